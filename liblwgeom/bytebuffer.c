@@ -187,12 +187,24 @@ void
 bytebuffer_append_varint(bytebuffer_t *b, const int64_t val)
 {	
 	size_t size;
-	bytebuffer_makeroom(b, 8);
+	/* A 64-bit varint takes up to 10 bytes */
+	bytebuffer_makeroom(b, 10);
 	size = varint_s64_encode_buf(val, b->writecursor);
 	b->writecursor += size;
 	return;
 }
 
+/**
+* Writes n signed varInts to the buffer
+*/
+void
+bytebuffer_append_varint_array(bytebuffer_t *b, const int64_t *vals, size_t n)
+{
+	bytebuffer_makeroom(b, 10 * n);
+	b->writecursor += varint_s64_encode_array(vals, n, b->writecursor);
+	return;
+}
+
 /**
 * Writes a unsigned varInt to the buffer
 */
@@ -200,7 +212,7 @@ void
 bytebuffer_append_uvarint(bytebuffer_t *b, const uint64_t val)
 {	
 	size_t size;
-	bytebuffer_makeroom(b, 8);
+	bytebuffer_makeroom(b, 10);
 	size = varint_u64_encode_buf(val, b->writecursor);
 	b->writecursor += size;
 	return;
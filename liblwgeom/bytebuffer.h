@@ -50,6 +50,7 @@ void bytebuffer_destroy(bytebuffer_t *s);
 void bytebuffer_clear(bytebuffer_t *s);
 void bytebuffer_append_byte(bytebuffer_t *s, const uint8_t val);
 void bytebuffer_append_varint(bytebuffer_t *s, const int64_t val);
+void bytebuffer_append_varint_array(bytebuffer_t *s, const int64_t *vals, size_t n);
 void bytebuffer_append_uvarint(bytebuffer_t *s, const uint64_t val);
 uint64_t bytebuffer_read_uvarint(bytebuffer_t *s);
 int64_t bytebuffer_read_varint(bytebuffer_t *s);
@@ -201,6 +201,32 @@ static void in_geojson_test_geoms(void)
 	    NULL, 0, 0);
 }
 
+static void in_geojson_test_members(void)
+{
+	/* Members in any order, unknown members skipped */
+	do_geojson_test(
+	    "LINESTRING(0 1,2 3)",
+	    "{ \"coordinates\" : [ [0,1] , [2,3] ], \"properties\":{\"a\":[true,false,null,\"\\u00e9\\n\"],\"b\":{}}, \"type\" : \"LineString\" }",
+	    NULL, 0, 0);
+
+	/* The last position sets the Z dimension */
+	do_geojson_test(
+	    "LINESTRING(0 1 0,2 3 4)",
+	    "{\"type\":\"LineString\",\"coordinates\":[[0,1],[2,3,4]]}",
+	    NULL, 0, 0);
+
+	do_geojson_test(
+	    "MULTIPOINT(0 1,2 3)",
+	    "{\"type\":\"MultiPoint\",\"coordinates\":[[0,1,2],[2,3]]}",
+	    NULL, 0, 0);
+
+	/* Number formats */
+	do_geojson_test(
+	    "POINT(-0.5 1500 0.0015)",
+	    "{\"type\":\"Point\",\"coordinates\":[-5e-1,1.5E+3,0.0015]}",
+	    NULL, 0, 0);
+}
+
 /*
 ** Used by test harness to register the tests in this file.
 */
@@ -211,4 +237,5 @@ void in_geojson_suite_setup(void)
 	PG_ADD_TEST(suite, in_geojson_test_srid);
 	PG_ADD_TEST(suite, in_geojson_test_bbox);
 	PG_ADD_TEST(suite, in_geojson_test_geoms);
+	PG_ADD_TEST(suite, in_geojson_test_members);
 }
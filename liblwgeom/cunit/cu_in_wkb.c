@@ -211,6 +211,35 @@ static void test_wkb_in_multicurve(void) {}
 
 static void test_wkb_in_multisurface(void) {}
 
+static void test_wkb_in_xdr(void)
+{
+	/* Big endian input goes through the byte swapping copy of the coordinates */
+	const char *wkt[] =
+	{
+		"SRID=4;POINT(1.5 -2.25)",
+		"LINESTRING ZM (0 1 2 3,4 5 6 7,1e300 -1e-300 0.1 -0.2)",
+		"POLYGON((0 0,0 1,1 1,1 0,0 0),(0.2 0.2,0.2 0.4,0.4 0.4,0.4 0.2,0.2 0.2))",
+		"GEOMETRYCOLLECTION(MULTIPOINT M (0 0 1,2 2 3),LINESTRING EMPTY,POINT Z (1 2 3))"
+	};
+	int i;
+
+	for ( i = 0; i < sizeof(wkt) / sizeof(wkt[0]); i++ )
+	{
+		LWGEOM *g_a = lwgeom_from_wkt(wkt[i], LW_PARSER_CHECK_NONE);
+		LWGEOM *g_b;
+		size_t wkb_size;
+		uint8_t *wkb = lwgeom_to_wkb(g_a, WKB_XDR | WKB_EXTENDED, &wkb_size);
+
+		g_b = lwgeom_from_wkb(wkb, wkb_size, LW_PARSER_CHECK_NONE);
+		CU_ASSERT(lwgeom_same(g_a, g_b));
+		CU_ASSERT_EQUAL(g_a->srid, g_b->srid);
+
+		lwfree(wkb);
+		lwgeom_free(g_a);
+		lwgeom_free(g_b);
+	}
+}
+
 static void test_wkb_in_malformed(void)
 {
 	/* See http://trac.osgeo.org/postgis/ticket/1445 */
@@ -243,5 +272,6 @@ void wkb_in_suite_setup(void)
 	PG_ADD_TEST(suite, test_wkb_in_curvpolygon);
 	PG_ADD_TEST(suite, test_wkb_in_multicurve);
 	PG_ADD_TEST(suite, test_wkb_in_multisurface);
+	PG_ADD_TEST(suite, test_wkb_in_xdr);
 	PG_ADD_TEST(suite, test_wkb_in_malformed);
 }
@@ -327,6 +327,45 @@ static void test_wkt_in_polyhedralsurface(void)
 
 }
 
+static void test_wkt_in_plain(void)
+{
+	LWGEOM_PARSER_RESULT p;
+	int rv = 0;
+
+	/* Plain geometries skip the grammar, they must read the same */
+	s = "SRID=4326;MULTIPOINT M (1 2 3,(4 5 6))";
+	r = cu_wkt_in(s, WKT_EXTENDED);
+	CU_ASSERT_STRING_EQUAL(r,"SRID=4326;MULTIPOINTM(1 2 3,4 5 6)");
+	lwfree(r);
+
+	s = "polygonzm((0 0 1 2,0 1 1 2,1 1 1 2,0 0 1 2))";
+	r = cu_wkt_in(s, WKT_ISO);
+	CU_ASSERT_STRING_EQUAL(r,"POLYGON ZM ((0 0 1 2,0 1 1 2,1 1 1 2,0 0 1 2))");
+	lwfree(r);
+
+	s = "LINESTRING( 1e3 -.5 , 2.5E-1 7. )";
+	r = cu_wkt_in(s, WKT_SFSQL);
+	CU_ASSERT_STRING_EQUAL(r,"LINESTRING(1000 -0.5,0.25 7)");
+	lwfree(r);
+
+	/* Numbers glued together are still split as the lexer does */
+	s = "LINESTRING(0-1,2.5.5)";
+	r = cu_wkt_in(s, WKT_SFSQL);
+	CU_ASSERT_STRING_EQUAL(r,"LINESTRING(0 -1,2.5 0.5)");
+	lwfree(r);
+
+	s = "POINT M (1 2)";
+	r = cu_wkt_in(s, WKT_SFSQL);
+	CU_ASSERT_STRING_EQUAL(r,"can not mix dimensionality in a geometry");
+	lwfree(r);
+
+	/* Parse checks are still applied */
+	rv = lwgeom_parse_wkt(&p, "POLYGON((0 0,0 1,1 1,1 0))", LW_PARSER_CHECK_ALL);
+	CU_ASSERT_EQUAL( rv, LW_FAILURE );
+	CU_ASSERT_STRING_EQUAL(p.message,"geometry contains non-closed rings");
+	lwgeom_parser_result_free(&p);
+}
+
 static void test_wkt_in_errlocation(void)
 {
 	LWGEOM_PARSER_RESULT p;
@@ -367,5 +406,6 @@ void wkt_in_suite_setup(void)
 	PG_ADD_TEST(suite, test_wkt_in_multisurface);
 	PG_ADD_TEST(suite, test_wkt_in_tin);
 	PG_ADD_TEST(suite, test_wkt_in_polyhedralsurface);
+	PG_ADD_TEST(suite, test_wkt_in_plain);
 	PG_ADD_TEST(suite, test_wkt_in_errlocation);
 }
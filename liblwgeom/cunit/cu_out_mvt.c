@@ -0,0 +1,135 @@
+/**********************************************************************
+ *
+ * PostGIS - Spatial Types for PostgreSQL
+ * http://postgis.net
+ *
+ * This is free software; you can redistribute and/or modify it under
+ * the terms of the GNU General Public Licence. See the COPYING file.
+ *
+ **********************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "CUnit/Basic.h"
+
+#include "liblwgeom_internal.h"
+#include "cu_tester.h"
+
+
+/*
+** Global variable to hold hex tile strings
+*/
+static char *s;
+
+static int init_mvt_out_suite(void)
+{
+	s = NULL;
+	return 0;
+}
+
+static int clean_mvt_out_suite(void)
+{
+	if (s) free(s);
+	s = NULL;
+	return 0;
+}
+
+static MVT_LAYER *cu_mvt_layer(int clip_geom)
+{
+	GBOX bounds;
+	memset(&bounds, 0, sizeof(GBOX));
+	bounds.xmax = bounds.ymax = 100;
+	return mvt_layer_create("test", &bounds, 4096, 256, clip_geom);
+}
+
+static void cu_mvt_tile(MVT_LAYER *layer)
+{
+	size_t tile_size;
+	uint8_t *tile = mvt_layer_to_tile(layer, &tile_size);
+	if ( s ) free(s);
+	s = hexbytes_from_bytes(tile, tile_size);
+	lwfree(tile);
+	mvt_layer_free(layer);
+}
+
+/*
+** Creating a single feature tile from a wkt string
+*/
+static void cu_mvt(char *wkt, int clip_geom)
+{
+	LWGEOM *g = lwgeom_from_wkt(wkt, LW_PARSER_CHECK_NONE);
+	MVT_LAYER *layer = cu_mvt_layer(clip_geom);
+	if ( ! g )  lwnotice("input wkt is invalid: %s", wkt);
+	if ( mvt_layer_feature_begin(layer, g) == LW_SUCCESS )
+		mvt_layer_feature_end(layer);
+	lwgeom_free(g);
+	cu_mvt_tile(layer);
+}
+
+
+static void test_mvt_out_point(void)
+{
+	/* Y axis points down */
+	cu_mvt("POINT(50 50)", 1);
+	CU_ASSERT_STRING_EQUAL(s, "1A160A047465737412091801220509802080202880207802");
+
+	/* Outside of the buffered tile */
+	cu_mvt("POINT(500 500)", 1);
+	CU_ASSERT_STRING_EQUAL(s, "1A0B0A04746573742880207802");
+}
+
+static void test_mvt_out_linestring(void)
+{
+	/* Clipped at -256 on both axes */
+	cu_mvt("LINESTRING(-50 50,50 50,50 150)", 1);
+	CU_ASSERT_STRING_EQUAL(s, "1A1D0A047465737412101802220C09FF0380201280240000FF232880207802");
+
+	cu_mvt("LINESTRING(-50 50,50 50,50 150)", 0);
+	CU_ASSERT_STRING_EQUAL(s, "1A1D0A047465737412101802220C09FF1F80201280400000FF3F2880207802");
+
+	/* Collapsed to a single tile unit */
+	cu_mvt("LINESTRING(10 10,10.001 10.001)", 1);
+	CU_ASSERT_STRING_EQUAL(s, "1A0B0A04746573742880207802");
+}
+
+static void test_mvt_out_polygon(void)
+{
+	/* Rings are reoriented: exterior clockwise, interior
+	   counterclockwise in tile coordinates */
+	cu_mvt("POLYGON((10 10,90 10,90 90,10 90,10 10),(40 40,40 60,60 60,60 40,40 40))", 1);
+	CU_ASSERT_STRING_EQUAL(s, "1A310A047465737412241803222009B406CC391A0097339833000098330F09FF1F97131AE80C0000E70CE70C000F2880207802");
+}
+
+static void test_mvt_out_tags(void)
+{
+	MVT_LAYER *layer = cu_mvt_layer(1);
+	LWGEOM *g = lwgeom_from_wkt("POINT(50 50)", LW_PARSER_CHECK_NONE);
+	int i;
+
+	/* Keys and values are shared by the features */
+	for ( i = 0; i < 2; i++ )
+	{
+		CU_ASSERT_EQUAL(mvt_layer_feature_begin(layer, g), LW_SUCCESS);
+		mvt_layer_feature_string(layer, mvt_layer_key(layer, "name"), "a", 1);
+		mvt_layer_feature_int(layer, mvt_layer_key(layer, "id"), i);
+		mvt_layer_feature_end(layer);
+	}
+	lwgeom_free(g);
+	cu_mvt_tile(layer);
+	CU_ASSERT_STRING_EQUAL(s, "1A440A0474657374120F120400000101180122050980208020120F1204000001021801220509802080201A046E616D651A02696422030A016122022800220228012880207802");
+}
+
+
+/*
+** Used by test harness to register the tests in this file.
+*/
+void mvt_out_suite_setup(void);
+void mvt_out_suite_setup(void)
+{
+	CU_pSuite suite = CU_add_suite("mvt_output", init_mvt_out_suite, clean_mvt_out_suite);
+	PG_ADD_TEST(suite, test_mvt_out_point);
+	PG_ADD_TEST(suite, test_mvt_out_linestring);
+	PG_ADD_TEST(suite, test_mvt_out_polygon);
+	PG_ADD_TEST(suite, test_mvt_out_tags);
+}
@@ -88,6 +88,28 @@ static void cu_twkb_idlist(char *wkt, int64_t *idlist, int8_t prec_xy, int8_t pr
 }
 
 
+/*
+** Creating a batch TWKB from wkt strings, one member each
+*/
+static void cu_twkb_batch(char **wkts, int64_t *idlist, int n, int8_t prec_xy, uint8_t variant)
+{
+	TWKB_BATCH *batch = twkb_batch_create(variant, prec_xy, 0, 0);
+	size_t twkb_size;
+	uint8_t *twkb;
+	int i;
+	for ( i = 0; i < n; i++ )
+	{
+		LWGEOM *g = lwgeom_from_wkt(wkts[i], LW_PARSER_CHECK_NONE);
+		twkb_batch_add(batch, g, idlist[i]);
+		lwgeom_free(g);
+	}
+	twkb = twkb_batch_to_twkb(batch, &twkb_size);
+	twkb_batch_free(batch);
+	if ( s ) free(s);
+	s = hexbytes_from_bytes(twkb, twkb_size);
+	free(twkb);
+}
+
 
 static void test_twkb_out_point(void)
 {
@@ -273,6 +295,32 @@ static void test_twkb_out_idlist(void)
 
 }
 
+static void test_twkb_out_batch(void)
+{
+	char *points[] = { "POINT(1 1)", "POINT(0 0)" };
+	char *mixed[] = { "POINT(1 1)", "POINT(0 0)", "LINESTRING(0 0,1 1)", "POINT EMPTY" };
+	int64_t idlist[4];
+	char *t;
+
+	idlist[0] = 2;
+	idlist[1] = 4;
+	idlist[2] = 6;
+	idlist[3] = 8;
+
+	/* Points share one delta stream, as in a multipoint */
+	cu_twkb_batch(points, idlist, 2, 0, 0);
+	CU_ASSERT_STRING_EQUAL(s,"040402040802020101");
+	cu_twkb_batch(points, idlist, 2, 0, TWKB_SIZE | TWKB_BBOX);
+	CU_ASSERT_STRING_EQUAL(s,"04070B0002000202040802020101");
+
+	/* A line turns the batch into a collection */
+	cu_twkb_idlist("GEOMETRYCOLLECTION(POINT(1 1),POINT(0 0),LINESTRING(0 0,1 1),POINT EMPTY)", idlist, 1, 0, 0, TWKB_SIZE | TWKB_BBOX);
+	t = s;
+	s = NULL;
+	cu_twkb_batch(mixed, idlist, 4, 1, TWKB_SIZE | TWKB_BBOX);
+	CU_ASSERT_STRING_EQUAL(s, t);
+	free(t);
+}
 
 /*
 ** Used by test harness to register the tests in this file.
@@ -289,4 +337,5 @@ void twkb_out_suite_setup(void)
 	PG_ADD_TEST(suite, test_twkb_out_multipolygon);
 	PG_ADD_TEST(suite, test_twkb_out_collection);
 	PG_ADD_TEST(suite, test_twkb_out_idlist);
+	PG_ADD_TEST(suite, test_twkb_out_batch);
 }
@@ -208,6 +208,46 @@ static void test_wkb_out_polyhedralsurface(void)
 //	printf("\nnew: %s\nold: %s\n",s,t);
 }
 
+/*
+** Writing from the serialized form must match the LWGEOM writer
+*/
+static void cu_wkb_serialized(char *wkt, int srid)
+{
+	uint8_t variants[] = { WKB_ISO | WKB_NDR, WKB_SFSQL | WKB_XDR, WKB_EXTENDED | WKB_NDR, WKB_EXTENDED | WKB_XDR | WKB_HEX };
+	LWGEOM *g = lwgeom_from_wkt(wkt, LW_PARSER_CHECK_NONE);
+	GSERIALIZED *gser;
+	int i;
+
+	lwgeom_set_srid(g, srid);
+	gser = gserialized_from_lwgeom(g, 0);
+	for ( i = 0; i < 4; i++ )
+	{
+		size_t size1, size2;
+		uint8_t *wkb1 = lwgeom_to_wkb(g, variants[i], &size1);
+		uint8_t *wkb2 = gserialized_to_wkb(gser, variants[i], &size2);
+		CU_ASSERT_EQUAL(size1, size2);
+		CU_ASSERT(memcmp(wkb1, wkb2, size1) == 0);
+		lwfree(wkb1);
+		lwfree(wkb2);
+	}
+	lwfree(gser);
+	lwgeom_free(g);
+}
+
+static void test_wkb_out_serialized(void)
+{
+	cu_wkb_serialized("POINT(1 2)", 4326);
+	cu_wkb_serialized("POINT EMPTY", 4326);
+	cu_wkb_serialized("LINESTRING ZM(1 2 3 4,5 6 7 8)", 0);
+	cu_wkb_serialized("POLYGON((0 0,0 1,1 1,0 0),(0 0,0 0.5,0.5 0.5,0 0))", 4326);
+	cu_wkb_serialized("POLYGON M((0 0 1,0 1 1,1 1 1,0 0 1))", 0);
+	cu_wkb_serialized("TRIANGLE((0 0,0 1,1 1,0 0))", 4326);
+	cu_wkb_serialized("MULTIPOINT(EMPTY,1 2)", 0);
+	cu_wkb_serialized("GEOMETRYCOLLECTION(POINT EMPTY,POLYGON EMPTY)", 4326);
+	cu_wkb_serialized("GEOMETRYCOLLECTION Z(MULTILINESTRING Z((0 0 0,1 1 1)),POINT Z(1 2 3))", 4326);
+	cu_wkb_serialized("CURVEPOLYGON(COMPOUNDCURVE(CIRCULARSTRING(0 0,1 1,2 0),(2 0,0 0)))", 0);
+}
+
 /*
 ** Used by test harness to register the tests in this file.
 */
@@ -228,4 +268,5 @@ void wkb_out_suite_setup(void)
 	PG_ADD_TEST(suite, test_wkb_out_multicurve);
 	PG_ADD_TEST(suite, test_wkb_out_multisurface);
 	PG_ADD_TEST(suite, test_wkb_out_polyhedralsurface);
+	PG_ADD_TEST(suite, test_wkb_out_serialized);
 }
@@ -157,6 +157,35 @@ static void test_lwprint_bad_formats(void)
 	test_lwprint_assert_error("POINT(1.23456 7.89012)", "DD.DDD jjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjj");
 }
 
+static void test_lwprint_double_assert(double d, int precision, const char *expected, const char *expected_significant)
+{
+	char buf[OUT_DOUBLE_BUFFER_SIZE];
+
+	lwprint_double(d, precision, buf, OUT_DOUBLE_BUFFER_SIZE);
+	CU_ASSERT_STRING_EQUAL(buf, expected);
+	lwprint_double_significant(d, precision, buf, OUT_DOUBLE_BUFFER_SIZE);
+	CU_ASSERT_STRING_EQUAL(buf, expected_significant);
+}
+
+static void test_lwprint_double(void)
+{
+	test_lwprint_double_assert(0, 15, "0", "0");
+	test_lwprint_double_assert(-0.0, 15, "-0", "-0");
+	test_lwprint_double_assert(1, 15, "1", "1");
+	test_lwprint_double_assert(-1.5, 0, "-2", "-2");
+	test_lwprint_double_assert(2.5, 0, "2", "2");
+	test_lwprint_double_assert(0.1, 15, "0.1", "0.1");
+	test_lwprint_double_assert(0.1, 17, "0.10000000000000001", "0.10000000000000001");
+	test_lwprint_double_assert(-0.0004, 3, "-0", "-0.0004");
+	test_lwprint_double_assert(123456.789, 2, "123456.79", "1.2e+05");
+	test_lwprint_double_assert(1234567.891, 15, "1234567.891000000061467", "1234567.891");
+	test_lwprint_double_assert(999999999999999.88, 16, "999999999999999.875", "999999999999999.9");
+	test_lwprint_double_assert(0.000099999, 3, "0", "0.0001");
+	test_lwprint_double_assert(1e-5, 15, "0.00001", "1e-05");
+	test_lwprint_double_assert(1e15, 15, "1e+15", "1e+15");
+	test_lwprint_double_assert(1.5e20, 15, "1.5e+20", "1.5e+20");
+}
+
 /*
 ** Callback used by the test harness to register the tests in this file.
 */
@@ -169,5 +198,6 @@ void print_suite_setup(void)
 	PG_ADD_TEST(suite, test_lwprint_optional_format);
 	PG_ADD_TEST(suite, test_lwprint_oddball_formats);
 	PG_ADD_TEST(suite, test_lwprint_bad_formats);
+	PG_ADD_TEST(suite, test_lwprint_double);
 }
 
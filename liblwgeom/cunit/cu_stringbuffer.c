@@ -47,6 +47,29 @@ static void test_stringbuffer_aprintf(void)
 	stringbuffer_destroy(sb);
 }
 
+static void test_stringbuffer_append_double(void)
+{
+	stringbuffer_t *sb;
+	const char *str;
+
+	sb = stringbuffer_create_with_size(2);
+	stringbuffer_append_char(sb, '[');
+	stringbuffer_append_double(sb, 1.50, 15);
+	stringbuffer_append_len(sb, ",,,", 1);
+	stringbuffer_append_double(sb, -123456789.123, 2);
+	stringbuffer_append_char(sb, ',');
+	stringbuffer_append_double_significant(sb, 0.1234567, 3);
+	stringbuffer_append_char(sb, ',');
+	stringbuffer_append_double_significant(sb, 1e300, 15);
+	stringbuffer_append_char(sb, ']');
+	str = stringbuffer_getstring(sb);
+
+	CU_ASSERT_STRING_EQUAL("[1.5,-123456789.12,0.123,1e+300]", str);
+	CU_ASSERT_EQUAL(stringbuffer_getlength(sb), strlen(str));
+
+	stringbuffer_destroy(sb);
+}
+
 
 /* TODO: add more... */
 
@@ -59,4 +82,5 @@ void stringbuffer_suite_setup(void)
 	CU_pSuite suite = CU_add_suite("stringbuffer", NULL, NULL);
 	PG_ADD_TEST(suite, test_stringbuffer_append);
 	PG_ADD_TEST(suite, test_stringbuffer_aprintf);
+	PG_ADD_TEST(suite, test_stringbuffer_append_double);
 }
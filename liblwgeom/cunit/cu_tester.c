@@ -48,6 +48,7 @@ extern void measures_suite_setup(void);
 extern void effectivearea_suite_setup(void);
 extern void minimum_bounding_circle_suite_setup(void);
 extern void misc_suite_setup(void);
+extern void mvt_out_suite_setup(void);
 extern void node_suite_setup(void);
 extern void out_encoded_polyline_suite_setup(void);
 extern void out_geojson_suite_setup(void);
@@ -95,6 +96,7 @@ PG_SuiteSetup setupfuncs[] =
 	effectivearea_suite_setup,
 	minimum_bounding_circle_suite_setup,
 	misc_suite_setup,
+	mvt_out_suite_setup,
 	node_suite_setup,
 	out_encoded_polyline_suite_setup,
 	out_geojson_suite_setup,
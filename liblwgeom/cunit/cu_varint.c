@@ -207,6 +207,30 @@ static void test_varint_roundtrip(void)
 	}
 }
 
+static void test_varint_array(void)
+{
+	int64_t vals[40], out[40];
+	uint8_t buf[40 * 10], one[40 * 10];
+	size_t size, one_size = 0, i, n = 40;
+
+	for ( i = 0; i < n; i++ )
+		vals[i] = (i % 2 ? -1 : 1) * ((int64_t)1 << (i + 3)) + (int64_t)i;
+	vals[0] = INT64_MAX;
+	vals[1] = INT64_MIN;
+
+	/* Same bytes as encoding the values one at a time */
+	size = varint_s64_encode_array(vals, n, buf);
+	for ( i = 0; i < n; i++ )
+		one_size += varint_s64_encode_buf(vals[i], one + one_size);
+	CU_ASSERT_EQUAL(size, one_size);
+	CU_ASSERT_EQUAL(memcmp(buf, one, size), 0);
+
+	/* Values near the end of the buffer take the checked path */
+	CU_ASSERT_EQUAL(varint_s64_decode_array(buf, buf + size, out, n), size);
+	for ( i = 0; i < n; i++ )
+		CU_ASSERT_EQUAL(out[i], vals[i]);
+}
+
 static void test_zigzag(void)
 {
 	int64_t a;
@@ -237,4 +261,5 @@ void varint_suite_setup(void)
 	PG_ADD_TEST(suite, test_zigzag);
 	PG_ADD_TEST(suite, test_varint);
 	PG_ADD_TEST(suite, test_varint_roundtrip);
+	PG_ADD_TEST(suite, test_varint_array);
 }
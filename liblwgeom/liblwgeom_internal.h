@@ -46,6 +46,7 @@
 #include <float.h>
 
 #include "liblwgeom.h"
+#include "stringbuffer.h"
 
 /**
 * Floating point comparators.
@@ -133,6 +134,7 @@
 #define OUT_SHOW_DIGS_DOUBLE 20
 #define OUT_MAX_DOUBLE_PRECISION 15
 #define OUT_MAX_DIGS_DOUBLE (OUT_SHOW_DIGS_DOUBLE + 2) /* +2 mean add dot and sign */
+#define OUT_DOUBLE_BUFFER_SIZE (OUT_MAX_DIGS_DOUBLE + OUT_MAX_DOUBLE_PRECISION + 1)
 
 
 /**
@@ -449,6 +451,23 @@ int gbox_centroid(const GBOX* gbox, POINT2D* out);
 /* Utilities */
 extern void trim_trailing_zeros(char *num);
 
+/*
+* Print a double with at most maxdd decimal digits, trailing zeros
+* removed ("%.*f" then trim_trailing_zeros), or "%g" from OUT_MAX_DOUBLE.
+*/
+int lwprint_double(double d, int maxdd, char *buf, size_t bufsize);
+
+/*
+* Print a double with at most precision significant digits ("%.*g").
+*/
+int lwprint_double_significant(double d, int precision, char *buf, size_t bufsize);
+
+/*
+* Append the GeoJson representation of a geometry to a stringbuffer,
+* see lwgeom_to_geojson.
+*/
+int lwgeom_to_geojson_sb(const LWGEOM *geom, char *srs, int precision, int has_bbox, stringbuffer_t *sb);
+
 extern uint8_t MULTITYPE[NUMTYPES];
 
 extern lwinterrupt_callback *_lwgeom_interrupt_callback;
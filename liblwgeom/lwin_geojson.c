@@ -44,6 +44,9 @@
 # define json_tokener_error_desc(x) json_tokener_errors[(x)]
 #endif
 
+#include <ctype.h>
+#include <float.h>
+#include <stdlib.h>
 #include <string.h>
 
 static void geojson_lwerror(char *msg, int error_code)
@@ -520,6 +523,641 @@ parse_geojson(json_object *geojson, int *hasz, int root_srid)
 	return NULL; /* Never reach */
 }
 
+/*
+ * Streaming parser for the common case of a single geometry object
+ * with plain coordinates and an optional named crs. Coordinates are
+ * read straight into point arrays, without building the json-c tree.
+ *
+ * The fast path only accepts a strict subset of JSON. On anything it
+ * does not handle (GeometryCollection, escaped member names, empty
+ * coordinates arrays, duplicate members, malformed input...) it gives
+ * up without error and the input goes through json-c, which takes
+ * care of the leniencies and of the error messages.
+ */
+
+/* Deeper input is left to json-c and its own depth limit */
+#define GEOJSON_FAST_MAX_DEPTH 16
+
+typedef struct
+{
+	const char *cur; /* Current parse position */
+	int hasz; /* Did the last position have a Z? */
+	POINTARRAY **pas; /* Point lists, in document order */
+	uint32_t npas, maxpas;
+	uint32_t *nrings; /* Rings per polygon of a MultiPolygon */
+	uint32_t npolys, maxpolys;
+} geojson_parse_state;
+
+/* Exact powers of ten for the fast number conversion */
+static const double geojson_pow10[] =
+{
+	1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+	1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+static inline void
+geojson_skip_ws(geojson_parse_state *s)
+{
+	while ( *s->cur == ' ' || *s->cur == '\n' || *s->cur == '\r' || *s->cur == '\t' )
+		s->cur++;
+}
+
+static inline int
+geojson_expect(geojson_parse_state *s, char c)
+{
+	geojson_skip_ws(s);
+	if ( *s->cur != c )
+		return LW_FAILURE;
+	s->cur++;
+	return LW_SUCCESS;
+}
+
+static inline int
+geojson_key_equals(const char *key, size_t len, const char *name)
+{
+	return strlen(name) == len && strncasecmp(key, name, len) == 0;
+}
+
+/**
+* Read a string, its content is returned in str and len. Escape
+* sequences are only accepted with allow_escapes, they are then
+* left as is.
+*/
+static int
+geojson_parse_string(geojson_parse_state *s, const char **str, size_t *len, int allow_escapes)
+{
+	const char *p;
+	int i;
+
+	geojson_skip_ws(s);
+	if ( *s->cur != '"' )
+		return LW_FAILURE;
+	p = s->cur + 1;
+
+	while ( *p != '"' )
+	{
+		if ( (unsigned char) *p < 0x20 )
+			return LW_FAILURE; /* also catches the end of input */
+
+		if ( *p == '\\' )
+		{
+			if ( ! allow_escapes )
+				return LW_FAILURE;
+			p++;
+			if ( *p == 'u' )
+			{
+				for ( i = 1; i <= 4; i++ )
+					if ( ! isxdigit((unsigned char) p[i]) )
+						return LW_FAILURE;
+				p += 4;
+			}
+			else if ( ! *p || ! strchr("\"\\/bfnrt", *p) )
+			{
+				return LW_FAILURE;
+			}
+		}
+		p++;
+	}
+
+	if ( str ) *str = s->cur + 1;
+	if ( len ) *len = p - (s->cur + 1);
+	s->cur = p + 1;
+	return LW_SUCCESS;
+}
+
+/**
+* Read a JSON number. Integers are converted like json-c does, going
+* through int64. Decimals of up to 15 significant digits and small
+* exponents are exactly rounded with a single multiplication or division
+* by a power of ten, anything else is left to strtod.
+*/
+static int
+geojson_parse_number(geojson_parse_state *s, double *d)
+{
+	const char *start, *p;
+	uint64_t mant = 0;
+	int ndigits = 0, nfrac = 0, exp10 = 0, expsign = 1;
+	int neg = 0, is_double = 0;
+
+	geojson_skip_ws(s);
+	start = p = s->cur;
+
+	if ( *p == '-' )
+	{
+		neg = 1;
+		p++;
+	}
+
+	/* No leading zeros */
+	if ( *p == '0' )
+	{
+		p++;
+	}
+	else if ( *p >= '1' && *p <= '9' )
+	{
+		while ( *p >= '0' && *p <= '9' )
+		{
+			if ( ndigits < 19 )
+				mant = mant * 10 + (*p - '0');
+			ndigits++;
+			p++;
+		}
+	}
+	else
+	{
+		return LW_FAILURE;
+	}
+
+	if ( *p == '.' )
+	{
+		is_double = 1;
+		p++;
+		if ( ! (*p >= '0' && *p <= '9') )
+			return LW_FAILURE;
+		while ( *p >= '0' && *p <= '9' )
+		{
+			/* Leading zeros of the fraction are not significant */
+			if ( ndigits || *p != '0' )
+			{
+				if ( ndigits < 19 )
+					mant = mant * 10 + (*p - '0');
+				ndigits++;
+			}
+			nfrac++;
+			p++;
+		}
+	}
+
+	if ( *p == 'e' || *p == 'E' )
+	{
+		is_double = 1;
+		p++;
+		if ( *p == '+' || *p == '-' )
+		{
+			if ( *p == '-' ) expsign = -1;
+			p++;
+		}
+		if ( ! (*p >= '0' && *p <= '9') )
+			return LW_FAILURE;
+		while ( *p >= '0' && *p <= '9' )
+		{
+			if ( exp10 < 10000 )
+				exp10 = exp10 * 10 + (*p - '0');
+			p++;
+		}
+	}
+	s->cur = p;
+
+	if ( ! is_double )
+	{
+		/* json-c saturates integers out of the int64 range */
+		if ( ndigits > 18 )
+			return LW_FAILURE;
+		*d = (double)(neg ? -(int64_t)mant : (int64_t)mant);
+		return LW_SUCCESS;
+	}
+
+	exp10 = expsign * exp10 - nfrac;
+
+#if defined(FLT_EVAL_METHOD) && FLT_EVAL_METHOD == 0
+	if ( ndigits <= 15 && exp10 >= -22 && exp10 <= 22 )
+	{
+		*d = exp10 < 0 ? mant / geojson_pow10[-exp10] : mant * geojson_pow10[exp10];
+		if ( neg ) *d = -*d;
+		return LW_SUCCESS;
+	}
+#endif
+
+	*d = strtod(start, NULL);
+	return LW_SUCCESS;
+}
+
+/**
+* Skip any JSON value
+*/
+static int
+geojson_skip_value(geojson_parse_state *s, int depth)
+{
+	double d;
+
+	if ( depth > GEOJSON_FAST_MAX_DEPTH )
+		return LW_FAILURE;
+
+	geojson_skip_ws(s);
+	switch ( *s->cur )
+	{
+	case '"':
+		return geojson_parse_string(s, NULL, NULL, LW_TRUE);
+	case '{':
+		s->cur++;
+		geojson_skip_ws(s);
+		if ( *s->cur == '}' )
+		{
+			s->cur++;
+			return LW_SUCCESS;
+		}
+		do
+		{
+			if ( geojson_parse_string(s, NULL, NULL, LW_TRUE) == LW_FAILURE ||
+			     geojson_expect(s, ':') == LW_FAILURE ||
+			     geojson_skip_value(s, depth + 1) == LW_FAILURE )
+				return LW_FAILURE;
+			geojson_skip_ws(s);
+		}
+		while ( *s->cur++ == ',' );
+		return *(s->cur - 1) == '}' ? LW_SUCCESS : LW_FAILURE;
+	case '[':
+		s->cur++;
+		geojson_skip_ws(s);
+		if ( *s->cur == ']' )
+		{
+			s->cur++;
+			return LW_SUCCESS;
+		}
+		do
+		{
+			if ( geojson_skip_value(s, depth + 1) == LW_FAILURE )
+				return LW_FAILURE;
+			geojson_skip_ws(s);
+		}
+		while ( *s->cur++ == ',' );
+		return *(s->cur - 1) == ']' ? LW_SUCCESS : LW_FAILURE;
+	case 't':
+		if ( strncmp(s->cur, "true", 4) ) return LW_FAILURE;
+		s->cur += 4;
+		return LW_SUCCESS;
+	case 'f':
+		if ( strncmp(s->cur, "false", 5) ) return LW_FAILURE;
+		s->cur += 5;
+		return LW_SUCCESS;
+	case 'n':
+		if ( strncmp(s->cur, "null", 4) ) return LW_FAILURE;
+		s->cur += 4;
+		return LW_SUCCESS;
+	default:
+		return geojson_parse_number(s, &d);
+	}
+}
+
+/**
+* Read a position and append it to pa. Like parse_geojson_coord, extra
+* ordinates past Z are dropped and a missing Z is set to 0.
+*/
+static int
+geojson_parse_position(geojson_parse_state *s, POINTARRAY *pa)
+{
+	POINT4D pt = {0.0, 0.0, 0.0, 0.0};
+	double extra;
+	int n = 0;
+
+	if ( geojson_expect(s, '[') == LW_FAILURE )
+		return LW_FAILURE;
+
+	do
+	{
+		if ( geojson_parse_number(s, n == 0 ? &pt.x : n == 1 ? &pt.y : n == 2 ? &pt.z : &extra) == LW_FAILURE )
+			return LW_FAILURE;
+		n++;
+		geojson_skip_ws(s);
+	}
+	while ( *s->cur++ == ',' );
+
+	if ( *(s->cur - 1) != ']' || n < 2 )
+		return LW_FAILURE;
+
+	s->hasz = n > 2;
+	return ptarray_append_point(pa, &pt, LW_TRUE);
+}
+
+/**
+* Read a non-empty array of positions into a new point array
+*/
+static int
+geojson_parse_positions(geojson_parse_state *s)
+{
+	POINTARRAY *pa;
+
+	if ( geojson_expect(s, '[') == LW_FAILURE )
+		return LW_FAILURE;
+
+	if ( s->npas == s->maxpas )
+	{
+		s->maxpas *= 2;
+		s->pas = lwrealloc(s->pas, sizeof(POINTARRAY*) * s->maxpas);
+	}
+	pa = s->pas[s->npas++] = ptarray_construct_empty(1, 0, 1);
+
+	do
+	{
+		if ( geojson_parse_position(s, pa) == LW_FAILURE )
+			return LW_FAILURE;
+		geojson_skip_ws(s);
+	}
+	while ( *s->cur++ == ',' );
+
+	return *(s->cur - 1) == ']' ? LW_SUCCESS : LW_FAILURE;
+}
+
+/**
+* Read a non-empty array of arrays of positions, counting them
+* in count if not NULL
+*/
+static int
+geojson_parse_lines(geojson_parse_state *s, uint32_t *count)
+{
+	if ( geojson_expect(s, '[') == LW_FAILURE )
+		return LW_FAILURE;
+
+	do
+	{
+		if ( geojson_parse_positions(s) == LW_FAILURE )
+			return LW_FAILURE;
+		if ( count ) (*count)++;
+		geojson_skip_ws(s);
+	}
+	while ( *s->cur++ == ',' );
+
+	return *(s->cur - 1) == ']' ? LW_SUCCESS : LW_FAILURE;
+}
+
+/**
+* Read the coordinates member. Its nesting depth is returned in
+* depth: 1 for a position, 2 for an array of positions, 3 for an array
+* of arrays of positions and 4 for the coordinates of a MultiPolygon.
+*/
+static int
+geojson_parse_coordinates(geojson_parse_state *s, int *depth)
+{
+	const char *p;
+
+	/* Count the opening brackets up to the first ordinate */
+	geojson_skip_ws(s);
+	*depth = 0;
+	for ( p = s->cur; *p == '[' || *p == ' ' || *p == '\n' || *p == '\r' || *p == '\t'; p++ )
+		if ( *p == '[' ) (*depth)++;
+
+	switch ( *depth )
+	{
+	case 1:
+		s->pas[s->npas++] = ptarray_construct_empty(1, 0, 1);
+		return geojson_parse_position(s, s->pas[0]);
+	case 2:
+		return geojson_parse_positions(s);
+	case 3:
+		return geojson_parse_lines(s, NULL);
+	case 4:
+		if ( geojson_expect(s, '[') == LW_FAILURE )
+			return LW_FAILURE;
+		do
+		{
+			if ( s->npolys == s->maxpolys )
+			{
+				s->maxpolys *= 2;
+				s->nrings = lwrealloc(s->nrings, sizeof(uint32_t) * s->maxpolys);
+			}
+			s->nrings[s->npolys] = 0;
+			if ( geojson_parse_lines(s, &(s->nrings[s->npolys++])) == LW_FAILURE )
+				return LW_FAILURE;
+			geojson_skip_ws(s);
+		}
+		while ( *s->cur++ == ',' );
+		return *(s->cur - 1) == ']' ? LW_SUCCESS : LW_FAILURE;
+	default:
+		return LW_FAILURE;
+	}
+}
+
+/**
+* Read a crs member, only named crs objects with a properties object
+* are handled. The name is returned in srs, it is left NULL when
+* json-c would not find it either.
+*/
+static int
+geojson_parse_crs(geojson_parse_state *s, char **srs)
+{
+	const char *key, *name = NULL;
+	size_t keylen, namelen = 0;
+	int has_type = LW_FALSE, has_props = LW_FALSE;
+
+	geojson_skip_ws(s);
+	if ( *s->cur != '{' )
+		return geojson_skip_value(s, 2);
+	s->cur++;
+
+	do
+	{
+		if ( geojson_parse_string(s, &key, &keylen, LW_FALSE) == LW_FAILURE ||
+		     geojson_expect(s, ':') == LW_FAILURE )
+			return LW_FAILURE;
+
+		if ( geojson_key_equals(key, keylen, "type") )
+		{
+			has_type = LW_TRUE;
+			if ( geojson_skip_value(s, 2) == LW_FAILURE )
+				return LW_FAILURE;
+		}
+		else if ( geojson_key_equals(key, keylen, "properties") )
+		{
+			if ( has_props )
+				return LW_FAILURE;
+			has_props = LW_TRUE;
+
+			geojson_skip_ws(s);
+			if ( *s->cur != '{' )
+			{
+				if ( geojson_skip_value(s, 3) == LW_FAILURE )
+					return LW_FAILURE;
+			}
+			else
+			{
+				s->cur++;
+				do
+				{
+					if ( geojson_parse_string(s, &key, &keylen, LW_FALSE) == LW_FAILURE ||
+					     geojson_expect(s, ':') == LW_FAILURE )
+						return LW_FAILURE;
+
+					if ( geojson_key_equals(key, keylen, "name") )
+					{
+						if ( name || geojson_parse_string(s, &name, &namelen, LW_FALSE) == LW_FAILURE )
+							return LW_FAILURE;
+					}
+					else if ( geojson_skip_value(s, 4) == LW_FAILURE )
+					{
+						return LW_FAILURE;
+					}
+					geojson_skip_ws(s);
+				}
+				while ( *s->cur++ == ',' );
+
+				if ( *(s->cur - 1) != '}' )
+					return LW_FAILURE;
+			}
+		}
+		else if ( geojson_skip_value(s, 2) == LW_FAILURE )
+		{
+			return LW_FAILURE;
+		}
+		geojson_skip_ws(s);
+	}
+	while ( *s->cur++ == ',' );
+
+	if ( *(s->cur - 1) != '}' )
+		return LW_FAILURE;
+
+	if ( has_type && name )
+	{
+		*srs = lwalloc(namelen + 1);
+		memcpy(*srs, name, namelen);
+		(*srs)[namelen] = '\0';
+	}
+	return LW_SUCCESS;
+}
+
+/**
+* Build the geometry out of the parsed point arrays, which are
+* handed over to it
+*/
+static LWGEOM*
+geojson_build_geom(geojson_parse_state *s, const char *type, size_t typelen, int depth)
+{
+	LWGEOM *geom;
+	uint32_t i, j, k;
+
+	if ( depth == 1 && geojson_key_equals(type, typelen, "Point") )
+	{
+		geom = (LWGEOM *) lwpoint_construct(0, NULL, s->pas[0]);
+	}
+	else if ( depth == 2 && geojson_key_equals(type, typelen, "LineString") )
+	{
+		geom = (LWGEOM *) lwline_construct(0, NULL, s->pas[0]);
+	}
+	else if ( depth == 3 && geojson_key_equals(type, typelen, "Polygon") )
+	{
+		geom = (LWGEOM *) lwpoly_construct(0, NULL, s->npas, s->pas);
+		s->pas = NULL; /* the polygon owns the array of rings */
+	}
+	else if ( depth == 2 && geojson_key_equals(type, typelen, "MultiPoint") )
+	{
+		POINT4D pt;
+		geom = (LWGEOM *) lwcollection_construct_empty(MULTIPOINTTYPE, 0, 1, 0);
+		for ( i = 0; i < s->pas[0]->npoints; i++ )
+		{
+			POINTARRAY *pa = ptarray_construct_empty(1, 0, 1);
+			getPoint4d_p(s->pas[0], i, &pt);
+			ptarray_append_point(pa, &pt, LW_TRUE);
+			geom = (LWGEOM *) lwmpoint_add_lwpoint((LWMPOINT *) geom, lwpoint_construct(0, NULL, pa));
+		}
+		ptarray_free(s->pas[0]);
+	}
+	else if ( depth == 3 && geojson_key_equals(type, typelen, "MultiLineString") )
+	{
+		geom = (LWGEOM *) lwcollection_construct_empty(MULTILINETYPE, 0, 1, 0);
+		for ( i = 0; i < s->npas; i++ )
+			geom = (LWGEOM *) lwmline_add_lwline((LWMLINE *) geom, lwline_construct(0, NULL, s->pas[i]));
+	}
+	else if ( depth == 4 && geojson_key_equals(type, typelen, "MultiPolygon") )
+	{
+		geom = (LWGEOM *) lwcollection_construct_empty(MULTIPOLYGONTYPE, 0, 1, 0);
+		for ( i = 0, k = 0; i < s->npolys; i++ )
+		{
+			LWPOLY *lwpoly = lwpoly_construct_empty(0, 1, 0);
+			for ( j = 0; j < s->nrings[i]; j++ )
+				lwpoly_add_ring(lwpoly, s->pas[k++]);
+			geom = (LWGEOM *) lwmpoly_add_lwpoly((LWMPOLY *) geom, lwpoly);
+		}
+	}
+	else
+	{
+		/* GeometryCollection, unknown type or unexpected nesting */
+		return NULL;
+	}
+
+	s->npas = 0;
+	return geom;
+}
+
+/**
+* Fast path of lwgeom_from_geojson, returns NULL when the input
+* has to go through json-c
+*/
+static LWGEOM*
+parse_geojson_fast(const char *geojson, int *hasz, char **srs)
+{
+	geojson_parse_state s;
+	LWGEOM *geom = NULL;
+	const char *key, *type = NULL;
+	size_t keylen, typelen = 0;
+	int depth = 0, has_crs = LW_FALSE;
+	uint32_t i;
+
+	s.cur = geojson;
+	s.hasz = LW_TRUE;
+	s.npas = s.npolys = 0;
+	s.maxpas = s.maxpolys = 4;
+	s.pas = lwalloc(sizeof(POINTARRAY*) * s.maxpas);
+	s.nrings = lwalloc(sizeof(uint32_t) * s.maxpolys);
+
+	if ( geojson_expect(&s, '{') == LW_FAILURE )
+		goto fallback;
+
+	do
+	{
+		if ( geojson_parse_string(&s, &key, &keylen, LW_FALSE) == LW_FAILURE ||
+		     geojson_expect(&s, ':') == LW_FAILURE )
+			goto fallback;
+
+		if ( geojson_key_equals(key, keylen, "type") )
+		{
+			if ( type || geojson_parse_string(&s, &type, &typelen, LW_FALSE) == LW_FAILURE )
+				goto fallback;
+		}
+		else if ( geojson_key_equals(key, keylen, "coordinates") )
+		{
+			if ( depth || geojson_parse_coordinates(&s, &depth) == LW_FAILURE )
+				goto fallback;
+		}
+		else if ( geojson_key_equals(key, keylen, "crs") )
+		{
+			if ( has_crs || geojson_parse_crs(&s, srs) == LW_FAILURE )
+				goto fallback;
+			has_crs = LW_TRUE;
+		}
+		else if ( geojson_key_equals(key, keylen, "geometries") )
+		{
+			goto fallback;
+		}
+		else if ( geojson_skip_value(&s, 1) == LW_FAILURE )
+		{
+			goto fallback;
+		}
+		geojson_skip_ws(&s);
+	}
+	while ( *s.cur++ == ',' );
+
+	if ( *(s.cur - 1) != '}' || ! type )
+		goto fallback;
+	geojson_skip_ws(&s);
+	if ( *s.cur )
+		goto fallback;
+
+	geom = geojson_build_geom(&s, type, typelen, depth);
+	if ( geom )
+		*hasz = s.hasz;
+
+fallback:
+	for ( i = 0; i < s.npas; i++ )
+		ptarray_free(s.pas[i]);
+	if ( s.pas ) lwfree(s.pas);
+	lwfree(s.nrings);
+	if ( ! geom && *srs )
+	{
+		lwfree(*srs);
+		*srs = NULL;
+	}
+	return geom;
+}
+
 #endif /* HAVE_LIBJSON or HAVE_LIBJSON_C --} */
 
 LWGEOM*
@@ -540,6 +1178,10 @@ lwgeom_from_geojson(const char *geojson, char **srs)
 	json_object* poObjSrs = NULL;
 	*srs = NULL;
 
+	lwgeom = parse_geojson_fast(geojson, &hasz, srs);
+	if ( lwgeom )
+		goto finish;
+
 	/* Begin to Parse json */
 	jstok = json_tokener_new();
 	poObj = json_tokener_parse_ex(jstok, geojson, -1);
@@ -580,6 +1222,7 @@ lwgeom_from_geojson(const char *geojson, char **srs)
 	lwgeom = parse_geojson(poObj, &hasz, 0);
 	json_object_put(poObj);
 
+finish:
 	lwgeom_add_bbox(lwgeom);
 
 	if (!hasz)
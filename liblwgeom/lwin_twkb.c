@@ -168,47 +168,57 @@ static uint8_t byte_from_twkb_state(twkb_parse_state *s)
 /**
 * POINTARRAY
 * Read a dynamically sized point array and advance the parse state forward.
+* The deltas are decoded a run at a time, then accumulated into the
+* coordinates.
 */
+#define TWKB_IN_CHUNK 256
+
 static POINTARRAY* ptarray_from_twkb_state(twkb_parse_state *s, uint32_t npoints)
 {
 	POINTARRAY *pa = NULL;
 	uint32_t ndims = s->ndims;
-	int i;
+	uint32_t i, j, k, n;
 	double *dlist;
+	double factors[TWKB_IN_MAXCOORDS];
+	int64_t deltas[TWKB_IN_CHUNK * TWKB_IN_MAXCOORDS];
 
 	LWDEBUG(2,"Entering ptarray_from_twkb_state");
 	LWDEBUGF(4,"Pointarray has %d points", npoints);
 
 	/* Empty! */
 	if( npoints == 0 )
-		return ptarray_construct_empty(s->has_z, s->has_m, 0);
+		return NULL;
+
+	/* Every ordinate takes at least one byte */
+	if( (uint64_t)npoints * ndims > (uint64_t)(s->twkb_end - s->pos) )
+	{
+		lwerror("%s: TWKB structure does not match expected size!", __func__);
+		return NULL;
+	}
+
+	/* X and Y share a precision, Z and M have their own */
+	j = 0;
+	factors[j++] = s->factor;
+	factors[j++] = s->factor;
+	if ( s->has_z )
+		factors[j++] = s->factor_z;
+	if ( s->has_m )
+		factors[j++] = s->factor_m;
 
 	pa = ptarray_construct(s->has_z, s->has_m, npoints);
 	dlist = (double*)(pa->serialized_pointlist);
-	for( i = 0; i < npoints; i++ )
+	for( i = 0; i < npoints; i += n )
 	{
-		int j = 0;
-		/* X */
-		s->coords[j] += twkb_parse_state_varint(s);
-		dlist[ndims*i + j] = s->coords[j] / s->factor;
-		j++;
-		/* Y */
-		s->coords[j] += twkb_parse_state_varint(s);
-		dlist[ndims*i + j] = s->coords[j] / s->factor;
-		j++;
-		/* Z */
-		if ( s->has_z )
-		{
-			s->coords[j] += twkb_parse_state_varint(s);
-			dlist[ndims*i + j] = s->coords[j] / s->factor_z;
-			j++;
-		}
-		/* M */
-		if ( s->has_m )
+		n = npoints - i < TWKB_IN_CHUNK ? npoints - i : TWKB_IN_CHUNK;
+		twkb_parse_state_advance(s, varint_s64_decode_array(s->pos, s->twkb_end, deltas, n * ndims));
+
+		for( k = 0; k < n * ndims; k += ndims )
 		{
-			s->coords[j] += twkb_parse_state_varint(s);
-			dlist[ndims*i + j] = s->coords[j] / s->factor_m;
-			j++;
+			for( j = 0; j < ndims; j++ )
+			{
+				s->coords[j] += deltas[k + j];
+				*dlist++ = s->coords[j] / factors[j];
+			}
 		}
 	}
 
@@ -124,7 +124,17 @@ uint8_t* bytes_from_hexbytes(const char *hexbuf, size_t hexsize)
 */
 static inline void wkb_parse_state_check(wkb_parse_state *s, size_t next)
 {
-	if( (s->pos + next) > (s->wkb + s->wkb_size) )
+	if( next > (size_t)(s->wkb + s->wkb_size - s->pos) )
+		lwerror("WKB structure does not match expected size!");
+}
+
+/**
+* Check that there is room left in the WKB array for count items
+* of at least size bytes each, without overflowing on large counts.
+*/
+static inline void wkb_parse_state_check_count(wkb_parse_state *s, uint32_t count, size_t size)
+{
+	if( count > (size_t)(s->wkb + s->wkb_size - s->pos) / size )
 		lwerror("WKB structure does not match expected size!");
 }
 
@@ -291,34 +301,62 @@ static uint32_t integer_from_wkb_state(wkb_parse_state *s)
 }
 
 /**
-* Double
-* Read an 8-byte double and advance the parse state forward.
+* Doubles
+* Copy n doubles out of the WKB array, reversing the bytes of each one.
+* This is a plain loop over 64-bit words, which compilers turn into
+* byte swap instructions, or vector shuffles where available.
 */
-static double double_from_wkb_state(wkb_parse_state *s)
+static void doubles_swap_from_wkb(double *dlist, const uint8_t *wkb, size_t n)
 {
-	double d = 0;
+	size_t i;
+	uint64_t v;
 
-	wkb_parse_state_check(s, WKB_DOUBLE_SIZE);
+	for( i = 0; i < n; i++ )
+	{
+		memcpy(&v, wkb + i * WKB_DOUBLE_SIZE, WKB_DOUBLE_SIZE);
+		v = ((v & 0x00000000000000FFULL) << 56) |
+		    ((v & 0x000000000000FF00ULL) << 40) |
+		    ((v & 0x0000000000FF0000ULL) << 24) |
+		    ((v & 0x00000000FF000000ULL) <<  8) |
+		    ((v & 0x000000FF00000000ULL) >>  8) |
+		    ((v & 0x0000FF0000000000ULL) >> 24) |
+		    ((v & 0x00FF000000000000ULL) >> 40) |
+		    ((v & 0xFF00000000000000ULL) >> 56);
+		memcpy(dlist + i, &v, WKB_DOUBLE_SIZE);
+	}
+}
 
-	memcpy(&d, s->pos, WKB_DOUBLE_SIZE);
+/**
+* Points
+* Read npoints points into a new point array and advance the parse state
+* forward. The whole block is checked once, then copied directly in our
+* native endianness, or with a single byte swapping pass otherwise.
+*/
+static POINTARRAY* ptarray_points_from_wkb_state(wkb_parse_state *s, uint32_t npoints)
+{
+	POINTARRAY *pa = NULL;
+	uint32_t ndims = 2;
 
-	/* Swap? Copy into a stack-allocated integer. */
-	if( s->swap_bytes )
-	{
-		int i = 0;
-		uint8_t tmp;
-		
-		for( i = 0; i < WKB_DOUBLE_SIZE/2; i++ )
-		{
-			tmp = ((uint8_t*)(&d))[i];
-			((uint8_t*)(&d))[i] = ((uint8_t*)(&d))[WKB_DOUBLE_SIZE - i - 1];
-			((uint8_t*)(&d))[WKB_DOUBLE_SIZE - i - 1] = tmp;
-		}
+	if( s->has_z ) ndims++;
+	if( s->has_m ) ndims++;
 
+	/* Does the data we want to read exist? */
+	wkb_parse_state_check_count(s, npoints, ndims * WKB_DOUBLE_SIZE);
+
+	/* If we're in a native endianness, we can just copy the data directly! */
+	if( ! s->swap_bytes )
+	{
+		pa = ptarray_construct_copy_data(s->has_z, s->has_m, npoints, s->pos);
+	}
+	/* Otherwise we have to flip each double. */
+	else
+	{
+		pa = ptarray_construct(s->has_z, s->has_m, npoints);
+		doubles_swap_from_wkb((double*)(pa->serialized_pointlist), s->pos, (size_t)npoints * ndims);
 	}
 
-	s->pos += WKB_DOUBLE_SIZE;
-	return d;
+	s->pos += (size_t)npoints * ndims * WKB_DOUBLE_SIZE;
+	return pa;
 }
 
 /**
@@ -328,9 +366,6 @@ static double double_from_wkb_state(wkb_parse_state *s)
 */
 static POINTARRAY* ptarray_from_wkb_state(wkb_parse_state *s)
 {
-	POINTARRAY *pa = NULL;
-	size_t pa_size;
-	uint32_t ndims = 2;
 	uint32_t npoints = 0;
 
 	/* Calculate the size of this point array. */
@@ -338,37 +373,11 @@ static POINTARRAY* ptarray_from_wkb_state(wkb_parse_state *s)
 
 	LWDEBUGF(4,"Pointarray has %d points", npoints);
 
-	if( s->has_z ) ndims++;
-	if( s->has_m ) ndims++;
-	pa_size = npoints * ndims * WKB_DOUBLE_SIZE;
-
 	/* Empty! */
 	if( npoints == 0 )
 		return ptarray_construct(s->has_z, s->has_m, npoints);
 
-	/* Does the data we want to read exist? */
-	wkb_parse_state_check(s, pa_size);
-	
-	/* If we're in a native endianness, we can just copy the data directly! */
-	if( ! s->swap_bytes )
-	{
-		pa = ptarray_construct_copy_data(s->has_z, s->has_m, npoints, (uint8_t*)s->pos);
-		s->pos += pa_size;
-	}
-	/* Otherwise we have to read each double, separately. */
-	else
-	{
-		int i = 0;
-		double *dlist;
-		pa = ptarray_construct(s->has_z, s->has_m, npoints);
-		dlist = (double*)(pa->serialized_pointlist);
-		for( i = 0; i < npoints * ndims; i++ )
-		{
-			dlist[i] = double_from_wkb_state(s);
-		}
-	}
-
-	return pa;
+	return ptarray_points_from_wkb_state(s, npoints);
 }
 
 /**
@@ -382,39 +391,9 @@ static POINTARRAY* ptarray_from_wkb_state(wkb_parse_state *s)
 */
 static LWPOINT* lwpoint_from_wkb_state(wkb_parse_state *s)
 {
-	static uint32_t npoints = 1;
-	POINTARRAY *pa = NULL;
-	size_t pa_size;
-	uint32_t ndims = 2;
+	POINTARRAY *pa = ptarray_points_from_wkb_state(s, 1);
 	const POINT2D *pt;
 
-	/* Count the dimensions. */
-	if( s->has_z ) ndims++;
-	if( s->has_m ) ndims++;
-	pa_size = ndims * WKB_DOUBLE_SIZE;
-
-	/* Does the data we want to read exist? */
-	wkb_parse_state_check(s, pa_size);
-
-	/* If we're in a native endianness, we can just copy the data directly! */
-	if( ! s->swap_bytes )
-	{
-		pa = ptarray_construct_copy_data(s->has_z, s->has_m, npoints, (uint8_t*)s->pos);
-		s->pos += pa_size;
-	}
-	/* Otherwise we have to read each double, separately */
-	else
-	{
-		int i = 0;
-		double *dlist;
-		pa = ptarray_construct(s->has_z, s->has_m, npoints);
-		dlist = (double*)(pa->serialized_pointlist);
-		for( i = 0; i < ndims; i++ )
-		{
-			dlist[i] = double_from_wkb_state(s);
-		}
-	}
-	
 	/* Check for POINT(NaN NaN) ==> POINT EMPTY */
 	pt = getPoint2d_cp(pa, 0);
 	if ( isnan(pt->x) && isnan(pt->y) )
@@ -503,6 +482,11 @@ static LWPOLY* lwpoly_from_wkb_state(wkb_parse_state *s)
 	if( nrings == 0 )
 		return poly;
 
+	/* Each ring starts with its point count, make room for all of them */
+	wkb_parse_state_check_count(s, nrings, WKB_INT_SIZE);
+	poly->rings = lwrealloc(poly->rings, nrings * sizeof(POINTARRAY*));
+	poly->maxrings = nrings;
+
 	for( i = 0; i < nrings; i++ )
 	{
 		POINTARRAY *pa = ptarray_from_wkb_state(s);
@@ -639,6 +623,10 @@ static LWCOLLECTION* lwcollection_from_wkb_state(wkb_parse_state *s)
 	if ( ngeoms == 0 )
 		return col;
 
+	/* Each member starts with its endian byte and type, make room for all of them */
+	wkb_parse_state_check_count(s, ngeoms, WKB_BYTE_SIZE + WKB_INT_SIZE);
+	lwcollection_reserve(col, ngeoms);
+
 	/* Be strict in polyhedral surface closures */
 	if ( s->lwtype == POLYHEDRALSURFACETYPE )
 		s->check |= LW_PARSER_CHECK_ZCLOSURE;
@@ -25,6 +25,8 @@
 
 #include <stdlib.h>
 #include <ctype.h> /* for isspace */
+#include <float.h> /* for FLT_EVAL_METHOD */
+#include <string.h> /* for strncasecmp */
 
 #include "lwin_wkt.h"
 #include "lwin_wkt_parse.h"
@@ -876,6 +878,454 @@ void wkt_parser_geometry_new(LWGEOM *geom, int srid)
 	global_parser_result.geom = geom;
 }
 
+/*
+* Hand-written reader for the common geometry types: POINT, LINESTRING,
+* POLYGON and their MULTI versions, with an optional SRID and Z/M tag.
+* A preflight scan of each coordinate list counts its points, so every
+* point array is allocated once at its final size and filled in place.
+*
+* Anything else (curves, collections, EMPTY members, mixed dimensions,
+* input the parse checks reject, oddly tokenized numbers...) is not
+* handled here: the reader gives up and the lexer and grammar take over,
+* reporting errors and their location as before.
+*/
+
+typedef struct
+{
+	const char *cur; /* Current parse position */
+	int check; /* Parser check flags */
+	int has_dims; /* Was there a Z/M tag? */
+	uint8_t flags; /* Z and M of the tag */
+} wkt_fast_state;
+
+static inline void
+wkt_fast_ws(wkt_fast_state *s)
+{
+	while ( *s->cur == ' ' || *s->cur == '\t' || *s->cur == '\n' || *s->cur == '\r' )
+		s->cur++;
+}
+
+static inline int
+wkt_fast_char(wkt_fast_state *s, char c)
+{
+	wkt_fast_ws(s);
+	if ( *s->cur != c )
+		return LW_FAILURE;
+	s->cur++;
+	return LW_SUCCESS;
+}
+
+static inline int
+wkt_fast_keyword(wkt_fast_state *s, const char *word)
+{
+	size_t len = strlen(word);
+	if ( strncasecmp(s->cur, word, len) )
+		return LW_FAILURE;
+	s->cur += len;
+	return LW_SUCCESS;
+}
+
+/* Exact powers of ten for the fast number conversion */
+static const double wkt_fast_pow10[] =
+{
+	1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+	1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+/**
+* Read a number the way the lexer would, and convert it like atof.
+* Up to 15 significant digits and an exponent within 22 are exactly
+* rounded with a single multiplication or division, longer numbers
+* go through strtod. Numbers must be followed by a space, a comma or
+* a closing bracket, so that the lexer would have seen the same token.
+*/
+static int
+wkt_fast_number(wkt_fast_state *s, double *d)
+{
+	const char *start, *p;
+	uint64_t mant = 0;
+	int ndigits = 0, nint = 0, nfrac = 0, exp10 = 0, expsign = 1;
+	int neg = 0;
+
+	wkt_fast_ws(s);
+	start = p = s->cur;
+
+	if ( *p == '-' )
+	{
+		neg = 1;
+		p++;
+	}
+
+	for ( ; *p >= '0' && *p <= '9'; p++, nint++ )
+	{
+		/* Leading zeros are not significant */
+		if ( ndigits || *p != '0' )
+		{
+			if ( ndigits < 19 )
+				mant = mant * 10 + (*p - '0');
+			ndigits++;
+		}
+	}
+
+	if ( *p == '.' )
+	{
+		for ( p++; *p >= '0' && *p <= '9'; p++, nfrac++ )
+		{
+			if ( ndigits || *p != '0' )
+			{
+				if ( ndigits < 19 )
+					mant = mant * 10 + (*p - '0');
+				ndigits++;
+			}
+		}
+	}
+
+	if ( ! nint && ! nfrac )
+		return LW_FAILURE;
+
+	/* An exponent needs digits after the decimal point, if any */
+	if ( (*p == 'e' || *p == 'E') && ! (p[-1] == '.') )
+	{
+		const char *e = p + 1;
+		if ( *e == '+' || *e == '-' )
+		{
+			if ( *e == '-' ) expsign = -1;
+			e++;
+		}
+		if ( *e >= '0' && *e <= '9' )
+		{
+			for ( p = e; *p >= '0' && *p <= '9'; p++ )
+			{
+				if ( exp10 < 10000 )
+					exp10 = exp10 * 10 + (*p - '0');
+			}
+		}
+	}
+
+	if ( ! (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r' || *p == ',' || *p == ')') )
+		return LW_FAILURE;
+	s->cur = p;
+
+	exp10 = expsign * exp10 - nfrac;
+
+#if defined(FLT_EVAL_METHOD) && FLT_EVAL_METHOD == 0
+	if ( ndigits <= 15 && exp10 >= -22 && exp10 <= 22 )
+	{
+		*d = exp10 < 0 ? mant / wkt_fast_pow10[-exp10] : mant * wkt_fast_pow10[exp10];
+		if ( neg ) *d = -*d;
+		return LW_SUCCESS;
+	}
+#endif
+
+	*d = strtod(start, NULL);
+	return LW_SUCCESS;
+}
+
+/**
+* Read a bracketed coordinate list, or a single bare coordinate, into a
+* new point array. A preflight scan up to the end of the list gives the
+* number of points and the number of ordinates of the first one, which
+* all points must share.
+*/
+static POINTARRAY*
+wkt_fast_ptarray(wkt_fast_state *s, int bare)
+{
+	POINTARRAY *pa;
+	const char *p;
+	uint32_t npoints = 1, i;
+	int ndims = 0, in_number = LW_FALSE, d;
+	double *pt;
+
+	if ( ! bare && wkt_fast_char(s, '(') == LW_FAILURE )
+		return NULL;
+
+	/* Preflight: count the points and the ordinates of the first one */
+	for ( p = s->cur; *p != ')' && ! (bare && *p == ','); p++ )
+	{
+		if ( *p == ',' )
+		{
+			npoints++;
+			in_number = LW_FALSE;
+		}
+		else if ( *p == ' ' || *p == '\t' || *p == '\n' || *p == '\r' )
+		{
+			in_number = LW_FALSE;
+		}
+		else if ( ! *p || *p == '(' )
+		{
+			return NULL;
+		}
+		else if ( ! in_number )
+		{
+			in_number = LW_TRUE;
+			if ( npoints == 1 ) ndims++;
+		}
+	}
+
+	if ( ndims < 2 || ndims > 4 )
+		return NULL;
+
+	/* A Z/M tag must match the ordinates, and then gives their meaning */
+	if ( s->has_dims )
+	{
+		if ( ndims != FLAGS_NDIMS(s->flags) )
+			return NULL;
+		pa = ptarray_construct(FLAGS_GET_Z(s->flags), FLAGS_GET_M(s->flags), npoints);
+	}
+	else
+	{
+		pa = ptarray_construct(ndims > 2, ndims > 3, npoints);
+	}
+
+	for ( i = 0; i < npoints; i++ )
+	{
+		pt = (double*) getPoint_internal(pa, i);
+		for ( d = 0; d < ndims; d++ )
+		{
+			if ( wkt_fast_number(s, pt + d) == LW_FAILURE )
+			{
+				ptarray_free(pa);
+				return NULL;
+			}
+		}
+		if ( ! (bare || wkt_fast_char(s, i + 1 < npoints ? ',' : ')') == LW_SUCCESS) )
+		{
+			ptarray_free(pa);
+			return NULL;
+		}
+	}
+
+	return pa;
+}
+
+/**
+* Read the rings of a polygon, applying the closure and minimum points
+* checks of wkt_parser_polygon_add_ring
+*/
+static LWPOLY*
+wkt_fast_polygon(wkt_fast_state *s)
+{
+	LWPOLY *poly = NULL;
+	POINTARRAY *pa;
+
+	if ( wkt_fast_char(s, '(') == LW_FAILURE )
+		return NULL;
+
+	do
+	{
+		pa = wkt_fast_ptarray(s, LW_FALSE);
+		if ( ! pa ||
+		     ( (s->check & LW_PARSER_CHECK_MINPOINTS) && pa->npoints < 4 ) ||
+		     ( (s->check & LW_PARSER_CHECK_CLOSURE) && ! ptarray_is_closed_2d(pa) ) ||
+		     ( poly && FLAGS_NDIMS(poly->flags) != FLAGS_NDIMS(pa->flags) ) )
+		{
+			if ( pa ) ptarray_free(pa);
+			if ( poly ) lwpoly_free(poly);
+			return NULL;
+		}
+
+		if ( ! poly )
+			poly = lwpoly_construct_empty(SRID_UNKNOWN, FLAGS_GET_Z(pa->flags), FLAGS_GET_M(pa->flags));
+		lwpoly_add_ring(poly, pa);
+		wkt_fast_ws(s);
+	}
+	while ( *s->cur++ == ',' );
+
+	if ( *(s->cur - 1) != ')' )
+	{
+		lwpoly_free(poly);
+		return NULL;
+	}
+	return poly;
+}
+
+/**
+* Read a single member of a geometry, untagged when part of a MULTI.
+* MULTIPOINT members may be bare coordinates.
+*/
+static LWGEOM*
+wkt_fast_member(wkt_fast_state *s, int type)
+{
+	POINTARRAY *pa;
+
+	switch ( type )
+	{
+	case POINTTYPE:
+		wkt_fast_ws(s);
+		pa = wkt_fast_ptarray(s, *s->cur != '(');
+		if ( pa && pa->npoints == 1 )
+			return lwpoint_as_lwgeom(lwpoint_construct(SRID_UNKNOWN, NULL, pa));
+		break;
+	case LINETYPE:
+		pa = wkt_fast_ptarray(s, LW_FALSE);
+		if ( pa && ! ( (s->check & LW_PARSER_CHECK_MINPOINTS) && pa->npoints < 2 ) )
+			return lwline_as_lwgeom(lwline_construct(SRID_UNKNOWN, NULL, pa));
+		break;
+	case POLYGONTYPE:
+		return lwpoly_as_lwgeom(wkt_fast_polygon(s));
+	default:
+		return NULL;
+	}
+
+	if ( pa ) ptarray_free(pa);
+	return NULL;
+}
+
+/**
+* Read the members of a MULTI geometry
+*/
+static LWGEOM*
+wkt_fast_multi(wkt_fast_state *s, int type, int subtype)
+{
+	LWCOLLECTION *col = NULL;
+	LWGEOM *geom;
+
+	if ( wkt_fast_char(s, '(') == LW_FAILURE )
+		return NULL;
+
+	do
+	{
+		geom = wkt_fast_member(s, subtype);
+
+		/* Members must share the dimensions of the first one */
+		if ( ! geom || ( col && FLAGS_NDIMS(col->flags) != FLAGS_NDIMS(geom->flags) ) )
+		{
+			if ( geom ) lwgeom_free(geom);
+			if ( col ) lwcollection_free(col);
+			return NULL;
+		}
+
+		if ( ! col )
+			col = lwcollection_construct_empty(type, SRID_UNKNOWN, FLAGS_GET_Z(geom->flags), FLAGS_GET_M(geom->flags));
+		lwcollection_add_lwgeom(col, geom);
+		wkt_fast_ws(s);
+	}
+	while ( *s->cur++ == ',' );
+
+	if ( *(s->cur - 1) != ')' )
+	{
+		lwcollection_free(col);
+		return NULL;
+	}
+	return lwcollection_as_lwgeom(col);
+}
+
+/**
+* Read a WKT string with the hand-written reader. Returns LW_FAILURE
+* without any error set when the input has to go through the grammar.
+*/
+int wkt_parser_fast(LWGEOM_PARSER_RESULT *parser_result, char *wktstr, int parser_check_flags)
+{
+	static const struct
+	{
+		const char *name;
+		int type;
+		int subtype;
+	}
+	types[] =
+	{
+		{ "POINT", POINTTYPE, 0 },
+		{ "LINESTRING", LINETYPE, 0 },
+		{ "POLYGON", POLYGONTYPE, 0 },
+		{ "MULTIPOINT", MULTIPOINTTYPE, POINTTYPE },
+		{ "MULTILINESTRING", MULTILINETYPE, LINETYPE },
+		{ "MULTIPOLYGON", MULTIPOLYGONTYPE, POLYGONTYPE }
+	};
+	wkt_fast_state s;
+	LWGEOM *geom = NULL;
+	char *sridstr = NULL;
+	int i, srid;
+
+	s.cur = wktstr;
+	s.check = parser_check_flags;
+	s.has_dims = LW_FALSE;
+	s.flags = 0;
+
+	wkt_fast_ws(&s);
+	if ( wkt_fast_keyword(&s, "SRID=") == LW_SUCCESS )
+	{
+		sridstr = (char*) s.cur - 5;
+		if ( *s.cur == '-' ) s.cur++;
+		if ( ! (*s.cur >= '0' && *s.cur <= '9') )
+			return LW_FAILURE;
+		while ( *s.cur >= '0' && *s.cur <= '9' )
+			s.cur++;
+		if ( wkt_fast_char(&s, ';') == LW_FAILURE )
+			return LW_FAILURE;
+		wkt_fast_ws(&s);
+	}
+
+	for ( i = 0; i < sizeof(types) / sizeof(types[0]); i++ )
+	{
+		if ( wkt_fast_keyword(&s, types[i].name) == LW_SUCCESS )
+			break;
+	}
+	if ( i == sizeof(types) / sizeof(types[0]) )
+		return LW_FAILURE;
+
+	/* The dimensionality tag, the lexer reads ZM before Z */
+	wkt_fast_ws(&s);
+	if ( wkt_fast_keyword(&s, "ZM") == LW_SUCCESS )
+		s.flags = gflags(1, 1, 0);
+	else if ( wkt_fast_keyword(&s, "Z") == LW_SUCCESS )
+		s.flags = gflags(1, 0, 0);
+	else if ( wkt_fast_keyword(&s, "M") == LW_SUCCESS )
+		s.flags = gflags(0, 1, 0);
+	s.has_dims = s.flags != 0;
+
+	wkt_fast_ws(&s);
+	if ( wkt_fast_keyword(&s, "EMPTY") == LW_SUCCESS )
+	{
+		int hasz = FLAGS_GET_Z(s.flags), hasm = FLAGS_GET_M(s.flags);
+		switch ( types[i].type )
+		{
+		case POINTTYPE:
+			geom = lwpoint_as_lwgeom(lwpoint_construct_empty(SRID_UNKNOWN, hasz, hasm));
+			break;
+		case LINETYPE:
+			geom = lwline_as_lwgeom(lwline_construct_empty(SRID_UNKNOWN, hasz, hasm));
+			break;
+		case POLYGONTYPE:
+			geom = lwpoly_as_lwgeom(lwpoly_construct_empty(SRID_UNKNOWN, hasz, hasm));
+			break;
+		default:
+			geom = lwcollection_as_lwgeom(lwcollection_construct_empty(types[i].type, SRID_UNKNOWN, hasz, hasm));
+			break;
+		}
+	}
+	else if ( *s.cur == '(' )
+	{
+		if ( types[i].subtype )
+			geom = wkt_fast_multi(&s, types[i].type, types[i].subtype);
+		else
+			geom = wkt_fast_member(&s, types[i].type);
+	}
+
+	if ( ! geom )
+		return LW_FAILURE;
+
+	/* Nothing but spaces may follow */
+	wkt_fast_ws(&s);
+	if ( *s.cur )
+	{
+		lwgeom_free(geom);
+		return LW_FAILURE;
+	}
+
+	/* Same SRID handling as the grammar, once the parse succeeded */
+	srid = sridstr ? wkt_lexer_read_srid(sridstr) : SRID_UNKNOWN;
+	if ( srid != SRID_UNKNOWN && srid < SRID_MAXIMUM )
+		lwgeom_set_srid(geom, srid);
+	else
+		lwgeom_set_srid(geom, SRID_UNKNOWN);
+
+	lwgeom_parser_result_init(parser_result);
+	parser_result->wkinput = wktstr;
+	parser_result->parser_check_flags = parser_check_flags;
+	parser_result->geom = geom;
+	return LW_SUCCESS;
+}
+
 void lwgeom_parser_result_init(LWGEOM_PARSER_RESULT *parser_result)
 {
 	memset(parser_result, 0, sizeof(LWGEOM_PARSER_RESULT));
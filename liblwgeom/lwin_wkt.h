@@ -79,3 +79,8 @@ LWGEOM* wkt_parser_collection_add_geom(LWGEOM *col, LWGEOM *geom);
 LWGEOM* wkt_parser_collection_finalize(int lwtype, LWGEOM *col, char *dimensionality);
 void    wkt_parser_geometry_new(LWGEOM *geom, int srid);
 
+/*
+* Hand-written reader for plain geometries, tried before the bison parser.
+*/
+int wkt_parser_fast(LWGEOM_PARSER_RESULT *parser_result, char *wktstr, int parser_check_flags);
+
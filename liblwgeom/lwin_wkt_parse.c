@@ -146,6 +146,10 @@ int lwgeom_parse_wkt(LWGEOM_PARSER_RESULT *parser_result, char *wktstr, int pars
 {
 	int parse_rv = 0;
 
+	/* Plain geometries are read without the lexer and grammar */
+	if ( wkt_parser_fast(parser_result, wktstr, parser_check_flags) == LW_SUCCESS )
+		return LW_SUCCESS;
+
 	/* Clean up our global parser result. */
 	lwgeom_parser_result_init(&global_parser_result);
 	/* Work-around possible bug in GNU Bison 3.0.2 resulting in wkt_yylloc
@@ -197,7 +201,7 @@ int lwgeom_parse_wkt(LWGEOM_PARSER_RESULT *parser_result, char *wktstr, int pars
 
 
 
-#line 178 "lwin_wkt_parse.c" /* yacc.c:339  */
+#line 182 "lwin_wkt_parse.c" /* yacc.c:339  */
 
 # ifndef YY_NULLPTR
 #  if defined __cplusplus && 201103L <= __cplusplus
@@ -287,7 +291,7 @@ extern int wkt_yydebug;
 
 union YYSTYPE
 {
-#line 108 "lwin_wkt_parse.y" /* yacc.c:355  */
+#line 112 "lwin_wkt_parse.y" /* yacc.c:355  */
 
 	int integervalue;
 	double doublevalue;
@@ -296,7 +300,7 @@ union YYSTYPE
 	POINT coordinatevalue;
 	POINTARRAY *ptarrayvalue;
 
-#line 277 "lwin_wkt_parse.c" /* yacc.c:355  */
+#line 281 "lwin_wkt_parse.c" /* yacc.c:355  */
 };
 
 typedef union YYSTYPE YYSTYPE;
@@ -327,7 +331,7 @@ int wkt_yyparse (void);
 
 /* Copy the second part of user declarations.  */
 
-#line 308 "lwin_wkt_parse.c" /* yacc.c:358  */
+#line 312 "lwin_wkt_parse.c" /* yacc.c:358  */
 
 #ifdef short
 # undef short
@@ -1408,219 +1412,219 @@ yydestruct (const char *yymsg, int yytype, YYSTYPE *yyvaluep, YYLTYPE *yylocatio
   switch (yytype)
     {
           case 28: /* geometry_no_srid  */
-#line 190 "lwin_wkt_parse.y" /* yacc.c:1257  */
+#line 194 "lwin_wkt_parse.y" /* yacc.c:1257  */
       { lwgeom_free(((*yyvaluep).geometryvalue)); }
-#line 1391 "lwin_wkt_parse.c" /* yacc.c:1257  */
+#line 1395 "lwin_wkt_parse.c" /* yacc.c:1257  */
         break;
 
     case 29: /* geometrycollection  */
-#line 191 "lwin_wkt_parse.y" /* yacc.c:1257  */
+#line 195 "lwin_wkt_parse.y" /* yacc.c:1257  */
       { lwgeom_free(((*yyvaluep).geometryvalue)); }
-#line 1397 "lwin_wkt_parse.c" /* yacc.c:1257  */
+#line 1401 "lwin_wkt_parse.c" /* yacc.c:1257  */
         break;
 
     case 31: /* multisurface  */
-#line 198 "lwin_wkt_parse.y" /* yacc.c:1257  */
+#line 202 "lwin_wkt_parse.y" /* yacc.c:1257  */
       { lwgeom_free(((*yyvaluep).geometryvalue)); }
-#line 1403 "lwin_wkt_parse.c" /* yacc.c:1257  */
+#line 1407 "lwin_wkt_parse.c" /* yacc.c:1257  */
         break;
 
     case 32: /* surface_list  */
-#line 177 "lwin_wkt_parse.y" /* yacc.c:1257  */
+#line 181 "lwin_wkt_parse.y" /* yacc.c:1257  */
       { lwgeom_free(((*yyvaluep).geometryvalue)); }
-#line 1409 "lwin_wkt_parse.c" /* yacc.c:1257  */
+#line 1413 "lwin_wkt_parse.c" /* yacc.c:1257  */
         break;
 
     case 33: /* tin  */
-#line 205 "lwin_wkt_parse.y" /* yacc.c:1257  */
+#line 209 "lwin_wkt_parse.y" /* yacc.c:1257  */
       { lwgeom_free(((*yyvaluep).geometryvalue)); }
-#line 1415 "lwin_wkt_parse.c" /* yacc.c:1257  */
+#line 1419 "lwin_wkt_parse.c" /* yacc.c:1257  */
         break;
 
     case 34: /* polyhedralsurface  */
-#line 204 "lwin_wkt_parse.y" /* yacc.c:1257  */
+#line 208 "lwin_wkt_parse.y" /* yacc.c:1257  */
       { lwgeom_free(((*yyvaluep).geometryvalue)); }
-#line 1421 "lwin_wkt_parse.c" /* yacc.c:1257  */
+#line 1425 "lwin_wkt_parse.c" /* yacc.c:1257  */
         break;
 
     case 35: /* multipolygon  */
-#line 197 "lwin_wkt_parse.y" /* yacc.c:1257  */
+#line 201 "lwin_wkt_parse.y" /* yacc.c:1257  */
       { lwgeom_free(((*yyvaluep).geometryvalue)); }
-#line 1427 "lwin_wkt_parse.c" /* yacc.c:1257  */
+#line 1431 "lwin_wkt_parse.c" /* yacc.c:1257  */
         break;
 
     case 36: /* polygon_list  */
-#line 178 "lwin_wkt_parse.y" /* yacc.c:1257  */
+#line 182 "lwin_wkt_parse.y" /* yacc.c:1257  */
       { lwgeom_free(((*yyvaluep).geometryvalue)); }
-#line 1433 "lwin_wkt_parse.c" /* yacc.c:1257  */
+#line 1437 "lwin_wkt_parse.c" /* yacc.c:1257  */
         break;
 
     case 37: /* patch_list  */
-#line 179 "lwin_wkt_parse.y" /* yacc.c:1257  */
+#line 183 "lwin_wkt_parse.y" /* yacc.c:1257  */
       { lwgeom_free(((*yyvaluep).geometryvalue)); }
-#line 1439 "lwin_wkt_parse.c" /* yacc.c:1257  */
+#line 1443 "lwin_wkt_parse.c" /* yacc.c:1257  */
         break;
 
     case 38: /* polygon  */
-#line 201 "lwin_wkt_parse.y" /* yacc.c:1257  */
+#line 205 "lwin_wkt_parse.y" /* yacc.c:1257  */
       { lwgeom_free(((*yyvaluep).geometryvalue)); }
-#line 1445 "lwin_wkt_parse.c" /* yacc.c:1257  */
+#line 1449 "lwin_wkt_parse.c" /* yacc.c:1257  */
         break;
 
     case 39: /* polygon_untagged  */
-#line 203 "lwin_wkt_parse.y" /* yacc.c:1257  */
+#line 207 "lwin_wkt_parse.y" /* yacc.c:1257  */
       { lwgeom_free(((*yyvaluep).geometryvalue)); }
-#line 1451 "lwin_wkt_parse.c" /* yacc.c:1257  */
+#line 1455 "lwin_wkt_parse.c" /* yacc.c:1257  */
         break;
 
     case 40: /* patch  */
-#line 202 "lwin_wkt_parse.y" /* yacc.c:1257  */
+#line 206 "lwin_wkt_parse.y" /* yacc.c:1257  */
       { lwgeom_free(((*yyvaluep).geometryvalue)); }
-#line 1457 "lwin_wkt_parse.c" /* yacc.c:1257  */
+#line 1461 "lwin_wkt_parse.c" /* yacc.c:1257  */
         break;
 
     case 41: /* curvepolygon  */
-#line 188 "lwin_wkt_parse.y" /* yacc.c:1257  */
+#line 192 "lwin_wkt_parse.y" /* yacc.c:1257  */
       { lwgeom_free(((*yyvaluep).geometryvalue)); }
-#line 1463 "lwin_wkt_parse.c" /* yacc.c:1257  */
+#line 1467 "lwin_wkt_parse.c" /* yacc.c:1257  */
         break;
 
     case 42: /* curvering_list  */
-#line 175 "lwin_wkt_parse.y" /* yacc.c:1257  */
+#line 179 "lwin_wkt_parse.y" /* yacc.c:1257  */
       { lwgeom_free(((*yyvaluep).geometryvalue)); }
-#line 1469 "lwin_wkt_parse.c" /* yacc.c:1257  */
+#line 1473 "lwin_wkt_parse.c" /* yacc.c:1257  */
         break;
 
     case 43: /* curvering  */
-#line 189 "lwin_wkt_parse.y" /* yacc.c:1257  */
+#line 193 "lwin_wkt_parse.y" /* yacc.c:1257  */
       { lwgeom_free(((*yyvaluep).geometryvalue)); }
-#line 1475 "lwin_wkt_parse.c" /* yacc.c:1257  */
+#line 1479 "lwin_wkt_parse.c" /* yacc.c:1257  */
         break;
 
     case 44: /* patchring_list  */
-#line 185 "lwin_wkt_parse.y" /* yacc.c:1257  */
+#line 189 "lwin_wkt_parse.y" /* yacc.c:1257  */
       { lwgeom_free(((*yyvaluep).geometryvalue)); }
-#line 1481 "lwin_wkt_parse.c" /* yacc.c:1257  */
+#line 1485 "lwin_wkt_parse.c" /* yacc.c:1257  */
         break;
 
     case 45: /* ring_list  */
-#line 184 "lwin_wkt_parse.y" /* yacc.c:1257  */
+#line 188 "lwin_wkt_parse.y" /* yacc.c:1257  */
       { lwgeom_free(((*yyvaluep).geometryvalue)); }
-#line 1487 "lwin_wkt_parse.c" /* yacc.c:1257  */
+#line 1491 "lwin_wkt_parse.c" /* yacc.c:1257  */
         break;
 
     case 46: /* patchring  */
-#line 174 "lwin_wkt_parse.y" /* yacc.c:1257  */
+#line 178 "lwin_wkt_parse.y" /* yacc.c:1257  */
       { ptarray_free(((*yyvaluep).ptarrayvalue)); }
-#line 1493 "lwin_wkt_parse.c" /* yacc.c:1257  */
+#line 1497 "lwin_wkt_parse.c" /* yacc.c:1257  */
         break;
 
     case 47: /* ring  */
-#line 173 "lwin_wkt_parse.y" /* yacc.c:1257  */
+#line 177 "lwin_wkt_parse.y" /* yacc.c:1257  */
       { ptarray_free(((*yyvaluep).ptarrayvalue)); }
-#line 1499 "lwin_wkt_parse.c" /* yacc.c:1257  */
+#line 1503 "lwin_wkt_parse.c" /* yacc.c:1257  */
         break;
 
     case 48: /* compoundcurve  */
-#line 187 "lwin_wkt_parse.y" /* yacc.c:1257  */
+#line 191 "lwin_wkt_parse.y" /* yacc.c:1257  */
       { lwgeom_free(((*yyvaluep).geometryvalue)); }
-#line 1505 "lwin_wkt_parse.c" /* yacc.c:1257  */
+#line 1509 "lwin_wkt_parse.c" /* yacc.c:1257  */
         break;
 
     case 49: /* compound_list  */
-#line 183 "lwin_wkt_parse.y" /* yacc.c:1257  */
+#line 187 "lwin_wkt_parse.y" /* yacc.c:1257  */
       { lwgeom_free(((*yyvaluep).geometryvalue)); }
-#line 1511 "lwin_wkt_parse.c" /* yacc.c:1257  */
+#line 1515 "lwin_wkt_parse.c" /* yacc.c:1257  */
         break;
 
     case 50: /* multicurve  */
-#line 194 "lwin_wkt_parse.y" /* yacc.c:1257  */
+#line 198 "lwin_wkt_parse.y" /* yacc.c:1257  */
       { lwgeom_free(((*yyvaluep).geometryvalue)); }
-#line 1517 "lwin_wkt_parse.c" /* yacc.c:1257  */
+#line 1521 "lwin_wkt_parse.c" /* yacc.c:1257  */
         break;
 
     case 51: /* curve_list  */
-#line 182 "lwin_wkt_parse.y" /* yacc.c:1257  */
+#line 186 "lwin_wkt_parse.y" /* yacc.c:1257  */
       { lwgeom_free(((*yyvaluep).geometryvalue)); }
-#line 1523 "lwin_wkt_parse.c" /* yacc.c:1257  */
+#line 1527 "lwin_wkt_parse.c" /* yacc.c:1257  */
         break;
 
     case 52: /* multilinestring  */
-#line 195 "lwin_wkt_parse.y" /* yacc.c:1257  */
+#line 199 "lwin_wkt_parse.y" /* yacc.c:1257  */
       { lwgeom_free(((*yyvaluep).geometryvalue)); }
-#line 1529 "lwin_wkt_parse.c" /* yacc.c:1257  */
+#line 1533 "lwin_wkt_parse.c" /* yacc.c:1257  */
         break;
 
     case 53: /* linestring_list  */
-#line 181 "lwin_wkt_parse.y" /* yacc.c:1257  */
+#line 185 "lwin_wkt_parse.y" /* yacc.c:1257  */
       { lwgeom_free(((*yyvaluep).geometryvalue)); }
-#line 1535 "lwin_wkt_parse.c" /* yacc.c:1257  */
+#line 1539 "lwin_wkt_parse.c" /* yacc.c:1257  */
         break;
 
     case 54: /* circularstring  */
-#line 186 "lwin_wkt_parse.y" /* yacc.c:1257  */
+#line 190 "lwin_wkt_parse.y" /* yacc.c:1257  */
       { lwgeom_free(((*yyvaluep).geometryvalue)); }
-#line 1541 "lwin_wkt_parse.c" /* yacc.c:1257  */
+#line 1545 "lwin_wkt_parse.c" /* yacc.c:1257  */
         break;
 
     case 55: /* linestring  */
-#line 192 "lwin_wkt_parse.y" /* yacc.c:1257  */
+#line 196 "lwin_wkt_parse.y" /* yacc.c:1257  */
       { lwgeom_free(((*yyvaluep).geometryvalue)); }
-#line 1547 "lwin_wkt_parse.c" /* yacc.c:1257  */
+#line 1551 "lwin_wkt_parse.c" /* yacc.c:1257  */
         break;
 
     case 56: /* linestring_untagged  */
-#line 193 "lwin_wkt_parse.y" /* yacc.c:1257  */
+#line 197 "lwin_wkt_parse.y" /* yacc.c:1257  */
       { lwgeom_free(((*yyvaluep).geometryvalue)); }
-#line 1553 "lwin_wkt_parse.c" /* yacc.c:1257  */
+#line 1557 "lwin_wkt_parse.c" /* yacc.c:1257  */
         break;
 
     case 57: /* triangle_list  */
-#line 176 "lwin_wkt_parse.y" /* yacc.c:1257  */
+#line 180 "lwin_wkt_parse.y" /* yacc.c:1257  */
       { lwgeom_free(((*yyvaluep).geometryvalue)); }
-#line 1559 "lwin_wkt_parse.c" /* yacc.c:1257  */
+#line 1563 "lwin_wkt_parse.c" /* yacc.c:1257  */
         break;
 
     case 58: /* triangle  */
-#line 206 "lwin_wkt_parse.y" /* yacc.c:1257  */
+#line 210 "lwin_wkt_parse.y" /* yacc.c:1257  */
       { lwgeom_free(((*yyvaluep).geometryvalue)); }
-#line 1565 "lwin_wkt_parse.c" /* yacc.c:1257  */
+#line 1569 "lwin_wkt_parse.c" /* yacc.c:1257  */
         break;
 
     case 59: /* triangle_untagged  */
-#line 207 "lwin_wkt_parse.y" /* yacc.c:1257  */
+#line 211 "lwin_wkt_parse.y" /* yacc.c:1257  */
       { lwgeom_free(((*yyvaluep).geometryvalue)); }
-#line 1571 "lwin_wkt_parse.c" /* yacc.c:1257  */
+#line 1575 "lwin_wkt_parse.c" /* yacc.c:1257  */
         break;
 
     case 60: /* multipoint  */
-#line 196 "lwin_wkt_parse.y" /* yacc.c:1257  */
+#line 200 "lwin_wkt_parse.y" /* yacc.c:1257  */
       { lwgeom_free(((*yyvaluep).geometryvalue)); }
-#line 1577 "lwin_wkt_parse.c" /* yacc.c:1257  */
+#line 1581 "lwin_wkt_parse.c" /* yacc.c:1257  */
         break;
 
     case 61: /* point_list  */
-#line 180 "lwin_wkt_parse.y" /* yacc.c:1257  */
+#line 184 "lwin_wkt_parse.y" /* yacc.c:1257  */
       { lwgeom_free(((*yyvaluep).geometryvalue)); }
-#line 1583 "lwin_wkt_parse.c" /* yacc.c:1257  */
+#line 1587 "lwin_wkt_parse.c" /* yacc.c:1257  */
         break;
 
     case 62: /* point_untagged  */
-#line 200 "lwin_wkt_parse.y" /* yacc.c:1257  */
+#line 204 "lwin_wkt_parse.y" /* yacc.c:1257  */
       { lwgeom_free(((*yyvaluep).geometryvalue)); }
-#line 1589 "lwin_wkt_parse.c" /* yacc.c:1257  */
+#line 1593 "lwin_wkt_parse.c" /* yacc.c:1257  */
         break;
 
     case 63: /* point  */
-#line 199 "lwin_wkt_parse.y" /* yacc.c:1257  */
+#line 203 "lwin_wkt_parse.y" /* yacc.c:1257  */
       { lwgeom_free(((*yyvaluep).geometryvalue)); }
-#line 1595 "lwin_wkt_parse.c" /* yacc.c:1257  */
+#line 1599 "lwin_wkt_parse.c" /* yacc.c:1257  */
         break;
 
     case 64: /* ptarray  */
-#line 172 "lwin_wkt_parse.y" /* yacc.c:1257  */
+#line 176 "lwin_wkt_parse.y" /* yacc.c:1257  */
       { ptarray_free(((*yyvaluep).ptarrayvalue)); }
-#line 1601 "lwin_wkt_parse.c" /* yacc.c:1257  */
+#line 1605 "lwin_wkt_parse.c" /* yacc.c:1257  */
         break;
 
 
@@ -1906,817 +1910,817 @@ yyreduce:
   switch (yyn)
     {
         case 2:
-#line 213 "lwin_wkt_parse.y" /* yacc.c:1646  */
+#line 217 "lwin_wkt_parse.y" /* yacc.c:1646  */
     { wkt_parser_geometry_new((yyvsp[0].geometryvalue), SRID_UNKNOWN); WKT_ERROR(); }
-#line 1889 "lwin_wkt_parse.c" /* yacc.c:1646  */
+#line 1893 "lwin_wkt_parse.c" /* yacc.c:1646  */
     break;
 
   case 3:
-#line 215 "lwin_wkt_parse.y" /* yacc.c:1646  */
+#line 219 "lwin_wkt_parse.y" /* yacc.c:1646  */
     { wkt_parser_geometry_new((yyvsp[0].geometryvalue), (yyvsp[-2].integervalue)); WKT_ERROR(); }
-#line 1895 "lwin_wkt_parse.c" /* yacc.c:1646  */
+#line 1899 "lwin_wkt_parse.c" /* yacc.c:1646  */
     break;
 
   case 4:
-#line 218 "lwin_wkt_parse.y" /* yacc.c:1646  */
+#line 222 "lwin_wkt_parse.y" /* yacc.c:1646  */
     { (yyval.geometryvalue) = (yyvsp[0].geometryvalue); }
-#line 1901 "lwin_wkt_parse.c" /* yacc.c:1646  */
+#line 1905 "lwin_wkt_parse.c" /* yacc.c:1646  */
     break;
 
   case 5:
-#line 219 "lwin_wkt_parse.y" /* yacc.c:1646  */
+#line 223 "lwin_wkt_parse.y" /* yacc.c:1646  */
     { (yyval.geometryvalue) = (yyvsp[0].geometryvalue); }
-#line 1907 "lwin_wkt_parse.c" /* yacc.c:1646  */
+#line 1911 "lwin_wkt_parse.c" /* yacc.c:1646  */
     break;
 
   case 6:
-#line 220 "lwin_wkt_parse.y" /* yacc.c:1646  */
+#line 224 "lwin_wkt_parse.y" /* yacc.c:1646  */
     { (yyval.geometryvalue) = (yyvsp[0].geometryvalue); }
-#line 1913 "lwin_wkt_parse.c" /* yacc.c:1646  */
+#line 1917 "lwin_wkt_parse.c" /* yacc.c:1646  */
     break;
 
   case 7:
-#line 221 "lwin_wkt_parse.y" /* yacc.c:1646  */
+#line 225 "lwin_wkt_parse.y" /* yacc.c:1646  */
     { (yyval.geometryvalue) = (yyvsp[0].geometryvalue); }
-#line 1919 "lwin_wkt_parse.c" /* yacc.c:1646  */
+#line 1923 "lwin_wkt_parse.c" /* yacc.c:1646  */
     break;
 
   case 8:
-#line 222 "lwin_wkt_parse.y" /* yacc.c:1646  */
+#line 226 "lwin_wkt_parse.y" /* yacc.c:1646  */
     { (yyval.geometryvalue) = (yyvsp[0].geometryvalue); }
-#line 1925 "lwin_wkt_parse.c" /* yacc.c:1646  */
+#line 1929 "lwin_wkt_parse.c" /* yacc.c:1646  */
     break;
 
   case 9:
-#line 223 "lwin_wkt_parse.y" /* yacc.c:1646  */
+#line 227 "lwin_wkt_parse.y" /* yacc.c:1646  */
     { (yyval.geometryvalue) = (yyvsp[0].geometryvalue); }
-#line 1931 "lwin_wkt_parse.c" /* yacc.c:1646  */
+#line 1935 "lwin_wkt_parse.c" /* yacc.c:1646  */
     break;
 
   case 10:
-#line 224 "lwin_wkt_parse.y" /* yacc.c:1646  */
+#line 228 "lwin_wkt_parse.y" /* yacc.c:1646  */
     { (yyval.geometryvalue) = (yyvsp[0].geometryvalue); }
-#line 1937 "lwin_wkt_parse.c" /* yacc.c:1646  */
+#line 1941 "lwin_wkt_parse.c" /* yacc.c:1646  */
     break;
 
   case 11:
-#line 225 "lwin_wkt_parse.y" /* yacc.c:1646  */
+#line 229 "lwin_wkt_parse.y" /* yacc.c:1646  */
     { (yyval.geometryvalue) = (yyvsp[0].geometryvalue); }
-#line 1943 "lwin_wkt_parse.c" /* yacc.c:1646  */
+#line 1947 "lwin_wkt_parse.c" /* yacc.c:1646  */
     break;
 
   case 12:
-#line 226 "lwin_wkt_parse.y" /* yacc.c:1646  */
+#line 230 "lwin_wkt_parse.y" /* yacc.c:1646  */
     { (yyval.geometryvalue) = (yyvsp[0].geometryvalue); }
-#line 1949 "lwin_wkt_parse.c" /* yacc.c:1646  */
+#line 1953 "lwin_wkt_parse.c" /* yacc.c:1646  */
     break;
 
   case 13:
-#line 227 "lwin_wkt_parse.y" /* yacc.c:1646  */
+#line 231 "lwin_wkt_parse.y" /* yacc.c:1646  */
     { (yyval.geometryvalue) = (yyvsp[0].geometryvalue); }
-#line 1955 "lwin_wkt_parse.c" /* yacc.c:1646  */
+#line 1959 "lwin_wkt_parse.c" /* yacc.c:1646  */
     break;
 
   case 14:
-#line 228 "lwin_wkt_parse.y" /* yacc.c:1646  */
+#line 232 "lwin_wkt_parse.y" /* yacc.c:1646  */
     { (yyval.geometryvalue) = (yyvsp[0].geometryvalue); }
-#line 1961 "lwin_wkt_parse.c" /* yacc.c:1646  */
+#line 1965 "lwin_wkt_parse.c" /* yacc.c:1646  */
     break;
 
   case 15:
-#line 229 "lwin_wkt_parse.y" /* yacc.c:1646  */
+#line 233 "lwin_wkt_parse.y" /* yacc.c:1646  */
     { (yyval.geometryvalue) = (yyvsp[0].geometryvalue); }
-#line 1967 "lwin_wkt_parse.c" /* yacc.c:1646  */
+#line 1971 "lwin_wkt_parse.c" /* yacc.c:1646  */
     break;
 
   case 16:
-#line 230 "lwin_wkt_parse.y" /* yacc.c:1646  */
+#line 234 "lwin_wkt_parse.y" /* yacc.c:1646  */
     { (yyval.geometryvalue) = (yyvsp[0].geometryvalue); }
-#line 1973 "lwin_wkt_parse.c" /* yacc.c:1646  */
+#line 1977 "lwin_wkt_parse.c" /* yacc.c:1646  */
     break;
 
   case 17:
-#line 231 "lwin_wkt_parse.y" /* yacc.c:1646  */
+#line 235 "lwin_wkt_parse.y" /* yacc.c:1646  */
     { (yyval.geometryvalue) = (yyvsp[0].geometryvalue); }
-#line 1979 "lwin_wkt_parse.c" /* yacc.c:1646  */
+#line 1983 "lwin_wkt_parse.c" /* yacc.c:1646  */
     break;
 
   case 18:
-#line 232 "lwin_wkt_parse.y" /* yacc.c:1646  */
+#line 236 "lwin_wkt_parse.y" /* yacc.c:1646  */
     { (yyval.geometryvalue) = (yyvsp[0].geometryvalue); }
-#line 1985 "lwin_wkt_parse.c" /* yacc.c:1646  */
+#line 1989 "lwin_wkt_parse.c" /* yacc.c:1646  */
     break;
 
   case 19:
-#line 236 "lwin_wkt_parse.y" /* yacc.c:1646  */
+#line 240 "lwin_wkt_parse.y" /* yacc.c:1646  */
     { (yyval.geometryvalue) = wkt_parser_collection_finalize(COLLECTIONTYPE, (yyvsp[-1].geometryvalue), NULL); WKT_ERROR(); }
-#line 1991 "lwin_wkt_parse.c" /* yacc.c:1646  */
+#line 1995 "lwin_wkt_parse.c" /* yacc.c:1646  */
     break;
 
   case 20:
-#line 238 "lwin_wkt_parse.y" /* yacc.c:1646  */
+#line 242 "lwin_wkt_parse.y" /* yacc.c:1646  */
     { (yyval.geometryvalue) = wkt_parser_collection_finalize(COLLECTIONTYPE, (yyvsp[-1].geometryvalue), (yyvsp[-3].stringvalue)); WKT_ERROR(); }
-#line 1997 "lwin_wkt_parse.c" /* yacc.c:1646  */
+#line 2001 "lwin_wkt_parse.c" /* yacc.c:1646  */
     break;
 
   case 21:
-#line 240 "lwin_wkt_parse.y" /* yacc.c:1646  */
+#line 244 "lwin_wkt_parse.y" /* yacc.c:1646  */
     { (yyval.geometryvalue) = wkt_parser_collection_finalize(COLLECTIONTYPE, NULL, (yyvsp[-1].stringvalue)); WKT_ERROR(); }
-#line 2003 "lwin_wkt_parse.c" /* yacc.c:1646  */
+#line 2007 "lwin_wkt_parse.c" /* yacc.c:1646  */
     break;
 
   case 22:
-#line 242 "lwin_wkt_parse.y" /* yacc.c:1646  */
+#line 246 "lwin_wkt_parse.y" /* yacc.c:1646  */
     { (yyval.geometryvalue) = wkt_parser_collection_finalize(COLLECTIONTYPE, NULL, NULL); WKT_ERROR(); }
-#line 2009 "lwin_wkt_parse.c" /* yacc.c:1646  */
+#line 2013 "lwin_wkt_parse.c" /* yacc.c:1646  */
     break;
 
   case 23:
-#line 246 "lwin_wkt_parse.y" /* yacc.c:1646  */
+#line 250 "lwin_wkt_parse.y" /* yacc.c:1646  */
     { (yyval.geometryvalue) = wkt_parser_collection_add_geom((yyvsp[-2].geometryvalue),(yyvsp[0].geometryvalue)); WKT_ERROR(); }
-#line 2015 "lwin_wkt_parse.c" /* yacc.c:1646  */
+#line 2019 "lwin_wkt_parse.c" /* yacc.c:1646  */
     break;
 
   case 24:
-#line 248 "lwin_wkt_parse.y" /* yacc.c:1646  */
+#line 252 "lwin_wkt_parse.y" /* yacc.c:1646  */
     { (yyval.geometryvalue) = wkt_parser_collection_new((yyvsp[0].geometryvalue)); WKT_ERROR(); }
-#line 2021 "lwin_wkt_parse.c" /* yacc.c:1646  */
+#line 2025 "lwin_wkt_parse.c" /* yacc.c:1646  */
     break;
 
   case 25:
-#line 252 "lwin_wkt_parse.y" /* yacc.c:1646  */
+#line 256 "lwin_wkt_parse.y" /* yacc.c:1646  */
     { (yyval.geometryvalue) = wkt_parser_collection_finalize(MULTISURFACETYPE, (yyvsp[-1].geometryvalue), NULL); WKT_ERROR(); }
-#line 2027 "lwin_wkt_parse.c" /* yacc.c:1646  */
+#line 2031 "lwin_wkt_parse.c" /* yacc.c:1646  */
     break;
 
   case 26:
-#line 254 "lwin_wkt_parse.y" /* yacc.c:1646  */
+#line 258 "lwin_wkt_parse.y" /* yacc.c:1646  */
     { (yyval.geometryvalue) = wkt_parser_collection_finalize(MULTISURFACETYPE, (yyvsp[-1].geometryvalue), (yyvsp[-3].stringvalue)); WKT_ERROR(); }
-#line 2033 "lwin_wkt_parse.c" /* yacc.c:1646  */
+#line 2037 "lwin_wkt_parse.c" /* yacc.c:1646  */
     break;
 
   case 27:
-#line 256 "lwin_wkt_parse.y" /* yacc.c:1646  */
+#line 260 "lwin_wkt_parse.y" /* yacc.c:1646  */
     { (yyval.geometryvalue) = wkt_parser_collection_finalize(MULTISURFACETYPE, NULL, (yyvsp[-1].stringvalue)); WKT_ERROR(); }
-#line 2039 "lwin_wkt_parse.c" /* yacc.c:1646  */
+#line 2043 "lwin_wkt_parse.c" /* yacc.c:1646  */
     break;
 
   case 28:
-#line 258 "lwin_wkt_parse.y" /* yacc.c:1646  */
+#line 262 "lwin_wkt_parse.y" /* yacc.c:1646  */
     { (yyval.geometryvalue) = wkt_parser_collection_finalize(MULTISURFACETYPE, NULL, NULL); WKT_ERROR(); }
-#line 2045 "lwin_wkt_parse.c" /* yacc.c:1646  */
+#line 2049 "lwin_wkt_parse.c" /* yacc.c:1646  */
     break;
 
   case 29:
-#line 262 "lwin_wkt_parse.y" /* yacc.c:1646  */
+#line 266 "lwin_wkt_parse.y" /* yacc.c:1646  */
     { (yyval.geometryvalue) = wkt_parser_collection_add_geom((yyvsp[-2].geometryvalue),(yyvsp[0].geometryvalue)); WKT_ERROR(); }
-#line 2051 "lwin_wkt_parse.c" /* yacc.c:1646  */
+#line 2055 "lwin_wkt_parse.c" /* yacc.c:1646  */
     break;
 
   case 30:
-#line 264 "lwin_wkt_parse.y" /* yacc.c:1646  */
+#line 268 "lwin_wkt_parse.y" /* yacc.c:1646  */
     { (yyval.geometryvalue) = wkt_parser_collection_add_geom((yyvsp[-2].geometryvalue),(yyvsp[0].geometryvalue)); WKT_ERROR(); }
-#line 2057 "lwin_wkt_parse.c" /* yacc.c:1646  */
+#line 2061 "lwin_wkt_parse.c" /* yacc.c:1646  */
     break;
 
   case 31:
-#line 266 "lwin_wkt_parse.y" /* yacc.c:1646  */
+#line 270 "lwin_wkt_parse.y" /* yacc.c:1646  */
     { (yyval.geometryvalue) = wkt_parser_collection_add_geom((yyvsp[-2].geometryvalue),(yyvsp[0].geometryvalue)); WKT_ERROR(); }
-#line 2063 "lwin_wkt_parse.c" /* yacc.c:1646  */
+#line 2067 "lwin_wkt_parse.c" /* yacc.c:1646  */
     break;
 
   case 32:
-#line 268 "lwin_wkt_parse.y" /* yacc.c:1646  */
+#line 272 "lwin_wkt_parse.y" /* yacc.c:1646  */
     { (yyval.geometryvalue) = wkt_parser_collection_new((yyvsp[0].geometryvalue)); WKT_ERROR(); }
-#line 2069 "lwin_wkt_parse.c" /* yacc.c:1646  */
+#line 2073 "lwin_wkt_parse.c" /* yacc.c:1646  */
     break;
 
   case 33:
-#line 270 "lwin_wkt_parse.y" /* yacc.c:1646  */
+#line 274 "lwin_wkt_parse.y" /* yacc.c:1646  */
     { (yyval.geometryvalue) = wkt_parser_collection_new((yyvsp[0].geometryvalue)); WKT_ERROR(); }
-#line 2075 "lwin_wkt_parse.c" /* yacc.c:1646  */
+#line 2079 "lwin_wkt_parse.c" /* yacc.c:1646  */
     break;
 
   case 34:
-#line 272 "lwin_wkt_parse.y" /* yacc.c:1646  */
+#line 276 "lwin_wkt_parse.y" /* yacc.c:1646  */
     { (yyval.geometryvalue) = wkt_parser_collection_new((yyvsp[0].geometryvalue)); WKT_ERROR(); }
-#line 2081 "lwin_wkt_parse.c" /* yacc.c:1646  */
+#line 2085 "lwin_wkt_parse.c" /* yacc.c:1646  */
     break;
 
   case 35:
-#line 276 "lwin_wkt_parse.y" /* yacc.c:1646  */
+#line 280 "lwin_wkt_parse.y" /* yacc.c:1646  */
     { (yyval.geometryvalue) = wkt_parser_collection_finalize(TINTYPE, (yyvsp[-1].geometryvalue), NULL); WKT_ERROR(); }
-#line 2087 "lwin_wkt_parse.c" /* yacc.c:1646  */
+#line 2091 "lwin_wkt_parse.c" /* yacc.c:1646  */
     break;
 
   case 36:
-#line 278 "lwin_wkt_parse.y" /* yacc.c:1646  */
+#line 282 "lwin_wkt_parse.y" /* yacc.c:1646  */
     { (yyval.geometryvalue) = wkt_parser_collection_finalize(TINTYPE, (yyvsp[-1].geometryvalue), (yyvsp[-3].stringvalue)); WKT_ERROR(); }
-#line 2093 "lwin_wkt_parse.c" /* yacc.c:1646  */
+#line 2097 "lwin_wkt_parse.c" /* yacc.c:1646  */
     break;
 
   case 37:
-#line 280 "lwin_wkt_parse.y" /* yacc.c:1646  */
+#line 284 "lwin_wkt_parse.y" /* yacc.c:1646  */
     { (yyval.geometryvalue) = wkt_parser_collection_finalize(TINTYPE, NULL, (yyvsp[-1].stringvalue)); WKT_ERROR(); }
-#line 2099 "lwin_wkt_parse.c" /* yacc.c:1646  */
+#line 2103 "lwin_wkt_parse.c" /* yacc.c:1646  */
     break;
 
   case 38:
-#line 282 "lwin_wkt_parse.y" /* yacc.c:1646  */
+#line 286 "lwin_wkt_parse.y" /* yacc.c:1646  */
     { (yyval.geometryvalue) = wkt_parser_collection_finalize(TINTYPE, NULL, NULL); WKT_ERROR(); }
-#line 2105 "lwin_wkt_parse.c" /* yacc.c:1646  */
+#line 2109 "lwin_wkt_parse.c" /* yacc.c:1646  */
     break;
 
   case 39:
-#line 286 "lwin_wkt_parse.y" /* yacc.c:1646  */
+#line 290 "lwin_wkt_parse.y" /* yacc.c:1646  */
     { (yyval.geometryvalue) = wkt_parser_collection_finalize(POLYHEDRALSURFACETYPE, (yyvsp[-1].geometryvalue), NULL); WKT_ERROR(); }
-#line 2111 "lwin_wkt_parse.c" /* yacc.c:1646  */
+#line 2115 "lwin_wkt_parse.c" /* yacc.c:1646  */
     break;
 
   case 40:
-#line 288 "lwin_wkt_parse.y" /* yacc.c:1646  */
+#line 292 "lwin_wkt_parse.y" /* yacc.c:1646  */
     { (yyval.geometryvalue) = wkt_parser_collection_finalize(POLYHEDRALSURFACETYPE, (yyvsp[-1].geometryvalue), (yyvsp[-3].stringvalue)); WKT_ERROR(); }
-#line 2117 "lwin_wkt_parse.c" /* yacc.c:1646  */
+#line 2121 "lwin_wkt_parse.c" /* yacc.c:1646  */
     break;
 
   case 41:
-#line 290 "lwin_wkt_parse.y" /* yacc.c:1646  */
+#line 294 "lwin_wkt_parse.y" /* yacc.c:1646  */
     { (yyval.geometryvalue) = wkt_parser_collection_finalize(POLYHEDRALSURFACETYPE, NULL, (yyvsp[-1].stringvalue)); WKT_ERROR(); }
-#line 2123 "lwin_wkt_parse.c" /* yacc.c:1646  */
+#line 2127 "lwin_wkt_parse.c" /* yacc.c:1646  */
     break;
 
   case 42:
-#line 292 "lwin_wkt_parse.y" /* yacc.c:1646  */
+#line 296 "lwin_wkt_parse.y" /* yacc.c:1646  */
     { (yyval.geometryvalue) = wkt_parser_collection_finalize(POLYHEDRALSURFACETYPE, NULL, NULL); WKT_ERROR(); }
-#line 2129 "lwin_wkt_parse.c" /* yacc.c:1646  */
+#line 2133 "lwin_wkt_parse.c" /* yacc.c:1646  */
     break;
 
   case 43:
-#line 296 "lwin_wkt_parse.y" /* yacc.c:1646  */
+#line 300 "lwin_wkt_parse.y" /* yacc.c:1646  */
     { (yyval.geometryvalue) = wkt_parser_collection_finalize(MULTIPOLYGONTYPE, (yyvsp[-1].geometryvalue), NULL); WKT_ERROR(); }
-#line 2135 "lwin_wkt_parse.c" /* yacc.c:1646  */
+#line 2139 "lwin_wkt_parse.c" /* yacc.c:1646  */
     break;
 
   case 44:
-#line 298 "lwin_wkt_parse.y" /* yacc.c:1646  */
+#line 302 "lwin_wkt_parse.y" /* yacc.c:1646  */
     { (yyval.geometryvalue) = wkt_parser_collection_finalize(MULTIPOLYGONTYPE, (yyvsp[-1].geometryvalue), (yyvsp[-3].stringvalue)); WKT_ERROR(); }
-#line 2141 "lwin_wkt_parse.c" /* yacc.c:1646  */
+#line 2145 "lwin_wkt_parse.c" /* yacc.c:1646  */
     break;
 
   case 45:
-#line 300 "lwin_wkt_parse.y" /* yacc.c:1646  */
+#line 304 "lwin_wkt_parse.y" /* yacc.c:1646  */
     { (yyval.geometryvalue) = wkt_parser_collection_finalize(MULTIPOLYGONTYPE, NULL, (yyvsp[-1].stringvalue)); WKT_ERROR(); }
-#line 2147 "lwin_wkt_parse.c" /* yacc.c:1646  */
+#line 2151 "lwin_wkt_parse.c" /* yacc.c:1646  */
     break;
 
   case 46:
-#line 302 "lwin_wkt_parse.y" /* yacc.c:1646  */
+#line 306 "lwin_wkt_parse.y" /* yacc.c:1646  */
     { (yyval.geometryvalue) = wkt_parser_collection_finalize(MULTIPOLYGONTYPE, NULL, NULL); WKT_ERROR(); }
-#line 2153 "lwin_wkt_parse.c" /* yacc.c:1646  */
+#line 2157 "lwin_wkt_parse.c" /* yacc.c:1646  */
     break;
 
   case 47:
-#line 306 "lwin_wkt_parse.y" /* yacc.c:1646  */
+#line 310 "lwin_wkt_parse.y" /* yacc.c:1646  */
     { (yyval.geometryvalue) = wkt_parser_collection_add_geom((yyvsp[-2].geometryvalue),(yyvsp[0].geometryvalue)); WKT_ERROR(); }
-#line 2159 "lwin_wkt_parse.c" /* yacc.c:1646  */
+#line 2163 "lwin_wkt_parse.c" /* yacc.c:1646  */
     break;
 
   case 48:
-#line 308 "lwin_wkt_parse.y" /* yacc.c:1646  */
+#line 312 "lwin_wkt_parse.y" /* yacc.c:1646  */
     { (yyval.geometryvalue) = wkt_parser_collection_new((yyvsp[0].geometryvalue)); WKT_ERROR(); }
-#line 2165 "lwin_wkt_parse.c" /* yacc.c:1646  */
+#line 2169 "lwin_wkt_parse.c" /* yacc.c:1646  */
     break;
 
   case 49:
-#line 312 "lwin_wkt_parse.y" /* yacc.c:1646  */
+#line 316 "lwin_wkt_parse.y" /* yacc.c:1646  */
     { (yyval.geometryvalue) = wkt_parser_collection_add_geom((yyvsp[-2].geometryvalue),(yyvsp[0].geometryvalue)); WKT_ERROR(); }
-#line 2171 "lwin_wkt_parse.c" /* yacc.c:1646  */
+#line 2175 "lwin_wkt_parse.c" /* yacc.c:1646  */
     break;
 
   case 50:
-#line 314 "lwin_wkt_parse.y" /* yacc.c:1646  */
+#line 318 "lwin_wkt_parse.y" /* yacc.c:1646  */
     { (yyval.geometryvalue) = wkt_parser_collection_new((yyvsp[0].geometryvalue)); WKT_ERROR(); }
-#line 2177 "lwin_wkt_parse.c" /* yacc.c:1646  */
+#line 2181 "lwin_wkt_parse.c" /* yacc.c:1646  */
     break;
 
   case 51:
-#line 318 "lwin_wkt_parse.y" /* yacc.c:1646  */
+#line 322 "lwin_wkt_parse.y" /* yacc.c:1646  */
     { (yyval.geometryvalue) = wkt_parser_polygon_finalize((yyvsp[-1].geometryvalue), NULL); WKT_ERROR(); }
-#line 2183 "lwin_wkt_parse.c" /* yacc.c:1646  */
+#line 2187 "lwin_wkt_parse.c" /* yacc.c:1646  */
     break;
 
   case 52:
-#line 320 "lwin_wkt_parse.y" /* yacc.c:1646  */
+#line 324 "lwin_wkt_parse.y" /* yacc.c:1646  */
     { (yyval.geometryvalue) = wkt_parser_polygon_finalize((yyvsp[-1].geometryvalue), (yyvsp[-3].stringvalue)); WKT_ERROR(); }
-#line 2189 "lwin_wkt_parse.c" /* yacc.c:1646  */
+#line 2193 "lwin_wkt_parse.c" /* yacc.c:1646  */
     break;
 
   case 53:
-#line 322 "lwin_wkt_parse.y" /* yacc.c:1646  */
+#line 326 "lwin_wkt_parse.y" /* yacc.c:1646  */
     { (yyval.geometryvalue) = wkt_parser_polygon_finalize(NULL, (yyvsp[-1].stringvalue)); WKT_ERROR(); }
-#line 2195 "lwin_wkt_parse.c" /* yacc.c:1646  */
+#line 2199 "lwin_wkt_parse.c" /* yacc.c:1646  */
     break;
 
   case 54:
-#line 324 "lwin_wkt_parse.y" /* yacc.c:1646  */
+#line 328 "lwin_wkt_parse.y" /* yacc.c:1646  */
     { (yyval.geometryvalue) = wkt_parser_polygon_finalize(NULL, NULL); WKT_ERROR(); }
-#line 2201 "lwin_wkt_parse.c" /* yacc.c:1646  */
+#line 2205 "lwin_wkt_parse.c" /* yacc.c:1646  */
     break;
 
   case 55:
-#line 328 "lwin_wkt_parse.y" /* yacc.c:1646  */
+#line 332 "lwin_wkt_parse.y" /* yacc.c:1646  */
     { (yyval.geometryvalue) = (yyvsp[-1].geometryvalue); }
-#line 2207 "lwin_wkt_parse.c" /* yacc.c:1646  */
+#line 2211 "lwin_wkt_parse.c" /* yacc.c:1646  */
     break;
 
   case 56:
-#line 330 "lwin_wkt_parse.y" /* yacc.c:1646  */
+#line 334 "lwin_wkt_parse.y" /* yacc.c:1646  */
     { (yyval.geometryvalue) = wkt_parser_polygon_finalize(NULL, NULL); WKT_ERROR(); }
-#line 2213 "lwin_wkt_parse.c" /* yacc.c:1646  */
+#line 2217 "lwin_wkt_parse.c" /* yacc.c:1646  */
     break;
 
   case 57:
-#line 333 "lwin_wkt_parse.y" /* yacc.c:1646  */
+#line 337 "lwin_wkt_parse.y" /* yacc.c:1646  */
     { (yyval.geometryvalue) = (yyvsp[-1].geometryvalue); }
-#line 2219 "lwin_wkt_parse.c" /* yacc.c:1646  */
+#line 2223 "lwin_wkt_parse.c" /* yacc.c:1646  */
     break;
 
   case 58:
-#line 337 "lwin_wkt_parse.y" /* yacc.c:1646  */
+#line 341 "lwin_wkt_parse.y" /* yacc.c:1646  */
     { (yyval.geometryvalue) = wkt_parser_curvepolygon_finalize((yyvsp[-1].geometryvalue), NULL); WKT_ERROR(); }
-#line 2225 "lwin_wkt_parse.c" /* yacc.c:1646  */
+#line 2229 "lwin_wkt_parse.c" /* yacc.c:1646  */
     break;
 
   case 59:
-#line 339 "lwin_wkt_parse.y" /* yacc.c:1646  */
+#line 343 "lwin_wkt_parse.y" /* yacc.c:1646  */
     { (yyval.geometryvalue) = wkt_parser_curvepolygon_finalize((yyvsp[-1].geometryvalue), (yyvsp[-3].stringvalue)); WKT_ERROR(); }
-#line 2231 "lwin_wkt_parse.c" /* yacc.c:1646  */
+#line 2235 "lwin_wkt_parse.c" /* yacc.c:1646  */
     break;
 
   case 60:
-#line 341 "lwin_wkt_parse.y" /* yacc.c:1646  */
+#line 345 "lwin_wkt_parse.y" /* yacc.c:1646  */
     { (yyval.geometryvalue) = wkt_parser_curvepolygon_finalize(NULL, (yyvsp[-1].stringvalue)); WKT_ERROR(); }
-#line 2237 "lwin_wkt_parse.c" /* yacc.c:1646  */
+#line 2241 "lwin_wkt_parse.c" /* yacc.c:1646  */
     break;
 
   case 61:
-#line 343 "lwin_wkt_parse.y" /* yacc.c:1646  */
+#line 347 "lwin_wkt_parse.y" /* yacc.c:1646  */
     { (yyval.geometryvalue) = wkt_parser_curvepolygon_finalize(NULL, NULL); WKT_ERROR(); }
-#line 2243 "lwin_wkt_parse.c" /* yacc.c:1646  */
+#line 2247 "lwin_wkt_parse.c" /* yacc.c:1646  */
     break;
 
   case 62:
-#line 347 "lwin_wkt_parse.y" /* yacc.c:1646  */
+#line 351 "lwin_wkt_parse.y" /* yacc.c:1646  */
     { (yyval.geometryvalue) = wkt_parser_curvepolygon_add_ring((yyvsp[-2].geometryvalue),(yyvsp[0].geometryvalue)); WKT_ERROR(); }
-#line 2249 "lwin_wkt_parse.c" /* yacc.c:1646  */
+#line 2253 "lwin_wkt_parse.c" /* yacc.c:1646  */
     break;
 
   case 63:
-#line 349 "lwin_wkt_parse.y" /* yacc.c:1646  */
+#line 353 "lwin_wkt_parse.y" /* yacc.c:1646  */
     { (yyval.geometryvalue) = wkt_parser_curvepolygon_new((yyvsp[0].geometryvalue)); WKT_ERROR(); }
-#line 2255 "lwin_wkt_parse.c" /* yacc.c:1646  */
+#line 2259 "lwin_wkt_parse.c" /* yacc.c:1646  */
     break;
 
   case 64:
-#line 352 "lwin_wkt_parse.y" /* yacc.c:1646  */
+#line 356 "lwin_wkt_parse.y" /* yacc.c:1646  */
     { (yyval.geometryvalue) = (yyvsp[0].geometryvalue); }
-#line 2261 "lwin_wkt_parse.c" /* yacc.c:1646  */
+#line 2265 "lwin_wkt_parse.c" /* yacc.c:1646  */
     break;
 
   case 65:
-#line 353 "lwin_wkt_parse.y" /* yacc.c:1646  */
+#line 357 "lwin_wkt_parse.y" /* yacc.c:1646  */
     { (yyval.geometryvalue) = (yyvsp[0].geometryvalue); }
-#line 2267 "lwin_wkt_parse.c" /* yacc.c:1646  */
+#line 2271 "lwin_wkt_parse.c" /* yacc.c:1646  */
     break;
 
   case 66:
-#line 354 "lwin_wkt_parse.y" /* yacc.c:1646  */
+#line 358 "lwin_wkt_parse.y" /* yacc.c:1646  */
     { (yyval.geometryvalue) = (yyvsp[0].geometryvalue); }
-#line 2273 "lwin_wkt_parse.c" /* yacc.c:1646  */
+#line 2277 "lwin_wkt_parse.c" /* yacc.c:1646  */
     break;
 
   case 67:
-#line 355 "lwin_wkt_parse.y" /* yacc.c:1646  */
+#line 359 "lwin_wkt_parse.y" /* yacc.c:1646  */
     { (yyval.geometryvalue) = (yyvsp[0].geometryvalue); }
-#line 2279 "lwin_wkt_parse.c" /* yacc.c:1646  */
+#line 2283 "lwin_wkt_parse.c" /* yacc.c:1646  */
     break;
 
   case 68:
-#line 359 "lwin_wkt_parse.y" /* yacc.c:1646  */
+#line 363 "lwin_wkt_parse.y" /* yacc.c:1646  */
     { (yyval.geometryvalue) = wkt_parser_polygon_add_ring((yyvsp[-2].geometryvalue),(yyvsp[0].ptarrayvalue),'Z'); WKT_ERROR(); }
-#line 2285 "lwin_wkt_parse.c" /* yacc.c:1646  */
+#line 2289 "lwin_wkt_parse.c" /* yacc.c:1646  */
     break;
 
   case 69:
-#line 361 "lwin_wkt_parse.y" /* yacc.c:1646  */
+#line 365 "lwin_wkt_parse.y" /* yacc.c:1646  */
     { (yyval.geometryvalue) = wkt_parser_polygon_new((yyvsp[0].ptarrayvalue),'Z'); WKT_ERROR(); }
-#line 2291 "lwin_wkt_parse.c" /* yacc.c:1646  */
+#line 2295 "lwin_wkt_parse.c" /* yacc.c:1646  */
     break;
 
   case 70:
-#line 365 "lwin_wkt_parse.y" /* yacc.c:1646  */
+#line 369 "lwin_wkt_parse.y" /* yacc.c:1646  */
     { (yyval.geometryvalue) = wkt_parser_polygon_add_ring((yyvsp[-2].geometryvalue),(yyvsp[0].ptarrayvalue),'2'); WKT_ERROR(); }
-#line 2297 "lwin_wkt_parse.c" /* yacc.c:1646  */
+#line 2301 "lwin_wkt_parse.c" /* yacc.c:1646  */
     break;
 
   case 71:
-#line 367 "lwin_wkt_parse.y" /* yacc.c:1646  */
+#line 371 "lwin_wkt_parse.y" /* yacc.c:1646  */
     { (yyval.geometryvalue) = wkt_parser_polygon_new((yyvsp[0].ptarrayvalue),'2'); WKT_ERROR(); }
-#line 2303 "lwin_wkt_parse.c" /* yacc.c:1646  */
+#line 2307 "lwin_wkt_parse.c" /* yacc.c:1646  */
     break;
 
   case 72:
-#line 370 "lwin_wkt_parse.y" /* yacc.c:1646  */
+#line 374 "lwin_wkt_parse.y" /* yacc.c:1646  */
     { (yyval.ptarrayvalue) = (yyvsp[-1].ptarrayvalue); }
-#line 2309 "lwin_wkt_parse.c" /* yacc.c:1646  */
+#line 2313 "lwin_wkt_parse.c" /* yacc.c:1646  */
     break;
 
   case 73:
-#line 373 "lwin_wkt_parse.y" /* yacc.c:1646  */
+#line 377 "lwin_wkt_parse.y" /* yacc.c:1646  */
     { (yyval.ptarrayvalue) = (yyvsp[-1].ptarrayvalue); }
-#line 2315 "lwin_wkt_parse.c" /* yacc.c:1646  */
+#line 2319 "lwin_wkt_parse.c" /* yacc.c:1646  */
     break;
 
   case 74:
-#line 377 "lwin_wkt_parse.y" /* yacc.c:1646  */
+#line 381 "lwin_wkt_parse.y" /* yacc.c:1646  */
     { (yyval.geometryvalue) = wkt_parser_collection_finalize(COMPOUNDTYPE, (yyvsp[-1].geometryvalue), NULL); WKT_ERROR(); }
-#line 2321 "lwin_wkt_parse.c" /* yacc.c:1646  */
+#line 2325 "lwin_wkt_parse.c" /* yacc.c:1646  */
     break;
 
   case 75:
-#line 379 "lwin_wkt_parse.y" /* yacc.c:1646  */
+#line 383 "lwin_wkt_parse.y" /* yacc.c:1646  */
     { (yyval.geometryvalue) = wkt_parser_collection_finalize(COMPOUNDTYPE, (yyvsp[-1].geometryvalue), (yyvsp[-3].stringvalue)); WKT_ERROR(); }
-#line 2327 "lwin_wkt_parse.c" /* yacc.c:1646  */
+#line 2331 "lwin_wkt_parse.c" /* yacc.c:1646  */
     break;
 
   case 76:
-#line 381 "lwin_wkt_parse.y" /* yacc.c:1646  */
+#line 385 "lwin_wkt_parse.y" /* yacc.c:1646  */
     { (yyval.geometryvalue) = wkt_parser_collection_finalize(COMPOUNDTYPE, NULL, (yyvsp[-1].stringvalue)); WKT_ERROR(); }
-#line 2333 "lwin_wkt_parse.c" /* yacc.c:1646  */
+#line 2337 "lwin_wkt_parse.c" /* yacc.c:1646  */
     break;
 
   case 77:
-#line 383 "lwin_wkt_parse.y" /* yacc.c:1646  */
+#line 387 "lwin_wkt_parse.y" /* yacc.c:1646  */
     { (yyval.geometryvalue) = wkt_parser_collection_finalize(COMPOUNDTYPE, NULL, NULL); WKT_ERROR(); }
-#line 2339 "lwin_wkt_parse.c" /* yacc.c:1646  */
+#line 2343 "lwin_wkt_parse.c" /* yacc.c:1646  */
     break;
 
   case 78:
-#line 387 "lwin_wkt_parse.y" /* yacc.c:1646  */
+#line 391 "lwin_wkt_parse.y" /* yacc.c:1646  */
     { (yyval.geometryvalue) = wkt_parser_compound_add_geom((yyvsp[-2].geometryvalue),(yyvsp[0].geometryvalue)); WKT_ERROR(); }
-#line 2345 "lwin_wkt_parse.c" /* yacc.c:1646  */
+#line 2349 "lwin_wkt_parse.c" /* yacc.c:1646  */
     break;
 
   case 79:
-#line 389 "lwin_wkt_parse.y" /* yacc.c:1646  */
+#line 393 "lwin_wkt_parse.y" /* yacc.c:1646  */
     { (yyval.geometryvalue) = wkt_parser_compound_add_geom((yyvsp[-2].geometryvalue),(yyvsp[0].geometryvalue)); WKT_ERROR(); }
-#line 2351 "lwin_wkt_parse.c" /* yacc.c:1646  */
+#line 2355 "lwin_wkt_parse.c" /* yacc.c:1646  */
     break;
 
   case 80:
-#line 391 "lwin_wkt_parse.y" /* yacc.c:1646  */
+#line 395 "lwin_wkt_parse.y" /* yacc.c:1646  */
     { (yyval.geometryvalue) = wkt_parser_compound_add_geom((yyvsp[-2].geometryvalue),(yyvsp[0].geometryvalue)); WKT_ERROR(); }
-#line 2357 "lwin_wkt_parse.c" /* yacc.c:1646  */
+#line 2361 "lwin_wkt_parse.c" /* yacc.c:1646  */
     break;
 
   case 81:
-#line 393 "lwin_wkt_parse.y" /* yacc.c:1646  */
+#line 397 "lwin_wkt_parse.y" /* yacc.c:1646  */
     { (yyval.geometryvalue) = wkt_parser_compound_new((yyvsp[0].geometryvalue)); WKT_ERROR(); }
-#line 2363 "lwin_wkt_parse.c" /* yacc.c:1646  */
+#line 2367 "lwin_wkt_parse.c" /* yacc.c:1646  */
     break;
 
   case 82:
-#line 395 "lwin_wkt_parse.y" /* yacc.c:1646  */
+#line 399 "lwin_wkt_parse.y" /* yacc.c:1646  */
     { (yyval.geometryvalue) = wkt_parser_compound_new((yyvsp[0].geometryvalue)); WKT_ERROR(); }
-#line 2369 "lwin_wkt_parse.c" /* yacc.c:1646  */
+#line 2373 "lwin_wkt_parse.c" /* yacc.c:1646  */
     break;
 
   case 83:
-#line 397 "lwin_wkt_parse.y" /* yacc.c:1646  */
+#line 401 "lwin_wkt_parse.y" /* yacc.c:1646  */
     { (yyval.geometryvalue) = wkt_parser_compound_new((yyvsp[0].geometryvalue)); WKT_ERROR(); }
-#line 2375 "lwin_wkt_parse.c" /* yacc.c:1646  */
+#line 2379 "lwin_wkt_parse.c" /* yacc.c:1646  */
     break;
 
   case 84:
-#line 401 "lwin_wkt_parse.y" /* yacc.c:1646  */
+#line 405 "lwin_wkt_parse.y" /* yacc.c:1646  */
     { (yyval.geometryvalue) = wkt_parser_collection_finalize(MULTICURVETYPE, (yyvsp[-1].geometryvalue), NULL); WKT_ERROR(); }
-#line 2381 "lwin_wkt_parse.c" /* yacc.c:1646  */
+#line 2385 "lwin_wkt_parse.c" /* yacc.c:1646  */
     break;
 
   case 85:
-#line 403 "lwin_wkt_parse.y" /* yacc.c:1646  */
+#line 407 "lwin_wkt_parse.y" /* yacc.c:1646  */
     { (yyval.geometryvalue) = wkt_parser_collection_finalize(MULTICURVETYPE, (yyvsp[-1].geometryvalue), (yyvsp[-3].stringvalue)); WKT_ERROR(); }
-#line 2387 "lwin_wkt_parse.c" /* yacc.c:1646  */
+#line 2391 "lwin_wkt_parse.c" /* yacc.c:1646  */
     break;
 
   case 86:
-#line 405 "lwin_wkt_parse.y" /* yacc.c:1646  */
+#line 409 "lwin_wkt_parse.y" /* yacc.c:1646  */
     { (yyval.geometryvalue) = wkt_parser_collection_finalize(MULTICURVETYPE, NULL, (yyvsp[-1].stringvalue)); WKT_ERROR(); }
-#line 2393 "lwin_wkt_parse.c" /* yacc.c:1646  */
+#line 2397 "lwin_wkt_parse.c" /* yacc.c:1646  */
     break;
 
   case 87:
-#line 407 "lwin_wkt_parse.y" /* yacc.c:1646  */
+#line 411 "lwin_wkt_parse.y" /* yacc.c:1646  */
     { (yyval.geometryvalue) = wkt_parser_collection_finalize(MULTICURVETYPE, NULL, NULL); WKT_ERROR(); }
-#line 2399 "lwin_wkt_parse.c" /* yacc.c:1646  */
+#line 2403 "lwin_wkt_parse.c" /* yacc.c:1646  */
     break;
 
   case 88:
-#line 411 "lwin_wkt_parse.y" /* yacc.c:1646  */
+#line 415 "lwin_wkt_parse.y" /* yacc.c:1646  */
     { (yyval.geometryvalue) = wkt_parser_collection_add_geom((yyvsp[-2].geometryvalue),(yyvsp[0].geometryvalue)); WKT_ERROR(); }
-#line 2405 "lwin_wkt_parse.c" /* yacc.c:1646  */
+#line 2409 "lwin_wkt_parse.c" /* yacc.c:1646  */
     break;
 
   case 89:
-#line 413 "lwin_wkt_parse.y" /* yacc.c:1646  */
+#line 417 "lwin_wkt_parse.y" /* yacc.c:1646  */
     { (yyval.geometryvalue) = wkt_parser_collection_add_geom((yyvsp[-2].geometryvalue),(yyvsp[0].geometryvalue)); WKT_ERROR(); }
-#line 2411 "lwin_wkt_parse.c" /* yacc.c:1646  */
+#line 2415 "lwin_wkt_parse.c" /* yacc.c:1646  */
     break;
 
   case 90:
-#line 415 "lwin_wkt_parse.y" /* yacc.c:1646  */
+#line 419 "lwin_wkt_parse.y" /* yacc.c:1646  */
     { (yyval.geometryvalue) = wkt_parser_collection_add_geom((yyvsp[-2].geometryvalue),(yyvsp[0].geometryvalue)); WKT_ERROR(); }
-#line 2417 "lwin_wkt_parse.c" /* yacc.c:1646  */
+#line 2421 "lwin_wkt_parse.c" /* yacc.c:1646  */
     break;
 
   case 91:
-#line 417 "lwin_wkt_parse.y" /* yacc.c:1646  */
+#line 421 "lwin_wkt_parse.y" /* yacc.c:1646  */
     { (yyval.geometryvalue) = wkt_parser_collection_add_geom((yyvsp[-2].geometryvalue),(yyvsp[0].geometryvalue)); WKT_ERROR(); }
-#line 2423 "lwin_wkt_parse.c" /* yacc.c:1646  */
+#line 2427 "lwin_wkt_parse.c" /* yacc.c:1646  */
     break;
 
   case 92:
-#line 419 "lwin_wkt_parse.y" /* yacc.c:1646  */
+#line 423 "lwin_wkt_parse.y" /* yacc.c:1646  */
     { (yyval.geometryvalue) = wkt_parser_collection_new((yyvsp[0].geometryvalue)); WKT_ERROR(); }
-#line 2429 "lwin_wkt_parse.c" /* yacc.c:1646  */
+#line 2433 "lwin_wkt_parse.c" /* yacc.c:1646  */
     break;
 
   case 93:
-#line 421 "lwin_wkt_parse.y" /* yacc.c:1646  */
+#line 425 "lwin_wkt_parse.y" /* yacc.c:1646  */
     { (yyval.geometryvalue) = wkt_parser_collection_new((yyvsp[0].geometryvalue)); WKT_ERROR(); }
-#line 2435 "lwin_wkt_parse.c" /* yacc.c:1646  */
+#line 2439 "lwin_wkt_parse.c" /* yacc.c:1646  */
     break;
 
   case 94:
-#line 423 "lwin_wkt_parse.y" /* yacc.c:1646  */
+#line 427 "lwin_wkt_parse.y" /* yacc.c:1646  */
     { (yyval.geometryvalue) = wkt_parser_collection_new((yyvsp[0].geometryvalue)); WKT_ERROR(); }
-#line 2441 "lwin_wkt_parse.c" /* yacc.c:1646  */
+#line 2445 "lwin_wkt_parse.c" /* yacc.c:1646  */
     break;
 
   case 95:
-#line 425 "lwin_wkt_parse.y" /* yacc.c:1646  */
+#line 429 "lwin_wkt_parse.y" /* yacc.c:1646  */
     { (yyval.geometryvalue) = wkt_parser_collection_new((yyvsp[0].geometryvalue)); WKT_ERROR(); }
-#line 2447 "lwin_wkt_parse.c" /* yacc.c:1646  */
+#line 2451 "lwin_wkt_parse.c" /* yacc.c:1646  */
     break;
 
   case 96:
-#line 429 "lwin_wkt_parse.y" /* yacc.c:1646  */
+#line 433 "lwin_wkt_parse.y" /* yacc.c:1646  */
     { (yyval.geometryvalue) = wkt_parser_collection_finalize(MULTILINETYPE, (yyvsp[-1].geometryvalue), NULL); WKT_ERROR(); }
-#line 2453 "lwin_wkt_parse.c" /* yacc.c:1646  */
+#line 2457 "lwin_wkt_parse.c" /* yacc.c:1646  */
     break;
 
   case 97:
-#line 431 "lwin_wkt_parse.y" /* yacc.c:1646  */
+#line 435 "lwin_wkt_parse.y" /* yacc.c:1646  */
     { (yyval.geometryvalue) = wkt_parser_collection_finalize(MULTILINETYPE, (yyvsp[-1].geometryvalue), (yyvsp[-3].stringvalue)); WKT_ERROR(); }
-#line 2459 "lwin_wkt_parse.c" /* yacc.c:1646  */
+#line 2463 "lwin_wkt_parse.c" /* yacc.c:1646  */
     break;
 
   case 98:
-#line 433 "lwin_wkt_parse.y" /* yacc.c:1646  */
+#line 437 "lwin_wkt_parse.y" /* yacc.c:1646  */
     { (yyval.geometryvalue) = wkt_parser_collection_finalize(MULTILINETYPE, NULL, (yyvsp[-1].stringvalue)); WKT_ERROR(); }
-#line 2465 "lwin_wkt_parse.c" /* yacc.c:1646  */
+#line 2469 "lwin_wkt_parse.c" /* yacc.c:1646  */
     break;
 
   case 99:
-#line 435 "lwin_wkt_parse.y" /* yacc.c:1646  */
+#line 439 "lwin_wkt_parse.y" /* yacc.c:1646  */
     { (yyval.geometryvalue) = wkt_parser_collection_finalize(MULTILINETYPE, NULL, NULL); WKT_ERROR(); }
-#line 2471 "lwin_wkt_parse.c" /* yacc.c:1646  */
+#line 2475 "lwin_wkt_parse.c" /* yacc.c:1646  */
     break;
 
   case 100:
-#line 439 "lwin_wkt_parse.y" /* yacc.c:1646  */
+#line 443 "lwin_wkt_parse.y" /* yacc.c:1646  */
     { (yyval.geometryvalue) = wkt_parser_collection_add_geom((yyvsp[-2].geometryvalue),(yyvsp[0].geometryvalue)); WKT_ERROR(); }
-#line 2477 "lwin_wkt_parse.c" /* yacc.c:1646  */
+#line 2481 "lwin_wkt_parse.c" /* yacc.c:1646  */
     break;
 
   case 101:
-#line 441 "lwin_wkt_parse.y" /* yacc.c:1646  */
+#line 445 "lwin_wkt_parse.y" /* yacc.c:1646  */
     { (yyval.geometryvalue) = wkt_parser_collection_new((yyvsp[0].geometryvalue)); WKT_ERROR(); }
-#line 2483 "lwin_wkt_parse.c" /* yacc.c:1646  */
+#line 2487 "lwin_wkt_parse.c" /* yacc.c:1646  */
     break;
 
   case 102:
-#line 445 "lwin_wkt_parse.y" /* yacc.c:1646  */
+#line 449 "lwin_wkt_parse.y" /* yacc.c:1646  */
     { (yyval.geometryvalue) = wkt_parser_circularstring_new((yyvsp[-1].ptarrayvalue), NULL); WKT_ERROR(); }
-#line 2489 "lwin_wkt_parse.c" /* yacc.c:1646  */
+#line 2493 "lwin_wkt_parse.c" /* yacc.c:1646  */
     break;
 
   case 103:
-#line 447 "lwin_wkt_parse.y" /* yacc.c:1646  */
+#line 451 "lwin_wkt_parse.y" /* yacc.c:1646  */
     { (yyval.geometryvalue) = wkt_parser_circularstring_new((yyvsp[-1].ptarrayvalue), (yyvsp[-3].stringvalue)); WKT_ERROR(); }
-#line 2495 "lwin_wkt_parse.c" /* yacc.c:1646  */
+#line 2499 "lwin_wkt_parse.c" /* yacc.c:1646  */
     break;
 
   case 104:
-#line 449 "lwin_wkt_parse.y" /* yacc.c:1646  */
+#line 453 "lwin_wkt_parse.y" /* yacc.c:1646  */
     { (yyval.geometryvalue) = wkt_parser_circularstring_new(NULL, (yyvsp[-1].stringvalue)); WKT_ERROR(); }
-#line 2501 "lwin_wkt_parse.c" /* yacc.c:1646  */
+#line 2505 "lwin_wkt_parse.c" /* yacc.c:1646  */
     break;
 
   case 105:
-#line 451 "lwin_wkt_parse.y" /* yacc.c:1646  */
+#line 455 "lwin_wkt_parse.y" /* yacc.c:1646  */
     { (yyval.geometryvalue) = wkt_parser_circularstring_new(NULL, NULL); WKT_ERROR(); }
-#line 2507 "lwin_wkt_parse.c" /* yacc.c:1646  */
+#line 2511 "lwin_wkt_parse.c" /* yacc.c:1646  */
     break;
 
   case 106:
-#line 455 "lwin_wkt_parse.y" /* yacc.c:1646  */
+#line 459 "lwin_wkt_parse.y" /* yacc.c:1646  */
     { (yyval.geometryvalue) = wkt_parser_linestring_new((yyvsp[-1].ptarrayvalue), NULL); WKT_ERROR(); }
-#line 2513 "lwin_wkt_parse.c" /* yacc.c:1646  */
+#line 2517 "lwin_wkt_parse.c" /* yacc.c:1646  */
     break;
 
   case 107:
-#line 457 "lwin_wkt_parse.y" /* yacc.c:1646  */
+#line 461 "lwin_wkt_parse.y" /* yacc.c:1646  */
     { (yyval.geometryvalue) = wkt_parser_linestring_new((yyvsp[-1].ptarrayvalue), (yyvsp[-3].stringvalue)); WKT_ERROR(); }
-#line 2519 "lwin_wkt_parse.c" /* yacc.c:1646  */
+#line 2523 "lwin_wkt_parse.c" /* yacc.c:1646  */
     break;
 
   case 108:
-#line 459 "lwin_wkt_parse.y" /* yacc.c:1646  */
+#line 463 "lwin_wkt_parse.y" /* yacc.c:1646  */
     { (yyval.geometryvalue) = wkt_parser_linestring_new(NULL, (yyvsp[-1].stringvalue)); WKT_ERROR(); }
-#line 2525 "lwin_wkt_parse.c" /* yacc.c:1646  */
+#line 2529 "lwin_wkt_parse.c" /* yacc.c:1646  */
     break;
 
   case 109:
-#line 461 "lwin_wkt_parse.y" /* yacc.c:1646  */
+#line 465 "lwin_wkt_parse.y" /* yacc.c:1646  */
     { (yyval.geometryvalue) = wkt_parser_linestring_new(NULL, NULL); WKT_ERROR(); }
-#line 2531 "lwin_wkt_parse.c" /* yacc.c:1646  */
+#line 2535 "lwin_wkt_parse.c" /* yacc.c:1646  */
     break;
 
   case 110:
-#line 465 "lwin_wkt_parse.y" /* yacc.c:1646  */
+#line 469 "lwin_wkt_parse.y" /* yacc.c:1646  */
     { (yyval.geometryvalue) = wkt_parser_linestring_new((yyvsp[-1].ptarrayvalue), NULL); WKT_ERROR(); }
-#line 2537 "lwin_wkt_parse.c" /* yacc.c:1646  */
+#line 2541 "lwin_wkt_parse.c" /* yacc.c:1646  */
     break;
 
   case 111:
-#line 467 "lwin_wkt_parse.y" /* yacc.c:1646  */
+#line 471 "lwin_wkt_parse.y" /* yacc.c:1646  */
     { (yyval.geometryvalue) = wkt_parser_linestring_new(NULL, NULL); WKT_ERROR(); }
-#line 2543 "lwin_wkt_parse.c" /* yacc.c:1646  */
+#line 2547 "lwin_wkt_parse.c" /* yacc.c:1646  */
     break;
 
   case 112:
-#line 471 "lwin_wkt_parse.y" /* yacc.c:1646  */
+#line 475 "lwin_wkt_parse.y" /* yacc.c:1646  */
     { (yyval.geometryvalue) = wkt_parser_collection_add_geom((yyvsp[-2].geometryvalue),(yyvsp[0].geometryvalue)); WKT_ERROR(); }
-#line 2549 "lwin_wkt_parse.c" /* yacc.c:1646  */
+#line 2553 "lwin_wkt_parse.c" /* yacc.c:1646  */
     break;
 
   case 113:
-#line 473 "lwin_wkt_parse.y" /* yacc.c:1646  */
+#line 477 "lwin_wkt_parse.y" /* yacc.c:1646  */
     { (yyval.geometryvalue) = wkt_parser_collection_new((yyvsp[0].geometryvalue)); WKT_ERROR(); }
-#line 2555 "lwin_wkt_parse.c" /* yacc.c:1646  */
+#line 2559 "lwin_wkt_parse.c" /* yacc.c:1646  */
     break;
 
   case 114:
-#line 477 "lwin_wkt_parse.y" /* yacc.c:1646  */
+#line 481 "lwin_wkt_parse.y" /* yacc.c:1646  */
     { (yyval.geometryvalue) = wkt_parser_triangle_new((yyvsp[-2].ptarrayvalue), NULL); WKT_ERROR(); }
-#line 2561 "lwin_wkt_parse.c" /* yacc.c:1646  */
+#line 2565 "lwin_wkt_parse.c" /* yacc.c:1646  */
     break;
 
   case 115:
-#line 479 "lwin_wkt_parse.y" /* yacc.c:1646  */
+#line 483 "lwin_wkt_parse.y" /* yacc.c:1646  */
     { (yyval.geometryvalue) = wkt_parser_triangle_new((yyvsp[-2].ptarrayvalue), (yyvsp[-5].stringvalue)); WKT_ERROR(); }
-#line 2567 "lwin_wkt_parse.c" /* yacc.c:1646  */
+#line 2571 "lwin_wkt_parse.c" /* yacc.c:1646  */
     break;
 
   case 116:
-#line 481 "lwin_wkt_parse.y" /* yacc.c:1646  */
+#line 485 "lwin_wkt_parse.y" /* yacc.c:1646  */
     { (yyval.geometryvalue) = wkt_parser_triangle_new(NULL, (yyvsp[-1].stringvalue)); WKT_ERROR(); }
-#line 2573 "lwin_wkt_parse.c" /* yacc.c:1646  */
+#line 2577 "lwin_wkt_parse.c" /* yacc.c:1646  */
     break;
 
   case 117:
-#line 483 "lwin_wkt_parse.y" /* yacc.c:1646  */
+#line 487 "lwin_wkt_parse.y" /* yacc.c:1646  */
     { (yyval.geometryvalue) = wkt_parser_triangle_new(NULL, NULL); WKT_ERROR(); }
-#line 2579 "lwin_wkt_parse.c" /* yacc.c:1646  */
+#line 2583 "lwin_wkt_parse.c" /* yacc.c:1646  */
     break;
 
   case 118:
-#line 487 "lwin_wkt_parse.y" /* yacc.c:1646  */
+#line 491 "lwin_wkt_parse.y" /* yacc.c:1646  */
     { (yyval.geometryvalue) = wkt_parser_triangle_new((yyvsp[-2].ptarrayvalue), NULL); WKT_ERROR(); }
-#line 2585 "lwin_wkt_parse.c" /* yacc.c:1646  */
+#line 2589 "lwin_wkt_parse.c" /* yacc.c:1646  */
     break;
 
   case 119:
-#line 491 "lwin_wkt_parse.y" /* yacc.c:1646  */
+#line 495 "lwin_wkt_parse.y" /* yacc.c:1646  */
     { (yyval.geometryvalue) = wkt_parser_collection_finalize(MULTIPOINTTYPE, (yyvsp[-1].geometryvalue), NULL); WKT_ERROR(); }
-#line 2591 "lwin_wkt_parse.c" /* yacc.c:1646  */
+#line 2595 "lwin_wkt_parse.c" /* yacc.c:1646  */
     break;
 
   case 120:
-#line 493 "lwin_wkt_parse.y" /* yacc.c:1646  */
+#line 497 "lwin_wkt_parse.y" /* yacc.c:1646  */
     { (yyval.geometryvalue) = wkt_parser_collection_finalize(MULTIPOINTTYPE, (yyvsp[-1].geometryvalue), (yyvsp[-3].stringvalue)); WKT_ERROR(); }
-#line 2597 "lwin_wkt_parse.c" /* yacc.c:1646  */
+#line 2601 "lwin_wkt_parse.c" /* yacc.c:1646  */
     break;
 
   case 121:
-#line 495 "lwin_wkt_parse.y" /* yacc.c:1646  */
+#line 499 "lwin_wkt_parse.y" /* yacc.c:1646  */
     { (yyval.geometryvalue) = wkt_parser_collection_finalize(MULTIPOINTTYPE, NULL, (yyvsp[-1].stringvalue)); WKT_ERROR(); }
-#line 2603 "lwin_wkt_parse.c" /* yacc.c:1646  */
+#line 2607 "lwin_wkt_parse.c" /* yacc.c:1646  */
     break;
 
   case 122:
-#line 497 "lwin_wkt_parse.y" /* yacc.c:1646  */
+#line 501 "lwin_wkt_parse.y" /* yacc.c:1646  */
     { (yyval.geometryvalue) = wkt_parser_collection_finalize(MULTIPOINTTYPE, NULL, NULL); WKT_ERROR(); }
-#line 2609 "lwin_wkt_parse.c" /* yacc.c:1646  */
+#line 2613 "lwin_wkt_parse.c" /* yacc.c:1646  */
     break;
 
   case 123:
-#line 501 "lwin_wkt_parse.y" /* yacc.c:1646  */
+#line 505 "lwin_wkt_parse.y" /* yacc.c:1646  */
     { (yyval.geometryvalue) = wkt_parser_collection_add_geom((yyvsp[-2].geometryvalue),(yyvsp[0].geometryvalue)); WKT_ERROR(); }
-#line 2615 "lwin_wkt_parse.c" /* yacc.c:1646  */
+#line 2619 "lwin_wkt_parse.c" /* yacc.c:1646  */
     break;
 
   case 124:
-#line 503 "lwin_wkt_parse.y" /* yacc.c:1646  */
+#line 507 "lwin_wkt_parse.y" /* yacc.c:1646  */
     { (yyval.geometryvalue) = wkt_parser_collection_new((yyvsp[0].geometryvalue)); WKT_ERROR(); }
-#line 2621 "lwin_wkt_parse.c" /* yacc.c:1646  */
+#line 2625 "lwin_wkt_parse.c" /* yacc.c:1646  */
     break;
 
   case 125:
-#line 507 "lwin_wkt_parse.y" /* yacc.c:1646  */
+#line 511 "lwin_wkt_parse.y" /* yacc.c:1646  */
     { (yyval.geometryvalue) = wkt_parser_point_new(wkt_parser_ptarray_new((yyvsp[0].coordinatevalue)),NULL); WKT_ERROR(); }
-#line 2627 "lwin_wkt_parse.c" /* yacc.c:1646  */
+#line 2631 "lwin_wkt_parse.c" /* yacc.c:1646  */
     break;
 
   case 126:
-#line 509 "lwin_wkt_parse.y" /* yacc.c:1646  */
+#line 513 "lwin_wkt_parse.y" /* yacc.c:1646  */
     { (yyval.geometryvalue) = wkt_parser_point_new(wkt_parser_ptarray_new((yyvsp[-1].coordinatevalue)),NULL); WKT_ERROR(); }
-#line 2633 "lwin_wkt_parse.c" /* yacc.c:1646  */
+#line 2637 "lwin_wkt_parse.c" /* yacc.c:1646  */
     break;
 
   case 127:
-#line 511 "lwin_wkt_parse.y" /* yacc.c:1646  */
+#line 515 "lwin_wkt_parse.y" /* yacc.c:1646  */
     { (yyval.geometryvalue) = wkt_parser_point_new(NULL, NULL); WKT_ERROR(); }
-#line 2639 "lwin_wkt_parse.c" /* yacc.c:1646  */
+#line 2643 "lwin_wkt_parse.c" /* yacc.c:1646  */
     break;
 
   case 128:
-#line 515 "lwin_wkt_parse.y" /* yacc.c:1646  */
+#line 519 "lwin_wkt_parse.y" /* yacc.c:1646  */
     { (yyval.geometryvalue) = wkt_parser_point_new((yyvsp[-1].ptarrayvalue), NULL); WKT_ERROR(); }
-#line 2645 "lwin_wkt_parse.c" /* yacc.c:1646  */
+#line 2649 "lwin_wkt_parse.c" /* yacc.c:1646  */
     break;
 
   case 129:
-#line 517 "lwin_wkt_parse.y" /* yacc.c:1646  */
+#line 521 "lwin_wkt_parse.y" /* yacc.c:1646  */
     { (yyval.geometryvalue) = wkt_parser_point_new((yyvsp[-1].ptarrayvalue), (yyvsp[-3].stringvalue)); WKT_ERROR(); }
-#line 2651 "lwin_wkt_parse.c" /* yacc.c:1646  */
+#line 2655 "lwin_wkt_parse.c" /* yacc.c:1646  */
     break;
 
   case 130:
-#line 519 "lwin_wkt_parse.y" /* yacc.c:1646  */
+#line 523 "lwin_wkt_parse.y" /* yacc.c:1646  */
     { (yyval.geometryvalue) = wkt_parser_point_new(NULL, (yyvsp[-1].stringvalue)); WKT_ERROR(); }
-#line 2657 "lwin_wkt_parse.c" /* yacc.c:1646  */
+#line 2661 "lwin_wkt_parse.c" /* yacc.c:1646  */
     break;
 
   case 131:
-#line 521 "lwin_wkt_parse.y" /* yacc.c:1646  */
+#line 525 "lwin_wkt_parse.y" /* yacc.c:1646  */
     { (yyval.geometryvalue) = wkt_parser_point_new(NULL,NULL); WKT_ERROR(); }
-#line 2663 "lwin_wkt_parse.c" /* yacc.c:1646  */
+#line 2667 "lwin_wkt_parse.c" /* yacc.c:1646  */
     break;
 
   case 132:
-#line 525 "lwin_wkt_parse.y" /* yacc.c:1646  */
+#line 529 "lwin_wkt_parse.y" /* yacc.c:1646  */
     { (yyval.ptarrayvalue) = wkt_parser_ptarray_add_coord((yyvsp[-2].ptarrayvalue), (yyvsp[0].coordinatevalue)); WKT_ERROR(); }
-#line 2669 "lwin_wkt_parse.c" /* yacc.c:1646  */
+#line 2673 "lwin_wkt_parse.c" /* yacc.c:1646  */
     break;
 
   case 133:
-#line 527 "lwin_wkt_parse.y" /* yacc.c:1646  */
+#line 531 "lwin_wkt_parse.y" /* yacc.c:1646  */
     { (yyval.ptarrayvalue) = wkt_parser_ptarray_new((yyvsp[0].coordinatevalue)); WKT_ERROR(); }
-#line 2675 "lwin_wkt_parse.c" /* yacc.c:1646  */
+#line 2679 "lwin_wkt_parse.c" /* yacc.c:1646  */
     break;
 
   case 134:
-#line 531 "lwin_wkt_parse.y" /* yacc.c:1646  */
+#line 535 "lwin_wkt_parse.y" /* yacc.c:1646  */
     { (yyval.coordinatevalue) = wkt_parser_coord_2((yyvsp[-1].doublevalue), (yyvsp[0].doublevalue)); WKT_ERROR(); }
-#line 2681 "lwin_wkt_parse.c" /* yacc.c:1646  */
+#line 2685 "lwin_wkt_parse.c" /* yacc.c:1646  */
     break;
 
   case 135:
-#line 533 "lwin_wkt_parse.y" /* yacc.c:1646  */
+#line 537 "lwin_wkt_parse.y" /* yacc.c:1646  */
     { (yyval.coordinatevalue) = wkt_parser_coord_3((yyvsp[-2].doublevalue), (yyvsp[-1].doublevalue), (yyvsp[0].doublevalue)); WKT_ERROR(); }
-#line 2687 "lwin_wkt_parse.c" /* yacc.c:1646  */
+#line 2691 "lwin_wkt_parse.c" /* yacc.c:1646  */
     break;
 
   case 136:
-#line 535 "lwin_wkt_parse.y" /* yacc.c:1646  */
+#line 539 "lwin_wkt_parse.y" /* yacc.c:1646  */
     { (yyval.coordinatevalue) = wkt_parser_coord_4((yyvsp[-3].doublevalue), (yyvsp[-2].doublevalue), (yyvsp[-1].doublevalue), (yyvsp[0].doublevalue)); WKT_ERROR(); }
-#line 2693 "lwin_wkt_parse.c" /* yacc.c:1646  */
+#line 2697 "lwin_wkt_parse.c" /* yacc.c:1646  */
     break;
 
 
-#line 2697 "lwin_wkt_parse.c" /* yacc.c:1646  */
+#line 2701 "lwin_wkt_parse.c" /* yacc.c:1646  */
       default: break;
     }
   /* User semantic actions sometimes alter yychar, and that requires
@@ -2951,6 +2955,6 @@ yyreturn:
 #endif
   return yyresult;
 }
-#line 537 "lwin_wkt_parse.y" /* yacc.c:1906  */
+#line 541 "lwin_wkt_parse.y" /* yacc.c:1906  */
 
 
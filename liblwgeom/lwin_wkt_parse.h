@@ -123,7 +123,7 @@ extern int wkt_yydebug;
 
 union YYSTYPE
 {
-#line 108 "lwin_wkt_parse.y" /* yacc.c:1909  */
+#line 112 "lwin_wkt_parse.y" /* yacc.c:1909  */
 
 	int integervalue;
 	double doublevalue;
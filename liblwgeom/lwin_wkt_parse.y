@@ -49,6 +49,10 @@ int lwgeom_parse_wkt(LWGEOM_PARSER_RESULT *parser_result, char *wktstr, int pars
 {
 	int parse_rv = 0;
 
+	/* Plain geometries are read without the lexer and grammar */
+	if ( wkt_parser_fast(parser_result, wktstr, parser_check_flags) == LW_SUCCESS )
+		return LW_SUCCESS;
+
 	/* Clean up our global parser result. */
 	lwgeom_parser_result_init(&global_parser_result);
 	/* Work-around possible bug in GNU Bison 3.0.2 resulting in wkt_yylloc
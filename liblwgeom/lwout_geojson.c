@@ -25,21 +25,13 @@
 
 
 #include "liblwgeom_internal.h"
+#include "stringbuffer.h"
 #include <string.h>	/* strlen */
 #include <assert.h>
 
-static char *asgeojson_point(const LWPOINT *point, char *srs, GBOX *bbox, int precision);
-static char *asgeojson_line(const LWLINE *line, char *srs, GBOX *bbox, int precision);
-static char *asgeojson_poly(const LWPOLY *poly, char *srs, GBOX *bbox, int precision);
-static char * asgeojson_multipoint(const LWMPOINT *mpoint, char *srs, GBOX *bbox, int precision);
-static char * asgeojson_multiline(const LWMLINE *mline, char *srs, GBOX *bbox, int precision);
-static char * asgeojson_multipolygon(const LWMPOLY *mpoly, char *srs, GBOX *bbox, int precision);
-static char * asgeojson_collection(const LWCOLLECTION *col, char *srs, GBOX *bbox, int precision);
-static size_t asgeojson_geom_size(const LWGEOM *geom, GBOX *bbox, int precision);
-static size_t asgeojson_geom_buf(const LWGEOM *geom, char *output, GBOX *bbox, int precision);
-
-static size_t pointArray_to_geojson(POINTARRAY *pa, char *buf, int precision);
-static size_t pointArray_geojson_size(POINTARRAY *pa, int precision);
+static void asgeojson_collection_sb(const LWCOLLECTION *col, char *srs, GBOX *bbox, int precision, stringbuffer_t *sb);
+static void asgeojson_geom_sb(const LWGEOM *geom, char *srs, GBOX *bbox, int precision, stringbuffer_t *sb);
+static void pointArray_to_geojson_sb(POINTARRAY *pa, int precision, stringbuffer_t *sb);
 
 /**
  * Takes a GEOMETRY and returns a GeoJson representation
@@ -47,43 +39,61 @@ static size_t pointArray_geojson_size(POINTARRAY *pa, int precision);
 char *
 lwgeom_to_geojson(const LWGEOM *geom, char *srs, int precision, int has_bbox)
 {
-	int type = geom->type;
+	stringbuffer_t *sb;
+	char *output = NULL;
+
+	sb = stringbuffer_create();
+	if ( lwgeom_to_geojson_sb(geom, srs, precision, has_bbox, sb) == LW_SUCCESS )
+		output = stringbuffer_getstringcopy(sb);
+	stringbuffer_destroy(sb);
+
+	return output;
+}
+
+/**
+ * Appends the GeoJson representation of a GEOMETRY to a stringbuffer
+ *
+ * The output is written in a single pass, no size estimate is computed
+ * beforehand. Returns LW_FAILURE on unsupported geometry types.
+ */
+int
+lwgeom_to_geojson_sb(const LWGEOM *geom, char *srs, int precision, int has_bbox, stringbuffer_t *sb)
+{
 	GBOX *bbox = NULL;
 	GBOX tmp;
 
 	if ( precision > OUT_MAX_DOUBLE_PRECISION ) precision = OUT_MAX_DOUBLE_PRECISION;
 
-	if (has_bbox)
-	{
-		/* Whether these are geography or geometry,
-		   the GeoJSON expects a cartesian bounding box */
-		lwgeom_calculate_gbox_cartesian(geom, &tmp);
-		bbox = &tmp;
-	}		
-
-	switch (type)
+	switch (geom->type)
 	{
 	case POINTTYPE:
-		return asgeojson_point((LWPOINT*)geom, srs, bbox, precision);
 	case LINETYPE:
-		return asgeojson_line((LWLINE*)geom, srs, bbox, precision);
 	case POLYGONTYPE:
-		return asgeojson_poly((LWPOLY*)geom, srs, bbox, precision);
 	case MULTIPOINTTYPE:
-		return asgeojson_multipoint((LWMPOINT*)geom, srs, bbox, precision);
 	case MULTILINETYPE:
-		return asgeojson_multiline((LWMLINE*)geom, srs, bbox, precision);
 	case MULTIPOLYGONTYPE:
-		return asgeojson_multipolygon((LWMPOLY*)geom, srs, bbox, precision);
 	case COLLECTIONTYPE:
-		return asgeojson_collection((LWCOLLECTION*)geom, srs, bbox, precision);
+		break;
 	default:
 		lwerror("lwgeom_to_geojson: '%s' geometry type not supported",
-		        lwtype_name(type));
+		        lwtype_name(geom->type));
+		return LW_FAILURE;
 	}
 
-	/* Never get here */
-	return NULL;
+	if (has_bbox)
+	{
+		/* Whether these are geography or geometry,
+		   the GeoJSON expects a cartesian bounding box */
+		lwgeom_calculate_gbox_cartesian(geom, &tmp);
+		bbox = &tmp;
+	}		
+
+	if (geom->type == COLLECTIONTYPE)
+		asgeojson_collection_sb((LWCOLLECTION*)geom, srs, bbox, precision, sb);
+	else
+		asgeojson_geom_sb(geom, srs, bbox, precision, sb);
+
+	return LW_SUCCESS;
 }
 
 
@@ -91,27 +101,13 @@ lwgeom_to_geojson(const LWGEOM *geom, char *srs, int precision, int has_bbox)
 /**
  * Handle SRS
  */
-static size_t
-asgeojson_srs_size(char *srs)
+static void
+asgeojson_srs_sb(char *srs, stringbuffer_t *sb)
 {
-	int size;
-
-	size = sizeof("'crs':{'type':'name',");
-	size += sizeof("'properties':{'name':''}},");
-	size += strlen(srs) * sizeof(char);
-
-	return size;
-}
-
-static size_t
-asgeojson_srs_buf(char *output, char *srs)
-{
-	char *ptr = output;
-
-	ptr += sprintf(ptr, "\"crs\":{\"type\":\"name\",");
-	ptr += sprintf(ptr, "\"properties\":{\"name\":\"%s\"}},", srs);
-
-	return (ptr-output);
+	stringbuffer_append(sb, "\"crs\":{\"type\":\"name\",");
+	stringbuffer_append(sb, "\"properties\":{\"name\":\"");
+	stringbuffer_append(sb, srs);
+	stringbuffer_append(sb, "\"}},");
 }
 
 
@@ -119,40 +115,17 @@ asgeojson_srs_buf(char *output, char *srs)
 /**
  * Handle Bbox
  */
-static size_t
-asgeojson_bbox_size(int hasz, int precision)
+static void
+asgeojson_bbox_sb(GBOX *bbox, int hasz, int precision, stringbuffer_t *sb)
 {
-	int size;
-
 	if (!hasz)
-	{
-		size = sizeof("\"bbox\":[,,,],");
-		size +=	2 * 2 * (OUT_MAX_DIGS_DOUBLE + precision);
-	}
-	else
-	{
-		size = sizeof("\"bbox\":[,,,,,],");
-		size +=	2 * 3 * (OUT_MAX_DIGS_DOUBLE + precision);
-	}
-
-	return size;
-}
-
-static size_t
-asgeojson_bbox_buf(char *output, GBOX *bbox, int hasz, int precision)
-{
-	char *ptr = output;
-
-	if (!hasz)
-		ptr += sprintf(ptr, "\"bbox\":[%.*f,%.*f,%.*f,%.*f],",
+		stringbuffer_aprintf(sb, "\"bbox\":[%.*f,%.*f,%.*f,%.*f],",
 		               precision, bbox->xmin, precision, bbox->ymin,
 		               precision, bbox->xmax, precision, bbox->ymax);
 	else
-		ptr += sprintf(ptr, "\"bbox\":[%.*f,%.*f,%.*f,%.*f,%.*f,%.*f],",
+		stringbuffer_aprintf(sb, "\"bbox\":[%.*f,%.*f,%.*f,%.*f,%.*f,%.*f],",
 		               precision, bbox->xmin, precision, bbox->ymin, precision, bbox->zmin,
 		               precision, bbox->xmax, precision, bbox->ymax, precision, bbox->zmax);
-
-	return (ptr-output);
 }
 
 
@@ -160,53 +133,18 @@ asgeojson_bbox_buf(char *output, GBOX *bbox, int hasz, int precision)
 /**
  * Point Geometry
  */
-
-static size_t
-asgeojson_point_size(const LWPOINT *point, char *srs, GBOX *bbox, int precision)
-{
-	int size;
-
-	size = pointArray_geojson_size(point->point, precision);
-	size += sizeof("{'type':'Point',");
-	size += sizeof("'coordinates':}");
-
-	if ( lwpoint_is_empty(point) )
-		size += 2; /* [] */
-
-	if (srs) size += asgeojson_srs_size(srs);
-	if (bbox) size += asgeojson_bbox_size(FLAGS_GET_Z(point->flags), precision);
-
-	return size;
-}
-
-static size_t
-asgeojson_point_buf(const LWPOINT *point, char *srs, char *output, GBOX *bbox, int precision)
+static void
+asgeojson_point_sb(const LWPOINT *point, char *srs, GBOX *bbox, int precision, stringbuffer_t *sb)
 {
-	char *ptr = output;
-
-	ptr += sprintf(ptr, "{\"type\":\"Point\",");
-	if (srs) ptr += asgeojson_srs_buf(ptr, srs);
-	if (bbox) ptr += asgeojson_bbox_buf(ptr, bbox, FLAGS_GET_Z(point->flags), precision);
+	stringbuffer_append(sb, "{\"type\":\"Point\",");
+	if (srs) asgeojson_srs_sb(srs, sb);
+	if (bbox) asgeojson_bbox_sb(bbox, FLAGS_GET_Z(point->flags), precision, sb);
 
-	ptr += sprintf(ptr, "\"coordinates\":");
+	stringbuffer_append(sb, "\"coordinates\":");
 	if ( lwpoint_is_empty(point) )
-		ptr += sprintf(ptr, "[]");
-	ptr += pointArray_to_geojson(point->point, ptr, precision);
-	ptr += sprintf(ptr, "}");
-
-	return (ptr-output);
-}
-
-static char *
-asgeojson_point(const LWPOINT *point, char *srs, GBOX *bbox, int precision)
-{
-	char *output;
-	int size;
-
-	size = asgeojson_point_size(point, srs, bbox, precision);
-	output = lwalloc(size);
-	asgeojson_point_buf(point, srs, output, bbox, precision);
-	return output;
+		stringbuffer_append(sb, "[]");
+	pointArray_to_geojson_sb(point->point, precision, sb);
+	stringbuffer_append_char(sb, '}');
 }
 
 
@@ -214,47 +152,15 @@ asgeojson_point(const LWPOINT *point, char *srs, GBOX *bbox, int precision)
 /**
  * Line Geometry
  */
-
-static size_t
-asgeojson_line_size(const LWLINE *line, char *srs, GBOX *bbox, int precision)
-{
-	int size;
-
-	size = sizeof("{'type':'LineString',");
-	if (srs) size += asgeojson_srs_size(srs);
-	if (bbox) size += asgeojson_bbox_size(FLAGS_GET_Z(line->flags), precision);
-	size += sizeof("'coordinates':[]}");
-	size += pointArray_geojson_size(line->points, precision);
-
-	return size;
-}
-
-static size_t
-asgeojson_line_buf(const LWLINE *line, char *srs, char *output, GBOX *bbox, int precision)
-{
-	char *ptr=output;
-
-	ptr += sprintf(ptr, "{\"type\":\"LineString\",");
-	if (srs) ptr += asgeojson_srs_buf(ptr, srs);
-	if (bbox) ptr += asgeojson_bbox_buf(ptr, bbox, FLAGS_GET_Z(line->flags), precision);
-	ptr += sprintf(ptr, "\"coordinates\":[");
-	ptr += pointArray_to_geojson(line->points, ptr, precision);
-	ptr += sprintf(ptr, "]}");
-
-	return (ptr-output);
-}
-
-static char *
-asgeojson_line(const LWLINE *line, char *srs, GBOX *bbox, int precision)
+static void
+asgeojson_line_sb(const LWLINE *line, char *srs, GBOX *bbox, int precision, stringbuffer_t *sb)
 {
-	char *output;
-	int size;
-
-	size = asgeojson_line_size(line, srs, bbox, precision);
-	output = lwalloc(size);
-	asgeojson_line_buf(line, srs, output, bbox, precision);
-
-	return output;
+	stringbuffer_append(sb, "{\"type\":\"LineString\",");
+	if (srs) asgeojson_srs_sb(srs, sb);
+	if (bbox) asgeojson_bbox_sb(bbox, FLAGS_GET_Z(line->flags), precision, sb);
+	stringbuffer_append(sb, "\"coordinates\":[");
+	pointArray_to_geojson_sb(line->points, precision, sb);
+	stringbuffer_append(sb, "]}");
 }
 
 
@@ -262,61 +168,23 @@ asgeojson_line(const LWLINE *line, char *srs, GBOX *bbox, int precision)
 /**
  * Polygon Geometry
  */
-
-static size_t
-asgeojson_poly_size(const LWPOLY *poly, char *srs, GBOX *bbox, int precision)
+static void
+asgeojson_poly_sb(const LWPOLY *poly, char *srs, GBOX *bbox, int precision, stringbuffer_t *sb)
 {
-	size_t size;
 	int i;
 
-	size = sizeof("{\"type\":\"Polygon\",");
-	if (srs) size += asgeojson_srs_size(srs);
-	if (bbox) size += asgeojson_bbox_size(FLAGS_GET_Z(poly->flags), precision);
-	size += sizeof("\"coordinates\":[");
+	stringbuffer_append(sb, "{\"type\":\"Polygon\",");
+	if (srs) asgeojson_srs_sb(srs, sb);
+	if (bbox) asgeojson_bbox_sb(bbox, FLAGS_GET_Z(poly->flags), precision, sb);
+	stringbuffer_append(sb, "\"coordinates\":[");
 	for (i=0; i<poly->nrings; i++)
 	{
-		size += pointArray_geojson_size(poly->rings[i], precision);
-		size += sizeof("[]");
+		if (i) stringbuffer_append_char(sb, ',');
+		stringbuffer_append_char(sb, '[');
+		pointArray_to_geojson_sb(poly->rings[i], precision, sb);
+		stringbuffer_append_char(sb, ']');
 	}
-	size += sizeof(",") * i;
-	size += sizeof("]}");
-
-	return size;
-}
-
-static size_t
-asgeojson_poly_buf(const LWPOLY *poly, char *srs, char *output, GBOX *bbox, int precision)
-{
-	int i;
-	char *ptr=output;
-
-	ptr += sprintf(ptr, "{\"type\":\"Polygon\",");
-	if (srs) ptr += asgeojson_srs_buf(ptr, srs);
-	if (bbox) ptr += asgeojson_bbox_buf(ptr, bbox, FLAGS_GET_Z(poly->flags), precision);
-	ptr += sprintf(ptr, "\"coordinates\":[");
-	for (i=0; i<poly->nrings; i++)
-	{
-		if (i) ptr += sprintf(ptr, ",");
-		ptr += sprintf(ptr, "[");
-		ptr += pointArray_to_geojson(poly->rings[i], ptr, precision);
-		ptr += sprintf(ptr, "]");
-	}
-	ptr += sprintf(ptr, "]}");
-
-	return (ptr-output);
-}
-
-static char *
-asgeojson_poly(const LWPOLY *poly, char *srs, GBOX *bbox, int precision)
-{
-	char *output;
-	int size;
-
-	size = asgeojson_poly_size(poly, srs, bbox, precision);
-	output = lwalloc(size);
-	asgeojson_poly_buf(poly, srs, output, bbox, precision);
-
-	return output;
+	stringbuffer_append(sb, "]}");
 }
 
 
@@ -324,63 +192,22 @@ asgeojson_poly(const LWPOLY *poly, char *srs, GBOX *bbox, int precision)
 /**
  * Multipoint Geometry
  */
-
-static size_t
-asgeojson_multipoint_size(const LWMPOINT *mpoint, char *srs, GBOX *bbox, int precision)
+static void
+asgeojson_multipoint_sb(const LWMPOINT *mpoint, char *srs, GBOX *bbox, int precision, stringbuffer_t *sb)
 {
-	LWPOINT * point;
-	int size;
 	int i;
 
-	size = sizeof("{'type':'MultiPoint',");
-	if (srs) size += asgeojson_srs_size(srs);
-	if (bbox) size += asgeojson_bbox_size(FLAGS_GET_Z(mpoint->flags), precision);
-	size += sizeof("'coordinates':[]}");
+	stringbuffer_append(sb, "{\"type\":\"MultiPoint\",");
+	if (srs) asgeojson_srs_sb(srs, sb);
+	if (bbox) asgeojson_bbox_sb(bbox, FLAGS_GET_Z(mpoint->flags), precision, sb);
+	stringbuffer_append(sb, "\"coordinates\":[");
 
 	for (i=0; i<mpoint->ngeoms; i++)
 	{
-		point = mpoint->geoms[i];
-		size += pointArray_geojson_size(point->point, precision);
+		if (i) stringbuffer_append_char(sb, ',');
+		pointArray_to_geojson_sb(mpoint->geoms[i]->point, precision, sb);
 	}
-	size += sizeof(",") * i;
-
-	return size;
-}
-
-static size_t
-asgeojson_multipoint_buf(const LWMPOINT *mpoint, char *srs, char *output, GBOX *bbox, int precision)
-{
-	LWPOINT *point;
-	int i;
-	char *ptr=output;
-
-	ptr += sprintf(ptr, "{\"type\":\"MultiPoint\",");
-	if (srs) ptr += asgeojson_srs_buf(ptr, srs);
-	if (bbox) ptr += asgeojson_bbox_buf(ptr, bbox, FLAGS_GET_Z(mpoint->flags), precision);
-	ptr += sprintf(ptr, "\"coordinates\":[");
-
-	for (i=0; i<mpoint->ngeoms; i++)
-	{
-		if (i) ptr += sprintf(ptr, ",");
-		point = mpoint->geoms[i];
-		ptr += pointArray_to_geojson(point->point, ptr, precision);
-	}
-	ptr += sprintf(ptr, "]}");
-
-	return (ptr - output);
-}
-
-static char *
-asgeojson_multipoint(const LWMPOINT *mpoint, char *srs, GBOX *bbox, int precision)
-{
-	char *output;
-	int size;
-
-	size = asgeojson_multipoint_size(mpoint, srs, bbox, precision);
-	output = lwalloc(size);
-	asgeojson_multipoint_buf(mpoint, srs, output, bbox, precision);
-
-	return output;
+	stringbuffer_append(sb, "]}");
 }
 
 
@@ -388,67 +215,25 @@ asgeojson_multipoint(const LWMPOINT *mpoint, char *srs, GBOX *bbox, int precisio
 /**
  * Multiline Geometry
  */
-
-static size_t
-asgeojson_multiline_size(const LWMLINE *mline, char *srs, GBOX *bbox, int precision)
-{
-	LWLINE * line;
-	int size;
-	int i;
-
-	size = sizeof("{'type':'MultiLineString',");
-	if (srs) size += asgeojson_srs_size(srs);
-	if (bbox) size += asgeojson_bbox_size(FLAGS_GET_Z(mline->flags), precision);
-	size += sizeof("'coordinates':[]}");
-
-	for (i=0 ; i<mline->ngeoms; i++)
-	{
-		line = mline->geoms[i];
-		size += pointArray_geojson_size(line->points, precision);
-		size += sizeof("[]");
-	}
-	size += sizeof(",") * i;
-
-	return size;
-}
-
-static size_t
-asgeojson_multiline_buf(const LWMLINE *mline, char *srs, char *output, GBOX *bbox, int precision)
+static void
+asgeojson_multiline_sb(const LWMLINE *mline, char *srs, GBOX *bbox, int precision, stringbuffer_t *sb)
 {
-	LWLINE *line;
 	int i;
-	char *ptr=output;
 
-	ptr += sprintf(ptr, "{\"type\":\"MultiLineString\",");
-	if (srs) ptr += asgeojson_srs_buf(ptr, srs);
-	if (bbox) ptr += asgeojson_bbox_buf(ptr, bbox, FLAGS_GET_Z(mline->flags), precision);
-	ptr += sprintf(ptr, "\"coordinates\":[");
+	stringbuffer_append(sb, "{\"type\":\"MultiLineString\",");
+	if (srs) asgeojson_srs_sb(srs, sb);
+	if (bbox) asgeojson_bbox_sb(bbox, FLAGS_GET_Z(mline->flags), precision, sb);
+	stringbuffer_append(sb, "\"coordinates\":[");
 
 	for (i=0; i<mline->ngeoms; i++)
 	{
-		if (i) ptr += sprintf(ptr, ",");
-		ptr += sprintf(ptr, "[");
-		line = mline->geoms[i];
-		ptr += pointArray_to_geojson(line->points, ptr, precision);
-		ptr += sprintf(ptr, "]");
+		if (i) stringbuffer_append_char(sb, ',');
+		stringbuffer_append_char(sb, '[');
+		pointArray_to_geojson_sb(mline->geoms[i]->points, precision, sb);
+		stringbuffer_append_char(sb, ']');
 	}
 
-	ptr += sprintf(ptr, "]}");
-
-	return (ptr - output);
-}
-
-static char *
-asgeojson_multiline(const LWMLINE *mline, char *srs, GBOX *bbox, int precision)
-{
-	char *output;
-	int size;
-
-	size = asgeojson_multiline_size(mline, srs, bbox, precision);
-	output = lwalloc(size);
-	asgeojson_multiline_buf(mline, srs, output, bbox, precision);
-
-	return output;
+	stringbuffer_append(sb, "]}");
 }
 
 
@@ -456,76 +241,31 @@ asgeojson_multiline(const LWMLINE *mline, char *srs, GBOX *bbox, int precision)
 /**
  * MultiPolygon Geometry
  */
-
-static size_t
-asgeojson_multipolygon_size(const LWMPOLY *mpoly, char *srs, GBOX *bbox, int precision)
+static void
+asgeojson_multipolygon_sb(const LWMPOLY *mpoly, char *srs, GBOX *bbox, int precision, stringbuffer_t *sb)
 {
 	LWPOLY *poly;
-	int size;
 	int i, j;
 
-	size = sizeof("{'type':'MultiPolygon',");
-	if (srs) size += asgeojson_srs_size(srs);
-	if (bbox) size += asgeojson_bbox_size(FLAGS_GET_Z(mpoly->flags), precision);
-	size += sizeof("'coordinates':[]}");
-
-	for (i=0; i < mpoly->ngeoms; i++)
-	{
-		poly = mpoly->geoms[i];
-		for (j=0 ; j <poly->nrings ; j++)
-		{
-			size += pointArray_geojson_size(poly->rings[j], precision);
-			size += sizeof("[]");
-		}
-		size += sizeof("[]");
-	}
-	size += sizeof(",") * i;
-	size += sizeof("]}");
-
-	return size;
-}
-
-static size_t
-asgeojson_multipolygon_buf(const LWMPOLY *mpoly, char *srs, char *output, GBOX *bbox, int precision)
-{
-	LWPOLY *poly;
-	int i, j;
-	char *ptr=output;
-
-	ptr += sprintf(ptr, "{\"type\":\"MultiPolygon\",");
-	if (srs) ptr += asgeojson_srs_buf(ptr, srs);
-	if (bbox) ptr += asgeojson_bbox_buf(ptr, bbox, FLAGS_GET_Z(mpoly->flags), precision);
-	ptr += sprintf(ptr, "\"coordinates\":[");
+	stringbuffer_append(sb, "{\"type\":\"MultiPolygon\",");
+	if (srs) asgeojson_srs_sb(srs, sb);
+	if (bbox) asgeojson_bbox_sb(bbox, FLAGS_GET_Z(mpoly->flags), precision, sb);
+	stringbuffer_append(sb, "\"coordinates\":[");
 	for (i=0; i<mpoly->ngeoms; i++)
 	{
-		if (i) ptr += sprintf(ptr, ",");
-		ptr += sprintf(ptr, "[");
+		if (i) stringbuffer_append_char(sb, ',');
+		stringbuffer_append_char(sb, '[');
 		poly = mpoly->geoms[i];
 		for (j=0 ; j < poly->nrings ; j++)
 		{
-			if (j) ptr += sprintf(ptr, ",");
-			ptr += sprintf(ptr, "[");
-			ptr += pointArray_to_geojson(poly->rings[j], ptr, precision);
-			ptr += sprintf(ptr, "]");
+			if (j) stringbuffer_append_char(sb, ',');
+			stringbuffer_append_char(sb, '[');
+			pointArray_to_geojson_sb(poly->rings[j], precision, sb);
+			stringbuffer_append_char(sb, ']');
 		}
-		ptr += sprintf(ptr, "]");
+		stringbuffer_append_char(sb, ']');
 	}
-	ptr += sprintf(ptr, "]}");
-
-	return (ptr - output);
-}
-
-static char *
-asgeojson_multipolygon(const LWMPOLY *mpoly, char *srs, GBOX *bbox, int precision)
-{
-	char *output;
-	int size;
-
-	size = asgeojson_multipolygon_size(mpoly, srs, bbox, precision);
-	output = lwalloc(size);
-	asgeojson_multipolygon_buf(mpoly, srs, output, bbox, precision);
-
-	return output;
+	stringbuffer_append(sb, "]}");
 }
 
 
@@ -533,204 +273,88 @@ asgeojson_multipolygon(const LWMPOLY *mpoly, char *srs, GBOX *bbox, int precisio
 /**
  * Collection Geometry
  */
-
-static size_t
-asgeojson_collection_size(const LWCOLLECTION *col, char *srs, GBOX *bbox, int precision)
+static void
+asgeojson_collection_sb(const LWCOLLECTION *col, char *srs, GBOX *bbox, int precision, stringbuffer_t *sb)
 {
 	int i;
-	int size;
 	LWGEOM *subgeom;
 
-	size = sizeof("{'type':'GeometryCollection',");
-	if (srs) size += asgeojson_srs_size(srs);
-	if (bbox) size += asgeojson_bbox_size(FLAGS_GET_Z(col->flags), precision);
-	size += sizeof("'geometries':");
+	stringbuffer_append(sb, "{\"type\":\"GeometryCollection\",");
+	if (srs) asgeojson_srs_sb(srs, sb);
+	if (col->ngeoms && bbox) asgeojson_bbox_sb(bbox, FLAGS_GET_Z(col->flags), precision, sb);
+	stringbuffer_append(sb, "\"geometries\":[");
 
 	for (i=0; i<col->ngeoms; i++)
 	{
+		if (i) stringbuffer_append_char(sb, ',');
 		subgeom = col->geoms[i];
-		size += asgeojson_geom_size(subgeom, NULL, precision);
+		asgeojson_geom_sb(subgeom, NULL, NULL, precision, sb);
 	}
-	size += sizeof(",") * i;
-	size += sizeof("]}");
 
-	return size;
+	stringbuffer_append(sb, "]}");
 }
 
-static size_t
-asgeojson_collection_buf(const LWCOLLECTION *col, char *srs, char *output, GBOX *bbox, int precision)
-{
-	int i;
-	char *ptr=output;
-	LWGEOM *subgeom;
 
-	ptr += sprintf(ptr, "{\"type\":\"GeometryCollection\",");
-	if (srs) ptr += asgeojson_srs_buf(ptr, srs);
-	if (col->ngeoms && bbox) ptr += asgeojson_bbox_buf(ptr, bbox, FLAGS_GET_Z(col->flags), precision);
-	ptr += sprintf(ptr, "\"geometries\":[");
 
-	for (i=0; i<col->ngeoms; i++)
-	{
-		if (i) ptr += sprintf(ptr, ",");
-		subgeom = col->geoms[i];
-		ptr += asgeojson_geom_buf(subgeom, ptr, NULL, precision);
-	}
-
-	ptr += sprintf(ptr, "]}");
-
-	return (ptr - output);
-}
-
-static char *
-asgeojson_collection(const LWCOLLECTION *col, char *srs, GBOX *bbox, int precision)
+static void
+asgeojson_geom_sb(const LWGEOM *geom, char *srs, GBOX *bbox, int precision, stringbuffer_t *sb)
 {
-	char *output;
-	int size;
-
-	size = asgeojson_collection_size(col, srs, bbox, precision);
-	output = lwalloc(size);
-	asgeojson_collection_buf(col, srs, output, bbox, precision);
-
-	return output;
-}
-
-
-
-static size_t
-asgeojson_geom_size(const LWGEOM *geom, GBOX *bbox, int precision)
-{
-	int type = geom->type;
-	size_t size = 0;
-
-	switch (type)
-	{
-	case POINTTYPE:
-		size = asgeojson_point_size((LWPOINT*)geom, NULL, bbox, precision);
-		break;
-
-	case LINETYPE:
-		size = asgeojson_line_size((LWLINE*)geom, NULL, bbox, precision);
-		break;
-
-	case POLYGONTYPE:
-		size = asgeojson_poly_size((LWPOLY*)geom, NULL, bbox, precision);
-		break;
-
-	case MULTIPOINTTYPE:
-		size = asgeojson_multipoint_size((LWMPOINT*)geom, NULL, bbox, precision);
-		break;
-
-	case MULTILINETYPE:
-		size = asgeojson_multiline_size((LWMLINE*)geom, NULL, bbox, precision);
-		break;
-
-	case MULTIPOLYGONTYPE:
-		size = asgeojson_multipolygon_size((LWMPOLY*)geom, NULL, bbox, precision);
-		break;
-
-	default:
-		lwerror("GeoJson: geometry not supported.");
-	}
-
-	return size;
-}
-
-
-static size_t
-asgeojson_geom_buf(const LWGEOM *geom, char *output, GBOX *bbox, int precision)
-{
-	int type = geom->type;
-	char *ptr=output;
-
-	switch (type)
+	switch (geom->type)
 	{
 	case POINTTYPE:
-		ptr += asgeojson_point_buf((LWPOINT*)geom, NULL, ptr, bbox, precision);
+		asgeojson_point_sb((LWPOINT*)geom, srs, bbox, precision, sb);
 		break;
 
 	case LINETYPE:
-		ptr += asgeojson_line_buf((LWLINE*)geom, NULL, ptr, bbox, precision);
+		asgeojson_line_sb((LWLINE*)geom, srs, bbox, precision, sb);
 		break;
 
 	case POLYGONTYPE:
-		ptr += asgeojson_poly_buf((LWPOLY*)geom, NULL, ptr, bbox, precision);
+		asgeojson_poly_sb((LWPOLY*)geom, srs, bbox, precision, sb);
 		break;
 
 	case MULTIPOINTTYPE:
-		ptr += asgeojson_multipoint_buf((LWMPOINT*)geom, NULL, ptr, bbox, precision);
+		asgeojson_multipoint_sb((LWMPOINT*)geom, srs, bbox, precision, sb);
 		break;
 
 	case MULTILINETYPE:
-		ptr += asgeojson_multiline_buf((LWMLINE*)geom, NULL, ptr, bbox, precision);
+		asgeojson_multiline_sb((LWMLINE*)geom, srs, bbox, precision, sb);
 		break;
 
 	case MULTIPOLYGONTYPE:
-		ptr += asgeojson_multipolygon_buf((LWMPOLY*)geom, NULL, ptr, bbox, precision);
+		asgeojson_multipolygon_sb((LWMPOLY*)geom, srs, bbox, precision, sb);
 		break;
 
 	default:
-		if (bbox) lwfree(bbox);
 		lwerror("GeoJson: geometry not supported.");
 	}
-
-	return (ptr-output);
 }
 
 /*
- * Print an ordinate value using at most the given number of decimal digits
+ * Append an ordinate value using at most the given number of decimal digits
  *
  * The actual number of printed decimal digits may be less than the
  * requested ones if out of significant digits.
- *
- * The function will not write more than maxsize bytes, including the
- * terminating NULL. Returns the number of bytes that would have been
- * written if there was enough space (excluding terminating NULL).
- * So a return of ``bufsize'' or more means that the string was
- * truncated and misses a terminating NULL.
- *
- * TODO: export ?
- *
  */
-static int
-lwprint_double(double d, int maxdd, char *buf, size_t bufsize)
+static void
+stringbuffer_append_geojson_double(stringbuffer_t *sb, double d, int maxdd)
 {
   double ad = fabs(d);
   int ndd = ad < 1 ? 0 : floor(log10(ad))+1; /* non-decimal digits */
-  if (fabs(d) < OUT_MAX_DOUBLE)
-  {
-    if ( maxdd > (OUT_MAX_DOUBLE_PRECISION - ndd) )  maxdd -= ndd;
-    return snprintf(buf, bufsize, "%.*f", maxdd, d);
-  }
-  else
-  {
-    return snprintf(buf, bufsize, "%g", d);
-  }
+  if (ad < OUT_MAX_DOUBLE && maxdd > (OUT_MAX_DOUBLE_PRECISION - ndd))
+    maxdd -= ndd;
+  stringbuffer_append_double(sb, d, maxdd);
 }
 
 
 
-static size_t
-pointArray_to_geojson(POINTARRAY *pa, char *output, int precision)
+static void
+pointArray_to_geojson_sb(POINTARRAY *pa, int precision, stringbuffer_t *sb)
 {
 	int i;
-	char *ptr;
-#define BUFSIZE OUT_MAX_DIGS_DOUBLE+OUT_MAX_DOUBLE_PRECISION
-	char x[BUFSIZE+1];
-	char y[BUFSIZE+1];
-	char z[BUFSIZE+1];
 
 	assert ( precision <= OUT_MAX_DOUBLE_PRECISION );
 
-  /* Ensure a terminating NULL at the end of buffers
-   * so that we don't need to check for truncation
-   * inprint_double */
-  x[BUFSIZE] = '\0';
-  y[BUFSIZE] = '\0';
-  z[BUFSIZE] = '\0';
-
-	ptr = output;
-
-  /* TODO: rewrite this loop to be simpler and possibly quicker */
 	if (!FLAGS_GET_Z(pa->flags))
 	{
 		for (i=0; i<pa->npoints; i++)
@@ -738,13 +362,12 @@ pointArray_to_geojson(POINTARRAY *pa, char *output, int precision)
 			const POINT2D *pt;
 			pt = getPoint2d_cp(pa, i);
 
-			lwprint_double(pt->x, precision, x, BUFSIZE);
-			trim_trailing_zeros(x);
-			lwprint_double(pt->y, precision, y, BUFSIZE);
-			trim_trailing_zeros(y);
-
-			if ( i ) ptr += sprintf(ptr, ",");
-			ptr += sprintf(ptr, "[%s,%s]", x, y);
+			if ( i ) stringbuffer_append_char(sb, ',');
+			stringbuffer_append_char(sb, '[');
+			stringbuffer_append_geojson_double(sb, pt->x, precision);
+			stringbuffer_append_char(sb, ',');
+			stringbuffer_append_geojson_double(sb, pt->y, precision);
+			stringbuffer_append_char(sb, ']');
 		}
 	}
 	else
@@ -754,34 +377,14 @@ pointArray_to_geojson(POINTARRAY *pa, char *output, int precision)
 			const POINT3DZ *pt;
 			pt = getPoint3dz_cp(pa, i);
 
-			lwprint_double(pt->x, precision, x, BUFSIZE);
-			trim_trailing_zeros(x);
-			lwprint_double(pt->y, precision, y, BUFSIZE);
-			trim_trailing_zeros(y);
-			lwprint_double(pt->z, precision, z, BUFSIZE);
-			trim_trailing_zeros(z);
-
-			if ( i ) ptr += sprintf(ptr, ",");
-			ptr += sprintf(ptr, "[%s,%s,%s]", x, y, z);
+			if ( i ) stringbuffer_append_char(sb, ',');
+			stringbuffer_append_char(sb, '[');
+			stringbuffer_append_geojson_double(sb, pt->x, precision);
+			stringbuffer_append_char(sb, ',');
+			stringbuffer_append_geojson_double(sb, pt->y, precision);
+			stringbuffer_append_char(sb, ',');
+			stringbuffer_append_geojson_double(sb, pt->z, precision);
+			stringbuffer_append_char(sb, ']');
 		}
 	}
-
-	return (ptr-output);
-}
-
-
-
-/**
- * Returns maximum size of rendered pointarray in bytes.
- */
-static size_t
-pointArray_geojson_size(POINTARRAY *pa, int precision)
-{
-	assert ( precision <= OUT_MAX_DOUBLE_PRECISION );
-	if (FLAGS_NDIMS(pa->flags) == 2)
-		return (OUT_MAX_DIGS_DOUBLE + precision + sizeof(","))
-		       * 2 * pa->npoints + sizeof(",[]");
-
-	return (OUT_MAX_DIGS_DOUBLE + precision + sizeof(",,"))
-	       * 3 * pa->npoints + sizeof(",[]");
 }
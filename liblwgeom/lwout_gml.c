@@ -663,12 +663,10 @@ pointArray_toGML2(POINTARRAY *pa, char *output, int precision)
 {
 	int i;
 	char *ptr;
-	char x[OUT_MAX_DIGS_DOUBLE+OUT_MAX_DOUBLE_PRECISION+1];
-	char y[OUT_MAX_DIGS_DOUBLE+OUT_MAX_DOUBLE_PRECISION+1];
-	char z[OUT_MAX_DIGS_DOUBLE+OUT_MAX_DOUBLE_PRECISION+1];
-
 	ptr = output;
 
+	/* ordinates are printed in place, the output is sized for them */
+
 	if ( ! FLAGS_GET_Z(pa->flags) )
 	{
 		for (i=0; i<pa->npoints; i++)
@@ -676,20 +674,10 @@ pointArray_toGML2(POINTARRAY *pa, char *output, int precision)
 			const POINT2D *pt;
 			pt = getPoint2d_cp(pa, i);
 
-			if (fabs(pt->x) < OUT_MAX_DOUBLE)
-				sprintf(x, "%.*f", precision, pt->x);
-			else
-				sprintf(x, "%g", pt->x);
-			trim_trailing_zeros(x);
-
-			if (fabs(pt->y) < OUT_MAX_DOUBLE)
-				sprintf(y, "%.*f", precision, pt->y);
-			else
-				sprintf(y, "%g", pt->y);
-			trim_trailing_zeros(y);
-
-			if ( i ) ptr += sprintf(ptr, " ");
-			ptr += sprintf(ptr, "%s,%s", x, y);
+			if ( i ) *ptr++ = ' ';
+			ptr += lwprint_double(pt->x, precision, ptr, OUT_DOUBLE_BUFFER_SIZE);
+			*ptr++ = ',';
+			ptr += lwprint_double(pt->y, precision, ptr, OUT_DOUBLE_BUFFER_SIZE);
 		}
 	}
 	else
@@ -699,28 +687,15 @@ pointArray_toGML2(POINTARRAY *pa, char *output, int precision)
 			const POINT3DZ *pt;
 			pt = getPoint3dz_cp(pa, i);
 
-			if (fabs(pt->x) < OUT_MAX_DOUBLE)
-				sprintf(x, "%.*f", precision, pt->x);
-			else
-				sprintf(x, "%g", pt->x);
-			trim_trailing_zeros(x);
-
-			if (fabs(pt->y) < OUT_MAX_DOUBLE)
-				sprintf(y, "%.*f", precision, pt->y);
-			else
-				sprintf(y, "%g", pt->y);
-			trim_trailing_zeros(y);
-
-			if (fabs(pt->z) < OUT_MAX_DOUBLE)
-				sprintf(z, "%.*f", precision, pt->z);
-			else
-				sprintf(z, "%g", pt->z);
-			trim_trailing_zeros(z);
-
-			if ( i ) ptr += sprintf(ptr, " ");
-			ptr += sprintf(ptr, "%s,%s,%s", x, y, z);
+			if ( i ) *ptr++ = ' ';
+			ptr += lwprint_double(pt->x, precision, ptr, OUT_DOUBLE_BUFFER_SIZE);
+			*ptr++ = ',';
+			ptr += lwprint_double(pt->y, precision, ptr, OUT_DOUBLE_BUFFER_SIZE);
+			*ptr++ = ',';
+			ptr += lwprint_double(pt->z, precision, ptr, OUT_DOUBLE_BUFFER_SIZE);
 		}
 	}
+	*ptr = '\0';
 
 	return ptr-output;
 }
@@ -1910,12 +1885,10 @@ pointArray_toGML3(POINTARRAY *pa, char *output, int precision, int opts)
 {
 	int i;
 	char *ptr;
-	char x[OUT_MAX_DIGS_DOUBLE+OUT_MAX_DOUBLE_PRECISION+1];
-	char y[OUT_MAX_DIGS_DOUBLE+OUT_MAX_DOUBLE_PRECISION+1];
-	char z[OUT_MAX_DIGS_DOUBLE+OUT_MAX_DOUBLE_PRECISION+1];
-
 	ptr = output;
 
+	/* ordinates are printed in place, the output is sized for them */
+
 	if ( ! FLAGS_GET_Z(pa->flags) )
 	{
 		for (i=0; i<pa->npoints; i++)
@@ -1923,23 +1896,10 @@ pointArray_toGML3(POINTARRAY *pa, char *output, int precision, int opts)
 			const POINT2D *pt;
 			pt = getPoint2d_cp(pa, i);
 
-			if (fabs(pt->x) < OUT_MAX_DOUBLE)
-				sprintf(x, "%.*f", precision, pt->x);
-			else
-				sprintf(x, "%g", pt->x);
-			trim_trailing_zeros(x);
-
-			if (fabs(pt->y) < OUT_MAX_DOUBLE)
-				sprintf(y, "%.*f", precision, pt->y);
-			else
-				sprintf(y, "%g", pt->y);
-			trim_trailing_zeros(y);
-
-			if ( i ) ptr += sprintf(ptr, " ");
-			if (IS_DEGREE(opts))
-				ptr += sprintf(ptr, "%s %s", y, x);
-			else
-				ptr += sprintf(ptr, "%s %s", x, y);
+			if ( i ) *ptr++ = ' ';
+			ptr += lwprint_double(IS_DEGREE(opts) ? pt->y : pt->x, precision, ptr, OUT_DOUBLE_BUFFER_SIZE);
+			*ptr++ = ' ';
+			ptr += lwprint_double(IS_DEGREE(opts) ? pt->x : pt->y, precision, ptr, OUT_DOUBLE_BUFFER_SIZE);
 		}
 	}
 	else
@@ -1949,31 +1909,15 @@ pointArray_toGML3(POINTARRAY *pa, char *output, int precision, int opts)
 			const POINT3DZ *pt;
 			pt = getPoint3dz_cp(pa, i);
 
-			if (fabs(pt->x) < OUT_MAX_DOUBLE)
-				sprintf(x, "%.*f", precision, pt->x);
-			else
-				sprintf(x, "%g", pt->x);
-			trim_trailing_zeros(x);
-
-			if (fabs(pt->y) < OUT_MAX_DOUBLE)
-				sprintf(y, "%.*f", precision, pt->y);
-			else
-				sprintf(y, "%g", pt->y);
-			trim_trailing_zeros(y);
-
-			if (fabs(pt->z) < OUT_MAX_DOUBLE)
-				sprintf(z, "%.*f", precision, pt->z);
-			else
-				sprintf(z, "%g", pt->z);
-			trim_trailing_zeros(z);
-
-			if ( i ) ptr += sprintf(ptr, " ");
-			if (IS_DEGREE(opts))
-				ptr += sprintf(ptr, "%s %s %s", y, x, z);
-			else
-				ptr += sprintf(ptr, "%s %s %s", x, y, z);
+			if ( i ) *ptr++ = ' ';
+			ptr += lwprint_double(IS_DEGREE(opts) ? pt->y : pt->x, precision, ptr, OUT_DOUBLE_BUFFER_SIZE);
+			*ptr++ = ' ';
+			ptr += lwprint_double(IS_DEGREE(opts) ? pt->x : pt->y, precision, ptr, OUT_DOUBLE_BUFFER_SIZE);
+			*ptr++ = ' ';
+			ptr += lwprint_double(pt->z, precision, ptr, OUT_DOUBLE_BUFFER_SIZE);
 		}
 	}
+	*ptr = '\0';
 
 	return ptr-output;
 }
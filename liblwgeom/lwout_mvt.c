@@ -0,0 +1,925 @@
+/**********************************************************************
+ *
+ * PostGIS - Spatial Types for PostgreSQL
+ * http://postgis.net
+ *
+ * PostGIS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * PostGIS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with PostGIS.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ **********************************************************************/
+
+
+/**
+* Mapbox Vector Tile output
+*
+* Features are transformed to tile coordinates, clipped to the buffered
+* tile, quantized and encoded as protobuf in a single pass over the
+* LWGEOM. See https://github.com/mapbox/vector-tile-spec/tree/master/2.1
+*/
+
+#include "liblwgeom_internal.h"
+#include "bytebuffer.h"
+#include "varint.h"
+
+/* Protobuf wire types */
+#define MVT_WIRE_VARINT 0
+#define MVT_WIRE_64BIT 1
+#define MVT_WIRE_LENGTH 2
+
+#define MVT_TAG(field, wire) ((uint8_t)(((field) << 3) | (wire)))
+
+/* Geometry commands */
+#define MVT_CMD_MOVETO 1
+#define MVT_CMD_LINETO 2
+#define MVT_CMD_CLOSEPATH 7
+
+/* Feature geometry types */
+#define MVT_POINT 1
+#define MVT_LINESTRING 2
+#define MVT_POLYGON 3
+
+/* Quantized coordinates are kept in a range whose deltas fit an int32 */
+#define MVT_MAX_COORD 1073741823.0
+
+struct mvt_layer
+{
+	char *name;
+	GBOX bounds;
+	uint32_t extent;
+	double sx, sy;          /* tile units per geometry unit */
+	double lo, hi;          /* buffered tile, in tile units */
+	int clip_geom;
+
+	char **keys;
+	uint32_t nkeys, maxkeys;
+
+	bytebuffer_t values;    /* encoded Value messages, back to back */
+	size_t *value_offsets;  /* nvalues + 1 offsets into values */
+	uint32_t nvalues, maxvalues;
+	uint32_t *value_hash;   /* open addressing, value index + 1 or 0 */
+	uint32_t hash_size;
+
+	bytebuffer_t features;  /* encoded Feature fields of the Layer */
+	uint32_t nfeatures;
+
+	/* Feature being built */
+	uint8_t type;
+	int clip_feature;
+	bytebuffer_t geom;      /* packed geometry commands */
+	bytebuffer_t tags;      /* packed tags */
+	bytebuffer_t value;     /* Value being looked up */
+	int32_t cx, cy;         /* command cursor */
+
+	/* Scratch point arrays */
+	double *d[2];
+	uint32_t maxd[2];
+	int32_t *pts;
+	uint32_t npts, maxpts;
+};
+
+
+static size_t
+mvt_varint_size(uint64_t val)
+{
+	size_t size = 1;
+	while ( val >= 0x80 )
+	{
+		val >>= 7;
+		size++;
+	}
+	return size;
+}
+
+static double *
+mvt_reserve_double(MVT_LAYER *layer, int i, uint32_t size)
+{
+	if ( size > layer->maxd[i] )
+	{
+		while ( layer->maxd[i] < size )
+			layer->maxd[i] *= 2;
+		layer->d[i] = lwrealloc(layer->d[i], layer->maxd[i] * sizeof(double));
+	}
+	return layer->d[i];
+}
+
+static void
+mvt_reserve_points(MVT_LAYER *layer, uint32_t npoints)
+{
+	if ( 2 * npoints > layer->maxpts )
+	{
+		while ( layer->maxpts < 2 * npoints )
+			layer->maxpts *= 2;
+		layer->pts = lwrealloc(layer->pts, layer->maxpts * sizeof(int32_t));
+	}
+}
+
+static inline int32_t
+mvt_quantize(double v)
+{
+	if ( v > MVT_MAX_COORD ) v = MVT_MAX_COORD;
+	else if ( v < -MVT_MAX_COORD ) v = -MVT_MAX_COORD;
+	return (int32_t) floor(v + 0.5);
+}
+
+
+/**
+* Create a layer named name, with features within bounds mapped to
+* [0, extent] tile coordinates, the Y axis pointing down. With clip_geom
+* set, geometries are clipped to the tile grown by buffer on each side.
+*/
+MVT_LAYER *
+mvt_layer_create(const char *name, const GBOX *bounds, uint32_t extent, uint32_t buffer, int clip_geom)
+{
+	MVT_LAYER *layer;
+
+	if ( bounds->xmax <= bounds->xmin || bounds->ymax <= bounds->ymin )
+	{
+		lwerror("%s: bounds width and height must be positive", __func__);
+		return NULL;
+	}
+	if ( ! extent )
+	{
+		lwerror("%s: extent must be positive", __func__);
+		return NULL;
+	}
+
+	layer = lwalloc(sizeof(MVT_LAYER));
+	layer->name = lwalloc(strlen(name) + 1);
+	strcpy(layer->name, name);
+	layer->bounds = *bounds;
+	layer->extent = extent;
+	layer->sx = extent / (bounds->xmax - bounds->xmin);
+	layer->sy = extent / (bounds->ymax - bounds->ymin);
+	layer->lo = - (double) buffer;
+	layer->hi = (double) extent + buffer;
+	layer->clip_geom = clip_geom;
+
+	layer->nkeys = 0;
+	layer->maxkeys = 8;
+	layer->keys = lwalloc(layer->maxkeys * sizeof(char*));
+
+	bytebuffer_init_with_size(&(layer->values), BYTEBUFFER_STARTSIZE);
+	layer->nvalues = 0;
+	layer->maxvalues = 64;
+	layer->value_offsets = lwalloc((layer->maxvalues + 1) * sizeof(size_t));
+	layer->value_offsets[0] = 0;
+	layer->hash_size = 2 * layer->maxvalues;
+	layer->value_hash = lwalloc(layer->hash_size * sizeof(uint32_t));
+	memset(layer->value_hash, 0, layer->hash_size * sizeof(uint32_t));
+
+	bytebuffer_init_with_size(&(layer->features), 4 * BYTEBUFFER_STARTSIZE);
+	layer->nfeatures = 0;
+
+	layer->type = 0;
+	layer->clip_feature = 0;
+	bytebuffer_init_with_size(&(layer->geom), BYTEBUFFER_STARTSIZE);
+	bytebuffer_init_with_size(&(layer->tags), BYTEBUFFER_STARTSIZE);
+	bytebuffer_init_with_size(&(layer->value), BYTEBUFFER_STARTSIZE);
+	layer->cx = layer->cy = 0;
+
+	layer->maxd[0] = layer->maxd[1] = 64;
+	layer->d[0] = lwalloc(layer->maxd[0] * sizeof(double));
+	layer->d[1] = lwalloc(layer->maxd[1] * sizeof(double));
+	layer->npts = 0;
+	layer->maxpts = 64;
+	layer->pts = lwalloc(layer->maxpts * sizeof(int32_t));
+
+	return layer;
+}
+
+void
+mvt_layer_free(MVT_LAYER *layer)
+{
+	uint32_t i;
+
+	for ( i = 0; i < layer->nkeys; i++ )
+		lwfree(layer->keys[i]);
+	lwfree(layer->keys);
+	lwfree(layer->name);
+	lwfree(layer->values.buf_start);
+	lwfree(layer->value_offsets);
+	lwfree(layer->value_hash);
+	lwfree(layer->features.buf_start);
+	lwfree(layer->geom.buf_start);
+	lwfree(layer->tags.buf_start);
+	lwfree(layer->value.buf_start);
+	lwfree(layer->d[0]);
+	lwfree(layer->d[1]);
+	lwfree(layer->pts);
+	lwfree(layer);
+}
+
+/**
+* Return the index of key in the layer keys, adding it if needed.
+*/
+uint32_t
+mvt_layer_key(MVT_LAYER *layer, const char *key)
+{
+	uint32_t i;
+
+	for ( i = 0; i < layer->nkeys; i++ )
+	{
+		if ( strcmp(layer->keys[i], key) == 0 )
+			return i;
+	}
+
+	if ( layer->nkeys == layer->maxkeys )
+	{
+		layer->maxkeys *= 2;
+		layer->keys = lwrealloc(layer->keys, layer->maxkeys * sizeof(char*));
+	}
+	layer->keys[i] = lwalloc(strlen(key) + 1);
+	strcpy(layer->keys[i], key);
+	layer->nkeys++;
+
+	return i;
+}
+
+
+/*
+* Geometry encoding
+*/
+
+static inline void
+mvt_command(MVT_LAYER *layer, uint32_t id, uint32_t count)
+{
+	bytebuffer_append_uvarint(&(layer->geom), (id & 0x7) | (count << 3));
+}
+
+static inline void
+mvt_param(MVT_LAYER *layer, int32_t x, int32_t y)
+{
+	bytebuffer_append_uvarint(&(layer->geom), zigzag64((int64_t) x - layer->cx));
+	bytebuffer_append_uvarint(&(layer->geom), zigzag64((int64_t) y - layer->cy));
+	layer->cx = x;
+	layer->cy = y;
+}
+
+/**
+* Load a point array into scratch array i, in tile coordinates.
+*/
+static double *
+mvt_load_ptarray(MVT_LAYER *layer, int i, const POINTARRAY *pa, uint32_t npoints)
+{
+	double *d = mvt_reserve_double(layer, i, 2 * npoints);
+	const POINT2D *pt;
+	uint32_t j;
+
+	for ( j = 0; j < npoints; j++ )
+	{
+		pt = getPoint2d_cp(pa, j);
+		d[2*j] = (pt->x - layer->bounds.xmin) * layer->sx;
+		d[2*j+1] = (layer->bounds.ymax - pt->y) * layer->sy;
+	}
+	return d;
+}
+
+/**
+* Quantize npoints tile coordinates into layer->pts, dropping
+* consecutive duplicates. Returns the number of points kept.
+*/
+static uint32_t
+mvt_quantize_points(MVT_LAYER *layer, const double *d, uint32_t npoints)
+{
+	uint32_t i, n = 0;
+	int32_t x, y;
+
+	mvt_reserve_points(layer, npoints);
+	for ( i = 0; i < npoints; i++ )
+	{
+		x = mvt_quantize(d[2*i]);
+		y = mvt_quantize(d[2*i+1]);
+		if ( n && x == layer->pts[2*n-2] && y == layer->pts[2*n-1] )
+			continue;
+		layer->pts[2*n] = x;
+		layer->pts[2*n+1] = y;
+		n++;
+	}
+	return n;
+}
+
+static inline int
+mvt_point_inside(const MVT_LAYER *layer, double x, double y)
+{
+	return x >= layer->lo && x <= layer->hi && y >= layer->lo && y <= layer->hi;
+}
+
+static void
+mvt_collect_point(MVT_LAYER *layer, const LWPOINT *point)
+{
+	const POINT2D *pt;
+	double x, y;
+
+	if ( lwpoint_is_empty(point) )
+		return;
+
+	pt = getPoint2d_cp(point->point, 0);
+	x = (pt->x - layer->bounds.xmin) * layer->sx;
+	y = (layer->bounds.ymax - pt->y) * layer->sy;
+	if ( layer->clip_feature && ! mvt_point_inside(layer, x, y) )
+		return;
+
+	mvt_reserve_points(layer, layer->npts + 1);
+	layer->pts[2*layer->npts] = mvt_quantize(x);
+	layer->pts[2*layer->npts+1] = mvt_quantize(y);
+	layer->npts++;
+}
+
+static void
+mvt_emit_line(MVT_LAYER *layer, const double *d, uint32_t npoints)
+{
+	uint32_t i, n;
+
+	n = mvt_quantize_points(layer, d, npoints);
+	/* Lines collapsed to a single tile unit are dropped */
+	if ( n < 2 )
+		return;
+
+	mvt_command(layer, MVT_CMD_MOVETO, 1);
+	mvt_param(layer, layer->pts[0], layer->pts[1]);
+	mvt_command(layer, MVT_CMD_LINETO, n - 1);
+	for ( i = 1; i < n; i++ )
+		mvt_param(layer, layer->pts[2*i], layer->pts[2*i+1]);
+}
+
+/**
+* Liang-Barsky clipping of the segment starting at (x, y) with
+* direction (dx, dy) to the buffered tile. On success the kept part
+* is [t0, t1] along the segment.
+*/
+static int
+mvt_clip_segment(const MVT_LAYER *layer, double x, double y, double dx, double dy, double *t0, double *t1)
+{
+	double p[4], q[4], r;
+	int k;
+
+	p[0] = -dx; q[0] = x - layer->lo;
+	p[1] = dx;  q[1] = layer->hi - x;
+	p[2] = -dy; q[2] = y - layer->lo;
+	p[3] = dy;  q[3] = layer->hi - y;
+
+	*t0 = 0.0;
+	*t1 = 1.0;
+	for ( k = 0; k < 4; k++ )
+	{
+		if ( p[k] == 0.0 )
+		{
+			if ( q[k] < 0.0 ) return LW_FALSE;
+			continue;
+		}
+		r = q[k] / p[k];
+		if ( p[k] < 0.0 )
+		{
+			if ( r > *t1 ) return LW_FALSE;
+			if ( r > *t0 ) *t0 = r;
+		}
+		else
+		{
+			if ( r < *t0 ) return LW_FALSE;
+			if ( r < *t1 ) *t1 = r;
+		}
+	}
+	return LW_TRUE;
+}
+
+static void
+mvt_encode_line(MVT_LAYER *layer, const POINTARRAY *pa)
+{
+	const double *d;
+	double *out;
+	double dx, dy, t0, t1;
+	uint32_t i, n = 0;
+
+	if ( pa->npoints < 2 )
+		return;
+
+	d = mvt_load_ptarray(layer, 0, pa, pa->npoints);
+	if ( ! layer->clip_feature )
+	{
+		mvt_emit_line(layer, d, pa->npoints);
+		return;
+	}
+
+	/* Each segment adds at most two points to the clipped pieces */
+	out = mvt_reserve_double(layer, 1, 4 * pa->npoints);
+	for ( i = 0; i + 1 < pa->npoints; i++ )
+	{
+		dx = d[2*i+2] - d[2*i];
+		dy = d[2*i+3] - d[2*i+1];
+		if ( ! mvt_clip_segment(layer, d[2*i], d[2*i+1], dx, dy, &t0, &t1) )
+		{
+			if ( n ) mvt_emit_line(layer, out, n);
+			n = 0;
+			continue;
+		}
+
+		/* Start a new piece where the line enters the tile */
+		if ( ! n || t0 > 0.0 )
+		{
+			if ( n ) mvt_emit_line(layer, out, n);
+			out[0] = d[2*i] + t0 * dx;
+			out[1] = d[2*i+1] + t0 * dy;
+			n = 1;
+		}
+		out[2*n] = d[2*i] + t1 * dx;
+		out[2*n+1] = d[2*i+1] + t1 * dy;
+		n++;
+
+		/* and end it where it leaves */
+		if ( t1 < 1.0 )
+		{
+			mvt_emit_line(layer, out, n);
+			n = 0;
+		}
+	}
+	if ( n ) mvt_emit_line(layer, out, n);
+}
+
+/**
+* Sutherland-Hodgman clipping of a ring of npoints (not closed) in
+* scratch array 0 against one side of the buffered tile, output in
+* scratch array 1.
+*/
+static uint32_t
+mvt_clip_ring_side(MVT_LAYER *layer, uint32_t npoints, int axis, double bound, int keep_above)
+{
+	const double *in;
+	double *out, t;
+	const double *cur, *prev;
+	int cin, pin;
+	uint32_t i, n = 0;
+
+	out = mvt_reserve_double(layer, 1, 4 * npoints);
+	in = layer->d[0];
+	prev = in + 2 * (npoints - 1);
+	pin = keep_above ? prev[axis] >= bound : prev[axis] <= bound;
+	for ( i = 0; i < npoints; i++ )
+	{
+		cur = in + 2 * i;
+		cin = keep_above ? cur[axis] >= bound : cur[axis] <= bound;
+		if ( cin != pin )
+		{
+			t = (bound - prev[axis]) / (cur[axis] - prev[axis]);
+			out[2*n] = prev[0] + t * (cur[0] - prev[0]);
+			out[2*n+1] = prev[1] + t * (cur[1] - prev[1]);
+			out[2*n+axis] = bound;
+			n++;
+		}
+		if ( cin )
+		{
+			out[2*n] = cur[0];
+			out[2*n+1] = cur[1];
+			n++;
+		}
+		prev = cur;
+		pin = cin;
+	}
+
+	/* Swap the scratch arrays, the output becomes the next input */
+	layer->d[1] = layer->d[0];
+	layer->d[0] = out;
+	i = layer->maxd[1];
+	layer->maxd[1] = layer->maxd[0];
+	layer->maxd[0] = i;
+
+	return n;
+}
+
+static int
+mvt_encode_ring(MVT_LAYER *layer, const POINTARRAY *pa, int exterior)
+{
+	uint32_t i, n;
+	double area = 0.0;
+	const int32_t *p;
+
+	if ( pa->npoints < 4 )
+		return LW_FAILURE;
+
+	/* The closing point is implied by ClosePath */
+	n = pa->npoints - 1;
+	mvt_load_ptarray(layer, 0, pa, n);
+	if ( layer->clip_feature )
+	{
+		n = mvt_clip_ring_side(layer, n, 0, layer->lo, LW_TRUE);
+		if ( n ) n = mvt_clip_ring_side(layer, n, 0, layer->hi, LW_FALSE);
+		if ( n ) n = mvt_clip_ring_side(layer, n, 1, layer->lo, LW_TRUE);
+		if ( n ) n = mvt_clip_ring_side(layer, n, 1, layer->hi, LW_FALSE);
+		if ( n < 3 )
+			return LW_FAILURE;
+	}
+
+	n = mvt_quantize_points(layer, layer->d[0], n);
+	p = layer->pts;
+	while ( n > 1 && p[2*n-2] == p[0] && p[2*n-1] == p[1] )
+		n--;
+	if ( n < 3 )
+		return LW_FAILURE;
+
+	/* Rings collapsed to no area are dropped */
+	for ( i = 0; i < n; i++ )
+	{
+		uint32_t j = (i + 1) % n;
+		area += (double) p[2*i] * p[2*j+1] - (double) p[2*j] * p[2*i+1];
+	}
+	if ( area == 0.0 )
+		return LW_FAILURE;
+
+	mvt_command(layer, MVT_CMD_MOVETO, 1);
+	mvt_param(layer, p[0], p[1]);
+	mvt_command(layer, MVT_CMD_LINETO, n - 1);
+
+	/* Exterior rings have a positive area in tile coordinates,
+	   interior rings a negative one */
+	if ( (area > 0.0) == (exterior != 0) )
+	{
+		for ( i = 1; i < n; i++ )
+			mvt_param(layer, p[2*i], p[2*i+1]);
+	}
+	else
+	{
+		for ( i = n - 1; i > 0; i-- )
+			mvt_param(layer, p[2*i], p[2*i+1]);
+	}
+	mvt_command(layer, MVT_CMD_CLOSEPATH, 1);
+
+	return LW_SUCCESS;
+}
+
+static void
+mvt_encode_poly(MVT_LAYER *layer, const LWPOLY *poly)
+{
+	int i;
+
+	if ( ! poly->nrings )
+		return;
+
+	/* Holes of a dropped shell are dropped too */
+	if ( mvt_encode_ring(layer, poly->rings[0], LW_TRUE) == LW_FAILURE )
+		return;
+
+	for ( i = 1; i < poly->nrings; i++ )
+		mvt_encode_ring(layer, poly->rings[i], LW_FALSE);
+}
+
+/**
+* Highest dimension of the points, lines and polygons in geom,
+* -1 if there is none.
+*/
+static int
+mvt_geom_dimension(const LWGEOM *geom)
+{
+	const LWCOLLECTION *col;
+	int i, dim, maxdim = -1;
+
+	if ( lwgeom_is_empty(geom) )
+		return -1;
+
+	switch ( geom->type )
+	{
+	case POINTTYPE:
+	case MULTIPOINTTYPE:
+		return 0;
+	case LINETYPE:
+	case MULTILINETYPE:
+		return 1;
+	case POLYGONTYPE:
+	case MULTIPOLYGONTYPE:
+		return 2;
+	case COLLECTIONTYPE:
+		col = (const LWCOLLECTION*) geom;
+		for ( i = 0; i < col->ngeoms; i++ )
+		{
+			dim = mvt_geom_dimension(col->geoms[i]);
+			if ( dim > maxdim ) maxdim = dim;
+		}
+		return maxdim;
+	default:
+		return -1;
+	}
+}
+
+/**
+* Encode the components of geom of dimension dim, a vector tile
+* feature only holds a single geometry type.
+*/
+static void
+mvt_encode_geom(MVT_LAYER *layer, const LWGEOM *geom, int dim)
+{
+	const LWCOLLECTION *col;
+	int i;
+
+	switch ( geom->type )
+	{
+	case POINTTYPE:
+		if ( dim == 0 ) mvt_collect_point(layer, (const LWPOINT*) geom);
+		break;
+	case LINETYPE:
+		if ( dim == 1 ) mvt_encode_line(layer, ((const LWLINE*) geom)->points);
+		break;
+	case POLYGONTYPE:
+		if ( dim == 2 ) mvt_encode_poly(layer, (const LWPOLY*) geom);
+		break;
+	case MULTIPOINTTYPE:
+	case MULTILINETYPE:
+	case MULTIPOLYGONTYPE:
+	case COLLECTIONTYPE:
+		col = (const LWCOLLECTION*) geom;
+		for ( i = 0; i < col->ngeoms; i++ )
+			mvt_encode_geom(layer, col->geoms[i], dim);
+		break;
+	default:
+		break;
+	}
+}
+
+/**
+* Start a new feature with geometry geom. Returns LW_FAILURE if nothing
+* is left of the geometry once clipped and quantized, the feature is
+* then skipped. Otherwise add the feature tags with the
+* mvt_layer_feature_* functions and finish it with mvt_layer_feature_end.
+*/
+int
+mvt_layer_feature_begin(MVT_LAYER *layer, const LWGEOM *geom)
+{
+	GBOX gbox;
+	double xmin, xmax, ymin, ymax;
+	LWGEOM *stroked = NULL;
+	int dim;
+
+	bytebuffer_clear(&(layer->geom));
+	bytebuffer_clear(&(layer->tags));
+	layer->cx = layer->cy = 0;
+	layer->npts = 0;
+	layer->type = 0;
+
+	if ( lwgeom_is_empty(geom) )
+		return LW_FAILURE;
+
+	if ( geom->bbox )
+		gbox = *(geom->bbox);
+	else if ( lwgeom_calculate_gbox(geom, &gbox) == LW_FAILURE )
+		return LW_FAILURE;
+
+	/* Features outside the buffered tile are skipped, and those
+	   inside it do not need clipping */
+	layer->clip_feature = 0;
+	if ( layer->clip_geom )
+	{
+		xmin = (gbox.xmin - layer->bounds.xmin) * layer->sx;
+		xmax = (gbox.xmax - layer->bounds.xmin) * layer->sx;
+		ymin = (layer->bounds.ymax - gbox.ymax) * layer->sy;
+		ymax = (layer->bounds.ymax - gbox.ymin) * layer->sy;
+		if ( xmax < layer->lo || xmin > layer->hi || ymax < layer->lo || ymin > layer->hi )
+			return LW_FAILURE;
+		layer->clip_feature = ! ( xmin >= layer->lo && xmax <= layer->hi &&
+		                          ymin >= layer->lo && ymax <= layer->hi );
+	}
+
+	if ( lwgeom_has_arc(geom) )
+		geom = stroked = lwgeom_stroke(geom, 32);
+
+	dim = mvt_geom_dimension(geom);
+	if ( dim >= 0 )
+		mvt_encode_geom(layer, geom, dim);
+
+	if ( stroked )
+		lwgeom_free(stroked);
+
+	if ( dim == 0 && layer->npts )
+	{
+		uint32_t i;
+		mvt_command(layer, MVT_CMD_MOVETO, layer->npts);
+		for ( i = 0; i < layer->npts; i++ )
+			mvt_param(layer, layer->pts[2*i], layer->pts[2*i+1]);
+	}
+
+	if ( ! bytebuffer_getlength(&(layer->geom)) )
+		return LW_FAILURE;
+
+	layer->type = dim == 0 ? MVT_POINT : dim == 1 ? MVT_LINESTRING : MVT_POLYGON;
+	return LW_SUCCESS;
+}
+
+
+/*
+* Feature tags
+*/
+
+/**
+* Return the index of the Value message held in layer->value,
+* adding it to the layer values if needed.
+*/
+static uint32_t
+mvt_value_index(MVT_LAYER *layer)
+{
+	const uint8_t *v = layer->value.buf_start;
+	size_t len = bytebuffer_getlength(&(layer->value));
+	uint32_t hash = 2166136261u;
+	uint32_t h, i, idx;
+	size_t j;
+
+	/* FNV-1a */
+	for ( j = 0; j < len; j++ )
+		hash = (hash ^ v[j]) * 16777619u;
+
+	for ( h = hash & (layer->hash_size - 1); layer->value_hash[h]; h = (h + 1) & (layer->hash_size - 1) )
+	{
+		idx = layer->value_hash[h] - 1;
+		if ( layer->value_offsets[idx+1] - layer->value_offsets[idx] == len &&
+		     memcmp(layer->values.buf_start + layer->value_offsets[idx], v, len) == 0 )
+			return idx;
+	}
+
+	idx = layer->nvalues++;
+	bytebuffer_append_bulk(&(layer->values), (void*) v, len);
+	if ( layer->nvalues > layer->maxvalues )
+	{
+		layer->maxvalues *= 2;
+		layer->value_offsets = lwrealloc(layer->value_offsets, (layer->maxvalues + 1) * sizeof(size_t));
+	}
+	layer->value_offsets[layer->nvalues] = bytebuffer_getlength(&(layer->values));
+	layer->value_hash[h] = idx + 1;
+
+	/* Keep the hash table at most half full */
+	if ( 2 * layer->nvalues > layer->hash_size )
+	{
+		lwfree(layer->value_hash);
+		layer->hash_size *= 2;
+		layer->value_hash = lwalloc(layer->hash_size * sizeof(uint32_t));
+		memset(layer->value_hash, 0, layer->hash_size * sizeof(uint32_t));
+		for ( i = 0; i < layer->nvalues; i++ )
+		{
+			const uint8_t *s = layer->values.buf_start + layer->value_offsets[i];
+			len = layer->value_offsets[i+1] - layer->value_offsets[i];
+			hash = 2166136261u;
+			for ( j = 0; j < len; j++ )
+				hash = (hash ^ s[j]) * 16777619u;
+			for ( h = hash & (layer->hash_size - 1); layer->value_hash[h]; h = (h + 1) & (layer->hash_size - 1) );
+			layer->value_hash[h] = i + 1;
+		}
+	}
+
+	return idx;
+}
+
+static void
+mvt_add_tag(MVT_LAYER *layer, uint32_t key)
+{
+	bytebuffer_append_uvarint(&(layer->tags), key);
+	bytebuffer_append_uvarint(&(layer->tags), mvt_value_index(layer));
+}
+
+void
+mvt_layer_feature_string(MVT_LAYER *layer, uint32_t key, const char *value, size_t len)
+{
+	bytebuffer_clear(&(layer->value));
+	bytebuffer_append_byte(&(layer->value), MVT_TAG(1, MVT_WIRE_LENGTH));
+	bytebuffer_append_uvarint(&(layer->value), len);
+	bytebuffer_append_bulk(&(layer->value), (void*) value, len);
+	mvt_add_tag(layer, key);
+}
+
+void
+mvt_layer_feature_double(MVT_LAYER *layer, uint32_t key, double value)
+{
+	uint64_t u;
+	int i;
+
+	memcpy(&u, &value, sizeof(double));
+	bytebuffer_clear(&(layer->value));
+	bytebuffer_append_byte(&(layer->value), MVT_TAG(3, MVT_WIRE_64BIT));
+	/* fixed width values are little endian */
+	for ( i = 0; i < 8; i++ )
+		bytebuffer_append_byte(&(layer->value), (uint8_t) (u >> (8 * i)));
+	mvt_add_tag(layer, key);
+}
+
+void
+mvt_layer_feature_int(MVT_LAYER *layer, uint32_t key, int64_t value)
+{
+	bytebuffer_clear(&(layer->value));
+	if ( value < 0 )
+	{
+		bytebuffer_append_byte(&(layer->value), MVT_TAG(6, MVT_WIRE_VARINT));
+		bytebuffer_append_uvarint(&(layer->value), zigzag64(value));
+	}
+	else
+	{
+		bytebuffer_append_byte(&(layer->value), MVT_TAG(5, MVT_WIRE_VARINT));
+		bytebuffer_append_uvarint(&(layer->value), (uint64_t) value);
+	}
+	mvt_add_tag(layer, key);
+}
+
+void
+mvt_layer_feature_bool(MVT_LAYER *layer, uint32_t key, int value)
+{
+	bytebuffer_clear(&(layer->value));
+	bytebuffer_append_byte(&(layer->value), MVT_TAG(7, MVT_WIRE_VARINT));
+	bytebuffer_append_byte(&(layer->value), value ? 1 : 0);
+	mvt_add_tag(layer, key);
+}
+
+/**
+* Append the feature started by mvt_layer_feature_begin to the layer.
+*/
+void
+mvt_layer_feature_end(MVT_LAYER *layer)
+{
+	size_t tagslen = bytebuffer_getlength(&(layer->tags));
+	size_t geomlen = bytebuffer_getlength(&(layer->geom));
+	size_t len = 0;
+
+	if ( tagslen )
+		len += 1 + mvt_varint_size(tagslen) + tagslen;
+	len += 2;
+	len += 1 + mvt_varint_size(geomlen) + geomlen;
+
+	bytebuffer_append_byte(&(layer->features), MVT_TAG(2, MVT_WIRE_LENGTH));
+	bytebuffer_append_uvarint(&(layer->features), len);
+	if ( tagslen )
+	{
+		bytebuffer_append_byte(&(layer->features), MVT_TAG(2, MVT_WIRE_LENGTH));
+		bytebuffer_append_uvarint(&(layer->features), tagslen);
+		bytebuffer_append_bulk(&(layer->features), layer->tags.buf_start, tagslen);
+	}
+	bytebuffer_append_byte(&(layer->features), MVT_TAG(3, MVT_WIRE_VARINT));
+	bytebuffer_append_byte(&(layer->features), layer->type);
+	bytebuffer_append_byte(&(layer->features), MVT_TAG(4, MVT_WIRE_LENGTH));
+	bytebuffer_append_uvarint(&(layer->features), geomlen);
+	bytebuffer_append_bulk(&(layer->features), layer->geom.buf_start, geomlen);
+
+	layer->nfeatures++;
+}
+
+
+static uint8_t *
+mvt_write_bytes(uint8_t *ptr, uint8_t tag, const void *data, size_t len)
+{
+	*ptr++ = tag;
+	ptr += varint_u64_encode_buf(len, ptr);
+	memcpy(ptr, data, len);
+	return ptr + len;
+}
+
+/**
+* Return a vector tile holding the layer, its size is returned in size.
+*/
+uint8_t *
+mvt_layer_to_tile(const MVT_LAYER *layer, size_t *size)
+{
+	size_t namelen = strlen(layer->name);
+	size_t featureslen = bytebuffer_getlength((bytebuffer_t*) &(layer->features));
+	size_t layerlen, len;
+	uint8_t *tile, *ptr;
+	uint32_t i;
+
+	layerlen = 1 + mvt_varint_size(namelen) + namelen;
+	layerlen += featureslen;
+	for ( i = 0; i < layer->nkeys; i++ )
+	{
+		len = strlen(layer->keys[i]);
+		layerlen += 1 + mvt_varint_size(len) + len;
+	}
+	for ( i = 0; i < layer->nvalues; i++ )
+	{
+		len = layer->value_offsets[i+1] - layer->value_offsets[i];
+		layerlen += 1 + mvt_varint_size(len) + len;
+	}
+	layerlen += 1 + mvt_varint_size(layer->extent);
+	layerlen += 2; /* version */
+
+	*size = 1 + mvt_varint_size(layerlen) + layerlen;
+	ptr = tile = lwalloc(*size);
+
+	/* Tile.layers */
+	*ptr++ = MVT_TAG(3, MVT_WIRE_LENGTH);
+	ptr += varint_u64_encode_buf(layerlen, ptr);
+
+	ptr = mvt_write_bytes(ptr, MVT_TAG(1, MVT_WIRE_LENGTH), layer->name, namelen);
+	memcpy(ptr, layer->features.buf_start, featureslen);
+	ptr += featureslen;
+	for ( i = 0; i < layer->nkeys; i++ )
+		ptr = mvt_write_bytes(ptr, MVT_TAG(3, MVT_WIRE_LENGTH), layer->keys[i], strlen(layer->keys[i]));
+	for ( i = 0; i < layer->nvalues; i++ )
+		ptr = mvt_write_bytes(ptr, MVT_TAG(4, MVT_WIRE_LENGTH),
+		                      layer->values.buf_start + layer->value_offsets[i],
+		                      layer->value_offsets[i+1] - layer->value_offsets[i]);
+	*ptr++ = MVT_TAG(5, MVT_WIRE_VARINT);
+	ptr += varint_u64_encode_buf(layer->extent, ptr);
+	*ptr++ = MVT_TAG(15, MVT_WIRE_VARINT);
+	*ptr++ = 2;
+
+	assert((size_t)(ptr - tile) == *size);
+	return tile;
+}
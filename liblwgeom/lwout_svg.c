@@ -119,24 +119,16 @@ static size_t
 assvg_point_buf(const LWPOINT *point, char * output, int circle, int precision)
 {
 	char *ptr=output;
-	char x[OUT_MAX_DIGS_DOUBLE+OUT_MAX_DOUBLE_PRECISION+1];
-	char y[OUT_MAX_DIGS_DOUBLE+OUT_MAX_DOUBLE_PRECISION+1];
+	char x[OUT_DOUBLE_BUFFER_SIZE];
+	char y[OUT_DOUBLE_BUFFER_SIZE];
 	POINT2D pt;
 
 	getPoint2d_p(point->point, 0, &pt);
 
-	if (fabs(pt.x) < OUT_MAX_DOUBLE)
-		sprintf(x, "%.*f", precision, pt.x);
-	else
-		sprintf(x, "%g", pt.x);
-	trim_trailing_zeros(x);
+	lwprint_double(pt.x, precision, x, OUT_DOUBLE_BUFFER_SIZE);
 
 	/* SVG Y axis is reversed, an no need to transform 0 into -0 */
-	if (fabs(pt.y) < OUT_MAX_DOUBLE)
-		sprintf(y, "%.*f", precision, fabs(pt.y) ? pt.y * -1 : pt.y);
-	else
-		sprintf(y, "%g", fabs(pt.y) ? pt.y * -1 : pt.y);
-	trim_trailing_zeros(y);
+	lwprint_double(fabs(pt.y) ? pt.y * -1 : pt.y, precision, y, OUT_DOUBLE_BUFFER_SIZE);
 
 	if (circle) ptr += sprintf(ptr, "x=\"%s\" y=\"%s\"", x, y);
 	else ptr += sprintf(ptr, "cx=\"%s\" cy=\"%s\"", x, y);
@@ -561,8 +553,8 @@ pointArray_svg_rel(POINTARRAY *pa, char *output, int close_ring, int precision)
 {
 	int i, end;
 	char *ptr;
-	char sx[OUT_MAX_DIGS_DOUBLE+OUT_MAX_DOUBLE_PRECISION+1];
-	char sy[OUT_MAX_DIGS_DOUBLE+OUT_MAX_DOUBLE_PRECISION+1];
+	char sx[OUT_DOUBLE_BUFFER_SIZE];
+	char sy[OUT_DOUBLE_BUFFER_SIZE];
 	const POINT2D *pt;
 
 	double f = 1.0;
@@ -584,17 +576,9 @@ pointArray_svg_rel(POINTARRAY *pa, char *output, int close_ring, int precision)
 	x = round(pt->x*f)/f;
 	y = round(pt->y*f)/f;
 
-	if (fabs(x) < OUT_MAX_DOUBLE)
-		sprintf(sx, "%.*f", precision, x);
-	else
-		sprintf(sx, "%g", x);
-	trim_trailing_zeros(sx);
+	lwprint_double(x, precision, sx, OUT_DOUBLE_BUFFER_SIZE);
 
-	if (fabs(y) < OUT_MAX_DOUBLE)
-		sprintf(sy, "%.*f", precision, fabs(y) ? y * -1 : y);
-	else
-		sprintf(sy, "%g", fabs(y) ? y * -1 : y);
-	trim_trailing_zeros(sy);
+	lwprint_double(fabs(y) ? y * -1 : y, precision, sy, OUT_DOUBLE_BUFFER_SIZE);
 
 	ptr += sprintf(ptr,"%s %s l", sx, sy);
 	
@@ -614,25 +598,15 @@ pointArray_svg_rel(POINTARRAY *pa, char *output, int close_ring, int precision)
 		dx = x - accum_x;
 		dy = y - accum_y;
 		
-		if (fabs(dx) < OUT_MAX_DOUBLE)
-			sprintf(sx, "%.*f", precision, dx);
-		else
-			sprintf(sx, "%g", dx);
-		trim_trailing_zeros(sx);
-
+		/* ordinates are printed in place, the output is sized for them */
+		*ptr++ = ' ';
+		ptr += lwprint_double(dx, precision, ptr, OUT_DOUBLE_BUFFER_SIZE);
+		*ptr++ = ' ';
 		/* SVG Y axis is reversed, an no need to transform 0 into -0 */
-		if (fabs(dy) < OUT_MAX_DOUBLE)
-			sprintf(sy, "%.*f", precision,
-			        fabs(dy) ? dy * -1: dy);
-		else
-			sprintf(sy, "%g",
-			        fabs(dy) ? dy * -1: dy);
-		trim_trailing_zeros(sy);
+		ptr += lwprint_double(fabs(dy) ? dy * -1: dy, precision, ptr, OUT_DOUBLE_BUFFER_SIZE);
 		
 		accum_x += dx;
 		accum_y += dy;
-
-		ptr += sprintf(ptr," %s %s", sx, sy);
 	}
 
 	return (ptr-output);
@@ -647,8 +621,6 @@ pointArray_svg_abs(POINTARRAY *pa, char *output, int close_ring, int precision)
 {
 	int i, end;
 	char *ptr;
-	char x[OUT_MAX_DIGS_DOUBLE+OUT_MAX_DOUBLE_PRECISION+1];
-	char y[OUT_MAX_DIGS_DOUBLE+OUT_MAX_DOUBLE_PRECISION+1];
 	POINT2D pt;
 
 	ptr = output;
@@ -660,23 +632,16 @@ pointArray_svg_abs(POINTARRAY *pa, char *output, int close_ring, int precision)
 	{
 		getPoint2d_p(pa, i, &pt);
 
-		if (fabs(pt.x) < OUT_MAX_DOUBLE)
-			sprintf(x, "%.*f", precision, pt.x);
-		else
-			sprintf(x, "%g", pt.x);
-		trim_trailing_zeros(x);
+		if (i == 1) ptr += sprintf(ptr, " L ");
+		else if (i) *ptr++ = ' ';
 
+		/* ordinates are printed in place, the output is sized for them */
+		ptr += lwprint_double(pt.x, precision, ptr, OUT_DOUBLE_BUFFER_SIZE);
+		*ptr++ = ' ';
 		/* SVG Y axis is reversed, an no need to transform 0 into -0 */
-		if (fabs(pt.y) < OUT_MAX_DOUBLE)
-			sprintf(y, "%.*f", precision, fabs(pt.y) ? pt.y * -1:pt.y);
-		else
-			sprintf(y, "%g", fabs(pt.y) ? pt.y * -1:pt.y);
-		trim_trailing_zeros(y);
-
-		if (i == 1) ptr += sprintf(ptr, " L ");
-		else if (i) ptr += sprintf(ptr, " ");
-		ptr += sprintf(ptr,"%s %s", x, y);
+		ptr += lwprint_double(fabs(pt.y) ? pt.y * -1:pt.y, precision, ptr, OUT_DOUBLE_BUFFER_SIZE);
 	}
+	*ptr = '\0';
 
 	return (ptr-output);
 }
@@ -28,13 +28,13 @@
 /*
 * GeometryType, and dimensions
 */
-static uint8_t lwgeom_twkb_type(const LWGEOM *geom)
+static uint8_t lwtype_twkb_type(uint8_t type)
 {
 	uint8_t twkb_type = 0;
 
-	LWDEBUGF(2, "Entered  lwgeom_twkb_type",0);
+	LWDEBUGF(2, "Entered  lwtype_twkb_type",0);
 
-	switch ( geom->type )
+	switch ( type )
 	{
 		case POINTTYPE:
 			twkb_type = WKB_POINT_TYPE;
@@ -59,7 +59,7 @@ static uint8_t lwgeom_twkb_type(const LWGEOM *geom)
 			break;
 		default:
 			lwerror("Unsupported geometry type: %s [%d]",
-				lwtype_name(geom->type), geom->type);
+				lwtype_name(type), type);
 	}
 	return twkb_type;
 }
@@ -112,6 +112,9 @@ static int ptarray_to_twkb_buf(const POINTARRAY *pa, TWKB_GLOBALS *globals, TWKB
 	int64_t nextdelta[MAX_N_DIMS];
 	int npoints = 0;
 	size_t npoints_offset = 0;
+	/* Deltas waiting to be written as varints */
+	int64_t deltas[TWKB_OUT_CHUNK * MAX_N_DIMS];
+	int ndeltas = 0;
 
 	LWDEBUGF(2, "Entered %s", __func__);
 
@@ -179,11 +182,16 @@ static int ptarray_to_twkb_buf(const POINTARRAY *pa, TWKB_GLOBALS *globals, TWKB
 		/* We really added a point, so... */
 		npoints++;
 		
-		/* Write this vertex to the temporary buffer as varints */
+		/* Queue this vertex, it is written as varints a chunk at a time */
 		for ( j = 0; j < ndims; j++ )
 		{
 			ts->accum_rels[j] += nextdelta[j];
-			bytebuffer_append_varint(b_p, nextdelta[j]);
+			deltas[ndeltas++] = nextdelta[j];
+		}
+		if ( ndeltas == TWKB_OUT_CHUNK * ndims )
+		{
+			bytebuffer_append_varint_array(b_p, deltas, ndeltas);
+			ndeltas = 0;
 		}
 
 		/* See if this coordinate expands the bounding box */
@@ -201,6 +209,10 @@ static int ptarray_to_twkb_buf(const POINTARRAY *pa, TWKB_GLOBALS *globals, TWKB
 
 	}	
 
+	/* Write the last deltas */
+	if ( ndeltas )
+		bytebuffer_append_varint_array(b_p, deltas, ndeltas);
+
 	if ( pa->npoints > 127 )
 	{		
 		/* Now write the temporary results into the main buffer */
@@ -404,27 +416,11 @@ static int lwgeom_to_twkb_buf(const LWGEOM *geom, TWKB_GLOBALS *globals, TWKB_ST
 }
 
 
-static int lwgeom_write_to_buffer(const LWGEOM *geom, TWKB_GLOBALS *globals, TWKB_STATE *parent_state)
+/*
+* Factors that bring the ordinates to the requested precisions
+*/
+static void twkb_set_factors(TWKB_GLOBALS *globals, int has_z, int has_m)
 {
-	int i, is_empty, has_z, has_m, ndims;
-	size_t bbox_size = 0, optional_precision_byte = 0;
-	uint8_t flag = 0, type_prec = 0;
-
-	TWKB_STATE child_state;
-	memset(&child_state, 0, sizeof(TWKB_STATE));
-	child_state.header_buf = bytebuffer_create_with_size(16);
-	child_state.geom_buf = bytebuffer_create_with_size(64);
-	child_state.idlist = parent_state->idlist;
-
-	/* Read dimensionality from input */
-	has_z = lwgeom_has_z(geom);
-	has_m = lwgeom_has_m(geom);
-	ndims = lwgeom_ndims(geom);
-	is_empty = lwgeom_is_empty(geom);
-
-	/* Do we need extended precision? If we have a Z or M we do. */
-	optional_precision_byte = (has_z || has_m);
-
 	/* Both X and Y dimension use the same precision */
 	globals->factor[0] = pow(10, globals->prec_xy);
 	globals->factor[1] = globals->factor[0];
@@ -434,27 +430,29 @@ static int lwgeom_write_to_buffer(const LWGEOM *geom, TWKB_GLOBALS *globals, TWK
 		globals->factor[2] = pow(10, globals->prec_z);
 	if ( has_m )
 		globals->factor[2 + has_z] = pow(10, globals->prec_m);
+}
 
-	/* Reset stats */
-	for ( i = 0; i < MAX_N_DIMS; i++ )
-	{
-		/* Reset bbox calculation */
-		child_state.bbox_max[i] = INT64_MIN;
-		child_state.bbox_min[i] = INT64_MAX;
-		/* Reset acumulated delta values to get absolute values on next point */
-		child_state.accum_rels[i] = 0;
-	}
+/*
+* Type/precision byte, metadata byte and the optional extended
+* precision byte
+*/
+static void twkb_write_header(bytebuffer_t *header_buf, uint8_t twkb_type, int has_z, int has_m, int is_empty, int has_idlist, const TWKB_GLOBALS *globals)
+{
+	uint8_t flag = 0, type_prec = 0;
+
+	/* Do we need extended precision? If we have a Z or M we do. */
+	int optional_precision_byte = (has_z || has_m);
 
 	/* TYPE/PRECISION BYTE */
 	if ( abs(globals->prec_xy) > 7 )
 		lwerror("%s: X/Z precision cannot be greater than 7 or less than -7", __func__);
 	
 	/* Read the TWKB type number from the geometry */
-	TYPE_PREC_SET_TYPE(type_prec, lwgeom_twkb_type(geom));
+	TYPE_PREC_SET_TYPE(type_prec, twkb_type);
 	/* Zig-zag the precision value before encoding it since it is a signed value */
 	TYPE_PREC_SET_PREC(type_prec, zigzag8(globals->prec_xy));
 	/* Write the type and precision byte */
-	bytebuffer_append_byte(child_state.header_buf, type_prec);
+	bytebuffer_append_byte(header_buf, type_prec);
 
 	/* METADATA BYTE */
 	/* Set first bit if we are going to store bboxes */
@@ -462,13 +460,13 @@ static int lwgeom_write_to_buffer(const LWGEOM *geom, TWKB_GLOBALS *globals, TWK
 	/* Set second bit if we are going to store resulting size */
 	FIRST_BYTE_SET_SIZES(flag, globals->variant & TWKB_SIZE);
 	/* There will be no ID-list (for now) */
-	FIRST_BYTE_SET_IDLIST(flag, parent_state->idlist && ! is_empty);
+	FIRST_BYTE_SET_IDLIST(flag, has_idlist && ! is_empty);
 	/* Are there higher dimensions */
 	FIRST_BYTE_SET_EXTENDED(flag, optional_precision_byte);
 	/* Empty? */
 	FIRST_BYTE_SET_EMPTY(flag, is_empty);
 	/* Write the header byte */
-	bytebuffer_append_byte(child_state.header_buf, flag);
+	bytebuffer_append_byte(header_buf, flag);
 
 	/* EXTENDED PRECISION BYTE (OPTIONAL) */
 	/* If needed, write the extended dim byte */
@@ -486,18 +484,75 @@ static int lwgeom_write_to_buffer(const LWGEOM *geom, TWKB_GLOBALS *globals, TWK
 		HIGHER_DIM_SET_HASM(flag, has_m);
 		HIGHER_DIM_SET_PRECZ(flag, globals->prec_z);
 		HIGHER_DIM_SET_PRECM(flag, globals->prec_m);
-		bytebuffer_append_byte(child_state.header_buf, flag);
+		bytebuffer_append_byte(header_buf, flag);
+	}
+
+	/* If the geometry is empty and this output is sized, */
+	/* write the size of all following content, which is */
+	/* zero because there is none */
+	if ( is_empty && (globals->variant & TWKB_SIZE) )
+		bytebuffer_append_byte(header_buf, 0);
+}
+
+/*
+* Optional size and bbox, written once the geometry body is known
+*/
+static void twkb_write_size_bbox(TWKB_GLOBALS *globals, TWKB_STATE *ts, int ndims, size_t body_size)
+{
+	/* Did we have a box? If so, how big? */
+	size_t bbox_size = 0;
+	if( globals->variant & TWKB_BBOX )
+	{
+		LWDEBUG(4,"We want boxes and will calculate required size");
+		bbox_size = sizeof_bbox(ts, ndims);
 	}
 
+	/* Write the size if wanted */
+	if( globals->variant & TWKB_SIZE )
+	{
+		/* Here we have to add what we know will be written to header */
+		/* buffer after size value is written */
+		bytebuffer_append_uvarint(ts->header_buf, body_size + bbox_size);
+	}
+
+	if( globals->variant & TWKB_BBOX )
+		write_bbox(ts, ndims);
+}
+
+static int lwgeom_write_to_buffer(const LWGEOM *geom, TWKB_GLOBALS *globals, TWKB_STATE *parent_state)
+{
+	int i, is_empty, has_z, has_m, ndims;
+
+	TWKB_STATE child_state;
+	memset(&child_state, 0, sizeof(TWKB_STATE));
+	child_state.header_buf = bytebuffer_create_with_size(16);
+	child_state.geom_buf = bytebuffer_create_with_size(64);
+	child_state.idlist = parent_state->idlist;
+
+	/* Read dimensionality from input */
+	has_z = lwgeom_has_z(geom);
+	has_m = lwgeom_has_m(geom);
+	ndims = lwgeom_ndims(geom);
+	is_empty = lwgeom_is_empty(geom);
+
+	twkb_set_factors(globals, has_z, has_m);
+
+	/* Reset stats */
+	for ( i = 0; i < MAX_N_DIMS; i++ )
+	{
+		/* Reset bbox calculation */
+		child_state.bbox_max[i] = INT64_MIN;
+		child_state.bbox_min[i] = INT64_MAX;
+		/* Reset acumulated delta values to get absolute values on next point */
+		child_state.accum_rels[i] = 0;
+	}
+
+	twkb_write_header(child_state.header_buf, lwtype_twkb_type(geom->type), has_z, has_m,
+	                  is_empty, parent_state->idlist != NULL, globals);
+
 	/* It the geometry is empty, we're almost done */
 	if ( is_empty )
 	{
-		/* If this output is sized, write the size of */
-		/* all following content, which is zero because */
-		/* there is none */
-		if ( globals->variant & TWKB_SIZE )
-			bytebuffer_append_byte(child_state.header_buf, 0);
-
 		bytebuffer_append_bytebuffer(parent_state->geom_buf, child_state.header_buf);
 		bytebuffer_destroy(child_state.header_buf);
 		bytebuffer_destroy(child_state.geom_buf);
@@ -521,27 +576,8 @@ static int lwgeom_write_to_buffer(const LWGEOM *geom, TWKB_GLOBALS *globals, TWK
 				parent_state->bbox_max[i] = child_state.bbox_max[i];
 		}
 	}
-	
-	/* Did we have a box? If so, how big? */
-	bbox_size = 0;
-	if( globals->variant & TWKB_BBOX )
-	{
-		LWDEBUG(4,"We want boxes and will calculate required size");
-		bbox_size = sizeof_bbox(&child_state, ndims);
-	}
-
-	/* Write the size if wanted */
-	if( globals->variant & TWKB_SIZE )
-	{
-		/* Here we have to add what we know will be written to header */
-		/* buffer after size value is written */
-		size_t size_to_register = bytebuffer_getlength(child_state.geom_buf);
-		size_to_register += bbox_size;
-		bytebuffer_append_uvarint(child_state.header_buf, size_to_register);
-	}
 
-	if( globals->variant & TWKB_BBOX )
-		write_bbox(&child_state, ndims);
+	twkb_write_size_bbox(globals, &child_state, ndims, bytebuffer_getlength(child_state.geom_buf));
 
 	bytebuffer_append_bytebuffer(parent_state->geom_buf,child_state.header_buf);
 	bytebuffer_append_bytebuffer(parent_state->geom_buf,child_state.geom_buf);
@@ -613,3 +649,280 @@ lwgeom_to_twkb(const LWGEOM *geom, uint8_t variant,
 }
 
 
+
+
+/******************************************************************
+* Batches
+*******************************************************************/
+
+/*
+* A batch writes rows into one ID'ed TWKB collection as they arrive,
+* keeping only the encoded bytes. While all rows are non-empty points,
+* or lines, or polygons of one type, they share the delta state of a
+* single multi-geometry body. The first row that does not fit turns
+* the batch into a generic collection of stand-alone members.
+*/
+struct twkb_batch
+{
+	TWKB_GLOBALS globals;
+	TWKB_STATE ts;        /* shared delta state and member bytes */
+	bytebuffer_t *id_buf; /* ids, as varints */
+	uint32_t ngeoms;
+	uint8_t type;         /* member type, COLLECTIONTYPE once mixed */
+	int has_z;
+	int has_m;
+	int is_empty;         /* no non-empty member yet */
+};
+
+static void twkb_batch_reset_state(TWKB_BATCH *batch)
+{
+	int i;
+	for ( i = 0; i < MAX_N_DIMS; i++ )
+	{
+		batch->ts.bbox_max[i] = INT64_MIN;
+		batch->ts.bbox_min[i] = INT64_MAX;
+		batch->ts.accum_rels[i] = 0;
+	}
+}
+
+/*
+* Copy npoints vertices of a shared delta stream into a member of its
+* own, whose deltas start from zero
+*/
+static const uint8_t* twkb_batch_copy_points(const uint8_t *p, const uint8_t *end, uint32_t npoints, int ndims,
+                                            int64_t *accum, int *first, TWKB_GLOBALS *globals, TWKB_STATE *ts)
+{
+	uint32_t i;
+	int j;
+	size_t size;
+	int64_t delta;
+
+	for ( i = 0; i < npoints; i++ )
+	{
+		for ( j = 0; j < ndims; j++ )
+		{
+			delta = varint_s64_decode(p, end, &size);
+			p += size;
+			accum[j] += delta;
+			/* The first vertex of the member is written in full */
+			ts->accum_rels[j] = accum[j];
+			bytebuffer_append_varint(ts->geom_buf, *first ? accum[j] : delta);
+
+			if( globals->variant & TWKB_BBOX )
+			{
+				if( ts->accum_rels[j] > ts->bbox_max[j] )
+					ts->bbox_max[j] = ts->accum_rels[j];
+				if( ts->accum_rels[j] < ts->bbox_min[j] )
+					ts->bbox_min[j] = ts->accum_rels[j];
+			}
+		}
+		*first = LW_FALSE;
+	}
+	return p;
+}
+
+/*
+* Turn the multi-geometry body written so far into stand-alone
+* members, each with its own header and deltas starting from zero.
+* This happens at most once per batch.
+*/
+static void twkb_batch_to_collection(TWKB_BATCH *batch)
+{
+	bytebuffer_t *multi = batch->ts.geom_buf;
+	const uint8_t *p = multi->buf_start;
+	const uint8_t *end = multi->writecursor;
+	int ndims = 2 + batch->has_z + batch->has_m;
+	int64_t accum[MAX_N_DIMS] = {0};
+	size_t size;
+	uint32_t i, r, nrings, npoints;
+	int j, first, is_empty;
+
+	batch->ts.geom_buf = bytebuffer_create_with_size(bytebuffer_getlength(multi) + 64);
+	twkb_batch_reset_state(batch);
+
+	for ( i = 0; i < batch->ngeoms; i++ )
+	{
+		TWKB_STATE ts;
+		memset(&ts, 0, sizeof(TWKB_STATE));
+		ts.header_buf = bytebuffer_create_with_size(16);
+		ts.geom_buf = bytebuffer_create_with_size(64);
+		for ( j = 0; j < MAX_N_DIMS; j++ )
+		{
+			ts.bbox_max[j] = INT64_MIN;
+			ts.bbox_min[j] = INT64_MAX;
+		}
+		first = LW_TRUE;
+
+		if ( batch->type == POINTTYPE )
+		{
+			is_empty = LW_FALSE;
+			p = twkb_batch_copy_points(p, end, 1, ndims, accum, &first, &(batch->globals), &ts);
+		}
+		else
+		{
+			/* Lines are polygons with one ring and no ring count */
+			if ( batch->type == POLYGONTYPE )
+			{
+				nrings = varint_u64_decode(p, end, &size);
+				p += size;
+				bytebuffer_append_uvarint(ts.geom_buf, nrings);
+			}
+			else
+			{
+				nrings = 1;
+			}
+			is_empty = (nrings == 0);
+
+			for ( r = 0; r < nrings; r++ )
+			{
+				npoints = varint_u64_decode(p, end, &size);
+				p += size;
+				bytebuffer_append_uvarint(ts.geom_buf, npoints);
+				if ( r == 0 && npoints == 0 )
+					is_empty = LW_TRUE;
+				p = twkb_batch_copy_points(p, end, npoints, ndims, accum, &first, &(batch->globals), &ts);
+			}
+		}
+
+		twkb_write_header(ts.header_buf, lwtype_twkb_type(batch->type), batch->has_z, batch->has_m,
+		                  is_empty, LW_FALSE, &(batch->globals));
+
+		if ( ! is_empty )
+		{
+			/* Merge the member bbox into the collection one */
+			if( batch->globals.variant & TWKB_BBOX )
+			{
+				for ( j = 0; j < ndims; j++ )
+				{
+					if( ts.bbox_min[j] < batch->ts.bbox_min[j] )
+						batch->ts.bbox_min[j] = ts.bbox_min[j];
+					if( ts.bbox_max[j] > batch->ts.bbox_max[j] )
+						batch->ts.bbox_max[j] = ts.bbox_max[j];
+				}
+			}
+			twkb_write_size_bbox(&(batch->globals), &ts, ndims, bytebuffer_getlength(ts.geom_buf));
+		}
+
+		bytebuffer_append_bytebuffer(batch->ts.geom_buf, ts.header_buf);
+		if ( ! is_empty )
+			bytebuffer_append_bytebuffer(batch->ts.geom_buf, ts.geom_buf);
+
+		bytebuffer_destroy(ts.header_buf);
+		bytebuffer_destroy(ts.geom_buf);
+	}
+
+	bytebuffer_destroy(multi);
+	batch->type = COLLECTIONTYPE;
+}
+
+TWKB_BATCH*
+twkb_batch_create(uint8_t variant, int8_t precision_xy, int8_t precision_z, int8_t precision_m)
+{
+	TWKB_BATCH *batch = lwalloc(sizeof(TWKB_BATCH));
+	memset(batch, 0, sizeof(TWKB_BATCH));
+
+	batch->globals.variant = variant;
+	batch->globals.prec_xy = precision_xy;
+	batch->globals.prec_z = precision_z;
+	batch->globals.prec_m = precision_m;
+
+	/* A header buffer tells the member writer to merge bboxes into ours */
+	batch->ts.header_buf = bytebuffer_create_with_size(16);
+	batch->ts.geom_buf = bytebuffer_create();
+	batch->id_buf = bytebuffer_create_with_size(64);
+	batch->is_empty = LW_TRUE;
+	twkb_batch_reset_state(batch);
+
+	return batch;
+}
+
+void
+twkb_batch_free(TWKB_BATCH *batch)
+{
+	bytebuffer_destroy(batch->ts.header_buf);
+	bytebuffer_destroy(batch->ts.geom_buf);
+	bytebuffer_destroy(batch->id_buf);
+	lwfree(batch);
+}
+
+void
+twkb_batch_add(TWKB_BATCH *batch, const LWGEOM *geom, int64_t id)
+{
+	int is_empty = lwgeom_is_empty(geom);
+	int fits_multi;
+
+	if ( batch->ngeoms == 0 )
+	{
+		batch->has_z = lwgeom_has_z(geom);
+		batch->has_m = lwgeom_has_m(geom);
+		twkb_set_factors(&(batch->globals), batch->has_z, batch->has_m);
+	}
+	else if ( lwgeom_has_z(geom) != batch->has_z || lwgeom_has_m(geom) != batch->has_m )
+	{
+		lwerror("Geometries have different dimensionality");
+		return;
+	}
+
+	/* Multi-geometries cannot hold empty points */
+	fits_multi = ( geom->type == POINTTYPE || geom->type == LINETYPE || geom->type == POLYGONTYPE ) &&
+	             ! ( geom->type == POINTTYPE && is_empty );
+
+	if ( batch->ngeoms == 0 )
+		batch->type = fits_multi ? geom->type : COLLECTIONTYPE;
+	else if ( batch->type != COLLECTIONTYPE && ! ( fits_multi && geom->type == batch->type ) )
+		twkb_batch_to_collection(batch);
+
+	if ( batch->type == COLLECTIONTYPE )
+	{
+		lwgeom_write_to_buffer(geom, &(batch->globals), &(batch->ts));
+	}
+	else
+	{
+		/* Continue the deltas of the previous member, with no header */
+		lwgeom_to_twkb_buf(geom, &(batch->globals), &(batch->ts));
+	}
+
+	bytebuffer_append_varint(batch->id_buf, id);
+	batch->ngeoms++;
+	if ( ! is_empty )
+		batch->is_empty = LW_FALSE;
+}
+
+uint8_t*
+twkb_batch_to_twkb(TWKB_BATCH *batch, size_t *twkb_size)
+{
+	TWKB_STATE ts = batch->ts;
+	uint8_t twkb_type, *twkb;
+	uint8_t buf[16];
+	size_t body_size;
+	int ndims = 2 + batch->has_z + batch->has_m;
+
+	/* Collection type that the member type allows */
+	twkb_type = lwtype_twkb_type(lwtype_get_collectiontype(batch->type));
+
+	/* The header goes into a buffer of its own, the members follow */
+	/* it without another copy of the batch */
+	ts.header_buf = bytebuffer_create_with_size(16 + bytebuffer_getlength(batch->id_buf) + bytebuffer_getlength(batch->ts.geom_buf));
+	twkb_write_header(ts.header_buf, twkb_type, batch->has_z, batch->has_m,
+	                  batch->is_empty, LW_TRUE, &(batch->globals));
+
+	if ( ! batch->is_empty )
+	{
+		/* Number of members, ids, then the members */
+		body_size = varint_u64_encode_buf(batch->ngeoms, buf);
+		body_size += bytebuffer_getlength(batch->id_buf);
+		body_size += bytebuffer_getlength(batch->ts.geom_buf);
+
+		twkb_write_size_bbox(&(batch->globals), &ts, ndims, body_size);
+		bytebuffer_append_uvarint(ts.header_buf, batch->ngeoms);
+		bytebuffer_append_bytebuffer(ts.header_buf, batch->id_buf);
+		bytebuffer_append_bytebuffer(ts.header_buf, batch->ts.geom_buf);
+	}
+
+	if ( twkb_size )
+		*twkb_size = bytebuffer_getlength(ts.header_buf);
+
+	twkb = ts.header_buf->buf_start;
+	lwfree(ts.header_buf);
+	return twkb;
+}
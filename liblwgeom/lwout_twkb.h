@@ -42,6 +42,9 @@
 /* Maximum number of geometry dimmensions that internal arrays can hold */
 #define MAX_N_DIMS 4
 
+/* Number of vertices buffered before they are written as varints */
+#define TWKB_OUT_CHUNK 256
+
 #define MAX_BBOX_SIZE 64
 #define MAX_SIZE_SIZE 8
 
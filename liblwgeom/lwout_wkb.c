@@ -79,11 +79,11 @@ static int lwgeom_wkb_needs_srid(const LWGEOM *geom, uint8_t variant)
 /*
 * GeometryType
 */
-static uint32_t lwgeom_wkb_type(const LWGEOM *geom, uint8_t variant)
+static uint32_t lwtype_wkb_type(uint8_t type, uint8_t flags, int needs_srid, uint8_t variant)
 {
 	uint32_t wkb_type = 0;
 
-	switch ( geom->type )
+	switch ( type )
 	{
 	case POINTTYPE:
 		wkb_type = WKB_POINT_TYPE;
@@ -132,32 +132,37 @@ static uint32_t lwgeom_wkb_type(const LWGEOM *geom, uint8_t variant)
 		break;
 	default:
 		lwerror("Unsupported geometry type: %s [%d]",
-			lwtype_name(geom->type), geom->type);
+			lwtype_name(type), type);
 	}
 
 	if ( variant & WKB_EXTENDED )
 	{
-		if ( FLAGS_GET_Z(geom->flags) )
+		if ( FLAGS_GET_Z(flags) )
 			wkb_type |= WKBZOFFSET;
-		if ( FLAGS_GET_M(geom->flags) )
+		if ( FLAGS_GET_M(flags) )
 			wkb_type |= WKBMOFFSET;
 /*		if ( geom->srid != SRID_UNKNOWN && ! (variant & WKB_NO_SRID) ) */
-		if ( lwgeom_wkb_needs_srid(geom, variant) )
+		if ( needs_srid )
 			wkb_type |= WKBSRIDFLAG;
 	}
 	else if ( variant & WKB_ISO )
 	{
 		/* Z types are in the 1000 range */
-		if ( FLAGS_GET_Z(geom->flags) )
+		if ( FLAGS_GET_Z(flags) )
 			wkb_type += 1000;
 		/* M types are in the 2000 range */
-		if ( FLAGS_GET_M(geom->flags) )
+		if ( FLAGS_GET_M(flags) )
 			wkb_type += 2000;
 		/* ZM types are in the 1000 + 2000 = 3000 range, see above */
 	}
 	return wkb_type;
 }
 
+static uint32_t lwgeom_wkb_type(const LWGEOM *geom, uint8_t variant)
+{
+	return lwtype_wkb_type(geom->type, geom->flags, lwgeom_wkb_needs_srid(geom, variant), variant);
+}
+
 /*
 * Endian
 */
@@ -347,6 +352,40 @@ static uint8_t* empty_to_wkb_buf(const LWGEOM *geom, uint8_t *buf, uint8_t varia
 	return buf;
 }
 
+/*
+* Coordinates
+* Write npoints points of pa_dims ordinates each, keeping the first
+* dims of them.
+*/
+static uint8_t* ordinates_to_wkb_buf(const double *ords, uint32_t npoints, int pa_dims, int dims, uint8_t *buf, uint8_t variant)
+{
+	int i, j;
+
+	/* Bulk copy the coordinates when: dimensionality matches, output format */
+	/* is not hex, and output endian matches internal endian. */
+	if ( npoints && (dims == pa_dims) && ! wkb_swap_bytes(variant) && ! (variant & WKB_HEX)  )
+	{
+		size_t size = npoints * dims * WKB_DOUBLE_SIZE;
+		memcpy(buf, ords, size);
+		buf += size;
+	}
+	/* Copy coordinates one-by-one otherwise */
+	else
+	{
+		for ( i = 0; i < npoints; i++ )
+		{
+			LWDEBUGF(4, "Writing point #%d", i);
+			for ( j = 0; j < dims; j++ )
+			{
+				LWDEBUGF(4, "Writing dimension #%d (buf = %p)", j, buf);
+				buf = double_to_wkb_buf(ords[j], buf, variant);
+			}
+			ords += pa_dims;
+		}
+	}
+	return buf;
+}
+
 /*
 * POINTARRAY
 */
@@ -372,8 +411,6 @@ static uint8_t* ptarray_to_wkb_buf(const POINTARRAY *pa, uint8_t *buf, uint8_t v
 {
 	int dims = 2;
 	int pa_dims = FLAGS_NDIMS(pa->flags);
-	int i, j;
-	double *dbl_ptr;
 
 	/* SFSQL is always 2-d. Extended and ISO use all available dimensions */
 	if ( (variant & WKB_ISO) || (variant & WKB_EXTENDED) )
@@ -383,28 +420,9 @@ static uint8_t* ptarray_to_wkb_buf(const POINTARRAY *pa, uint8_t *buf, uint8_t v
 	if ( ! ( variant & WKB_NO_NPOINTS ) )
 		buf = integer_to_wkb_buf(pa->npoints, buf, variant);
 
-	/* Bulk copy the coordinates when: dimensionality matches, output format */
-	/* is not hex, and output endian matches internal endian. */
-	if ( pa->npoints && (dims == pa_dims) && ! wkb_swap_bytes(variant) && ! (variant & WKB_HEX)  )
-	{
-		size_t size = pa->npoints * dims * WKB_DOUBLE_SIZE;
-		memcpy(buf, getPoint_internal(pa, 0), size);
-		buf += size;
-	}
-	/* Copy coordinates one-by-one otherwise */
-	else
-	{
-		for ( i = 0; i < pa->npoints; i++ )
-		{
-			LWDEBUGF(4, "Writing point #%d", i);
-			dbl_ptr = (double*)getPoint_internal(pa, i);
-			for ( j = 0; j < dims; j++ )
-			{
-				LWDEBUGF(4, "Writing dimension #%d (buf = %p)", j, buf);
-				buf = double_to_wkb_buf(dbl_ptr[j], buf, variant);
-			}
-		}
-	}
+	if ( pa->npoints )
+		buf = ordinates_to_wkb_buf((double*)getPoint_internal(pa, 0), pa->npoints, pa_dims, dims, buf, variant);
+
 	LWDEBUGF(4, "Done (buf = %p)", buf);
 	return buf;
 }
@@ -850,3 +868,276 @@ char* lwgeom_to_hexwkb(const LWGEOM *geom, uint8_t variant, size_t *size_out)
 	return (char*)lwgeom_to_wkb(geom, variant | WKB_HEX, size_out);
 }
 
+
+
+/*
+* GSERIALIZED
+* Write WKB straight from the serialized form, walking its buffer
+* instead of building the LWGEOM tree first. The output is the same
+* as lwgeom_to_wkb on the deserialized geometry, and the coordinate
+* runs are copied as blocks when the variant allows it.
+*/
+
+/*
+* Size in the serialized buffer of the geometry starting at p, and
+* whether lwgeom_is_empty would find it empty.
+*/
+static size_t gserialized_buffer_walk(const uint8_t *p, uint8_t flags, int *isempty)
+{
+	uint32_t type = lw_get_uint32_t(p);
+	uint32_t count = lw_get_uint32_t(p + 4);
+	size_t ordsize = FLAGS_NDIMS(flags) * sizeof(double);
+	size_t size = 8; /* type + count */
+	uint32_t i;
+	int subempty;
+
+	switch ( type )
+	{
+		case POINTTYPE:
+		case LINETYPE:
+		case CIRCSTRINGTYPE:
+		case TRIANGLETYPE:
+			*isempty = (count == 0);
+			return size + count * ordsize;
+
+		/* Ring sizes come first, padded to a double boundary */
+		case POLYGONTYPE:
+			*isempty = (count == 0 || lw_get_uint32_t(p + 8) == 0);
+			size += 4 * (count + count % 2);
+			for ( i = 0; i < count; i++ )
+				size += lw_get_uint32_t(p + 8 + 4 * i) * ordsize;
+			return size;
+
+		case MULTIPOINTTYPE:
+		case MULTILINETYPE:
+		case MULTIPOLYGONTYPE:
+		case COMPOUNDTYPE:
+		case CURVEPOLYTYPE:
+		case MULTICURVETYPE:
+		case MULTISURFACETYPE:
+		case COLLECTIONTYPE:
+		case POLYHEDRALSURFACETYPE:
+		case TINTYPE:
+			*isempty = LW_TRUE;
+			for ( i = 0; i < count; i++ )
+			{
+				size += gserialized_buffer_walk(p + size, flags, &subempty);
+				if ( ! subempty )
+					*isempty = LW_FALSE;
+			}
+			return size;
+
+		default:
+			lwerror("Unsupported geometry type: %s [%d]", lwtype_name(type), type);
+	}
+	return 0;
+}
+
+/*
+* Empties are short circuited by lwgeom_to_wkb in the canonical forms,
+* and by each non-collection type in the extended form.
+*/
+static inline int gserialized_buffer_wkb_empty(uint32_t type, int isempty, uint8_t variant)
+{
+	return isempty && ! ( (variant & WKB_EXTENDED) && lwtype_is_collection(type) );
+}
+
+static inline int gserialized_wkb_needs_srid(int32_t srid, uint8_t variant)
+{
+	return (variant & WKB_EXTENDED) && ! (variant & WKB_NO_SRID) && srid != SRID_UNKNOWN;
+}
+
+static size_t gserialized_buffer_to_wkb_size(const uint8_t *p, uint8_t flags, int32_t srid, uint8_t variant, size_t *g_size)
+{
+	uint32_t type = lw_get_uint32_t(p);
+	uint32_t count = lw_get_uint32_t(p + 4);
+	int dims = (variant & (WKB_ISO | WKB_EXTENDED)) ? FLAGS_NDIMS(flags) : 2;
+	/* Endian flag + type number */
+	size_t size = WKB_BYTE_SIZE + WKB_INT_SIZE;
+	size_t offset, subsize;
+	uint32_t i;
+	int isempty;
+
+	*g_size = gserialized_buffer_walk(p, flags, &isempty);
+
+	/* Extended WKB needs space for optional SRID integer */
+	if ( gserialized_wkb_needs_srid(srid, variant) )
+		size += WKB_INT_SIZE;
+
+	/* POINT EMPTY is POINT(NaN NaN), other empties have no elements */
+	if ( gserialized_buffer_wkb_empty(type, isempty, variant) )
+		return size + (type == POINTTYPE ? FLAGS_NDIMS(flags) * WKB_DOUBLE_SIZE : WKB_INT_SIZE);
+
+	switch ( type )
+	{
+		case POINTTYPE:
+			return size + dims * WKB_DOUBLE_SIZE;
+
+		case LINETYPE:
+		case CIRCSTRINGTYPE:
+			return size + WKB_INT_SIZE + count * dims * WKB_DOUBLE_SIZE;
+
+		/* Number of rings (always one) + number of points */
+		case TRIANGLETYPE:
+			return size + 2 * WKB_INT_SIZE + count * dims * WKB_DOUBLE_SIZE;
+
+		case POLYGONTYPE:
+			size += WKB_INT_SIZE;
+			for ( i = 0; i < count; i++ )
+				size += WKB_INT_SIZE + lw_get_uint32_t(p + 8 + 4 * i) * dims * WKB_DOUBLE_SIZE;
+			return size;
+
+		/* Sub-geometries do not get SRIDs */
+		default:
+			size += WKB_INT_SIZE;
+			offset = 8;
+			for ( i = 0; i < count; i++ )
+			{
+				size += gserialized_buffer_to_wkb_size(p + offset, flags, SRID_UNKNOWN, variant | WKB_NO_SRID, &subsize);
+				offset += subsize;
+			}
+			return size;
+	}
+}
+
+static uint8_t* gserialized_buffer_to_wkb_buf(const uint8_t *p, uint8_t flags, int32_t srid, uint8_t *buf, uint8_t variant, size_t *g_size)
+{
+	uint32_t type = lw_get_uint32_t(p);
+	uint32_t count = lw_get_uint32_t(p + 4);
+	int pa_dims = FLAGS_NDIMS(flags);
+	int dims = (variant & (WKB_ISO | WKB_EXTENDED)) ? pa_dims : 2;
+	int needs_srid = gserialized_wkb_needs_srid(srid, variant);
+	const double *ords = (const double*)(p + 8);
+	size_t offset, subsize;
+	uint32_t i, npoints;
+	int isempty;
+
+	*g_size = gserialized_buffer_walk(p, flags, &isempty);
+
+	/* Set the endian flag */
+	buf = endian_to_wkb_buf(buf, variant);
+	/* Set the geometry type */
+	buf = integer_to_wkb_buf(lwtype_wkb_type(type, flags, needs_srid, variant), buf, variant);
+	/* Set the optional SRID for extended variant */
+	if ( needs_srid )
+		buf = integer_to_wkb_buf(srid, buf, variant);
+
+	/* Represent POINT EMPTY as POINT(NaN NaN), others have zero elements */
+	if ( gserialized_buffer_wkb_empty(type, isempty, variant) )
+	{
+		if ( type == POINTTYPE )
+		{
+			static double nn = NAN;
+			for ( i = 0; i < pa_dims; i++ )
+				buf = double_to_wkb_buf(nn, buf, variant);
+			return buf;
+		}
+		return integer_to_wkb_buf(0, buf, variant);
+	}
+
+	switch ( type )
+	{
+		case POINTTYPE:
+			return ordinates_to_wkb_buf(ords, 1, pa_dims, dims, buf, variant);
+
+		case LINETYPE:
+		case CIRCSTRINGTYPE:
+			buf = integer_to_wkb_buf(count, buf, variant);
+			return ordinates_to_wkb_buf(ords, count, pa_dims, dims, buf, variant);
+
+		/* One ring, it's a triangle */
+		case TRIANGLETYPE:
+			buf = integer_to_wkb_buf(1, buf, variant);
+			buf = integer_to_wkb_buf(count, buf, variant);
+			return ordinates_to_wkb_buf(ords, count, pa_dims, dims, buf, variant);
+
+		/* Ordinates start after the padded list of ring sizes */
+		case POLYGONTYPE:
+			buf = integer_to_wkb_buf(count, buf, variant);
+			ords = (const double*)(p + 8 + 4 * (count + count % 2));
+			for ( i = 0; i < count; i++ )
+			{
+				npoints = lw_get_uint32_t(p + 8 + 4 * i);
+				buf = integer_to_wkb_buf(npoints, buf, variant);
+				buf = ordinates_to_wkb_buf(ords, npoints, pa_dims, dims, buf, variant);
+				ords += npoints * pa_dims;
+			}
+			return buf;
+
+		/* Sub-geometries do not get SRIDs, they inherit from their parents */
+		default:
+			buf = integer_to_wkb_buf(count, buf, variant);
+			offset = 8;
+			for ( i = 0; i < count; i++ )
+			{
+				buf = gserialized_buffer_to_wkb_buf(p + offset, flags, SRID_UNKNOWN, buf, variant | WKB_NO_SRID, &subsize);
+				offset += subsize;
+			}
+			return buf;
+	}
+}
+
+/**
+* Convert a GSERIALIZED to WKB, with the same output as lwgeom_to_wkb
+* on its deserialized form. Caller is responsible for freeing the
+* returned array.
+*/
+uint8_t* gserialized_to_wkb(const GSERIALIZED *g, uint8_t variant, size_t *size_out)
+{
+	const uint8_t *data = (const uint8_t*)g->data;
+	int32_t srid = gserialized_get_srid(g);
+	size_t buf_size, g_size;
+	uint8_t *buf = NULL;
+	uint8_t *wkb_out = NULL;
+
+	/* Initialize output size */
+	if ( size_out ) *size_out = 0;
+
+	if ( FLAGS_GET_BBOX(g->flags) )
+		data += gbox_serialized_size(g->flags);
+
+	/* Calculate the required size of the output buffer */
+	buf_size = gserialized_buffer_to_wkb_size(data, g->flags, srid, variant, &g_size);
+	LWDEBUGF(4, "WKB output size: %d", buf_size);
+
+	/* Hex string takes twice as much space as binary + a null character */
+	if ( variant & WKB_HEX )
+		buf_size = 2 * buf_size + 1;
+
+	/* If neither or both variants are specified, choose the native order */
+	if ( ! (variant & WKB_NDR || variant & WKB_XDR) ||
+	       (variant & WKB_NDR && variant & WKB_XDR) )
+	{
+		if ( getMachineEndian() == NDR )
+			variant = variant | WKB_NDR;
+		else
+			variant = variant | WKB_XDR;
+	}
+
+	buf = lwalloc(buf_size);
+	wkb_out = buf;
+
+	/* Write the WKB into the output buffer */
+	buf = gserialized_buffer_to_wkb_buf(data, g->flags, srid, buf, variant, &g_size);
+
+	/* Null the last byte if this is a hex output */
+	if ( variant & WKB_HEX )
+		*buf++ = '\0';
+
+	if ( buf_size != (buf - wkb_out) )
+	{
+		lwerror("Output WKB is not the same size as the allocated buffer.");
+		lwfree(wkb_out);
+		return NULL;
+	}
+
+	/* Report output size */
+	if ( size_out ) *size_out = buf_size;
+
+	return wkb_out;
+}
+
+char* gserialized_to_hexwkb(const GSERIALIZED *g, uint8_t variant, size_t *size_out)
+{
+	return (char*)gserialized_to_wkb(g, variant | WKB_HEX, size_out);
+}
@@ -26,6 +26,7 @@
 
 #include <stdio.h>
 #include <string.h>
+#include <math.h>
 #include "liblwgeom_internal.h"
 
 /* Ensures the given lat and lon are in the "normal" range:
@@ -423,3 +424,341 @@ char* lwpoint_to_latlon(const LWPOINT * pt, const char *format)
 	p = getPoint2d_cp(pt->point, 0);
 	return lwdoubles_to_latlon(p->y, p->x, format);
 }
+
+/*
+ * Double to text conversion used by the lwout_* writers.
+ *
+ * The writers print ordinates with a fixed number of decimal digits
+ * ("%.*f" without trailing zeros) or of significant digits ("%.*g").
+ * Instead of going through snprintf, the binary value m * 2^e is scaled
+ * by the power of ten of the precision in 128-bit integer arithmetic
+ * and rounded half to even, which is exact and so gives the same
+ * digits as a correctly rounding printf. Values out of the supported
+ * range fall back to snprintf.
+ */
+
+/* Largest number of decimal digits handled without snprintf */
+#define LWPRINT_MAX_DIGITS 19
+
+typedef struct
+{
+	uint64_t hi;
+	uint64_t lo;
+}
+lwuint128;
+
+static const uint64_t lwprint_pow10[] =
+{
+	1ULL, 10ULL, 100ULL, 1000ULL, 10000ULL, 100000ULL, 1000000ULL,
+	10000000ULL, 100000000ULL, 1000000000ULL, 10000000000ULL,
+	100000000000ULL, 1000000000000ULL, 10000000000000ULL,
+	100000000000000ULL, 1000000000000000ULL, 10000000000000000ULL,
+	100000000000000000ULL, 1000000000000000000ULL,
+	10000000000000000000ULL
+};
+
+/* r = a * b */
+static inline void
+u128_mul64(uint64_t a, uint64_t b, lwuint128 *r)
+{
+	uint64_t a_lo = a & 0xFFFFFFFF, a_hi = a >> 32;
+	uint64_t b_lo = b & 0xFFFFFFFF, b_hi = b >> 32;
+	uint64_t ll = a_lo * b_lo;
+	uint64_t lh = a_lo * b_hi;
+	uint64_t hl = a_hi * b_lo;
+	uint64_t hh = a_hi * b_hi;
+	uint64_t mid = (ll >> 32) + (lh & 0xFFFFFFFF) + (hl & 0xFFFFFFFF);
+
+	r->lo = (mid << 32) | (ll & 0xFFFFFFFF);
+	r->hi = hh + (lh >> 32) + (hl >> 32) + (mid >> 32);
+}
+
+/* r = r << n, 0 <= n < 128 */
+static inline void
+u128_shl(lwuint128 *r, int n)
+{
+	if ( n >= 64 )
+	{
+		r->hi = r->lo << (n - 64);
+		r->lo = 0;
+	}
+	else if ( n > 0 )
+	{
+		r->hi = (r->hi << n) | (r->lo >> (64 - n));
+		r->lo <<= n;
+	}
+}
+
+/* r = r / 2^n, rounded half to even if round is set, n > 0 */
+static inline void
+u128_shr(lwuint128 *r, int n, int round)
+{
+	int k = n - 1; /* position of the half bit */
+	int half = 0;
+	int sticky = 0;
+
+	if ( n > 128 )
+	{
+		r->hi = r->lo = 0;
+		return;
+	}
+
+	if ( round && k < 64 )
+	{
+		half = (r->lo >> k) & 1;
+		sticky = k ? (r->lo & ((1ULL << k) - 1)) != 0 : 0;
+	}
+	else if ( round )
+	{
+		half = (r->hi >> (k - 64)) & 1;
+		sticky = r->lo != 0 || (k > 64 && (r->hi & ((1ULL << (k - 64)) - 1)) != 0);
+	}
+
+	if ( n >= 128 )
+	{
+		r->hi = r->lo = 0;
+	}
+	else if ( n >= 64 )
+	{
+		r->lo = r->hi >> (n - 64);
+		r->hi = 0;
+	}
+	else
+	{
+		r->lo = (r->lo >> n) | (r->hi << (64 - n));
+		r->hi >>= n;
+	}
+
+	if ( half && (sticky || (r->lo & 1)) )
+	{
+		r->lo++;
+		if ( ! r->lo ) r->hi++;
+	}
+}
+
+/* r = r / d, returns r % d */
+static inline uint32_t
+u128_divmod32(lwuint128 *r, uint32_t d)
+{
+	uint32_t w[4];
+	uint64_t rem = 0;
+	int i;
+
+	w[0] = r->hi >> 32;
+	w[1] = r->hi & 0xFFFFFFFF;
+	w[2] = r->lo >> 32;
+	w[3] = r->lo & 0xFFFFFFFF;
+	for ( i = 0; i < 4; i++ )
+	{
+		uint64_t part = (rem << 32) | w[i];
+		w[i] = part / d;
+		rem = part % d;
+	}
+	r->hi = ((uint64_t)w[0] << 32) | w[1];
+	r->lo = ((uint64_t)w[2] << 32) | w[3];
+	return rem;
+}
+
+/*
+ * Round |d| * 10^p to the nearest integer, ties to even, or truncate
+ * it if round is not set. d must be finite,
+ * 0 <= p <= LWPRINT_MAX_DIGITS and |d| * 10^p below 2^113.
+ */
+static void
+lwprint_scale(double d, int p, int round, lwuint128 *q)
+{
+	uint64_t bits;
+	uint64_t m;
+	int e;
+
+	memcpy(&bits, &d, sizeof(double));
+	m = bits & 0xFFFFFFFFFFFFFULL;
+	e = (bits >> 52) & 0x7FF;
+	if ( e )
+	{
+		m |= 1ULL << 52;
+		e -= 1075;
+	}
+	else
+	{
+		e = -1074; /* subnormal */
+	}
+
+	u128_mul64(m, lwprint_pow10[p], q);
+	if ( e > 0 )
+		u128_shl(q, e);
+	else if ( e < 0 )
+		u128_shr(q, -e, round);
+}
+
+/*
+ * Write the decimal digits of q to buf, most significant first,
+ * without terminating NULL. Returns the number of digits.
+ */
+static int
+lwprint_digits(lwuint128 q, char *buf)
+{
+	char tmp[40];
+	int n = 0;
+	int i;
+	uint64_t v;
+
+	while ( q.hi )
+	{
+		uint32_t rem = u128_divmod32(&q, 1000000000);
+		for ( i = 0; i < 9; i++ )
+		{
+			tmp[n++] = '0' + rem % 10;
+			rem /= 10;
+		}
+	}
+
+	v = q.lo;
+	do
+	{
+		tmp[n++] = '0' + v % 10;
+		v /= 10;
+	}
+	while ( v );
+
+	for ( i = 0; i < n; i++ )
+		buf[i] = tmp[n - 1 - i];
+	return n;
+}
+
+/*
+ * Write q / 10^p in fixed notation with p decimal digits, trailing
+ * zeros of the decimals and a trailing dot removed. Returns the
+ * length of the NULL terminated output.
+ */
+static int
+lwprint_fixed(int negative, lwuint128 q, int p, char *buf)
+{
+	char digits[48];
+	int ndigits = lwprint_digits(q, digits);
+	int nint;
+	char *ptr = buf;
+
+	/* pad with leading zeros so that there is an integer digit */
+	if ( ndigits <= p )
+	{
+		int npad = p + 1 - ndigits;
+		memmove(digits + npad, digits, ndigits);
+		memset(digits, '0', npad);
+		ndigits = p + 1;
+	}
+	nint = ndigits - p;
+
+	/* drop trailing zeros of the decimals */
+	while ( p > 0 && digits[ndigits - 1] == '0' )
+	{
+		ndigits--;
+		p--;
+	}
+
+	if ( negative ) *ptr++ = '-';
+	memcpy(ptr, digits, nint);
+	ptr += nint;
+	if ( p > 0 )
+	{
+		*ptr++ = '.';
+		memcpy(ptr, digits + nint, p);
+		ptr += p;
+	}
+
+	*ptr = '\0';
+	return ptr - buf;
+}
+
+/*
+ * Print a double with at most maxdd decimal digits, as "%.*f"
+ * followed by trim_trailing_zeros() would. Values of OUT_MAX_DOUBLE
+ * or more are printed with "%g".
+ *
+ * Returns the number of bytes written, excluding the terminating
+ * NULL. A return of bufsize or more means that the output did not
+ * fit, which only happens for a maxdd beyond OUT_MAX_DOUBLE_PRECISION
+ * with a buffer of OUT_DOUBLE_BUFFER_SIZE bytes.
+ */
+int
+lwprint_double(double d, int maxdd, char *buf, size_t bufsize)
+{
+	lwuint128 q;
+
+	if ( ! (fabs(d) < OUT_MAX_DOUBLE) )
+		return snprintf(buf, bufsize, "%g", d);
+
+	if ( maxdd < 0 || maxdd > LWPRINT_MAX_DIGITS )
+	{
+		int len = snprintf(buf, bufsize, "%.*f", maxdd, d);
+		if ( (size_t)len >= bufsize ) return len; /* truncated */
+		trim_trailing_zeros(buf);
+		return strlen(buf);
+	}
+
+	lwprint_scale(d, maxdd, LW_TRUE, &q);
+	return lwprint_fixed(signbit(d) != 0, q, maxdd, buf);
+}
+
+/*
+ * Print a double with at most precision significant digits, as
+ * "%.*g" would.
+ *
+ * Returns the number of bytes written, excluding the terminating
+ * NULL. A return of bufsize or more means that the output did not
+ * fit, as with snprintf.
+ */
+int
+lwprint_double_significant(double d, int precision, char *buf, size_t bufsize)
+{
+	lwuint128 q;
+	double ad = fabs(d);
+	int p;
+	int e;
+
+	if ( precision == 0 ) precision = 1;
+
+	/* exponent notation, infinite, NaN or out of range precision */
+	if ( ! (ad >= 1e-5 && ad < 1e17) || precision < 0 || precision > 17 )
+	{
+		if ( ad == 0 && precision >= 0 )
+		{
+			q.hi = q.lo = 0;
+			return lwprint_fixed(signbit(d) != 0, q, 0, buf);
+		}
+		return snprintf(buf, bufsize, "%.*g", precision, d);
+	}
+
+	/* decimal exponent of d, exactly */
+	e = floor(log10(ad));
+	for (;;)
+	{
+		p = precision - 1 - e;
+		if ( p < 0 || p > LWPRINT_MAX_DIGITS )
+			return snprintf(buf, bufsize, "%.*g", precision, d);
+
+		lwprint_scale(d, p, LW_FALSE, &q);
+		if ( q.lo >= lwprint_pow10[precision] )
+			e++;
+		else if ( q.lo < lwprint_pow10[precision - 1] )
+			e--;
+		else
+			break;
+	}
+
+	/* rounding to precision digits may carry into the next exponent */
+	lwprint_scale(d, p, LW_TRUE, &q);
+	if ( q.lo == lwprint_pow10[precision] )
+	{
+		e++;
+		p--;
+		if ( p < 0 )
+			return snprintf(buf, bufsize, "%.*g", precision, d);
+		lwprint_scale(d, p, LW_TRUE, &q);
+	}
+
+	if ( e < -4 || e >= precision )
+		return snprintf(buf, bufsize, "%.*g", precision, d);
+
+	return lwprint_fixed(signbit(d) != 0, q, p, buf);
+}
@@ -140,6 +140,68 @@ stringbuffer_append(stringbuffer_t *s, const char *a)
 	s->str_end += alen;
 }
 
+/**
+* Append the first alen characters of the specified string to the
+* stringbuffer_t.
+*/
+void
+stringbuffer_append_len(stringbuffer_t *s, const char *a, int alen)
+{
+	stringbuffer_makeroom(s, alen + 1);
+	memcpy(s->str_end, a, alen);
+	s->str_end += alen;
+	*(s->str_end) = '\0';
+}
+
+/**
+* Append the specified character to the stringbuffer_t.
+*/
+void
+stringbuffer_append_char(stringbuffer_t *s, char c)
+{
+	stringbuffer_makeroom(s, 2);
+	*(s->str_end++) = c;
+	*(s->str_end) = '\0';
+}
+
+/**
+* Append a double with at most precision decimal digits and no
+* trailing zeros, printed in place by lwprint_double.
+*/
+void
+stringbuffer_append_double(stringbuffer_t *s, double d, int precision)
+{
+	int len;
+
+	stringbuffer_makeroom(s, OUT_DOUBLE_BUFFER_SIZE);
+	len = lwprint_double(d, precision, s->str_end, OUT_DOUBLE_BUFFER_SIZE);
+	if ( len >= OUT_DOUBLE_BUFFER_SIZE )
+	{
+		stringbuffer_makeroom(s, len + 1);
+		len = lwprint_double(d, precision, s->str_end, len + 1);
+	}
+	s->str_end += len;
+}
+
+/**
+* Append a double with at most precision significant digits, as
+* "%.*g" would, printed in place by lwprint_double_significant.
+*/
+void
+stringbuffer_append_double_significant(stringbuffer_t *s, double d, int precision)
+{
+	int len;
+
+	stringbuffer_makeroom(s, OUT_DOUBLE_BUFFER_SIZE);
+	len = lwprint_double_significant(d, precision, s->str_end, OUT_DOUBLE_BUFFER_SIZE);
+	if ( len >= OUT_DOUBLE_BUFFER_SIZE )
+	{
+		stringbuffer_makeroom(s, len + 1);
+		len = lwprint_double_significant(d, precision, s->str_end, len + 1);
+	}
+	s->str_end += len;
+}
+
 /**
 * Returns a reference to the internal string being managed by
 * the stringbuffer. The current string will be null-terminated
@@ -51,6 +51,10 @@ extern void stringbuffer_clear(stringbuffer_t *sb);
 void stringbuffer_set(stringbuffer_t *sb, const char *s);
 void stringbuffer_copy(stringbuffer_t *sb, stringbuffer_t *src);
 extern void stringbuffer_append(stringbuffer_t *sb, const char *s);
+extern void stringbuffer_append_len(stringbuffer_t *sb, const char *s, int alen);
+extern void stringbuffer_append_char(stringbuffer_t *sb, char c);
+extern void stringbuffer_append_double(stringbuffer_t *sb, double d, int precision);
+extern void stringbuffer_append_double_significant(stringbuffer_t *sb, double d, int precision);
 extern int stringbuffer_aprintf(stringbuffer_t *sb, const char *fmt, ...);
 extern const char *stringbuffer_getstring(stringbuffer_t *sb);
 extern char *stringbuffer_getstringcopy(stringbuffer_t *sb);
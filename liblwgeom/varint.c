@@ -128,6 +128,9 @@ varint_u64_decode(const uint8_t *the_start, const uint8_t *the_end, size_t *size
 			ptr++;
 			/* move the cursor in the resulting variable (7 bits) */
 			nShift += 7;
+			/* ten bytes hold 64 bits, there is no room for more */
+			if ( nShift > 63 )
+				break;
 		}
 		else
 		{
@@ -139,10 +142,85 @@ varint_u64_decode(const uint8_t *the_start, const uint8_t *the_end, size_t *size
 			return nVal | ((uint64_t)nByte << nShift);
 		}
 	}
-	lwerror("%s: varint extends past end of buffer", __func__);
+	if ( ptr < the_end )
+		lwerror("%s: varint is too long", __func__);
+	else
+		lwerror("%s: varint extends past end of buffer", __func__);
 	return 0;
 }
 
+/*
+* Bulk versions for coordinate runs: the per-value call and the
+* bounds check of the loops above dominate when most deltas fit in
+* one or two bytes.
+*/
+
+/* Write n signed values as consecutive varints. The buffer must */
+/* have room for 10 bytes per value, the longest 64bit varint. */
+size_t
+varint_s64_encode_array(const int64_t *vals, size_t n, uint8_t *buf)
+{
+	uint8_t *ptr = buf;
+	size_t i;
+
+	for ( i = 0; i < n; i++ )
+	{
+		uint64_t q = zigzag64(vals[i]);
+		while ( q > 0x7f )
+		{
+			*ptr++ = 0x80 | (q & 0x7f);
+			q >>= 7;
+		}
+		*ptr++ = (uint8_t)q;
+	}
+	return ptr - buf;
+}
+
+/* Read n consecutive signed varints, returns the number of bytes read */
+size_t
+varint_s64_decode_array(const uint8_t *the_start, const uint8_t *the_end, int64_t *vals, size_t n)
+{
+	const uint8_t *ptr = the_start;
+	uint64_t nVal;
+	int nShift;
+	size_t i = 0;
+
+	/* While even the longest varints fit, skip the bounds checks */
+	while ( i < n && (size_t)(the_end - ptr) >= 10 * (n - i) )
+	{
+		nVal = *ptr++;
+		/* Hibit is set, so read on */
+		if ( nVal & 0x80 )
+		{
+			nVal &= 0x7f;
+			nShift = 7;
+			while ( *ptr & 0x80 )
+			{
+				if ( nShift > 56 )
+				{
+					lwerror("%s: varint is too long", __func__);
+					return 0;
+				}
+				nVal |= ((uint64_t)(*ptr++ & 0x7f)) << nShift;
+				nShift += 7;
+			}
+			nVal |= ((uint64_t)*ptr++) << nShift;
+		}
+		/* unzigzag */
+		vals[i++] = (int64_t)((nVal >> 1) ^ (~(nVal & 1) + 1));
+	}
+
+	/* Close to the end of the buffer, check every byte */
+	for ( ; i < n; i++ )
+	{
+		size_t size;
+		vals[i] = varint_s64_decode(ptr, the_end, &size);
+		ptr += size;
+	}
+
+	return ptr - the_start;
+}
+
 size_t
 varint_size(const uint8_t *the_start, const uint8_t *the_end)
 {
@@ -182,18 +260,13 @@ uint8_t zigzag8(int8_t val)
 	
 int64_t unzigzag64(uint64_t val)
 {
-        if ( val & 0x01 )
-            return -1 * (int64_t)((val+1) >> 1);
-        else
-            return (int64_t)(val >> 1);
+	/* no val+1, it wraps for the most negative value */
+	return (int64_t)((val >> 1) ^ (~(val & 1) + 1));
 }
 	
 int32_t unzigzag32(uint32_t val)
 {
-        if ( val & 0x01 )
-            return -1 * (int32_t)((val+1) >> 1);
-        else
-            return (int32_t)(val >> 1);
+	return (int32_t)((val >> 1) ^ (~(val & 1) + 1));
 }
 	
 int8_t unzigzag8(uint8_t val)
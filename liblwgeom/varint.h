@@ -39,6 +39,8 @@ size_t varint_u64_encode_buf(uint64_t val, uint8_t *buf);
 size_t varint_s64_encode_buf(int64_t val, uint8_t *buf);
 int64_t varint_s64_decode(const uint8_t *the_start, const uint8_t *the_end, size_t *size);
 uint64_t varint_u64_decode(const uint8_t *the_start, const uint8_t *the_end, size_t *size);
+size_t varint_s64_encode_array(const int64_t *vals, size_t n, uint8_t *buf);
+size_t varint_s64_decode_array(const uint8_t *the_start, const uint8_t *the_end, int64_t *vals, size_t n);
 
 size_t varint_size(const uint8_t *the_start, const uint8_t *the_end);
 
@@ -37,6 +37,10 @@ usage()
 	printf(_( "  -g <geocolumn> Specify the name of the geometry/geography column\n"
 	          "      (mostly useful in append mode).\n" ));
 	printf(_( "  -D  Use postgresql dump format (defaults to SQL insert statements).\n" ));
+	printf(_( "  -B <file> Write the rows in binary COPY format to <file> and load them\n"
+	          "      with a \\copy command. Use - to write only the binary rows to stdout\n"
+	          "      for COPY ... FROM STDIN (FORMAT binary), which requires -a.\n"
+	          "      Not compatible with -D, -w or -s FROM_SRID:TO_SRID.\n" ));
 	printf(_( "  -e  Execute each statement individually, do not use a transaction.\n"
 	          "      Not compatible with -D.\n" ));
 	printf(_( "  -G  Use geography type (requires lon/lat data or -s to reproject).\n" ));
@@ -74,6 +78,8 @@ main (int argc, char **argv)
 	SHPLOADERCONFIG *config;
 	SHPLOADERSTATE *state;
 	char *header, *footer, *record;
+	size_t length;
+	FILE *binary_out = NULL;
 	int c;
 	int ret, i;
 
@@ -95,7 +101,7 @@ main (int argc, char **argv)
 	set_loader_config_defaults(config);
 
 	/* Keep the flag list alphabetic so it's easy to see what's left. */
-	while ((c = pgis_getopt(argc, argv, "acdeg:ikm:nps:t:wDGIN:ST:W:X:")) != EOF)
+	while ((c = pgis_getopt(argc, argv, "acdeg:ikm:nps:t:wB:DGIN:ST:W:X:")) != EOF)
 	{
 		switch (c)
 		{
@@ -110,6 +116,10 @@ main (int argc, char **argv)
 			config->dump_format = 1;
 			break;
 
+		case 'B':
+			config->binary_file = pgis_optarg;
+			break;
+
 		case 'G':
 			config->geography = 1;
 			break;
@@ -249,6 +259,33 @@ main (int argc, char **argv)
 		exit(1);
 	}
 
+	if (config->binary_file)
+	{
+		if (config->dump_format || config->use_wkt)
+		{
+			fprintf(stderr, "Invalid argument combination - cannot use -B with -D or -w\n");
+			exit(1);
+		}
+
+		if (config->shp_sr_id != SRID_UNKNOWN)
+		{
+			fprintf(stderr, "Invalid argument combination - cannot use -B with -s FROM_SRID:TO_SRID\n");
+			exit(1);
+		}
+
+		/* Nothing but the rows may be written to stdout */
+		if (!strcmp(config->binary_file, "-"))
+		{
+			if (config->opt != 'a' || config->createindex)
+			{
+				fprintf(stderr, "Invalid argument combination - -B - requires -a and cannot be used with -I\n");
+				exit(1);
+			}
+
+			binary_out = stdout;
+		}
+	}
+
 	/* Determine the shapefile name from the next argument, if no shape file, exit. */
 	if (pgis_optind < argc)
 	{
@@ -358,11 +395,90 @@ main (int argc, char **argv)
 			exit(1);
 	}
 
-	printf("%s", header);
+	if (binary_out != stdout)
+		printf("%s", header);
 	free(header);
 
 	/* If we are not in "prepare" mode, go ahead and write out the data. */
-	if ( state->config->opt != 'p' )
+	if ( state->config->opt != 'p' && state->config->binary_file )
+	{
+		if (binary_out == NULL)
+		{
+			binary_out = fopen(state->config->binary_file, "wb");
+			if (binary_out == NULL)
+			{
+				fprintf(stderr, "Unable to open binary COPY file %s: %s\n", state->config->binary_file, strerror(errno));
+				exit(1);
+			}
+		}
+
+		ShpLoaderGetBinaryHeader(state, &header, &length);
+		fwrite(header, 1, length, binary_out);
+		free(header);
+
+		/* Main loop: iterate through all of the records and write them out */
+		for (i = 0; i < ShpLoaderGetRecordCount(state); i++)
+		{
+			ret = ShpLoaderGenerateBinaryRow(state, i, &record, &length);
+
+			switch (ret)
+			{
+			case SHPLOADEROK:
+				fwrite(record, 1, length, binary_out);
+				free(record);
+				break;
+
+			case SHPLOADERERR:
+				/* Display the error message then stop */
+				fprintf(stderr, "%s\n", state->message);
+				exit(1);
+				break;
+
+			case SHPLOADERWARN:
+				/* Display the warning, but continue */
+				fprintf(stderr, "%s\n", state->message);
+				fwrite(record, 1, length, binary_out);
+				free(record);
+				break;
+
+			case SHPLOADERRECDELETED:
+			case SHPLOADERRECISNULL:
+				/* Record is deleted or NULL and should be ignored */
+				break;
+			}
+		}
+
+		ShpLoaderGetBinaryTrailer(state, &footer, &length);
+		fwrite(footer, 1, length, binary_out);
+		free(footer);
+
+		if (ferror(binary_out) || fflush(binary_out) != 0)
+		{
+			fprintf(stderr, "Unable to write binary COPY rows: %s\n", strerror(errno));
+			exit(1);
+		}
+
+		/* Load the rows of the binary COPY file */
+		if (binary_out != stdout)
+		{
+			if (fclose(binary_out) != 0)
+			{
+				fprintf(stderr, "Unable to close binary COPY file %s: %s\n", state->config->binary_file, strerror(errno));
+				exit(1);
+			}
+
+			ret = ShpLoaderGetSQLBinaryCopyStatement(state, &header);
+			if (ret != SHPLOADEROK)
+			{
+				fprintf(stderr, "%s\n", state->message);
+				exit(1);
+			}
+
+			printf("%s", header);
+			free(header);
+		}
+	}
+	else if ( state->config->opt != 'p' )
 	{
 
 		/* If in COPY mode, output the COPY statement */
@@ -433,7 +549,8 @@ main (int argc, char **argv)
 			exit(1);
 	}
 
-	printf("%s", footer);
+	if (binary_out != stdout)
+		printf("%s", footer);
 	free(footer);
 
 
@@ -18,6 +18,7 @@
 #include "shp2pgsql-core.h"
 #include "../liblwgeom/liblwgeom.h"
 #include "../liblwgeom/lwgeom_log.h" /* for LWDEBUG macros */
+#include "../liblwgeom/bytebuffer.h"
 
 
 
@@ -47,12 +48,12 @@ typedef struct struct_ring
 char *escape_copy_string(char *str);
 char *escape_insert_string(char *str);
 
-int GeneratePointGeometry(SHPLOADERSTATE *state, SHPObject *obj, char **geometry, int force_multi);
-int GenerateLineStringGeometry(SHPLOADERSTATE *state, SHPObject *obj, char **geometry);
+int GeneratePointGeometry(SHPLOADERSTATE *state, SHPObject *obj, char **geometry, size_t *length, int force_multi);
+int GenerateLineStringGeometry(SHPLOADERSTATE *state, SHPObject *obj, char **geometry, size_t *length);
 int PIP(Point P, Point *V, int n);
 int FindPolygons(SHPObject *obj, Ring ***Out);
 void ReleasePolygons(Ring **polys, int npolys);
-int GeneratePolygonGeometry(SHPLOADERSTATE *state, SHPObject *obj, char **geometry);
+int GeneratePolygonGeometry(SHPLOADERSTATE *state, SHPObject *obj, char **geometry, size_t *length);
 
 
 /* Return allocated string containing UTF8 string converted from encoding fromcode */
@@ -219,12 +220,27 @@ escape_insert_string(char *str)
 }
 
 
+/**
+ * @brief Return the allocated output of a generated geometry: WKT, hex-encoded WKB or, when
+ * writing binary COPY, WKB. Its length is returned in length if not NULL.
+ */
+static char *
+GenerateGeometryOutput(SHPLOADERSTATE *state, LWGEOM *lwgeom, size_t *length)
+{
+	if (state->config->use_wkt)
+		return lwgeom_to_wkt(lwgeom, WKT_EXTENDED, WKT_PRECISION, length);
+	else if (state->config->binary_file)
+		return (char *)lwgeom_to_wkb(lwgeom, WKB_EXTENDED, length);
+	else
+		return lwgeom_to_hexwkb(lwgeom, WKB_EXTENDED, length);
+}
+
 /**
  * @brief Generate an allocated geometry string for shapefile object obj using the state parameters
  * if "force_multi" is true, single points will instead be created as multipoints with a single vertice.
  */
 int
-GeneratePointGeometry(SHPLOADERSTATE *state, SHPObject *obj, char **geometry, int force_multi)
+GeneratePointGeometry(SHPLOADERSTATE *state, SHPObject *obj, char **geometry, size_t *length, int force_multi)
 {
 	LWGEOM **lwmultipoints;
 	LWGEOM *lwgeom = NULL;
@@ -235,7 +251,6 @@ GeneratePointGeometry(SHPLOADERSTATE *state, SHPObject *obj, char **geometry, in
 	int u;
 
 	char *mem;
-	size_t mem_length;
 
 	FLAGS_SET_Z(dims, state->has_z);
 	FLAGS_SET_M(dims, state->has_m);
@@ -277,14 +292,7 @@ GeneratePointGeometry(SHPLOADERSTATE *state, SHPObject *obj, char **geometry, in
 		lwfree(lwmultipoints);
 	}
 
-	if (state->config->use_wkt)
-	{
-		mem = lwgeom_to_wkt(lwgeom, WKT_EXTENDED, WKT_PRECISION, &mem_length);
-	}
-	else
-	{
-		mem = lwgeom_to_hexwkb(lwgeom, WKB_EXTENDED, &mem_length);
-	}
+	mem = GenerateGeometryOutput(state, lwgeom, length);
 
 	if ( !mem )
 	{
@@ -306,7 +314,7 @@ GeneratePointGeometry(SHPLOADERSTATE *state, SHPObject *obj, char **geometry, in
  * @brief Generate an allocated geometry string for shapefile object obj using the state parameters
  */
 int
-GenerateLineStringGeometry(SHPLOADERSTATE *state, SHPObject *obj, char **geometry)
+GenerateLineStringGeometry(SHPLOADERSTATE *state, SHPObject *obj, char **geometry, size_t *length)
 {
 
 	LWGEOM **lwmultilinestrings;
@@ -315,7 +323,6 @@ GenerateLineStringGeometry(SHPLOADERSTATE *state, SHPObject *obj, char **geometr
 	int dims = 0;
 	int u, v, start_vertex, end_vertex;
 	char *mem;
-	size_t mem_length;
 
 
 	FLAGS_SET_Z(dims, state->has_z);
@@ -375,10 +382,7 @@ GenerateLineStringGeometry(SHPLOADERSTATE *state, SHPObject *obj, char **geometr
 		lwfree(lwmultilinestrings);
 	}
 
-	if (!state->config->use_wkt)
-		mem = lwgeom_to_hexwkb(lwgeom, WKB_EXTENDED, &mem_length);
-	else
-		mem = lwgeom_to_wkt(lwgeom, WKT_EXTENDED, WKT_PRECISION, &mem_length);
+	mem = GenerateGeometryOutput(state, lwgeom, length);
 
 	if ( !mem )
 	{
@@ -604,7 +608,7 @@ ReleasePolygons(Ring **polys, int npolys)
  *
  */
 int
-GeneratePolygonGeometry(SHPLOADERSTATE *state, SHPObject *obj, char **geometry)
+GeneratePolygonGeometry(SHPLOADERSTATE *state, SHPObject *obj, char **geometry, size_t *length)
 {
 	Ring **Outer;
 	int polygon_total, ring_total;
@@ -618,7 +622,6 @@ GeneratePolygonGeometry(SHPLOADERSTATE *state, SHPObject *obj, char **geometry)
 	int dims = 0;
 
 	char *mem;
-	size_t mem_length;
 
 	FLAGS_SET_Z(dims, state->has_z);
 	FLAGS_SET_M(dims, state->has_m);
@@ -696,10 +699,7 @@ GeneratePolygonGeometry(SHPLOADERSTATE *state, SHPObject *obj, char **geometry)
 		lwfree(lwpolygons);
 	}
 
-	if (!state->config->use_wkt)
-		mem = lwgeom_to_hexwkb(lwgeom, WKB_EXTENDED, &mem_length);
-	else
-		mem = lwgeom_to_wkt(lwgeom, WKT_EXTENDED, WKT_PRECISION, &mem_length);
+	mem = GenerateGeometryOutput(state, lwgeom, length);
 
 	if ( !mem )
 	{
@@ -762,6 +762,7 @@ set_loader_config_defaults(SHPLOADERCONFIG *config)
 	config->idxtablespace = NULL;
 	config->usetransaction = 1;
 	config->column_map_filename = NULL;
+	config->binary_file = NULL;
 }
 
 /* Create a new shapefile state object */
@@ -1498,53 +1499,184 @@ ShpLoaderGetRecordCount(SHPLOADERSTATE *state)
 }
 
 
-/* Return an allocated string representation of a specified record item */
-int
-ShpLoaderGenerateSQLRowStatement(SHPLOADERSTATE *state, int item, char **strrecord)
+/*
+ * Read the shape object of the specified record item into *obj (NULL if only
+ * reading the DBF file), returning the record status
+ */
+static int
+ShpLoaderReadRecord(SHPLOADERSTATE *state, int item, SHPObject **obj)
 {
-	SHPObject *obj = NULL;
-	stringbuffer_t *sb;
-	stringbuffer_t *sbwarn;
-	char val[MAXVALUELEN];
-	char *escval;
-	char *geometry=NULL, *ret;
-	char *utf8str;
-	int res, i;
-	int rv;
-
-	/* Clear the stringbuffers */
-	sbwarn = stringbuffer_create();
-	stringbuffer_clear(sbwarn);
-	sb = stringbuffer_create();
-	stringbuffer_clear(sb);
+	*obj = NULL;
 
 	/* If we are reading the DBF only and the record has been marked deleted, return deleted record status */
 	if (state->config->readshape == 0 && DBFIsRecordDeleted(state->hDBFHandle, item))
-	{
-		*strrecord = NULL;
 		return SHPLOADERRECDELETED;
-	}
 
 	/* If we are reading the shapefile, open the specified record */
 	if (state->config->readshape == 1)
 	{
-		obj = SHPReadObject(state->hSHPHandle, item);
-		if (!obj)
+		*obj = SHPReadObject(state->hSHPHandle, item);
+		if (!*obj)
 		{
 			snprintf(state->message, SHPLOADERMSGLEN, _("Error reading shape object %d"), item);
 			return SHPLOADERERR;
 		}
 
 		/* If we are set to skip NULLs, return a NULL record status */
-		if (state->config->null_policy == POLICY_NULL_SKIP && obj->nVertices == 0 )
+		if (state->config->null_policy == POLICY_NULL_SKIP && (*obj)->nVertices == 0 )
 		{
-			SHPDestroyObject(obj);
+			SHPDestroyObject(*obj);
+			*obj = NULL;
 
-			*strrecord = NULL;
 			return SHPLOADERRECISNULL;
 		}
 	}
 
+	return SHPLOADEROK;
+}
+
+
+/*
+ * Read the non-NULL DBF attribute i of the specified record item into val,
+ * cleaned up and converted to UTF-8. Truncation warnings are added to sbwarn.
+ */
+static int
+ShpLoaderReadAttribute(SHPLOADERSTATE *state, int item, int i, char *val, stringbuffer_t *sbwarn)
+{
+	char *utf8str;
+	int rv;
+
+	switch (state->types[i])
+	{
+	case FTInteger:
+	case FTDouble:
+		rv = snprintf(val, MAXVALUELEN, "%s", DBFReadStringAttribute(state->hDBFHandle, item, i));
+		if (rv >= MAXVALUELEN || rv == -1)
+		{
+			stringbuffer_aprintf(sbwarn, "Warning: field %d name truncated\n", i);
+			val[MAXVALUELEN - 1] = '\0';
+		}
+
+		/* If the value is an empty string, change to 0 */
+		if (val[0] == '\0')
+		{
+			val[0] = '0';
+			val[1] = '\0';
+		}
+
+		/* If the value ends with just ".", remove the dot */
+		if (val[strlen(val) - 1] == '.')
+			val[strlen(val) - 1] = '\0';
+		break;
+
+	case FTString:
+	case FTLogical:
+	case FTDate:
+		rv = snprintf(val, MAXVALUELEN, "%s", DBFReadStringAttribute(state->hDBFHandle, item, i));
+		if (rv >= MAXVALUELEN || rv == -1)
+		{
+			stringbuffer_aprintf(sbwarn, "Warning: field %d name truncated\n", i);
+			val[MAXVALUELEN - 1] = '\0';
+		}
+		break;
+
+	default:
+		snprintf(state->message, SHPLOADERMSGLEN, _("Error: field %d has invalid or unknown field type (%d)"), i, state->types[i]);
+
+		return SHPLOADERERR;
+	}
+
+	if (state->config->encoding)
+	{
+		char *encoding_msg = _("Try \"LATIN1\" (Western European), or one of the values described at http://www.postgresql.org/docs/current/static/multibyte.html.");
+
+		rv = utf8(state->config->encoding, val, &utf8str);
+
+		if (rv != UTF8_GOOD_RESULT)
+		{
+			if ( rv == UTF8_BAD_RESULT )
+				snprintf(state->message, SHPLOADERMSGLEN, _("Unable to convert data value \"%s\" to UTF-8 (iconv reports \"%s\"). Current encoding is \"%s\". %s"), utf8str, strerror(errno), state->config->encoding, encoding_msg);
+			else if ( rv == UTF8_NO_RESULT )
+				snprintf(state->message, SHPLOADERMSGLEN, _("Unable to convert data value to UTF-8 (iconv reports \"%s\"). Current encoding is \"%s\". %s"), strerror(errno), state->config->encoding, encoding_msg);
+			else
+				snprintf(state->message, SHPLOADERMSGLEN, _("Unexpected return value from utf8()"));
+
+			if ( rv == UTF8_BAD_RESULT )
+				free(utf8str);
+
+			return SHPLOADERERR;
+		}
+		strncpy(val, utf8str, MAXVALUELEN);
+		free(utf8str);
+
+	}
+
+	return SHPLOADEROK;
+}
+
+
+/* Generate the geometry string of a non-NULL shape object */
+static int
+ShpLoaderGenerateGeometry(SHPLOADERSTATE *state, SHPObject *obj, char **geometry, size_t *length)
+{
+	switch (obj->nSHPType)
+	{
+	case SHPT_POLYGON:
+	case SHPT_POLYGONM:
+	case SHPT_POLYGONZ:
+		return GeneratePolygonGeometry(state, obj, geometry, length);
+
+	case SHPT_POINT:
+	case SHPT_POINTM:
+	case SHPT_POINTZ:
+		return GeneratePointGeometry(state, obj, geometry, length, 0);
+
+	case SHPT_MULTIPOINT:
+	case SHPT_MULTIPOINTM:
+	case SHPT_MULTIPOINTZ:
+		/* Force it to multi unless using -S */
+		return GeneratePointGeometry(state, obj, geometry, length,
+			state->config->simple_geometries ? 0 : 1);
+
+	case SHPT_ARC:
+	case SHPT_ARCM:
+	case SHPT_ARCZ:
+		return GenerateLineStringGeometry(state, obj, geometry, length);
+
+	default:
+		snprintf(state->message, SHPLOADERMSGLEN, _("Shape type is not supported, type id = %d"), obj->nSHPType);
+
+		return SHPLOADERERR;
+	}
+}
+
+
+/* Return an allocated string representation of a specified record item */
+int
+ShpLoaderGenerateSQLRowStatement(SHPLOADERSTATE *state, int item, char **strrecord)
+{
+	SHPObject *obj = NULL;
+	stringbuffer_t *sb;
+	stringbuffer_t *sbwarn;
+	char val[MAXVALUELEN];
+	char *escval;
+	char *geometry=NULL, *ret;
+	int res, i;
+
+	/* Open the specified record, unless it is to be ignored */
+	res = ShpLoaderReadRecord(state, item, &obj);
+	if (res != SHPLOADEROK)
+	{
+		*strrecord = NULL;
+		return res;
+	}
+
+	/* Clear the stringbuffers */
+	sbwarn = stringbuffer_create();
+	stringbuffer_clear(sbwarn);
+	sb = stringbuffer_create();
+	stringbuffer_clear(sb);
+
 	/* If not in dump format, generate the INSERT string */
 	if (!state->config->dump_format)
 	{
@@ -1575,43 +1707,9 @@ ShpLoaderGenerateSQLRowStatement(SHPLOADERSTATE *state, int item, char **strreco
 		else
 		{
 			/* Attribute NOT NULL */
-			switch (state->types[i])
+			if (ShpLoaderReadAttribute(state, item, i, val, sbwarn) != SHPLOADEROK)
 			{
-			case FTInteger:
-			case FTDouble:
-				rv = snprintf(val, MAXVALUELEN, "%s", DBFReadStringAttribute(state->hDBFHandle, item, i));
-				if (rv >= MAXVALUELEN || rv == -1)
-				{
-					stringbuffer_aprintf(sbwarn, "Warning: field %d name truncated\n", i);
-					val[MAXVALUELEN - 1] = '\0';
-				}
-
-				/* If the value is an empty string, change to 0 */
-				if (val[0] == '\0')
-				{
-					val[0] = '0';
-					val[1] = '\0';
-				}
-
-				/* If the value ends with just ".", remove the dot */
-				if (val[strlen(val) - 1] == '.')
-					val[strlen(val) - 1] = '\0';
-				break;
-
-			case FTString:
-			case FTLogical:
-			case FTDate:
-				rv = snprintf(val, MAXVALUELEN, "%s", DBFReadStringAttribute(state->hDBFHandle, item, i));
-				if (rv >= MAXVALUELEN || rv == -1)
-				{
-					stringbuffer_aprintf(sbwarn, "Warning: field %d name truncated\n", i);
-					val[MAXVALUELEN - 1] = '\0';
-				}
-				break;
-
-			default:
-				snprintf(state->message, SHPLOADERMSGLEN, _("Error: field %d has invalid or unknown field type (%d)"), i, state->types[i]);
-
+				/* Error message has already been set */
 				SHPDestroyObject(obj);
 				stringbuffer_destroy(sbwarn);
 				stringbuffer_destroy(sb);
@@ -1619,31 +1717,6 @@ ShpLoaderGenerateSQLRowStatement(SHPLOADERSTATE *state, int item, char **strreco
 				return SHPLOADERERR;
 			}
 
-			if (state->config->encoding)
-			{
-				char *encoding_msg = _("Try \"LATIN1\" (Western European), or one of the values described at http://www.postgresql.org/docs/current/static/multibyte.html.");
-
-				rv = utf8(state->config->encoding, val, &utf8str);
-
-				if (rv != UTF8_GOOD_RESULT)
-				{
-					if ( rv == UTF8_BAD_RESULT )
-						snprintf(state->message, SHPLOADERMSGLEN, _("Unable to convert data value \"%s\" to UTF-8 (iconv reports \"%s\"). Current encoding is \"%s\". %s"), utf8str, strerror(errno), state->config->encoding, encoding_msg);
-					else if ( rv == UTF8_NO_RESULT )
-						snprintf(state->message, SHPLOADERMSGLEN, _("Unable to convert data value to UTF-8 (iconv reports \"%s\"). Current encoding is \"%s\". %s"), strerror(errno), state->config->encoding, encoding_msg);
-					else
-						snprintf(state->message, SHPLOADERMSGLEN, _("Unexpected return value from utf8()"));
-
-					if ( rv == UTF8_BAD_RESULT )
-						free(utf8str);
-
-					return SHPLOADERERR;
-				}
-				strncpy(val, utf8str, MAXVALUELEN);
-				free(utf8str);
-
-			}
-
 			/* Escape attribute correctly according to dump format */
 			if (state->config->dump_format)
 			{
@@ -1691,43 +1764,7 @@ ShpLoaderGenerateSQLRowStatement(SHPLOADERSTATE *state, int item, char **strreco
 		else
 		{
 			/* Handle all other shape attributes */
-			switch (obj->nSHPType)
-			{
-			case SHPT_POLYGON:
-			case SHPT_POLYGONM:
-			case SHPT_POLYGONZ:
-				res = GeneratePolygonGeometry(state, obj, &geometry);
-				break;
-
-			case SHPT_POINT:
-			case SHPT_POINTM:
-			case SHPT_POINTZ:
-				res = GeneratePointGeometry(state, obj, &geometry, 0);
-				break;
-
-			case SHPT_MULTIPOINT:
-			case SHPT_MULTIPOINTM:
-			case SHPT_MULTIPOINTZ:
-				/* Force it to multi unless using -S */
-				res = GeneratePointGeometry(state, obj, &geometry,
-					state->config->simple_geometries ? 0 : 1);
-				break;
-
-			case SHPT_ARC:
-			case SHPT_ARCM:
-			case SHPT_ARCZ:
-				res = GenerateLineStringGeometry(state, obj, &geometry);
-				break;
-
-			default:
-				snprintf(state->message, SHPLOADERMSGLEN, _("Shape type is not supported, type id = %d"), obj->nSHPType);
-				SHPDestroyObject(obj);
-				stringbuffer_destroy(sbwarn);
-				stringbuffer_destroy(sb);
-
-				return SHPLOADERERR;
-			}
-			/* The default returns out of the function, so res will always have been set. */
+			res = ShpLoaderGenerateGeometry(state, obj, &geometry, NULL);
 			if (res != SHPLOADEROK)
 			{
 				/* Error message has already been set */
@@ -1806,6 +1843,437 @@ ShpLoaderGenerateSQLRowStatement(SHPLOADERSTATE *state, int item, char **strreco
 }
 
 
+/* Append integers to a binary COPY row in network byte order */
+static void
+binary_append_int16(bytebuffer_t *b, int v)
+{
+	bytebuffer_append_byte(b, (v >> 8) & 0xFF);
+	bytebuffer_append_byte(b, v & 0xFF);
+}
+
+static void
+binary_append_int32(bytebuffer_t *b, int32_t v)
+{
+	int i;
+
+	for (i = 24; i >= 0; i -= 8)
+		bytebuffer_append_byte(b, ((uint32_t) v >> i) & 0xFF);
+}
+
+static void
+binary_append_int64(bytebuffer_t *b, uint64_t v)
+{
+	int i;
+
+	for (i = 56; i >= 0; i -= 8)
+		bytebuffer_append_byte(b, (v >> i) & 0xFF);
+}
+
+/* Append a WKB geometry as the geometry/geography send format */
+static void
+binary_append_wkb(bytebuffer_t *b, const uint8_t *wkb, size_t len)
+{
+	binary_append_int32(b, len);
+	bytebuffer_append_bulk(b, (void *)wkb, len);
+}
+
+/* Julian day number of a date, as in the PostgreSQL backend */
+static int
+binary_date2j(int y, int m, int d)
+{
+	int julian;
+	int century;
+
+	if (m > 2)
+	{
+		m += 1;
+		y += 4800;
+	}
+	else
+	{
+		m += 13;
+		y += 4799;
+	}
+
+	century = y / 100;
+	julian = y * 365 - 32167;
+	julian += y / 4 - century + century / 4;
+	julian += 7834 * m / 256 + d;
+
+	return julian;
+}
+
+/* Append a DBF date (YYYYMMDD) as days since 2000-01-01 */
+static int
+binary_append_date(bytebuffer_t *b, const char *val)
+{
+	static const int mdays[] = {31, 29, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+	int y, m, d, n = 0;
+
+	while (isspace((unsigned char) *val))
+		val++;
+	if (sscanf(val, "%4d%2d%2d%n", &y, &m, &d, &n) != 3 || n != 8)
+		return 0;
+	for (val += n; *val; val++)
+	{
+		if (!isspace((unsigned char) *val))
+			return 0;
+	}
+
+	if (y < 1 || m < 1 || m > 12 || d < 1 || d > mdays[m - 1])
+		return 0;
+	if (m == 2 && d == 29 && !((y % 4 == 0 && y % 100 != 0) || y % 400 == 0))
+		return 0;
+
+	binary_append_int32(b, 4);
+	binary_append_int32(b, binary_date2j(y, m, d) - binary_date2j(2000, 1, 1));
+
+	return 1;
+}
+
+/*
+ * Append a decimal number as the numeric send format: ndigits, weight, sign
+ * and display scale followed by the base 10000 digits, most significant first
+ */
+static int
+binary_append_numeric(bytebuffer_t *b, const char *val)
+{
+	char digits[MAXVALUELEN + 8];
+	int ndigits = 0;
+	int point = 0;
+	int scale = 0;
+	int seenpoint = 0;
+	int seendigit = 0;
+	int negative = 0;
+	int exponent = 0;
+	int weight, lead, ngroups, i, j, group;
+	char *endptr;
+
+	while (isspace((unsigned char) *val))
+		val++;
+	if (*val == '-' || *val == '+')
+		negative = (*val++ == '-');
+
+	for (; *val; val++)
+	{
+		if (*val == '.' && !seenpoint)
+			seenpoint = 1;
+		else if (isdigit((unsigned char) *val))
+		{
+			seendigit = 1;
+
+			/* skip leading zeros */
+			if (ndigits || *val != '0')
+				digits[ndigits++] = *val;
+			if (seenpoint)
+				scale++;
+			else if (ndigits)
+				point++;
+		}
+		else
+			break;
+	}
+	if (!seendigit)
+		return 0;
+
+	if (*val == 'e' || *val == 'E')
+	{
+		errno = 0;
+		exponent = strtol(val + 1, &endptr, 10);
+		if (endptr == val + 1 || errno || exponent > 1000 || exponent < -1000)
+			return 0;
+		val = endptr;
+	}
+	while (isspace((unsigned char) *val))
+		val++;
+	if (*val)
+		return 0;
+
+	/* leading zeros of the fraction come before the first digit */
+	if (!point)
+		point = -(scale - ndigits);
+	point += exponent;
+	scale -= exponent;
+	if (scale < 0)
+		scale = 0;
+
+	/* drop trailing zeros */
+	while (ndigits && digits[ndigits - 1] == '0')
+		ndigits--;
+
+	if (!ndigits)
+	{
+		binary_append_int32(b, 8);
+		binary_append_int16(b, 0);
+		binary_append_int16(b, 0);
+		binary_append_int16(b, 0);
+		binary_append_int16(b, scale);
+		return 1;
+	}
+
+	/* group of the first digit and its position within the group */
+	weight = (point >= 1) ? (point - 1) / 4 : -((4 - point) / 4);
+	lead = 4 * (weight + 1) - point;
+	ngroups = (lead + ndigits + 3) / 4;
+
+	binary_append_int32(b, 8 + 2 * ngroups);
+	binary_append_int16(b, ngroups);
+	binary_append_int16(b, weight);
+	binary_append_int16(b, negative ? 0x4000 : 0);
+	binary_append_int16(b, scale);
+
+	for (i = 0, j = -lead; i < ngroups; i++)
+	{
+		int k;
+
+		group = 0;
+		for (k = 0; k < 4; k++, j++)
+			group = group * 10 + ((j >= 0 && j < ndigits) ? digits[j] - '0' : 0);
+		binary_append_int16(b, group);
+	}
+
+	return 1;
+}
+
+/* Append a non-NULL attribute in the send format of its PostgreSQL type */
+static int
+binary_append_attribute(bytebuffer_t *b, const char *pgfieldtype, const char *val)
+{
+	char *endptr;
+	long l;
+	double d;
+	uint64_t u;
+
+	if (!strcmp("varchar", pgfieldtype))
+	{
+		binary_append_int32(b, strlen(val));
+		bytebuffer_append_bulk(b, (void *) val, strlen(val));
+		return 1;
+	}
+	else if (!strcmp("int2", pgfieldtype) || !strcmp("int4", pgfieldtype))
+	{
+		errno = 0;
+		l = strtol(val, &endptr, 10);
+		while (isspace((unsigned char) *endptr))
+			endptr++;
+		if (endptr == val || *endptr || errno)
+			return 0;
+
+		if (!strcmp("int2", pgfieldtype))
+		{
+			if (l < -32768 || l > 32767)
+				return 0;
+			binary_append_int32(b, 2);
+			binary_append_int16(b, l);
+		}
+		else
+		{
+			if (l < INT32_MIN || l > INT32_MAX)
+				return 0;
+			binary_append_int32(b, 4);
+			binary_append_int32(b, l);
+		}
+		return 1;
+	}
+	else if (!strcmp("float8", pgfieldtype))
+	{
+		d = strtod(val, &endptr);
+		while (isspace((unsigned char) *endptr))
+			endptr++;
+		if (endptr == val || *endptr)
+			return 0;
+
+		memcpy(&u, &d, sizeof(d));
+		binary_append_int32(b, 8);
+		binary_append_int64(b, u);
+		return 1;
+	}
+	else if (!strcmp("numeric", pgfieldtype))
+		return binary_append_numeric(b, val);
+	else if (!strcmp("date", pgfieldtype))
+		return binary_append_date(b, val);
+	else if (!strcmp("boolean", pgfieldtype))
+	{
+		while (isspace((unsigned char) *val))
+			val++;
+		binary_append_int32(b, 1);
+		if (*val && strchr("TtYy1", *val))
+			bytebuffer_append_byte(b, 1);
+		else if (*val && strchr("FfNn0", *val))
+			bytebuffer_append_byte(b, 0);
+		else
+			return 0;
+		return 1;
+	}
+
+	return 0;
+}
+
+
+/* Return the header of the rows in binary COPY format */
+int
+ShpLoaderGetBinaryHeader(SHPLOADERSTATE *state, char **strheader, size_t *length)
+{
+	/* Signature, flags and header extension length */
+	static const char header[19] = "PGCOPY\n\377\r\n\0\0\0\0\0\0\0\0\0";
+
+	*strheader = malloc(sizeof(header));
+	memcpy(*strheader, header, sizeof(header));
+	*length = sizeof(header);
+
+	return SHPLOADEROK;
+}
+
+
+/* Return the trailer of the rows in binary COPY format */
+int
+ShpLoaderGetBinaryTrailer(SHPLOADERSTATE *state, char **strfooter, size_t *length)
+{
+	*strfooter = malloc(2);
+	(*strfooter)[0] = (char) 0xFF;
+	(*strfooter)[1] = (char) 0xFF;
+	*length = 2;
+
+	return SHPLOADEROK;
+}
+
+
+/* Return an allocated string containing the \copy command loading the binary COPY file */
+int
+ShpLoaderGetSQLBinaryCopyStatement(SHPLOADERSTATE *state, char **strheader)
+{
+	stringbuffer_t *sb;
+	char *escfile;
+
+	if (!state->config->binary_file)
+	{
+		snprintf(state->message, SHPLOADERMSGLEN, _("Internal error: attempt to generate a \\copy command for data that hasn't been requested in binary COPY format"));
+
+		return SHPLOADERERR;
+	}
+
+	sb = stringbuffer_create();
+	stringbuffer_clear(sb);
+
+	if (state->config->schema)
+		stringbuffer_aprintf(sb, "\\copy \"%s\".\"%s\" %s", state->config->schema,
+		                     state->config->table, state->col_names);
+	else
+		stringbuffer_aprintf(sb, "\\copy \"%s\" %s", state->config->table, state->col_names);
+
+	escfile = escape_insert_string(state->config->binary_file);
+	stringbuffer_aprintf(sb, " FROM '%s' WITH (FORMAT binary)\n", escfile);
+	if (escfile != state->config->binary_file)
+		free(escfile);
+
+	*strheader = strdup(stringbuffer_getstring(sb));
+	stringbuffer_destroy(sb);
+
+	return SHPLOADEROK;
+}
+
+
+/*
+ * Return an allocated binary COPY row of a specified record item and its
+ * length. Attributes are written in the send format of the column types
+ * chosen by ShpLoaderOpenShape and geometries as WKB.
+ */
+int
+ShpLoaderGenerateBinaryRow(SHPLOADERSTATE *state, int item, char **record, size_t *length)
+{
+	SHPObject *obj = NULL;
+	bytebuffer_t *b;
+	stringbuffer_t *sbwarn;
+	char val[MAXVALUELEN];
+	char *geometry = NULL;
+	size_t geometry_length = 0;
+	char *oldlocale;
+	int res, i;
+
+	*record = NULL;
+	*length = 0;
+
+	/* Open the specified record, unless it is to be ignored */
+	res = ShpLoaderReadRecord(state, item, &obj);
+	if (res != SHPLOADEROK)
+		return res;
+
+	sbwarn = stringbuffer_create();
+	stringbuffer_clear(sbwarn);
+	b = bytebuffer_create();
+
+	/* Numbers are parsed the way the server would */
+	oldlocale = setlocale(LC_NUMERIC, "C");
+
+	/* Field count */
+	binary_append_int16(b, DBFGetFieldCount(state->hDBFHandle) + (state->config->readshape == 1 ? 1 : 0));
+
+	for (i = 0; i < DBFGetFieldCount(state->hDBFHandle); i++)
+	{
+		if (DBFIsAttributeNULL(state->hDBFHandle, item, i))
+		{
+			binary_append_int32(b, -1);
+			continue;
+		}
+
+		res = ShpLoaderReadAttribute(state, item, i, val, sbwarn);
+		if (res == SHPLOADEROK && !binary_append_attribute(b, state->pgfieldtypes[i], val))
+		{
+			snprintf(state->message, SHPLOADERMSGLEN, _("Unable to convert value \"%s\" of field %d to binary %s"), val, i, state->pgfieldtypes[i]);
+			res = SHPLOADERERR;
+		}
+		if (res != SHPLOADEROK)
+			break;
+	}
+
+	/* Add the shape attribute if we are reading it */
+	if (res == SHPLOADEROK && state->config->readshape == 1)
+	{
+		if (obj->nVertices == 0)
+			binary_append_int32(b, -1);
+		else
+		{
+			res = ShpLoaderGenerateGeometry(state, obj, &geometry, &geometry_length);
+			if (res == SHPLOADEROK)
+			{
+				binary_append_wkb(b, (uint8_t *)geometry, geometry_length);
+				free(geometry);
+			}
+		}
+	}
+
+	setlocale(LC_NUMERIC, oldlocale);
+	SHPDestroyObject(obj);
+
+	if (res != SHPLOADEROK)
+	{
+		/* Error message has already been set */
+		bytebuffer_destroy(b);
+		stringbuffer_destroy(sbwarn);
+
+		return SHPLOADERERR;
+	}
+
+	/* Copy the byte buffer into a new record, destroying the byte buffer */
+	*length = bytebuffer_getlength(b);
+	*record = malloc(*length);
+	memcpy(*record, b->buf_start, *length);
+	bytebuffer_destroy(b);
+
+	/* If any warnings occurred, set the returned message string and warning status */
+	if (strlen((char *)stringbuffer_getstring(sbwarn)) > 0)
+	{
+		snprintf(state->message, SHPLOADERMSGLEN, "%s", stringbuffer_getstring(sbwarn));
+		stringbuffer_destroy(sbwarn);
+
+		return SHPLOADERWARN;
+	}
+
+	stringbuffer_destroy(sbwarn);
+
+	return SHPLOADEROK;
+}
+
 /* Return a pointer to an allocated string containing the header for the specified loader state */
 int
 ShpLoaderGetSQLFooter(SHPLOADERSTATE *state, char **strfooter)
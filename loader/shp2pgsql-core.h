@@ -147,6 +147,9 @@ typedef struct shp_loader_config
 	/* Name of the column map file if specified */
 	char *column_map_filename;
 
+	/* File for rows in binary COPY format, "-" = stdout, NULL = SQL output */
+	char *binary_file;
+
 } SHPLOADERCONFIG;
 
 
@@ -233,5 +236,9 @@ int ShpLoaderGetSQLHeader(SHPLOADERSTATE *state, char **strheader);
 int ShpLoaderGetSQLCopyStatement(SHPLOADERSTATE *state, char **strheader);
 int ShpLoaderGetRecordCount(SHPLOADERSTATE *state);
 int ShpLoaderGenerateSQLRowStatement(SHPLOADERSTATE *state, int item, char **strrecord);
+int ShpLoaderGetBinaryHeader(SHPLOADERSTATE *state, char **strheader, size_t *length);
+int ShpLoaderGetBinaryTrailer(SHPLOADERSTATE *state, char **strfooter, size_t *length);
+int ShpLoaderGetSQLBinaryCopyStatement(SHPLOADERSTATE *state, char **strheader);
+int ShpLoaderGenerateBinaryRow(SHPLOADERSTATE *state, int item, char **record, size_t *length);
 int ShpLoaderGetSQLFooter(SHPLOADERSTATE *state, char **strfooter);
 void ShpLoaderDestroy(SHPLOADERSTATE *state);
@@ -190,14 +190,11 @@ Datum geography_in(PG_FUNCTION_ARGS)
 PG_FUNCTION_INFO_V1(geography_out);
 Datum geography_out(PG_FUNCTION_ARGS)
 {
-	LWGEOM *lwgeom = NULL;
 	GSERIALIZED *g = NULL;
 	char *hexwkb;
 
 	g = PG_GETARG_GSERIALIZED_P(0);
-	lwgeom = lwgeom_from_gserialized(g);
-	hexwkb = lwgeom_to_hexwkb(lwgeom, WKB_EXTENDED, 0);
-	lwgeom_free(lwgeom);
+	hexwkb = gserialized_to_hexwkb(g, WKB_EXTENDED, 0);
 
 	PG_RETURN_CSTRING(hexwkb);
 }
@@ -684,16 +681,13 @@ Datum geography_recv(PG_FUNCTION_ARGS)
 PG_FUNCTION_INFO_V1(geography_send);
 Datum geography_send(PG_FUNCTION_ARGS)
 {
-	LWGEOM *lwgeom = NULL;
 	GSERIALIZED *g = NULL;
 	size_t size_result;
 	uint8_t *wkb;
 	bytea *result;
 
 	g = PG_GETARG_GSERIALIZED_P(0);
-	lwgeom = lwgeom_from_gserialized(g);
-	wkb = lwgeom_to_wkb(lwgeom, WKB_EXTENDED, &size_result);
-	lwgeom_free(lwgeom);
+	wkb = gserialized_to_wkb(g, WKB_EXTENDED, &size_result);
 
 	result = palloc(size_result + VARHDRSZ);
 	SET_VARSIZE(result, size_result + VARHDRSZ);
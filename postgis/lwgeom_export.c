@@ -31,16 +31,23 @@
 #include "float.h" /* for DBL_DIG */
 #include "postgres.h"
 #include "executor/spi.h"
+#include "utils/lsyscache.h" /* for type_is_rowtype */
 
 #include "../postgis_config.h"
+#if POSTGIS_PGSQL_VERSION >= 92
+#include "utils/json.h" /* for row_to_json */
+#endif
 #include "lwgeom_pg.h"
 #include "liblwgeom.h"
+#include "liblwgeom_internal.h" /* for lwgeom_to_geojson_sb */
 #include "lwgeom_export.h"
 
 Datum LWGEOM_asGML(PG_FUNCTION_ARGS);
 Datum LWGEOM_asKML(PG_FUNCTION_ARGS);
 Datum LWGEOM_asGeoJson(PG_FUNCTION_ARGS);
 Datum LWGEOM_asGeoJson_old(PG_FUNCTION_ARGS);
+Datum pgis_asgeojson_transfn(PG_FUNCTION_ARGS);
+Datum pgis_asgeojson_finalfn(PG_FUNCTION_ARGS);
 Datum LWGEOM_asSVG(PG_FUNCTION_ARGS);
 Datum LWGEOM_asX3D(PG_FUNCTION_ARGS);
 Datum LWGEOM_asEncodedPolyline(PG_FUNCTION_ARGS);
@@ -477,6 +484,137 @@ Datum LWGEOM_asGeoJson(PG_FUNCTION_ARGS)
 }
 
 
+/**
+ * State of the GeoJson FeatureCollection aggregate: the whole
+ * collection is appended to one buffer allocated in the aggregate
+ * memory context, the closing brackets are added by the final function.
+ */
+typedef struct
+{
+	stringbuffer_t *sb;
+	uint32_t nfeatures;
+}
+geojson_agg_state;
+
+/**
+ * Append a Feature built from a geometry and a properties record
+ * to a GeoJson FeatureCollection
+ */
+PG_FUNCTION_INFO_V1(pgis_asgeojson_transfn);
+Datum pgis_asgeojson_transfn(PG_FUNCTION_ARGS)
+{
+	MemoryContext aggcontext;
+	MemoryContext oldcontext;
+	geojson_agg_state *state;
+	int precision = DBL_DIG;
+
+	if ( ! AggCheckCallContext(fcinfo, &aggcontext) )
+	{
+		/* cannot be called directly because of internal-type argument */
+		elog(ERROR, "%s called in non-aggregate context", __func__);
+		aggcontext = NULL;  /* keep compiler quiet */
+	}
+
+	if ( PG_ARGISNULL(0) )
+	{
+		/* row_to_json reads the properties as a tuple */
+		if ( PG_NARGS() > 2 && ! type_is_rowtype(get_fn_expr_argtype(fcinfo->flinfo, 2)) )
+			elog(ERROR, "%s: properties must be a record", __func__);
+
+		/* the buffer is grown by repalloc, it stays in aggcontext */
+		oldcontext = MemoryContextSwitchTo(aggcontext);
+		state = palloc(sizeof(geojson_agg_state));
+		state->sb = stringbuffer_create();
+		state->nfeatures = 0;
+		MemoryContextSwitchTo(oldcontext);
+
+		stringbuffer_append(state->sb, "{\"type\":\"FeatureCollection\",\"features\":[");
+	}
+	else
+	{
+		state = (geojson_agg_state*) PG_GETARG_POINTER(0);
+	}
+
+	/* Retrieve precision if any (default is max) */
+	if ( PG_NARGS() > 3 && !PG_ARGISNULL(3) )
+	{
+		precision = PG_GETARG_INT32(3);
+		if ( precision > DBL_DIG )
+			precision = DBL_DIG;
+		else if ( precision < 0 )
+			precision = 0;
+	}
+
+	if ( state->nfeatures++ )
+		stringbuffer_append_char(state->sb, ',');
+	stringbuffer_append(state->sb, "{\"type\":\"Feature\",\"geometry\":");
+
+	if ( PG_ARGISNULL(1) )
+	{
+		stringbuffer_append(state->sb, "null");
+	}
+	else
+	{
+		GSERIALIZED *geom = PG_GETARG_GSERIALIZED_P(1);
+		LWGEOM *lwgeom = lwgeom_from_gserialized(geom);
+
+		/* coordinates are formatted straight into the collection */
+		lwgeom_to_geojson_sb(lwgeom, NULL, precision, 0, state->sb);
+		lwgeom_free(lwgeom);
+		PG_FREE_IF_COPY(geom, 1);
+	}
+
+	stringbuffer_append(state->sb, ",\"properties\":");
+
+	if ( PG_NARGS() > 2 && !PG_ARGISNULL(2) )
+	{
+#if POSTGIS_PGSQL_VERSION >= 92
+		text *json = DatumGetTextP(DirectFunctionCall1(row_to_json, PG_GETARG_DATUM(2)));
+		stringbuffer_append_len(state->sb, VARDATA_ANY(json), VARSIZE_ANY_EXHDR(json));
+		pfree(json);
+#endif
+	}
+	else
+	{
+		stringbuffer_append(state->sb, "null");
+	}
+
+	stringbuffer_append_char(state->sb, '}');
+
+	PG_RETURN_POINTER(state);
+}
+
+/**
+ * Close the GeoJson FeatureCollection and return it as text
+ */
+PG_FUNCTION_INFO_V1(pgis_asgeojson_finalfn);
+Datum pgis_asgeojson_finalfn(PG_FUNCTION_ARGS)
+{
+	geojson_agg_state *state;
+	text *result;
+	size_t len;
+
+	/* cannot be called directly because of internal-type argument */
+	Assert(fcinfo->context &&
+	       (IsA(fcinfo->context, AggState) ||
+	        IsA(fcinfo->context, WindowAggState))
+	       );
+
+	if ( PG_ARGISNULL(0) )
+		PG_RETURN_NULL();   /* returns null iff no input values */
+
+	state = (geojson_agg_state*) PG_GETARG_POINTER(0);
+
+	/* the state is left untouched, the final function may be called again */
+	len = stringbuffer_getlength(state->sb);
+	result = palloc(VARHDRSZ + len + 2);
+	SET_VARSIZE(result, VARHDRSZ + len + 2);
+	memcpy(VARDATA(result), stringbuffer_getstring(state->sb), len);
+	memcpy(VARDATA(result) + len, "]}", 2);
+
+	PG_RETURN_TEXT_P(result);
+}
+
 /**
  * SVG features
  */
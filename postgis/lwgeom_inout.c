@@ -68,6 +68,8 @@ Datum LWGEOM_to_latlon(PG_FUNCTION_ARGS);
 Datum WKBFromLWGEOM(PG_FUNCTION_ARGS);
 Datum TWKBFromLWGEOM(PG_FUNCTION_ARGS);
 Datum TWKBFromLWGEOMArray(PG_FUNCTION_ARGS);
+Datum pgis_astwkb_transfn(PG_FUNCTION_ARGS);
+Datum pgis_astwkb_finalfn(PG_FUNCTION_ARGS);
 Datum LWGEOMFromTWKB(PG_FUNCTION_ARGS);
 
 
@@ -268,13 +270,11 @@ PG_FUNCTION_INFO_V1(LWGEOM_out);
 Datum LWGEOM_out(PG_FUNCTION_ARGS)
 {
 	GSERIALIZED *geom = PG_GETARG_GSERIALIZED_P(0);
-	LWGEOM *lwgeom;
 	char *hexwkb;
 	size_t hexwkb_size;
 
-	lwgeom = lwgeom_from_gserialized(geom);
-	hexwkb = lwgeom_to_hexwkb(lwgeom, WKB_EXTENDED, &hexwkb_size);
-	lwgeom_free(lwgeom);
+	/* Write straight from the serialized form */
+	hexwkb = gserialized_to_hexwkb(geom, WKB_EXTENDED, &hexwkb_size);
 	
 	PG_RETURN_CSTRING(hexwkb);
 }
@@ -286,7 +286,6 @@ PG_FUNCTION_INFO_V1(LWGEOM_asHEXEWKB);
 Datum LWGEOM_asHEXEWKB(PG_FUNCTION_ARGS)
 {
 	GSERIALIZED *geom = PG_GETARG_GSERIALIZED_P(0);
-	LWGEOM *lwgeom;
 	char *hexwkb;
 	size_t hexwkb_size;
 	uint8_t variant = 0;
@@ -311,9 +310,7 @@ Datum LWGEOM_asHEXEWKB(PG_FUNCTION_ARGS)
 	}
 
 	/* Create WKB hex string */
-	lwgeom = lwgeom_from_gserialized(geom);
-	hexwkb = lwgeom_to_hexwkb(lwgeom, variant | WKB_EXTENDED, &hexwkb_size);
-	lwgeom_free(lwgeom);
+	hexwkb = gserialized_to_hexwkb(geom, variant | WKB_EXTENDED, &hexwkb_size);
 	
 	/* Prepare the PgSQL text return type */
 	text_size = hexwkb_size - 1 + VARHDRSZ;
@@ -339,15 +336,12 @@ PG_FUNCTION_INFO_V1(LWGEOM_to_text);
 Datum LWGEOM_to_text(PG_FUNCTION_ARGS)
 {
 	GSERIALIZED *geom = PG_GETARG_GSERIALIZED_P(0);
-	LWGEOM *lwgeom;
 	char *hexwkb;
 	size_t hexwkb_size;
 	text *result;
 
 	/* Generate WKB hex text */
-	lwgeom = lwgeom_from_gserialized(geom);
-	hexwkb = lwgeom_to_hexwkb(lwgeom, WKB_EXTENDED, &hexwkb_size);
-	lwgeom_free(lwgeom);
+	hexwkb = gserialized_to_hexwkb(geom, WKB_EXTENDED, &hexwkb_size);
 	
 	/* Copy into text obect */
 	result = cstring2text(hexwkb);
@@ -422,7 +416,6 @@ PG_FUNCTION_INFO_V1(WKBFromLWGEOM);
 Datum WKBFromLWGEOM(PG_FUNCTION_ARGS)
 {
 	GSERIALIZED *geom = PG_GETARG_GSERIALIZED_P(0);
-	LWGEOM *lwgeom;
 	uint8_t *wkb;
 	size_t wkb_size;
 	uint8_t variant = 0;
@@ -444,11 +437,8 @@ Datum WKBFromLWGEOM(PG_FUNCTION_ARGS)
 		}
 	}
 	wkb_size= VARSIZE(geom) - VARHDRSZ;
-	/* Create WKB hex string */
-	lwgeom = lwgeom_from_gserialized(geom);
-
-	wkb = lwgeom_to_wkb(lwgeom, variant | WKB_EXTENDED , &wkb_size);
-	lwgeom_free(lwgeom);
+	/* Create WKB string */
+	wkb = gserialized_to_wkb(geom, variant | WKB_EXTENDED , &wkb_size);
 	
 	/* Prepare the PgSQL text return type */
 	result = palloc(wkb_size + VARHDRSZ);
@@ -684,6 +674,114 @@ Datum TWKBFromLWGEOMArray(PG_FUNCTION_ARGS)
 }
 
 
+/**
+* Add a geometry and its id to a TWKB collection. Rows are encoded as
+* they arrive, the aggregate state only holds the TWKB bytes.
+*/
+PG_FUNCTION_INFO_V1(pgis_astwkb_transfn);
+Datum pgis_astwkb_transfn(PG_FUNCTION_ARGS)
+{
+	MemoryContext aggcontext;
+	MemoryContext oldcontext;
+	TWKB_BATCH *batch = NULL;
+	GSERIALIZED *geom;
+	LWGEOM *lwgeom;
+
+	if ( ! AggCheckCallContext(fcinfo, &aggcontext) )
+	{
+		/* cannot be called directly because of internal-type argument */
+		elog(ERROR, "%s called in non-aggregate context", __func__);
+		aggcontext = NULL;  /* keep compiler quiet */
+	}
+
+	if ( ! PG_ARGISNULL(0) )
+		batch = (TWKB_BATCH *) PG_GETARG_POINTER(0);
+
+	/* Rows without a geometry or an id are skipped */
+	if ( PG_ARGISNULL(1) || PG_ARGISNULL(2) )
+	{
+		if ( ! batch )
+			PG_RETURN_NULL();
+		PG_RETURN_POINTER(batch);
+	}
+
+	geom = PG_GETARG_GSERIALIZED_P(1);
+
+	/* Options are read from the first row */
+	if ( ! batch )
+	{
+		srs_precision sp;
+		uint8_t variant = 0;
+
+		/* Read sensible precision defaults (about one meter) given the srs */
+		sp = srid_axis_precision(fcinfo, gserialized_get_srid(geom), TWKB_DEFAULT_PRECISION);
+
+		/* If user specified XY precision, use it */
+		if ( PG_NARGS() > 3 && ! PG_ARGISNULL(3) )
+			sp.precision_xy = PG_GETARG_INT32(3);
+
+		/* If user specified Z precision, use it */
+		if ( PG_NARGS() > 4 && ! PG_ARGISNULL(4) )
+			sp.precision_z = PG_GETARG_INT32(4);
+
+		/* If user specified M precision, use it */
+		if ( PG_NARGS() > 5 && ! PG_ARGISNULL(5) )
+			sp.precision_m = PG_GETARG_INT32(5);
+
+		/* If user wants registered twkb sizes */
+		if ( PG_NARGS() > 6 && ! PG_ARGISNULL(6) && PG_GETARG_BOOL(6) )
+			variant |= TWKB_SIZE;
+
+		/* If user wants bounding boxes */
+		if ( PG_NARGS() > 7 && ! PG_ARGISNULL(7) && PG_GETARG_BOOL(7) )
+			variant |= TWKB_BBOX;
+
+		oldcontext = MemoryContextSwitchTo(aggcontext);
+		batch = twkb_batch_create(variant, sp.precision_xy, sp.precision_z, sp.precision_m);
+		MemoryContextSwitchTo(oldcontext);
+	}
+
+	lwgeom = lwgeom_from_gserialized(geom);
+
+	/* the batch buffers grow by repalloc, they stay in aggcontext */
+	oldcontext = MemoryContextSwitchTo(aggcontext);
+	twkb_batch_add(batch, lwgeom, PG_GETARG_INT64(2));
+	MemoryContextSwitchTo(oldcontext);
+
+	lwgeom_free(lwgeom);
+	PG_FREE_IF_COPY(geom, 1);
+
+	PG_RETURN_POINTER(batch);
+}
+
+/**
+* Write out the TWKB collection
+*/
+PG_FUNCTION_INFO_V1(pgis_astwkb_finalfn);
+Datum pgis_astwkb_finalfn(PG_FUNCTION_ARGS)
+{
+	TWKB_BATCH *batch;
+	uint8_t *twkb;
+	size_t twkb_size;
+	bytea *result;
+
+	/* No row had both a geometry and an id */
+	if ( PG_ARGISNULL(0) )
+		PG_RETURN_NULL();
+
+	batch = (TWKB_BATCH *) PG_GETARG_POINTER(0);
+	twkb = twkb_batch_to_twkb(batch, &twkb_size);
+
+	/* Convert to a bytea return type */
+	result = palloc(twkb_size + VARHDRSZ);
+	memcpy(VARDATA(result), twkb, twkb_size);
+	SET_VARSIZE(result, twkb_size + VARHDRSZ);
+	pfree(twkb);
+
+	PG_RETURN_BYTEA_P(result);
+}
+
+
 /* puts a bbox inside the geometry */
 PG_FUNCTION_INFO_V1(LWGEOM_addBBOX);
 Datum LWGEOM_addBBOX(PG_FUNCTION_ARGS)
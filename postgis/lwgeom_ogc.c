@@ -886,15 +886,12 @@ PG_FUNCTION_INFO_V1(LWGEOM_asBinary);
 Datum LWGEOM_asBinary(PG_FUNCTION_ARGS)
 {
 	GSERIALIZED *geom;
-	LWGEOM *lwgeom;
 	uint8_t *wkb;
 	size_t wkb_size;
 	bytea *result;
 	uint8_t variant = WKB_ISO;
 
-	/* Get a 2D version of the geometry */
 	geom = PG_GETARG_GSERIALIZED_P(0);
-	lwgeom = lwgeom_from_gserialized(geom);
 
 	/* If user specified endianness, respect it */
 	if ( (PG_NARGS()>1) && (!PG_ARGISNULL(1)) )
@@ -912,9 +909,8 @@ Datum LWGEOM_asBinary(PG_FUNCTION_ARGS)
 		}
 	}
 	
-	/* Write to WKB and free the geometry */
-	wkb = lwgeom_to_wkb(lwgeom, variant, &wkb_size);
-	lwgeom_free(lwgeom);
+	/* Write to WKB straight from the serialized form */
+	wkb = gserialized_to_wkb(geom, variant, &wkb_size);
 
 	/* Write to text and free the WKT */
 	result = palloc(wkb_size + VARHDRSZ);
@@ -0,0 +1,239 @@
+/**********************************************************************
+ *
+ * PostGIS - Spatial Types for PostgreSQL
+ * http://postgis.net
+ *
+ * PostGIS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * PostGIS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with PostGIS.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ **********************************************************************/
+
+
+/**
+* Mapbox Vector Tile aggregate: every row adds one feature to a layer
+* kept in the aggregate memory context, the final function encodes
+* the layer as a tile.
+*/
+
+#include "postgres.h"
+#include "fmgr.h"
+#include "funcapi.h"
+#include "access/htup.h"
+#include "catalog/pg_type.h"
+#include "utils/lsyscache.h"
+#include "utils/typcache.h"
+
+#include "../postgis_config.h"
+
+#if POSTGIS_PGSQL_VERSION >= 93
+#include "access/htup_details.h"
+#endif
+
+#include "liblwgeom.h"
+#include "lwgeom_pg.h"
+
+#define MVT_DEFAULT_EXTENT 4096
+#define MVT_DEFAULT_BUFFER 256
+
+Datum pgis_asmvt_transfn(PG_FUNCTION_ARGS);
+Datum pgis_asmvt_finalfn(PG_FUNCTION_ARGS);
+
+
+/**
+* Add the columns of a properties record as tags of the current feature.
+* NULL values are skipped, numbers and booleans keep their type,
+* anything else is written with its text output function.
+*/
+static void
+mvt_layer_add_properties(MVT_LAYER *layer, HeapTupleHeader rec)
+{
+	TupleDesc tupdesc;
+	HeapTupleData tuple;
+	int i;
+
+	tupdesc = lookup_rowtype_tupdesc(HeapTupleHeaderGetTypeId(rec),
+	                                 HeapTupleHeaderGetTypMod(rec));
+
+	tuple.t_len = HeapTupleHeaderGetDatumLength(rec);
+	ItemPointerSetInvalid(&(tuple.t_self));
+	tuple.t_tableOid = InvalidOid;
+	tuple.t_data = rec;
+
+	for ( i = 0; i < tupdesc->natts; i++ )
+	{
+		Form_pg_attribute att = tupdesc->attrs[i];
+		uint32_t key;
+		bool isnull;
+		Datum value;
+
+		if ( att->attisdropped )
+			continue;
+
+		value = heap_getattr(&tuple, i + 1, tupdesc, &isnull);
+		if ( isnull )
+			continue;
+
+		key = mvt_layer_key(layer, NameStr(att->attname));
+
+		switch ( att->atttypid )
+		{
+			case BOOLOID:
+				mvt_layer_feature_bool(layer, key, DatumGetBool(value));
+				break;
+			case INT2OID:
+				mvt_layer_feature_int(layer, key, DatumGetInt16(value));
+				break;
+			case INT4OID:
+				mvt_layer_feature_int(layer, key, DatumGetInt32(value));
+				break;
+			case INT8OID:
+				mvt_layer_feature_int(layer, key, DatumGetInt64(value));
+				break;
+			case FLOAT4OID:
+				mvt_layer_feature_double(layer, key, DatumGetFloat4(value));
+				break;
+			case FLOAT8OID:
+				mvt_layer_feature_double(layer, key, DatumGetFloat8(value));
+				break;
+			case TEXTOID:
+			case VARCHAROID:
+			{
+				text *txt = DatumGetTextPP(value);
+				mvt_layer_feature_string(layer, key, VARDATA_ANY(txt), VARSIZE_ANY_EXHDR(txt));
+				if ( (Pointer) txt != DatumGetPointer(value) )
+					pfree(txt);
+				break;
+			}
+			default:
+			{
+				Oid typoutput;
+				bool typisvarlena;
+				char *str;
+
+				getTypeOutputInfo(att->atttypid, &typoutput, &typisvarlena);
+				str = OidOutputFunctionCall(typoutput, value);
+				mvt_layer_feature_string(layer, key, str, strlen(str));
+				pfree(str);
+				break;
+			}
+		}
+	}
+
+	ReleaseTupleDesc(tupdesc);
+}
+
+/**
+* Add a feature built from a geometry and a properties record
+* to a Mapbox Vector Tile layer
+*/
+PG_FUNCTION_INFO_V1(pgis_asmvt_transfn);
+Datum pgis_asmvt_transfn(PG_FUNCTION_ARGS)
+{
+	MemoryContext aggcontext;
+	MemoryContext oldcontext;
+	MVT_LAYER *layer;
+	GSERIALIZED *geom;
+	LWGEOM *lwgeom;
+	HeapTupleHeader rec;
+
+	if ( ! AggCheckCallContext(fcinfo, &aggcontext) )
+	{
+		/* cannot be called directly because of internal-type argument */
+		elog(ERROR, "%s called in non-aggregate context", __func__);
+		aggcontext = NULL;  /* keep compiler quiet */
+	}
+
+	if ( PG_ARGISNULL(0) )
+	{
+		char *name = "default";
+		GBOX *bounds;
+		int32 extent = MVT_DEFAULT_EXTENT;
+		int32 buffer = MVT_DEFAULT_BUFFER;
+
+		if ( ! type_is_rowtype(get_fn_expr_argtype(fcinfo->flinfo, 2)) )
+			elog(ERROR, "%s: properties must be a record", __func__);
+
+		if ( PG_ARGISNULL(4) )
+			elog(ERROR, "%s: tile bounds cannot be null", __func__);
+		bounds = (GBOX *) PG_GETARG_POINTER(4);
+
+		if ( ! PG_ARGISNULL(3) )
+			name = text2cstring(PG_GETARG_TEXT_P(3));
+
+		if ( PG_NARGS() > 5 && ! PG_ARGISNULL(5) )
+			extent = PG_GETARG_INT32(5);
+		if ( PG_NARGS() > 6 && ! PG_ARGISNULL(6) )
+			buffer = PG_GETARG_INT32(6);
+
+		if ( extent <= 0 )
+			elog(ERROR, "%s: extent must be positive", __func__);
+		if ( buffer < 0 )
+			elog(ERROR, "%s: buffer cannot be negative", __func__);
+
+		/* the layer grows by repalloc, it stays in aggcontext */
+		oldcontext = MemoryContextSwitchTo(aggcontext);
+		layer = mvt_layer_create(name, bounds, extent, buffer, LW_TRUE);
+		MemoryContextSwitchTo(oldcontext);
+	}
+	else
+	{
+		layer = (MVT_LAYER *) PG_GETARG_POINTER(0);
+	}
+
+	/* NULL geometries make no feature */
+	if ( PG_ARGISNULL(1) )
+		PG_RETURN_POINTER(layer);
+
+	geom = PG_GETARG_GSERIALIZED_P(1);
+	lwgeom = lwgeom_from_gserialized(geom);
+	rec = PG_ARGISNULL(2) ? NULL : PG_GETARG_HEAPTUPLEHEADER(2);
+
+	oldcontext = MemoryContextSwitchTo(aggcontext);
+	if ( mvt_layer_feature_begin(layer, lwgeom) == LW_SUCCESS )
+	{
+		if ( rec )
+			mvt_layer_add_properties(layer, rec);
+		mvt_layer_feature_end(layer);
+	}
+	MemoryContextSwitchTo(oldcontext);
+
+	lwgeom_free(lwgeom);
+	PG_FREE_IF_COPY(geom, 1);
+
+	PG_RETURN_POINTER(layer);
+}
+
+/**
+* Encode the layer as a Mapbox Vector Tile
+*/
+PG_FUNCTION_INFO_V1(pgis_asmvt_finalfn);
+Datum pgis_asmvt_finalfn(PG_FUNCTION_ARGS)
+{
+	MVT_LAYER *layer;
+	uint8_t *tile;
+	size_t tile_size;
+	bytea *result;
+
+	if ( PG_ARGISNULL(0) )
+		PG_RETURN_NULL();
+
+	layer = (MVT_LAYER *) PG_GETARG_POINTER(0);
+	tile = mvt_layer_to_tile(layer, &tile_size);
+
+	result = palloc(tile_size + VARHDRSZ);
+	SET_VARSIZE(result, tile_size + VARHDRSZ);
+	memcpy(VARDATA(result), tile, tile_size);
+	lwfree(tile);
+
+	PG_RETURN_BYTEA_P(result);
+}
@@ -29,6 +29,10 @@
 #include "gdal_vrt.h"
 #include "ogr_srs_api.h"
 #include <assert.h>
+#ifndef _WIN32
+#include <unistd.h> /* for fork, dup2 */
+#include <sys/wait.h> /* for waitpid */
+#endif
 
 static void
 loader_rt_error_handler(const char *fmt, va_list ap) {
@@ -386,7 +390,13 @@ usage() {
 		"  -l <overview factor> Create overview of the raster. For more than\n"
 		"      one factor, separate with comma(,). Overview table name follows\n"
 		"      the pattern o_<overview factor>_<table>. Created overview is\n"
-		"      stored in the database and is not affected by -R.\n"
+		"      stored in the database and is not affected by -R. Overviews\n"
+		"      are resampled from the rows of the raster read for its tiles.\n"
+	));
+	printf(_(
+		"  -L <resampling> Resampling of overviews. Use near for nearest\n"
+		"      neighbor (default) or average for the average of the pixels\n"
+		"      that are not NODATA.\n"
 	));
 	printf(_(
 		"  -q  Wrap PostgreSQL identifiers in quotes.\n"
@@ -439,6 +449,19 @@ usage() {
 	printf(_(
 		"  -Y  Use COPY statements instead of INSERT statements.\n"
 	));
+	printf(_(
+		"  -B <file> Write the rows in binary COPY format to <file> and load\n"
+		"      them with a \\copy command in the output. Use - to write only\n"
+		"      the binary rows to stdout for COPY ... FROM STDIN (FORMAT\n"
+		"      binary), which requires -a. Cannot be used with -Y or -l.\n"
+	));
+	printf(_(
+		"  -j <jobs> Convert up to <jobs> rasters at once in separate\n"
+		"      processes, and resample the overviews of -l in up to <jobs>\n"
+		"      processes while the raster is read for its tiles. Rows of\n"
+		"      each table are output in the same order as when using one\n"
+		"      process. Defaults to 1.\n"
+	));
 	printf(_(
 		"  -G  Print the supported GDAL raster formats.\n"
 	));
@@ -722,6 +745,10 @@ init_config(RTLOADERCFG *config) {
 	config->version = 0;
 	config->transaction = 1;
 	config->copy_statements = 0;
+	config->overview_resample = 0;
+	config->copy_binary = NULL;
+	config->copy_out = NULL;
+	config->jobs = 1;
 }
 
 static void
@@ -760,6 +787,10 @@ rtdealloc_config(RTLOADERCFG *config) {
 		rtdealloc(config->tablespace);
 	if (config->idx_tablespace != NULL)
 		rtdealloc(config->idx_tablespace);
+	if (config->copy_binary != NULL)
+		rtdealloc(config->copy_binary);
+	if (config->copy_out != NULL && config->copy_out != stdout)
+		fclose(config->copy_out);
 
 	rtdealloc(config);
 }
@@ -873,6 +904,114 @@ copy_from_end(STRINGBUFFER *buffer)
 	return 1;
 }
 
+/* integers of binary COPY are in network byte order */
+static int
+copy_binary_int16(FILE *out, int16_t val) {
+	uint16_t v = (uint16_t) val;
+
+	if (fputc((v >> 8) & 0xFF, out) == EOF || fputc(v & 0xFF, out) == EOF)
+		return 0;
+	return 1;
+}
+
+static int
+copy_binary_int32(FILE *out, int32_t val) {
+	uint32_t v = (uint32_t) val;
+	int i = 0;
+
+	for (i = 24; i >= 0; i -= 8) {
+		if (fputc((v >> i) & 0xFF, out) == EOF)
+			return 0;
+	}
+	return 1;
+}
+
+static int
+copy_binary_header(FILE *out) {
+	/* signature, flags and header extension length */
+	if (fwrite("PGCOPY\n\377\r\n\0", 1, 11, out) != 11)
+		return 0;
+
+	return copy_binary_int32(out, 0) && copy_binary_int32(out, 0);
+}
+
+static int
+copy_binary_trailer(FILE *out) {
+	return copy_binary_int16(out, -1);
+}
+
+/* write one tuple of the raster's WKB, its binary send format, and optional filename */
+static int
+copy_binary_row(FILE *out, const uint8_t *wkb, uint32_t wkblen, const char *filename) {
+	uint32_t len = 0;
+
+	if (
+		!copy_binary_int16(out, (filename != NULL ? 2 : 1)) ||
+		!copy_binary_int32(out, wkblen) ||
+		fwrite(wkb, 1, wkblen, out) != wkblen
+	) {
+		rterror(_("copy_binary_row: Could not write binary COPY row"));
+		return 0;
+	}
+
+	if (filename != NULL) {
+		len = strlen(filename);
+		if (!copy_binary_int32(out, len) || fwrite(filename, 1, len, out) != len) {
+			rterror(_("copy_binary_row: Could not write binary COPY row"));
+			return 0;
+		}
+	}
+
+	return 1;
+}
+
+static int
+copy_binary_from(const char *schema, const char *table, const char *column,
+                 const char *file_column_name, const char *copy_binary,
+                 STRINGBUFFER *buffer)
+{
+	char *fn = NULL;
+	char *sql = NULL;
+	uint32_t len = 0;
+
+	assert(table != NULL);
+	assert(column != NULL);
+	assert(copy_binary != NULL);
+
+	/* escape single-quotes in filename of COPY data */
+	fn = strreplace(copy_binary, "'", "''", NULL);
+
+	len = strlen("\\copy  () FROM '' WITH (FORMAT binary)") + 1;
+	if (schema != NULL)
+		len += strlen(schema);
+	len += strlen(table);
+	len += strlen(column);
+	if (file_column_name != NULL)
+		len += strlen(",") + strlen(file_column_name);
+	len += strlen(fn);
+
+	sql = rtalloc(sizeof(char) * len);
+	if (sql == NULL) {
+		rterror(_("copy_binary_from: Could not allocate memory for \\copy command"));
+		rtdealloc(fn);
+		return 0;
+	}
+	sprintf(sql, "\\copy %s%s (%s%s%s) FROM '%s' WITH (FORMAT binary)",
+		(schema != NULL ? schema : ""),
+		table,
+		column,
+		(file_column_name != NULL ? "," : ""),
+		(file_column_name != NULL ? file_column_name : ""),
+		fn
+	);
+	rtdealloc(fn);
+
+	append_sql_to_buffer(buffer, sql);
+	sql = NULL;
+
+	return 1;
+}
+
 static int
 insert_records(
 	const char *schema, const char *table, const char *column,
@@ -1346,275 +1485,881 @@ add_overview_constraints(
 	return 1;
 }
 
-static int
-build_overview(int idx, RTLOADERCFG *config, RASTERINFO *info, int ovx, STRINGBUFFER *tileset, STRINGBUFFER *buffer) {
-	GDALDatasetH hdsSrc;
-	VRTDatasetH hdsOv;
-	VRTSourcedRasterBandH hbandOv;
-	double gtOv[6] = {0.};
-	int dimOv[2] = {0};
-
-	int j = 0;
-	int factor;
-	const char *ovtable = NULL;
-
-	VRTDatasetH hdsDst;
-	VRTSourcedRasterBandH hbandDst;
-	int tile_size[2] = {0};
-	int _tile_size[2] = {0};
-	int ntiles[2] = {1, 1};
-	int xtile = 0;
-	int ytile = 0;
+/*
+	dataset of the rows y0 to y0 + nrows of the bands to load of the
+	source raster. with read, the rows are read into a MEM dataset so
+	that the tiles and the overviews are made from one read of the
+	source. otherwise, the dataset is a VRT of the source
+*/
+static GDALDatasetH
+source_rows(GDALDatasetH hdsSrc, RASTERINFO *info, int y0, int nrows, int read) {
+	GDALDriverH drv = NULL;
+	GDALDatasetH hdsRows = NULL;
+	GDALRasterBandH hbandRows = NULL;
 	double gt[6] = {0.};
+	uint8_t *pixels = NULL;
+	int j = 0;
 
-	rt_raster rast = NULL;
-	char *hex;
-	uint32_t hexlen = 0;
+	memcpy(gt, info->gt, sizeof(double) * 6);
+	GDALApplyGeoTransform(info->gt, 0, y0, &(gt[0]), &(gt[3]));
 
-	hdsSrc = GDALOpenShared(config->rt_file[idx], GA_ReadOnly);
-	if (hdsSrc == NULL) {
-		rterror(_("build_overview: Could not open raster: %s"), config->rt_file[idx]);
-		return 0;
+	if (read) {
+		drv = GDALGetDriverByName("MEM");
+		if (drv == NULL) {
+			rterror(_("source_rows: Could not load the MEM GDAL driver"));
+			return NULL;
+		}
+		hdsRows = GDALCreate(drv, "", info->dim[0], nrows, 0, GDT_Byte, NULL);
+	}
+	else
+		hdsRows = VRTCreate(info->dim[0], nrows);
+	if (hdsRows == NULL) {
+		rterror(_("source_rows: Could not create dataset of rows"));
+		return NULL;
 	}
 
-	/* working copy of geotransform matrix */
-	memcpy(gtOv, info->gt, sizeof(double) * 6);
+	if (info->srs != NULL)
+		GDALSetProjection(hdsRows, info->srs);
+	GDALSetGeoTransform(hdsRows, gt);
 
-	if (ovx >= config->overview_count) {
-		rterror(_("build_overview: Invalid overview index: %d"), ovx);
-		return 0;
-	}
-	factor = config->overview[ovx];
-	ovtable = (const char *) config->overview_table[ovx];
+	for (j = 0; j < info->nband_count; j++) {
+		if (GDALAddBand(hdsRows, info->gdalbandtype[j], NULL) != CE_None) {
+			rterror(_("source_rows: Could not add band to dataset of rows"));
+			GDALClose(hdsRows);
+			return NULL;
+		}
+		hbandRows = GDALGetRasterBand(hdsRows, j + 1);
 
-	/* factor must be within valid range */
-	if (factor < MINOVFACTOR || factor > MAXOVFACTOR) {
-		rterror(_("build_overview: Overview factor %d is not between %d and %d"), factor, MINOVFACTOR, MAXOVFACTOR);
-		return 0;
-	}
+		if (info->hasnodata[j])
+			GDALSetRasterNoDataValue(hbandRows, info->nodataval[j]);
+
+		if (!read) {
+			VRTAddSimpleSource(
+				(VRTSourcedRasterBandH) hbandRows, GDALGetRasterBand(hdsSrc, info->nband[j]),
+				0, y0,
+				info->dim[0], nrows,
+				0, 0,
+				info->dim[0], nrows,
+				"near", VRT_NODATA_UNSET
+			);
+			continue;
+		}
 
-	dimOv[0] = (int) (info->dim[0] + (factor / 2)) / factor;
-	dimOv[1] = (int) (info->dim[1] + (factor / 2)) / factor;
+		pixels = rtalloc(info->dim[0] * nrows * (GDALGetDataTypeSize(info->gdalbandtype[j]) / 8));
+		if (pixels == NULL) {
+			rterror(_("source_rows: Could not allocate memory for rows of raster"));
+			GDALClose(hdsRows);
+			return NULL;
+		}
 
-	/* create VRT dataset */
-	hdsOv = VRTCreate(dimOv[0], dimOv[1]);
-	/*
-	GDALSetDescription(hdsOv, "/tmp/ov.vrt");
-	*/
-	GDALSetProjection(hdsOv, info->srs);
+		if (
+			GDALRasterIO(
+				GDALGetRasterBand(hdsSrc, info->nband[j]), GF_Read,
+				0, y0, info->dim[0], nrows,
+				pixels, info->dim[0], nrows,
+				info->gdalbandtype[j], 0, 0
+			) != CE_None ||
+			GDALRasterIO(
+				hbandRows, GF_Write,
+				0, 0, info->dim[0], nrows,
+				pixels, info->dim[0], nrows,
+				info->gdalbandtype[j], 0, 0
+			) != CE_None
+		) {
+			rterror(_("source_rows: Could not read rows of raster"));
+			rtdealloc(pixels);
+			GDALClose(hdsRows);
+			return NULL;
+		}
+		rtdealloc(pixels);
+	}
 
-	/* adjust scale */
-	gtOv[1] *= factor;
-	gtOv[5] *= factor;
+	if (!read)
+		VRTFlushCache(hdsRows);
 
-	GDALSetGeoTransform(hdsOv, gtOv);
+	return hdsRows;
+}
 
-	/* add bands as simple sources */
-	for (j = 0; j < info->nband_count; j++) {
-		GDALAddBand(hdsOv, info->gdalbandtype[j], NULL);
-		hbandOv = (VRTSourcedRasterBandH) GDALGetRasterBand(hdsOv, j + 1);
+/*
+	add a tile to the tileset as hex-encoded WKB. with binary COPY
+	output, the tile's WKB is written as a row instead
+*/
+static int
+append_tile(int idx, RTLOADERCFG *config, rt_raster rast, STRINGBUFFER *tileset) {
+	uint8_t *wkb = NULL;
+	uint32_t wkblen = 0;
+	char *hex = NULL;
+	uint32_t hexlen = 0;
+	int rtn = 1;
 
-		if (info->hasnodata[j])
-			GDALSetRasterNoDataValue(hbandOv, info->nodataval[j]);
+	if (config->copy_out != NULL) {
+		wkb = rt_raster_to_wkb(rast, FALSE, &wkblen);
+		if (wkb == NULL) {
+			rterror(_("append_tile: Could not convert PostGIS raster to WKB"));
+			return 0;
+		}
 
-		VRTAddSimpleSource(
-			hbandOv, GDALGetRasterBand(hdsSrc, info->nband[j]),
-			0, 0,
-			info->dim[0], info->dim[1],
-			0, 0,
-			dimOv[0], dimOv[1],
-			"near", VRT_NODATA_UNSET
+		rtn = copy_binary_row(
+			config->copy_out, wkb, wkblen,
+			(config->file_column ? config->rt_filename[idx] : NULL)
 		);
+		rtdealloc(wkb);
+
+		return rtn;
 	}
 
-	/* make sure VRT reflects all changes */
-	VRTFlushCache(hdsOv);
+	hex = rt_raster_to_hexwkb(rast, FALSE, &hexlen);
+	if (hex == NULL) {
+		rterror(_("append_tile: Could not convert PostGIS raster to hex WKB"));
+		return 0;
+	}
 
-	/* decide on tile size */
-	if (!config->tile_size[0])
-		tile_size[0] = dimOv[0];
-	else
-		tile_size[0] = config->tile_size[0];
-	if (!config->tile_size[1])
-		tile_size[1] = dimOv[1];
-	else
-		tile_size[1] = config->tile_size[1];
+	append_stringbuffer(tileset, hex);
+
+	return 1;
+}
+
+/*
+	tile one row of tiles of a raster or overview of dimensions dim and
+	geotransform gt. hdsRows has the rows of the row of tiles ytile
+*/
+static int
+tile_rows(
+	int idx, RTLOADERCFG *config, RASTERINFO *info,
+	const char *table, GDALDatasetH hdsRows,
+	int *dim, double *gtRaster, int *tile_size, int ytile,
+	int check_nodata,
+	STRINGBUFFER *tileset, STRINGBUFFER *buffer
+) {
+	VRTDatasetH hdsDst;
+	VRTSourcedRasterBandH hbandDst;
+	int ntiles[2] = {1, 1};
+	int _tile_size[2] = {0, 0};
+	int xtile = 0;
+	double gt[6] = {0.};
+	int i = 0;
+
+	rt_raster rast = NULL;
+	int numbands = 0;
+	rt_band band = NULL;
 
 	/* number of tiles */
-	if (
-		tile_size[0] != dimOv[0] &&
-		tile_size[1] != dimOv[1]
-	) {
-		ntiles[0] = (dimOv[0] + tile_size[0] -  1) / tile_size[0];
-		ntiles[1] = (dimOv[1] + tile_size[1]  - 1) / tile_size[1];
-	}
+	if (tile_size[0] != dim[0])
+		ntiles[0] = (dim[0] + tile_size[0]  - 1) / tile_size[0];
+	if (tile_size[1] != dim[1])
+		ntiles[1] = (dim[1] + tile_size[1]  - 1) / tile_size[1];
 
 	/* working copy of geotransform matrix */
-	memcpy(gt, gtOv, sizeof(double) * 6);
+	memcpy(gt, gtRaster, sizeof(double) * 6);
+
+	/* edge y tile */
+	if (!config->pad_tile && ntiles[1] > 1 && (ytile + 1) == ntiles[1])
+		_tile_size[1] = dim[1] - (ytile * tile_size[1]);
+	else
+		_tile_size[1] = tile_size[1];
 
-	/* tile overview */
 	/* each tile is a VRT with constraints set for just the data required for the tile */
-	for (ytile = 0; ytile < ntiles[1]; ytile++) {
+	for (xtile = 0; xtile < ntiles[0]; xtile++) {
 
-		/* edge y tile */
-		if (!config->pad_tile && ntiles[1] > 1 && (ytile + 1) == ntiles[1])
-			_tile_size[1] = dimOv[1] - (ytile * tile_size[1]);
+		/* edge x tile */
+		if (!config->pad_tile && ntiles[0] > 1 && (xtile + 1) == ntiles[0])
+			_tile_size[0] = dim[0] - (xtile * tile_size[0]);
 		else
-			_tile_size[1] = tile_size[1];
+			_tile_size[0] = tile_size[0];
 
-		for (xtile = 0; xtile < ntiles[0]; xtile++) {
-			/*
-			char fn[100];
-			sprintf(fn, "/tmp/ovtile%d.vrt", (ytile * ntiles[0]) + xtile);
-			*/
-
-			/* edge x tile */
-			if (!config->pad_tile && ntiles[0] > 1 && (xtile + 1) == ntiles[0])
-				_tile_size[0] = dimOv[0] - (xtile * tile_size[0]);
-			else
-				_tile_size[0] = tile_size[0];
+		/* compute tile's upper-left corner */
+		GDALApplyGeoTransform(
+			gtRaster,
+			xtile * tile_size[0], ytile * tile_size[1],
+			&(gt[0]), &(gt[3])
+		);
 
-			/* compute tile's upper-left corner */
-			GDALApplyGeoTransform(
-				gtOv,
-				xtile * tile_size[0], ytile * tile_size[1],
-				&(gt[0]), &(gt[3])
+		/* create VRT dataset */
+		hdsDst = VRTCreate(_tile_size[0], _tile_size[1]);
+		GDALSetProjection(hdsDst, info->srs);
+		GDALSetGeoTransform(hdsDst, gt);
+
+		/* add bands as simple sources */
+		for (i = 0; i < info->nband_count; i++) {
+			GDALAddBand(hdsDst, info->gdalbandtype[i], NULL);
+			hbandDst = (VRTSourcedRasterBandH) GDALGetRasterBand(hdsDst, i + 1);
+
+			if (info->hasnodata[i])
+				GDALSetRasterNoDataValue(hbandDst, info->nodataval[i]);
+
+			VRTAddSimpleSource(
+				hbandDst, GDALGetRasterBand(hdsRows, i + 1),
+				xtile * tile_size[0], 0,
+				_tile_size[0], _tile_size[1],
+				0, 0,
+				_tile_size[0], _tile_size[1],
+				"near", VRT_NODATA_UNSET
 			);
+		}
 
-			/* create VRT dataset */
-			hdsDst = VRTCreate(_tile_size[0], _tile_size[1]);
-			/*
-			GDALSetDescription(hdsDst, fn);
-			*/
-			GDALSetProjection(hdsDst, info->srs);
-			GDALSetGeoTransform(hdsDst, gt);
+		/* make sure VRT reflects all changes */
+		VRTFlushCache(hdsDst);
 
-			/* add bands as simple sources */
-			for (j = 0; j < info->nband_count; j++) {
-				GDALAddBand(hdsDst, info->gdalbandtype[j], NULL);
-				hbandDst = (VRTSourcedRasterBandH) GDALGetRasterBand(hdsDst, j + 1);
-
-				if (info->hasnodata[j])
-					GDALSetRasterNoDataValue(hbandDst, info->nodataval[j]);
-
-				VRTAddSimpleSource(
-					hbandDst, GDALGetRasterBand(hdsOv, j + 1),
-					xtile * tile_size[0], ytile * tile_size[1],
-					_tile_size[0], _tile_size[1],
-					0, 0,
-					_tile_size[0], _tile_size[1],
-					"near", VRT_NODATA_UNSET
-				);
-			}
+		/* convert VRT dataset to rt_raster */
+		rast = rt_raster_from_gdal_dataset(hdsDst);
+		if (rast == NULL) {
+			rterror(_("tile_rows: Could not convert VRT dataset to PostGIS raster"));
+			GDALClose(hdsDst);
+			return 0;
+		}
 
-			/* make sure VRT reflects all changes */
-			VRTFlushCache(hdsDst);
+		/* set srid if provided */
+		rt_raster_set_srid(rast, info->srid);
 
-			/* convert VRT dataset to rt_raster */
-			rast = rt_raster_from_gdal_dataset(hdsDst);
-			if (rast == NULL) {
-				rterror(_("build_overview: Could not convert VRT dataset to PostGIS raster"));
-				GDALClose(hdsDst);
-				return 0;
+		/* inspect each band of raster where band is NODATA */
+		if (check_nodata) {
+			numbands = rt_raster_get_num_bands(rast);
+			for (i = 0; i < numbands; i++) {
+				band = rt_raster_get_band(rast, i);
+				if (band != NULL)
+					rt_band_check_is_nodata(band);
 			}
+		}
 
-			/* set srid if provided */
-			rt_raster_set_srid(rast, info->srid);
-
-			/* convert rt_raster to hexwkb */
-			hex = rt_raster_to_hexwkb(rast, FALSE, &hexlen);
+		/* add tile to tileset */
+		if (!append_tile(idx, config, rast, tileset)) {
+			rterror(_("tile_rows: Could not add PostGIS raster to tileset"));
 			raster_destroy(rast);
+			GDALClose(hdsDst);
+			return 0;
+		}
+		raster_destroy(rast);
 
-			if (hex == NULL) {
-				rterror(_("build_overview: Could not convert PostGIS raster to hex WKB"));
-				GDALClose(hdsDst);
+		GDALClose(hdsDst);
+
+		/* flush if tileset gets too big */
+		if (tileset->length > 10) {
+			if (!insert_records(
+				config->schema, table, config->raster_column,
+				(config->file_column ? config->rt_filename[idx] : NULL), config->file_column_name,
+				config->copy_statements, config->out_srid,
+				tileset, buffer
+			)) {
+				rterror(_("tile_rows: Could not convert raster tiles into INSERT or COPY statements"));
 				return 0;
 			}
 
-			/* add hexwkb to tileset */
-			append_stringbuffer(tileset, hex);
+			rtdealloc_stringbuffer(tileset, 0);
+		}
+	}
 
-			GDALClose(hdsDst);
+	return 1;
+}
 
-			/* flush if tileset gets too big */
-			if (tileset->length > 10) {
-				if (!insert_records(
-					config->schema, ovtable, config->raster_column,
-					(config->file_column ? config->rt_filename[idx] : NULL), config->file_column_name,
-					config->copy_statements, config->out_srid,
-					tileset, buffer
-				)) {
-					rterror(_("build_overview: Could not convert raster tiles into INSERT or COPY statements"));
-					GDALClose(hdsSrc);
-					return 0;
-				}
+static void
+free_overviews(RTLOADERCFG *config, RASTERINFO *info, OVERVIEWLEVEL *levels) {
+	int i = 0;
+	int j = 0;
 
-				rtdealloc_stringbuffer(tileset, 0);
+	if (levels == NULL)
+		return;
+
+	for (i = 0; i < config->overview_count; i++) {
+		if (levels[i].sum != NULL) {
+			for (j = 0; j < info->nband_count; j++) {
+				if (levels[i].sum[j] != NULL)
+					rtdealloc(levels[i].sum[j]);
 			}
+			rtdealloc(levels[i].sum);
 		}
+		if (levels[i].count != NULL) {
+			for (j = 0; j < info->nband_count; j++) {
+				if (levels[i].count[j] != NULL)
+					rtdealloc(levels[i].count[j]);
+			}
+			rtdealloc(levels[i].count);
+		}
+		if (levels[i].values != NULL)
+			rtdealloc(levels[i].values);
+		if (levels[i].hdsRows != NULL)
+			GDALClose(levels[i].hdsRows);
+		rtdealloc_stringbuffer(&(levels[i].tileset), 0);
 	}
 
-	GDALClose(hdsOv);
-	GDALClose(hdsSrc);
-	return 1;
+	rtdealloc(levels);
 }
 
-static int
-convert_raster(int idx, RTLOADERCFG *config, RASTERINFO *info, STRINGBUFFER *tileset, STRINGBUFFER *buffer) {
-	GDALDatasetH hdsSrc;
-	GDALRasterBandH hbandSrc;
-	int nband = 0;
+/*
+	set up the overviews of all factors. the overviews are resampled
+	from the rows of the raster as they are read for its tiles
+*/
+static OVERVIEWLEVEL *
+init_overviews(RTLOADERCFG *config, RASTERINFO *info) {
+	OVERVIEWLEVEL *levels = NULL;
+	OVERVIEWLEVEL *level = NULL;
+	int factor = 0;
 	int i = 0;
-	int ntiles[2] = {1, 1};
-	int _tile_size[2] = {0, 0};
-	int xtile = 0;
-	int ytile = 0;
-	double gt[6] = {0.};
-	const char* pszProjectionRef = NULL;
-	int tilesize = 0;
-
-	rt_raster rast = NULL;
-	int numbands = 0;
-	rt_band band = NULL;
-	char *hex;
-	uint32_t hexlen = 0;
-
-	info->srid = config->srid;
+	int j = 0;
 
-	hdsSrc = GDALOpenShared(config->rt_file[idx], GA_ReadOnly);
-	if (hdsSrc == NULL) {
-		rterror(_("convert_raster: Could not open raster: %s"), config->rt_file[idx]);
-		return 0;
+	levels = rtalloc(sizeof(OVERVIEWLEVEL) * config->overview_count);
+	if (levels == NULL) {
+		rterror(_("init_overviews: Could not allocate memory for overviews"));
+		return NULL;
 	}
+	memset(levels, 0, sizeof(OVERVIEWLEVEL) * config->overview_count);
+	for (i = 0; i < config->overview_count; i++)
+		init_stringbuffer(&(levels[i].tileset));
 
-	nband = GDALGetRasterCount(hdsSrc);
-	if (!nband) {
-		rterror(_("convert_raster: No bands found in raster: %s"), config->rt_file[idx]);
-		GDALClose(hdsSrc);
-		return 0;
-	}
+	for (i = 0; i < config->overview_count; i++) {
+		level = &(levels[i]);
+		factor = config->overview[i];
 
-	/* check that bands specified are available */
-	for (i = 0; i < config->nband_count; i++) {
-		if (config->nband[i] > nband) {
-			rterror(_("convert_raster: Band %d not found in raster: %s"), config->nband[i], config->rt_file[idx]);
-			GDALClose(hdsSrc);
-			return 0;
+		level->ovx = i;
+		level->factor = factor;
+
+		level->dim[0] = (int) (info->dim[0] + (factor / 2)) / factor;
+		level->dim[1] = (int) (info->dim[1] + (factor / 2)) / factor;
+		if (level->dim[0] < 1 || level->dim[1] < 1) {
+			rterror(_("init_overviews: Overview factor %d is too large for raster"), factor);
+			free_overviews(config, info, levels);
+			return NULL;
 		}
-	}
 
-	/* record srs */
-	pszProjectionRef = GDALGetProjectionRef(hdsSrc);
-	if (pszProjectionRef != NULL && pszProjectionRef[0] != '\0') {
-		info->srs = rtalloc(sizeof(char) * (strlen(pszProjectionRef) + 1));
-		if (info->srs == NULL) {
-			rterror(_("convert_raster: Could not allocate memory for storing SRS"));
-			GDALClose(hdsSrc);
-			return 0;
+		/* adjust scale */
+		memcpy(level->gt, info->gt, sizeof(double) * 6);
+		level->gt[1] *= factor;
+		level->gt[5] *= factor;
+
+		/* decide on tile size */
+		if (!config->tile_size[0])
+			level->tile_size[0] = level->dim[0];
+		else
+			level->tile_size[0] = config->tile_size[0];
+		if (!config->tile_size[1])
+			level->tile_size[1] = level->dim[1];
+		else
+			level->tile_size[1] = config->tile_size[1];
+
+		level->sum = rtalloc(sizeof(double *) * info->nband_count);
+		level->count = rtalloc(sizeof(int *) * info->nband_count);
+		level->values = rtalloc(sizeof(double) * level->dim[0]);
+		if (level->sum == NULL || level->count == NULL || level->values == NULL) {
+			rterror(_("init_overviews: Could not allocate memory for resampling overview"));
+			free_overviews(config, info, levels);
+			return NULL;
 		}
-		strcpy(info->srs, pszProjectionRef);
+		memset(level->sum, 0, sizeof(double *) * info->nband_count);
+		memset(level->count, 0, sizeof(int *) * info->nband_count);
 
-		if (info->srid == SRID_UNKNOWN) {
+		for (j = 0; j < info->nband_count; j++) {
+			level->sum[j] = rtalloc(sizeof(double) * level->dim[0]);
+			level->count[j] = rtalloc(sizeof(int) * level->dim[0]);
+			if (level->sum[j] == NULL || level->count[j] == NULL) {
+				rterror(_("init_overviews: Could not allocate memory for resampling overview"));
+				free_overviews(config, info, levels);
+				return NULL;
+			}
+			memset(level->sum[j], 0, sizeof(double) * level->dim[0]);
+			memset(level->count[j], 0, sizeof(int) * level->dim[0]);
+		}
+	}
+
+	return levels;
+}
+
+/* last row of the raster that one row of an overview is resampled from */
+static int
+overview_last_row(RTLOADERCFG *config, RASTERINFO *info, OVERVIEWLEVEL *level, int y) {
+	int row = 0;
+
+	/* pixel at the center */
+	if (!config->overview_resample)
+		row = (y * level->factor) + (level->factor / 2);
+	else
+		row = ((y + 1) * level->factor) - 1;
+
+	/* last row may be partly outside of raster */
+	if (row >= (int) info->dim[1])
+		row = info->dim[1] - 1;
+
+	return row;
+}
+
+/*
+	write the resampled row of an overview to the rows of its row of
+	tiles, tiling them once the row of tiles is complete. each row of
+	tiles is released once its tiles are made
+*/
+static int
+finish_overview_row(int idx, RTLOADERCFG *config, RASTERINFO *info, OVERVIEWLEVEL *level, STRINGBUFFER *buffer) {
+	GDALDriverH drv = NULL;
+	double gt[6] = {0.};
+	int ytile = level->row / level->tile_size[1];
+	int y0 = ytile * level->tile_size[1];
+	int nrows = 0;
+	int x = 0;
+	int j = 0;
+
+	/* rows of the row of tiles */
+	if (level->hdsRows == NULL) {
+		drv = GDALGetDriverByName("MEM");
+		if (drv == NULL) {
+			rterror(_("finish_overview_row: Could not load the MEM GDAL driver"));
+			return 0;
+		}
+
+		/* last row of tiles may be partly outside of overview */
+		nrows = level->tile_size[1];
+		if (y0 + nrows > level->dim[1])
+			nrows = level->dim[1] - y0;
+
+		level->hdsRows = GDALCreate(drv, "", level->dim[0], nrows, 0, GDT_Byte, NULL);
+		if (level->hdsRows == NULL) {
+			rterror(_("finish_overview_row: Could not create MEM dataset of overview"));
+			return 0;
+		}
+
+		if (info->srs != NULL)
+			GDALSetProjection(level->hdsRows, info->srs);
+		memcpy(gt, level->gt, sizeof(double) * 6);
+		GDALApplyGeoTransform(level->gt, 0, y0, &(gt[0]), &(gt[3]));
+		GDALSetGeoTransform(level->hdsRows, gt);
+
+		for (j = 0; j < info->nband_count; j++) {
+			if (GDALAddBand(level->hdsRows, info->gdalbandtype[j], NULL) != CE_None) {
+				rterror(_("finish_overview_row: Could not add band to MEM dataset of overview"));
+				return 0;
+			}
+
+			if (info->hasnodata[j])
+				GDALSetRasterNoDataValue(GDALGetRasterBand(level->hdsRows, j + 1), info->nodataval[j]);
+		}
+	}
+
+	for (j = 0; j < info->nband_count; j++) {
+		for (x = 0; x < level->dim[0]; x++) {
+			if (!config->overview_resample)
+				level->values[x] = level->sum[j][x];
+			else if (level->count[j][x])
+				level->values[x] = level->sum[j][x] / level->count[j][x];
+			else
+				level->values[x] = info->nodataval[j];
+		}
+		memset(level->sum[j], 0, sizeof(double) * level->dim[0]);
+		memset(level->count[j], 0, sizeof(int) * level->dim[0]);
+
+		if (GDALRasterIO(
+			GDALGetRasterBand(level->hdsRows, j + 1),
+			GF_Write,
+			0, level->row - y0, level->dim[0], 1,
+			level->values, level->dim[0], 1,
+			GDT_Float64, 0, 0
+		) != CE_None) {
+			rterror(_("finish_overview_row: Could not write row of overview"));
+			return 0;
+		}
+	}
+
+	level->row++;
+
+	/* row of tiles is complete */
+	if (level->row == level->dim[1] || level->row == y0 + level->tile_size[1]) {
+		if (!tile_rows(
+			idx, config, info,
+			config->overview_table[level->ovx], level->hdsRows,
+			level->dim, level->gt, level->tile_size, ytile,
+			0,
+			&(level->tileset), buffer
+		)) {
+			rterror(_("finish_overview_row: Could not tile overview of factor %d"), level->factor);
+			return 0;
+		}
+
+		GDALClose(level->hdsRows);
+		level->hdsRows = NULL;
+	}
+
+	return 1;
+}
+
+/*
+	resample an overview from row y of the raster, pixels has the row of
+	each band one after the other. every overview pixel is resampled from
+	the pixels of the raster: the pixel at the center of the
+	factor x factor pixels it covers for nearest neighbor, or the average
+	of those pixels that are not NODATA
+*/
+static int
+resample_overview_row(
+	int idx, RTLOADERCFG *config, RASTERINFO *info,
+	OVERVIEWLEVEL *level, double *pixels, int y,
+	STRINGBUFFER *buffer
+) {
+	double *row = NULL;
+	double val = 0;
+	int width = 0;
+	int factor = level->factor;
+	int x = 0;
+	int j = 0;
+	int k = 0;
+
+	/* row is past the overview */
+	if (level->row >= level->dim[1])
+		return 1;
+
+	for (j = 0; j < info->nband_count; j++) {
+		row = pixels + ((size_t) j * info->dim[0]);
+
+		/* pixel at the center */
+		if (!config->overview_resample) {
+			if (y != overview_last_row(config, info, level, level->row))
+				continue;
+
+			for (x = 0; x < level->dim[0]; x++) {
+				k = (x * factor) + (factor / 2);
+				if (k >= (int) info->dim[0])
+					k = info->dim[0] - 1;
+				level->sum[j][x] = row[k];
+			}
+			continue;
+		}
+
+		/* row is below the overview */
+		if (y / factor != level->row)
+			continue;
+
+		/* last column may be partly outside of raster */
+		width = level->dim[0] * factor;
+		if (width > (int) info->dim[0])
+			width = info->dim[0];
+		for (k = 0; k < width; k++) {
+			val = row[k];
+			if (info->hasnodata[j] && FLT_EQ(val, info->nodataval[j]))
+				continue;
+			level->sum[j][k / factor] += val;
+			level->count[j][k / factor]++;
+		}
+	}
+
+	while (
+		level->row < level->dim[1] &&
+		y == overview_last_row(config, info, level, level->row)
+	) {
+		if (!finish_overview_row(idx, config, info, level, buffer))
+			return 0;
+	}
+
+	return 1;
+}
+
+/*
+	resample the overviews from the rows y0 to y0 + nrows of the raster
+	in hdsRows. with nfeed worker processes resampling the overviews,
+	each row of all bands is written to every feed instead
+*/
+static int
+resample_overviews(
+	int idx, RTLOADERCFG *config, RASTERINFO *info,
+	OVERVIEWLEVEL *levels, GDALDatasetH hdsRows, int y0, int nrows,
+	FILE **feed, int nfeed,
+	STRINGBUFFER *buffer
+) {
+	double *pixels = NULL;
+	size_t npixels = (size_t) info->dim[0] * info->nband_count;
+	int y = 0;
+	int i = 0;
+	int j = 0;
+
+	pixels = rtalloc(sizeof(double) * npixels);
+	if (pixels == NULL) {
+		rterror(_("resample_overviews: Could not allocate memory for row of raster"));
+		return 0;
+	}
+
+	for (y = y0; y < y0 + nrows; y++) {
+		for (j = 0; j < info->nband_count; j++) {
+			if (GDALRasterIO(
+				GDALGetRasterBand(hdsRows, j + 1),
+				GF_Read,
+				0, y - y0, info->dim[0], 1,
+				pixels + ((size_t) j * info->dim[0]), info->dim[0], 1,
+				GDT_Float64, 0, 0
+			) != CE_None) {
+				rterror(_("resample_overviews: Could not read row of raster"));
+				rtdealloc(pixels);
+				return 0;
+			}
+		}
+
+		if (nfeed) {
+			for (i = 0; i < nfeed; i++) {
+				if (fwrite(pixels, sizeof(double), npixels, feed[i]) != npixels) {
+					rterror(_("resample_overviews: Could not send row of raster to overview worker"));
+					rtdealloc(pixels);
+					return 0;
+				}
+			}
+			continue;
+		}
+
+		for (i = 0; i < config->overview_count; i++) {
+			if (!resample_overview_row(idx, config, info, &(levels[i]), pixels, y, buffer)) {
+				rtdealloc(pixels);
+				return 0;
+			}
+		}
+	}
+
+	rtdealloc(pixels);
+	return 1;
+}
+
+#ifndef _WIN32
+/* copy the statements a worker wrote to its temporary file to the output */
+static void
+copy_worker_output(RTLOADERCFG *config, FILE *out) {
+	FILE *dst = (config->copy_out != NULL ? config->copy_out : stdout);
+	char buf[8192];
+	size_t len = 0;
+
+	rewind(out);
+	while ((len = fread(buf, 1, sizeof(buf), out)) > 0)
+		fwrite(buf, 1, len, dst);
+	fflush(dst);
+}
+
+/*
+	resample the overviews w, w + nworkers, ... in worker process w from
+	the rows of the raster read from in, as written by resample_overviews()
+*/
+static int
+overview_worker(
+	int idx, RTLOADERCFG *config, RASTERINFO *info,
+	OVERVIEWLEVEL *levels, int w, int nworkers, FILE *in,
+	STRINGBUFFER *buffer
+) {
+	double *pixels = NULL;
+	size_t npixels = (size_t) info->dim[0] * info->nband_count;
+	int y = 0;
+	int i = 0;
+
+	pixels = rtalloc(sizeof(double) * npixels);
+	if (pixels == NULL) {
+		rterror(_("overview_worker: Could not allocate memory for row of raster"));
+		return 0;
+	}
+
+	for (y = 0; y < (int) info->dim[1]; y++) {
+		if (fread(pixels, sizeof(double), npixels, in) != npixels) {
+			rterror(_("overview_worker: Could not receive row of raster"));
+			rtdealloc(pixels);
+			return 0;
+		}
+
+		for (i = w; i < config->overview_count; i += nworkers) {
+			if (!resample_overview_row(idx, config, info, &(levels[i]), pixels, y, buffer)) {
+				rtdealloc(pixels);
+				return 0;
+			}
+		}
+	}
+
+	rtdealloc(pixels);
+
+	/* process overview tiles into COPY or INSERT statements */
+	for (i = w; i < config->overview_count; i += nworkers) {
+		if (levels[i].tileset.length && !insert_records(
+			config->schema, config->overview_table[i], config->raster_column,
+			(config->file_column ? config->rt_filename[idx] : NULL), config->file_column_name,
+			config->copy_statements, config->out_srid,
+			&(levels[i].tileset), buffer
+		)) {
+			rterror(_("overview_worker: Could not convert overview tiles into INSERT or COPY statements"));
+			return 0;
+		}
+	}
+
+	flush_stringbuffer(buffer);
+
+	return 1;
+}
+
+/*
+	start nworkers worker processes resampling the overviews of a raster
+	from its rows, fed through pipes by resample_overviews() while the
+	raster is read once for its tiles. each worker writes its statements
+	to a temporary file copied to stdout by finish_overview_workers()
+*/
+static int
+start_overview_workers(
+	int idx, RTLOADERCFG *config, RASTERINFO *info, OVERVIEWLEVEL *levels,
+	int nworkers, pid_t *pid, FILE **feed, FILE **out,
+	STRINGBUFFER *buffer
+) {
+	int fd[2] = {-1, -1};
+	int w = 0;
+	int k = 0;
+
+	for (w = 0; w < nworkers; w++) {
+		pid[w] = -1;
+		feed[w] = NULL;
+		out[w] = NULL;
+	}
+
+	/* nothing buffered may be written twice by the workers */
+	flush_stringbuffer(buffer);
+	fflush(stdout);
+
+	for (w = 0; w < nworkers; w++) {
+		out[w] = tmpfile();
+		if (out[w] == NULL) {
+			rterror(_("start_overview_workers: Could not create temporary file for overviews of: %s"), config->rt_file[idx]);
+			return 0;
+		}
+
+		if (pipe(fd) < 0) {
+			rterror(_("start_overview_workers: Could not create pipe for overviews of: %s"), config->rt_file[idx]);
+			return 0;
+		}
+
+		pid[w] = fork();
+		if (pid[w] < 0) {
+			rterror(_("start_overview_workers: Could not start worker process for overviews of: %s"), config->rt_file[idx]);
+			close(fd[0]);
+			close(fd[1]);
+			return 0;
+		}
+		/* worker */
+		else if (pid[w] == 0) {
+			FILE *in = NULL;
+			int ok = 0;
+
+			/* only the main process writes to the pipes */
+			close(fd[1]);
+			for (k = 0; k < w; k++)
+				fclose(feed[k]);
+
+			/* workers do not start workers of their own */
+			config->jobs = 1;
+			in = fdopen(fd[0], "rb");
+			if (in != NULL && dup2(fileno(out[w]), STDOUT_FILENO) >= 0)
+				ok = overview_worker(idx, config, info, levels, w, nworkers, in, buffer);
+			fflush(stdout);
+
+			_exit(ok ? 0 : 1);
+		}
+
+		close(fd[0]);
+		feed[w] = fdopen(fd[1], "wb");
+		if (feed[w] == NULL) {
+			rterror(_("start_overview_workers: Could not open pipe for overviews of: %s"), config->rt_file[idx]);
+			close(fd[1]);
+			return 0;
+		}
+	}
+
+	return 1;
+}
+
+/*
+	end the rows sent to the overview workers and wait on them. if ok,
+	their statements are copied to stdout in worker order
+*/
+static int
+finish_overview_workers(
+	int idx, RTLOADERCFG *config,
+	int nworkers, pid_t *pid, FILE **feed, FILE **out,
+	int ok
+) {
+	int status = 0;
+	int rtn = ok;
+	int w = 0;
+
+	for (w = 0; w < nworkers; w++) {
+		if (feed[w] != NULL && fclose(feed[w]) != 0)
+			rtn = 0;
+		feed[w] = NULL;
+	}
+
+	for (w = 0; w < nworkers; w++) {
+		if (pid[w] > 0) {
+			if (waitpid(pid[w], &status, 0) < 0 || !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+				rterror(_("finish_overview_workers: Worker process failed for overviews of: %s"), config->rt_file[idx]);
+				rtn = 0;
+			}
+			else if (rtn)
+				copy_worker_output(config, out[w]);
+		}
+
+		if (out[w] != NULL)
+			fclose(out[w]);
+	}
+
+	return rtn;
+}
+#endif
+
+static int
+convert_raster(int idx, RTLOADERCFG *config, RASTERINFO *info, STRINGBUFFER *tileset, STRINGBUFFER *buffer) {
+	GDALDatasetH hdsSrc;
+	GDALRasterBandH hbandSrc;
+	int nband = 0;
+	int i = 0;
+	int ntiles[2] = {1, 1};
+	int _tile_size[2] = {0, 0};
+	int xtile = 0;
+	int ytile = 0;
+	double gt[6] = {0.};
+	const char* pszProjectionRef = NULL;
+	int tilesize = 0;
+
+	int dim[2] = {0, 0};
+	int y0 = 0;
+	int nrows = 0;
+	GDALDatasetH hdsRows = NULL;
+	OVERVIEWLEVEL *levels = NULL;
+	FILE **feed = NULL;
+	int nworkers = 0;
+#ifndef _WIN32
+	FILE **out = NULL;
+	pid_t *pid = NULL;
+#endif
+	int rtn = 1;
+
+	rt_raster rast = NULL;
+	rt_band band = NULL;
+
+	info->srid = config->srid;
+
+	hdsSrc = GDALOpenShared(config->rt_file[idx], GA_ReadOnly);
+	if (hdsSrc == NULL) {
+		rterror(_("convert_raster: Could not open raster: %s"), config->rt_file[idx]);
+		return 0;
+	}
+
+	nband = GDALGetRasterCount(hdsSrc);
+	if (!nband) {
+		rterror(_("convert_raster: No bands found in raster: %s"), config->rt_file[idx]);
+		GDALClose(hdsSrc);
+		return 0;
+	}
+
+	/* check that bands specified are available */
+	for (i = 0; i < config->nband_count; i++) {
+		if (config->nband[i] > nband) {
+			rterror(_("convert_raster: Band %d not found in raster: %s"), config->nband[i], config->rt_file[idx]);
+			GDALClose(hdsSrc);
+			return 0;
+		}
+	}
+
+	/* record srs */
+	pszProjectionRef = GDALGetProjectionRef(hdsSrc);
+	if (pszProjectionRef != NULL && pszProjectionRef[0] != '\0') {
+		info->srs = rtalloc(sizeof(char) * (strlen(pszProjectionRef) + 1));
+		if (info->srs == NULL) {
+			rterror(_("convert_raster: Could not allocate memory for storing SRS"));
+			GDALClose(hdsSrc);
+			return 0;
+		}
+		strcpy(info->srs, pszProjectionRef);
+
+		if (info->srid == SRID_UNKNOWN) {
 			OGRSpatialReferenceH hSRS = OSRNewSpatialReference(NULL);
 			if (OSRSetFromUserInput(hSRS, pszProjectionRef) == OGRERR_NONE) {
 				const char* pszAuthorityName = OSRGetAuthorityName(hSRS, NULL);
@@ -1707,6 +2452,8 @@ convert_raster(int idx, RTLOADERCFG *config, RASTERINFO *info, STRINGBUFFER *til
 	/* dimensions of raster */
 	info->dim[0] = GDALGetRasterXSize(hdsSrc);
 	info->dim[1] = GDALGetRasterYSize(hdsSrc);
+	dim[0] = info->dim[0];
+	dim[1] = info->dim[1];
 
 	/* tile size is "auto" */
 	if (
@@ -1778,19 +2525,54 @@ convert_raster(int idx, RTLOADERCFG *config, RASTERINFO *info, STRINGBUFFER *til
 	if (tilesize > MAXTILESIZE)
 		rtwarn(_("The size of each output tile may exceed 1 GB. Use -t to specify a reasonable tile size"));
 
+	/* overviews are resampled from the rows read for the tiles */
+	if (config->overview_count) {
+		levels = init_overviews(config, info);
+		if (levels == NULL) {
+			rterror(_("convert_raster: Could not set up overviews for raster: %s"), config->rt_file[idx]);
+			GDALClose(hdsSrc);
+			return 0;
+		}
+
+#ifndef _WIN32
+		/* resample the overviews in worker processes fed with the rows */
+		if (config->jobs > 1) {
+			nworkers = config->jobs;
+			if (nworkers > config->overview_count)
+				nworkers = config->overview_count;
+
+			pid = rtalloc(sizeof(pid_t) * nworkers);
+			feed = rtalloc(sizeof(FILE *) * nworkers);
+			out = rtalloc(sizeof(FILE *) * nworkers);
+			if (pid == NULL || feed == NULL || out == NULL) {
+				rterror(_("convert_raster: Could not allocate memory for overview workers"));
+				if (pid != NULL) rtdealloc(pid);
+				if (feed != NULL) rtdealloc(feed);
+				if (out != NULL) rtdealloc(out);
+				free_overviews(config, info, levels);
+				GDALClose(hdsSrc);
+				return 0;
+			}
+
+			if (!start_overview_workers(idx, config, info, levels, nworkers, pid, feed, out, buffer)) {
+				rterror(_("convert_raster: Could not start overview workers for raster: %s"), config->rt_file[idx]);
+				rtn = 0;
+			}
+		}
+#endif
+	}
+
 	/* out-db raster */
 	if (config->outdb) {
-		GDALClose(hdsSrc);
-
 		/* each tile is a raster */
-		for (ytile = 0; ytile < ntiles[1]; ytile++) {
+		for (ytile = 0; rtn && ytile < ntiles[1]; ytile++) {
 			/* edge y tile */
 			if (!config->pad_tile && ntiles[1] > 1 && (ytile + 1) == ntiles[1])
 				_tile_size[1] = info->dim[1] - (ytile * info->tile_size[1]);
 			else
 				_tile_size[1] = info->tile_size[1];
 
-			for (xtile = 0; xtile < ntiles[0]; xtile++) {
+			for (xtile = 0; rtn && xtile < ntiles[0]; xtile++) {
 
 				/* edge x tile */
 				if (!config->pad_tile && ntiles[0] > 1 && (xtile + 1) == ntiles[0])
@@ -1809,7 +2591,8 @@ convert_raster(int idx, RTLOADERCFG *config, RASTERINFO *info, STRINGBUFFER *til
 				rast = rt_raster_new(_tile_size[0], _tile_size[1]);
 				if (rast == NULL) {
 					rterror(_("convert_raster: Could not create raster"));
-					return 0;
+					rtn = 0;
+					break;
 				}
 
 				/* set raster attributes */
@@ -1827,16 +2610,16 @@ convert_raster(int idx, RTLOADERCFG *config, RASTERINFO *info, STRINGBUFFER *til
 					);
 					if (band == NULL) {
 						rterror(_("convert_raster: Could not create offline band"));
-						raster_destroy(rast);
-						return 0;
+						rtn = 0;
+						break;
 					}
 
 					/* add band to raster */
 					if (rt_raster_add_band(rast, band, rt_raster_get_num_bands(rast)) == -1) {
 						rterror(_("convert_raster: Could not add offlineband to raster"));
 						rt_band_destroy(band);
-						raster_destroy(rast);
-						return 0;
+						rtn = 0;
+						break;
 					}
 
 					/* inspect each band of raster where band is NODATA */
@@ -1844,17 +2627,14 @@ convert_raster(int idx, RTLOADERCFG *config, RASTERINFO *info, STRINGBUFFER *til
 						rt_band_check_is_nodata(band);
 				}
 
-				/* convert rt_raster to hexwkb */
-				hex = rt_raster_to_hexwkb(rast, FALSE, &hexlen);
-				raster_destroy(rast);
-
-				if (hex == NULL) {
-					rterror(_("convert_raster: Could not convert PostGIS raster to hex WKB"));
-					return 0;
+				/* add tile to tileset */
+				if (rtn && !append_tile(idx, config, rast, tileset)) {
+					rterror(_("convert_raster: Could not add PostGIS raster to tileset"));
+					rtn = 0;
 				}
-
-				/* add hexwkb to tileset */
-				append_stringbuffer(tileset, hex);
+				raster_destroy(rast);
+				if (!rtn)
+					break;
 
 				/* flush if tileset gets too big */
 				if (tileset->length > 10) {
@@ -1865,7 +2645,8 @@ convert_raster(int idx, RTLOADERCFG *config, RASTERINFO *info, STRINGBUFFER *til
 						tileset, buffer
 					)) {
 						rterror(_("convert_raster: Could not convert raster tiles into INSERT or COPY statements"));
-						return 0;
+						rtn = 0;
+						break;
 					}
 
 					rtdealloc_stringbuffer(tileset, 0);
@@ -1873,132 +2654,233 @@ convert_raster(int idx, RTLOADERCFG *config, RASTERINFO *info, STRINGBUFFER *til
 			}
 		}
 	}
-	/* in-db raster */
-	else {
-		VRTDatasetH hdsDst;
-		VRTSourcedRasterBandH hbandDst;
 
-		/* each tile is a VRT with constraints set for just the data required for the tile */
-		for (ytile = 0; ytile < ntiles[1]; ytile++) {
+	/*
+		rows of the raster, one row of tiles at a time. the rows of an
+		out-db raster are only read for its overviews
+	*/
+	for (ytile = 0; rtn && ytile < ntiles[1]; ytile++) {
+		if (config->outdb && levels == NULL)
+			break;
+
+		y0 = ytile * info->tile_size[1];
+		nrows = info->tile_size[1];
+		if (y0 + nrows > dim[1])
+			nrows = dim[1] - y0;
+
+		hdsRows = source_rows(hdsSrc, info, y0, nrows, (levels != NULL));
+		if (hdsRows == NULL) {
+			rterror(_("convert_raster: Could not get rows of raster: %s"), config->rt_file[idx]);
+			rtn = 0;
+			break;
+		}
+
+		if (!config->outdb && !tile_rows(
+			idx, config, info,
+			config->table, hdsRows,
+			dim, info->gt, info->tile_size, ytile,
+			!config->skip_nodataval_check,
+			tileset, buffer
+		)) {
+			rterror(_("convert_raster: Could not tile raster: %s"), config->rt_file[idx]);
+			rtn = 0;
+		}
+		else if (levels != NULL && !resample_overviews(
+			idx, config, info,
+			levels, hdsRows, y0, nrows,
+			feed, nworkers,
+			buffer
+		)) {
+			rterror(_("convert_raster: Could not resample overviews of raster: %s"), config->rt_file[idx]);
+			rtn = 0;
+		}
 
-			/* edge y tile */
-			if (!config->pad_tile && ntiles[1] > 1 && (ytile + 1) == ntiles[1])
-				_tile_size[1] = info->dim[1] - (ytile * info->tile_size[1]);
-			else
-				_tile_size[1] = info->tile_size[1];
+		GDALClose(hdsRows);
 
-			for (xtile = 0; xtile < ntiles[0]; xtile++) {
-				/*
-				char fn[100];
-				sprintf(fn, "/tmp/tile%d.vrt", (ytile * ntiles[0]) + xtile);
-				*/
+		/* flush buffer after every row of tiles */
+		flush_stringbuffer(buffer);
+	}
 
-				/* edge x tile */
-				if (!config->pad_tile && ntiles[0] > 1 && (xtile + 1) == ntiles[0])
-					_tile_size[0] = info->dim[0] - (xtile * info->tile_size[0]);
-				else
-					_tile_size[0] = info->tile_size[0];
+#ifndef _WIN32
+	/* statements of the overviews resampled by worker processes */
+	if (nworkers) {
+		if (!finish_overview_workers(idx, config, nworkers, pid, feed, out, rtn)) {
+			if (rtn)
+				rterror(_("convert_raster: Could not resample overviews of raster: %s"), config->rt_file[idx]);
+			rtn = 0;
+		}
 
-				/* compute tile's upper-left corner */
-				GDALApplyGeoTransform(
-					info->gt,
-					xtile * info->tile_size[0], ytile * info->tile_size[1],
-					&(gt[0]), &(gt[3])
-				);
-				/*
-				rtinfo(_("tile (%d, %d) gt = (%f, %f, %f, %f, %f, %f)"),
-					xtile, ytile,
-					gt[0], gt[1], gt[2], gt[3], gt[4], gt[5]
-				);
-				*/
+		rtdealloc(pid);
+		rtdealloc(feed);
+		rtdealloc(out);
+	}
+#endif
 
-				/* create VRT dataset */
-				hdsDst = VRTCreate(_tile_size[0], _tile_size[1]);
-				/*
-  	 		GDALSetDescription(hdsDst, fn);
-				*/
-				GDALSetProjection(hdsDst, info->srs);
-				GDALSetGeoTransform(hdsDst, gt);
+	/* process overview tiles into COPY or INSERT statements */
+	for (i = 0; rtn && levels != NULL && !nworkers && i < config->overview_count; i++) {
+		if (levels[i].tileset.length && !insert_records(
+			config->schema, config->overview_table[i], config->raster_column,
+			(config->file_column ? config->rt_filename[idx] : NULL), config->file_column_name,
+			config->copy_statements, config->out_srid,
+			&(levels[i].tileset), buffer
+		)) {
+			rterror(_("convert_raster: Could not convert overview tiles into INSERT or COPY statements"));
+			rtn = 0;
+		}
+	}
 
-				/* add bands as simple sources */
-				for (i = 0; i < info->nband_count; i++) {
-					GDALAddBand(hdsDst, info->gdalbandtype[i], NULL);
-					hbandDst = (VRTSourcedRasterBandH) GDALGetRasterBand(hdsDst, i + 1);
+	free_overviews(config, info, levels);
+	GDALClose(hdsSrc);
 
-					if (info->hasnodata[i])
-						GDALSetRasterNoDataValue(hbandDst, info->nodataval[i]);
+	return rtn;
+}
 
-					VRTAddSimpleSource(
-						hbandDst, GDALGetRasterBand(hdsSrc, info->nband[i]),
-						xtile * info->tile_size[0], ytile * info->tile_size[1],
-						_tile_size[0], _tile_size[1],
-						0, 0,
-						_tile_size[0], _tile_size[1],
-						"near", VRT_NODATA_UNSET
-					);
-				}
+#ifndef _WIN32
+/* work on one item in a worker process, writing its statements to stdout */
+typedef int (*worker_func)(int i, RTLOADERCFG *config, STRINGBUFFER *buffer, void *arg);
 
-				/* make sure VRT reflects all changes */
-				VRTFlushCache(hdsDst);
+/*
+	run work on items first to count - 1 in up to config->jobs worker
+	processes. each worker writes its statements to a temporary file
+	that is copied to stdout in item order so that the output is the
+	same as when working on the items serially
+*/
+static int
+run_workers(
+	int first, int count, char **names,
+	worker_func work, void *arg,
+	RTLOADERCFG *config, STRINGBUFFER *buffer
+) {
+	pid_t *pid = NULL;
+	FILE **out = NULL;
+	int next = first;
+	int i = first;
+	int status = 0;
+	int rtn = 1;
+
+	pid = rtalloc(sizeof(pid_t) * count);
+	out = rtalloc(sizeof(FILE *) * count);
+	if (pid == NULL || out == NULL) {
+		rterror(_("run_workers: Could not allocate memory for worker processes"));
+		if (pid != NULL) rtdealloc(pid);
+		if (out != NULL) rtdealloc(out);
+		return 0;
+	}
 
-				/* convert VRT dataset to rt_raster */
-				rast = rt_raster_from_gdal_dataset(hdsDst);
-				if (rast == NULL) {
-					rterror(_("convert_raster: Could not convert VRT dataset to PostGIS raster"));
-					GDALClose(hdsDst);
-					return 0;
-				}
+	/* nothing buffered may be written twice by the workers */
+	flush_stringbuffer(buffer);
+	fflush(stdout);
+	if (config->copy_out != NULL)
+		fflush(config->copy_out);
+
+	for (i = first; i < count; i++) {
+		/* keep up to config->jobs workers running */
+		for (; rtn && next < count && next - i < config->jobs; next++) {
+			out[next] = tmpfile();
+			if (out[next] == NULL) {
+				rterror(_("run_workers: Could not create temporary file for: %s"), names[next]);
+				rtn = 0;
+				break;
+			}
 
-				/* set srid if provided */
-				rt_raster_set_srid(rast, info->srid);
+			pid[next] = fork();
+			if (pid[next] < 0) {
+				rterror(_("run_workers: Could not start worker process for: %s"), names[next]);
+				fclose(out[next]);
+				rtn = 0;
+				break;
+			}
+			/* worker */
+			else if (pid[next] == 0) {
+				int ok = 0;
+
+				/* workers do not start workers of their own */
+				config->jobs = 1;
+				/* binary COPY rows are also copied over in order */
+				if (config->copy_out != NULL)
+					config->copy_out = stdout;
+				if (dup2(fileno(out[next]), STDOUT_FILENO) >= 0)
+					ok = work(next, config, buffer, arg);
+				fflush(stdout);
+
+				_exit(ok ? 0 : 1);
+			}
+		}
 
-				/* inspect each band of raster where band is NODATA */
-				numbands = rt_raster_get_num_bands(rast);
-				for (i = 0; i < numbands; i++) {
-					band = rt_raster_get_band(rast, i);
-					if (band != NULL && !config->skip_nodataval_check)
-						rt_band_check_is_nodata(band);
-				}
+		/* all workers started have to be waited on */
+		if (i >= next)
+			break;
 
-				/* convert rt_raster to hexwkb */
-				hex = rt_raster_to_hexwkb(rast, FALSE, &hexlen);
-				raster_destroy(rast);
+		if (waitpid(pid[i], &status, 0) < 0 || !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+			rterror(_("run_workers: Worker process failed for: %s"), names[i]);
+			rtn = 0;
+		}
+		/* copy worker output in order */
+		else if (rtn)
+			copy_worker_output(config, out[i]);
+		fclose(out[i]);
+	}
 
-				if (hex == NULL) {
-					rterror(_("convert_raster: Could not convert PostGIS raster to hex WKB"));
-					GDALClose(hdsDst);
-					return 0;
-				}
+	rtdealloc(pid);
+	rtdealloc(out);
 
-				/* add hexwkb to tileset */
-				append_stringbuffer(tileset, hex);
+	return rtn;
+}
+#endif
 
-				GDALClose(hdsDst);
+/* convert one raster and its overviews, flushing statements to stdout */
+static int
+process_raster(int idx, RTLOADERCFG *config, RASTERINFO *rastinfo, STRINGBUFFER *buffer) {
+	STRINGBUFFER tileset;
 
-				/* flush if tileset gets too big */
-				if (tileset->length > 10) {
-					if (!insert_records(
-						config->schema, config->table, config->raster_column,
-						(config->file_column ? config->rt_filename[idx] : NULL), config->file_column_name,
-						config->copy_statements, config->out_srid,
-						tileset, buffer
-					)) {
-						rterror(_("convert_raster: Could not convert raster tiles into INSERT or COPY statements"));
-						GDALClose(hdsSrc);
-						return 0;
-					}
+	fprintf(stderr, _("Processing %d/%d: %s\n"), idx + 1, config->rt_file_count, config->rt_file[idx]);
 
-					rtdealloc_stringbuffer(tileset, 0);
-				}
-			}
-		}
+	init_stringbuffer(&tileset);
 
-		GDALClose(hdsSrc);
+	/* convert raster */
+	if (!convert_raster(idx, config, rastinfo, &tileset, buffer)) {
+		rterror(_("process_rasters: Could not process raster: %s"), config->rt_file[idx]);
+		rtdealloc_stringbuffer(&tileset, 0);
+		return 0;
+	}
+
+	/* process raster tiles into COPY or INSERT statements */
+	if (tileset.length && !insert_records(
+		config->schema, config->table, config->raster_column,
+		(config->file_column ? config->rt_filename[idx] : NULL),
+		config->file_column_name,
+		config->copy_statements, config->out_srid,
+		&tileset, buffer
+	)) {
+		rterror(_("process_rasters: Could not convert raster tiles into INSERT or COPY statements"));
+		rtdealloc_stringbuffer(&tileset, 0);
+		return 0;
 	}
 
+	rtdealloc_stringbuffer(&tileset, 0);
+
+	/* flush buffer after every raster */
+	flush_stringbuffer(buffer);
+
 	return 1;
 }
 
+#ifndef _WIN32
+/* convert one raster in a worker process */
+static int
+process_raster_worker(int idx, RTLOADERCFG *config, STRINGBUFFER *buffer, void *arg) {
+	RASTERINFO rastinfo;
+	int ok = 0;
+
+	init_rastinfo(&rastinfo);
+	ok = process_raster(idx, config, &rastinfo, buffer);
+	if (ok)
+		diff_rastinfo(&rastinfo, (RASTERINFO *) arg);
+
+	return ok;
+}
+#endif
+
 static int
 process_rasters(RTLOADERCFG *config, STRINGBUFFER *buffer) {
 	int i = 0;
@@ -2063,75 +2945,34 @@ process_rasters(RTLOADERCFG *config, STRINGBUFFER *buffer) {
 		RASTERINFO refinfo;
 		init_rastinfo(&refinfo);
 
+		if (config->copy_out != NULL && !copy_binary_header(config->copy_out)) {
+			rterror(_("process_rasters: Could not write binary COPY header"));
+			return 0;
+		}
+
 		/* process each raster */
 		for (i = 0; i < config->rt_file_count; i++) {
 			RASTERINFO rastinfo;
-			STRINGBUFFER tileset;
 
-			fprintf(stderr, _("Processing %d/%d: %s\n"), i + 1, config->rt_file_count, config->rt_file[i]);
+#ifndef _WIN32
+			/* hand off remaining rasters to worker processes */
+			if (i > 0 && config->jobs > 1) {
+				if (!run_workers(i, config->rt_file_count, config->rt_file, process_raster_worker, &refinfo, config, buffer)) {
+					rtdealloc_rastinfo(&refinfo);
+					return 0;
+				}
+				break;
+			}
+#endif
 
 			init_rastinfo(&rastinfo);
-			init_stringbuffer(&tileset);
 
-			/* convert raster */
-			if (!convert_raster(i, config, &rastinfo, &tileset, buffer)) {
-				rterror(_("process_rasters: Could not process raster: %s"), config->rt_file[i]);
+			if (!process_raster(i, config, &rastinfo, buffer)) {
 				rtdealloc_rastinfo(&rastinfo);
-				rtdealloc_stringbuffer(&tileset, 0);
+				rtdealloc_rastinfo(&refinfo);
 				return 0;
 			}
 
-			/* process raster tiles into COPY or INSERT statements */
-			if (tileset.length && !insert_records(
-				config->schema, config->table, config->raster_column,
-				(config->file_column ? config->rt_filename[i] : NULL),
-        config->file_column_name,
-				config->copy_statements, config->out_srid,
-				&tileset, buffer
-			)) {
-				rterror(_("process_rasters: Could not convert raster tiles into INSERT or COPY statements"));
-				rtdealloc_rastinfo(&rastinfo);
-				rtdealloc_stringbuffer(&tileset, 0);
-				return 0;
-			}
-
-			rtdealloc_stringbuffer(&tileset, 0);
-
-			/* flush buffer after every raster */
-			flush_stringbuffer(buffer);
-
-			/* overviews */
-			if (config->overview_count) {
-				int j = 0;
-
-				for (j = 0; j < config->overview_count; j++) {
-
-					if (!build_overview(i, config, &rastinfo, j, &tileset, buffer)) {
-						rterror(_("process_rasters: Could not create overview of factor %d for raster %s"), config->overview[j], config->rt_file[i]);
-						rtdealloc_rastinfo(&rastinfo);
-						rtdealloc_stringbuffer(&tileset, 0);
-						return 0;
-					}
-
-					if (tileset.length && !insert_records(
-						config->schema, config->overview_table[j], config->raster_column,
-						(config->file_column ? config->rt_filename[i] : NULL), config->file_column_name,
-						config->copy_statements, config->out_srid,
-						&tileset, buffer
-					)) {
-						rterror(_("process_rasters: Could not convert overview tiles into INSERT or COPY statements"));
-						rtdealloc_rastinfo(&rastinfo);
-						rtdealloc_stringbuffer(&tileset, 0);
-						return 0;
-					}
-
-					rtdealloc_stringbuffer(&tileset, 0);
-
-					/* flush buffer after every raster */
-					flush_stringbuffer(buffer);
-				}
-			}
-
 			if (config->rt_file_count > 1) {
 				if (i < 1)
 					copy_rastinfo(&refinfo, &rastinfo);
@@ -2144,6 +2985,33 @@ process_rasters(RTLOADERCFG *config, STRINGBUFFER *buffer) {
 		}
 
 		rtdealloc_rastinfo(&refinfo);
+
+		if (config->copy_out != NULL) {
+			if (!copy_binary_trailer(config->copy_out) || fflush(config->copy_out) != 0) {
+				rterror(_("process_rasters: Could not write binary COPY trailer"));
+				return 0;
+			}
+
+			/* load rows written to file */
+			if (config->copy_out != stdout) {
+				if (fclose(config->copy_out) != 0) {
+					config->copy_out = NULL;
+					rterror(_("process_rasters: Could not close binary COPY file: %s"), config->copy_binary);
+					return 0;
+				}
+				config->copy_out = NULL;
+
+				if (!copy_binary_from(
+					config->schema, config->table, config->raster_column,
+					(config->file_column ? config->file_column_name : NULL),
+					config->copy_binary,
+					buffer
+				)) {
+					rterror(_("process_rasters: Could not add \\copy command to string buffer"));
+					return 0;
+				}
+			}
+		}
 	}
 
 	/* index */
@@ -2530,6 +3398,19 @@ main(int argc, char **argv) {
 				}
 			}
 		}
+		/* resampling of overviews */
+		else if (CSEQUAL(argv[i], "-L") && i < argc - 1) {
+			++i;
+			if (CSEQUAL(argv[i], "near"))
+				config->overview_resample = 0;
+			else if (CSEQUAL(argv[i], "average"))
+				config->overview_resample = 1;
+			else {
+				rterror(_("Invalid argument for -L. Must be near or average"));
+				rtdealloc_config(config);
+				exit(1);
+			}
+		}
 		/* quote identifiers */
 		else if (CSEQUAL(argv[i], "-q")) {
 			config->quoteident = 1;
@@ -2601,6 +3482,31 @@ main(int argc, char **argv) {
 		else if (CSEQUAL(argv[i], "-Y")) {
 			config->copy_statements = 1;
 		}
+		/* binary COPY rows */
+		else if (CSEQUAL(argv[i], "-B") && i < argc - 1) {
+			config->copy_binary = rtalloc(sizeof(char) * (strlen(argv[++i]) + 1));
+			if (config->copy_binary == NULL) {
+				rterror(_("Could not allocate memory for storing binary COPY file name"));
+				rtdealloc_config(config);
+				exit(1);
+			}
+			strncpy(config->copy_binary, argv[i], strlen(argv[i]) + 1);
+		}
+		/* worker processes */
+		else if (CSEQUAL(argv[i], "-j") && i < argc - 1) {
+			config->jobs = atoi(argv[++i]);
+			if (config->jobs < 1) {
+				rterror(_("Number of jobs must be greater than zero"));
+				rtdealloc_config(config);
+				exit(1);
+			}
+#ifdef _WIN32
+			if (config->jobs > 1) {
+				rtwarn(_("Converting rasters in separate processes is not supported on this platform. Ignoring -j"));
+				config->jobs = 1;
+			}
+#endif
+		}
 		/* GDAL formats */
 		else if (CSEQUAL(argv[i], "-G")) {
 			uint32_t drv_count = 0;
@@ -2653,6 +3559,10 @@ main(int argc, char **argv) {
 			rterror(_("Invalid argument combination - cannot use -Y with -s FROM_SRID:TO_SRID"));
 			exit(1);
 		}
+		if (config->copy_binary != NULL) {
+			rterror(_("Invalid argument combination - cannot use -B with -s FROM_SRID:TO_SRID"));
+			exit(1);
+		}
 		if (config->out_srid == SRID_UNKNOWN) {
 			rterror(_("Unknown target SRID is invalid when source SRID is given"));
 			exit(1);
@@ -3015,6 +3925,39 @@ main(int argc, char **argv) {
 		}
 	}
 
+	/* binary COPY rows */
+	if (config->copy_binary != NULL) {
+		if (config->copy_statements) {
+			rterror(_("Invalid argument combination - cannot use -B with -Y"));
+			rtdealloc_config(config);
+			exit(1);
+		}
+		if (config->overview_count) {
+			rterror(_("Invalid argument combination - cannot use -B with -l"));
+			rtdealloc_config(config);
+			exit(1);
+		}
+
+		/* nothing but the rows may be written to stdout */
+		if (strcmp(config->copy_binary, "-") == 0) {
+			if (config->opt != 'a' || config->idx || config->constraints || config->maintenance) {
+				rterror(_("Invalid argument combination - -B - requires -a and cannot be used with -I, -C or -M"));
+				rtdealloc_config(config);
+				exit(1);
+			}
+			config->transaction = 0;
+			config->copy_out = stdout;
+		}
+		else if (config->opt != 'p') {
+			config->copy_out = fopen(config->copy_binary, "wb");
+			if (config->copy_out == NULL) {
+				rterror(_("Could not open binary COPY file: %s"), config->copy_binary);
+				rtdealloc_config(config);
+				exit(1);
+			}
+		}
+	}
+
 	/****************************************************************************
 	* processing of rasters
 	****************************************************************************/
@@ -159,6 +159,17 @@ typedef struct raster_loader_config {
 	/* use COPY instead of INSERT */
 	int copy_statements;
 
+	/* resampling of overviews, 0 = nearest neighbor (default), 1 = average */
+	int overview_resample;
+
+	/* file for binary COPY rows, "-" = stdout, NULL = not binary */
+	char *copy_binary;
+	/* stream binary COPY rows are written to */
+	FILE *copy_out;
+
+	/* number of rasters to convert at once, 1 (default) = serial */
+	int jobs;
+
 } RTLOADERCFG;
 
 typedef struct rasterinfo_t {
@@ -196,3 +207,38 @@ typedef struct stringbuffer_t {
 	uint32_t length;
 	char **line;
 } STRINGBUFFER;
+
+typedef struct overviewlevel_t {
+	/* index of overview factor and table */
+	int ovx;
+
+	/* overview factor */
+	int factor;
+
+	/* width, height */
+	int dim[2];
+
+	/* geotransform matrix */
+	double gt[6];
+
+	/* tile size */
+	int tile_size[2];
+
+	/* next row of overview to resample */
+	int row;
+
+	/* per band, sum of the pixels of the row being resampled */
+	double **sum;
+	/* per band, number of pixels in sum */
+	int **count;
+
+	/* resampled row of a band */
+	double *values;
+
+	/* MEM dataset of the rows of the row of tiles being resampled */
+	GDALDatasetH hdsRows;
+
+	/* tiles not yet converted into statements */
+	STRINGBUFFER tileset;
+
+} OVERVIEWLEVEL;
@@ -159,9 +159,11 @@ typedef struct rt_band_t* rt_band;
 typedef struct rt_pixel_t* rt_pixel;
 typedef struct rt_mask_t* rt_mask;
 typedef struct rt_geomval_t* rt_geomval;
+typedef struct rt_polygonizer_t* rt_polygonizer;
 typedef struct rt_bandstats_t* rt_bandstats;
 typedef struct rt_histogram_t* rt_histogram;
 typedef struct rt_quantile_t* rt_quantile;
+typedef struct rt_quantile_sketch_t* rt_quantile_sketch;
 typedef struct rt_valuecount_t* rt_valuecount;
 typedef struct rt_gdaldriver_t* rt_gdaldriver;
 typedef struct rt_reclassexpr_t* rt_reclassexpr;
@@ -172,6 +174,8 @@ typedef struct rt_iterator_arg_t* rt_iterator_arg;
 typedef struct rt_colormap_entry_t* rt_colormap_entry;
 typedef struct rt_colormap_t* rt_colormap;
 
+typedef struct rt_mapexpr_t* rt_mapexpr;
+
 /* envelope information */
 typedef struct {
 	double MinX;
@@ -474,6 +478,31 @@ rt_band rt_band_new_offline(
  */
 rt_band rt_band_duplicate(rt_band band);
 
+/**
+ * Create a new in-db band from a window of the source band.  Rows of
+ * the window are copied from the source band's data with memcpy.
+ * Cells of the window outside of the source band are set to nodataval.
+ * The caller is responsible for freeing the memory when the returned
+ * rt_band is destroyed.
+ *
+ * @param band : the band to copy from
+ * @param x : X coordinate (0-based) of the window's upper-left corner
+ * @param y : Y coordinate (0-based) of the window's upper-left corner
+ * @param width : number of pixel columns of the window
+ * @param height : number of pixel rows of the window
+ * @param hasnodata : indicates if the new band has nodata value
+ * @param nodataval : the nodata value of the new band, also used to
+ *                    fill the cells outside of the source band
+ *
+ * @return an rt_band or NULL on failure
+ */
+rt_band rt_band_new_window(
+	rt_band band,
+	int x, int y,
+	uint16_t width, uint16_t height,
+	uint32_t hasnodata, double nodataval
+);
+
 /**
  * Return non-zero if the given band data is on
  * the filesystem.
@@ -830,6 +859,28 @@ rt_bandstats rt_band_get_summary_stats(
 	uint64_t *cK, double *cM, double *cQ
 );
 	
+/**
+ * Compute summary statistics of the pixels of a band whose centers
+ * are inside a polygonal geometry
+ *
+ * @param raster : the raster of the band
+ * @param nband : 0-based index of the band
+ * @param geom : POLYGON or MULTIPOLYGON in the raster's coordinates
+ * @param exclude_nodata_value : if non-zero, ignore nodata values
+ * @param inc_vals : flag to include values in return struct
+ * @param cK : number of pixels counted thus far in coverage
+ * @param cM : M component of 1-pass stddev for coverage
+ * @param cQ : Q component of 1-pass stddev for coverage
+ *
+ * @return the summary statistics of the pixels or NULL
+ */
+rt_bandstats rt_raster_get_zonal_stats(
+	rt_raster raster, int nband,
+	const LWGEOM *geom,
+	int exclude_nodata_value, int inc_vals,
+	uint64_t *cK, double *cM, double *cQ
+);
+
 /**
  * Count the distribution of data
  *
@@ -911,6 +962,115 @@ rt_quantile rt_band_get_quantiles_stream(
 	uint32_t *rtn_count
 );
 
+/**
+ * Create a mergeable quantile sketch (merging t-digest) of bounded size
+ *
+ * This function is based upon the algorithm described in:
+ *
+ * Computing Extremely Accurate Quantiles Using t-Digests (2019)
+ *   by Ted Dunning, Otmar Ertl
+ *
+ * @param compression : the accuracy parameter of the sketch, the
+ *   number of centroids kept is at most compression + 2.
+ *   if zero or less, a default of 100 is used
+ *
+ * @return a new sketch or NULL on error
+ */
+rt_quantile_sketch rt_quantile_sketch_new(double compression);
+
+/**
+ * Destroy a quantile sketch
+ *
+ * @param sketch : the sketch to destroy
+ */
+void rt_quantile_sketch_destroy(rt_quantile_sketch sketch);
+
+/**
+ * Add a value to a quantile sketch
+ *
+ * @param sketch : the sketch to add to
+ * @param value : the value to add
+ * @param weight : the number of times value occurs
+ *
+ * @return ES_NONE on success, ES_ERROR on error
+ */
+rt_errorstate rt_quantile_sketch_add(
+	rt_quantile_sketch sketch,
+	double value, double weight
+);
+
+/**
+ * Add the pixel values of a band to a quantile sketch
+ *
+ * @param sketch : the sketch to add to
+ * @param band : the band whose values are added
+ * @param exclude_nodata_value : if non-zero, ignore nodata values
+ * @param sample : percentage of pixels to sample
+ *
+ * @return ES_NONE on success, ES_ERROR on error
+ */
+rt_errorstate rt_quantile_sketch_add_band(
+	rt_quantile_sketch sketch,
+	rt_band band, int exclude_nodata_value, double sample
+);
+
+/**
+ * Merge a quantile sketch into another
+ *
+ * @param sketch : the sketch to merge into
+ * @param other : the sketch to merge from, left unchanged
+ *
+ * @return ES_NONE on success, ES_ERROR on error
+ */
+rt_errorstate rt_quantile_sketch_merge(
+	rt_quantile_sketch sketch,
+	rt_quantile_sketch other
+);
+
+/**
+ * Estimate the default set of or requested quantiles from a sketch.
+ * Until the sketch has to merge values, the quantiles are exactly
+ * those of rt_band_get_quantiles()
+ *
+ * @param sketch : the sketch to query
+ * @param quantiles : the quantiles to be computed
+ * @param quantiles_count : the number of quantiles to be computed
+ * @param rtn_count : set to the number of quantiles being returned
+ *
+ * @return the default set of or requested quantiles or NULL
+ */
+rt_quantile rt_quantile_sketch_get_quantiles(
+	rt_quantile_sketch sketch,
+	double *quantiles, int quantiles_count,
+	uint32_t *rtn_count
+);
+
+/**
+ * Flatten a quantile sketch into a buffer
+ *
+ * @param sketch : the sketch to flatten
+ * @param size : set to the number of bytes of the buffer
+ *
+ * @return the buffer or NULL on error
+ */
+uint8_t *rt_quantile_sketch_serialize(
+	rt_quantile_sketch sketch,
+	uint32_t *size
+);
+
+/**
+ * Rebuild a quantile sketch from a buffer of rt_quantile_sketch_serialize()
+ *
+ * @param data : the buffer
+ * @param size : the number of bytes of the buffer
+ *
+ * @return a new sketch or NULL on error
+ */
+rt_quantile_sketch rt_quantile_sketch_deserialize(
+	const uint8_t *data,
+	uint32_t size
+);
+
 /**
  * Count the number of times provided value(s) occur in
  * the band
@@ -1428,6 +1588,67 @@ LWPOLY* rt_raster_pixel_as_polygon(rt_raster raster, int x, int y);
  */
 rt_errorstate rt_raster_surface(rt_raster raster, int nband, LWMPOLY **surface);
 
+/**
+ * Returns a set of "geomval" value, one for each group of pixel
+ * sharing the same value for the provided band. Same as
+ * rt_raster_gdal_polygonize() but traced from the band data
+ * without a GDAL dataset.
+ *
+ * @param raster : the raster to get info from.
+ * @param nband : the band to polygonize. 0-based
+ * @param exclude_nodata_value : if non-zero, ignore nodata values
+ * to check for pixels with value
+ * @param pnElements : output parameter, number of geomval returned
+ *
+ * @return A set of "geomval" values, one for each group of pixels
+ * sharing the same value for the provided band. The returned values are
+ * LWPOLY geometries.
+ */
+rt_geomval
+rt_raster_polygonize(
+	rt_raster raster, int nband,
+	int exclude_nodata_value,
+	int *pnElements
+);
+
+/**
+ * Group the pixels of a band for rt_polygonizer_next(). Pixels are
+ * grouped if they share an edge (4-connected) and have the same value.
+ *
+ * @param raster : the raster to get info from.
+ * @param nband : the band to polygonize. 0-based
+ * @param exclude_nodata_value : if non-zero, ignore nodata values
+ * to check for pixels with value
+ *
+ * @return the polygonizer or NULL on error or if the band is NODATA.
+ * The raster can be destroyed before the polygonizer.
+ */
+rt_polygonizer
+rt_polygonizer_new(
+	rt_raster raster, int nband,
+	int exclude_nodata_value
+);
+
+/**
+ * Trace the polygon of the next group of pixels of a polygonizer.
+ * Groups are returned in scan order of their first pixel.
+ *
+ * @param poly : the polygonizer
+ * @param val : output parameter, value of the pixels of the group
+ *
+ * @return polygon of the group or NULL when all groups are returned
+ */
+LWPOLY *
+rt_polygonizer_next(rt_polygonizer poly, double *val);
+
+/**
+ * Destroy a polygonizer
+ *
+ * @param poly : the polygonizer to destroy
+ */
+void
+rt_polygonizer_destroy(rt_polygonizer poly);
+
 /**
  * Returns a set of "geomval" value, one for each group of pixel
  * sharing the same value for the provided band.
@@ -1644,6 +1865,99 @@ rt_raster rt_raster_gdal_warp(
 	double *skew_x, double *skew_y,
 	GDALResampleAlg resample_alg, double max_err);
 
+/**
+ * Call a function for each run of pixels whose centers are inside
+ * a polygonal geometry.  Rings are combined with the even-odd rule
+ *
+ * @param raster : the raster whose grid the geometry is scanned against
+ * @param geom : POLYGON or MULTIPOLYGON in the raster's coordinates
+ * @param callback : function called with arg, the row, the first
+ *   column and the number of columns of each run.  scanning stops
+ *   if the function does not return ES_NONE
+ * @param arg : argument passed to callback
+ *
+ * @return ES_NONE if success, ES_ERROR if error
+ */
+rt_errorstate rt_raster_scan_polygon(
+	rt_raster raster, const LWGEOM *geom,
+	rt_errorstate (*callback)(void *arg, int y, int x, int count),
+	void *arg
+);
+
+/**
+ * Set pixels whose centers are inside a polygonal geometry to a value
+ *
+ * @param raster : the raster of the band
+ * @param nband : 0-based index of the band, must not be offline
+ * @param geom : POLYGON or MULTIPOLYGON in the raster's coordinates
+ * @param value : value of the pixels, clamped to the band's pixel type
+ * @param burned : optional output parameter, number of pixels set
+ *
+ * @return ES_NONE if success, ES_ERROR if error
+ */
+rt_errorstate rt_raster_burn_polygon(
+	rt_raster raster, int nband,
+	const LWGEOM *geom, double value,
+	uint32_t *burned
+);
+
+/**
+ * Call a function for each pixel on a linear geometry, drawing each
+ * segment between the pixels of its ends as GDAL does when not
+ * burning all touched pixels
+ *
+ * @param raster : the raster whose grid the geometry is scanned against
+ * @param geom : LINESTRING or MULTILINESTRING in the raster's coordinates
+ * @param callback : function called with arg, the row, the column
+ *   and 1 for each pixel.  scanning stops if the function does not
+ *   return ES_NONE
+ * @param arg : argument passed to callback
+ *
+ * @return ES_NONE if success, ES_ERROR if error
+ */
+rt_errorstate rt_raster_scan_line(
+	rt_raster raster, const LWGEOM *geom,
+	rt_errorstate (*callback)(void *arg, int y, int x, int count),
+	void *arg
+);
+
+/**
+ * Set pixels on a linear geometry to a value
+ *
+ * @param raster : the raster of the band
+ * @param nband : 0-based index of the band, must not be offline
+ * @param geom : LINESTRING or MULTILINESTRING in the raster's coordinates
+ * @param value : value of the pixels, clamped to the band's pixel type
+ * @param burned : optional output parameter, number of pixels set
+ *
+ * @return ES_NONE if success, ES_ERROR if error
+ */
+rt_errorstate rt_raster_burn_line(
+	rt_raster raster, int nband,
+	const LWGEOM *geom, double value,
+	uint32_t *burned
+);
+
+/**
+ * Set pixels covered by a geometry to a value as rasterized by
+ * rt_raster_gdal_rasterize().  polygons and lines are burned
+ * directly unless all touched pixels are burned
+ *
+ * @param raster : the raster of the band
+ * @param nband : 0-based index of the band, must not be offline
+ * @param geom : geometry in the raster's coordinates
+ * @param value : value of the pixels, clamped to the band's pixel type
+ * @param touched : if non-zero, burn all pixels touched by geometry
+ * @param burned : optional output parameter, number of pixels set
+ *
+ * @return ES_NONE if success, ES_ERROR if error
+ */
+rt_errorstate rt_raster_burn_geometry(
+	rt_raster raster, int nband,
+	const LWGEOM *geom, double value, int touched,
+	uint32_t *burned
+);
+
 /**
  * Return a raster of the provided geometry
  *
@@ -1979,6 +2293,60 @@ rt_raster_iterator(
 	rt_raster *rtnraster
 );
 
+/**
+ * Compile a map algebra expression for evaluation without SQL.
+ * Only the arithmetic/conditional subset of SQL is supported:
+ * numeric literals, NULL, TRUE, FALSE, keywords, + - * / %,
+ * comparisons, AND, OR, NOT, IS [NOT] NULL, CASE WHEN,
+ * abs(), sqrt(), floor(), ceil(), least() and greatest().
+ * The result of the compiled expression is the same as the result
+ * of "SELECT (expr)::double precision".
+ *
+ * @param expr : the expression
+ * @param kw : keywords (e.g. "[rast1.val]") usable as variables
+ * @param kwint : for each keyword, non-zero if the variable is int4.
+ * Otherwise, the variable is double precision
+ * @param kwcount : number of elements in kw and kwint
+ *
+ * @return compiled expression or NULL if the expression is not
+ * supported and must be evaluated by other means
+ */
+rt_mapexpr
+rt_mapexpr_compile(
+	const char *expr,
+	char **kw, const int *kwint, int kwcount
+);
+
+/**
+ * Evaluate a compiled map algebra expression
+ *
+ * @param mexpr : compiled expression
+ * @param values : values of the keywords, in the order passed to
+ * rt_mapexpr_compile()
+ * @param nulls : for each keyword, non-zero if the value is NULL
+ * @param value : result of the expression
+ * @param isnull : non-zero if the result is NULL
+ *
+ * @return ES_NONE on success. ES_ERROR if the values lead to a condition
+ * that the compiled expression does not handle (e.g. division by zero
+ * or overflow), in which case the expression must be evaluated by
+ * other means for these values
+ */
+rt_errorstate
+rt_mapexpr_eval(
+	rt_mapexpr mexpr,
+	const double *values, const int *nulls,
+	double *value, int *isnull
+);
+
+/**
+ * Free a compiled map algebra expression
+ *
+ * @param mexpr : compiled expression to free
+ */
+void
+rt_mapexpr_destroy(rt_mapexpr mexpr);
+
 /**
  * Returns a new raster with up to four 8BUI bands (RGBA) from
  * applying a colormap to the user-specified band of the
@@ -2213,7 +2581,7 @@ rt_util_hsv_to_rgb(
 struct rt_raster_serialized_t {
     /*---[ 8 byte boundary ]---{ */
     uint32_t size; /* required by postgresql: 4 bytes */
-    uint16_t version; /* format version (this is version 0): 2 bytes */
+    uint16_t version; /* format version (0 or 1): 2 bytes */
     uint16_t numBands; /* Number of bands: 2 bytes */
 
     /* }---[ 8 byte boundary ]---{ */
@@ -2284,6 +2652,10 @@ struct rt_band_t {
     double nodataval; /* int will be converted ... */
     int8_t ownsdata; /* 0, externally owned. 1, internally owned. only applies to data.mem */
 
+    /* run-length encoded data of a deserialized band, decoded into
+       data.mem on first access. NULL once decoded */
+    const uint8_t *rle;
+
 		rt_raster raster; /* reference to parent raster */
 
     union {
@@ -2317,6 +2689,26 @@ struct rt_geomval_t {
 	double val;
 };
 
+/* groups of pixels of a band traced one polygon at a time */
+struct rt_polygonizer_t {
+	int width;
+	int height;
+	double gt[6];
+	int32_t srid;
+
+	uint32_t *labels; /* group of each pixel, starting at 1 */
+	uint8_t *visited; /* pixels whose top edge was traced */
+	uint32_t *next; /* one-based next pixel starting a ring of same group */
+
+	uint32_t nlabels; /* # of groups */
+	uint32_t *head; /* one-based first pixel starting a ring of group */
+	uint8_t *skip; /* group is NODATA */
+	double *values; /* value of group */
+
+	uint32_t count; /* # of polygons */
+	uint32_t label; /* last group returned */
+};
+
 /* summary stats of specified band */
 struct rt_bandstats_t {
 	double sample;
@@ -2382,6 +2774,27 @@ struct quantile_llist_index {
 	uint32_t index;
 };
 
+/* centroid of a rt_quantile_sketch */
+struct rt_quantile_centroid_t {
+	double mean;
+	double weight;
+};
+
+/* mergeable quantile sketch (merging t-digest) */
+struct rt_quantile_sketch_t {
+	double compression;
+
+	/* merged centroids, sorted by mean, followed by unmerged values */
+	struct rt_quantile_centroid_t *centroids;
+	uint32_t capacity; /* max # of elements in centroids */
+	uint32_t count; /* # of merged centroids */
+	uint32_t buffered; /* # of unmerged values */
+
+	double total; /* total weight */
+	double min;
+	double max;
+};
+
 /* number of times a value occurs */
 struct rt_valuecount_t {
 	double value;
@@ -31,6 +31,7 @@
 
 #include "librtcore.h"
 #include "librtcore_internal.h"
+#include "rt_serialize.h"
 
 #include "gdal_vrt.h"
 
@@ -82,6 +83,7 @@ rt_band_new_inline(
 	band->nodataval = 0;
 	band->data.mem = data;
 	band->ownsdata = 0; /* we do NOT own this data!!! */
+	band->rle = NULL;
 	band->raster = NULL;
 
 	RASTER_DEBUGF(3, "Created rt_band with dimensions %d x %d", band->width, band->height);
@@ -145,6 +147,7 @@ rt_band_new_offline(
 	band->nodataval = 0;
 	band->isnodata = FALSE; /* we don't know if the offline band is NODATA */
 	band->ownsdata = 0; /* offline, flag is useless as all offline data cache is owned internally */
+	band->rle = NULL;
 	band->raster = NULL;
 
 	/* properly set nodataval as it may need to be constrained to the data type */
@@ -200,12 +203,17 @@ rt_band_duplicate(rt_band band) {
 	/* online */
 	else {
 		uint8_t *data = NULL;
+		uint8_t *src = rt_band_get_data(band);
+		if (src == NULL) {
+			rterror("rt_band_duplicate: Could not get band data");
+			return NULL;
+		}
 		data = rtalloc(rt_pixtype_size(band->pixtype) * band->width * band->height);
 		if (data == NULL) {
 			rterror("rt_band_duplicate: Out of memory allocating online band data");
 			return NULL;
 		}
-		memcpy(data, band->data.mem, rt_pixtype_size(band->pixtype) * band->width * band->height);
+		memcpy(data, src, rt_pixtype_size(band->pixtype) * band->width * band->height);
 
 		rtn = rt_band_new_inline(
 			band->width, band->height,
@@ -224,6 +232,125 @@ rt_band_duplicate(rt_band band) {
 	return rtn;
 }
 
+/**
+ * Create a new in-db band from a window of the source band.  Each
+ * row of the window that overlaps the source band is copied with a
+ * single memcpy.  Cells of the window outside of the source band are
+ * set to nodataval.  The caller is responsible for freeing the memory
+ * when the returned rt_band is destroyed.
+ *
+ * @param band : the band to copy from
+ * @param x : X coordinate (0-based) of the window's upper-left corner
+ * @param y : Y coordinate (0-based) of the window's upper-left corner
+ * @param width : number of pixel columns of the window
+ * @param height : number of pixel rows of the window
+ * @param hasnodata : indicates if the new band has nodata value
+ * @param nodataval : the nodata value of the new band, also used to
+ *                    fill the cells outside of the source band
+ *
+ * @return an rt_band or NULL on failure
+ */
+rt_band
+rt_band_new_window(
+	rt_band band,
+	int x, int y,
+	uint16_t width, uint16_t height,
+	uint32_t hasnodata, double nodataval
+) {
+	rt_band rtn = NULL;
+	uint8_t *src = NULL;
+	uint8_t *data = NULL;
+	int pixsize = 0;
+	uint32_t datasize = 0;
+	int x0 = 0;
+	int x1 = 0;
+	int y0 = 0;
+	int y1 = 0;
+	int isnodata = 0;
+	int row = 0;
+
+	assert(band != NULL);
+	assert(width > 0 && height > 0);
+
+	pixsize = rt_pixtype_size(band->pixtype);
+	datasize = pixsize * width * height;
+
+	data = rtalloc(datasize);
+	if (data == NULL) {
+		rterror("rt_band_new_window: Out of memory allocating band data");
+		return NULL;
+	}
+
+	rtn = rt_band_new_inline(
+		width, height,
+		band->pixtype,
+		hasnodata, nodataval,
+		data
+	);
+	if (rtn == NULL) {
+		rterror("rt_band_new_window: Could not create band");
+		rtdealloc(data);
+		return NULL;
+	}
+	rt_band_set_ownsdata_flag(rtn, 1); /* we DO own this data!!! */
+
+	/* portion of the window covered by the source band */
+	x0 = x > 0 ? x : 0;
+	y0 = y > 0 ? y : 0;
+	x1 = x + width < band->width ? x + width : band->width;
+	y1 = y + height < band->height ? y + height : band->height;
+
+	isnodata = rt_band_get_isnodata_flag(band);
+
+	/* fill the cells not copied from the source band */
+	if (isnodata || x0 != x || y0 != y || x1 != x + width || y1 != y + height) {
+		if (FLT_EQ(nodataval, 0.0))
+			memset(data, 0, datasize);
+		else {
+			uint32_t filled = pixsize;
+
+			/* set the first cell, then double the filled span */
+			if (rt_band_set_pixel(rtn, 0, 0, nodataval, NULL) != ES_NONE) {
+				rterror("rt_band_new_window: Could not set fill value");
+				rt_band_destroy(rtn);
+				return NULL;
+			}
+			while (filled < datasize) {
+				uint32_t n = filled < datasize - filled ? filled : datasize - filled;
+				memcpy(data + filled, data, n);
+				filled += n;
+			}
+		}
+	}
+
+	if (isnodata) {
+		if (hasnodata)
+			rt_band_set_isnodata_flag(rtn, 1);
+		return rtn;
+	}
+
+	/* window does not overlap the source band */
+	if (x0 >= x1 || y0 >= y1)
+		return rtn;
+
+	src = rt_band_get_data(band);
+	if (src == NULL) {
+		rterror("rt_band_new_window: Could not get source band data");
+		rt_band_destroy(rtn);
+		return NULL;
+	}
+
+	for (row = y0; row < y1; row++) {
+		memcpy(
+			data + (((row - y) * width) + (x0 - x)) * pixsize,
+			src + ((row * band->width) + x0) * pixsize,
+			(x1 - x0) * pixsize
+		);
+	}
+
+	return rtn;
+}
+
 int
 rt_band_is_offline(rt_band band) {
 
@@ -311,8 +438,13 @@ rt_band_get_data(rt_band band) {
 		else
 			return band->data.offline.mem;
 	}
-	else
+	else {
+		/* run-length encoded band of a deserialized raster */
+		if (band->rle != NULL && rt_band_decode_rle(band) != ES_NONE)
+			return NULL;
+
 		return band->data.mem;
+	}
 }
 
 /* variable for PostgreSQL GUC: postgis.enable_outdb_rasters */
@@ -915,6 +915,438 @@ rt_raster_get_convex_hull(rt_raster raster, LWGEOM **hull) {
 	return ES_NONE;
 }
 
+/******************************************************************************
+* rt_raster_polygonize()
+******************************************************************************/
+
+/* pixels have the same value */
+static int
+_rti_polygonize_pixel_equal(
+	const uint8_t *a, const uint8_t *b,
+	rt_pixtype pixtype, int pixbytes
+) {
+	switch (pixtype) {
+		case PT_32BF:
+			if (*((float *) a) == *((float *) b))
+				return 1;
+			break;
+		case PT_64BF:
+			if (*((double *) a) == *((double *) b))
+				return 1;
+			break;
+		default:
+			break;
+	}
+
+	return memcmp(a, b, pixbytes) == 0;
+}
+
+/*
+	directions of travel along pixel edges, in raster space with y down.
+	when traveling, the pixels of the traced group are on the right.
+	the pixel to the front-right and front-left of a corner are at the
+	offsets below from the corner
+*/
+static const int _rti_polygonize_dx[4] = {1, 0, -1, 0}; /* E, S, W, N */
+static const int _rti_polygonize_dy[4] = {0, 1, 0, -1};
+static const int _rti_polygonize_rf[4][2] = {{0, 0}, {-1, 0}, {-1, -1}, {0, -1}};
+static const int _rti_polygonize_lf[4][2] = {{0, -1}, {0, 0}, {-1, 0}, {-1, -1}};
+
+/*
+	trace ring of group starting at upper-left corner of pixel (x, y)
+	going east. pixels of group touching only at a corner are not
+	connected so rings never touch themselves, but may touch other rings
+*/
+static POINTARRAY *
+_rti_polygonize_trace_ring(
+	const uint32_t *labels, uint8_t *visited,
+	int width, int height,
+	int x, int y,
+	double *gt
+) {
+	uint32_t label = labels[x + (y * width)];
+	POINTARRAY *pa = NULL;
+	POINT4D pt;
+	int vx = x;
+	int vy = y;
+	int d = 0;
+	int nd = 0;
+	int px = 0;
+	int py = 0;
+	int rf = 0;
+	int lf = 0;
+
+	pa = ptarray_construct_empty(0, 0, 8);
+	if (pa == NULL)
+		return NULL;
+
+	pt.z = pt.m = 0;
+	pt.x = gt[0] + (vx * gt[1]) + (vy * gt[2]);
+	pt.y = gt[3] + (vx * gt[4]) + (vy * gt[5]);
+	ptarray_append_point(pa, &pt, LW_TRUE);
+
+	do {
+		/* top edge of pixel traced east */
+		if (d == 0)
+			visited[vx + (vy * width)] = 1;
+
+		vx += _rti_polygonize_dx[d];
+		vy += _rti_polygonize_dy[d];
+
+		/*
+			turn left if front-left pixel is in group. this also splits
+			rings where pixels of the group touch at a corner
+		*/
+		px = vx + _rti_polygonize_lf[d][0];
+		py = vy + _rti_polygonize_lf[d][1];
+		lf = (px >= 0 && px < width && py >= 0 && py < height && labels[px + (py * width)] == label);
+
+		if (lf)
+			nd = (d + 3) % 4;
+		else {
+			/* go straight if front-right pixel is in group, else turn right */
+			px = vx + _rti_polygonize_rf[d][0];
+			py = vy + _rti_polygonize_rf[d][1];
+			rf = (px >= 0 && px < width && py >= 0 && py < height && labels[px + (py * width)] == label);
+
+			nd = rf ? d : (d + 1) % 4;
+		}
+
+		/* only corners are vertices */
+		if (nd != d) {
+			pt.x = gt[0] + (vx * gt[1]) + (vy * gt[2]);
+			pt.y = gt[3] + (vx * gt[4]) + (vy * gt[5]);
+			ptarray_append_point(pa, &pt, LW_TRUE);
+			d = nd;
+		}
+	}
+	while (vx != x || vy != y || d != 0);
+
+	return pa;
+}
+
+/**
+ * Group the pixels of a band for rt_polygonizer_next(). Pixels are
+ * grouped if they share an edge (4-connected) and have the same value,
+ * as with GDALPolygonize().
+ *
+ * @param raster : the raster to get info from.
+ * @param nband : the band to polygonize. 0-based
+ * @param exclude_nodata_value : if non-zero, ignore nodata values
+ * to check for pixels with value
+ *
+ * @return the polygonizer or NULL on error or if the band is NODATA.
+ * The raster can be destroyed before the polygonizer.
+ */
+rt_polygonizer
+rt_polygonizer_new(
+	rt_raster raster, int nband,
+	int exclude_nodata_value
+) {
+	rt_polygonizer poly = NULL;
+	rt_band band = NULL;
+	rt_pixtype pixtype = PT_END;
+	int pixbytes = 0;
+	uint8_t *data = NULL;
+	int width = 0;
+	int height = 0;
+	uint32_t npixels = 0;
+
+	uint32_t *stack = NULL;
+	uint32_t nstack = 0;
+	uint32_t *tail = NULL;
+	uint32_t nlabels = 0;
+
+	int isnodata = 0;
+	uint32_t i = 0;
+	uint32_t j = 0;
+	uint32_t k = 0;
+	uint32_t idx = 0;
+	int x = 0;
+	int y = 0;
+	int nx = 0;
+	int ny = 0;
+	int n = 0;
+
+	assert(NULL != raster);
+
+	RASTER_DEBUG(2, "In rt_polygonizer_new");
+
+	band = rt_raster_get_band(raster, nband);
+	if (NULL == band) {
+		rterror("rt_polygonizer_new: Error getting band %d from raster", nband);
+		return NULL;
+	}
+
+	if (exclude_nodata_value) {
+		/* band is NODATA */
+		if (rt_band_get_isnodata_flag(band)) {
+			RASTER_DEBUG(3, "Band is NODATA.  Returning null");
+			return NULL;
+		}
+
+		if (!rt_band_get_hasnodata_flag(band))
+			exclude_nodata_value = FALSE;
+	}
+
+	width = rt_raster_get_width(raster);
+	height = rt_raster_get_height(raster);
+	npixels = (uint32_t) width * height;
+
+	pixtype = rt_band_get_pixtype(band);
+	pixbytes = rt_pixtype_size(pixtype);
+	data = rt_band_get_data(band);
+	if (data == NULL || pixbytes < 1) {
+		rterror("rt_polygonizer_new: Could not get band data");
+		return NULL;
+	}
+
+	poly = rtalloc(sizeof(struct rt_polygonizer_t));
+	if (poly == NULL) {
+		rterror("rt_polygonizer_new: Could not allocate memory for polygonizer");
+		return NULL;
+	}
+	memset(poly, 0, sizeof(struct rt_polygonizer_t));
+
+	poly->width = width;
+	poly->height = height;
+	poly->srid = rt_raster_get_srid(raster);
+	rt_raster_get_geotransform_matrix(raster, poly->gt);
+
+	poly->labels = rtalloc(sizeof(uint32_t) * (npixels + 1));
+	poly->visited = rtalloc(sizeof(uint8_t) * (npixels + 1));
+	poly->next = rtalloc(sizeof(uint32_t) * (npixels + 1));
+	stack = rtalloc(sizeof(uint32_t) * (npixels + 1));
+	if (
+		poly->labels == NULL || poly->visited == NULL ||
+		poly->next == NULL || stack == NULL
+	) {
+		rterror("rt_polygonizer_new: Could not allocate memory for pixel groups");
+		if (stack != NULL) rtdealloc(stack);
+		rt_polygonizer_destroy(poly);
+		return NULL;
+	}
+	memset(poly->labels, 0, sizeof(uint32_t) * npixels);
+	memset(poly->visited, 0, sizeof(uint8_t) * npixels);
+
+	/* group 4-connected pixels of same value, labels start at 1 */
+	for (i = 0; i < npixels; i++) {
+		if (poly->labels[i])
+			continue;
+
+		nlabels++;
+		poly->labels[i] = nlabels;
+		stack[0] = i;
+		nstack = 1;
+
+		while (nstack) {
+			idx = stack[--nstack];
+			x = idx % width;
+			y = idx / width;
+
+			for (n = 0; n < 4; n++) {
+				nx = x + _rti_polygonize_dx[n];
+				ny = y + _rti_polygonize_dy[n];
+				if (nx < 0 || nx >= width || ny < 0 || ny >= height)
+					continue;
+
+				j = nx + (ny * width);
+				if (poly->labels[j] || !_rti_polygonize_pixel_equal(
+					data + ((size_t) i * pixbytes), data + ((size_t) j * pixbytes),
+					pixtype, pixbytes
+				)) {
+					continue;
+				}
+
+				poly->labels[j] = nlabels;
+				stack[nstack++] = j;
+			}
+		}
+	}
+	rtdealloc(stack);
+
+	RASTER_DEBUGF(3, "%d groups of pixels", nlabels);
+
+	poly->nlabels = nlabels;
+	poly->head = rtalloc(sizeof(uint32_t) * (nlabels + 1));
+	poly->skip = rtalloc(sizeof(uint8_t) * (nlabels + 1));
+	poly->values = rtalloc(sizeof(double) * (nlabels + 1));
+	tail = rtalloc(sizeof(uint32_t) * (nlabels + 1));
+	if (
+		poly->head == NULL || poly->skip == NULL ||
+		poly->values == NULL || tail == NULL
+	) {
+		rterror("rt_polygonizer_new: Could not allocate memory for pixel groups");
+		if (tail != NULL) rtdealloc(tail);
+		rt_polygonizer_destroy(poly);
+		return NULL;
+	}
+
+	/*
+		labels are in scan order of first pixel. every ring of a group has
+		a pixel whose top edge is on the boundary, these pixels are linked
+		per group in scan order so that the first one starts the exterior
+	*/
+	for (i = 0, k = 0; i < npixels; i++) {
+		j = poly->labels[i];
+
+		if (j > k) {
+			k = j;
+			rt_band_get_pixel(band, i % width, i / width, &(poly->values[k]), &isnodata);
+
+			poly->skip[k] = 0;
+			if (exclude_nodata_value)
+				poly->skip[k] = (isnodata != 0);
+
+			if (!poly->skip[k])
+				poly->count++;
+
+			poly->head[k] = 0;
+			tail[k] = 0;
+		}
+
+		/* link is one-based, zero ends the list */
+		poly->next[i] = 0;
+		if (i >= (uint32_t) width && poly->labels[i - width] == j)
+			continue;
+
+		if (tail[j])
+			poly->next[tail[j] - 1] = i + 1;
+		else
+			poly->head[j] = i + 1;
+		tail[j] = i + 1;
+	}
+	rtdealloc(tail);
+
+	RASTER_DEBUGF(3, "%d polygons", poly->count);
+
+	poly->label = 0;
+
+	return poly;
+}
+
+/**
+ * Trace the polygon of the next group of pixels of a polygonizer.
+ * Groups are returned in scan order of their first pixel.
+ *
+ * @param poly : the polygonizer
+ * @param val : output parameter, value of the pixels of the group
+ *
+ * @return polygon of the group or NULL when all groups are returned
+ */
+LWPOLY *
+rt_polygonizer_next(rt_polygonizer poly, double *val) {
+	LWPOLY *geom = NULL;
+	uint32_t i = 0;
+
+	assert(NULL != poly);
+
+	do {
+		poly->label++;
+		if (poly->label > poly->nlabels)
+			return NULL;
+	}
+	while (poly->skip[poly->label]);
+
+	geom = lwpoly_construct_empty(poly->srid, 0, 0);
+
+	/* ring starts traced by earlier rings of the group are skipped */
+	for (i = poly->head[poly->label]; i; i = poly->next[i - 1]) {
+		if (poly->visited[i - 1])
+			continue;
+
+		lwpoly_add_ring(
+			geom,
+			_rti_polygonize_trace_ring(
+				poly->labels, poly->visited,
+				poly->width, poly->height,
+				(i - 1) % poly->width, (i - 1) / poly->width,
+				poly->gt
+			)
+		);
+	}
+
+	if (val != NULL)
+		*val = poly->values[poly->label];
+
+	return geom;
+}
+
+/**
+ * Destroy a polygonizer
+ *
+ * @param poly : the polygonizer to destroy
+ */
+void
+rt_polygonizer_destroy(rt_polygonizer poly) {
+	if (poly == NULL)
+		return;
+
+	if (poly->labels != NULL) rtdealloc(poly->labels);
+	if (poly->visited != NULL) rtdealloc(poly->visited);
+	if (poly->next != NULL) rtdealloc(poly->next);
+	if (poly->head != NULL) rtdealloc(poly->head);
+	if (poly->skip != NULL) rtdealloc(poly->skip);
+	if (poly->values != NULL) rtdealloc(poly->values);
+
+	rtdealloc(poly);
+}
+
+/**
+ * Returns a set of "geomval" value, one for each group of pixel
+ * sharing the same value for the provided band. Pixels are grouped
+ * if they share an edge (4-connected) as with GDALPolygonize(), but
+ * the polygons are traced from the band data without converting
+ * the raster to a GDAL dataset.
+ *
+ * @param raster : the raster to get info from.
+ * @param nband : the band to polygonize. 0-based
+ * @param exclude_nodata_value : if non-zero, ignore nodata values
+ * to check for pixels with value
+ * @param pnElements : output parameter, number of geomval returned
+ *
+ * @return A set of "geomval" values, one for each group of pixels
+ * sharing the same value for the provided band. The returned values are
+ * LWPOLY geometries.
+ */
+rt_geomval
+rt_raster_polygonize(
+	rt_raster raster, int nband,
+	int exclude_nodata_value,
+	int *pnElements
+) {
+	rt_polygonizer poly = NULL;
+	rt_geomval pols = NULL;
+	uint32_t i = 0;
+
+	/* checks */
+	assert(NULL != raster);
+	assert(NULL != pnElements);
+
+	RASTER_DEBUG(2, "In rt_raster_polygonize");
+
+	*pnElements = 0;
+
+	poly = rt_polygonizer_new(raster, nband, exclude_nodata_value);
+	if (poly == NULL)
+		return NULL;
+
+	pols = (rt_geomval) rtalloc(sizeof(struct rt_geomval_t) * (poly->count ? poly->count : 1));
+	if (pols == NULL) {
+		rterror("rt_raster_polygonize: Could not allocate memory for geomval set");
+		rt_polygonizer_destroy(poly);
+		return NULL;
+	}
+
+	for (i = 0; i < poly->count; i++)
+		pols[i].geom = rt_polygonizer_next(poly, &(pols[i].val));
+
+	*pnElements = poly->count;
+	rt_polygonizer_destroy(poly);
+
+	return pols;
+}
+
 /******************************************************************************
 * rt_raster_gdal_polygonize()
 ******************************************************************************/
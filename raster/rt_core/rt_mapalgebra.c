@@ -30,6 +30,9 @@
 #include "librtcore.h"
 #include "librtcore_internal.h"
 
+#include <ctype.h> /* for isdigit, isalpha */
+#include <math.h>
+
 /******************************************************************************
 * rt_band_reclass()
 ******************************************************************************/
@@ -1850,3 +1853,1085 @@ rt_raster rt_raster_colormap(
 
 	return rtnraster;
 }
+
+/******************************************************************************
+* rt_mapexpr_compile()
+******************************************************************************/
+
+/*
+	The map algebra expressions are plain SQL that rt_pg evaluates with SPI.
+	The arithmetic/conditional subset compiled here follows PostgreSQL's
+	type resolution so that the result is the same as the SQL result.
+	Anything outside that subset is left to SPI.
+*/
+
+/* type of a (sub)expression, ordered for numeric promotion */
+typedef enum {
+	_RTI_MAPEXPR_NULL = 0, /* untyped NULL literal */
+	_RTI_MAPEXPR_BOOL,
+	_RTI_MAPEXPR_INT, /* int4 */
+	_RTI_MAPEXPR_NUMERIC, /* decimal literal */
+	_RTI_MAPEXPR_FLOAT /* float8 */
+} _rti_mapexpr_type;
+
+typedef enum {
+	_RTI_MAPEXPR_OP_CONST = 0,
+	_RTI_MAPEXPR_OP_VAR,
+	_RTI_MAPEXPR_OP_NEG_INT,
+	_RTI_MAPEXPR_OP_NEG,
+	_RTI_MAPEXPR_OP_ADD_INT,
+	_RTI_MAPEXPR_OP_SUB_INT,
+	_RTI_MAPEXPR_OP_MUL_INT,
+	_RTI_MAPEXPR_OP_DIV_INT,
+	_RTI_MAPEXPR_OP_MOD_INT,
+	_RTI_MAPEXPR_OP_ADD,
+	_RTI_MAPEXPR_OP_SUB,
+	_RTI_MAPEXPR_OP_MUL,
+	_RTI_MAPEXPR_OP_DIV,
+	_RTI_MAPEXPR_OP_EQ,
+	_RTI_MAPEXPR_OP_NE,
+	_RTI_MAPEXPR_OP_LT,
+	_RTI_MAPEXPR_OP_LE,
+	_RTI_MAPEXPR_OP_GT,
+	_RTI_MAPEXPR_OP_GE,
+	_RTI_MAPEXPR_OP_AND,
+	_RTI_MAPEXPR_OP_OR,
+	_RTI_MAPEXPR_OP_NOT,
+	_RTI_MAPEXPR_OP_ISNULL,
+	_RTI_MAPEXPR_OP_ISNOTNULL,
+	_RTI_MAPEXPR_OP_ABS_INT,
+	_RTI_MAPEXPR_OP_ABS,
+	_RTI_MAPEXPR_OP_SQRT,
+	_RTI_MAPEXPR_OP_FLOOR,
+	_RTI_MAPEXPR_OP_CEIL,
+	_RTI_MAPEXPR_OP_LEAST,
+	_RTI_MAPEXPR_OP_GREATEST,
+	_RTI_MAPEXPR_OP_JUMP,
+	_RTI_MAPEXPR_OP_JUMPIFNOT
+} _rti_mapexpr_op;
+
+struct _rti_mapexpr_instr_t {
+	_rti_mapexpr_op op;
+	int arg; /* variable index, argument count or jump target */
+	int isnull; /* constant is NULL */
+	double val; /* constant value */
+};
+
+struct rt_mapexpr_t {
+	struct _rti_mapexpr_instr_t *instr;
+	int count;
+	int size;
+
+	/* evaluation stack */
+	int maxdepth;
+	double *values;
+	int *nulls;
+};
+
+typedef enum {
+	_RTI_MAPEXPR_TK_END = 0,
+	_RTI_MAPEXPR_TK_INVALID,
+	_RTI_MAPEXPR_TK_INT,
+	_RTI_MAPEXPR_TK_NUMERIC,
+	_RTI_MAPEXPR_TK_VAR,
+	_RTI_MAPEXPR_TK_IDENT,
+	_RTI_MAPEXPR_TK_OP,
+	_RTI_MAPEXPR_TK_LPAREN,
+	_RTI_MAPEXPR_TK_RPAREN,
+	_RTI_MAPEXPR_TK_COMMA
+} _rti_mapexpr_token;
+
+typedef struct _rti_mapexpr_parser_t* _rti_mapexpr_parser;
+struct _rti_mapexpr_parser_t {
+	const char *cur;
+
+	int kwcount;
+	char **kw;
+	const int *kwint;
+
+	/* current token */
+	_rti_mapexpr_token tok;
+	const char *tokstr;
+	int toklen;
+	double tokval;
+	int tokvar;
+
+	rt_mapexpr mexpr;
+	int depth;
+	int maxdepth;
+};
+
+static int
+_rti_mapexpr_is_opchar(char c) {
+	return (strchr("~!@#^&|`?+-*/%<>=", c) != NULL && c != '\0');
+}
+
+static void
+_rti_mapexpr_next(_rti_mapexpr_parser p) {
+	const char *s = p->cur;
+	int i = 0;
+
+	while (*s == ' ' || *s == '\t' || *s == '\n' || *s == '\r' || *s == '\f')
+		s++;
+
+	p->tokstr = s;
+	p->toklen = 1;
+
+	if (*s == '\0') {
+		p->tok = _RTI_MAPEXPR_TK_END;
+		p->toklen = 0;
+	}
+	else if (*s == '(')
+		p->tok = _RTI_MAPEXPR_TK_LPAREN;
+	else if (*s == ')')
+		p->tok = _RTI_MAPEXPR_TK_RPAREN;
+	else if (*s == ',')
+		p->tok = _RTI_MAPEXPR_TK_COMMA;
+	/* keyword such as [rast1.val] */
+	else if (*s == '[') {
+		p->tok = _RTI_MAPEXPR_TK_INVALID;
+		for (i = 0; i < p->kwcount; i++) {
+			int len = strlen(p->kw[i]);
+			if (strncmp(s, p->kw[i], len) == 0) {
+				p->tok = _RTI_MAPEXPR_TK_VAR;
+				p->tokvar = i;
+				p->toklen = len;
+				break;
+			}
+		}
+	}
+	/* number, same lexical rules as PostgreSQL */
+	else if (isdigit((unsigned char) *s) || (*s == '.' && isdigit((unsigned char) s[1]))) {
+		const char *e = s;
+		int isint = 1;
+
+		while (isdigit((unsigned char) *e)) e++;
+		if (*e == '.') {
+			isint = 0;
+			e++;
+			while (isdigit((unsigned char) *e)) e++;
+		}
+		if (*e == 'e' || *e == 'E') {
+			isint = 0;
+			e++;
+			if (*e == '+' || *e == '-') e++;
+			if (!isdigit((unsigned char) *e))
+				e = s;
+			while (isdigit((unsigned char) *e)) e++;
+		}
+
+		p->toklen = e - s;
+		if (e == s || isalnum((unsigned char) *e) || *e == '_' || *e == '.')
+			p->tok = _RTI_MAPEXPR_TK_INVALID;
+		else {
+			p->tokval = strtod(s, NULL);
+			if (!isint)
+				p->tok = _RTI_MAPEXPR_TK_NUMERIC;
+			/* larger integers are int8 or numeric */
+			else if (p->toklen > 10 || p->tokval > INT32_MAX)
+				p->tok = _RTI_MAPEXPR_TK_INVALID;
+			else
+				p->tok = _RTI_MAPEXPR_TK_INT;
+		}
+	}
+	else if (isalpha((unsigned char) *s) || *s == '_') {
+		const char *e = s;
+		while (isalnum((unsigned char) *e) || *e == '_' || *e == '$') e++;
+		p->tok = _RTI_MAPEXPR_TK_IDENT;
+		p->toklen = e - s;
+	}
+	else if (_rti_mapexpr_is_opchar(*s)) {
+		int trim = 1;
+		int len = 0;
+
+		while (_rti_mapexpr_is_opchar(s[len])) len++;
+
+		/* comments are not handled */
+		for (i = 0; i < len - 1; i++) {
+			if ((s[i] == '-' && s[i + 1] == '-') || (s[i] == '/' && s[i + 1] == '*'))
+				break;
+		}
+
+		if (i < len - 1)
+			p->tok = _RTI_MAPEXPR_TK_INVALID;
+		else {
+			/* multi-character operators cannot end in + or - unless they contain one of ~!@#%^&|`? */
+			for (i = 0; i < len; i++) {
+				if (strchr("~!@#%^&|`?", s[i]) != NULL) {
+					trim = 0;
+					break;
+				}
+			}
+			while (trim && len > 1 && (s[len - 1] == '+' || s[len - 1] == '-'))
+				len--;
+
+			p->tok = _RTI_MAPEXPR_TK_OP;
+			p->toklen = len;
+		}
+	}
+	else
+		p->tok = _RTI_MAPEXPR_TK_INVALID;
+
+	p->cur = s + p->toklen;
+}
+
+/* current token is the given operator or (case-insensitive) keyword */
+static int
+_rti_mapexpr_is(_rti_mapexpr_parser p, const char *str) {
+	int len = strlen(str);
+
+	if (p->toklen != len)
+		return 0;
+
+	if (p->tok == _RTI_MAPEXPR_TK_OP)
+		return strncmp(p->tokstr, str, len) == 0;
+	else if (p->tok == _RTI_MAPEXPR_TK_IDENT)
+		return strnicmp(p->tokstr, str, len) == 0;
+
+	return 0;
+}
+
+static int
+_rti_mapexpr_emit(_rti_mapexpr_parser p, _rti_mapexpr_op op, int arg, double val, int isnull) {
+	rt_mapexpr mexpr = p->mexpr;
+	struct _rti_mapexpr_instr_t *instr = NULL;
+
+	if (mexpr->count >= mexpr->size) {
+		mexpr->size *= 2;
+		mexpr->instr = rtrealloc(mexpr->instr, sizeof(struct _rti_mapexpr_instr_t) * mexpr->size);
+		if (mexpr->instr == NULL) {
+			rterror("_rti_mapexpr_emit: Could not reallocate memory for instructions");
+			return -1;
+		}
+	}
+
+	instr = &(mexpr->instr[mexpr->count]);
+	instr->op = op;
+	instr->arg = arg;
+	instr->val = val;
+	instr->isnull = isnull;
+
+	/* track depth of evaluation stack */
+	switch (op) {
+		case _RTI_MAPEXPR_OP_CONST:
+		case _RTI_MAPEXPR_OP_VAR:
+			p->depth++;
+			break;
+		case _RTI_MAPEXPR_OP_NEG_INT:
+		case _RTI_MAPEXPR_OP_NEG:
+		case _RTI_MAPEXPR_OP_NOT:
+		case _RTI_MAPEXPR_OP_ISNULL:
+		case _RTI_MAPEXPR_OP_ISNOTNULL:
+		case _RTI_MAPEXPR_OP_ABS_INT:
+		case _RTI_MAPEXPR_OP_ABS:
+		case _RTI_MAPEXPR_OP_SQRT:
+		case _RTI_MAPEXPR_OP_FLOOR:
+		case _RTI_MAPEXPR_OP_CEIL:
+		case _RTI_MAPEXPR_OP_JUMP:
+			break;
+		case _RTI_MAPEXPR_OP_LEAST:
+		case _RTI_MAPEXPR_OP_GREATEST:
+			p->depth -= arg - 1;
+			break;
+		default:
+			p->depth--;
+			break;
+	}
+	if (p->depth > p->maxdepth)
+		p->maxdepth = p->depth;
+
+	return mexpr->count++;
+}
+
+static int _rti_mapexpr_parse_expr(_rti_mapexpr_parser p);
+
+/* common type of arithmetic and comparison operands, -1 if not supported */
+static int
+_rti_mapexpr_operator_type(int t1, int t2) {
+	if (t1 == _RTI_MAPEXPR_BOOL || t2 == _RTI_MAPEXPR_BOOL)
+		return -1;
+	/* NULL op NULL is ambiguous */
+	else if (t1 == _RTI_MAPEXPR_NULL && t2 == _RTI_MAPEXPR_NULL)
+		return -1;
+	else if (t1 == _RTI_MAPEXPR_NULL)
+		return t2;
+	else if (t2 == _RTI_MAPEXPR_NULL)
+		return t1;
+	else if (t1 == _RTI_MAPEXPR_FLOAT || t2 == _RTI_MAPEXPR_FLOAT)
+		return _RTI_MAPEXPR_FLOAT;
+	else if (t1 == _RTI_MAPEXPR_INT && t2 == _RTI_MAPEXPR_INT)
+		return _RTI_MAPEXPR_INT;
+
+	/* numeric arithmetic is exact decimal in PostgreSQL */
+	return -1;
+}
+
+/* common type of CASE results and function arguments, -1 if not supported */
+static int
+_rti_mapexpr_common_type(int t1, int t2) {
+	if (t1 < 0 || t2 < 0)
+		return -1;
+	else if (t1 == _RTI_MAPEXPR_NULL)
+		return t2;
+	else if (t2 == _RTI_MAPEXPR_NULL)
+		return t1;
+	else if (t1 == _RTI_MAPEXPR_BOOL || t2 == _RTI_MAPEXPR_BOOL)
+		return (t1 == t2) ? t1 : -1;
+
+	return (t1 > t2) ? t1 : t2;
+}
+
+static int
+_rti_mapexpr_parse_function(_rti_mapexpr_parser p) {
+	const char *name = p->tokstr;
+	int len = p->toklen;
+	int type = _RTI_MAPEXPR_NULL;
+	int argtype = 0;
+	int nargs = 0;
+
+	_rti_mapexpr_next(p);
+	if (p->tok != _RTI_MAPEXPR_TK_LPAREN)
+		return -1;
+
+	do {
+		_rti_mapexpr_next(p);
+		argtype = _rti_mapexpr_parse_expr(p);
+		type = _rti_mapexpr_common_type(type, argtype);
+		if (type < 0)
+			return -1;
+		nargs++;
+	}
+	while (p->tok == _RTI_MAPEXPR_TK_COMMA);
+
+	if (p->tok != _RTI_MAPEXPR_TK_RPAREN)
+		return -1;
+	_rti_mapexpr_next(p);
+
+	if (len == 5 && strnicmp(name, "least", len) == 0) {
+		if (type == _RTI_MAPEXPR_BOOL || type == _RTI_MAPEXPR_NUMERIC)
+			return -1;
+		if (_rti_mapexpr_emit(p, _RTI_MAPEXPR_OP_LEAST, nargs, 0, 0) < 0)
+			return -1;
+		return type;
+	}
+	else if (len == 8 && strnicmp(name, "greatest", len) == 0) {
+		if (type == _RTI_MAPEXPR_BOOL || type == _RTI_MAPEXPR_NUMERIC)
+			return -1;
+		if (_rti_mapexpr_emit(p, _RTI_MAPEXPR_OP_GREATEST, nargs, 0, 0) < 0)
+			return -1;
+		return type;
+	}
+
+	/* single argument functions, NULL literal argument is ambiguous */
+	if (nargs != 1 || (type != _RTI_MAPEXPR_INT && type != _RTI_MAPEXPR_NUMERIC && type != _RTI_MAPEXPR_FLOAT))
+		return -1;
+
+	if (len == 3 && strnicmp(name, "abs", len) == 0) {
+		if (_rti_mapexpr_emit(p, (type == _RTI_MAPEXPR_INT) ? _RTI_MAPEXPR_OP_ABS_INT : _RTI_MAPEXPR_OP_ABS, 0, 0, 0) < 0)
+			return -1;
+		return type;
+	}
+
+	/* the numeric variants of these are not exact in double */
+	if (type == _RTI_MAPEXPR_NUMERIC)
+		return -1;
+
+	if (len == 4 && strnicmp(name, "sqrt", len) == 0) {
+		if (_rti_mapexpr_emit(p, _RTI_MAPEXPR_OP_SQRT, 0, 0, 0) < 0)
+			return -1;
+	}
+	else if (len == 5 && strnicmp(name, "floor", len) == 0) {
+		if (_rti_mapexpr_emit(p, _RTI_MAPEXPR_OP_FLOOR, 0, 0, 0) < 0)
+			return -1;
+	}
+	else if (
+		(len == 4 && strnicmp(name, "ceil", len) == 0) ||
+		(len == 7 && strnicmp(name, "ceiling", len) == 0)
+	) {
+		if (_rti_mapexpr_emit(p, _RTI_MAPEXPR_OP_CEIL, 0, 0, 0) < 0)
+			return -1;
+	}
+	else
+		return -1;
+
+	return _RTI_MAPEXPR_FLOAT;
+}
+
+static int
+_rti_mapexpr_parse_case(_rti_mapexpr_parser p) {
+	int type = _RTI_MAPEXPR_NULL;
+	int ttype = 0;
+	int depth = p->depth;
+	int jumps[256];
+	int njump = 0;
+	int cond = -1;
+	int i = 0;
+
+	/* CASE keyword consumed by caller, simple CASE not supported */
+	if (!_rti_mapexpr_is(p, "when"))
+		return -1;
+
+	while (_rti_mapexpr_is(p, "when")) {
+		_rti_mapexpr_next(p);
+		ttype = _rti_mapexpr_parse_expr(p);
+		if (ttype != _RTI_MAPEXPR_BOOL && ttype != _RTI_MAPEXPR_NULL)
+			return -1;
+		if ((cond = _rti_mapexpr_emit(p, _RTI_MAPEXPR_OP_JUMPIFNOT, 0, 0, 0)) < 0)
+			return -1;
+
+		if (!_rti_mapexpr_is(p, "then"))
+			return -1;
+		_rti_mapexpr_next(p);
+		ttype = _rti_mapexpr_parse_expr(p);
+		type = _rti_mapexpr_common_type(type, ttype);
+		if (type < 0)
+			return -1;
+
+		if (njump >= 256)
+			return -1;
+		if ((jumps[njump++] = _rti_mapexpr_emit(p, _RTI_MAPEXPR_OP_JUMP, 0, 0, 0)) < 0)
+			return -1;
+
+		/* next branch starts with the stack as before this one */
+		p->depth = depth;
+		p->mexpr->instr[cond].arg = p->mexpr->count;
+	}
+
+	if (_rti_mapexpr_is(p, "else")) {
+		_rti_mapexpr_next(p);
+		ttype = _rti_mapexpr_parse_expr(p);
+		type = _rti_mapexpr_common_type(type, ttype);
+		if (type < 0)
+			return -1;
+	}
+	else if (_rti_mapexpr_emit(p, _RTI_MAPEXPR_OP_CONST, 0, 0, 1) < 0)
+		return -1;
+
+	if (!_rti_mapexpr_is(p, "end"))
+		return -1;
+	_rti_mapexpr_next(p);
+
+	for (i = 0; i < njump; i++)
+		p->mexpr->instr[jumps[i]].arg = p->mexpr->count;
+
+	return type;
+}
+
+static int
+_rti_mapexpr_parse_primary(_rti_mapexpr_parser p) {
+	int type = -1;
+
+	switch (p->tok) {
+		case _RTI_MAPEXPR_TK_INT:
+		case _RTI_MAPEXPR_TK_NUMERIC:
+			type = (p->tok == _RTI_MAPEXPR_TK_INT) ? _RTI_MAPEXPR_INT : _RTI_MAPEXPR_NUMERIC;
+			if (_rti_mapexpr_emit(p, _RTI_MAPEXPR_OP_CONST, 0, p->tokval, 0) < 0)
+				return -1;
+			_rti_mapexpr_next(p);
+			return type;
+		case _RTI_MAPEXPR_TK_VAR:
+			type = p->kwint[p->tokvar] ? _RTI_MAPEXPR_INT : _RTI_MAPEXPR_FLOAT;
+			if (_rti_mapexpr_emit(p, _RTI_MAPEXPR_OP_VAR, p->tokvar, 0, 0) < 0)
+				return -1;
+			_rti_mapexpr_next(p);
+			return type;
+		case _RTI_MAPEXPR_TK_LPAREN:
+			_rti_mapexpr_next(p);
+			type = _rti_mapexpr_parse_expr(p);
+			if (type < 0 || p->tok != _RTI_MAPEXPR_TK_RPAREN)
+				return -1;
+			_rti_mapexpr_next(p);
+			return type;
+		case _RTI_MAPEXPR_TK_IDENT:
+			break;
+		default:
+			return -1;
+	}
+
+	if (_rti_mapexpr_is(p, "null")) {
+		if (_rti_mapexpr_emit(p, _RTI_MAPEXPR_OP_CONST, 0, 0, 1) < 0)
+			return -1;
+		_rti_mapexpr_next(p);
+		return _RTI_MAPEXPR_NULL;
+	}
+	else if (_rti_mapexpr_is(p, "true") || _rti_mapexpr_is(p, "false")) {
+		if (_rti_mapexpr_emit(p, _RTI_MAPEXPR_OP_CONST, 0, _rti_mapexpr_is(p, "true") ? 1 : 0, 0) < 0)
+			return -1;
+		_rti_mapexpr_next(p);
+		return _RTI_MAPEXPR_BOOL;
+	}
+	else if (_rti_mapexpr_is(p, "case")) {
+		_rti_mapexpr_next(p);
+		return _rti_mapexpr_parse_case(p);
+	}
+
+	return _rti_mapexpr_parse_function(p);
+}
+
+static int
+_rti_mapexpr_parse_unary(_rti_mapexpr_parser p) {
+	int type = -1;
+
+	if (_rti_mapexpr_is(p, "-")) {
+		_rti_mapexpr_next(p);
+		type = _rti_mapexpr_parse_unary(p);
+		if (type < 0 || type == _RTI_MAPEXPR_BOOL || type == _RTI_MAPEXPR_NULL)
+			return -1;
+		if (_rti_mapexpr_emit(p, (type == _RTI_MAPEXPR_INT) ? _RTI_MAPEXPR_OP_NEG_INT : _RTI_MAPEXPR_OP_NEG, 0, 0, 0) < 0)
+			return -1;
+		return type;
+	}
+	else if (_rti_mapexpr_is(p, "+")) {
+		_rti_mapexpr_next(p);
+		type = _rti_mapexpr_parse_unary(p);
+		if (type == _RTI_MAPEXPR_BOOL || type == _RTI_MAPEXPR_NULL)
+			return -1;
+		return type;
+	}
+
+	return _rti_mapexpr_parse_primary(p);
+}
+
+static int
+_rti_mapexpr_parse_term(_rti_mapexpr_parser p) {
+	int type = _rti_mapexpr_parse_unary(p);
+	int rtype = 0;
+	_rti_mapexpr_op op;
+
+	while (type >= 0 && (_rti_mapexpr_is(p, "*") || _rti_mapexpr_is(p, "/") || _rti_mapexpr_is(p, "%"))) {
+		char opchar = *(p->tokstr);
+
+		_rti_mapexpr_next(p);
+		rtype = _rti_mapexpr_parse_unary(p);
+		if (rtype < 0)
+			return -1;
+
+		type = _rti_mapexpr_operator_type(type, rtype);
+		if (type < 0)
+			return -1;
+
+		if (opchar == '*')
+			op = (type == _RTI_MAPEXPR_INT) ? _RTI_MAPEXPR_OP_MUL_INT : _RTI_MAPEXPR_OP_MUL;
+		else if (opchar == '/')
+			op = (type == _RTI_MAPEXPR_INT) ? _RTI_MAPEXPR_OP_DIV_INT : _RTI_MAPEXPR_OP_DIV;
+		/* there is no float8 modulo */
+		else if (type == _RTI_MAPEXPR_INT)
+			op = _RTI_MAPEXPR_OP_MOD_INT;
+		else
+			return -1;
+
+		if (_rti_mapexpr_emit(p, op, 0, 0, 0) < 0)
+			return -1;
+	}
+
+	return type;
+}
+
+static int
+_rti_mapexpr_parse_sum(_rti_mapexpr_parser p) {
+	int type = _rti_mapexpr_parse_term(p);
+	int rtype = 0;
+	_rti_mapexpr_op op;
+
+	while (type >= 0 && (_rti_mapexpr_is(p, "+") || _rti_mapexpr_is(p, "-"))) {
+		char opchar = *(p->tokstr);
+
+		_rti_mapexpr_next(p);
+		rtype = _rti_mapexpr_parse_term(p);
+		if (rtype < 0)
+			return -1;
+
+		type = _rti_mapexpr_operator_type(type, rtype);
+		if (type < 0)
+			return -1;
+
+		if (opchar == '+')
+			op = (type == _RTI_MAPEXPR_INT) ? _RTI_MAPEXPR_OP_ADD_INT : _RTI_MAPEXPR_OP_ADD;
+		else
+			op = (type == _RTI_MAPEXPR_INT) ? _RTI_MAPEXPR_OP_SUB_INT : _RTI_MAPEXPR_OP_SUB;
+
+		if (_rti_mapexpr_emit(p, op, 0, 0, 0) < 0)
+			return -1;
+	}
+
+	return type;
+}
+
+static int
+_rti_mapexpr_parse_comparison(_rti_mapexpr_parser p) {
+	int type = _rti_mapexpr_parse_sum(p);
+	int rtype = 0;
+	_rti_mapexpr_op op;
+
+	if (type < 0)
+		return -1;
+
+	if (_rti_mapexpr_is(p, "="))
+		op = _RTI_MAPEXPR_OP_EQ;
+	else if (_rti_mapexpr_is(p, "<>") || _rti_mapexpr_is(p, "!="))
+		op = _RTI_MAPEXPR_OP_NE;
+	else if (_rti_mapexpr_is(p, "<"))
+		op = _RTI_MAPEXPR_OP_LT;
+	else if (_rti_mapexpr_is(p, "<="))
+		op = _RTI_MAPEXPR_OP_LE;
+	else if (_rti_mapexpr_is(p, ">"))
+		op = _RTI_MAPEXPR_OP_GT;
+	else if (_rti_mapexpr_is(p, ">="))
+		op = _RTI_MAPEXPR_OP_GE;
+	else
+		return type;
+
+	_rti_mapexpr_next(p);
+	rtype = _rti_mapexpr_parse_sum(p);
+	if (rtype < 0)
+		return -1;
+
+	/* numeric and int4 are compared as numeric */
+	type = _rti_mapexpr_operator_type(type, rtype);
+	if (type < 0)
+		return -1;
+
+	if (_rti_mapexpr_emit(p, op, 0, 0, 0) < 0)
+		return -1;
+
+	return _RTI_MAPEXPR_BOOL;
+}
+
+static int
+_rti_mapexpr_parse_is(_rti_mapexpr_parser p) {
+	int type = _rti_mapexpr_parse_comparison(p);
+	_rti_mapexpr_op op;
+
+	while (type >= 0 && _rti_mapexpr_is(p, "is")) {
+		_rti_mapexpr_next(p);
+
+		op = _RTI_MAPEXPR_OP_ISNULL;
+		if (_rti_mapexpr_is(p, "not")) {
+			op = _RTI_MAPEXPR_OP_ISNOTNULL;
+			_rti_mapexpr_next(p);
+		}
+
+		/* IS TRUE, IS DISTINCT FROM... */
+		if (!_rti_mapexpr_is(p, "null"))
+			return -1;
+		_rti_mapexpr_next(p);
+
+		if (_rti_mapexpr_emit(p, op, 0, 0, 0) < 0)
+			return -1;
+		type = _RTI_MAPEXPR_BOOL;
+	}
+
+	return type;
+}
+
+static int
+_rti_mapexpr_parse_not(_rti_mapexpr_parser p) {
+	int type = -1;
+
+	if (!_rti_mapexpr_is(p, "not"))
+		return _rti_mapexpr_parse_is(p);
+
+	_rti_mapexpr_next(p);
+	type = _rti_mapexpr_parse_not(p);
+	if (type != _RTI_MAPEXPR_BOOL && type != _RTI_MAPEXPR_NULL)
+		return -1;
+
+	if (_rti_mapexpr_emit(p, _RTI_MAPEXPR_OP_NOT, 0, 0, 0) < 0)
+		return -1;
+
+	return _RTI_MAPEXPR_BOOL;
+}
+
+static int
+_rti_mapexpr_parse_and(_rti_mapexpr_parser p) {
+	int type = _rti_mapexpr_parse_not(p);
+	int rtype = 0;
+
+	while (type >= 0 && _rti_mapexpr_is(p, "and")) {
+		if (type != _RTI_MAPEXPR_BOOL && type != _RTI_MAPEXPR_NULL)
+			return -1;
+
+		_rti_mapexpr_next(p);
+		rtype = _rti_mapexpr_parse_not(p);
+		if (rtype != _RTI_MAPEXPR_BOOL && rtype != _RTI_MAPEXPR_NULL)
+			return -1;
+
+		if (_rti_mapexpr_emit(p, _RTI_MAPEXPR_OP_AND, 0, 0, 0) < 0)
+			return -1;
+		type = _RTI_MAPEXPR_BOOL;
+	}
+
+	return type;
+}
+
+static int
+_rti_mapexpr_parse_expr(_rti_mapexpr_parser p) {
+	int type = _rti_mapexpr_parse_and(p);
+	int rtype = 0;
+
+	while (type >= 0 && _rti_mapexpr_is(p, "or")) {
+		if (type != _RTI_MAPEXPR_BOOL && type != _RTI_MAPEXPR_NULL)
+			return -1;
+
+		_rti_mapexpr_next(p);
+		rtype = _rti_mapexpr_parse_and(p);
+		if (rtype != _RTI_MAPEXPR_BOOL && rtype != _RTI_MAPEXPR_NULL)
+			return -1;
+
+		if (_rti_mapexpr_emit(p, _RTI_MAPEXPR_OP_OR, 0, 0, 0) < 0)
+			return -1;
+		type = _RTI_MAPEXPR_BOOL;
+	}
+
+	return type;
+}
+
+/**
+ * Compile a map algebra expression for evaluation without SQL.
+ * Only the arithmetic/conditional subset of SQL is supported:
+ * numeric literals, NULL, TRUE, FALSE, keywords, + - * / %,
+ * comparisons, AND, OR, NOT, IS [NOT] NULL, CASE WHEN,
+ * abs(), sqrt(), floor(), ceil(), least() and greatest().
+ * The result of the compiled expression is the same as the result
+ * of "SELECT (expr)::double precision".
+ *
+ * @param expr : the expression
+ * @param kw : keywords (e.g. "[rast1.val]") usable as variables
+ * @param kwint : for each keyword, non-zero if the variable is int4.
+ * Otherwise, the variable is double precision
+ * @param kwcount : number of elements in kw and kwint
+ *
+ * @return compiled expression or NULL if the expression is not
+ * supported and must be evaluated by other means
+ */
+rt_mapexpr
+rt_mapexpr_compile(
+	const char *expr,
+	char **kw, const int *kwint, int kwcount
+) {
+	struct _rti_mapexpr_parser_t parser;
+	rt_mapexpr mexpr = NULL;
+	int type = -1;
+
+	assert(expr != NULL);
+
+	mexpr = rtalloc(sizeof(struct rt_mapexpr_t));
+	if (mexpr == NULL) {
+		rterror("rt_mapexpr_compile: Could not allocate memory for compiled expression");
+		return NULL;
+	}
+	mexpr->count = 0;
+	mexpr->size = 16;
+	mexpr->maxdepth = 0;
+	mexpr->values = NULL;
+	mexpr->nulls = NULL;
+	mexpr->instr = rtalloc(sizeof(struct _rti_mapexpr_instr_t) * mexpr->size);
+	if (mexpr->instr == NULL) {
+		rterror("rt_mapexpr_compile: Could not allocate memory for instructions");
+		rtdealloc(mexpr);
+		return NULL;
+	}
+
+	memset(&parser, 0, sizeof(struct _rti_mapexpr_parser_t));
+	parser.cur = expr;
+	parser.kw = kw;
+	parser.kwint = kwint;
+	parser.kwcount = kwcount;
+	parser.mexpr = mexpr;
+
+	_rti_mapexpr_next(&parser);
+	type = _rti_mapexpr_parse_expr(&parser);
+
+	/* boolean cannot be cast to double precision */
+	if (
+		type < 0 || type == _RTI_MAPEXPR_BOOL ||
+		parser.tok != _RTI_MAPEXPR_TK_END || mexpr->instr == NULL
+	) {
+		RASTER_DEBUGF(3, "Expression not supported by compiler: %s", expr);
+		rt_mapexpr_destroy(mexpr);
+		return NULL;
+	}
+
+	mexpr->maxdepth = parser.maxdepth;
+	mexpr->values = rtalloc(sizeof(double) * mexpr->maxdepth);
+	mexpr->nulls = rtalloc(sizeof(int) * mexpr->maxdepth);
+	if (mexpr->values == NULL || mexpr->nulls == NULL) {
+		rterror("rt_mapexpr_compile: Could not allocate memory for evaluation stack");
+		rt_mapexpr_destroy(mexpr);
+		return NULL;
+	}
+
+	RASTER_DEBUGF(3, "Compiled expression %s into %d instructions", expr, mexpr->count);
+
+	return mexpr;
+}
+
+/**
+ * Evaluate a compiled map algebra expression
+ *
+ * @param mexpr : compiled expression
+ * @param values : values of the keywords, in the order passed to
+ * rt_mapexpr_compile()
+ * @param nulls : for each keyword, non-zero if the value is NULL
+ * @param value : result of the expression
+ * @param isnull : non-zero if the result is NULL
+ *
+ * @return ES_NONE on success. ES_ERROR if the values lead to a condition
+ * that the compiled expression does not handle (e.g. division by zero
+ * or overflow), in which case the expression must be evaluated by
+ * other means for these values
+ */
+rt_errorstate
+rt_mapexpr_eval(
+	rt_mapexpr mexpr,
+	const double *values, const int *nulls,
+	double *value, int *isnull
+) {
+	struct _rti_mapexpr_instr_t *instr = NULL;
+	double *v = mexpr->values;
+	int *n = mexpr->nulls;
+	int sp = -1;
+	int pc = 0;
+	int i = 0;
+	double a = 0;
+	double b = 0;
+	double r = 0;
+
+	while (pc < mexpr->count) {
+		instr = &(mexpr->instr[pc++]);
+
+		switch (instr->op) {
+			case _RTI_MAPEXPR_OP_CONST:
+				sp++;
+				v[sp] = instr->val;
+				n[sp] = instr->isnull;
+				continue;
+			case _RTI_MAPEXPR_OP_VAR:
+				sp++;
+				v[sp] = values[instr->arg];
+				n[sp] = nulls[instr->arg];
+				if (!n[sp] && !isfinite(v[sp]))
+					return ES_ERROR;
+				continue;
+			case _RTI_MAPEXPR_OP_JUMP:
+				pc = instr->arg;
+				continue;
+			case _RTI_MAPEXPR_OP_JUMPIFNOT:
+				if (n[sp] || v[sp] == 0)
+					pc = instr->arg;
+				sp--;
+				continue;
+			case _RTI_MAPEXPR_OP_ISNULL:
+				v[sp] = n[sp] ? 1 : 0;
+				n[sp] = 0;
+				continue;
+			case _RTI_MAPEXPR_OP_ISNOTNULL:
+				v[sp] = n[sp] ? 0 : 1;
+				n[sp] = 0;
+				continue;
+			case _RTI_MAPEXPR_OP_AND:
+				sp--;
+				if ((!n[sp] && v[sp] == 0) || (!n[sp + 1] && v[sp + 1] == 0)) {
+					v[sp] = 0;
+					n[sp] = 0;
+				}
+				else
+					n[sp] = n[sp] || n[sp + 1];
+				continue;
+			case _RTI_MAPEXPR_OP_OR:
+				sp--;
+				if ((!n[sp] && v[sp] != 0) || (!n[sp + 1] && v[sp + 1] != 0)) {
+					v[sp] = 1;
+					n[sp] = 0;
+				}
+				else
+					n[sp] = n[sp] || n[sp + 1];
+				continue;
+			case _RTI_MAPEXPR_OP_LEAST:
+			case _RTI_MAPEXPR_OP_GREATEST:
+			{
+				int hasval = 0;
+
+				/* NULL arguments are ignored */
+				sp -= instr->arg - 1;
+				for (i = 0; i < instr->arg; i++) {
+					if (n[sp + i])
+						continue;
+					if (
+						!hasval ||
+						(instr->op == _RTI_MAPEXPR_OP_LEAST && v[sp + i] < r) ||
+						(instr->op == _RTI_MAPEXPR_OP_GREATEST && v[sp + i] > r)
+					) {
+						r = v[sp + i];
+						hasval = 1;
+					}
+				}
+				v[sp] = r;
+				n[sp] = !hasval;
+				continue;
+			}
+			default:
+				break;
+		}
+
+		/* unary operators and functions */
+		if (instr->op >= _RTI_MAPEXPR_OP_NEG_INT && instr->op <= _RTI_MAPEXPR_OP_NEG) {
+			if (!n[sp]) {
+				if (instr->op == _RTI_MAPEXPR_OP_NEG_INT && v[sp] == INT32_MIN)
+					return ES_ERROR;
+				v[sp] = -v[sp];
+			}
+			continue;
+		}
+		else if (instr->op == _RTI_MAPEXPR_OP_NOT) {
+			if (!n[sp])
+				v[sp] = (v[sp] == 0) ? 1 : 0;
+			continue;
+		}
+		else if (instr->op >= _RTI_MAPEXPR_OP_ABS_INT && instr->op <= _RTI_MAPEXPR_OP_CEIL) {
+			if (n[sp])
+				continue;
+
+			switch (instr->op) {
+				case _RTI_MAPEXPR_OP_ABS_INT:
+					if (v[sp] == INT32_MIN)
+						return ES_ERROR;
+					v[sp] = fabs(v[sp]);
+					break;
+				case _RTI_MAPEXPR_OP_ABS:
+					v[sp] = fabs(v[sp]);
+					break;
+				case _RTI_MAPEXPR_OP_SQRT:
+					if (v[sp] < 0)
+						return ES_ERROR;
+					v[sp] = sqrt(v[sp]);
+					break;
+				case _RTI_MAPEXPR_OP_FLOOR:
+					v[sp] = floor(v[sp]);
+					break;
+				case _RTI_MAPEXPR_OP_CEIL:
+					v[sp] = ceil(v[sp]);
+					break;
+				default:
+					break;
+			}
+			continue;
+		}
+
+		/* binary operators are strict */
+		sp--;
+		if (n[sp] || n[sp + 1]) {
+			n[sp] = 1;
+			continue;
+		}
+		a = v[sp];
+		b = v[sp + 1];
+
+		switch (instr->op) {
+			case _RTI_MAPEXPR_OP_ADD_INT:
+				r = a + b;
+				break;
+			case _RTI_MAPEXPR_OP_SUB_INT:
+				r = a - b;
+				break;
+			case _RTI_MAPEXPR_OP_MUL_INT:
+				r = a * b;
+				break;
+			case _RTI_MAPEXPR_OP_DIV_INT:
+				if (b == 0)
+					return ES_ERROR;
+				if (b == -1)
+					r = -a;
+				else
+					r = (int32_t) a / (int32_t) b;
+				break;
+			case _RTI_MAPEXPR_OP_MOD_INT:
+				if (b == 0)
+					return ES_ERROR;
+				if (b == -1)
+					r = 0;
+				else
+					r = (int32_t) a % (int32_t) b;
+				break;
+			case _RTI_MAPEXPR_OP_ADD:
+				r = a + b;
+				break;
+			case _RTI_MAPEXPR_OP_SUB:
+				r = a - b;
+				break;
+			case _RTI_MAPEXPR_OP_MUL:
+				r = a * b;
+				/* underflow */
+				if (r == 0 && a != 0 && b != 0)
+					return ES_ERROR;
+				break;
+			case _RTI_MAPEXPR_OP_DIV:
+				if (b == 0)
+					return ES_ERROR;
+				r = a / b;
+				/* underflow */
+				if (r == 0 && a != 0)
+					return ES_ERROR;
+				break;
+			case _RTI_MAPEXPR_OP_EQ:
+				r = (a == b);
+				break;
+			case _RTI_MAPEXPR_OP_NE:
+				r = (a != b);
+				break;
+			case _RTI_MAPEXPR_OP_LT:
+				r = (a < b);
+				break;
+			case _RTI_MAPEXPR_OP_LE:
+				r = (a <= b);
+				break;
+			case _RTI_MAPEXPR_OP_GT:
+				r = (a > b);
+				break;
+			case _RTI_MAPEXPR_OP_GE:
+				r = (a >= b);
+				break;
+			default:
+				rterror("rt_mapexpr_eval: Unknown instruction %d", instr->op);
+				return ES_ERROR;
+		}
+
+		/* int4 overflow */
+		if (
+			instr->op >= _RTI_MAPEXPR_OP_ADD_INT && instr->op <= _RTI_MAPEXPR_OP_MOD_INT &&
+			(r > INT32_MAX || r < INT32_MIN)
+		) {
+			return ES_ERROR;
+		}
+		/* float8 overflow */
+		else if (!isfinite(r))
+			return ES_ERROR;
+
+		v[sp] = r;
+	}
+
+	*isnull = n[0];
+	*value = n[0] ? 0 : v[0];
+
+	return ES_NONE;
+}
+
+/**
+ * Free a compiled map algebra expression
+ *
+ * @param mexpr : compiled expression to free
+ */
+void
+rt_mapexpr_destroy(rt_mapexpr mexpr) {
+	if (mexpr == NULL)
+		return;
+
+	if (mexpr->instr != NULL)
+		rtdealloc(mexpr->instr);
+	if (mexpr->values != NULL)
+		rtdealloc(mexpr->values);
+	if (mexpr->nulls != NULL)
+		rtdealloc(mexpr->nulls);
+
+	rtdealloc(mexpr);
+}
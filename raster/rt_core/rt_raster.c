@@ -2392,6 +2392,689 @@ rt_raster_from_gdal_dataset(GDALDatasetH ds) {
 	return rast;
 }
 
+/******************************************************************************
+* rt_raster_scan_polygon()
+******************************************************************************/
+
+/* edge of polygon in raster space, y0 < y1 */
+typedef struct {
+	double x0;
+	double y0;
+	double x1;
+	double y1;
+} _rti_scan_edge;
+
+static int
+_rti_scan_edge_cmp(const void *a, const void *b) {
+	const _rti_scan_edge *ea = (const _rti_scan_edge *) a;
+	const _rti_scan_edge *eb = (const _rti_scan_edge *) b;
+
+	if (ea->y0 < eb->y0) return -1;
+	if (ea->y0 > eb->y0) return 1;
+	return 0;
+}
+
+static uint32_t
+_rti_scan_add_edges(
+	LWPOLY *poly, double *igt,
+	_rti_scan_edge *edges, uint32_t nedges
+) {
+	uint32_t i = 0;
+	uint32_t j = 0;
+	POINT2D p;
+	double x0 = 0;
+	double y0 = 0;
+	double x1 = 0;
+	double y1 = 0;
+
+	for (i = 0; i < poly->nrings; i++) {
+		POINTARRAY *pa = poly->rings[i];
+
+		for (j = 0; j < pa->npoints; j++) {
+			getPoint2d_p(pa, j, &p);
+			x1 = igt[0] + (p.x * igt[1]) + (p.y * igt[2]);
+			y1 = igt[3] + (p.x * igt[4]) + (p.y * igt[5]);
+
+			/* horizontal edges never cross a scanline */
+			if (j > 0 && y0 != y1) {
+				if (y0 < y1) {
+					edges[nedges].x0 = x0;
+					edges[nedges].y0 = y0;
+					edges[nedges].x1 = x1;
+					edges[nedges].y1 = y1;
+				}
+				else {
+					edges[nedges].x0 = x1;
+					edges[nedges].y0 = y1;
+					edges[nedges].x1 = x0;
+					edges[nedges].y1 = y0;
+				}
+				nedges++;
+			}
+
+			x0 = x1;
+			y0 = y1;
+		}
+	}
+
+	return nedges;
+}
+
+/**
+ * Call a function for each run of pixels of a raster whose centers
+ * are inside a polygonal geometry.  This is the rule used by GDAL's
+ * rasterizer when not burning all touched pixels.  Rings of all
+ * polygons are combined with the even-odd rule.
+ *
+ * @param raster : the raster whose grid the geometry is scanned against
+ * @param geom : POLYGON or MULTIPOLYGON in the raster's coordinates
+ * @param callback : function called with callback's arg, the row,
+ *   the first column and the number of columns of each run.
+ *   Scanning stops if the function does not return ES_NONE
+ * @param arg : argument passed to callback
+ *
+ * @return ES_NONE on success, ES_ERROR on error
+ */
+rt_errorstate
+rt_raster_scan_polygon(
+	rt_raster raster, const LWGEOM *geom,
+	rt_errorstate (*callback)(void *arg, int y, int x, int count),
+	void *arg
+) {
+	double igt[6] = {0};
+	_rti_scan_edge *edges = NULL;
+	uint32_t nedges = 0;
+	uint32_t maxedges = 0;
+	double *xs = NULL;
+	uint32_t nxs = 0;
+	uint32_t first = 0;
+	uint32_t i = 0;
+	uint32_t j = 0;
+	int y = 0;
+	int ymin = 0;
+	int ymax = 0;
+	int x0 = 0;
+	int x1 = 0;
+	double dy = 0;
+	double tmp = 0;
+	rt_errorstate err = ES_NONE;
+	LWMPOLY *mpoly = NULL;
+
+	assert(NULL != raster);
+	assert(NULL != geom);
+	assert(NULL != callback);
+
+	if (lwgeom_is_empty(geom) || !raster->width || !raster->height)
+		return ES_NONE;
+
+	if (rt_raster_get_inverse_geotransform_matrix(raster, NULL, igt) != ES_NONE) {
+		rterror("rt_raster_scan_polygon: Could not get inverse geotransform matrix");
+		return ES_ERROR;
+	}
+
+	/* count edges */
+	switch (geom->type) {
+		case POLYGONTYPE:
+			for (i = 0; i < ((LWPOLY *) geom)->nrings; i++)
+				maxedges += ((LWPOLY *) geom)->rings[i]->npoints;
+			break;
+		case MULTIPOLYGONTYPE:
+			mpoly = (LWMPOLY *) geom;
+			for (j = 0; j < mpoly->ngeoms; j++) {
+				for (i = 0; i < mpoly->geoms[j]->nrings; i++)
+					maxedges += mpoly->geoms[j]->rings[i]->npoints;
+			}
+			break;
+		default:
+			rterror("rt_raster_scan_polygon: Geometry must be a POLYGON or MULTIPOLYGON");
+			return ES_ERROR;
+	}
+
+	edges = rtalloc(sizeof(_rti_scan_edge) * maxedges);
+	xs = rtalloc(sizeof(double) * maxedges);
+	if (edges == NULL || xs == NULL) {
+		rterror("rt_raster_scan_polygon: Could not allocate memory for polygon edges");
+		if (edges != NULL) rtdealloc(edges);
+		if (xs != NULL) rtdealloc(xs);
+		return ES_ERROR;
+	}
+
+	/* edges in raster space */
+	if (mpoly == NULL)
+		nedges = _rti_scan_add_edges((LWPOLY *) geom, igt, edges, 0);
+	else {
+		for (j = 0; j < mpoly->ngeoms; j++)
+			nedges = _rti_scan_add_edges(mpoly->geoms[j], igt, edges, nedges);
+	}
+
+	if (!nedges) {
+		rtdealloc(edges);
+		rtdealloc(xs);
+		return ES_NONE;
+	}
+
+	qsort(edges, nedges, sizeof(_rti_scan_edge), _rti_scan_edge_cmp);
+
+	/* rows spanned by polygon */
+	ymin = (int) floor(edges[0].y0);
+	ymax = ymin;
+	for (i = 0; i < nedges; i++) {
+		if (edges[i].y1 > ymax)
+			ymax = (int) floor(edges[i].y1);
+	}
+	if (ymin < 0) ymin = 0;
+	if (ymax >= raster->height) ymax = raster->height - 1;
+
+	for (y = ymin; y <= ymax && err == ES_NONE; y++) {
+		dy = y + 0.5;
+
+		/* edges are sorted by lower y, skip leading edges ending above scanline */
+		while (first < nedges && edges[first].y1 <= dy)
+			first++;
+
+		/* crossings of scanline */
+		nxs = 0;
+		for (i = first; i < nedges && edges[i].y0 <= dy; i++) {
+			if (dy < edges[i].y1 && dy >= edges[i].y0) {
+				tmp = (dy - edges[i].y0) * (edges[i].x1 - edges[i].x0) / (edges[i].y1 - edges[i].y0) + edges[i].x0;
+
+				/* insertion sort, crossings are few */
+				for (j = nxs; j > 0 && xs[j - 1] > tmp; j--)
+					xs[j] = xs[j - 1];
+				xs[j] = tmp;
+				nxs++;
+			}
+		}
+
+		/* runs of pixels with center between pairs of crossings */
+		for (i = 0; i + 1 < nxs; i += 2) {
+			x0 = (int) floor(xs[i] + 0.5);
+			x1 = (int) floor(xs[i + 1] + 0.5);
+
+			if (x0 < 0) x0 = 0;
+			if (x1 > raster->width) x1 = raster->width;
+			if (x1 <= x0)
+				continue;
+
+			err = callback(arg, y, x0, x1 - x0);
+			if (err != ES_NONE)
+				break;
+		}
+	}
+
+	rtdealloc(edges);
+	rtdealloc(xs);
+
+	return err;
+}
+
+/******************************************************************************
+* rt_raster_scan_line()
+******************************************************************************/
+
+static rt_errorstate
+_rti_scan_linestring(
+	rt_raster raster, LWLINE *line, double *igt,
+	rt_errorstate (*callback)(void *arg, int y, int x, int count),
+	void *arg
+) {
+	POINTARRAY *pa = line->points;
+	POINT2D p;
+	uint32_t j = 0;
+	int x = 0;
+	int y = 0;
+	int x1 = 0;
+	int y1 = 0;
+	int dx = 0;
+	int dy = 0;
+	int xstep = 0;
+	int ystep = 0;
+	int err0 = 0;
+	int err1 = 0;
+	int error = 0;
+	int steps = 0;
+	rt_errorstate err = ES_NONE;
+
+	if (pa == NULL || pa->npoints < 2)
+		return ES_NONE;
+
+	/* first vertex */
+	getPoint2d_p(pa, 0, &p);
+	x1 = (int) floor(igt[0] + (p.x * igt[1]) + (p.y * igt[2]));
+	y1 = (int) floor(igt[3] + (p.x * igt[4]) + (p.y * igt[5]));
+
+	for (j = 1; j < pa->npoints; j++) {
+		x = x1;
+		y = y1;
+
+		getPoint2d_p(pa, j, &p);
+		x1 = (int) floor(igt[0] + (p.x * igt[1]) + (p.y * igt[2]));
+		y1 = (int) floor(igt[3] + (p.x * igt[4]) + (p.y * igt[5]));
+
+		dx = abs(x1 - x);
+		dy = abs(y1 - y);
+		xstep = (x > x1) ? -1 : 1;
+		ystep = (y > y1) ? -1 : 1;
+
+		/* both ends of each segment are burned, stepping along the major axis */
+		if (dx >= dy) {
+			err0 = dy << 1;
+			err1 = err0 - (dx << 1);
+			error = err0 - dx;
+			steps = dx;
+		}
+		else {
+			err0 = dx << 1;
+			err1 = err0 - (dy << 1);
+			error = err0 - dy;
+			steps = dy;
+		}
+
+		for (; steps >= 0; steps--) {
+			if (x >= 0 && x < raster->width && y >= 0 && y < raster->height) {
+				err = callback(arg, y, x, 1);
+				if (err != ES_NONE)
+					return err;
+			}
+
+			if (dx >= dy) {
+				x += xstep;
+				if (error > 0) {
+					y += ystep;
+					error += err1;
+				}
+				else
+					error += err0;
+			}
+			else {
+				y += ystep;
+				if (error > 0) {
+					x += xstep;
+					error += err1;
+				}
+				else
+					error += err0;
+			}
+		}
+	}
+
+	return ES_NONE;
+}
+
+/**
+ * Call a function for each pixel of a raster on a linear geometry.
+ * This is the rule used by GDAL's rasterizer when not burning all
+ * touched pixels: each segment is drawn with Bresenham's algorithm
+ * between the pixels of its ends.
+ *
+ * @param raster : the raster whose grid the geometry is scanned against
+ * @param geom : LINESTRING or MULTILINESTRING in the raster's coordinates
+ * @param callback : function called with callback's arg, the row,
+ *   the column and 1 for each pixel.  A pixel may be passed more than
+ *   once.  Scanning stops if the function does not return ES_NONE
+ * @param arg : argument passed to callback
+ *
+ * @return ES_NONE on success, ES_ERROR on error
+ */
+rt_errorstate
+rt_raster_scan_line(
+	rt_raster raster, const LWGEOM *geom,
+	rt_errorstate (*callback)(void *arg, int y, int x, int count),
+	void *arg
+) {
+	double igt[6] = {0};
+	LWMLINE *mline = NULL;
+	uint32_t i = 0;
+	rt_errorstate err = ES_NONE;
+
+	assert(NULL != raster);
+	assert(NULL != geom);
+	assert(NULL != callback);
+
+	if (lwgeom_is_empty(geom) || !raster->width || !raster->height)
+		return ES_NONE;
+
+	if (rt_raster_get_inverse_geotransform_matrix(raster, NULL, igt) != ES_NONE) {
+		rterror("rt_raster_scan_line: Could not get inverse geotransform matrix");
+		return ES_ERROR;
+	}
+
+	switch (geom->type) {
+		case LINETYPE:
+			return _rti_scan_linestring(raster, (LWLINE *) geom, igt, callback, arg);
+		case MULTILINETYPE:
+			mline = (LWMLINE *) geom;
+			for (i = 0; i < mline->ngeoms && err == ES_NONE; i++)
+				err = _rti_scan_linestring(raster, mline->geoms[i], igt, callback, arg);
+			return err;
+		default:
+			rterror("rt_raster_scan_line: Geometry must be a LINESTRING or MULTILINESTRING");
+			return ES_ERROR;
+	}
+}
+
+/******************************************************************************
+* rt_raster_burn_polygon()
+******************************************************************************/
+
+typedef struct {
+	uint8_t *data;
+	int pixbytes;
+	uint16_t width;
+	uint8_t pixel[8];
+	uint32_t count;
+} _rti_burn_arg;
+
+static rt_errorstate
+_rti_burn_span(void *arg, int y, int x, int count) {
+	_rti_burn_arg *burn = (_rti_burn_arg *) arg;
+	uint8_t *ptr = burn->data + ((size_t) y * burn->width + x) * burn->pixbytes;
+	int i = 0;
+
+	if (burn->pixbytes == 1)
+		memset(ptr, burn->pixel[0], count);
+	else {
+		for (i = 0; i < count; i++, ptr += burn->pixbytes)
+			memcpy(ptr, burn->pixel, burn->pixbytes);
+	}
+	burn->count += count;
+
+	return ES_NONE;
+}
+
+/* band data and value as stored in band of burning into a band */
+static rt_band
+_rti_burn_init(rt_raster raster, int nband, double value, _rti_burn_arg *burn) {
+	rt_band band = NULL;
+	rt_band pixband = NULL;
+	rt_errorstate err = ES_NONE;
+
+	band = rt_raster_get_band(raster, nband);
+	if (band == NULL) {
+		rterror("_rti_burn_init: Could not get band at index %d", nband);
+		return NULL;
+	}
+	if (rt_band_is_offline(band)) {
+		rterror("_rti_burn_init: Cannot burn into an offline band");
+		return NULL;
+	}
+
+	burn->data = rt_band_get_data(band);
+	burn->pixbytes = rt_pixtype_size(rt_band_get_pixtype(band));
+	burn->width = raster->width;
+	burn->count = 0;
+	if (burn->data == NULL || burn->pixbytes < 1) {
+		rterror("_rti_burn_init: Could not get band data");
+		return NULL;
+	}
+
+	/* value as stored in band */
+	memset(burn->pixel, 0, sizeof(burn->pixel));
+	pixband = rt_band_new_inline(1, 1, rt_band_get_pixtype(band), 0, 0, burn->pixel);
+	if (pixband == NULL) {
+		rterror("_rti_burn_init: Could not convert value to band's pixel type");
+		return NULL;
+	}
+	err = rt_band_set_pixel(pixband, 0, 0, value, NULL);
+	rt_band_destroy(pixband);
+	if (err != ES_NONE) {
+		rterror("_rti_burn_init: Could not convert value to band's pixel type");
+		return NULL;
+	}
+
+	return band;
+}
+
+/**
+ * Set the pixels of a band whose centers are inside a polygonal
+ * geometry to a value.
+ *
+ * @param raster : the raster of the band
+ * @param nband : 0-based index of the band, must not be offline
+ * @param geom : POLYGON or MULTIPOLYGON in the raster's coordinates
+ * @param value : value of the pixels, clamped to the band's pixel type
+ * @param burned : (optional) number of pixels set
+ *
+ * @return ES_NONE on success, ES_ERROR on error
+ */
+rt_errorstate
+rt_raster_burn_polygon(
+	rt_raster raster, int nband,
+	const LWGEOM *geom, double value,
+	uint32_t *burned
+) {
+	rt_band band = NULL;
+	_rti_burn_arg burn;
+	rt_errorstate err = ES_NONE;
+
+	assert(NULL != raster);
+	assert(NULL != geom);
+
+	band = _rti_burn_init(raster, nband, value, &burn);
+	if (band == NULL) {
+		rterror("rt_raster_burn_polygon: Could not prepare band at index %d", nband);
+		return ES_ERROR;
+	}
+
+	err = rt_raster_scan_polygon(raster, geom, _rti_burn_span, &burn);
+
+	if (burn.count)
+		rt_band_set_isnodata_flag(band, 0);
+	if (burned != NULL)
+		*burned = burn.count;
+
+	return err;
+}
+
+/**
+ * Set the pixels of a band on a linear geometry to a value.
+ *
+ * @param raster : the raster of the band
+ * @param nband : 0-based index of the band, must not be offline
+ * @param geom : LINESTRING or MULTILINESTRING in the raster's coordinates
+ * @param value : value of the pixels, clamped to the band's pixel type
+ * @param burned : (optional) number of pixels set, a pixel on more
+ *   than one segment is counted for each
+ *
+ * @return ES_NONE on success, ES_ERROR on error
+ */
+rt_errorstate
+rt_raster_burn_line(
+	rt_raster raster, int nband,
+	const LWGEOM *geom, double value,
+	uint32_t *burned
+) {
+	rt_band band = NULL;
+	_rti_burn_arg burn;
+	rt_errorstate err = ES_NONE;
+
+	assert(NULL != raster);
+	assert(NULL != geom);
+
+	band = _rti_burn_init(raster, nband, value, &burn);
+	if (band == NULL) {
+		rterror("rt_raster_burn_line: Could not prepare band at index %d", nband);
+		return ES_ERROR;
+	}
+
+	err = rt_raster_scan_line(raster, geom, _rti_burn_span, &burn);
+
+	if (burn.count)
+		rt_band_set_isnodata_flag(band, 0);
+	if (burned != NULL)
+		*burned = burn.count;
+
+	return err;
+}
+
+/*
+	burn a geometry through a mask rasterized by GDAL on the raster's
+	grid, for what is not burned natively
+*/
+static rt_errorstate
+_rti_burn_gdal(
+	rt_raster raster, int nband,
+	const LWGEOM *geom, double value, int touched,
+	uint32_t *burned
+) {
+	rt_band band = NULL;
+	_rti_burn_arg burn;
+	rt_raster mask = NULL;
+	rt_band maskband = NULL;
+	uint8_t *maskdata = NULL;
+	uint8_t *wkb = NULL;
+	size_t wkb_len = 0;
+	char *options[2] = {NULL, NULL};
+	double gt[6] = {0};
+	double mgt[6] = {0};
+	double xr = 0;
+	double yr = 0;
+	int xoff = 0;
+	int yoff = 0;
+	int x = 0;
+	int y = 0;
+	int x0 = 0;
+	int run = 0;
+
+	band = _rti_burn_init(raster, nband, value, &burn);
+	if (band == NULL) {
+		rterror("_rti_burn_gdal: Could not prepare band at index %d", nband);
+		return ES_ERROR;
+	}
+
+	if (touched)
+		options[0] = "ALL_TOUCHED=TRUE";
+
+	rt_raster_get_geotransform_matrix(raster, gt);
+	wkb = lwgeom_to_wkb(geom, WKB_SFSQL, &wkb_len);
+	if (wkb == NULL) {
+		rterror("_rti_burn_gdal: Could not get WKB of geometry");
+		return ES_ERROR;
+	}
+
+	/* mask of pixels to burn, aligned to raster */
+	mask = rt_raster_gdal_rasterize(
+		wkb, wkb_len,
+		NULL,
+		0, NULL,
+		NULL, NULL,
+		NULL, NULL,
+		NULL, NULL,
+		&(gt[1]), &(gt[5]),
+		NULL, NULL,
+		&(gt[0]), &(gt[3]),
+		&(gt[2]), &(gt[4]),
+		options
+	);
+	rtdealloc(wkb);
+	if (mask == NULL) {
+		rterror("_rti_burn_gdal: Could not rasterize geometry");
+		return ES_ERROR;
+	}
+
+	if (rt_raster_is_empty(mask) || !rt_raster_has_band(mask, 0)) {
+		rt_raster_destroy(mask);
+		if (burned != NULL)
+			*burned = 0;
+		return ES_NONE;
+	}
+
+	/* pixel of raster at upper-left corner of mask */
+	rt_raster_get_geotransform_matrix(mask, mgt);
+	if (rt_raster_geopoint_to_cell(raster, mgt[0], mgt[3], &xr, &yr, NULL) != ES_NONE) {
+		rterror("_rti_burn_gdal: Could not get position of mask in raster");
+		rt_raster_destroy(mask);
+		return ES_ERROR;
+	}
+	xoff = (int) xr;
+	yoff = (int) yr;
+
+	maskband = rt_raster_get_band(mask, 0);
+	maskdata = rt_band_get_data(maskband);
+	if (maskdata == NULL) {
+		rterror("_rti_burn_gdal: Could not get data of mask");
+		rt_raster_destroy(mask);
+		return ES_ERROR;
+	}
+
+	/* runs of mask pixels inside raster */
+	for (y = 0; y < mask->height; y++) {
+		if (y + yoff < 0 || y + yoff >= raster->height)
+			continue;
+
+		run = 0;
+		for (x = 0; x <= mask->width; x++) {
+			if (
+				x < mask->width &&
+				x + xoff >= 0 && x + xoff < raster->width &&
+				maskdata[(size_t) y * mask->width + x]
+			) {
+				if (!run++)
+					x0 = x;
+				continue;
+			}
+
+			if (run)
+				_rti_burn_span(&burn, y + yoff, x0 + xoff, run);
+			run = 0;
+		}
+	}
+
+	rt_raster_destroy(mask);
+
+	if (burn.count)
+		rt_band_set_isnodata_flag(band, 0);
+	if (burned != NULL)
+		*burned = burn.count;
+
+	return ES_NONE;
+}
+
+/**
+ * Set the pixels of a band covered by a geometry to a value, using
+ * the rules of rt_raster_gdal_rasterize().  Polygons and lines not
+ * burning all touched pixels are burned directly into the band,
+ * other geometries through a mask rasterized by GDAL.
+ *
+ * @param raster : the raster of the band
+ * @param nband : 0-based index of the band, must not be offline
+ * @param geom : geometry in the raster's coordinates
+ * @param value : value of the pixels, clamped to the band's pixel type
+ * @param touched : if non-zero, burn all pixels touched by geometry
+ * @param burned : (optional) number of pixels set
+ *
+ * @return ES_NONE on success, ES_ERROR on error
+ */
+rt_errorstate
+rt_raster_burn_geometry(
+	rt_raster raster, int nband,
+	const LWGEOM *geom, double value, int touched,
+	uint32_t *burned
+) {
+	assert(NULL != raster);
+	assert(NULL != geom);
+
+	if (burned != NULL)
+		*burned = 0;
+	if (lwgeom_is_empty(geom))
+		return ES_NONE;
+
+	if (!touched) {
+		switch (geom->type) {
+			case POLYGONTYPE:
+			case MULTIPOLYGONTYPE:
+				return rt_raster_burn_polygon(raster, nband, geom, value, burned);
+			case LINETYPE:
+			case MULTILINETYPE:
+				return rt_raster_burn_line(raster, nband, geom, value, burned);
+			default:
+				break;
+		}
+	}
+
+	return _rti_burn_gdal(raster, nband, geom, value, touched, burned);
+}
+
 /******************************************************************************
 * rt_raster_gdal_rasterize()
 ******************************************************************************/
@@ -2462,6 +3145,98 @@ _rti_rasterize_arg_destroy(_rti_rasterize_arg arg) {
 	rtdealloc(arg);
 }
 
+/* value is stored unchanged in a band of pixel type */
+static int
+_rti_rasterize_value_is_exact(rt_pixtype pixtype, double value) {
+	switch (pixtype) {
+		case PT_1BB:
+			return (double) rt_util_clamp_to_1BB(value) == value;
+		case PT_2BUI:
+			return (double) rt_util_clamp_to_2BUI(value) == value;
+		case PT_4BUI:
+			return (double) rt_util_clamp_to_4BUI(value) == value;
+		case PT_8BSI:
+			return (double) rt_util_clamp_to_8BSI(value) == value;
+		case PT_8BUI:
+			return (double) rt_util_clamp_to_8BUI(value) == value;
+		case PT_16BSI:
+			return (double) rt_util_clamp_to_16BSI(value) == value;
+		case PT_16BUI:
+			return (double) rt_util_clamp_to_16BUI(value) == value;
+		case PT_32BSI:
+			return (double) rt_util_clamp_to_32BSI(value) == value;
+		case PT_32BUI:
+			return (double) rt_util_clamp_to_32BUI(value) == value;
+		case PT_32BF:
+			return (double) ((float) value) == value;
+		case PT_64BF:
+			return 1;
+		default:
+			return 0;
+	}
+}
+
+/*
+	rasterize polygons and lines without a GDAL dataset
+
+	only used when the result is the same as GDALRasterizeGeometries():
+	no options (e.g. ALL_TOUCHED) and values not altered by pixel type
+*/
+static rt_raster
+_rti_rasterize_native(
+	_rti_rasterize_arg arg,
+	const unsigned char *wkb, uint32_t wkb_len,
+	int *dim, double *gt
+) {
+	rt_raster rast = NULL;
+	LWGEOM *geom = NULL;
+	int i = 0;
+
+	geom = lwgeom_from_wkb(wkb, wkb_len, LW_PARSER_CHECK_NONE);
+	if (geom == NULL) {
+		rterror("rt_raster_gdal_rasterize: Could not create geometry from WKB");
+		return NULL;
+	}
+
+	rast = rt_raster_new(dim[0], dim[1]);
+	if (rast == NULL) {
+		rterror("rt_raster_gdal_rasterize: Out of memory allocating raster");
+		lwgeom_free(geom);
+		return NULL;
+	}
+	rt_raster_set_geotransform_matrix(rast, gt);
+
+	for (i = 0; i < arg->numbands; i++) {
+		if (rt_raster_generate_new_band(
+			rast, arg->pixtype[i],
+			arg->init[i],
+			arg->hasnodata[i], arg->nodata[i],
+			i
+		) < 0) {
+			rterror("rt_raster_gdal_rasterize: Could not add band to raster");
+			rt_raster_destroy(rast);
+			lwgeom_free(geom);
+			return NULL;
+		}
+
+		if (rt_raster_burn_geometry(rast, i, geom, arg->value[i], 0, NULL) != ES_NONE) {
+			rterror("rt_raster_gdal_rasterize: Could not rasterize geometry");
+			rt_raster_destroy(rast);
+			lwgeom_free(geom);
+			return NULL;
+		}
+
+		/*
+			bands of the GDAL path come from rt_raster_from_gdal_dataset(),
+			which never sets isnodata, even if no pixel was burned
+		*/
+		rt_band_set_isnodata_flag(rt_raster_get_band(rast, i), 0);
+	}
+
+	lwgeom_free(geom);
+	return rast;
+}
+
 /**
  * Return a raster of the provided geometry
  *
@@ -2573,18 +3348,8 @@ rt_raster_gdal_rasterize(
 		arg->value = value;
 	}
 
-	/* OGR spatial reference */
-	if (NULL != srs && strlen(srs)) {
-		arg->src_sr = OSRNewSpatialReference(NULL);
-		if (OSRSetFromUserInput(arg->src_sr, srs) != OGRERR_NONE) {
-			rterror("rt_raster_gdal_rasterize: Could not create OSR spatial reference using the provided srs: %s", srs);
-			_rti_rasterize_arg_destroy(arg);
-			return NULL;
-		}
-	}
-
-	/* convert WKB to OGR Geometry */
-	ogrerr = OGR_G_CreateFromWkb((unsigned char *) wkb, arg->src_sr, &src_geom, wkb_len);
+	/* convert WKB to OGR Geometry, spatial reference is only needed by GDAL */
+	ogrerr = OGR_G_CreateFromWkb((unsigned char *) wkb, NULL, &src_geom, wkb_len);
 	if (ogrerr != OGRERR_NONE) {
 		rterror("rt_raster_gdal_rasterize: Could not create OGR Geometry from WKB");
 
@@ -3144,6 +3909,49 @@ rt_raster_gdal_rasterize(
 	RASTER_DEBUGF(3, "Raster dimensions (width x height): %d x %d",
 		_dim[0], _dim[1]);
 
+	/* polygons and lines can be burned directly into raster */
+	if (
+		(
+			wkbtype == wkbPolygon || wkbtype == wkbMultiPolygon ||
+			wkbtype == wkbLineString || wkbtype == wkbMultiLineString
+		) &&
+		(options == NULL || options[0] == NULL)
+	) {
+		int native = 1;
+
+		for (i = 0; i < arg->numbands; i++) {
+			if (
+				!_rti_rasterize_value_is_exact(arg->pixtype[i], arg->init[i]) ||
+				!_rti_rasterize_value_is_exact(arg->pixtype[i], arg->value[i])
+			) {
+				native = 0;
+				break;
+			}
+		}
+
+		if (native) {
+			RASTER_DEBUG(3, "Rasterizing polygons and lines without GDAL");
+
+			OGR_G_DestroyGeometry(src_geom);
+			rast = _rti_rasterize_native(arg, wkb, wkb_len, _dim, _gt);
+			_rti_rasterize_arg_destroy(arg);
+
+			return rast;
+		}
+	}
+
+	/* OGR spatial reference */
+	if (NULL != srs && strlen(srs)) {
+		arg->src_sr = OSRNewSpatialReference(NULL);
+		if (OSRSetFromUserInput(arg->src_sr, srs) != OGRERR_NONE) {
+			rterror("rt_raster_gdal_rasterize: Could not create OSR spatial reference using the provided srs: %s", srs);
+			OGR_G_DestroyGeometry(src_geom);
+			_rti_rasterize_arg_destroy(arg);
+			return NULL;
+		}
+		OGR_G_AssignSpatialReference(src_geom, arg->src_sr);
+	}
+
 	/* load GDAL mem */
 	if (!rt_util_gdal_driver_registered("MEM")) {
 		RASTER_DEBUG(4, "Registering MEM driver");
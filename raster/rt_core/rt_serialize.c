@@ -458,8 +458,214 @@ write_float64(uint8_t** to, uint8_t littleEndian, double v) {
 }
 */
 
+/* variable for PostgreSQL GUC: postgis.enable_raster_compression */
+char enable_raster_compression = 0;
+
+/******************************************************************************
+* Run-length encoding of in-db band data
+*
+* Pixel values are encoded in units of whole pixels as control bytes
+* followed by pixel values (see doc/RFC1-SerializedFormat):
+*   0 to 127: next (control + 1) pixels are literal
+*   128 to 255: next pixel is repeated (control - 126) times
+******************************************************************************/
+
+#define RLE_MAX_LITERAL 128
+#define RLE_MAX_RUN 129
+
+/*
+ * Encode npix pixels of pixbytes bytes each into out.
+ * If out is NULL, only compute the encoded size. Encoding stops
+ * as soon as the encoded size reaches limit (when limit > 0).
+ *
+ * Returns the number of bytes of the encoded form.
+ */
+static uint32_t
+_rti_rle_encode(
+	const uint8_t *data, uint32_t npix, int pixbytes,
+	uint8_t *out, uint32_t limit
+) {
+	uint32_t size = 0;
+	uint32_t i = 0;
+	uint32_t run = 0;
+	uint32_t lit = 0;
+
+	while (i < npix) {
+		const uint8_t *pix = data + (size_t) i * pixbytes;
+
+		/* length of run of identical pixels starting at i */
+		run = 1;
+		while (
+			i + run < npix &&
+			run < RLE_MAX_RUN &&
+			memcmp(pix, pix + (size_t) run * pixbytes, pixbytes) == 0
+		) {
+			run++;
+		}
+
+		if (run > 1) {
+			if (out != NULL) {
+				*out++ = (uint8_t) (run + 126);
+				memcpy(out, pix, pixbytes);
+				out += pixbytes;
+			}
+			size += 1 + pixbytes;
+			i += run;
+		}
+		else {
+			/* literal ends where the next run starts */
+			lit = 1;
+			while (
+				i + lit < npix &&
+				lit < RLE_MAX_LITERAL &&
+				!(
+					i + lit + 1 < npix &&
+					memcmp(
+						pix + (size_t) lit * pixbytes,
+						pix + (size_t) (lit + 1) * pixbytes,
+						pixbytes
+					) == 0
+				)
+			) {
+				lit++;
+			}
+
+			if (out != NULL) {
+				*out++ = (uint8_t) (lit - 1);
+				memcpy(out, pix, (size_t) lit * pixbytes);
+				out += (size_t) lit * pixbytes;
+			}
+			size += 1 + lit * pixbytes;
+			i += lit;
+		}
+
+		if (limit && size >= limit)
+			break;
+	}
+
+	return size;
+}
+
+/*
+ * Decode insize bytes of encoded data into exactly npix pixels
+ * of pixbytes bytes each.
+ *
+ * Returns ES_NONE on success, ES_ERROR if the encoded data is corrupted
+ */
+static rt_errorstate
+_rti_rle_decode(
+	const uint8_t *in, uint32_t insize, int pixbytes,
+	uint8_t *out, uint32_t npix
+) {
+	const uint8_t *end = in + insize;
+	uint32_t n = 0;
+	uint32_t i = 0;
+	uint8_t ctrl = 0;
+
+	while (in < end && n < npix) {
+		ctrl = *in++;
+
+		/* run */
+		if (ctrl > 127) {
+			uint32_t run = ctrl - 126;
+
+			if ((uint32_t) (end - in) < (uint32_t) pixbytes || run > npix - n)
+				return ES_ERROR;
+
+			if (pixbytes == 1)
+				memset(out, *in, run);
+			else {
+				for (i = 0; i < run; i++)
+					memcpy(out + (size_t) i * pixbytes, in, pixbytes);
+			}
+			in += pixbytes;
+			out += (size_t) run * pixbytes;
+			n += run;
+		}
+		/* literal */
+		else {
+			uint32_t lit = ctrl + 1;
+
+			if ((uint32_t) (end - in) < lit * pixbytes || lit > npix - n)
+				return ES_ERROR;
+
+			memcpy(out, in, (size_t) lit * pixbytes);
+			in += (size_t) lit * pixbytes;
+			out += (size_t) lit * pixbytes;
+			n += lit;
+		}
+	}
+
+	if (in != end || n != npix)
+		return ES_ERROR;
+
+	return ES_NONE;
+}
+
+/*
+ * Run-length encode the data of band into a new buffer and set rlesize
+ * to the number of bytes of the encoded data (excluding the byte count).
+ *
+ * Returns the buffer or NULL if the band should be stored plain
+ */
+static uint8_t *
+_rti_band_rle_encode(rt_band band, int pixbytes, uint32_t *rlesize) {
+	uint32_t npix = 0;
+	uint32_t datasize = 0;
+	uint32_t size = 0;
+	uint8_t *data = NULL;
+	uint8_t *rle = NULL;
+
+	if (!enable_raster_compression || band->offline)
+		return NULL;
+
+	data = rt_band_get_data(band);
+	if (data == NULL)
+		return NULL;
+
+	npix = band->width * band->height;
+	datasize = npix * pixbytes;
+
+	/* the byte count must fit too */
+	if (datasize <= 4)
+		return NULL;
+
+	/* encoding stops past the limit by at most one literal */
+	rle = rtalloc(datasize - 4 + 1 + RLE_MAX_LITERAL * pixbytes);
+	if (rle == NULL)
+		return NULL;
+
+	size = _rti_rle_encode(data, npix, pixbytes, rle, datasize - 4);
+	if (size >= datasize - 4) {
+		rtdealloc(rle);
+		return NULL;
+	}
+
+	*rlesize = size;
+	return rle;
+}
+
+static void
+_rti_band_rle_free(uint8_t **rle, uint16_t numBands) {
+	uint16_t i = 0;
+
+	if (rle == NULL)
+		return;
+
+	for (i = 0; i < numBands; i++) {
+		if (rle[i] != NULL)
+			rtdealloc(rle[i]);
+	}
+	rtdealloc(rle);
+}
+
+/*
+ * Return the size of the serialized form of raster. The run-length
+ * encoded data of bands is stored in rle and rlesize (arrays of
+ * numBands elements) to be written by rt_raster_serialize().
+ */
 static uint32_t
-rt_raster_serialized_size(rt_raster raster) {
+rt_raster_serialized_size(rt_raster raster, uint8_t **rle, uint32_t *rlesize) {
 	uint32_t size = sizeof (struct rt_raster_serialized_t);
 	uint16_t i = 0;
 
@@ -492,8 +698,14 @@ rt_raster_serialized_size(rt_raster raster) {
 			size += strlen(band->data.offline.path) + 1;
 		}
 		else {
+			rle[i] = _rti_band_rle_encode(band, pixbytes, &rlesize[i]);
+
+			/* Add space for byte count and encoded band data */
+			if (rle[i] != NULL)
+				size += 4 + rlesize[i];
 			/* Add space for raster band data */
-			size += pixbytes * raster->width * raster->height;
+			else
+				size += pixbytes * raster->width * raster->height;
 		}
 
 		RASTER_DEBUGF(3, "Size before alignment is %d", size);
@@ -522,14 +734,36 @@ rt_raster_serialize(rt_raster raster) {
 	uint32_t size = 0;
 	uint8_t* ret = NULL;
 	uint8_t* ptr = NULL;
+	uint8_t** rle = NULL;
+	uint32_t* rlesize = NULL;
 	uint16_t i = 0;
 
 	assert(NULL != raster);
 
-	size = rt_raster_serialized_size(raster);
+	if (raster->numBands) {
+		rle = rtalloc(sizeof(uint8_t *) * raster->numBands);
+		rlesize = rtalloc(sizeof(uint32_t) * raster->numBands);
+		if (rle == NULL || rlesize == NULL) {
+			rterror("rt_raster_serialize: Out of memory allocating run-length encoding registry");
+			if (rle != NULL) rtdealloc(rle);
+			if (rlesize != NULL) rtdealloc(rlesize);
+			return NULL;
+		}
+		memset(rle, 0, sizeof(uint8_t *) * raster->numBands);
+	}
+
+	size = rt_raster_serialized_size(raster, rle, rlesize);
+	if (!size) {
+		_rti_band_rle_free(rle, raster->numBands);
+		if (rlesize != NULL) rtdealloc(rlesize);
+		return NULL;
+	}
+
 	ret = (uint8_t*) rtalloc(size);
 	if (!ret) {
 		rterror("rt_raster_serialize: Out of memory allocating %d bytes for serializing a raster", size);
+		_rti_band_rle_free(rle, raster->numBands);
+		if (rlesize != NULL) rtdealloc(rlesize);
 		return NULL;
 	}
 	memset(ret, '-', size);
@@ -548,8 +782,14 @@ rt_raster_serialize(rt_raster raster) {
 	 */
 	raster->size = size;
 
-	/* Set version */
-	raster->version = 0;
+	/* Set version, bumped only if any band is run-length encoded */
+	raster->version = RASTER_SERIALIZED_VERSION;
+	for (i = 0; i < raster->numBands; ++i) {
+		if (rle[i] != NULL) {
+			raster->version = RASTER_SERIALIZED_VERSION_RLE;
+			break;
+		}
+	}
 
 	/* Copy header */
 	memcpy(ptr, raster, sizeof (struct rt_raster_serialized_t));
@@ -572,6 +812,8 @@ rt_raster_serialize(rt_raster raster) {
 		int pixbytes = rt_pixtype_size(pixtype);
 		if (pixbytes < 1) {
 			rterror("rt_raster_serialize: Corrupted band: unknown pixtype");
+			_rti_band_rle_free(rle, raster->numBands);
+			rtdealloc(rlesize);
 			rtdealloc(ret);
 			return NULL;
 		}
@@ -581,6 +823,9 @@ rt_raster_serialize(rt_raster raster) {
 		if (band->offline) {
 #ifdef POSTGIS_RASTER_DISABLE_OFFLINE
       rterror("rt_raster_serialize: offdb raster support disabled at compile-time");
+      _rti_band_rle_free(rle, raster->numBands);
+      rtdealloc(rlesize);
+      rtdealloc(ret);
       return NULL;
 #endif
 			*ptr |= BANDTYPE_FLAG_OFFDB;
@@ -592,6 +837,9 @@ rt_raster_serialize(rt_raster raster) {
 		if (band->isnodata) {
 			*ptr |= BANDTYPE_FLAG_ISNODATA;
 		}
+		if (rle[i] != NULL) {
+			*ptr |= BANDTYPE_FLAG_RLE;
+		}
 
 #if POSTGIS_DEBUG_LEVEL > 2
 		d_print_binary_hex("PIXTYPE", dbg_ptr, size);
@@ -656,6 +904,8 @@ rt_raster_serialize(rt_raster raster) {
 			}
 			default:
 				rterror("rt_raster_serialize: Fatal error caused by unknown pixel type. Aborting.");
+				_rti_band_rle_free(rle, raster->numBands);
+				rtdealloc(rlesize);
 				rtdealloc(ret);
 				return NULL;
 		}
@@ -676,10 +926,25 @@ rt_raster_serialize(rt_raster raster) {
 			strcpy((char*) ptr, band->data.offline.path);
 			ptr += strlen(band->data.offline.path) + 1;
 		}
+		else if (rle[i] != NULL) {
+			/* Write byte count and encoded data */
+			memcpy(ptr, &rlesize[i], 4);
+			ptr += 4;
+			memcpy(ptr, rle[i], rlesize[i]);
+			ptr += rlesize[i];
+		}
 		else {
 			/* Write data */
 			uint32_t datasize = raster->width * raster->height * pixbytes;
-			memcpy(ptr, band->data.mem, datasize);
+			uint8_t *data = rt_band_get_data(band);
+			if (data == NULL) {
+				rterror("rt_raster_serialize: Could not get data of band %d", i);
+				_rti_band_rle_free(rle, raster->numBands);
+				rtdealloc(rlesize);
+				rtdealloc(ret);
+				return NULL;
+			}
+			memcpy(ptr, data, datasize);
 			ptr += datasize;
 		}
 
@@ -699,12 +964,185 @@ rt_raster_serialize(rt_raster raster) {
 		assert(!((ptr - ret) % pixbytes));
 	} /* for-loop over bands */
 
+	_rti_band_rle_free(rle, raster->numBands);
+	if (rlesize != NULL) rtdealloc(rlesize);
+
 #if POSTGIS_DEBUG_LEVEL > 2
 		d_print_binary_hex("SERIALIZED RASTER", dbg_ptr, size);
 #endif
 	return ret;
 }
 
+/**
+ * Decode the run-length encoded data of a deserialized band into
+ * a buffer allocated now and owned by the band.
+ * Called by rt_band_get_data() on first access to the data.
+ *
+ * @param band : the band with run-length encoded data
+ *
+ * @return ES_NONE on success, ES_ERROR on error
+ */
+rt_errorstate
+rt_band_decode_rle(rt_band band) {
+	uint32_t rlesize = 0;
+	int pixbytes = 0;
+	uint8_t *data = NULL;
+
+	assert(NULL != band);
+	assert(NULL != band->rle);
+
+	pixbytes = rt_pixtype_size(band->pixtype);
+	data = rtalloc(band->width * band->height * pixbytes);
+	if (data == NULL) {
+		rterror("rt_band_decode_rle: Could not allocate memory for decoding band data");
+		return ES_ERROR;
+	}
+
+	/* byte count was validated by rt_raster_deserialize */
+	memcpy(&rlesize, band->rle, 4);
+
+	if (_rti_rle_decode(
+		band->rle + 4, rlesize,
+		pixbytes,
+		data, band->width * band->height
+	) != ES_NONE) {
+		rterror("rt_band_decode_rle: Corrupted run-length encoded data");
+		rtdealloc(data);
+		return ES_ERROR;
+	}
+
+	band->data.mem = data;
+	band->ownsdata = 1;
+	band->rle = NULL;
+	return ES_NONE;
+}
+
+/* Return band n of a raster from its serialized form at ptr */
+static rt_band
+_rti_raster_deserialize_band(rt_raster raster, const uint8_t *ptr, int n) {
+	rt_band band = NULL;
+	uint8_t type = 0;
+	int pixbytes = 0;
+	uint8_t littleEndian = isMachineLittleEndian();
+
+	band = rtalloc(sizeof(struct rt_band_t));
+	if (!band) {
+		rterror("rt_raster_deserialize: Out of memory allocating rt_band during deserialization");
+		return NULL;
+	}
+
+	type = *ptr;
+	ptr++;
+	band->pixtype = type & BANDTYPE_PIXTYPE_MASK;
+
+	RASTER_DEBUGF(3, "rt_raster_deserialize: band %d with pixel type %s", n, rt_pixtype_name(band->pixtype));
+
+	band->offline = BANDTYPE_IS_OFFDB(type) ? 1 : 0;
+	band->hasnodata = BANDTYPE_HAS_NODATA(type) ? 1 : 0;
+	band->isnodata = band->hasnodata ? (BANDTYPE_IS_NODATA(type) ? 1 : 0) : 0;
+	band->width = raster->width;
+	band->height = raster->height;
+	band->ownsdata = 0; /* we do NOT own this data!!! */
+	band->rle = NULL;
+	band->raster = raster;
+
+	/* Advance by data padding */
+	pixbytes = rt_pixtype_size(band->pixtype);
+	ptr += pixbytes - 1;
+
+	/* Read nodata value */
+	switch (band->pixtype) {
+		case PT_1BB: {
+			band->nodataval = ((int) read_uint8(&ptr)) & 0x01;
+			break;
+		}
+		case PT_2BUI: {
+			band->nodataval = ((int) read_uint8(&ptr)) & 0x03;
+			break;
+		}
+		case PT_4BUI: {
+			band->nodataval = ((int) read_uint8(&ptr)) & 0x0F;
+			break;
+		}
+		case PT_8BSI: {
+			band->nodataval = read_int8(&ptr);
+			break;
+		}
+		case PT_8BUI: {
+			band->nodataval = read_uint8(&ptr);
+			break;
+		}
+		case PT_16BSI: {
+			band->nodataval = read_int16(&ptr, littleEndian);
+			break;
+		}
+		case PT_16BUI: {
+			band->nodataval = read_uint16(&ptr, littleEndian);
+			break;
+		}
+		case PT_32BSI: {
+			band->nodataval = read_int32(&ptr, littleEndian);
+			break;
+		}
+		case PT_32BUI: {
+			band->nodataval = read_uint32(&ptr, littleEndian);
+			break;
+		}
+		case PT_32BF: {
+			band->nodataval = read_float32(&ptr, littleEndian);
+			break;
+		}
+		case PT_64BF: {
+			band->nodataval = read_float64(&ptr, littleEndian);
+			break;
+		}
+		default: {
+			rterror("rt_raster_deserialize: Unknown pixeltype %d", band->pixtype);
+			rtdealloc(band);
+			return NULL;
+		}
+	}
+
+	RASTER_DEBUGF(3, "rt_raster_deserialize: has nodata flag %d", band->hasnodata);
+	RASTER_DEBUGF(3, "rt_raster_deserialize: nodata value %g", band->nodataval);
+
+	if (band->offline) {
+		int pathlen = 0;
+
+		/* Read band number */
+		band->data.offline.bandNum = *ptr;
+		ptr += 1;
+
+		/* Register path */
+		pathlen = strlen((char*) ptr);
+		band->data.offline.path = rtalloc(sizeof(char) * (pathlen + 1));
+		if (band->data.offline.path == NULL) {
+			rterror("rt_raster_deserialize: Could not allocate memory for offline band path");
+			rtdealloc(band);
+			return NULL;
+		}
+
+		memcpy(band->data.offline.path, ptr, pathlen);
+		band->data.offline.path[pathlen] = '\0';
+
+		band->data.offline.mem = NULL;
+	}
+	else if (BANDTYPE_IS_RLE(type)) {
+		/*
+			decoded on first access by rt_band_get_data(), which the
+			serialized form must outlive as it does for other in-db bands
+		*/
+		band->data.mem = NULL;
+		band->rle = ptr;
+	}
+	else {
+		/* Register data */
+		band->data.mem = (uint8_t*) ptr;
+	}
+
+	return band;
+}
+
 /**
  * Return a raster from a serialized form.
  *
@@ -712,6 +1150,8 @@ rt_raster_serialize(rt_raster raster) {
  *
  * NOTE: the raster will contain pointer to the serialized
  * form (including band data), which must be kept alive.
+ * Run-length encoded bands are decoded on first access to their
+ * data into memory then allocated and owned by the band.
  */
 rt_raster
 rt_raster_deserialize(void* serialized, int header_only) {
@@ -720,7 +1160,6 @@ rt_raster_deserialize(void* serialized, int header_only) {
 	const uint8_t *beg = NULL;
 	uint16_t i = 0;
 	uint16_t j = 0;
-	uint8_t littleEndian = isMachineLittleEndian();
 
 	assert(NULL != serialized);
 
@@ -743,6 +1182,12 @@ rt_raster_deserialize(void* serialized, int header_only) {
 	RASTER_DEBUG(3, "rt_raster_deserialize: Deserialize raster header");
 	memcpy(rast, serialized, sizeof (struct rt_raster_serialized_t));
 
+	if (rast->version > RASTER_SERIALIZED_VERSION_RLE) {
+		rterror("rt_raster_deserialize: Unsupported serialized raster version %d", rast->version);
+		rtdealloc(rast);
+		return NULL;
+	}
+
 	if (0 == rast->numBands || header_only) {
 		rast->bands = 0;
 		return rast;
@@ -767,140 +1212,67 @@ rt_raster_deserialize(void* serialized, int header_only) {
 
 	/* Deserialize bands now */
 	for (i = 0; i < rast->numBands; ++i) {
-		rt_band band = NULL;
 		uint8_t type = 0;
 		int pixbytes = 0;
 
-		band = rtalloc(sizeof(struct rt_band_t));
-		if (!band) {
-			rterror("rt_raster_deserialize: Out of memory allocating rt_band during deserialization");
-			for (j = 0; j < i; j++) rt_band_destroy(rast->bands[j]);
-			rt_raster_destroy(rast);
-			return NULL;
-		}
+		type = *ptr;
+		pixbytes = rt_pixtype_size(type & BANDTYPE_PIXTYPE_MASK);
 
-		rast->bands[i] = band;
+		/* Byte count of encoded data is never more than plain data */
+		if (pixbytes > 0 && !BANDTYPE_IS_OFFDB(type) && BANDTYPE_IS_RLE(type)) {
+			uint32_t rlesize = 0;
 
-		type = *ptr;
-		ptr++;
-		band->pixtype = type & BANDTYPE_PIXTYPE_MASK;
-
-		RASTER_DEBUGF(3, "rt_raster_deserialize: band %d with pixel type %s", i, rt_pixtype_name(band->pixtype));
-
-		band->offline = BANDTYPE_IS_OFFDB(type) ? 1 : 0;
-		band->hasnodata = BANDTYPE_HAS_NODATA(type) ? 1 : 0;
-		band->isnodata = band->hasnodata ? (BANDTYPE_IS_NODATA(type) ? 1 : 0) : 0;
-		band->width = rast->width;
-		band->height = rast->height;
-		band->ownsdata = 0; /* we do NOT own this data!!! */
-		band->raster = rast;
-
-		/* Advance by data padding */
-		pixbytes = rt_pixtype_size(band->pixtype);
-		ptr += pixbytes - 1;
-
-		/* Read nodata value */
-		switch (band->pixtype) {
-			case PT_1BB: {
-				band->nodataval = ((int) read_uint8(&ptr)) & 0x01;
-				break;
-			}
-			case PT_2BUI: {
-				band->nodataval = ((int) read_uint8(&ptr)) & 0x03;
-				break;
-			}
-			case PT_4BUI: {
-				band->nodataval = ((int) read_uint8(&ptr)) & 0x0F;
-				break;
-			}
-			case PT_8BSI: {
-				band->nodataval = read_int8(&ptr);
-				break;
-			}
-			case PT_8BUI: {
-				band->nodataval = read_uint8(&ptr);
-				break;
-			}
-			case PT_16BSI: {
-				band->nodataval = read_int16(&ptr, littleEndian);
-				break;
-			}
-			case PT_16BUI: {
-				band->nodataval = read_uint16(&ptr, littleEndian);
-				break;
-			}
-			case PT_32BSI: {
-				band->nodataval = read_int32(&ptr, littleEndian);
-				break;
-			}
-			case PT_32BUI: {
-				band->nodataval = read_uint32(&ptr, littleEndian);
-				break;
-			}
-			case PT_32BF: {
-				band->nodataval = read_float32(&ptr, littleEndian);
-				break;
-			}
-			case PT_64BF: {
-				band->nodataval = read_float64(&ptr, littleEndian);
-				break;
+			/* run-length encoded bands came with version 1 */
+			if (rast->version < RASTER_SERIALIZED_VERSION_RLE) {
+				rterror("rt_raster_deserialize: Run-length encoded band %d in serialized raster version %d", i, rast->version);
+				for (j = 0; j < i; j++) rt_band_destroy(rast->bands[j]);
+				rt_raster_destroy(rast);
+				return NULL;
 			}
-			default: {
-				rterror("rt_raster_deserialize: Unknown pixeltype %d", band->pixtype);
-				for (j = 0; j <= i; j++) rt_band_destroy(rast->bands[j]);
+
+			memcpy(&rlesize, ptr + 2 * pixbytes, 4);
+			if (rlesize >= (uint32_t) (rast->width * rast->height * pixbytes)) {
+				rterror("rt_raster_deserialize: Corrupted run-length encoded data for band %d", i);
+				for (j = 0; j < i; j++) rt_band_destroy(rast->bands[j]);
 				rt_raster_destroy(rast);
 				return NULL;
 			}
 		}
 
-		RASTER_DEBUGF(3, "rt_raster_deserialize: has nodata flag %d", band->hasnodata);
-		RASTER_DEBUGF(3, "rt_raster_deserialize: nodata value %g", band->nodataval);
+		rast->bands[i] = _rti_raster_deserialize_band(rast, ptr, i);
+		if (rast->bands[i] == NULL) {
+			for (j = 0; j < i; j++) rt_band_destroy(rast->bands[j]);
+			rt_raster_destroy(rast);
+			return NULL;
+		}
+
+		/* Skip band type, data padding and nodata value */
+		ptr += 2 * pixbytes;
 
 		/* Consistency checking (ptr is pixbytes-aligned) */
 		assert(!((ptr - beg) % pixbytes));
 
-		if (band->offline) {
-			int pathlen = 0;
-
-			/* Read band number */
-			band->data.offline.bandNum = *ptr;
+		if (BANDTYPE_IS_OFFDB(type)) {
+			/* Skip band number and path */
 			ptr += 1;
+			ptr += strlen((char*) ptr) + 1;
+		}
+		else if (BANDTYPE_IS_RLE(type)) {
+			uint32_t rlesize = 0;
 
-			/* Register path */
-			pathlen = strlen((char*) ptr);
-			band->data.offline.path = rtalloc(sizeof(char) * (pathlen + 1));
-			if (band->data.offline.path == NULL) {
-				rterror("rt_raster_deserialize: Could not allocate memory for offline band path");
-				for (j = 0; j <= i; j++) rt_band_destroy(rast->bands[j]);
-				rt_raster_destroy(rast);
-				return NULL;
-			}
-
-			memcpy(band->data.offline.path, ptr, pathlen);
-			band->data.offline.path[pathlen] = '\0';
-			ptr += pathlen + 1;
-
-			band->data.offline.mem = NULL;
+			/* Skip byte count and encoded data */
+			memcpy(&rlesize, ptr, 4);
+			ptr += 4 + rlesize;
 		}
 		else {
-			/* Register data */
-			const uint32_t datasize = rast->width * rast->height * pixbytes;
-			band->data.mem = (uint8_t*) ptr;
-			ptr += datasize;
+			/* Skip data */
+			ptr += rast->width * rast->height * pixbytes;
 		}
 
 		/* Skip bytes of padding up to 8-bytes boundary */
-#if POSTGIS_DEBUG_LEVEL > 0
-		const uint8_t *padbeg = ptr;
-#endif
 		while (0 != ((ptr - beg) % 8)) {
 			++ptr;
 		}
-
-		RASTER_DEBUGF(3, "rt_raster_deserialize: skip %d bytes of 8-bytes boundary padding", ptr - padbeg);
-
-		/* Consistency checking (ptr is pixbytes-aligned) */
-		assert(!((ptr - beg) % pixbytes));
 	}
 
 	return rast;
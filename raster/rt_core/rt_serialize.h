@@ -32,17 +32,25 @@
 
 #include "librtcore.h"
 
+/* serialized format versions, 1 if any band is run-length encoded */
+#define RASTER_SERIALIZED_VERSION 0
+#define RASTER_SERIALIZED_VERSION_RLE 1
+
 #define BANDTYPE_FLAGS_MASK 0xF0
 #define BANDTYPE_PIXTYPE_MASK 0x0F
 #define BANDTYPE_FLAG_OFFDB     (1<<7)
 #define BANDTYPE_FLAG_HASNODATA (1<<6)
 #define BANDTYPE_FLAG_ISNODATA  (1<<5)
-#define BANDTYPE_FLAG_RESERVED3 (1<<4)
+#define BANDTYPE_FLAG_RLE       (1<<4)
 
 #define BANDTYPE_PIXTYPE(x) ((x)&BANDTYPE_PIXTYPE_MASK)
 #define BANDTYPE_IS_OFFDB(x) ((x)&BANDTYPE_FLAG_OFFDB)
 #define BANDTYPE_HAS_NODATA(x) ((x)&BANDTYPE_FLAG_HASNODATA)
 #define BANDTYPE_IS_NODATA(x) ((x)&BANDTYPE_FLAG_ISNODATA)
+#define BANDTYPE_IS_RLE(x) ((x)&BANDTYPE_FLAG_RLE)
+
+rt_errorstate
+rt_band_decode_rle(rt_band band);
 
 #if POSTGIS_DEBUG_LEVEL > 2
 char*
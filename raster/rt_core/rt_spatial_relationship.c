@@ -633,12 +633,189 @@ rt_errorstate rt_raster_fully_within_distance(
 * rt_raster_intersects()
 ******************************************************************************/
 
+/*
+	coarse occupancy of a band. the band is divided in blocks of
+	block x block pixels and a summed-area table counts the blocks
+	having at least one pixel with value
+*/
+typedef struct _rti_occupancy_arg_t* _rti_occupancy_arg;
+struct _rti_occupancy_arg_t {
+	uint16_t width;
+	uint16_t height;
+	double igt[6];
+
+	uint32_t block;
+	uint32_t columns;
+	uint32_t rows;
+	uint32_t *sum;
+};
+
+static void
+_rti_occupancy_arg_destroy(_rti_occupancy_arg _param) {
+	if (_param == NULL)
+		return;
+
+	if (_param->sum != NULL)
+		rtdealloc(_param->sum);
+	rtdealloc(_param);
+}
+
+static _rti_occupancy_arg
+_rti_occupancy_arg_init(rt_raster raster, rt_band band) {
+	_rti_occupancy_arg _param;
+	uint32_t bx = 0;
+	uint32_t by = 0;
+	uint32_t stride = 0;
+	uint32_t x = 0;
+	uint32_t y = 0;
+	uint32_t xmax = 0;
+	uint32_t ymax = 0;
+	uint32_t occupied = 0;
+	double val = 0;
+	int isnodata = 0;
+
+	_param = rtalloc(sizeof(struct _rti_occupancy_arg_t));
+	if (_param == NULL) {
+		rterror("_rti_occupancy_arg_init: Could not allocate memory for _rti_occupancy_arg");
+		return NULL;
+	}
+
+	_param->width = rt_raster_get_width(raster);
+	_param->height = rt_raster_get_height(raster);
+	_param->sum = NULL;
+
+	if (rt_raster_get_inverse_geotransform_matrix(raster, NULL, _param->igt) != ES_NONE) {
+		rterror("_rti_occupancy_arg_init: Could not get inverse geotransform matrix");
+		_rti_occupancy_arg_destroy(_param);
+		return NULL;
+	}
+
+	/* at most 64K blocks */
+	_param->block = 1;
+	while (
+		((_param->width / _param->block) + 1) * ((_param->height / _param->block) + 1) > 65536
+	) {
+		_param->block *= 2;
+	}
+	_param->columns = (_param->width + _param->block - 1) / _param->block;
+	_param->rows = (_param->height + _param->block - 1) / _param->block;
+	stride = _param->columns + 1;
+
+	_param->sum = rtalloc(sizeof(uint32_t) * stride * (_param->rows + 1));
+	if (_param->sum == NULL) {
+		rterror("_rti_occupancy_arg_init: Could not allocate memory for block summary");
+		_rti_occupancy_arg_destroy(_param);
+		return NULL;
+	}
+	memset(_param->sum, 0, sizeof(uint32_t) * stride * (_param->rows + 1));
+
+	for (by = 0; by < _param->rows; by++) {
+		ymax = (by + 1) * _param->block;
+		if (ymax > _param->height)
+			ymax = _param->height;
+
+		for (bx = 0; bx < _param->columns; bx++) {
+			xmax = (bx + 1) * _param->block;
+			if (xmax > _param->width)
+				xmax = _param->width;
+
+			/* stop at first pixel with value */
+			occupied = 0;
+			for (y = by * _param->block; y < ymax && !occupied; y++) {
+				for (x = bx * _param->block; x < xmax; x++) {
+					if (
+						rt_band_get_pixel(band, x, y, &val, &isnodata) == ES_NONE &&
+						!isnodata
+					) {
+						occupied = 1;
+						break;
+					}
+				}
+			}
+
+			_param->sum[((by + 1) * stride) + bx + 1] = occupied +
+				_param->sum[(by * stride) + bx + 1] +
+				_param->sum[((by + 1) * stride) + bx] -
+				_param->sum[(by * stride) + bx];
+		}
+	}
+
+	RASTER_DEBUGF(4, "%d of %d blocks of %d pixels have values",
+		_param->sum[(_param->rows * stride) + _param->columns],
+		_param->columns * _param->rows, _param->block * _param->block);
+
+	return _param;
+}
+
+/* band has any pixel with value */
+static int
+_rti_occupancy_any(_rti_occupancy_arg _param) {
+	if (_param == NULL)
+		return 1;
+
+	return _param->sum[(_param->rows * (_param->columns + 1)) + _param->columns] > 0;
+}
+
+/*
+	band may have a pixel with value within dx and dy of point (x, y).
+	the search window is grown by a pixel to be safe from rounding
+*/
+static int
+_rti_occupancy_has_value(
+	_rti_occupancy_arg _param,
+	double x, double y,
+	double dx, double dy
+) {
+	double cx;
+	double cy;
+	double rx;
+	double ry;
+	double x0;
+	double x1;
+	double y0;
+	double y1;
+	uint32_t bx0;
+	uint32_t bx1;
+	uint32_t by0;
+	uint32_t by1;
+	uint32_t stride;
+
+	if (_param == NULL)
+		return 1;
+
+	cx = _param->igt[0] + (x * _param->igt[1]) + (y * _param->igt[2]);
+	cy = _param->igt[3] + (x * _param->igt[4]) + (y * _param->igt[5]);
+	rx = (fabs(_param->igt[1]) * dx) + (fabs(_param->igt[2]) * dy) + 1;
+	ry = (fabs(_param->igt[4]) * dx) + (fabs(_param->igt[5]) * dy) + 1;
+
+	x0 = floor(fmax(cx - rx, 0));
+	x1 = floor(fmin(cx + rx, _param->width - 1));
+	y0 = floor(fmax(cy - ry, 0));
+	y1 = floor(fmin(cy + ry, _param->height - 1));
+	if (x0 > x1 || y0 > y1)
+		return 0;
+
+	bx0 = (uint32_t) x0 / _param->block;
+	bx1 = ((uint32_t) x1 / _param->block) + 1;
+	by0 = (uint32_t) y0 / _param->block;
+	by1 = ((uint32_t) y1 / _param->block) + 1;
+	stride = _param->columns + 1;
+
+	return (
+		_param->sum[(by1 * stride) + bx1] -
+		_param->sum[(by0 * stride) + bx1] -
+		_param->sum[(by1 * stride) + bx0] +
+		_param->sum[(by0 * stride) + bx0]
+	) > 0;
+}
+
 static
 int rt_raster_intersects_algorithm(
 	rt_raster rast1, rt_raster rast2,
 	rt_band band1, rt_band band2,
 	int hasnodata1, int hasnodata2,
-	double nodata1, double nodata2
+	double nodata1, double nodata2,
+	_rti_occupancy_arg occ1, _rti_occupancy_arg occ2
 ) {
 	int i;
 	int byHeight = 1;
@@ -822,6 +999,15 @@ int rt_raster_intersects_algorithm(
 					)) {
 						RASTER_DEBUG(4, "within bounds");
 
+						/* skip if no pixel with value around intersection */
+						if (
+							!_rti_occupancy_has_value(occ1, P[pX], P[pY], fabs(xscale), fabs(yscale)) ||
+							!_rti_occupancy_has_value(occ2, P[pX], P[pY], fabs(xscale), fabs(yscale))
+						) {
+							RASTER_DEBUG(4, "no pixels with value around intersection");
+							continue;
+						}
+
 						for (i = 0; i < 8; i++) adjacent[i] = 0;
 
 						/* test points around intersection */
@@ -1027,6 +1213,8 @@ rt_raster_intersects(
 	int isnodataL = 0;
 	double gtS[6] = {0};
 	double igtL[6] = {0};
+	_rti_occupancy_arg occS = NULL;
+	_rti_occupancy_arg occL = NULL;
 
 	uint32_t row;
 	uint32_t rowoffset;
@@ -1272,23 +1460,55 @@ rt_raster_intersects(
 		RASTER_DEBUG(4, "Smaller raster not in the other raster's pixel. Continuing");
 	}
 
+	/* summarize bands with NODATA to skip empty blocks */
+	if (hasnodataS != FALSE) {
+		occS = _rti_occupancy_arg_init(rastS, bandS);
+		if (occS == NULL) {
+			rterror("rt_raster_intersects: Could not summarize band %d of the first raster", nbandS);
+			*intersects = 0;
+			return ES_ERROR;
+		}
+	}
+	if (hasnodataL != FALSE) {
+		occL = _rti_occupancy_arg_init(rastL, bandL);
+		if (occL == NULL) {
+			rterror("rt_raster_intersects: Could not summarize band %d of the second raster", nbandL);
+			_rti_occupancy_arg_destroy(occS);
+			*intersects = 0;
+			return ES_ERROR;
+		}
+	}
+
+	if (!_rti_occupancy_any(occS) || !_rti_occupancy_any(occL)) {
+		RASTER_DEBUG(3, "One of the two raster bands has no pixel with value. The two rasters do not intersect");
+		_rti_occupancy_arg_destroy(occS);
+		_rti_occupancy_arg_destroy(occL);
+		*intersects = 0;
+		return ES_NONE;
+	}
+
 	RASTER_DEBUG(4, "Testing smaller raster vs larger raster");
 	*intersects = rt_raster_intersects_algorithm(
 		rastS, rastL,
 		bandS, bandL,
 		hasnodataS, hasnodataL,
-		nodataS, nodataL
+		nodataS, nodataL,
+		occS, occL
 	);
 
-	if (*intersects) return ES_NONE;
+	if (!*intersects) {
+		RASTER_DEBUG(4, "Testing larger raster vs smaller raster");
+		*intersects = rt_raster_intersects_algorithm(
+			rastL, rastS,
+			bandL, bandS,
+			hasnodataL, hasnodataS,
+			nodataL, nodataS,
+			occL, occS
+		);
+	}
 
-	RASTER_DEBUG(4, "Testing larger raster vs smaller raster");
-	*intersects = rt_raster_intersects_algorithm(
-		rastL, rastS,
-		bandL, bandS,
-		hasnodataL, hasnodataS,
-		nodataL, nodataS
-	);
+	_rti_occupancy_arg_destroy(occS);
+	_rti_occupancy_arg_destroy(occL);
 
 	if (*intersects) return ES_NONE;
 
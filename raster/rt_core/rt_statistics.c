@@ -89,10 +89,264 @@ static void quicksort(double *left, double *right) {
 	}
 }
 
+/******************************************************************************
+* quickselect
+******************************************************************************/
+
+/*
+	partially order values between left and right (inclusive) so that the
+	value at k is the one that would be there if sorted. values before k
+	are less than or equal to it and values after are greater than or equal.
+	partitions three ways as pixel values tend to have many duplicates
+*/
+static void quickselect(double *values, uint32_t left, uint32_t right, uint32_t k) {
+	double p;
+	uint32_t lt;
+	uint32_t gt;
+	uint32_t i;
+
+	while (left < right) {
+		/* median of three */
+		p = values[left + (right - left) / 2];
+		if (
+			(values[left] < p && p < values[right]) ||
+			(values[right] < p && p < values[left])
+		) {
+			/* middle value is median */
+		}
+		else if (
+			(p < values[left] && values[left] < values[right]) ||
+			(values[right] < values[left] && values[left] < p)
+		) {
+			p = values[left];
+		}
+		else if (
+			(p < values[right] && values[right] < values[left]) ||
+			(values[left] < values[right] && values[right] < p)
+		) {
+			p = values[right];
+		}
+
+		lt = left;
+		gt = right;
+		i = left;
+		while (i <= gt) {
+			if (values[i] < p) {
+				SWAP(values[lt], values[i]);
+				lt++;
+				i++;
+			}
+			else if (values[i] > p) {
+				SWAP(values[i], values[gt]);
+				if (gt == 0) break;
+				gt--;
+			}
+			else
+				i++;
+		}
+
+		if (k < lt)
+			right = lt - 1;
+		else if (k > gt)
+			left = gt + 1;
+		else
+			return;
+	}
+}
+
 /******************************************************************************
 * rt_band_get_summary_stats()
 ******************************************************************************/
 
+/*
+	running statistics of the pixel values of a band. shared by
+	rt_band_get_summary_stats() and rt_raster_get_zonal_stats()
+*/
+typedef struct {
+	uint8_t *data;
+	uint16_t width;
+
+	int exclude_nodata_value;
+	double nodata;
+	double cnodata;
+
+	double *values;
+	uint32_t k;
+	double sum;
+	double M;
+	double Q;
+	double min;
+	double max;
+
+	uint64_t *cK;
+	double *cM;
+	double *cQ;
+} _rti_stats_arg;
+
+/*
+	add count pixels of band data to the statistics, starting at offset
+	and stepping by stride pixels. one kernel per pixel type so that the
+	pixel type is resolved once per band instead of once per pixel. the
+	running values are kept in locals for the length of the run
+*/
+typedef void (*_rti_stats_kernel)(
+	_rti_stats_arg *arg,
+	uint32_t offset, uint32_t count, uint32_t stride
+);
+
+#define _RTI_STATS_KERNEL(name, ctype) \
+static void name( \
+	_rti_stats_arg *arg, \
+	uint32_t offset, uint32_t count, uint32_t stride \
+) { \
+	const ctype *ptr = ((const ctype *) arg->data) + offset; \
+	int exclude_nodata_value = arg->exclude_nodata_value; \
+	double nodata = arg->nodata; \
+	double cnodata = arg->cnodata; \
+	double *values = arg->values; \
+	uint32_t k = arg->k; \
+	double sum = arg->sum; \
+	double M = arg->M; \
+	double Q = arg->Q; \
+	double min = arg->min; \
+	double max = arg->max; \
+	double value; \
+	double delta; \
+\
+	for (; count > 0; count--, ptr += stride) { \
+		value = *ptr; \
+\
+		if (exclude_nodata_value && ( \
+			FLT_EQ(value, nodata) || FLT_EQ(value, cnodata) \
+		)) { \
+			continue; \
+		} \
+\
+		/* inc_vals set, collect pixel values */ \
+		if (values != NULL) \
+			values[k] = value; \
+\
+		/* average */ \
+		k++; \
+		sum += value; \
+\
+		/* \
+			one-pass standard deviation \
+			http://www.eecs.berkeley.edu/~mhoemmen/cs194/Tutorials/variance.pdf \
+		*/ \
+		if (k == 1) { \
+			Q = 0; \
+			M = value; \
+			min = max = value; \
+		} \
+		else { \
+			delta = value - M; \
+			Q += (((k - 1) * (delta * delta)) / k); \
+			M += (delta / k); \
+\
+			/* min/max */ \
+			if (value < min) \
+				min = value; \
+			if (value > max) \
+				max = value; \
+		} \
+\
+		/* coverage one-pass standard deviation */ \
+		if (NULL != arg->cK) { \
+			(*arg->cK)++; \
+			if (*arg->cK == 1) { \
+				*arg->cQ = 0; \
+				*arg->cM = value; \
+			} \
+			else { \
+				delta = value - *arg->cM; \
+				*arg->cQ += (((*arg->cK - 1) * (delta * delta)) / *arg->cK); \
+				*arg->cM += (delta / *arg->cK); \
+			} \
+		} \
+	} \
+\
+	arg->k = k; \
+	arg->sum = sum; \
+	arg->M = M; \
+	arg->Q = Q; \
+	arg->min = min; \
+	arg->max = max; \
+}
+
+_RTI_STATS_KERNEL(_rti_stats_add_8BSI, int8_t)
+_RTI_STATS_KERNEL(_rti_stats_add_8BUI, uint8_t)
+_RTI_STATS_KERNEL(_rti_stats_add_16BSI, int16_t) /* we assume correct alignment */
+_RTI_STATS_KERNEL(_rti_stats_add_16BUI, uint16_t)
+_RTI_STATS_KERNEL(_rti_stats_add_32BSI, int32_t)
+_RTI_STATS_KERNEL(_rti_stats_add_32BUI, uint32_t)
+_RTI_STATS_KERNEL(_rti_stats_add_32BF, float)
+_RTI_STATS_KERNEL(_rti_stats_add_64BF, double)
+
+static _rti_stats_kernel _rti_stats_get_kernel(rt_pixtype pixtype) {
+	switch (pixtype) {
+		/* read as signed bytes, as rt_band_get_pixel() does */
+		case PT_1BB:
+		case PT_2BUI:
+		case PT_4BUI:
+		case PT_8BSI:
+			return _rti_stats_add_8BSI;
+		case PT_8BUI:
+			return _rti_stats_add_8BUI;
+		case PT_16BSI:
+			return _rti_stats_add_16BSI;
+		case PT_16BUI:
+			return _rti_stats_add_16BUI;
+		case PT_32BSI:
+			return _rti_stats_add_32BSI;
+		case PT_32BUI:
+			return _rti_stats_add_32BUI;
+		case PT_32BF:
+			return _rti_stats_add_32BF;
+		case PT_64BF:
+			return _rti_stats_add_64BF;
+		default:
+			break;
+	}
+
+	return NULL;
+}
+
+/*
+	NODATA value clamped to pixtype. a pixel value is NODATA if equal to
+	either the NODATA value or the clamped NODATA value, matching
+	rt_band_clamped_value_is_nodata()
+*/
+static double _rti_pixtype_clamp_value(rt_pixtype pixtype, double value) {
+	switch (pixtype) {
+		case PT_1BB:
+			return rt_util_clamp_to_1BB(value);
+		case PT_2BUI:
+			return rt_util_clamp_to_2BUI(value);
+		case PT_4BUI:
+			return rt_util_clamp_to_4BUI(value);
+		case PT_8BSI:
+			return rt_util_clamp_to_8BSI(value);
+		case PT_8BUI:
+			return rt_util_clamp_to_8BUI(value);
+		case PT_16BSI:
+			return rt_util_clamp_to_16BSI(value);
+		case PT_16BUI:
+			return rt_util_clamp_to_16BUI(value);
+		case PT_32BSI:
+			return rt_util_clamp_to_32BSI(value);
+		case PT_32BUI:
+			return rt_util_clamp_to_32BUI(value);
+		case PT_32BF:
+			return rt_util_clamp_to_32F(value);
+		case PT_64BF:
+		default:
+			break;
+	}
+
+	return value;
+}
+
 /**
  * Compute summary statistics for a band
  *
@@ -117,24 +371,17 @@ rt_band_get_summary_stats(
 	uint32_t z = 0;
 	uint32_t offset = 0;
 	uint32_t diff = 0;
-	int rtn;
 	int hasnodata = FALSE;
 	double nodata = 0;
-	double *values = NULL;
-	double value;
-	int isnodata = 0;
 	rt_bandstats stats = NULL;
+	_rti_stats_arg arg;
+	_rti_stats_kernel kernel = NULL;
 
 	uint32_t do_sample = 0;
 	uint32_t sample_size = 0;
 	uint32_t sample_per = 0;
 	uint32_t sample_int = 0;
 	uint32_t i = 0;
-	uint32_t j = 0;
-	double sum = 0;
-	uint32_t k = 0;
-	double M = 0;
-	double Q = 0;
 
 #if POSTGIS_DEBUG_LEVEL > 0
 	clock_t start, stop;
@@ -212,6 +459,25 @@ rt_band_get_summary_stats(
 		return stats;
 	}
 
+	/* read pixels directly from band data instead of by rt_band_get_pixel() */
+	memset(&arg, 0, sizeof(arg));
+	arg.data = rt_band_get_data(band);
+	if (arg.data == NULL) {
+		rterror("rt_band_get_summary_stats: Cannot get band data");
+		return NULL;
+	}
+	kernel = _rti_stats_get_kernel(band->pixtype);
+	if (kernel == NULL) {
+		rterror("rt_band_get_summary_stats: Unknown pixeltype %d", band->pixtype);
+		return NULL;
+	}
+	arg.exclude_nodata_value = exclude_nodata_value;
+	arg.nodata = nodata;
+	arg.cnodata = _rti_pixtype_clamp_value(band->pixtype, nodata);
+	arg.cK = cK;
+	arg.cM = cM;
+	arg.cQ = cQ;
+
 	/* clamp percentage */
 	if (
 		(sample < 0 || FLT_EQ(sample, 0.0)) ||
@@ -247,17 +513,16 @@ rt_band_get_summary_stats(
 		, sample_size, (band->width * band->height), sample_per);
 
 	if (inc_vals) {
-		values = rtalloc(sizeof(double) * sample_size);
-		if (NULL == values) {
+		arg.values = rtalloc(sizeof(double) * sample_size);
+		if (NULL == arg.values)
 			rtwarn("Could not allocate memory for values");
-			inc_vals = 0;
-		}
 	}
 
 	/* initialize stats */
 	stats = (rt_bandstats) rtalloc(sizeof(struct rt_bandstats_t));
 	if (NULL == stats) {
 		rterror("rt_band_get_summary_stats: Could not allocate memory for stats");
+		if (arg.values != NULL) rtdealloc(arg.values);
 		return NULL;
 	}
 	stats->sample = sample;
@@ -269,72 +534,24 @@ rt_band_get_summary_stats(
 	stats->values = NULL;
 	stats->sorted = 0;
 
-	for (x = 0, j = 0, k = 0; x < band->width; x++) {
+	for (x = 0; x < band->width; x++) {
+		/* whole column in one run */
+		if (!do_sample) {
+			kernel(&arg, x, band->height, band->width);
+			continue;
+		}
+
 		y = -1;
 		diff = 0;
 
 		for (i = 0, z = 0; i < sample_per; i++) {
-			if (!do_sample)
-				y = i;
-			else {
-				offset = (rand() % sample_int) + 1;
-				y += diff + offset;
-				diff = sample_int - offset;
-			}
+			offset = (rand() % sample_int) + 1;
+			y += diff + offset;
+			diff = sample_int - offset;
 			RASTER_DEBUGF(5, "(x, y, z) = (%d, %d, %d)", x, y, z);
 			if (y >= band->height || z > sample_per) break;
 
-			rtn = rt_band_get_pixel(band, x, y, &value, &isnodata);
-
-			j++;
-			if (rtn == ES_NONE && (!exclude_nodata_value || (exclude_nodata_value && !isnodata))) {
-
-				/* inc_vals set, collect pixel values */
-				if (inc_vals) values[k] = value;
-
-				/* average */
-				k++;
-				sum += value;
-
-				/*
-					one-pass standard deviation
-					http://www.eecs.berkeley.edu/~mhoemmen/cs194/Tutorials/variance.pdf
-				*/
-				if (k == 1) {
-					Q = 0;
-					M = value;
-				}
-				else {
-					Q += (((k  - 1) * pow(value - M, 2)) / k);
-					M += ((value - M ) / k);
-				}
-
-				/* coverage one-pass standard deviation */
-				if (NULL != cK) {
-					(*cK)++;
-					if (*cK == 1) {
-						*cQ = 0;
-						*cM = value;
-					}
-					else {
-						*cQ += (((*cK  - 1) * pow(value - *cM, 2)) / *cK);
-						*cM += ((value - *cM ) / *cK);
-					}
-				}
-
-				/* min/max */
-				if (stats->count < 1) {
-					stats->count = 1;
-					stats->min = stats->max = value;
-				}
-				else {
-					if (value < stats->min)
-						stats->min = value;
-					if (value > stats->max)
-						stats->max = value;
-				}
-
-			}
+			kernel(&arg, x + (y * band->width), 1, 1);
 
 			z++;
 		}
@@ -342,37 +559,39 @@ rt_band_get_summary_stats(
 
 	RASTER_DEBUG(3, "sampling complete");
 
-	stats->count = k;
-	if (k > 0) {
-		if (inc_vals) {
+	stats->count = arg.k;
+	if (arg.k > 0) {
+		if (arg.values != NULL) {
 			/* free unused memory */
-			if (sample_size != k) {
-				values = rtrealloc(values, k * sizeof(double));
+			if (sample_size != arg.k) {
+				arg.values = rtrealloc(arg.values, arg.k * sizeof(double));
 			}
 
-			stats->values = values;
+			stats->values = arg.values;
 		}
 
-		stats->sum = sum;
-		stats->mean = sum / k;
+		stats->sum = arg.sum;
+		stats->mean = arg.sum / arg.k;
+		stats->min = arg.min;
+		stats->max = arg.max;
 
 		/* standard deviation */
 		if (!do_sample)
-			stats->stddev = sqrt(Q / k);
+			stats->stddev = sqrt(arg.Q / arg.k);
 		/* sample deviation */
 		else {
-			if (k < 2)
+			if (arg.k < 2)
 				stats->stddev = -1;
 			else
-				stats->stddev = sqrt(Q / (k - 1));
+				stats->stddev = sqrt(arg.Q / (arg.k - 1));
 		}
 	}
 	/* inc_vals thus values allocated but not used */
-	else if (inc_vals)
-		rtdealloc(values);
+	else if (arg.values != NULL)
+		rtdealloc(arg.values);
 
 	/* if do_sample is one */
-	if (do_sample && k < 1)
+	if (do_sample && arg.k < 1)
 		rtwarn("All sampled pixels of band have the NODATA value");
 
 #if POSTGIS_DEBUG_LEVEL > 0
@@ -386,6 +605,138 @@ rt_band_get_summary_stats(
 	return stats;
 }
 
+/******************************************************************************
+* rt_raster_get_zonal_stats()
+******************************************************************************/
+
+typedef struct {
+	_rti_stats_arg stats;
+	_rti_stats_kernel kernel;
+} _rti_zonal_stats_arg;
+
+static rt_errorstate
+_rti_zonal_stats_span(void *_arg, int y, int x, int count) {
+	_rti_zonal_stats_arg *arg = (_rti_zonal_stats_arg *) _arg;
+
+	arg->kernel(&(arg->stats), x + ((uint32_t) y * arg->stats.width), count, 1);
+
+	return ES_NONE;
+}
+
+/**
+ * Compute summary statistics of the pixels of a band whose centers
+ * are inside a polygonal geometry, without creating a clipped raster
+ *
+ * @param raster : the raster of the band
+ * @param nband : 0-based index of the band
+ * @param geom : POLYGON or MULTIPOLYGON in the raster's coordinates
+ * @param exclude_nodata_value : if non-zero, ignore nodata values
+ * @param inc_vals : flag to include values in return struct
+ * @param cK : number of pixels counted thus far in coverage
+ * @param cM : M component of 1-pass stddev for coverage
+ * @param cQ : Q component of 1-pass stddev for coverage
+ *
+ * @return the summary statistics of the pixels or NULL
+ */
+rt_bandstats
+rt_raster_get_zonal_stats(
+	rt_raster raster, int nband,
+	const LWGEOM *geom,
+	int exclude_nodata_value, int inc_vals,
+	uint64_t *cK, double *cM, double *cQ
+) {
+	rt_band band = NULL;
+	rt_bandstats stats = NULL;
+	_rti_zonal_stats_arg arg;
+
+	assert(NULL != raster);
+	assert(NULL != geom);
+
+	band = rt_raster_get_band(raster, nband);
+	if (band == NULL) {
+		rterror("rt_raster_get_zonal_stats: Could not get band at index %d", nband);
+		return NULL;
+	}
+
+	stats = (rt_bandstats) rtalloc(sizeof(struct rt_bandstats_t));
+	if (NULL == stats) {
+		rterror("rt_raster_get_zonal_stats: Could not allocate memory for stats");
+		return NULL;
+	}
+	stats->sample = 1;
+	stats->count = 0;
+	stats->sum = 0;
+	stats->mean = 0;
+	stats->stddev = -1;
+	stats->min = stats->max = 0;
+	stats->values = NULL;
+	stats->sorted = 0;
+
+	memset(&arg, 0, sizeof(arg));
+	arg.stats.exclude_nodata_value = exclude_nodata_value;
+	if (rt_band_get_hasnodata_flag(band) != FALSE)
+		rt_band_get_nodata(band, &(arg.stats.nodata));
+	else
+		arg.stats.exclude_nodata_value = 0;
+
+	/* entire band is nodata */
+	if (arg.stats.exclude_nodata_value && rt_band_get_isnodata_flag(band) != FALSE)
+		return stats;
+
+	arg.kernel = _rti_stats_get_kernel(rt_band_get_pixtype(band));
+	if (arg.kernel == NULL) {
+		rterror("rt_raster_get_zonal_stats: Unknown pixeltype %d", rt_band_get_pixtype(band));
+		rtdealloc(stats);
+		return NULL;
+	}
+	arg.stats.width = band->width;
+	arg.stats.cnodata = _rti_pixtype_clamp_value(rt_band_get_pixtype(band), arg.stats.nodata);
+	arg.stats.cK = cK;
+	arg.stats.cM = cM;
+	arg.stats.cQ = cQ;
+
+	arg.stats.data = rt_band_get_data(band);
+	if (arg.stats.data == NULL) {
+		rterror("rt_raster_get_zonal_stats: Cannot get band data");
+		rtdealloc(stats);
+		return NULL;
+	}
+
+	/* upper bound of pixels in geometry */
+	if (inc_vals && band->width && band->height) {
+		arg.stats.values = rtalloc(sizeof(double) * band->width * band->height);
+		if (NULL == arg.stats.values)
+			rtwarn("Could not allocate memory for values");
+	}
+
+	if (rt_raster_scan_polygon(raster, geom, _rti_zonal_stats_span, &arg) != ES_NONE) {
+		rterror("rt_raster_get_zonal_stats: Could not scan geometry");
+		if (arg.stats.values != NULL) rtdealloc(arg.stats.values);
+		rtdealloc(stats);
+		return NULL;
+	}
+
+	stats->count = arg.stats.k;
+	if (arg.stats.k > 0) {
+		if (arg.stats.values != NULL) {
+			/* free unused memory */
+			if ((uint32_t) band->width * band->height != arg.stats.k)
+				arg.stats.values = rtrealloc(arg.stats.values, arg.stats.k * sizeof(double));
+			stats->values = arg.stats.values;
+		}
+
+		stats->sum = arg.stats.sum;
+		stats->mean = arg.stats.sum / arg.stats.k;
+		stats->stddev = sqrt(arg.stats.Q / arg.stats.k);
+		stats->min = arg.stats.min;
+		stats->max = arg.stats.max;
+	}
+	else if (arg.stats.values != NULL)
+		rtdealloc(arg.stats.values);
+
+	return stats;
+}
+
 /******************************************************************************
 * rt_band_get_histogram()
 ******************************************************************************/
@@ -419,6 +770,8 @@ rt_band_get_histogram(
 	int init_width = 0;
 	int i;
 	int j;
+	int lo;
+	int hi;
 	double tmp;
 	double value;
 	int sum = 0;
@@ -592,43 +945,47 @@ rt_band_get_histogram(
 			bins[bin_count - 1].min = qmin;
 	}
 
-	/* process the values */
+	/*
+		process the values
+
+		bins are ordered so the first bin accepting the value is found
+		by bisection. only the last bin is inclusive at its far edge
+	*/
 	for (i = 0; i < stats->count; i++) {
 		value = stats->values[i];
+		lo = 0;
+		hi = bin_count;
 
 		/* default, [a, b) */
 		if (!right) {
-			for (j = 0; j < bin_count; j++) {
-				if (
-					(!bins[j].inc_max && value < bins[j].max) || (
-						bins[j].inc_max && (
-							(value < bins[j].max) ||
-							FLT_EQ(value, bins[j].max)
-						)
-					)
-				) {
-					bins[j].count++;
-					sum++;
-					break;
-				}
+			while (lo < hi) {
+				j = lo + (hi - lo) / 2;
+				if (value < bins[j].max)
+					hi = j;
+				else
+					lo = j + 1;
 			}
+
+			if (lo == bin_count && FLT_EQ(value, bins[bin_count - 1].max))
+				lo = bin_count - 1;
 		}
 		/* (a, b] */
 		else {
-			for (j = 0; j < bin_count; j++) {
-				if (
-					(!bins[j].inc_min && value > bins[j].min) || (
-						bins[j].inc_min && (
-							(value > bins[j].min) ||
-							FLT_EQ(value, bins[j].min)
-						)
-					)
-				) {
-					bins[j].count++;
-					sum++;
-					break;
-				}
+			while (lo < hi) {
+				j = lo + (hi - lo) / 2;
+				if (value > bins[j].min)
+					hi = j;
+				else
+					lo = j + 1;
 			}
+
+			if (lo == bin_count && FLT_EQ(value, bins[bin_count - 1].min))
+				lo = bin_count - 1;
+		}
+
+		if (lo < bin_count) {
+			bins[lo].count++;
+			sum++;
 		}
 	}
 
@@ -679,6 +1036,7 @@ rt_band_get_quantiles(
 	int i = 0;
 	double h;
 	int hl;
+	uint32_t left = 0;
 
 #if POSTGIS_DEBUG_LEVEL > 0
 	clock_t start, stop;
@@ -735,17 +1093,14 @@ rt_band_get_quantiles(
 		return NULL;
 	}
 
-	/* sort values */
-	if (!stats->sorted) {
-		quicksort(stats->values, stats->values + stats->count - 1);
-		stats->sorted = 1;
-	}
-
 	/*
 		make quantiles
 
 		formula is that used in R (method 7) and Excel from
 			http://en.wikipedia.org/wiki/Quantile
+
+		values are not sorted. instead, the values needed are selected in
+		ascending order, each selection only looking past the previous one
 	*/
 	for (i = 0; i < quantiles_count; i++) {
 		rtn[i].quantile = quantiles[i];
@@ -753,6 +1108,17 @@ rt_band_get_quantiles(
 		h = ((stats->count - 1.) * quantiles[i]) + 1.;
 		hl = floor(h);
 
+		if (!stats->sorted) {
+			if ((uint32_t) (hl - 1) >= left) {
+				quickselect(stats->values, left, stats->count - 1, hl - 1);
+				left = hl - 1;
+			}
+			if (h > hl && (uint32_t) hl > left) {
+				quickselect(stats->values, left + 1, stats->count - 1, hl);
+				left = hl;
+			}
+		}
+
 		/* h greater than hl, do full equation */
 		if (h > hl)
 			rtn[i].value = stats->values[hl - 1] + ((h - hl) * (stats->values[hl] - stats->values[hl - 1]));
@@ -1586,6 +1952,404 @@ rt_band_get_quantiles_stream(
 	return rtn;
 }
 
+/******************************************************************************
+* rt_quantile_sketch
+******************************************************************************/
+
+#define RT_QUANTILE_SKETCH_COMPRESSION 100
+
+static int _rti_quantile_centroid_cmp(const void *a, const void *b) {
+	const struct rt_quantile_centroid_t *ca = a;
+	const struct rt_quantile_centroid_t *cb = b;
+
+	if (ca->mean < cb->mean) return -1;
+	if (ca->mean > cb->mean) return 1;
+	return 0;
+}
+
+/* scale function k1 of the t-digest and its inverse */
+static double _rti_quantile_sketch_k(double compression, double q) {
+	return compression / (2. * M_PI) * asin(2. * q - 1.);
+}
+
+static double _rti_quantile_sketch_q(double compression, double k) {
+	if (k >= compression / 4.) return 1.;
+	return (sin(k * (2. * M_PI) / compression) + 1.) / 2.;
+}
+
+/*
+	merge the buffered values into the centroids. each centroid may only
+	grow while it spans no more than one unit of the scale function, so
+	centroids stay small near the extremes
+*/
+static void _rti_quantile_sketch_compress(rt_quantile_sketch sketch) {
+	struct rt_quantile_centroid_t *c = sketch->centroids;
+	uint32_t n = sketch->count + sketch->buffered;
+	uint32_t i = 0;
+	uint32_t j = 0;
+	double so_far = 0;
+	double q_limit = 0;
+
+	if (sketch->buffered < 1)
+		return;
+
+	qsort(c, n, sizeof(struct rt_quantile_centroid_t), _rti_quantile_centroid_cmp);
+
+	q_limit = _rti_quantile_sketch_q(
+		sketch->compression,
+		_rti_quantile_sketch_k(sketch->compression, 0) + 1.
+	);
+	for (i = 1; i < n; i++) {
+		if ((so_far + c[j].weight + c[i].weight) / sketch->total <= q_limit) {
+			c[j].weight += c[i].weight;
+			c[j].mean += (c[i].mean - c[j].mean) * c[i].weight / c[j].weight;
+		}
+		else {
+			so_far += c[j].weight;
+			q_limit = _rti_quantile_sketch_q(
+				sketch->compression,
+				_rti_quantile_sketch_k(sketch->compression, so_far / sketch->total) + 1.
+			);
+			c[++j] = c[i];
+		}
+	}
+
+	sketch->count = j + 1;
+	sketch->buffered = 0;
+}
+
+rt_quantile_sketch rt_quantile_sketch_new(double compression) {
+	rt_quantile_sketch sketch = NULL;
+
+	if (compression <= 0)
+		compression = RT_QUANTILE_SKETCH_COMPRESSION;
+
+	sketch = rtalloc(sizeof(struct rt_quantile_sketch_t));
+	if (NULL == sketch) {
+		rterror("rt_quantile_sketch_new: Could not allocate memory for sketch");
+		return NULL;
+	}
+
+	/* compressing leaves at most compression + 2 centroids, buffer the rest */
+	sketch->compression = compression;
+	sketch->capacity = 5 * ((uint32_t) ceil(compression) + 2);
+	sketch->count = 0;
+	sketch->buffered = 0;
+	sketch->total = 0;
+	sketch->min = 0;
+	sketch->max = 0;
+
+	sketch->centroids = rtalloc(sizeof(struct rt_quantile_centroid_t) * sketch->capacity);
+	if (NULL == sketch->centroids) {
+		rterror("rt_quantile_sketch_new: Could not allocate memory for sketch centroids");
+		rtdealloc(sketch);
+		return NULL;
+	}
+
+	return sketch;
+}
+
+void rt_quantile_sketch_destroy(rt_quantile_sketch sketch) {
+	if (NULL == sketch)
+		return;
+
+	if (NULL != sketch->centroids)
+		rtdealloc(sketch->centroids);
+	rtdealloc(sketch);
+}
+
+rt_errorstate rt_quantile_sketch_add(
+	rt_quantile_sketch sketch,
+	double value, double weight
+) {
+	struct rt_quantile_centroid_t *c = NULL;
+
+	assert(NULL != sketch);
+
+	if (weight <= 0)
+		return ES_NONE;
+	if (isnan(value)) {
+		rterror("rt_quantile_sketch_add: Cannot add NaN to sketch");
+		return ES_ERROR;
+	}
+
+	if (sketch->count + sketch->buffered >= sketch->capacity)
+		_rti_quantile_sketch_compress(sketch);
+
+	if (sketch->total <= 0) {
+		sketch->min = value;
+		sketch->max = value;
+	}
+	else if (value < sketch->min)
+		sketch->min = value;
+	else if (value > sketch->max)
+		sketch->max = value;
+
+	c = &(sketch->centroids[sketch->count + sketch->buffered]);
+	c->mean = value;
+	c->weight = weight;
+	sketch->buffered++;
+	sketch->total += weight;
+
+	return ES_NONE;
+}
+
+rt_errorstate rt_quantile_sketch_add_band(
+	rt_quantile_sketch sketch,
+	rt_band band, int exclude_nodata_value, double sample
+) {
+	rt_bandstats stats = NULL;
+	uint32_t i = 0;
+	rt_errorstate err = ES_NONE;
+
+	assert(NULL != sketch);
+	assert(NULL != band);
+
+	stats = rt_band_get_summary_stats(
+		band, exclude_nodata_value,
+		sample, 1,
+		NULL, NULL, NULL
+	);
+	if (NULL == stats) {
+		rterror("rt_quantile_sketch_add_band: Could not get summary stats of band");
+		return ES_ERROR;
+	}
+
+	/* band is entirely nodata and nodata is not excluded */
+	if (stats->count > 0 && NULL == stats->values)
+		err = rt_quantile_sketch_add(sketch, stats->min, stats->count);
+	else {
+		for (i = 0; i < stats->count && err == ES_NONE; i++)
+			err = rt_quantile_sketch_add(sketch, stats->values[i], 1);
+	}
+
+	if (NULL != stats->values)
+		rtdealloc(stats->values);
+	rtdealloc(stats);
+
+	return err;
+}
+
+rt_errorstate rt_quantile_sketch_merge(
+	rt_quantile_sketch sketch,
+	rt_quantile_sketch other
+) {
+	uint32_t i = 0;
+	uint32_t n = 0;
+
+	assert(NULL != sketch);
+	assert(NULL != other);
+
+	n = other->count + other->buffered;
+	for (i = 0; i < n; i++) {
+		if (rt_quantile_sketch_add(sketch, other->centroids[i].mean, other->centroids[i].weight) != ES_NONE)
+			return ES_ERROR;
+	}
+
+	/* the extremes of other may have been merged into its centroids */
+	if (other->total > 0) {
+		if (other->min < sketch->min)
+			sketch->min = other->min;
+		if (other->max > sketch->max)
+			sketch->max = other->max;
+	}
+
+	return ES_NONE;
+}
+
+rt_quantile rt_quantile_sketch_get_quantiles(
+	rt_quantile_sketch sketch,
+	double *quantiles, int quantiles_count,
+	uint32_t *rtn_count
+) {
+	struct rt_quantile_centroid_t *c = NULL;
+	rt_quantile rtn;
+	int init_quantiles = 0;
+	int i = 0;
+	uint32_t j = 0;
+	double h;
+	double t;
+	double left;
+	double right;
+
+	assert(NULL != sketch);
+	assert(NULL != rtn_count);
+
+	if (sketch->total <= 0) {
+		rterror("rt_quantile_sketch_get_quantiles: Sketch has no value");
+		return NULL;
+	}
+
+	/* quantiles not provided */
+	if (NULL == quantiles) {
+		/* quantile count not specified, default to quartiles */
+		if (quantiles_count < 2)
+			quantiles_count = 5;
+
+		quantiles = rtalloc(sizeof(double) * quantiles_count);
+		init_quantiles = 1;
+		if (NULL == quantiles) {
+			rterror("rt_quantile_sketch_get_quantiles: Could not allocate memory for quantile input");
+			return NULL;
+		}
+
+		quantiles_count--;
+		for (i = 0; i <= quantiles_count; i++)
+			quantiles[i] = ((double) i) / quantiles_count;
+		quantiles_count++;
+	}
+
+	/* check quantiles */
+	for (i = 0; i < quantiles_count; i++) {
+		if (quantiles[i] < 0. || quantiles[i] > 1.) {
+			rterror("rt_quantile_sketch_get_quantiles: Quantile value not between 0 and 1");
+			if (init_quantiles) rtdealloc(quantiles);
+			return NULL;
+		}
+	}
+
+	rtn = rtalloc(sizeof(struct rt_quantile_t) * quantiles_count);
+	if (NULL == rtn) {
+		rterror("rt_quantile_sketch_get_quantiles: Could not allocate memory for quantile output");
+		if (init_quantiles) rtdealloc(quantiles);
+		return NULL;
+	}
+
+	_rti_quantile_sketch_compress(sketch);
+	c = sketch->centroids;
+
+	/*
+		the same formula as rt_band_get_quantiles() over ranks 0 to total - 1,
+		with each centroid standing at the middle rank of the values it
+		holds and min and max at the first and last ranks. interpolate
+		linearly between those
+	*/
+	for (i = 0; i < quantiles_count; i++) {
+		rtn[i].quantile = quantiles[i];
+		rtn[i].has_value = 1;
+
+		h = (sketch->total - 1.) * quantiles[i];
+
+		/* between min and the first centroid */
+		right = (c[0].weight - 1.) / 2.;
+		if (h <= right) {
+			rtn[i].value = (right > 0)
+				? sketch->min + (h / right) * (c[0].mean - sketch->min)
+				: c[0].mean;
+			continue;
+		}
+
+		/* between two centroids */
+		t = 0;
+		for (j = 0; j < sketch->count - 1; j++) {
+			left = t + (c[j].weight - 1.) / 2.;
+			right = t + c[j].weight + (c[j + 1].weight - 1.) / 2.;
+			if (h <= right)
+				break;
+			t += c[j].weight;
+		}
+		if (j < sketch->count - 1) {
+			rtn[i].value = c[j].mean + ((h - left) / (right - left)) * (c[j + 1].mean - c[j].mean);
+			continue;
+		}
+
+		/* between the last centroid and max */
+		left = t + (c[j].weight - 1.) / 2.;
+		right = sketch->total - 1.;
+		rtn[i].value = (right > left)
+			? c[j].mean + ((h - left) / (right - left)) * (sketch->max - c[j].mean)
+			: c[j].mean;
+	}
+
+	*rtn_count = quantiles_count;
+	if (init_quantiles) rtdealloc(quantiles);
+	return rtn;
+}
+
+uint8_t *rt_quantile_sketch_serialize(
+	rt_quantile_sketch sketch,
+	uint32_t *size
+) {
+	uint8_t *data = NULL;
+	uint8_t *ptr = NULL;
+
+	assert(NULL != sketch);
+	assert(NULL != size);
+
+	_rti_quantile_sketch_compress(sketch);
+
+	/* compression, count, total, min, max and centroids */
+	*size = sizeof(double) * 4 + sizeof(uint32_t) +
+		sizeof(struct rt_quantile_centroid_t) * sketch->count;
+	data = rtalloc(*size);
+	if (NULL == data) {
+		rterror("rt_quantile_sketch_serialize: Could not allocate memory for buffer");
+		return NULL;
+	}
+
+	ptr = data;
+	memcpy(ptr, &(sketch->compression), sizeof(double));
+	ptr += sizeof(double);
+	memcpy(ptr, &(sketch->count), sizeof(uint32_t));
+	ptr += sizeof(uint32_t);
+	memcpy(ptr, &(sketch->total), sizeof(double));
+	ptr += sizeof(double);
+	memcpy(ptr, &(sketch->min), sizeof(double));
+	ptr += sizeof(double);
+	memcpy(ptr, &(sketch->max), sizeof(double));
+	ptr += sizeof(double);
+	memcpy(ptr, sketch->centroids, sizeof(struct rt_quantile_centroid_t) * sketch->count);
+
+	return data;
+}
+
+rt_quantile_sketch rt_quantile_sketch_deserialize(
+	const uint8_t *data,
+	uint32_t size
+) {
+	rt_quantile_sketch sketch = NULL;
+	double compression = 0;
+	uint32_t count = 0;
+	uint32_t header = sizeof(double) * 4 + sizeof(uint32_t);
+
+	assert(NULL != data);
+
+	if (size < header) {
+		rterror("rt_quantile_sketch_deserialize: Buffer is too small");
+		return NULL;
+	}
+
+	memcpy(&compression, data, sizeof(double));
+	data += sizeof(double);
+	memcpy(&count, data, sizeof(uint32_t));
+	data += sizeof(uint32_t);
+
+	if (size != header + sizeof(struct rt_quantile_centroid_t) * count) {
+		rterror("rt_quantile_sketch_deserialize: Buffer size does not match centroid count");
+		return NULL;
+	}
+
+	sketch = rt_quantile_sketch_new(compression);
+	if (NULL == sketch)
+		return NULL;
+	if (count > sketch->capacity) {
+		rterror("rt_quantile_sketch_deserialize: Too many centroids for compression");
+		rt_quantile_sketch_destroy(sketch);
+		return NULL;
+	}
+
+	memcpy(&(sketch->total), data, sizeof(double));
+	data += sizeof(double);
+	memcpy(&(sketch->min), data, sizeof(double));
+	data += sizeof(double);
+	memcpy(&(sketch->max), data, sizeof(double));
+	data += sizeof(double);
+	memcpy(sketch->centroids, data, sizeof(struct rt_quantile_centroid_t) * count);
+	sketch->count = count;
+
+	return sketch;
+}
+
 /******************************************************************************
 * rt_band_get_value_count()
 ******************************************************************************/
@@ -34,10 +34,50 @@
 #include "librtcore.h"
 #include "librtcore_internal.h"
 
+#include "cpl_string.h" /* for CSLSetNameValue */
+
 /******************************************************************************
 * rt_raster_gdal_warp()
 ******************************************************************************/
 
+/* variables for PostgreSQL GUCs: postgis.gdal_warp_num_threads and postgis.gdal_warp_memory_limit */
+int gdal_warp_num_threads = 1;
+int gdal_warp_memory_limit = 0;
+
+/*
+	last converted source and destination spatial references
+	kept across calls as consecutive rasters usually share them
+*/
+static struct {
+	char *srs;
+	char *wkt;
+} _rti_warp_srs_cache[2] = {{NULL, NULL}, {NULL, NULL}};
+
+/* idx: 0 for source, 1 for destination */
+static char *
+_rti_warp_convert_sr(const char *srs, int idx) {
+	char *wkt = NULL;
+
+	if (
+		_rti_warp_srs_cache[idx].srs != NULL &&
+		strcmp(_rti_warp_srs_cache[idx].srs, srs) == 0
+	) {
+		RASTER_DEBUGF(4, "Using cached conversion of srs %d", idx);
+		return CPLStrdup(_rti_warp_srs_cache[idx].wkt);
+	}
+
+	wkt = rt_util_gdal_convert_sr(srs, 0);
+	if (wkt == NULL)
+		return NULL;
+
+	CPLFree(_rti_warp_srs_cache[idx].srs);
+	CPLFree(_rti_warp_srs_cache[idx].wkt);
+	_rti_warp_srs_cache[idx].srs = CPLStrdup(srs);
+	_rti_warp_srs_cache[idx].wkt = CPLStrdup(wkt);
+
+	return wkt;
+}
+
 typedef struct _rti_warp_arg_t* _rti_warp_arg;
 struct _rti_warp_arg_t {
 
@@ -237,8 +277,8 @@ rt_raster rt_raster_gdal_warp(
 		/* reprojection taking place */
 		if (dst_srs != NULL && strcmp(src_srs, dst_srs) != 0) {
 			RASTER_DEBUG(4, "Warp operation does include a reprojection");
-			arg->src.srs = rt_util_gdal_convert_sr(src_srs, 0);
-			arg->dst.srs = rt_util_gdal_convert_sr(dst_srs, 0);
+			arg->src.srs = _rti_warp_convert_sr(src_srs, 0);
+			arg->dst.srs = _rti_warp_convert_sr(dst_srs, 1);
 
 			if (arg->src.srs == NULL || arg->dst.srs == NULL) {
 				rterror("rt_raster_gdal_warp: Could not convert srs values to GDAL accepted format");
@@ -871,10 +911,23 @@ rt_raster rt_raster_gdal_warp(
 	arg->wopts->hDstDS = arg->dst.ds;
 	arg->wopts->pfnTransformer = arg->transform.func;
 	arg->wopts->pTransformerArg = arg->transform.arg.transform;
-	arg->wopts->papszWarpOptions = (char **) CPLMalloc(sizeof(char *) * 2);
-	arg->wopts->papszWarpOptions[0] = (char *) CPLMalloc(sizeof(char) * (strlen("INIT_DEST=NO_DATA") + 1));
-	strcpy(arg->wopts->papszWarpOptions[0], "INIT_DEST=NO_DATA");
-	arg->wopts->papszWarpOptions[1] = NULL;
+	arg->wopts->papszWarpOptions = CSLSetNameValue(NULL, "INIT_DEST", "NO_DATA");
+
+	/* number of threads of warp kernel, 0 for all CPUs */
+	if (gdal_warp_num_threads != 1) {
+		char num_threads[16];
+
+		if (gdal_warp_num_threads < 1)
+			strcpy(num_threads, "ALL_CPUS");
+		else
+			snprintf(num_threads, sizeof(num_threads), "%d", gdal_warp_num_threads);
+		arg->wopts->papszWarpOptions = CSLSetNameValue(arg->wopts->papszWarpOptions, "NUM_THREADS", num_threads);
+		RASTER_DEBUGF(4, "NUM_THREADS = %s", num_threads);
+	}
+
+	/* memory limit (kB) of warp chunks, 0 for GDAL's default */
+	if (gdal_warp_memory_limit > 0)
+		arg->wopts->dfWarpMemoryLimit = gdal_warp_memory_limit * 1024.;
 
 	/* set band mapping */
 	arg->wopts->nBandCount = numBands;
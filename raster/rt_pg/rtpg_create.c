@@ -1055,7 +1055,12 @@ Datum RASTER_tile(PG_FUNCTION_ARGS)
 			SRF_RETURN_DONE(funcctx);
 		}
 
-		pgraster = (rt_pgraster *) PG_DETOAST_DATUM_COPY(PG_GETARG_DATUM(0));
+		/*
+			no copy of the detoasted raster is needed as arguments
+			remain valid across calls. deserialized bands read their
+			data from it
+		*/
+		pgraster = (rt_pgraster *) PG_DETOAST_DATUM(PG_GETARG_DATUM(0));
 		arg1->raster.raster = rt_raster_deserialize(pgraster, FALSE);
 		if (!arg1->raster.raster) {
 			ereport(ERROR, (
@@ -1273,7 +1278,6 @@ Datum RASTER_tile(PG_FUNCTION_ARGS)
 		int width = 0;
 		int height = 0;
 
-		int k = 0;
 		int tx = 0;
 		int ty = 0;
 		int rx = 0;
@@ -1282,9 +1286,6 @@ Datum RASTER_tile(PG_FUNCTION_ARGS)
 		int ey = 0; /* edge tile on bottom */
 		double ulx = 0;
 		double uly = 0;
-		uint16_t len = 0;
-		void *vals = NULL;
-		uint16_t nvals;
 
 		POSTGIS_RT_DEBUGF(3, "call number %d", call_cntr);
 
@@ -1344,12 +1345,6 @@ Datum RASTER_tile(PG_FUNCTION_ARGS)
 		rt_raster_set_offsets(tile, ulx, uly);
 		POSTGIS_RT_DEBUGF(4, "spatial coordinates = %f, %f", ulx, uly);
 
-		/* compute length of pixel line to read */
-		len = arg2->tile.width;
-		if (rx + arg2->tile.width >= arg2->raster.width)
-			len = arg2->raster.width - rx;
-		POSTGIS_RT_DEBUGF(3, "read line len = %d", len);
-
 		/* copy bands to tile */
 		for (i = 0; i < arg2->numbands; i++) {
 			POSTGIS_RT_DEBUGF(4, "copying band %d to tile %d", arg2->nbands[i], call_cntr);
@@ -1376,62 +1371,37 @@ Datum RASTER_tile(PG_FUNCTION_ARGS)
 			else
 				nodataval = rt_band_get_min_value(_band);
 
-			/* inline band */
+			/* inline band, copy the tile's rows of the source band */
 			if (!rt_band_is_offline(_band)) {
-				if (rt_raster_generate_new_band(tile, pixtype, nodataval, hasnodata, nodataval, i) < 0) {
+				band = rt_band_new_window(
+					_band,
+					rx, ry,
+					width, height,
+					hasnodata, nodataval
+				);
+				if (band == NULL) {
 					rt_raster_destroy(tile);
 					rt_raster_destroy(arg2->raster.raster);
-					pfree(arg2->nbands);
+					if (arg2->numbands) pfree(arg2->nbands);
 					pfree(arg2);
-					elog(ERROR, "RASTER_tile: Could not add new band to output tile");
+					elog(ERROR, "RASTER_tile: Could not create new band for output tile");
 					SRF_RETURN_DONE(funcctx);
 				}
-				band = rt_raster_get_band(tile, i);
-				if (band == NULL) {
+
+				if (rt_raster_add_band(tile, band, i) < 0) {
+					rt_band_destroy(band);
 					rt_raster_destroy(tile);
 					rt_raster_destroy(arg2->raster.raster);
 					if (arg2->numbands) pfree(arg2->nbands);
 					pfree(arg2);
-					elog(ERROR, "RASTER_tile: Could not get newly added band from output tile");
+					elog(ERROR, "RASTER_tile: Could not add new band to output tile");
 					SRF_RETURN_DONE(funcctx);
 				}
-
-				/* if isnodata, set flag and continue */
-				if (rt_band_get_isnodata_flag(_band)) {
-					rt_band_set_isnodata_flag(band, 1);
-					continue;
-				}
-
-				/* copy data */
-				for (j = 0; j < arg2->tile.height; j++) {
-					k = ry + j;
-
-					if (k >= arg2->raster.height) {
-						POSTGIS_RT_DEBUGF(4, "row %d is beyond extent of source raster. skipping", k);
-						continue;
-					}
-
-					POSTGIS_RT_DEBUGF(4, "getting pixel line %d, %d for %d pixels", rx, k, len);
-					if (rt_band_get_pixel_line(_band, rx, k, len, &vals, &nvals) != ES_NONE) {
-						rt_raster_destroy(tile);
-						rt_raster_destroy(arg2->raster.raster);
-						if (arg2->numbands) pfree(arg2->nbands);
-						pfree(arg2);
-						elog(ERROR, "RASTER_tile: Could not get pixel line from source raster");
-						SRF_RETURN_DONE(funcctx);
-					}
-
-					if (nvals && rt_band_set_pixel_line(band, 0, j, vals, nvals) != ES_NONE) {
-						rt_raster_destroy(tile);
-						rt_raster_destroy(arg2->raster.raster);
-						if (arg2->numbands) pfree(arg2->nbands);
-						pfree(arg2);
-						elog(ERROR, "RASTER_tile: Could not set pixel line of output tile");
-						SRF_RETURN_DONE(funcctx);
-					}
-				}
 			}
-			/* offline */
+			/*
+				offline band, only reference the external band as the
+				tile's georeference locates its pixels in the file
+			*/
 			else {
 				uint8_t bandnum = 0;
 				rt_band_get_ext_band_num(_band, &bandnum);
@@ -59,6 +59,10 @@ Datum RASTER_getPolygon(PG_FUNCTION_ARGS);
 /* rasterize a geometry */
 Datum RASTER_asRaster(PG_FUNCTION_ARGS);
 
+/* rasterize geometries into one raster */
+Datum RASTER_asRaster_transfn(PG_FUNCTION_ARGS);
+Datum RASTER_asRaster_finalfn(PG_FUNCTION_ARGS);
+
 /* ---------------------------------------------------------------- */
 /*  Raster envelope                                                 */
 /* ---------------------------------------------------------------- */
@@ -192,8 +196,8 @@ PG_FUNCTION_INFO_V1(RASTER_dumpAsPolygons);
 Datum RASTER_dumpAsPolygons(PG_FUNCTION_ARGS) {
 	FuncCallContext *funcctx;
 	TupleDesc tupdesc;
-	rt_geomval geomval;
-	rt_geomval geomval2;
+	rt_polygonizer poly;
+	rt_polygonizer poly2;
 	int call_cntr;
 	int max_calls;
 
@@ -205,7 +209,6 @@ Datum RASTER_dumpAsPolygons(PG_FUNCTION_ARGS) {
 		rt_raster raster = NULL;
 		int nband;
 		bool exclude_nodata_value = TRUE;
-		int nElements;
 
 		POSTGIS_RT_DEBUG(2, "RASTER_dumpAsPolygons first call");
 
@@ -263,12 +266,12 @@ Datum RASTER_dumpAsPolygons(PG_FUNCTION_ARGS) {
 		/* Polygonize raster */
 
 		/**
-		 * Dump raster
+		 * Group pixels now, polygons are traced one per call
 		 */
-		geomval = rt_raster_gdal_polygonize(raster, nband - 1, exclude_nodata_value, &nElements);
+		poly = rt_polygonizer_new(raster, nband - 1, exclude_nodata_value);
 		rt_raster_destroy(raster);
 		PG_FREE_IF_COPY(pgraster, 0);
-		if (NULL == geomval) {
+		if (NULL == poly) {
 			ereport(ERROR, (
 				errcode(ERRCODE_NO_DATA_FOUND),
 				errmsg("Could not polygonize raster")
@@ -277,13 +280,13 @@ Datum RASTER_dumpAsPolygons(PG_FUNCTION_ARGS) {
 			SRF_RETURN_DONE(funcctx);
 		}
 
-		POSTGIS_RT_DEBUGF(3, "raster dump, %d elements returned", nElements);
+		POSTGIS_RT_DEBUGF(3, "raster dump, %d elements to return", poly->count);
 
 		/* Store needed information */
-		funcctx->user_fctx = geomval;
+		funcctx->user_fctx = poly;
 
 		/* total number of tuples to be returned */
-		funcctx->max_calls = nElements;
+		funcctx->max_calls = poly->count;
 
 		/* Build a tuple descriptor for our result type */
 		if (get_call_result_type(fcinfo, NULL, &tupdesc) != TYPEFUNC_COMPOSITE) {
@@ -305,7 +308,7 @@ Datum RASTER_dumpAsPolygons(PG_FUNCTION_ARGS) {
 	call_cntr = funcctx->call_cntr;
 	max_calls = funcctx->max_calls;
 	tupdesc = funcctx->tuple_desc;
-	geomval2 = funcctx->user_fctx;
+	poly2 = funcctx->user_fctx;
 
 	/* do when there is more left to send */
 	if (call_cntr < max_calls) {
@@ -315,6 +318,8 @@ Datum RASTER_dumpAsPolygons(PG_FUNCTION_ARGS) {
 		HeapTuple    tuple;
 		Datum        result;
 
+		LWPOLY *geom = NULL;
+		double val = 0;
 		GSERIALIZED *gser = NULL;
 		size_t gser_size = 0;
 
@@ -322,12 +327,15 @@ Datum RASTER_dumpAsPolygons(PG_FUNCTION_ARGS) {
 
 		memset(nulls, FALSE, sizeof(bool) * values_length);
 
+		/* trace polygon of next group of pixels */
+		geom = rt_polygonizer_next(poly2, &val);
+
 		/* convert LWGEOM to GSERIALIZED */
-		gser = gserialized_from_lwgeom(lwpoly_as_lwgeom(geomval2[call_cntr].geom), &gser_size);
-		lwgeom_free(lwpoly_as_lwgeom(geomval2[call_cntr].geom));
+		gser = gserialized_from_lwgeom(lwpoly_as_lwgeom(geom), &gser_size);
+		lwgeom_free(lwpoly_as_lwgeom(geom));
 
 		values[0] = PointerGetDatum(gser);
-		values[1] = Float8GetDatum(geomval2[call_cntr].val);
+		values[1] = Float8GetDatum(val);
 
 		/* build a tuple */
 		tuple = heap_form_tuple(tupdesc, values, nulls);
@@ -339,7 +347,7 @@ Datum RASTER_dumpAsPolygons(PG_FUNCTION_ARGS) {
 	}
 	/* do when there is no more left */
 	else {
-		pfree(geomval2);
+		rt_polygonizer_destroy(poly2);
 		SRF_RETURN_DONE(funcctx);
 	}
 }
@@ -1317,3 +1325,179 @@ Datum RASTER_asRaster(PG_FUNCTION_ARGS)
 	SET_VARSIZE(pgrast, pgrast->size);
 	PG_RETURN_POINTER(pgrast);
 }
+
+/* ---------------------------------------------------------------- */
+/*  Rasterize geometries into one raster                            */
+/* ---------------------------------------------------------------- */
+
+typedef struct rtpg_asraster_arg_t *rtpg_asraster_arg;
+struct rtpg_asraster_arg_t {
+	rt_raster raster;
+	int srid;
+	bool touched;
+};
+
+/**
+ * Burn a geometry into the raster of the aggregate, created on the
+ * grid of the first reference raster
+ */
+PG_FUNCTION_INFO_V1(RASTER_asRaster_transfn);
+Datum RASTER_asRaster_transfn(PG_FUNCTION_ARGS)
+{
+	MemoryContext aggcontext;
+	MemoryContext oldcontext;
+	rtpg_asraster_arg state = NULL;
+
+	GSERIALIZED *gser = NULL;
+	LWGEOM *geom = NULL;
+	int srid = SRID_UNKNOWN;
+	double value = 1;
+
+	rt_pgraster *pgraster = NULL;
+	rt_raster ref = NULL;
+	double gt[6] = {0};
+
+	text *pixeltypetext = NULL;
+	char *pixeltype = NULL;
+	rt_pixtype pixtype = PT_8BUI;
+	double nodataval = 0;
+	bool hasnodata = TRUE;
+
+	/* cannot be called directly as this is exclusive aggregate function */
+	if (!AggCheckCallContext(fcinfo, &aggcontext)) {
+		elog(ERROR, "RASTER_asRaster_transfn: Cannot be called in a non-aggregate context");
+		PG_RETURN_NULL();
+	}
+
+	if (!PG_ARGISNULL(0))
+		state = (rtpg_asraster_arg) PG_GETARG_POINTER(0);
+
+	/* raster of the aggregate */
+	if (state == NULL) {
+		/* no reference raster yet */
+		if (PG_ARGISNULL(3))
+			PG_RETURN_NULL();
+
+		/* pixel type */
+		if (PG_NARGS() > 4 && !PG_ARGISNULL(4)) {
+			pixeltypetext = PG_GETARG_TEXT_P(4);
+			pixeltype = rtpg_trim(text_to_cstring(pixeltypetext));
+			pixtype = rt_pixtype_index_from_name(pixeltype);
+			if (pixtype == PT_END) {
+				elog(ERROR, "RASTER_asRaster_transfn: Invalid pixel type provided: %s", pixeltype);
+				PG_RETURN_NULL();
+			}
+		}
+
+		/* NODATA value */
+		if (PG_NARGS() > 5) {
+			if (PG_ARGISNULL(5))
+				hasnodata = FALSE;
+			else
+				nodataval = PG_GETARG_FLOAT8(5);
+		}
+
+		pgraster = (rt_pgraster *) PG_DETOAST_DATUM_SLICE(PG_GETARG_DATUM(3), 0, sizeof(struct rt_raster_serialized_t));
+		ref = rt_raster_deserialize(pgraster, TRUE);
+		if (ref == NULL) {
+			PG_FREE_IF_COPY(pgraster, 3);
+			elog(ERROR, "RASTER_asRaster_transfn: Could not deserialize reference raster");
+			PG_RETURN_NULL();
+		}
+		rt_raster_get_geotransform_matrix(ref, gt);
+
+		oldcontext = MemoryContextSwitchTo(aggcontext);
+
+		state = palloc(sizeof(struct rtpg_asraster_arg_t));
+		state->srid = rt_raster_get_srid(ref);
+		state->touched = (PG_NARGS() > 6 && !PG_ARGISNULL(6)) ? PG_GETARG_BOOL(6) : FALSE;
+
+		/* raster initialized to NODATA on the grid of the reference raster */
+		state->raster = rt_raster_new(rt_raster_get_width(ref), rt_raster_get_height(ref));
+		if (state->raster == NULL) {
+			MemoryContextSwitchTo(oldcontext);
+			rt_raster_destroy(ref);
+			PG_FREE_IF_COPY(pgraster, 3);
+			elog(ERROR, "RASTER_asRaster_transfn: Could not create raster");
+			PG_RETURN_NULL();
+		}
+		rt_raster_set_geotransform_matrix(state->raster, gt);
+		rt_raster_set_srid(state->raster, state->srid);
+
+		if (!rt_raster_is_empty(state->raster) && rt_raster_generate_new_band(
+			state->raster, pixtype,
+			nodataval,
+			hasnodata, nodataval,
+			0
+		) < 0) {
+			MemoryContextSwitchTo(oldcontext);
+			rt_raster_destroy(ref);
+			PG_FREE_IF_COPY(pgraster, 3);
+			elog(ERROR, "RASTER_asRaster_transfn: Could not add band to raster");
+			PG_RETURN_NULL();
+		}
+
+		MemoryContextSwitchTo(oldcontext);
+
+		rt_raster_destroy(ref);
+		PG_FREE_IF_COPY(pgraster, 3);
+	}
+
+	/* nothing to burn */
+	if (PG_ARGISNULL(1) || PG_ARGISNULL(2) || rt_raster_is_empty(state->raster))
+		PG_RETURN_POINTER(state);
+
+	gser = PG_GETARG_GSERIALIZED_P(1);
+	srid = gserialized_get_srid(gser);
+	if (srid != state->srid) {
+		PG_FREE_IF_COPY(gser, 1);
+		elog(ERROR, "RASTER_asRaster_transfn: The geometry's SRID (%d) is not the same as the raster's SRID (%d)", srid, state->srid);
+		PG_RETURN_NULL();
+	}
+	value = PG_GETARG_FLOAT8(2);
+
+	geom = lwgeom_from_gserialized(gser);
+	if (rt_raster_burn_geometry(state->raster, 0, geom, value, state->touched, NULL) != ES_NONE) {
+		lwgeom_free(geom);
+		PG_FREE_IF_COPY(gser, 1);
+		elog(ERROR, "RASTER_asRaster_transfn: Could not rasterize geometry");
+		PG_RETURN_NULL();
+	}
+
+	lwgeom_free(geom);
+	PG_FREE_IF_COPY(gser, 1);
+
+	PG_RETURN_POINTER(state);
+}
+
+/**
+ * Return the raster of the aggregate
+ */
+PG_FUNCTION_INFO_V1(RASTER_asRaster_finalfn);
+Datum RASTER_asRaster_finalfn(PG_FUNCTION_ARGS)
+{
+	rtpg_asraster_arg state = NULL;
+	rt_pgraster *pgraster = NULL;
+
+	/* cannot be called directly as this is exclusive aggregate function */
+	if (!AggCheckCallContext(fcinfo, NULL)) {
+		elog(ERROR, "RASTER_asRaster_finalfn: Cannot be called in a non-aggregate context");
+		PG_RETURN_NULL();
+	}
+
+	/* no reference raster */
+	if (PG_ARGISNULL(0))
+		PG_RETURN_NULL();
+
+	state = (rtpg_asraster_arg) PG_GETARG_POINTER(0);
+
+	/* raster stays in state as final function may be called more than once */
+	pgraster = rt_raster_serialize(state->raster);
+	if (pgraster == NULL) {
+		elog(ERROR, "RASTER_asRaster_finalfn: Could not serialize raster");
+		PG_RETURN_NULL();
+	}
+
+	SET_VARSIZE(pgraster, pgraster->size);
+	PG_RETURN_POINTER(pgraster);
+}
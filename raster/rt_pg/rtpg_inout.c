@@ -29,11 +29,14 @@
 
 #include <postgres.h>
 #include <fmgr.h>
+#include <lib/stringinfo.h>
 
 #include "rtpostgis.h"
 
 Datum RASTER_in(PG_FUNCTION_ARGS);
 Datum RASTER_out(PG_FUNCTION_ARGS);
+Datum RASTER_recv(PG_FUNCTION_ARGS);
+Datum RASTER_send(PG_FUNCTION_ARGS);
 Datum RASTER_noop(PG_FUNCTION_ARGS);
 
 Datum RASTER_to_bytea(PG_FUNCTION_ARGS);
@@ -103,6 +106,56 @@ Datum RASTER_out(PG_FUNCTION_ARGS)
 	PG_RETURN_CSTRING(hexwkb);
 }
 
+/**
+ * Input is raster Well-Known-Binary from the binary COPY or
+ * extended query protocol
+ */
+PG_FUNCTION_INFO_V1(RASTER_recv);
+Datum RASTER_recv(PG_FUNCTION_ARGS)
+{
+	StringInfo buf = (StringInfo) PG_GETARG_POINTER(0);
+	rt_raster raster;
+	void *result = NULL;
+
+	POSTGIS_RT_DEBUG(3, "Starting");
+
+	raster = rt_raster_from_wkb((uint8_t *) buf->data + buf->cursor, buf->len - buf->cursor);
+	if (raster == NULL) {
+		elog(ERROR, "RASTER_recv: Could not parse raster WKB");
+		PG_RETURN_NULL();
+	}
+
+	/* Set cursor to the end of buffer (so the backend is happy) */
+	buf->cursor = buf->len;
+
+	result = rt_raster_serialize(raster);
+	rt_raster_destroy(raster);
+	if (result == NULL) {
+		elog(ERROR, "RASTER_recv: Could not serialize raster");
+		PG_RETURN_NULL();
+	}
+
+	SET_VARSIZE(result, ((rt_pgraster*)result)->size);
+	PG_RETURN_POINTER(result);
+}
+
+/**
+ * Output raster Well-Known-Binary to the binary COPY or
+ * extended query protocol
+ */
+PG_FUNCTION_INFO_V1(RASTER_send);
+Datum RASTER_send(PG_FUNCTION_ARGS)
+{
+	POSTGIS_RT_DEBUG(3, "Starting");
+
+	PG_RETURN_POINTER(
+		DatumGetPointer(
+			DirectFunctionCall1(
+				RASTER_to_bytea,
+				PG_GETARG_DATUM(0)
+			)));
+}
+
 /**
  * Return bytea object with raster in Well-Known-Binary form.
  */
@@ -39,6 +39,7 @@
 #include <utils/builtins.h>
 #include <catalog/pg_type.h> /* for INT2OID, INT4OID, FLOAT4OID, FLOAT8OID and TEXTOID */
 #include <executor/executor.h> /* for GetAttributeByName */
+#include <utils/memutils.h> /* for MaxAllocSize */
 
 #include "../../postgis_config.h"
 #include "lwgeom_pg.h"
@@ -969,6 +970,9 @@ typedef struct {
 		uint32_t spi_argcount;
 		uint8_t *spi_argpos;
 
+		/* compiled expression, evaluated before spi_plan */
+		rt_mapexpr mapexpr;
+
 		int hasval;
 		double val;
 	} expr[3];
@@ -1015,6 +1019,7 @@ static rtpg_nmapalgebraexpr_arg rtpg_nmapalgebraexpr_arg_init(int cnt, char **kw
 	for (i = 0; i < arg->callback.exprcount; i++) {
 		arg->callback.expr[i].spi_plan = NULL;
 		arg->callback.expr[i].spi_argcount = 0;
+		arg->callback.expr[i].mapexpr = NULL;
 		arg->callback.expr[i].spi_argpos = palloc(cnt * sizeof(uint8_t));
 		if (arg->callback.expr[i].spi_argpos == NULL) {
 			elog(ERROR, "rtpg_nmapalgebraexpr_arg_init: Could not allocate memory for spi_argpos");
@@ -1039,6 +1044,8 @@ static void rtpg_nmapalgebraexpr_arg_destroy(rtpg_nmapalgebraexpr_arg arg) {
 	for (i = 0; i < arg->callback.exprcount; i++) {
 		if (arg->callback.expr[i].spi_plan)
 			SPI_freeplan(arg->callback.expr[i].spi_plan);
+		if (arg->callback.expr[i].mapexpr)
+			rt_mapexpr_destroy(arg->callback.expr[i].mapexpr);
 		if (arg->callback.kw.count)
 			pfree(arg->callback.expr[i].spi_argpos);
 	}
@@ -1054,6 +1061,7 @@ static int rtpg_nmapalgebraexpr_callback(
 	SPIPlanPtr plan = NULL;
 	int i = 0;
 	int id = -1;
+	int isnull = 0;
 
 	if (arg == NULL)
 		return 0;
@@ -1137,6 +1145,48 @@ static int rtpg_nmapalgebraexpr_callback(
 		}
 	}
 
+	/* evaluate compiled expression, falling back to prepared plan */
+	if (plan != NULL && callback->expr[id].mapexpr != NULL) {
+		double values[12];
+		int nulls[12];
+
+		for (i = 0; i < callback->kw.count; i++) {
+			/* [rast2.*] only exists with 2 rasters */
+			int z = (i < 8) ? 0 : 1;
+
+			values[i] = 0;
+			nulls[i] = 0;
+
+			if (z >= arg->rasters) {
+				nulls[i] = 1;
+				continue;
+			}
+
+			switch (i % 4) {
+				/* x */
+				case 0:
+					values[i] = arg->src_pixel[z][0] + 1;
+					break;
+				/* y */
+				case 1:
+					values[i] = arg->src_pixel[z][1] + 1;
+					break;
+				/* val */
+				default:
+					if (!arg->nodata[z][0][0])
+						values[i] = arg->values[z][0][0];
+					else
+						nulls[i] = 1;
+					break;
+			}
+		}
+
+		if (rt_mapexpr_eval(callback->expr[id].mapexpr, values, nulls, value, &isnull) == ES_NONE) {
+			POSTGIS_RT_DEBUGF(4, "Evaluated compiled expression %d", id);
+			plan = NULL;
+		}
+	}
+
 	/* run prepared plan */
 	if (plan != NULL) {
 		Datum values[12];
@@ -1147,7 +1197,6 @@ static int rtpg_nmapalgebraexpr_callback(
 		SPITupleTable *tuptable = NULL;
 		HeapTuple tuple;
 		Datum datum;
-		bool isnull = FALSE;
 
 		POSTGIS_RT_DEBUGF(4, "Running plan %d", id);
 
@@ -1234,37 +1283,45 @@ static int rtpg_nmapalgebraexpr_callback(
 		tuptable = SPI_tuptable;
 		tuple = tuptable->vals[0];
 
-		datum = SPI_getbinval(tuple, tupdesc, 1, &isnull);
-		if (SPI_result == SPI_ERROR_NOATTRIBUTE) {
-			if (SPI_tuptable) SPI_freetuptable(tuptable);
-			elog(ERROR, "rtpg_nmapalgebraexpr_callback: Could not get result of prepared statement %d", id);
-			return 0;
-		}
+		{
+			bool datumisnull = FALSE;
 
-		if (!isnull) {
-			*value = DatumGetFloat8(datum);
-			POSTGIS_RT_DEBUG(4, "Getting value from Datum");
-		}
-		else {
-			/* 2 raster, check nodatanodataval */
-			if (arg->rasters > 1) {
-				if (callback->nodatanodata.hasval)
-					*value = callback->nodatanodata.val;
-				else
-					*nodata = 1;
+			datum = SPI_getbinval(tuple, tupdesc, 1, &datumisnull);
+			if (SPI_result == SPI_ERROR_NOATTRIBUTE) {
+				if (SPI_tuptable) SPI_freetuptable(tuptable);
+				elog(ERROR, "rtpg_nmapalgebraexpr_callback: Could not get result of prepared statement %d", id);
+				return 0;
 			}
-			/* 1 raster, check nodataval */
-			else {
-				if (callback->expr[1].hasval)
-					*value = callback->expr[1].val;
-				else
-					*nodata = 1;
+
+			if (!datumisnull) {
+				*value = DatumGetFloat8(datum);
+				POSTGIS_RT_DEBUG(4, "Getting value from Datum");
 			}
+			else
+				isnull = 1;
 		}
 
 		if (SPI_tuptable) SPI_freetuptable(tuptable);
 	}
 
+	/* expression evaluated to NULL */
+	if (isnull) {
+		/* 2 raster, check nodatanodataval */
+		if (arg->rasters > 1) {
+			if (callback->nodatanodata.hasval)
+				*value = callback->nodatanodata.val;
+			else
+				*nodata = 1;
+		}
+		/* 1 raster, check nodataval */
+		else {
+			if (callback->expr[1].hasval)
+				*value = callback->expr[1].val;
+			else
+				*nodata = 1;
+		}
+	}
+
 	POSTGIS_RT_DEBUGF(4, "(value, nodata) = (%f, %d)", *value, *nodata);
 	return 1;
 }
@@ -1313,6 +1370,12 @@ Datum RASTER_nMapAlgebraExpr(PG_FUNCTION_ARGS)
 		"[rast2.val]",
 		"[rast2]"
 	};
+	/* positions are INT4 */
+	const int argkwint[] = {
+		1, 1, 0, 0,
+		1, 1, 0, 0,
+		1, 1, 0, 0
+	};
 
 	if (PG_ARGISNULL(0))
 		PG_RETURN_NULL();
@@ -1442,6 +1505,9 @@ Datum RASTER_nMapAlgebraExpr(PG_FUNCTION_ARGS)
 		expr = text_to_cstring(PG_GETARG_TEXT_P(exprpos[i]));
 		POSTGIS_RT_DEBUGF(3, "raw expr of argument #%d: %s", exprpos[i], expr);
 
+		/* compile expression if possible, the prepared plan is still used as fallback */
+		arg->callback.expr[i].mapexpr = rt_mapexpr_compile(expr, argkw, argkwint, argkwcount);
+
 		for (j = 0, k = 1; j < argkwcount; j++) {
 			/* attempt to replace keyword with placeholder */
 			len = 0;
@@ -1698,6 +1764,13 @@ struct rtpg_union_band_arg_t {
 
 	int numraster;
 	rt_raster *raster;
+
+	/*
+		bandless raster covering the union of all input rasters.
+		working rasters are allocated larger than this extent so
+		that most input rasters can be pasted in place
+	*/
+	rt_raster extent;
 };
 
 typedef struct rtpg_union_arg_t *rtpg_union_arg;
@@ -1726,6 +1799,9 @@ static void rtpg_union_arg_destroy(rtpg_union_arg arg) {
 			}
 
 			pfree(arg->bandarg[i].raster);
+
+			if (arg->bandarg[i].extent != NULL)
+				rt_raster_destroy(arg->bandarg[i].extent);
 		}
 
 		pfree(arg->bandarg);
@@ -1982,6 +2058,7 @@ static int rtpg_union_unionarg_process(rtpg_union_arg arg, ArrayType *array) {
 		arg->bandarg[i].uniontype = utype;
 		arg->bandarg[i].nband = nband - 1;
 		arg->bandarg[i].raster = NULL;
+		arg->bandarg[i].extent = NULL;
 
 		if (
 			utype != UT_MEAN &&
@@ -2034,6 +2111,7 @@ static int rtpg_union_noarg(rtpg_union_arg arg, rt_raster raster) {
 		arg->bandarg[i].uniontype = UT_LAST;
 		arg->bandarg[i].nband = i;
 		arg->bandarg[i].numraster = 1;
+		arg->bandarg[i].extent = NULL;
 
 		arg->bandarg[i].raster = (rt_raster *) palloc(sizeof(rt_raster) * arg->bandarg[i].numraster);
 		if (arg->bandarg[i].raster == NULL) {
@@ -2049,9 +2127,192 @@ static int rtpg_union_noarg(rtpg_union_arg arg, rt_raster raster) {
 				elog(ERROR, "rtpg_union_noarg: Could not create working raster");
 				return 0;
 			}
+
+			if (arg->bandarg[0].extent != NULL) {
+				arg->bandarg[i].extent = rt_raster_clone(arg->bandarg[0].extent, 0);
+				if (arg->bandarg[i].extent == NULL) {
+					elog(ERROR, "rtpg_union_noarg: Could not create extent of working raster");
+					return 0;
+				}
+			}
+		}
+	}
+
+	return 1;
+}
+
+/*
+	grow the internal raster computed from the working raster and the
+	input raster so that the working raster isn't reallocated and copied
+	every time the union extent expands.  each side of the internal raster
+	that grew is padded by half the internal raster's dimension, making the
+	number of reallocations logarithmic instead of linear in the number of
+	input rasters.  offsets are updated to be relative to the padded raster
+*/
+static int rtpg_union_pad_raster(
+	rt_raster *iraster, rt_raster working,
+	rt_pixtype pixtype, double *offset
+) {
+	rt_raster _rast = NULL;
+	int dim[2] = {0};
+	int wdim[2] = {0};
+	int pad[4] = {0}; /* left, top, right, bottom */
+	int avail = 0;
+	double gt[6] = {0.};
+	int i = 0;
+
+	dim[0] = rt_raster_get_width(*iraster);
+	dim[1] = rt_raster_get_height(*iraster);
+	wdim[0] = rt_raster_get_width(working);
+	wdim[1] = rt_raster_get_height(working);
+
+	/* only pad the sides that grew */
+	for (i = 0; i < 2; i++) {
+		if ((int) offset[i] > 0)
+			pad[i] = dim[i] / 2;
+		if (dim[i] - (int) offset[i] - wdim[i] > 0)
+			pad[i + 2] = dim[i] / 2;
+
+		/* dimensions are limited to 65535 */
+		avail = 65535 - dim[i];
+		if (pad[i] + pad[i + 2] > avail) {
+			if (pad[i] && pad[i + 2]) {
+				pad[i] = avail / 2;
+				pad[i + 2] = avail / 2;
+			}
+			else if (pad[i])
+				pad[i] = avail;
+			else
+				pad[i + 2] = avail;
+		}
+	}
+
+	if (!pad[0] && !pad[1] && !pad[2] && !pad[3])
+		return 1;
+
+	/* padded band must still fit in one allocation */
+	if (
+		(double) (dim[0] + pad[0] + pad[2]) * (double) (dim[1] + pad[1] + pad[3]) * rt_pixtype_size(pixtype) >
+		(double) MaxAllocSize
+	) {
+		POSTGIS_RT_DEBUG(3, "Padded internal raster too large. Not padding");
+		return 1;
+	}
+
+	POSTGIS_RT_DEBUGF(4, "pad = %d, %d, %d, %d", pad[0], pad[1], pad[2], pad[3]);
+
+	_rast = rt_raster_new(dim[0] + pad[0] + pad[2], dim[1] + pad[1] + pad[3]);
+	if (_rast == NULL) {
+		elog(ERROR, "rtpg_union_pad_raster: Could not create padded internal raster");
+		return 0;
+	}
+
+	rt_raster_get_geotransform_matrix(*iraster, gt);
+	if (rt_raster_cell_to_geopoint(
+		*iraster,
+		-1 * pad[0], -1 * pad[1],
+		&(gt[0]), &(gt[3]),
+		NULL
+	) != ES_NONE) {
+		rt_raster_destroy(_rast);
+		elog(ERROR, "rtpg_union_pad_raster: Could not get spatial coordinates of upper-left pixel of padded internal raster");
+		return 0;
+	}
+	rt_raster_set_geotransform_matrix(_rast, gt);
+	rt_raster_set_srid(_rast, rt_raster_get_srid(*iraster));
+
+	offset[0] += pad[0];
+	offset[1] += pad[1];
+	offset[2] += pad[0];
+	offset[3] += pad[1];
+
+	rt_raster_destroy(*iraster);
+	*iraster = _rast;
+
+	return 1;
+}
+
+/*
+	replace working raster with a raster of the union's extent,
+	dropping the padding added by rtpg_union_pad_raster()
+*/
+static int rtpg_union_crop_raster(rt_raster *working, rt_raster extent) {
+	rt_raster _rast = NULL;
+	rt_band band = NULL;
+	rt_band _band = NULL;
+	double offset[4] = {0.};
+	double nodataval = 0;
+	uint16_t dim[2] = {0};
+	void *vals = NULL;
+	uint16_t nvals = 0;
+	int y = 0;
+	int k = 0;
+
+	if (
+		rt_raster_get_width(*working) == rt_raster_get_width(extent) &&
+		rt_raster_get_height(*working) == rt_raster_get_height(extent)
+	) {
+		return 1;
+	}
+
+	if (rt_raster_from_two_rasters(
+		extent, *working,
+		ET_FIRST,
+		&_rast, offset
+	) != ES_NONE) {
+		elog(ERROR, "rtpg_union_crop_raster: Could not create cropped working raster");
+		return 0;
+	}
+
+	if (rt_raster_has_band(*working, 0)) {
+		band = rt_raster_get_band(*working, 0);
+		if (rt_band_get_hasnodata_flag(band))
+			rt_band_get_nodata(band, &nodataval);
+
+		if (rt_raster_generate_new_band(
+			_rast,
+			rt_band_get_pixtype(band),
+			nodataval,
+			rt_band_get_hasnodata_flag(band), nodataval,
+			0
+		) == -1) {
+			rt_raster_destroy(_rast);
+			elog(ERROR, "rtpg_union_crop_raster: Could not add new band to cropped working raster");
+			return 0;
+		}
+		_band = rt_raster_get_band(_rast, 0);
+
+		dim[0] = rt_raster_get_width(_rast);
+		dim[1] = rt_raster_get_height(_rast);
+		for (y = 0; y < dim[1]; y++) {
+			if (rt_band_get_pixel_line(
+				band,
+				(int) -offset[2], (int) -offset[3] + y,
+				dim[0],
+				&vals, &nvals
+			) != ES_NONE) {
+				rt_band_destroy(_band);
+				rt_raster_destroy(_rast);
+				elog(ERROR, "rtpg_union_crop_raster: Could not get pixel line from band of working raster");
+				return 0;
+			}
+
+			if (rt_band_set_pixel_line(_band, 0, y, vals, nvals) != ES_NONE) {
+				pfree(vals);
+				rt_band_destroy(_band);
+				rt_raster_destroy(_rast);
+				elog(ERROR, "rtpg_union_crop_raster: Could not set pixel line to band of cropped working raster");
+				return 0;
+			}
+			pfree(vals);
 		}
 	}
 
+	for (k = rt_raster_get_num_bands(*working) - 1; k >= 0; k--)
+		rt_band_destroy(rt_raster_get_band(*working, k));
+	rt_raster_destroy(*working);
+	*working = _rast;
+
 	return 1;
 }
 
@@ -2229,6 +2490,7 @@ Datum RASTER_union_transfn(PG_FUNCTION_ARGS)
 						else
 							iwr->bandarg[i].numraster = 1;
 						iwr->bandarg[i].raster = NULL;
+						iwr->bandarg[i].extent = NULL;
 					}
 
 					break;
@@ -2274,6 +2536,7 @@ Datum RASTER_union_transfn(PG_FUNCTION_ARGS)
 
 					iwr->bandarg[0].numraster = 1;
 					iwr->bandarg[0].raster = NULL;
+					iwr->bandarg[0].extent = NULL;
 					break;
 				/* only other type allowed is unionarg */
 				default:
@@ -2356,6 +2619,22 @@ Datum RASTER_union_transfn(PG_FUNCTION_ARGS)
 						PG_RETURN_NULL();
 					}
 				}
+
+				if (iwr->bandarg[i].extent == NULL && iwr->bandarg[0].extent != NULL) {
+					iwr->bandarg[i].extent = rt_raster_clone(iwr->bandarg[0].extent, 0);
+					if (iwr->bandarg[i].extent == NULL) {
+
+						rtpg_union_arg_destroy(iwr);
+						if (raster != NULL) {
+							rt_raster_destroy(raster);
+							PG_FREE_IF_COPY(pgraster, 1);
+						}
+
+						MemoryContextSwitchTo(oldcontext);
+						elog(ERROR, "RASTER_union_transfn: Could not create extent of working raster");
+						PG_RETURN_NULL();
+					}
+				}
 			}
 		}
 	}
@@ -2517,6 +2796,22 @@ Datum RASTER_union_transfn(PG_FUNCTION_ARGS)
 
 				/* use internal raster */
 				if (!reuserast) {
+					/* leave room for the rasters that follow */
+					if (!rtpg_union_pad_raster(&iraster, iwr->bandarg[i].raster[j], pixtype, _offset)) {
+
+						pfree(itrset);
+						rtpg_union_arg_destroy(iwr);
+						rt_raster_destroy(iraster);
+						if (raster != NULL) {
+							rt_raster_destroy(raster);
+							PG_FREE_IF_COPY(pgraster, 1);
+						}
+
+						MemoryContextSwitchTo(oldcontext);
+						elog(ERROR, "RASTER_union_transfn: Could not pad internal raster");
+						PG_RETURN_NULL();
+					}
+
 					/* create band of same type */
 					if (rt_raster_generate_new_band(
 						iraster,
@@ -2586,6 +2881,7 @@ Datum RASTER_union_transfn(PG_FUNCTION_ARGS)
 							elog(ERROR, "RASTER_union_transfn: Could not set pixel line to band of internal raster");
 							PG_RETURN_NULL();
 						}
+						pfree(vals);
 					}
 				}
 				else {
@@ -2675,6 +2971,7 @@ Datum RASTER_union_transfn(PG_FUNCTION_ARGS)
 						elog(ERROR, "RASTER_union_transfn: Could not set pixel line to band of internal raster");
 						PG_RETURN_NULL();
 					}
+					pfree(vals);
 				}
 
 				/* free _raster */
@@ -2724,6 +3021,34 @@ Datum RASTER_union_transfn(PG_FUNCTION_ARGS)
 			iwr->bandarg[i].raster[j] = _raster;
 		}
 
+		/* expand extent of union */
+		if (!rt_raster_is_empty(raster)) {
+			if (iwr->bandarg[i].extent == NULL)
+				_raster = rt_raster_clone(raster, 0);
+			else if (rt_raster_from_two_rasters(
+				iwr->bandarg[i].extent, raster,
+				ET_UNION,
+				&_raster, NULL
+			) != ES_NONE) {
+				_raster = NULL;
+			}
+
+			if (_raster == NULL) {
+
+				pfree(itrset);
+				rtpg_union_arg_destroy(iwr);
+				rt_raster_destroy(raster);
+				PG_FREE_IF_COPY(pgraster, 1);
+
+				MemoryContextSwitchTo(oldcontext);
+				elog(ERROR, "RASTER_union_transfn: Could not compute extent of union");
+				PG_RETURN_NULL();
+			}
+
+			if (iwr->bandarg[i].extent != NULL)
+				rt_raster_destroy(iwr->bandarg[i].extent);
+			iwr->bandarg[i].extent = _raster;
+		}
 	}
 
 	pfree(itrset);
@@ -2782,6 +3107,23 @@ Datum RASTER_union_finalfn(PG_FUNCTION_ARGS)
 	}
 
 	for (i = 0; i < iwr->numband; i++) {
+		/* drop padding of working rasters */
+		if (iwr->bandarg[i].extent != NULL) {
+			for (j = 0; j < iwr->bandarg[i].numraster; j++) {
+				if (rt_raster_is_empty(iwr->bandarg[i].raster[j]))
+					continue;
+
+				if (!rtpg_union_crop_raster(&(iwr->bandarg[i].raster[j]), iwr->bandarg[i].extent)) {
+					pfree(itrset);
+					rtpg_union_arg_destroy(iwr);
+					if (_rtn != NULL)
+						rt_raster_destroy(_rtn);
+					elog(ERROR, "RASTER_union_finalfn: Could not crop working raster");
+					PG_RETURN_NULL();
+				}
+			}
+		}
+
 		if (
 			iwr->bandarg[i].uniontype == UT_MEAN ||
 			iwr->bandarg[i].uniontype == UT_RANGE
@@ -4451,6 +4793,12 @@ Datum RASTER_mapAlgebraExpr(PG_FUNCTION_ARGS)
     bool isnull = FALSE;
     int i = 0;
     int j = 0;
+    rt_mapexpr mapexpr = NULL;
+    char *mapkw[] = {"[rast]", "[rast.x]", "[rast.y]", "[rast.val]"};
+    const int mapkwint[] = {0, 1, 1, 0};
+    double mapvalues[4];
+    int mapnulls[4] = {0};
+    int mapisnull = 0;
 
     POSTGIS_RT_DEBUG(2, "RASTER_mapAlgebraExpr: Starting...");
 
@@ -4858,6 +5206,9 @@ Datum RASTER_mapAlgebraExpr(PG_FUNCTION_ARGS)
             width, height);
 
     if (initexpr != NULL) {
+        /* compile expression if possible, the prepared plan is still used as fallback */
+        mapexpr = rt_mapexpr_compile(expression, mapkw, mapkwint, 4);
+
     	/* Convert [rast.val] to [rast] */
         newexpr = rtpg_strreplace(initexpr, "[rast.val]", "[rast]", NULL);
         pfree(initexpr); initexpr=newexpr;
@@ -4951,7 +5302,24 @@ Datum RASTER_mapAlgebraExpr(PG_FUNCTION_ARGS)
              **/
             if (ret == ES_NONE && FLT_NEQ(r, newnodatavalue)) {
                 if (skipcomputation == 0) {
-                    if (initexpr != NULL) {
+                    if (mapexpr != NULL) {
+                        /* x and y are 0 based index, but SQL expects 1 based index */
+                        mapvalues[0] = r;
+                        mapvalues[1] = x + 1;
+                        mapvalues[2] = y + 1;
+                        mapvalues[3] = r;
+                    }
+
+                    if (
+                        mapexpr != NULL &&
+                        rt_mapexpr_eval(mapexpr, mapvalues, mapnulls, &newval, &mapisnull) == ES_NONE
+                    ) {
+                        if (mapisnull) {
+                            POSTGIS_RT_DEBUGF(3, "Expression for pixel %d,%d (value %g) evaluated to NULL, skip setting", x+1,y+1,r);
+                            newval = newinitialvalue;
+                        }
+                    }
+                    else if (initexpr != NULL) {
                         /* Reset the null arg flags. */
                         memset(nulls, 'n', argcount);
 
@@ -4989,6 +5357,7 @@ Datum RASTER_mapAlgebraExpr(PG_FUNCTION_ARGS)
                             pfree(values);
                             pfree(nulls);
                             pfree(initexpr);
+                            rt_mapexpr_destroy(mapexpr);
 
                             rt_raster_destroy(raster);
                             PG_FREE_IF_COPY(pgraster, 0);
@@ -5039,6 +5408,7 @@ Datum RASTER_mapAlgebraExpr(PG_FUNCTION_ARGS)
         pfree(values);
         pfree(nulls);
         pfree(initexpr);
+        rt_mapexpr_destroy(mapexpr);
     }
     else {
         POSTGIS_RT_DEBUG(3, "RASTER_mapAlgebraExpr: no SPI cleanup");
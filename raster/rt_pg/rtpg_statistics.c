@@ -43,6 +43,7 @@
 #include "access/htup_details.h" /* for heap_form_tuple() */
 #endif
 
+#include "lwgeom_pg.h"
 #include "rtpostgis.h"
 
 /* Get summary stats */
@@ -50,8 +51,15 @@ Datum RASTER_summaryStats(PG_FUNCTION_ARGS);
 Datum RASTER_summaryStatsCoverage(PG_FUNCTION_ARGS);
 
 Datum RASTER_summaryStats_transfn(PG_FUNCTION_ARGS);
+Datum RASTER_summaryStats_combinefn(PG_FUNCTION_ARGS);
+Datum RASTER_summaryStats_serialfn(PG_FUNCTION_ARGS);
+Datum RASTER_summaryStats_deserialfn(PG_FUNCTION_ARGS);
 Datum RASTER_summaryStats_finalfn(PG_FUNCTION_ARGS);
 
+/* get summary stats of pixels in geometry */
+Datum RASTER_summaryStatsGeometry(PG_FUNCTION_ARGS);
+Datum RASTER_summaryStatsGeometry_transfn(PG_FUNCTION_ARGS);
+
 /* get histogram */
 Datum RASTER_histogram(PG_FUNCTION_ARGS);
 Datum RASTER_histogramCoverage(PG_FUNCTION_ARGS);
@@ -60,6 +68,12 @@ Datum RASTER_histogramCoverage(PG_FUNCTION_ARGS);
 Datum RASTER_quantile(PG_FUNCTION_ARGS);
 Datum RASTER_quantileCoverage(PG_FUNCTION_ARGS);
 
+Datum RASTER_quantile_transfn(PG_FUNCTION_ARGS);
+Datum RASTER_quantile_combinefn(PG_FUNCTION_ARGS);
+Datum RASTER_quantile_serialfn(PG_FUNCTION_ARGS);
+Datum RASTER_quantile_deserialfn(PG_FUNCTION_ARGS);
+Datum RASTER_quantile_finalfn(PG_FUNCTION_ARGS);
+
 /* get counts of values */
 Datum RASTER_valueCount(PG_FUNCTION_ARGS);
 Datum RASTER_valueCountCoverage(PG_FUNCTION_ARGS);
@@ -826,6 +840,185 @@ Datum RASTER_summaryStats_transfn(PG_FUNCTION_ARGS)
 	PG_RETURN_POINTER(state);
 }
 
+PG_FUNCTION_INFO_V1(RASTER_summaryStats_combinefn);
+Datum RASTER_summaryStats_combinefn(PG_FUNCTION_ARGS)
+{
+	MemoryContext aggcontext;
+	MemoryContext oldcontext;
+	rtpg_summarystats_arg state1 = NULL;
+	rtpg_summarystats_arg state2 = NULL;
+	uint64_t cK = 0;
+	double delta = 0;
+
+	/* cannot be called directly as this is exclusive aggregate function */
+	if (!AggCheckCallContext(fcinfo, &aggcontext)) {
+		elog(
+			ERROR,
+			"RASTER_summaryStats_combinefn: Cannot be called in a non-aggregate context"
+		);
+		PG_RETURN_NULL();
+	}
+
+	if (PG_ARGISNULL(1)) {
+		if (PG_ARGISNULL(0))
+			PG_RETURN_NULL();
+		PG_RETURN_POINTER(PG_GETARG_POINTER(0));
+	}
+	state2 = (rtpg_summarystats_arg) PG_GETARG_POINTER(1);
+
+	oldcontext = MemoryContextSwitchTo(aggcontext);
+
+	/* the state of the partial aggregate is copied into aggcontext */
+	if (PG_ARGISNULL(0)) {
+		state1 = rtpg_summarystats_arg_init();
+		state1->band_index = state2->band_index;
+		state1->exclude_nodata_value = state2->exclude_nodata_value;
+		state1->sample = state2->sample;
+	}
+	else
+		state1 = (rtpg_summarystats_arg) PG_GETARG_POINTER(0);
+
+	if (state2->stats->count > 0) {
+		if (state1->stats->count < 1) {
+			state1->stats->sample = state2->stats->sample;
+			state1->stats->count = state2->stats->count;
+			state1->stats->min = state2->stats->min;
+			state1->stats->max = state2->stats->max;
+			state1->stats->sum = state2->stats->sum;
+		}
+		else {
+			state1->stats->count += state2->stats->count;
+			state1->stats->sum += state2->stats->sum;
+
+			if (state2->stats->min < state1->stats->min)
+				state1->stats->min = state2->stats->min;
+			if (state2->stats->max > state1->stats->max)
+				state1->stats->max = state2->stats->max;
+		}
+	}
+
+	/* merge the one-pass mean and squared deviations (Chan et al.) */
+	if (state2->cK > 0) {
+		if (state1->cK < 1) {
+			state1->cK = state2->cK;
+			state1->cM = state2->cM;
+			state1->cQ = state2->cQ;
+		}
+		else {
+			cK = state1->cK + state2->cK;
+			delta = state2->cM - state1->cM;
+
+			state1->cQ += state2->cQ +
+				(delta * delta) * ((double) state1->cK * state2->cK / cK);
+			state1->cM += delta * ((double) state2->cK / cK);
+			state1->cK = cK;
+		}
+	}
+
+	MemoryContextSwitchTo(oldcontext);
+
+	PG_RETURN_POINTER(state1);
+}
+
+PG_FUNCTION_INFO_V1(RASTER_summaryStats_serialfn);
+Datum RASTER_summaryStats_serialfn(PG_FUNCTION_ARGS)
+{
+	rtpg_summarystats_arg state = NULL;
+	bytea *result = NULL;
+	uint8_t *ptr = NULL;
+	int32_t header[2];
+	uint64_t counts[2];
+	double values[7];
+
+	/* cannot be called directly as this is exclusive aggregate function */
+	if (!AggCheckCallContext(fcinfo, NULL)) {
+		elog(ERROR, "RASTER_summaryStats_serialfn: Cannot be called in a non-aggregate context");
+		PG_RETURN_NULL();
+	}
+
+	state = (rtpg_summarystats_arg) PG_GETARG_POINTER(0);
+
+	/* band index, exclude_nodata_value, counts and running values */
+	header[0] = state->band_index;
+	header[1] = state->exclude_nodata_value ? 1 : 0;
+
+	counts[0] = state->stats->count;
+	counts[1] = state->cK;
+
+	values[0] = state->sample;
+	values[1] = state->stats->sample;
+	values[2] = state->stats->min;
+	values[3] = state->stats->max;
+	values[4] = state->stats->sum;
+	values[5] = state->cM;
+	values[6] = state->cQ;
+
+	result = palloc(VARHDRSZ + sizeof(header) + sizeof(counts) + sizeof(values));
+	SET_VARSIZE(result, VARHDRSZ + sizeof(header) + sizeof(counts) + sizeof(values));
+
+	ptr = (uint8_t *) VARDATA(result);
+	memcpy(ptr, header, sizeof(header));
+	ptr += sizeof(header);
+	memcpy(ptr, counts, sizeof(counts));
+	ptr += sizeof(counts);
+	memcpy(ptr, values, sizeof(values));
+
+	PG_RETURN_BYTEA_P(result);
+}
+
+PG_FUNCTION_INFO_V1(RASTER_summaryStats_deserialfn);
+Datum RASTER_summaryStats_deserialfn(PG_FUNCTION_ARGS)
+{
+	MemoryContext aggcontext;
+	MemoryContext oldcontext;
+	rtpg_summarystats_arg state = NULL;
+	bytea *data = NULL;
+	uint8_t *ptr = NULL;
+	int32_t header[2];
+	uint64_t counts[2];
+	double values[7];
+
+	/* cannot be called directly as this is exclusive aggregate function */
+	if (!AggCheckCallContext(fcinfo, &aggcontext)) {
+		elog(ERROR, "RASTER_summaryStats_deserialfn: Cannot be called in a non-aggregate context");
+		PG_RETURN_NULL();
+	}
+
+	data = PG_GETARG_BYTEA_P(0);
+	if (VARSIZE(data) - VARHDRSZ != sizeof(header) + sizeof(counts) + sizeof(values)) {
+		elog(ERROR, "RASTER_summaryStats_deserialfn: Cannot deserialize summary stats");
+		PG_RETURN_NULL();
+	}
+
+	ptr = (uint8_t *) VARDATA(data);
+	memcpy(header, ptr, sizeof(header));
+	ptr += sizeof(header);
+	memcpy(counts, ptr, sizeof(counts));
+	ptr += sizeof(counts);
+	memcpy(values, ptr, sizeof(values));
+
+	oldcontext = MemoryContextSwitchTo(aggcontext);
+
+	state = rtpg_summarystats_arg_init();
+	state->band_index = header[0];
+	state->exclude_nodata_value = header[1] ? TRUE : FALSE;
+
+	state->stats->count = counts[0];
+	state->cK = counts[1];
+
+	state->sample = values[0];
+	state->stats->sample = values[1];
+	state->stats->min = values[2];
+	state->stats->max = values[3];
+	state->stats->sum = values[4];
+	state->cM = values[5];
+	state->cQ = values[6];
+
+	MemoryContextSwitchTo(oldcontext);
+
+	PG_RETURN_POINTER(state);
+}
+
 PG_FUNCTION_INFO_V1(RASTER_summaryStats_finalfn);
 Datum RASTER_summaryStats_finalfn(PG_FUNCTION_ARGS)
 {
@@ -912,107 +1105,434 @@ Datum RASTER_summaryStats_finalfn(PG_FUNCTION_ARGS)
 	PG_RETURN_DATUM(result);
 }
 
+/* ---------------------------------------------------------------- */
+/* ST_SummaryStats of pixels in geometry                            */
+/* ---------------------------------------------------------------- */
+
+/*
+	2D polygonal geometry to compute stats of pixels in.
+	returns NULL if geometry is not in raster's SRID
+*/
+static LWGEOM *
+rtpg_summarystats_geometry(GSERIALIZED *gser, rt_raster raster) {
+	LWGEOM *geom = NULL;
+	int type = gserialized_get_type(gser);
+
+	if (type != POLYGONTYPE && type != MULTIPOLYGONTYPE) {
+		elog(ERROR, "Geometry provided must be a POLYGON or MULTIPOLYGON");
+		return NULL;
+	}
+
+	if (clamp_srid(rt_raster_get_srid(raster)) != clamp_srid(gserialized_get_srid(gser)))
+		return NULL;
+
+	geom = lwgeom_from_gserialized(gser);
+
+	/* Get a 2D version of the geometry if necessary */
+	if (lwgeom_ndims(geom) > 2) {
+		LWGEOM *geom2d = lwgeom_force_2d(geom);
+		lwgeom_free(geom);
+		geom = geom2d;
+	}
+
+	return geom;
+}
+
 /**
- * Returns histogram for a band
+ * Get summary stats of the pixels of a band inside a geometry
+ * without clipping the raster
  */
-PG_FUNCTION_INFO_V1(RASTER_histogram);
-Datum RASTER_histogram(PG_FUNCTION_ARGS)
+PG_FUNCTION_INFO_V1(RASTER_summaryStatsGeometry);
+Datum RASTER_summaryStatsGeometry(PG_FUNCTION_ARGS)
 {
-	FuncCallContext *funcctx;
-	TupleDesc tupdesc;
+	rt_pgraster *pgraster = NULL;
+	rt_raster raster = NULL;
+	GSERIALIZED *gser = NULL;
+	LWGEOM *geom = NULL;
+	int32_t bandindex = 1;
+	bool exclude_nodata_value = TRUE;
+	int num_bands = 0;
+	rt_bandstats stats = NULL;
 
-	int i;
-	rt_histogram hist;
-	rt_histogram hist2;
-	int call_cntr;
-	int max_calls;
+	TupleDesc tupdesc;
+	int values_length = 6;
+	Datum values[values_length];
+	bool nulls[values_length];
+	HeapTuple tuple;
+	Datum result;
 
-	/* first call of function */
-	if (SRF_IS_FIRSTCALL()) {
-		MemoryContext oldcontext;
+	/* pgraster or geometry is null, return null */
+	if (PG_ARGISNULL(0) || PG_ARGISNULL(1))
+		PG_RETURN_NULL();
+	pgraster = (rt_pgraster *) PG_DETOAST_DATUM(PG_GETARG_DATUM(0));
 
-		rt_pgraster *pgraster = NULL;
-		rt_raster raster = NULL;
-		rt_band band = NULL;
-		int32_t bandindex = 1;
-		int num_bands = 0;
-		bool exclude_nodata_value = TRUE;
-		double sample = 0;
-		uint32_t bin_count = 0;
-		double *bin_width = NULL;
-		uint32_t bin_width_count = 0;
-		double width = 0;
-		bool right = FALSE;
-		double min = 0;
-		double max = 0;
-		rt_bandstats stats = NULL;
-		uint32_t count;
+	raster = rt_raster_deserialize(pgraster, FALSE);
+	if (!raster) {
+		PG_FREE_IF_COPY(pgraster, 0);
+		elog(ERROR, "RASTER_summaryStatsGeometry: Cannot deserialize raster");
+		PG_RETURN_NULL();
+	}
 
-		int j;
-		int n;
+	/* band index is 1-based */
+	if (!PG_ARGISNULL(2))
+		bandindex = PG_GETARG_INT32(2);
+	num_bands = rt_raster_get_num_bands(raster);
+	if (bandindex < 1 || bandindex > num_bands) {
+		elog(NOTICE, "Invalid band index (must use 1-based). Returning NULL");
+		rt_raster_destroy(raster);
+		PG_FREE_IF_COPY(pgraster, 0);
+		PG_RETURN_NULL();
+	}
 
-		ArrayType *array;
-		Oid etype;
-		Datum *e;
-		bool *nulls;
-		int16 typlen;
-		bool typbyval;
-		char typalign;
+	/* exclude_nodata_value flag */
+	if (!PG_ARGISNULL(3))
+		exclude_nodata_value = PG_GETARG_BOOL(3);
 
-		POSTGIS_RT_DEBUG(3, "RASTER_histogram: Starting");
+	/* geometry */
+	gser = PG_GETARG_GSERIALIZED_P(1);
+	geom = rtpg_summarystats_geometry(gser, raster);
+	if (geom == NULL) {
+		elog(NOTICE, "Geometry provided does not have the same SRID as the raster. Returning NULL");
+		rt_raster_destroy(raster);
+		PG_FREE_IF_COPY(pgraster, 0);
+		PG_FREE_IF_COPY(gser, 1);
+		PG_RETURN_NULL();
+	}
 
-		/* create a function context for cross-call persistence */
-		funcctx = SRF_FIRSTCALL_INIT();
+	/* we don't need the raw values, hence the zero parameter */
+	stats = rt_raster_get_zonal_stats(
+		raster, bandindex - 1,
+		geom,
+		(int) exclude_nodata_value, 0,
+		NULL, NULL, NULL
+	);
+	lwgeom_free(geom);
+	rt_raster_destroy(raster);
+	PG_FREE_IF_COPY(pgraster, 0);
+	PG_FREE_IF_COPY(gser, 1);
+	if (NULL == stats) {
+		elog(NOTICE, "Cannot compute summary statistics for band at index %d. Returning NULL", bandindex);
+		PG_RETURN_NULL();
+	}
 
-		/* switch to memory context appropriate for multiple function calls */
-		oldcontext = MemoryContextSwitchTo(funcctx->multi_call_memory_ctx);
+	/* Build a tuple descriptor for our result type */
+	if (get_call_result_type(fcinfo, NULL, &tupdesc) != TYPEFUNC_COMPOSITE) {
+		ereport(ERROR, (
+			errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+			errmsg(
+				"function returning record called in context "
+				"that cannot accept type record"
+			)
+		));
+	}
 
-		/* pgraster is null, return nothing */
-		if (PG_ARGISNULL(0)) {
-			MemoryContextSwitchTo(oldcontext);
-			SRF_RETURN_DONE(funcctx);
-		}
-		pgraster = (rt_pgraster *) PG_DETOAST_DATUM(PG_GETARG_DATUM(0));
+	BlessTupleDesc(tupdesc);
 
-		raster = rt_raster_deserialize(pgraster, FALSE);
-		if (!raster) {
-			PG_FREE_IF_COPY(pgraster, 0);
-			MemoryContextSwitchTo(oldcontext);
-			elog(ERROR, "RASTER_histogram: Cannot deserialize raster");
-			SRF_RETURN_DONE(funcctx);
-		}
+	memset(nulls, FALSE, sizeof(bool) * values_length);
 
-		/* band index is 1-based */
-		if (!PG_ARGISNULL(1))
-			bandindex = PG_GETARG_INT32(1);
-		num_bands = rt_raster_get_num_bands(raster);
-		if (bandindex < 1 || bandindex > num_bands) {
-			elog(NOTICE, "Invalid band index (must use 1-based). Returning NULL");
-			rt_raster_destroy(raster);
-			PG_FREE_IF_COPY(pgraster, 0);
-			MemoryContextSwitchTo(oldcontext);
-			SRF_RETURN_DONE(funcctx);
-		}
+	values[0] = Int64GetDatum(stats->count);
+	if (stats->count > 0) {
+		values[1] = Float8GetDatum(stats->sum);
+		values[2] = Float8GetDatum(stats->mean);
+		values[3] = Float8GetDatum(stats->stddev);
+		values[4] = Float8GetDatum(stats->min);
+		values[5] = Float8GetDatum(stats->max);
+	}
+	else {
+		nulls[1] = TRUE;
+		nulls[2] = TRUE;
+		nulls[3] = TRUE;
+		nulls[4] = TRUE;
+		nulls[5] = TRUE;
+	}
 
-		/* exclude_nodata_value flag */
-		if (!PG_ARGISNULL(2))
-			exclude_nodata_value = PG_GETARG_BOOL(2);
+	/* build a tuple */
+	tuple = heap_form_tuple(tupdesc, values, nulls);
 
-		/* sample % */
-		if (!PG_ARGISNULL(3)) {
-			sample = PG_GETARG_FLOAT8(3);
-			if (sample < 0 || sample > 1) {
-				elog(NOTICE, "Invalid sample percentage (must be between 0 and 1). Returning NULL");
-				rt_raster_destroy(raster);
-				PG_FREE_IF_COPY(pgraster, 0);
-				MemoryContextSwitchTo(oldcontext);
-				SRF_RETURN_DONE(funcctx);
-			}
-			else if (FLT_EQ(sample, 0.0))
-				sample = 1;
-		}
-		else
-			sample = 1;
+	/* make the tuple into a datum */
+	result = HeapTupleGetDatum(tuple);
+
+	/* clean up */
+	pfree(stats);
+
+	PG_RETURN_DATUM(result);
+}
+
+/*
+	aggregate of the pixels inside a geometry over the tiles of a coverage.
+	shares state and final function with ST_SummaryStatsAgg
+*/
+PG_FUNCTION_INFO_V1(RASTER_summaryStatsGeometry_transfn);
+Datum RASTER_summaryStatsGeometry_transfn(PG_FUNCTION_ARGS)
+{
+	MemoryContext aggcontext;
+	MemoryContext oldcontext;
+	rtpg_summarystats_arg state = NULL;
+
+	rt_pgraster *pgraster = NULL;
+	rt_raster raster = NULL;
+	GSERIALIZED *gser = NULL;
+	LWGEOM *geom = NULL;
+	int num_bands = 0;
+	rt_bandstats stats = NULL;
+
+	POSTGIS_RT_DEBUG(3, "Starting...");
+
+	/* cannot be called directly as this is exclusive aggregate function */
+	if (!AggCheckCallContext(fcinfo, &aggcontext)) {
+		elog(
+			ERROR,
+			"RASTER_summaryStatsGeometry_transfn: Cannot be called in a non-aggregate context"
+		);
+		PG_RETURN_NULL();
+	}
+
+	/* switch to aggcontext */
+	oldcontext = MemoryContextSwitchTo(aggcontext);
+
+	if (PG_ARGISNULL(0)) {
+		POSTGIS_RT_DEBUG(3, "Creating state variable");
+
+		state = rtpg_summarystats_arg_init();
+		if (state == NULL) {
+			MemoryContextSwitchTo(oldcontext);
+			elog(
+				ERROR,
+				"RASTER_summaryStatsGeometry_transfn: Cannot allocate memory for state variable"
+			);
+			PG_RETURN_NULL();
+		}
+
+		/* band index */
+		if (PG_NARGS() > 3 && !PG_ARGISNULL(3)) {
+			state->band_index = PG_GETARG_INT32(3);
+			if (state->band_index < 1) {
+				rtpg_summarystats_arg_destroy(state);
+				MemoryContextSwitchTo(oldcontext);
+				elog(
+					ERROR,
+					"RASTER_summaryStatsGeometry_transfn: Invalid band index (must use 1-based). Returning NULL"
+				);
+				PG_RETURN_NULL();
+			}
+		}
+
+		/* exclude_nodata_value */
+		if (PG_NARGS() > 4 && !PG_ARGISNULL(4))
+			state->exclude_nodata_value = PG_GETARG_BOOL(4);
+	}
+	else {
+		POSTGIS_RT_DEBUG(3, "State variable already exists");
+		state = (rtpg_summarystats_arg) PG_GETARG_POINTER(0);
+	}
+
+	/* null raster or geometry, return */
+	if (PG_ARGISNULL(1) || PG_ARGISNULL(2)) {
+		POSTGIS_RT_DEBUG(4, "NULL raster or geometry so no processing required");
+		MemoryContextSwitchTo(oldcontext);
+		PG_RETURN_POINTER(state);
+	}
+
+	/* deserialize raster */
+	pgraster = (rt_pgraster *) PG_DETOAST_DATUM(PG_GETARG_DATUM(1));
+	raster = rt_raster_deserialize(pgraster, FALSE);
+	if (raster == NULL) {
+		rtpg_summarystats_arg_destroy(state);
+		PG_FREE_IF_COPY(pgraster, 1);
+
+		MemoryContextSwitchTo(oldcontext);
+		elog(ERROR, "RASTER_summaryStatsGeometry_transfn: Cannot deserialize raster");
+		PG_RETURN_NULL();
+	}
+
+	/* inspect number of bands */
+	num_bands = rt_raster_get_num_bands(raster);
+	if (state->band_index > num_bands) {
+		elog(
+			NOTICE,
+			"Raster does not have band at index %d. Skipping raster",
+			state->band_index
+		);
+
+		rt_raster_destroy(raster);
+		PG_FREE_IF_COPY(pgraster, 1);
+
+		MemoryContextSwitchTo(oldcontext);
+		PG_RETURN_POINTER(state);
+	}
+
+	/* geometry */
+	gser = PG_GETARG_GSERIALIZED_P(2);
+	geom = rtpg_summarystats_geometry(gser, raster);
+	if (geom == NULL) {
+		rtpg_summarystats_arg_destroy(state);
+		rt_raster_destroy(raster);
+		PG_FREE_IF_COPY(pgraster, 1);
+		PG_FREE_IF_COPY(gser, 2);
+
+		MemoryContextSwitchTo(oldcontext);
+		elog(ERROR, "RASTER_summaryStatsGeometry_transfn: Geometry provided does not have the same SRID as the raster");
+		PG_RETURN_NULL();
+	}
+
+	/* we don't need the raw values, hence the zero parameter */
+	stats = rt_raster_get_zonal_stats(
+		raster, state->band_index - 1,
+		geom,
+		(int) state->exclude_nodata_value, 0,
+		&(state->cK), &(state->cM), &(state->cQ)
+	);
+
+	lwgeom_free(geom);
+	rt_raster_destroy(raster);
+	PG_FREE_IF_COPY(pgraster, 1);
+	PG_FREE_IF_COPY(gser, 2);
+
+	if (NULL == stats) {
+		elog(
+			NOTICE,
+			"Cannot compute summary statistics for band at index %d. Returning NULL",
+			state->band_index
+		);
+
+		rtpg_summarystats_arg_destroy(state);
+
+		MemoryContextSwitchTo(oldcontext);
+		PG_RETURN_NULL();
+	}
+
+	if (stats->count > 0) {
+		if (state->stats->count < 1) {
+			state->stats->sample = stats->sample;
+			state->stats->count = stats->count;
+			state->stats->min = stats->min;
+			state->stats->max = stats->max;
+			state->stats->sum = stats->sum;
+			state->stats->mean = stats->mean;
+			state->stats->stddev = -1;
+		}
+		else {
+			state->stats->count += stats->count;
+			state->stats->sum += stats->sum;
+
+			if (stats->min < state->stats->min)
+				state->stats->min = stats->min;
+			if (stats->max > state->stats->max)
+				state->stats->max = stats->max;
+		}
+	}
+
+	pfree(stats);
+
+	/* switch back to local context */
+	MemoryContextSwitchTo(oldcontext);
+
+	POSTGIS_RT_DEBUG(3, "Finished");
+
+	PG_RETURN_POINTER(state);
+}
+
+/**
+ * Returns histogram for a band
+ */
+PG_FUNCTION_INFO_V1(RASTER_histogram);
+Datum RASTER_histogram(PG_FUNCTION_ARGS)
+{
+	FuncCallContext *funcctx;
+	TupleDesc tupdesc;
+
+	int i;
+	rt_histogram hist;
+	rt_histogram hist2;
+	int call_cntr;
+	int max_calls;
+
+	/* first call of function */
+	if (SRF_IS_FIRSTCALL()) {
+		MemoryContext oldcontext;
+
+		rt_pgraster *pgraster = NULL;
+		rt_raster raster = NULL;
+		rt_band band = NULL;
+		int32_t bandindex = 1;
+		int num_bands = 0;
+		bool exclude_nodata_value = TRUE;
+		double sample = 0;
+		uint32_t bin_count = 0;
+		double *bin_width = NULL;
+		uint32_t bin_width_count = 0;
+		double width = 0;
+		bool right = FALSE;
+		double min = 0;
+		double max = 0;
+		rt_bandstats stats = NULL;
+		uint32_t count;
+
+		int j;
+		int n;
+
+		ArrayType *array;
+		Oid etype;
+		Datum *e;
+		bool *nulls;
+		int16 typlen;
+		bool typbyval;
+		char typalign;
+
+		POSTGIS_RT_DEBUG(3, "RASTER_histogram: Starting");
+
+		/* create a function context for cross-call persistence */
+		funcctx = SRF_FIRSTCALL_INIT();
+
+		/* switch to memory context appropriate for multiple function calls */
+		oldcontext = MemoryContextSwitchTo(funcctx->multi_call_memory_ctx);
+
+		/* pgraster is null, return nothing */
+		if (PG_ARGISNULL(0)) {
+			MemoryContextSwitchTo(oldcontext);
+			SRF_RETURN_DONE(funcctx);
+		}
+		pgraster = (rt_pgraster *) PG_DETOAST_DATUM(PG_GETARG_DATUM(0));
+
+		raster = rt_raster_deserialize(pgraster, FALSE);
+		if (!raster) {
+			PG_FREE_IF_COPY(pgraster, 0);
+			MemoryContextSwitchTo(oldcontext);
+			elog(ERROR, "RASTER_histogram: Cannot deserialize raster");
+			SRF_RETURN_DONE(funcctx);
+		}
+
+		/* band index is 1-based */
+		if (!PG_ARGISNULL(1))
+			bandindex = PG_GETARG_INT32(1);
+		num_bands = rt_raster_get_num_bands(raster);
+		if (bandindex < 1 || bandindex > num_bands) {
+			elog(NOTICE, "Invalid band index (must use 1-based). Returning NULL");
+			rt_raster_destroy(raster);
+			PG_FREE_IF_COPY(pgraster, 0);
+			MemoryContextSwitchTo(oldcontext);
+			SRF_RETURN_DONE(funcctx);
+		}
+
+		/* exclude_nodata_value flag */
+		if (!PG_ARGISNULL(2))
+			exclude_nodata_value = PG_GETARG_BOOL(2);
+
+		/* sample % */
+		if (!PG_ARGISNULL(3)) {
+			sample = PG_GETARG_FLOAT8(3);
+			if (sample < 0 || sample > 1) {
+				elog(NOTICE, "Invalid sample percentage (must be between 0 and 1). Returning NULL");
+				rt_raster_destroy(raster);
+				PG_FREE_IF_COPY(pgraster, 0);
+				MemoryContextSwitchTo(oldcontext);
+				SRF_RETURN_DONE(funcctx);
+			}
+			else if (FLT_EQ(sample, 0.0))
+				sample = 1;
+		}
+		else
+			sample = 1;
 
 		/* bin_count */
 		if (!PG_ARGISNULL(4)) {
@@ -2401,6 +2921,491 @@ Datum RASTER_quantileCoverage(PG_FUNCTION_ARGS)
 	}
 }
 
+/* ---------------------------------------------------------------- */
+/* Aggregate ST_QuantileAgg                                         */
+/* ---------------------------------------------------------------- */
+
+typedef struct rtpg_quantileagg_arg_t *rtpg_quantileagg_arg;
+struct rtpg_quantileagg_arg_t {
+	rt_quantile_sketch sketch;
+
+	int32_t band_index; /* one-based */
+	bool exclude_nodata_value;
+	double *quantiles; /* NULL for quartiles */
+	int quantiles_count;
+};
+
+static void
+rtpg_quantileagg_arg_destroy(rtpg_quantileagg_arg arg) {
+	if (arg->sketch != NULL)
+		rt_quantile_sketch_destroy(arg->sketch);
+	if (arg->quantiles != NULL)
+		pfree(arg->quantiles);
+
+	pfree(arg);
+}
+
+static rtpg_quantileagg_arg
+rtpg_quantileagg_arg_init() {
+	rtpg_quantileagg_arg arg = NULL;
+
+	arg = palloc(sizeof(struct rtpg_quantileagg_arg_t));
+	if (arg == NULL) {
+		elog(
+			ERROR,
+			"rtpg_quantileagg_arg_init: Cannot allocate memory for function arguments"
+		);
+		return NULL;
+	}
+
+	arg->band_index = 1;
+	arg->exclude_nodata_value = TRUE;
+	arg->quantiles = NULL;
+	arg->quantiles_count = 0;
+
+	arg->sketch = rt_quantile_sketch_new(0);
+	if (arg->sketch == NULL) {
+		rtpg_quantileagg_arg_destroy(arg);
+		elog(
+			ERROR,
+			"rtpg_quantileagg_arg_init: Cannot allocate memory for quantile sketch"
+		);
+		return NULL;
+	}
+
+	return arg;
+}
+
+PG_FUNCTION_INFO_V1(RASTER_quantile_transfn);
+Datum RASTER_quantile_transfn(PG_FUNCTION_ARGS)
+{
+	MemoryContext aggcontext;
+	MemoryContext oldcontext;
+	rtpg_quantileagg_arg state = NULL;
+
+	int i = 0;
+	int j = 0;
+
+	rt_pgraster *pgraster = NULL;
+	rt_raster raster = NULL;
+	rt_band band = NULL;
+	int num_bands = 0;
+	rt_errorstate err;
+
+	POSTGIS_RT_DEBUG(3, "Starting...");
+
+	/* cannot be called directly as this is exclusive aggregate function */
+	if (!AggCheckCallContext(fcinfo, &aggcontext)) {
+		elog(
+			ERROR,
+			"RASTER_quantile_transfn: Cannot be called in a non-aggregate context"
+		);
+		PG_RETURN_NULL();
+	}
+
+	/* switch to aggcontext */
+	oldcontext = MemoryContextSwitchTo(aggcontext);
+
+	if (!PG_ARGISNULL(0)) {
+		POSTGIS_RT_DEBUG(3, "State variable already exists");
+		state = (rtpg_quantileagg_arg) PG_GETARG_POINTER(0);
+	}
+	else {
+		Oid calltype;
+		int nargs = 0;
+
+		ArrayType *array;
+		Oid etype;
+		Datum *e;
+		bool *nulls;
+		int16 typlen;
+		bool typbyval;
+		char typalign;
+		int n;
+
+		POSTGIS_RT_DEBUG(3, "Creating state variable");
+
+		state = rtpg_quantileagg_arg_init();
+		if (state == NULL) {
+			MemoryContextSwitchTo(oldcontext);
+			elog(
+				ERROR,
+				"RASTER_quantile_transfn: Cannot allocate memory for state variable"
+			);
+			PG_RETURN_NULL();
+		}
+
+		/* 3 to 5 total possible args */
+		nargs = PG_NARGS();
+		POSTGIS_RT_DEBUGF(4, "nargs = %d", nargs);
+
+		for (i = 2; i < nargs; i++) {
+			if (PG_ARGISNULL(i))
+				continue;
+
+			calltype = get_fn_expr_argtype(fcinfo->flinfo, i);
+
+			/* band index */
+			if (
+				(calltype == INT2OID || calltype == INT4OID) &&
+				i == 2
+			) {
+				if (calltype == INT2OID)
+					state->band_index = PG_GETARG_INT16(i);
+				else
+					state->band_index = PG_GETARG_INT32(i);
+
+				/* basic check, > 0 */
+				if (state->band_index < 1) {
+					rtpg_quantileagg_arg_destroy(state);
+					MemoryContextSwitchTo(oldcontext);
+					elog(
+						ERROR,
+						"RASTER_quantile_transfn: Invalid band index (must use 1-based). Returning NULL"
+					);
+					PG_RETURN_NULL();
+				}
+			}
+			/* exclude_nodata_value */
+			else if (calltype == BOOLOID && i == 3) {
+				state->exclude_nodata_value = PG_GETARG_BOOL(i);
+			}
+			/* quantiles */
+			else if (get_element_type(calltype) == FLOAT8OID) {
+				array = PG_GETARG_ARRAYTYPE_P(i);
+				etype = ARR_ELEMTYPE(array);
+				get_typlenbyvalalign(etype, &typlen, &typbyval, &typalign);
+
+				deconstruct_array(array, etype, typlen, typbyval, typalign, &e,
+					&nulls, &n);
+
+				state->quantiles = palloc(sizeof(double) * (n > 0 ? n : 1));
+				for (j = 0; j < n; j++) {
+					if (nulls[j]) continue;
+
+					state->quantiles[state->quantiles_count] = DatumGetFloat8(e[j]);
+					if (
+						state->quantiles[state->quantiles_count] < 0 ||
+						state->quantiles[state->quantiles_count] > 1
+					) {
+						rtpg_quantileagg_arg_destroy(state);
+						MemoryContextSwitchTo(oldcontext);
+						elog(
+							ERROR,
+							"RASTER_quantile_transfn: Invalid value for quantile (must be between 0 and 1)"
+						);
+						PG_RETURN_NULL();
+					}
+					state->quantiles_count++;
+				}
+
+				/* no quantiles, use quartiles */
+				if (state->quantiles_count < 1) {
+					pfree(state->quantiles);
+					state->quantiles = NULL;
+				}
+			}
+			/* unknown arg */
+			else {
+				rtpg_quantileagg_arg_destroy(state);
+				MemoryContextSwitchTo(oldcontext);
+				elog(
+					ERROR,
+					"RASTER_quantile_transfn: Unknown function parameter at index %d",
+					i
+				);
+				PG_RETURN_NULL();
+			}
+		}
+	}
+
+	/* null raster, return */
+	if (PG_ARGISNULL(1)) {
+		POSTGIS_RT_DEBUG(4, "NULL raster so processing required");
+		MemoryContextSwitchTo(oldcontext);
+		PG_RETURN_POINTER(state);
+	}
+
+	/* deserialize raster */
+	pgraster = (rt_pgraster *) PG_DETOAST_DATUM(PG_GETARG_DATUM(1));
+
+	/* Get raster object */
+	raster = rt_raster_deserialize(pgraster, FALSE);
+	if (raster == NULL) {
+		PG_FREE_IF_COPY(pgraster, 1);
+		MemoryContextSwitchTo(oldcontext);
+		elog(ERROR, "RASTER_quantile_transfn: Cannot deserialize raster");
+		PG_RETURN_NULL();
+	}
+
+	/* inspect number of bands */
+	num_bands = rt_raster_get_num_bands(raster);
+	if (state->band_index > num_bands) {
+		elog(
+			NOTICE,
+			"Raster does not have band at index %d. Skipping raster",
+			state->band_index
+		);
+
+		rt_raster_destroy(raster);
+		PG_FREE_IF_COPY(pgraster, 1);
+
+		MemoryContextSwitchTo(oldcontext);
+		PG_RETURN_POINTER(state);
+	}
+
+	/* get band */
+	band = rt_raster_get_band(raster, state->band_index - 1);
+	if (!band) {
+		elog(
+			NOTICE, "Cannot find band at index %d. Skipping raster",
+			state->band_index
+		);
+
+		rt_raster_destroy(raster);
+		PG_FREE_IF_COPY(pgraster, 1);
+
+		MemoryContextSwitchTo(oldcontext);
+		PG_RETURN_POINTER(state);
+	}
+
+	err = rt_quantile_sketch_add_band(
+		state->sketch,
+		band, (int) state->exclude_nodata_value, 1
+	);
+
+	rt_band_destroy(band);
+	rt_raster_destroy(raster);
+	PG_FREE_IF_COPY(pgraster, 1);
+
+	if (err != ES_NONE) {
+		MemoryContextSwitchTo(oldcontext);
+		elog(
+			ERROR,
+			"RASTER_quantile_transfn: Cannot add band at index %d to quantile sketch",
+			state->band_index
+		);
+		PG_RETURN_NULL();
+	}
+
+	/* switch back to local context */
+	MemoryContextSwitchTo(oldcontext);
+
+	POSTGIS_RT_DEBUG(3, "Finished");
+
+	PG_RETURN_POINTER(state);
+}
+
+PG_FUNCTION_INFO_V1(RASTER_quantile_combinefn);
+Datum RASTER_quantile_combinefn(PG_FUNCTION_ARGS)
+{
+	MemoryContext aggcontext;
+	MemoryContext oldcontext;
+	rtpg_quantileagg_arg state1 = NULL;
+	rtpg_quantileagg_arg state2 = NULL;
+
+	/* cannot be called directly as this is exclusive aggregate function */
+	if (!AggCheckCallContext(fcinfo, &aggcontext)) {
+		elog(
+			ERROR,
+			"RASTER_quantile_combinefn: Cannot be called in a non-aggregate context"
+		);
+		PG_RETURN_NULL();
+	}
+
+	if (PG_ARGISNULL(1)) {
+		if (PG_ARGISNULL(0))
+			PG_RETURN_NULL();
+		PG_RETURN_POINTER(PG_GETARG_POINTER(0));
+	}
+	state2 = (rtpg_quantileagg_arg) PG_GETARG_POINTER(1);
+
+	oldcontext = MemoryContextSwitchTo(aggcontext);
+
+	/* the state of the partial aggregate is copied into aggcontext */
+	if (PG_ARGISNULL(0)) {
+		state1 = rtpg_quantileagg_arg_init();
+		state1->band_index = state2->band_index;
+		state1->exclude_nodata_value = state2->exclude_nodata_value;
+		state1->quantiles_count = state2->quantiles_count;
+		if (state2->quantiles != NULL) {
+			state1->quantiles = palloc(sizeof(double) * state2->quantiles_count);
+			memcpy(state1->quantiles, state2->quantiles, sizeof(double) * state2->quantiles_count);
+		}
+	}
+	else
+		state1 = (rtpg_quantileagg_arg) PG_GETARG_POINTER(0);
+
+	if (rt_quantile_sketch_merge(state1->sketch, state2->sketch) != ES_NONE) {
+		MemoryContextSwitchTo(oldcontext);
+		elog(ERROR, "RASTER_quantile_combinefn: Cannot merge quantile sketches");
+		PG_RETURN_NULL();
+	}
+
+	MemoryContextSwitchTo(oldcontext);
+
+	PG_RETURN_POINTER(state1);
+}
+
+PG_FUNCTION_INFO_V1(RASTER_quantile_serialfn);
+Datum RASTER_quantile_serialfn(PG_FUNCTION_ARGS)
+{
+	rtpg_quantileagg_arg state = NULL;
+	uint8_t *sketch = NULL;
+	uint32_t sketch_size = 0;
+	bytea *result = NULL;
+	uint8_t *ptr = NULL;
+	int32_t header[3];
+
+	/* cannot be called directly as this is exclusive aggregate function */
+	if (!AggCheckCallContext(fcinfo, NULL)) {
+		elog(ERROR, "RASTER_quantile_serialfn: Cannot be called in a non-aggregate context");
+		PG_RETURN_NULL();
+	}
+
+	state = (rtpg_quantileagg_arg) PG_GETARG_POINTER(0);
+
+	sketch = rt_quantile_sketch_serialize(state->sketch, &sketch_size);
+	if (sketch == NULL) {
+		elog(ERROR, "RASTER_quantile_serialfn: Cannot serialize quantile sketch");
+		PG_RETURN_NULL();
+	}
+
+	/* band index, exclude_nodata_value, quantiles and sketch */
+	header[0] = state->band_index;
+	header[1] = state->exclude_nodata_value ? 1 : 0;
+	header[2] = state->quantiles_count;
+
+	result = palloc(
+		VARHDRSZ + sizeof(header) +
+		sizeof(double) * state->quantiles_count + sketch_size
+	);
+	SET_VARSIZE(result,
+		VARHDRSZ + sizeof(header) +
+		sizeof(double) * state->quantiles_count + sketch_size
+	);
+
+	ptr = (uint8_t *) VARDATA(result);
+	memcpy(ptr, header, sizeof(header));
+	ptr += sizeof(header);
+	if (state->quantiles_count > 0) {
+		memcpy(ptr, state->quantiles, sizeof(double) * state->quantiles_count);
+		ptr += sizeof(double) * state->quantiles_count;
+	}
+	memcpy(ptr, sketch, sketch_size);
+	pfree(sketch);
+
+	PG_RETURN_BYTEA_P(result);
+}
+
+PG_FUNCTION_INFO_V1(RASTER_quantile_deserialfn);
+Datum RASTER_quantile_deserialfn(PG_FUNCTION_ARGS)
+{
+	MemoryContext aggcontext;
+	MemoryContext oldcontext;
+	rtpg_quantileagg_arg state = NULL;
+	bytea *data = NULL;
+	uint8_t *ptr = NULL;
+	uint32_t size = 0;
+	int32_t header[3];
+
+	/* cannot be called directly as this is exclusive aggregate function */
+	if (!AggCheckCallContext(fcinfo, &aggcontext)) {
+		elog(ERROR, "RASTER_quantile_deserialfn: Cannot be called in a non-aggregate context");
+		PG_RETURN_NULL();
+	}
+
+	data = PG_GETARG_BYTEA_P(0);
+	ptr = (uint8_t *) VARDATA(data);
+	size = VARSIZE(data) - VARHDRSZ;
+
+	memcpy(header, ptr, sizeof(header));
+	ptr += sizeof(header);
+	size -= sizeof(header);
+
+	oldcontext = MemoryContextSwitchTo(aggcontext);
+
+	state = palloc(sizeof(struct rtpg_quantileagg_arg_t));
+	state->band_index = header[0];
+	state->exclude_nodata_value = header[1] ? TRUE : FALSE;
+	state->quantiles_count = header[2];
+	state->quantiles = NULL;
+	if (state->quantiles_count > 0) {
+		state->quantiles = palloc(sizeof(double) * state->quantiles_count);
+		memcpy(state->quantiles, ptr, sizeof(double) * state->quantiles_count);
+		ptr += sizeof(double) * state->quantiles_count;
+		size -= sizeof(double) * state->quantiles_count;
+	}
+
+	state->sketch = rt_quantile_sketch_deserialize(ptr, size);
+	if (state->sketch == NULL) {
+		MemoryContextSwitchTo(oldcontext);
+		elog(ERROR, "RASTER_quantile_deserialfn: Cannot deserialize quantile sketch");
+		PG_RETURN_NULL();
+	}
+
+	MemoryContextSwitchTo(oldcontext);
+
+	PG_RETURN_POINTER(state);
+}
+
+PG_FUNCTION_INFO_V1(RASTER_quantile_finalfn);
+Datum RASTER_quantile_finalfn(PG_FUNCTION_ARGS)
+{
+	rtpg_quantileagg_arg state = NULL;
+	rt_quantile quant = NULL;
+	uint32_t count = 0;
+	uint32_t i = 0;
+	Datum *values = NULL;
+	ArrayType *result = NULL;
+	int16 typlen;
+	bool typbyval;
+	char typalign;
+
+	POSTGIS_RT_DEBUG(3, "Starting...");
+
+	/* cannot be called directly as this is exclusive aggregate function */
+	if (!AggCheckCallContext(fcinfo, NULL)) {
+		elog(ERROR, "RASTER_quantile_finalfn: Cannot be called in a non-aggregate context");
+		PG_RETURN_NULL();
+	}
+
+	/* NULL, return null */
+	if (PG_ARGISNULL(0))
+		PG_RETURN_NULL();
+
+	state = (rtpg_quantileagg_arg) PG_GETARG_POINTER(0);
+
+	/* no pixel values, return null */
+	if (state->sketch->total <= 0)
+		PG_RETURN_NULL();
+
+	quant = rt_quantile_sketch_get_quantiles(
+		state->sketch,
+		state->quantiles, state->quantiles_count,
+		&count
+	);
+	if (quant == NULL) {
+		elog(ERROR, "RASTER_quantile_finalfn: Cannot compute coverage quantiles");
+		PG_RETURN_NULL();
+	}
+
+	values = palloc(sizeof(Datum) * count);
+	for (i = 0; i < count; i++)
+		values[i] = Float8GetDatum(quant[i].value);
+	pfree(quant);
+
+	get_typlenbyvalalign(FLOAT8OID, &typlen, &typbyval, &typalign);
+	result = construct_array(
+		values, count,
+		FLOAT8OID,
+		typlen, typbyval, typalign
+	);
+	pfree(values);
+
+	PG_RETURN_ARRAYTYPE_P(result);
+}
+
 /* get counts of values */
 PG_FUNCTION_INFO_V1(RASTER_valueCount);
 Datum RASTER_valueCount(PG_FUNCTION_ARGS) {
@@ -243,6 +243,9 @@ rt_pg_debug(const char *fmt, va_list ap)
 static char *gdal_datapath = NULL;
 extern char *gdal_enabled_drivers;
 extern char enable_outdb_rasters;
+extern char enable_raster_compression;
+extern int gdal_warp_num_threads;
+extern int gdal_warp_memory_limit;
 
 /* postgis.gdal_datapath */
 static void
@@ -543,6 +546,85 @@ _PG_init(void) {
 		);
 	}
 
+	if ( postgis_guc_find_option("postgis.enable_raster_compression") )
+	{
+		/* In this narrow case the previously installed GUC is tied to the callback in */
+		/* the previously loaded library. Probably this is happening during an */
+		/* upgrade, so the old library is where the callback ties to. */
+		elog(WARNING, "'%s' is already set and cannot be changed until you reconnect", "postgis.enable_raster_compression");
+	}
+	else
+	{
+		DefineCustomBoolVariable(
+			"postgis.enable_raster_compression", /* name */
+			"Enable run-length encoding of in-db raster bands", /* short_desc */
+			"If true, in-db raster bands are stored run-length encoded when smaller", /* long_desc */
+			&enable_raster_compression, /* valueAddr */
+			false, /* bootValue */
+			PGC_USERSET, /* GucContext context */
+			0, /* int flags */
+#if POSTGIS_PGSQL_VERSION >= 91
+			NULL, /* GucBoolCheckHook check_hook */
+#endif
+			NULL, /* GucBoolAssignHook assign_hook */
+			NULL  /* GucShowHook show_hook */
+		);
+	}
+
+	if ( postgis_guc_find_option("postgis.gdal_warp_num_threads") )
+	{
+		/* In this narrow case the previously installed GUC is tied to the callback in */
+		/* the previously loaded library. Probably this is happening during an */
+		/* upgrade, so the old library is where the callback ties to. */
+		elog(WARNING, "'%s' is already set and cannot be changed until you reconnect", "postgis.gdal_warp_num_threads");
+	}
+	else
+	{
+		DefineCustomIntVariable(
+			"postgis.gdal_warp_num_threads", /* name */
+			"Number of threads used by GDAL Warp API", /* short_desc */
+			"Number of threads GDAL uses to warp rasters in ST_Transform and ST_Resample. Use 0 for all CPUs (sets the NUM_THREADS warp option).", /* long_desc */
+			&gdal_warp_num_threads, /* valueAddr */
+			1, /* bootValue */
+			0, /* minValue */
+			1024, /* maxValue */
+			PGC_USERSET, /* GucContext context */
+			0, /* int flags */
+#if POSTGIS_PGSQL_VERSION >= 91
+			NULL, /* GucIntCheckHook check_hook */
+#endif
+			NULL, /* GucIntAssignHook assign_hook */
+			NULL  /* GucShowHook show_hook */
+		);
+	}
+
+	if ( postgis_guc_find_option("postgis.gdal_warp_memory_limit") )
+	{
+		/* In this narrow case the previously installed GUC is tied to the callback in */
+		/* the previously loaded library. Probably this is happening during an */
+		/* upgrade, so the old library is where the callback ties to. */
+		elog(WARNING, "'%s' is already set and cannot be changed until you reconnect", "postgis.gdal_warp_memory_limit");
+	}
+	else
+	{
+		DefineCustomIntVariable(
+			"postgis.gdal_warp_memory_limit", /* name */
+			"Memory used by GDAL Warp API per chunk", /* short_desc */
+			"Amount of memory GDAL Warp API may use to warp a chunk of a raster. Use 0 for GDAL's default.", /* long_desc */
+			&gdal_warp_memory_limit, /* valueAddr */
+			0, /* bootValue */
+			0, /* minValue */
+			MAX_KILOBYTES, /* maxValue */
+			PGC_USERSET, /* GucContext context */
+			GUC_UNIT_KB, /* int flags */
+#if POSTGIS_PGSQL_VERSION >= 91
+			NULL, /* GucIntCheckHook check_hook */
+#endif
+			NULL, /* GucIntAssignHook assign_hook */
+			NULL  /* GucShowHook show_hook */
+		);
+	}
+
 	/* free memory allocations */
 	pfree(boot_postgis_gdal_enabled_drivers);
 }
@@ -1252,6 +1252,69 @@ static void test_band_get_pixel_line() {
 	cu_free_raster(rast);
 }
 
+static void test_band_new_window() {
+	rt_raster rast;
+	rt_band band;
+	rt_band window;
+	int maxX = 5;
+	int maxY = 5;
+	int x = 0;
+	int y = 0;
+	double val = 0;
+	int err = 0;
+
+	rast = rt_raster_new(maxX, maxY);
+	CU_ASSERT(rast != NULL);
+
+	band = cu_add_band(rast, PT_16BSI, 1, -1);
+	CU_ASSERT(band != NULL);
+
+	for (y = 0; y < maxY; y++) {
+		for (x = 0; x < maxX; x++)
+			rt_band_set_pixel(band, x, y, x + (y * maxX), NULL);
+	}
+
+	/* window inside the band */
+	window = rt_band_new_window(band, 1, 2, 3, 2, 1, -1);
+	CU_ASSERT(window != NULL);
+	CU_ASSERT_EQUAL(rt_band_get_width(window), 3);
+	CU_ASSERT_EQUAL(rt_band_get_height(window), 2);
+	CU_ASSERT_EQUAL(rt_band_get_pixtype(window), PT_16BSI);
+	err = rt_band_get_pixel(window, 0, 0, &val, NULL);
+	CU_ASSERT_EQUAL(err, ES_NONE);
+	CU_ASSERT_DOUBLE_EQUAL(val, 11, DBL_EPSILON);
+	err = rt_band_get_pixel(window, 2, 1, &val, NULL);
+	CU_ASSERT_EQUAL(err, ES_NONE);
+	CU_ASSERT_DOUBLE_EQUAL(val, 18, DBL_EPSILON);
+	rt_band_destroy(window);
+
+	/* window partially outside the band */
+	window = rt_band_new_window(band, 3, 3, 4, 4, 1, -1);
+	CU_ASSERT(window != NULL);
+	err = rt_band_get_pixel(window, 1, 1, &val, NULL);
+	CU_ASSERT_EQUAL(err, ES_NONE);
+	CU_ASSERT_DOUBLE_EQUAL(val, 24, DBL_EPSILON);
+	err = rt_band_get_pixel(window, 2, 1, &val, NULL);
+	CU_ASSERT_EQUAL(err, ES_NONE);
+	CU_ASSERT_DOUBLE_EQUAL(val, -1, DBL_EPSILON);
+	err = rt_band_get_pixel(window, 3, 3, &val, NULL);
+	CU_ASSERT_EQUAL(err, ES_NONE);
+	CU_ASSERT_DOUBLE_EQUAL(val, -1, DBL_EPSILON);
+	rt_band_destroy(window);
+
+	/* NODATA band */
+	rt_band_set_isnodata_flag(band, 1);
+	window = rt_band_new_window(band, 0, 0, 2, 2, 1, -1);
+	CU_ASSERT(window != NULL);
+	CU_ASSERT(rt_band_get_isnodata_flag(window));
+	err = rt_band_get_pixel(window, 1, 1, &val, NULL);
+	CU_ASSERT_EQUAL(err, ES_NONE);
+	CU_ASSERT_DOUBLE_EQUAL(val, -1, DBL_EPSILON);
+	rt_band_destroy(window);
+
+	cu_free_raster(rast);
+}
+
 /* register tests */
 void band_basics_suite_setup(void);
 void band_basics_suite_setup(void)
@@ -1270,5 +1333,6 @@ void band_basics_suite_setup(void)
 	PG_ADD_TEST(suite, test_band_pixtype_32BF);
 	PG_ADD_TEST(suite, test_band_pixtype_64BF);
 	PG_ADD_TEST(suite, test_band_get_pixel_line);
+	PG_ADD_TEST(suite, test_band_new_window);
 }
 
@@ -64,9 +64,27 @@ static void test_band_stats() {
 	CU_ASSERT(stats != NULL);
 	CU_ASSERT_DOUBLE_EQUAL(stats->min, 1, DBL_EPSILON);
 	CU_ASSERT_DOUBLE_EQUAL(stats->max, 198, DBL_EPSILON);
+	CU_ASSERT_EQUAL(stats->count, 9999);
+	CU_ASSERT_DOUBLE_EQUAL(stats->sum, 990000, DBL_EPSILON);
 
 	quantile = (rt_quantile) rt_band_get_quantiles(stats, NULL, 0, &count);
 	CU_ASSERT(quantile != NULL);
+	CU_ASSERT_EQUAL(count, 5);
+	CU_ASSERT_DOUBLE_EQUAL(quantile[0].value, 1, DBL_EPSILON);
+	CU_ASSERT_DOUBLE_EQUAL(quantile[1].value, 70, DBL_EPSILON);
+	CU_ASSERT_DOUBLE_EQUAL(quantile[2].value, 99, DBL_EPSILON);
+	CU_ASSERT_DOUBLE_EQUAL(quantile[3].value, 128, DBL_EPSILON);
+	CU_ASSERT_DOUBLE_EQUAL(quantile[4].value, 198, DBL_EPSILON);
+	rtdealloc(quantile);
+
+	quantile = (rt_quantile) rt_band_get_quantiles(stats, quantiles, 5, &count);
+	CU_ASSERT(quantile != NULL);
+	CU_ASSERT_EQUAL(count, 5);
+	CU_ASSERT_DOUBLE_EQUAL(quantile[0].value, 44, DBL_EPSILON);
+	CU_ASSERT_DOUBLE_EQUAL(quantile[1].value, 76, DBL_EPSILON);
+	CU_ASSERT_DOUBLE_EQUAL(quantile[2].value, 99, DBL_EPSILON);
+	CU_ASSERT_DOUBLE_EQUAL(quantile[3].value, 122, DBL_EPSILON);
+	CU_ASSERT_DOUBLE_EQUAL(quantile[4].value, 154, DBL_EPSILON);
 	rtdealloc(quantile);
 
 	histogram = (rt_histogram) rt_band_get_histogram(stats, 0, NULL, 0, 0, 0, 0, &count);
@@ -79,6 +97,16 @@ static void test_band_stats() {
 
 	histogram = (rt_histogram) rt_band_get_histogram(stats, 0, bin_width, 1, 0, 0, 0, &count);
 	CU_ASSERT(histogram != NULL);
+	CU_ASSERT_EQUAL(count, 2);
+	CU_ASSERT_EQUAL(histogram[0].count, 5148);
+	CU_ASSERT_EQUAL(histogram[1].count, 4851);
+	rtdealloc(histogram);
+
+	histogram = (rt_histogram) rt_band_get_histogram(stats, 0, bin_width, 1, 1, 0, 0, &count);
+	CU_ASSERT(histogram != NULL);
+	CU_ASSERT_EQUAL(count, 2);
+	CU_ASSERT_EQUAL(histogram[0].count, 5050);
+	CU_ASSERT_EQUAL(histogram[1].count, 4949);
 	rtdealloc(histogram);
 
 	rtdealloc(stats->values);
@@ -209,6 +237,117 @@ static void test_band_stats() {
 	cu_free_raster(raster);
 }
 
+static void test_band_quantile_sketch() {
+	rt_bandstats stats = NULL;
+	double quantiles[] = {0.1, 0.3, 0.5, 0.7, 0.9};
+	rt_quantile quantile = NULL;
+	rt_quantile exact = NULL;
+	uint32_t count = 0;
+	rt_quantile_sketch sketch = NULL;
+	rt_quantile_sketch other = NULL;
+	uint8_t *data = NULL;
+	uint32_t size = 0;
+
+	rt_raster raster;
+	rt_band band;
+	uint32_t x;
+	uint32_t xmax = 100;
+	uint32_t y;
+	uint32_t ymax = 100;
+	uint32_t i;
+
+	uint32_t values[] = {0, 91, 55, 86, 76, 41, 36, 97, 25, 63, 68, 2, 78, 15, 82, 47};
+
+	/* few values are not merged, so quantiles are exact */
+	raster = rt_raster_new(4, 4);
+	CU_ASSERT(raster != NULL);
+	band = cu_add_band(raster, PT_8BUI, 0, 0);
+	CU_ASSERT(band != NULL);
+	for (i = 0; i < 16; i++)
+		rt_band_set_pixel(band, i % 4, i / 4, values[i], NULL);
+
+	stats = (rt_bandstats) rt_band_get_summary_stats(band, 0, 1, 1, NULL, NULL, NULL);
+	CU_ASSERT(stats != NULL);
+	exact = (rt_quantile) rt_band_get_quantiles(stats, quantiles, 5, &count);
+	CU_ASSERT(exact != NULL);
+	rtdealloc(stats->values);
+	rtdealloc(stats);
+
+	sketch = rt_quantile_sketch_new(0);
+	CU_ASSERT(sketch != NULL);
+	CU_ASSERT_EQUAL(rt_quantile_sketch_add_band(sketch, band, 0, 1), ES_NONE);
+	quantile = rt_quantile_sketch_get_quantiles(sketch, quantiles, 5, &count);
+	CU_ASSERT(quantile != NULL);
+	CU_ASSERT_EQUAL(count, 5);
+	for (i = 0; i < count; i++)
+		CU_ASSERT_DOUBLE_EQUAL(quantile[i].value, exact[i].value, DBL_EPSILON);
+	rtdealloc(quantile);
+	rtdealloc(exact);
+	rt_quantile_sketch_destroy(sketch);
+	cu_free_raster(raster);
+
+	/* many values are merged into bounded centroids */
+	raster = rt_raster_new(xmax, ymax);
+	CU_ASSERT(raster != NULL);
+	band = cu_add_band(raster, PT_32BUI, 1, 0);
+	CU_ASSERT(band != NULL);
+
+	for (x = 0; x < xmax; x++) {
+		for (y = 0; y < ymax; y++) {
+			rt_band_set_pixel(band, x, y, x + y, NULL);
+		}
+	}
+
+	sketch = rt_quantile_sketch_new(0);
+	CU_ASSERT(sketch != NULL);
+	CU_ASSERT_EQUAL(rt_quantile_sketch_add_band(sketch, band, 1, 1), ES_NONE);
+	CU_ASSERT_DOUBLE_EQUAL(sketch->total, 9999, DBL_EPSILON);
+	CU_ASSERT(sketch->count + sketch->buffered <= sketch->capacity);
+
+	quantile = rt_quantile_sketch_get_quantiles(sketch, NULL, 0, &count);
+	CU_ASSERT(quantile != NULL);
+	CU_ASSERT_EQUAL(count, 5);
+	CU_ASSERT(sketch->count <= 102);
+	CU_ASSERT_DOUBLE_EQUAL(quantile[0].value, 1, DBL_EPSILON);
+	CU_ASSERT_DOUBLE_EQUAL(quantile[1].value, 70, 1);
+	CU_ASSERT_DOUBLE_EQUAL(quantile[2].value, 99, 1);
+	CU_ASSERT_DOUBLE_EQUAL(quantile[3].value, 128, 1);
+	CU_ASSERT_DOUBLE_EQUAL(quantile[4].value, 198, DBL_EPSILON);
+	rtdealloc(quantile);
+
+	/* merge with a sketch of the same values passed through a buffer */
+	data = rt_quantile_sketch_serialize(sketch, &size);
+	CU_ASSERT(data != NULL);
+	other = rt_quantile_sketch_deserialize(data, size);
+	CU_ASSERT(other != NULL);
+	CU_ASSERT_EQUAL(other->count, sketch->count);
+	CU_ASSERT(rt_quantile_sketch_deserialize(data, size - 1) == NULL);
+	rtdealloc(data);
+
+	CU_ASSERT_EQUAL(rt_quantile_sketch_merge(sketch, other), ES_NONE);
+	CU_ASSERT_DOUBLE_EQUAL(sketch->total, 19998, DBL_EPSILON);
+	rt_quantile_sketch_destroy(other);
+
+	quantile = rt_quantile_sketch_get_quantiles(sketch, NULL, 0, &count);
+	CU_ASSERT(quantile != NULL);
+	CU_ASSERT(sketch->count <= 102);
+	CU_ASSERT_DOUBLE_EQUAL(quantile[0].value, 1, DBL_EPSILON);
+	CU_ASSERT_DOUBLE_EQUAL(quantile[1].value, 70, 1);
+	CU_ASSERT_DOUBLE_EQUAL(quantile[2].value, 99, 1);
+	CU_ASSERT_DOUBLE_EQUAL(quantile[3].value, 128, 1);
+	CU_ASSERT_DOUBLE_EQUAL(quantile[4].value, 198, DBL_EPSILON);
+	rtdealloc(quantile);
+
+	quantile = rt_quantile_sketch_get_quantiles(sketch, quantiles, 5, &count);
+	CU_ASSERT(quantile != NULL);
+	CU_ASSERT_DOUBLE_EQUAL(quantile[0].value, 44, 1);
+	CU_ASSERT_DOUBLE_EQUAL(quantile[4].value, 154, 1);
+	rtdealloc(quantile);
+
+	rt_quantile_sketch_destroy(sketch);
+	cu_free_raster(raster);
+}
+
 static void test_band_value_count() {
 	rt_valuecount vcnts = NULL;
 
@@ -266,12 +405,86 @@ static void test_band_value_count() {
 	cu_free_raster(raster);
 }
 
+static void test_band_zonal_stats() {
+	rt_bandstats stats = NULL;
+	rt_histogram histogram = NULL;
+	double bin_width[] = {2};
+	uint32_t count = 0;
+	uint64_t cK = 0;
+	double cM = 0;
+	double cQ = 0;
+
+	rt_raster raster;
+	rt_band band;
+	LWGEOM *geom;
+	uint32_t x;
+	uint32_t y;
+
+	raster = rt_raster_new(10, 10);
+	CU_ASSERT(raster != NULL);
+	rt_raster_set_offsets(raster, 0, 10);
+	rt_raster_set_scale(raster, 1, -1);
+	band = cu_add_band(raster, PT_32BUI, 1, 0);
+	CU_ASSERT(band != NULL);
+
+	for (x = 0; x < 10; x++) {
+		for (y = 0; y < 10; y++) {
+			rt_band_set_pixel(band, x, y, x + y, NULL);
+		}
+	}
+
+	/* upper-left 3x3 pixels */
+	geom = lwgeom_from_wkt("POLYGON((0 10,3 10,3 7,0 7,0 10))", LW_PARSER_CHECK_NONE);
+	CU_ASSERT(geom != NULL);
+
+	stats = rt_raster_get_zonal_stats(raster, 0, geom, 1, 1, &cK, &cM, &cQ);
+	CU_ASSERT(stats != NULL);
+	CU_ASSERT_EQUAL(stats->count, 8);
+	CU_ASSERT_DOUBLE_EQUAL(stats->sum, 18, DBL_EPSILON);
+	CU_ASSERT_DOUBLE_EQUAL(stats->mean, 2.25, DBL_EPSILON);
+	CU_ASSERT_DOUBLE_EQUAL(stats->min, 1, DBL_EPSILON);
+	CU_ASSERT_DOUBLE_EQUAL(stats->max, 4, DBL_EPSILON);
+	CU_ASSERT_EQUAL(cK, 8);
+
+	histogram = (rt_histogram) rt_band_get_histogram(stats, 0, bin_width, 1, 0, 0, 0, &count);
+	CU_ASSERT(histogram != NULL);
+	CU_ASSERT_EQUAL(count, 2);
+	CU_ASSERT_EQUAL(histogram[0].count, 5);
+	CU_ASSERT_EQUAL(histogram[1].count, 3);
+	rtdealloc(histogram);
+
+	rtdealloc(stats->values);
+	rtdealloc(stats);
+
+	/* NODATA pixel included */
+	stats = rt_raster_get_zonal_stats(raster, 0, geom, 0, 0, &cK, &cM, &cQ);
+	CU_ASSERT(stats != NULL);
+	CU_ASSERT_EQUAL(stats->count, 9);
+	CU_ASSERT_DOUBLE_EQUAL(stats->min, 0, DBL_EPSILON);
+	CU_ASSERT(stats->values == NULL);
+	CU_ASSERT_EQUAL(cK, 17);
+	rtdealloc(stats);
+	lwgeom_free(geom);
+
+	/* outside of raster */
+	geom = lwgeom_from_wkt("POLYGON((20 20,30 20,30 30,20 30,20 20))", LW_PARSER_CHECK_NONE);
+	stats = rt_raster_get_zonal_stats(raster, 0, geom, 1, 0, NULL, NULL, NULL);
+	CU_ASSERT(stats != NULL);
+	CU_ASSERT_EQUAL(stats->count, 0);
+	rtdealloc(stats);
+	lwgeom_free(geom);
+
+	cu_free_raster(raster);
+}
+
 /* register tests */
 void band_stats_suite_setup(void);
 void band_stats_suite_setup(void)
 {
 	CU_pSuite suite = CU_add_suite("band_stats", NULL, NULL);
 	PG_ADD_TEST(suite, test_band_stats);
+	PG_ADD_TEST(suite, test_band_quantile_sketch);
 	PG_ADD_TEST(suite, test_band_value_count);
+	PG_ADD_TEST(suite, test_band_zonal_stats);
 }
 
@@ -96,6 +96,98 @@ static void test_gdal_rasterize() {
 	cu_free_raster(raster);
 }
 
+static void test_gdal_rasterize_native() {
+	const char *wkt[] = {
+		"POLYGON((0 0,1000 0,1000 1000,0 1000,0 0),(400 400,400 600,600 600,600 400,400 400))",
+		/* covers no pixel center */
+		"POLYGON((0 0,10 0,0 10,0 0))"
+	};
+	/* any option forces the GDAL path without changing the result */
+	char *options[] = {"ALL_TOUCHED=FALSE", NULL};
+	LWGEOM *geom = NULL;
+	unsigned char *wkb = NULL;
+	size_t wkb_len = 0;
+	rt_raster rast_native = NULL;
+	rt_raster rast_gdal = NULL;
+	rt_band band_native = NULL;
+	rt_band band_gdal = NULL;
+	double val_native = 0;
+	double val_gdal = 0;
+	int nodata_native = 0;
+	int nodata_gdal = 0;
+	int i = 0;
+	int x = 0;
+	int y = 0;
+	double scale_x = 100;
+	double scale_y = -100;
+
+	rt_pixtype pixtype[] = {PT_8BUI};
+	double init[] = {0};
+	double value[] = {1};
+	double nodata[] = {0};
+	uint8_t nodata_mask[] = {1};
+
+	for (i = 0; i < 2; i++) {
+		geom = lwgeom_from_wkt(wkt[i], LW_PARSER_CHECK_NONE);
+		CU_ASSERT(geom != NULL);
+		wkb = lwgeom_to_wkb(geom, WKB_ISO | WKB_NDR, &wkb_len);
+		lwgeom_free(geom);
+
+		rast_native = rt_raster_gdal_rasterize(
+			wkb, wkb_len, NULL,
+			1, pixtype,
+			init, value,
+			nodata, nodata_mask,
+			NULL, NULL,
+			&scale_x, &scale_y,
+			NULL, NULL,
+			NULL, NULL,
+			NULL, NULL,
+			NULL
+		);
+		CU_ASSERT(rast_native != NULL);
+
+		rast_gdal = rt_raster_gdal_rasterize(
+			wkb, wkb_len, NULL,
+			1, pixtype,
+			init, value,
+			nodata, nodata_mask,
+			NULL, NULL,
+			&scale_x, &scale_y,
+			NULL, NULL,
+			NULL, NULL,
+			NULL, NULL,
+			options
+		);
+		CU_ASSERT(rast_gdal != NULL);
+		lwfree(wkb);
+
+		CU_ASSERT_EQUAL(rt_raster_get_width(rast_native), rt_raster_get_width(rast_gdal));
+		CU_ASSERT_EQUAL(rt_raster_get_height(rast_native), rt_raster_get_height(rast_gdal));
+
+		band_native = rt_raster_get_band(rast_native, 0);
+		band_gdal = rt_raster_get_band(rast_gdal, 0);
+		CU_ASSERT(band_native != NULL);
+		CU_ASSERT(band_gdal != NULL);
+
+		CU_ASSERT_EQUAL(rt_band_get_hasnodata_flag(band_native), rt_band_get_hasnodata_flag(band_gdal));
+		CU_ASSERT_EQUAL(rt_band_get_isnodata_flag(band_native), rt_band_get_isnodata_flag(band_gdal));
+		CU_ASSERT_FALSE(rt_band_get_isnodata_flag(band_native));
+
+		for (y = 0; y < rt_raster_get_height(rast_native); y++) {
+			for (x = 0; x < rt_raster_get_width(rast_native); x++) {
+				rt_band_get_pixel(band_native, x, y, &val_native, &nodata_native);
+				rt_band_get_pixel(band_gdal, x, y, &val_gdal, &nodata_gdal);
+				CU_ASSERT_DOUBLE_EQUAL(val_native, val_gdal, DBL_EPSILON);
+				CU_ASSERT_EQUAL(nodata_native, nodata_gdal);
+			}
+		}
+
+		cu_free_raster(rast_native);
+		cu_free_raster(rast_gdal);
+	}
+}
+
 static char *
 lwgeom_to_text(const LWGEOM *lwgeom) {
 	char *wkt;
@@ -651,6 +743,7 @@ void gdal_suite_setup(void)
 	PG_ADD_TEST(suite, test_gdal_configured);
 	PG_ADD_TEST(suite, test_gdal_drivers);
 	PG_ADD_TEST(suite, test_gdal_rasterize);
+	PG_ADD_TEST(suite, test_gdal_rasterize_native);
 	PG_ADD_TEST(suite, test_gdal_polygonize);
 	PG_ADD_TEST(suite, test_raster_to_gdal);
 	PG_ADD_TEST(suite, test_gdal_to_raster);
@@ -1183,6 +1183,85 @@ static void test_raster_colormap() {
 	cu_free_raster(raster);
 }
 
+static int testMapExpr_eval(const char *expr, double rast1, double rast2, double *value, int *isnull) {
+	char *kw[] = {"[rast1.x]", "[rast1.y]", "[rast1]", "[rast2]"};
+	int kwint[] = {1, 1, 0, 0};
+	double values[] = {3, 7, rast1, rast2};
+	int nulls[] = {0, 0, 0, 0};
+	rt_mapexpr mexpr = NULL;
+	rt_errorstate rtn;
+
+	nulls[3] = isnan(rast2);
+
+	mexpr = rt_mapexpr_compile(expr, kw, kwint, 4);
+	if (mexpr == NULL)
+		return -1;
+
+	rtn = rt_mapexpr_eval(mexpr, values, nulls, value, isnull);
+	rt_mapexpr_destroy(mexpr);
+
+	return rtn == ES_NONE ? 1 : 0;
+}
+
+static void test_raster_mapexpr() {
+	double value = 0;
+	int isnull = 0;
+
+	/* arithmetic */
+	CU_ASSERT_EQUAL(testMapExpr_eval("([rast1] - [rast2]) / ([rast1] + [rast2])", 0.75, 0.25, &value, &isnull), 1);
+	CU_ASSERT_DOUBLE_EQUAL(value, 0.5, DBL_EPSILON);
+	CU_ASSERT_EQUAL(isnull, 0);
+
+	CU_ASSERT_EQUAL(testMapExpr_eval("-[rast1] * 2 + 1", 3, 0, &value, &isnull), 1);
+	CU_ASSERT_DOUBLE_EQUAL(value, -5, DBL_EPSILON);
+
+	/* int4 division truncates */
+	CU_ASSERT_EQUAL(testMapExpr_eval("[rast1.y] / 2", 0, 0, &value, &isnull), 1);
+	CU_ASSERT_DOUBLE_EQUAL(value, 3, DBL_EPSILON);
+	CU_ASSERT_EQUAL(testMapExpr_eval("[rast1.y] / 2.", 0, 0, &value, &isnull), -1);
+	CU_ASSERT_EQUAL(testMapExpr_eval("[rast1.y] % [rast1.x]", 0, 0, &value, &isnull), 1);
+	CU_ASSERT_DOUBLE_EQUAL(value, 1, DBL_EPSILON);
+	CU_ASSERT_EQUAL(testMapExpr_eval("[rast1] / 2", 7, 0, &value, &isnull), 1);
+	CU_ASSERT_DOUBLE_EQUAL(value, 3.5, DBL_EPSILON);
+
+	/* NULL propagation */
+	CU_ASSERT_EQUAL(testMapExpr_eval("[rast1] + [rast2]", 1, NAN, &value, &isnull), 1);
+	CU_ASSERT_EQUAL(isnull, 1);
+	CU_ASSERT_EQUAL(testMapExpr_eval("greatest([rast1], [rast2])", 1, NAN, &value, &isnull), 1);
+	CU_ASSERT_EQUAL(isnull, 0);
+	CU_ASSERT_DOUBLE_EQUAL(value, 1, DBL_EPSILON);
+
+	/* conditionals */
+	CU_ASSERT_EQUAL(testMapExpr_eval("CASE WHEN [rast1] > 10 THEN 1 WHEN [rast1] > 5 THEN 0.5 ELSE 0 END", 7, 0, &value, &isnull), 1);
+	CU_ASSERT_DOUBLE_EQUAL(value, 0.5, DBL_EPSILON);
+	CU_ASSERT_EQUAL(testMapExpr_eval("case when [rast1] > 10 then 1 end", 7, 0, &value, &isnull), 1);
+	CU_ASSERT_EQUAL(isnull, 1);
+	CU_ASSERT_EQUAL(testMapExpr_eval("CASE WHEN [rast2] IS NULL OR [rast1] <= 0 THEN -1 ELSE least([rast1], [rast2]) END", 2, NAN, &value, &isnull), 1);
+	CU_ASSERT_DOUBLE_EQUAL(value, -1, DBL_EPSILON);
+	CU_ASSERT_EQUAL(testMapExpr_eval("CASE WHEN NOT ([rast1] <> 2 AND [rast2] = 3) THEN sqrt([rast1.y] + 2) END", 2, 3, &value, &isnull), 1);
+	CU_ASSERT_DOUBLE_EQUAL(value, 3, DBL_EPSILON);
+
+	/* branch not taken is not evaluated */
+	CU_ASSERT_EQUAL(testMapExpr_eval("CASE WHEN [rast2] = 0 THEN 0 ELSE [rast1] / [rast2] END", 1, 0, &value, &isnull), 1);
+	CU_ASSERT_DOUBLE_EQUAL(value, 0, DBL_EPSILON);
+
+	/* conditions left to SQL */
+	CU_ASSERT_EQUAL(testMapExpr_eval("[rast1] / [rast2]", 1, 0, &value, &isnull), 0);
+	CU_ASSERT_EQUAL(testMapExpr_eval("[rast1.x] * 1000000000", 0, 0, &value, &isnull), 0);
+	CU_ASSERT_EQUAL(testMapExpr_eval("sqrt([rast1])", -1, 0, &value, &isnull), 0);
+
+	/* syntax left to SQL */
+	CU_ASSERT_EQUAL(testMapExpr_eval("[rast1]::integer", 1, 0, &value, &isnull), -1);
+	CU_ASSERT_EQUAL(testMapExpr_eval("[rast1] > 0", 1, 0, &value, &isnull), -1);
+	CU_ASSERT_EQUAL(testMapExpr_eval("[rast1] -- comment", 1, 0, &value, &isnull), -1);
+	CU_ASSERT_EQUAL(testMapExpr_eval("[rast1] + 0.5 * 2.0", 1, 0, &value, &isnull), -1);
+	CU_ASSERT_EQUAL(testMapExpr_eval("[rast1] ^ 2", 1, 0, &value, &isnull), -1);
+	CU_ASSERT_EQUAL(testMapExpr_eval("[rast3] + 1", 1, 0, &value, &isnull), -1);
+	CU_ASSERT_EQUAL(testMapExpr_eval("power([rast1], 2)", 1, 0, &value, &isnull), -1);
+	CU_ASSERT_EQUAL(testMapExpr_eval("([rast1] + 1", 1, 0, &value, &isnull), -1);
+	CU_ASSERT_EQUAL(testMapExpr_eval("[rast1.x] + 2147483648", 1, 0, &value, &isnull), -1);
+}
+
 /* register tests */
 void mapalgebra_suite_setup(void);
 void mapalgebra_suite_setup(void)
@@ -1191,5 +1270,6 @@ void mapalgebra_suite_setup(void)
 	PG_ADD_TEST(suite, test_raster_iterator);
 	PG_ADD_TEST(suite, test_band_reclass);
 	PG_ADD_TEST(suite, test_raster_colormap);
+	PG_ADD_TEST(suite, test_raster_mapexpr);
 }
 
@@ -567,6 +567,81 @@ static void test_raster_pixel_as_polygon() {
 	cu_free_raster(rast);
 }
 
+static void test_raster_polygonize() {
+	rt_raster rast;
+	rt_band band;
+	uint32_t x, y;
+	int i;
+	int nPols = 0;
+	rt_geomval gv = NULL;
+	char *wkt = NULL;
+
+	/*
+		0 0 0 0 0
+		0 1 1 1 0
+		0 1 0 1 0
+		0 1 1 1 0
+		0 0 0 0 1
+	*/
+	rast = rt_raster_new(5, 5);
+	CU_ASSERT(rast != NULL);
+	rt_raster_set_scale(rast, 1, -1);
+
+	band = cu_add_band(rast, PT_8BUI, 1, 0);
+	CU_ASSERT(band != NULL);
+
+	for (x = 1; x < 4; x++) {
+		for (y = 1; y < 4; y++) {
+			rt_band_set_pixel(band, x, y, 1, NULL);
+		}
+	}
+	rt_band_set_pixel(band, 2, 2, 0, NULL);
+	rt_band_set_pixel(band, 4, 4, 1, NULL);
+
+	/* all values */
+	gv = rt_raster_polygonize(rast, 0, FALSE, &nPols);
+	CU_ASSERT(gv != NULL);
+	CU_ASSERT_EQUAL(nPols, 4);
+
+	CU_ASSERT_DOUBLE_EQUAL(gv[0].val, 0, FLT_EPSILON);
+	CU_ASSERT_EQUAL(gv[0].geom->nrings, 2);
+	CU_ASSERT_DOUBLE_EQUAL(lwgeom_area((LWGEOM *) gv[0].geom), 15, FLT_EPSILON);
+
+	/* donut */
+	CU_ASSERT_DOUBLE_EQUAL(gv[1].val, 1, FLT_EPSILON);
+	wkt = lwgeom_to_text((const LWGEOM *) gv[1].geom);
+	CU_ASSERT_STRING_EQUAL(wkt, "POLYGON((1 -1,4 -1,4 -4,1 -4,1 -1),(2 -3,3 -3,3 -2,2 -2,2 -3))");
+	rtdealloc(wkt);
+
+	CU_ASSERT_DOUBLE_EQUAL(gv[2].val, 0, FLT_EPSILON);
+	wkt = lwgeom_to_text((const LWGEOM *) gv[2].geom);
+	CU_ASSERT_STRING_EQUAL(wkt, "POLYGON((2 -2,3 -2,3 -3,2 -3,2 -2))");
+	rtdealloc(wkt);
+
+	/* touches donut at a corner only */
+	CU_ASSERT_DOUBLE_EQUAL(gv[3].val, 1, FLT_EPSILON);
+	wkt = lwgeom_to_text((const LWGEOM *) gv[3].geom);
+	CU_ASSERT_STRING_EQUAL(wkt, "POLYGON((4 -4,5 -4,5 -5,4 -5,4 -4))");
+	rtdealloc(wkt);
+
+	for (i = 0; i < nPols; i++) lwgeom_free((LWGEOM *) gv[i].geom);
+	rtdealloc(gv);
+
+	/* exclude NODATA */
+	gv = rt_raster_polygonize(rast, 0, TRUE, &nPols);
+	CU_ASSERT(gv != NULL);
+	CU_ASSERT_EQUAL(nPols, 2);
+	CU_ASSERT_DOUBLE_EQUAL(gv[0].val, 1, FLT_EPSILON);
+	CU_ASSERT_DOUBLE_EQUAL(lwgeom_area((LWGEOM *) gv[0].geom), 8, FLT_EPSILON);
+	CU_ASSERT_DOUBLE_EQUAL(gv[1].val, 1, FLT_EPSILON);
+	CU_ASSERT_DOUBLE_EQUAL(lwgeom_area((LWGEOM *) gv[1].geom), 1, FLT_EPSILON);
+
+	for (i = 0; i < nPols; i++) lwgeom_free((LWGEOM *) gv[i].geom);
+	rtdealloc(gv);
+
+	cu_free_raster(rast);
+}
+
 /* register tests */
 void raster_geometry_suite_setup(void);
 void raster_geometry_suite_setup(void)
@@ -578,5 +653,6 @@ void raster_geometry_suite_setup(void)
 	PG_ADD_TEST(suite, test_raster_surface);
 	PG_ADD_TEST(suite, test_raster_perimeter);
 	PG_ADD_TEST(suite, test_raster_pixel_as_polygon);
+	PG_ADD_TEST(suite, test_raster_polygonize);
 }
 
@@ -204,6 +204,146 @@ static void test_raster_compute_skewed_raster() {
 	cu_free_raster(rast);
 }
 
+static void test_raster_burn_polygon() {
+	rt_raster rast;
+	rt_band band;
+	LWGEOM *geom;
+	uint32_t burned = 0;
+	double val;
+	int nodata;
+
+	rast = rt_raster_new(10, 10);
+	CU_ASSERT(rast != NULL);
+	rt_raster_set_offsets(rast, 0, 10);
+	rt_raster_set_scale(rast, 1, -1);
+
+	band = cu_add_band(rast, PT_8BUI, 1, 0);
+	CU_ASSERT(band != NULL);
+
+	/* pixel centers between 1 and 9 except those in the hole */
+	geom = lwgeom_from_wkt(
+		"POLYGON((1 1,9 1,9 9,1 9,1 1),(4 4,4 6,6 6,6 4,4 4))",
+		LW_PARSER_CHECK_NONE
+	);
+	CU_ASSERT(geom != NULL);
+
+	CU_ASSERT_EQUAL(rt_raster_burn_polygon(rast, 0, geom, 5, &burned), ES_NONE);
+	CU_ASSERT_EQUAL(burned, 60);
+
+	rt_band_get_pixel(band, 0, 0, &val, &nodata);
+	CU_ASSERT_EQUAL(nodata, 1);
+	rt_band_get_pixel(band, 1, 1, &val, &nodata);
+	CU_ASSERT_DOUBLE_EQUAL(val, 5, DBL_EPSILON);
+	rt_band_get_pixel(band, 8, 8, &val, &nodata);
+	CU_ASSERT_DOUBLE_EQUAL(val, 5, DBL_EPSILON);
+	rt_band_get_pixel(band, 9, 8, &val, &nodata);
+	CU_ASSERT_EQUAL(nodata, 1);
+	rt_band_get_pixel(band, 4, 5, &val, &nodata);
+	CU_ASSERT_EQUAL(nodata, 1);
+	rt_band_get_pixel(band, 3, 5, &val, &nodata);
+	CU_ASSERT_DOUBLE_EQUAL(val, 5, DBL_EPSILON);
+	lwgeom_free(geom);
+
+	/* partially outside raster */
+	geom = lwgeom_from_wkt(
+		"MULTIPOLYGON(((-5 -5,2 -5,2 20,-5 20,-5 -5)),((8.6 3,20 3,20 3.4,8.6 3)))",
+		LW_PARSER_CHECK_NONE
+	);
+	CU_ASSERT(geom != NULL);
+
+	CU_ASSERT_EQUAL(rt_raster_burn_polygon(rast, 0, geom, 7, &burned), ES_NONE);
+	CU_ASSERT_EQUAL(burned, 20);
+
+	rt_band_get_pixel(band, 0, 9, &val, &nodata);
+	CU_ASSERT_DOUBLE_EQUAL(val, 7, DBL_EPSILON);
+	rt_band_get_pixel(band, 1, 0, &val, &nodata);
+	CU_ASSERT_DOUBLE_EQUAL(val, 7, DBL_EPSILON);
+	rt_band_get_pixel(band, 2, 0, &val, &nodata);
+	CU_ASSERT_EQUAL(nodata, 1);
+	lwgeom_free(geom);
+
+	/* not polygonal */
+	geom = lwgeom_from_wkt("LINESTRING(0 0,10 10)", LW_PARSER_CHECK_NONE);
+	CU_ASSERT_NOT_EQUAL(rt_raster_burn_polygon(rast, 0, geom, 1, NULL), ES_NONE);
+	lwgeom_free(geom);
+
+	cu_free_raster(rast);
+}
+
+static void test_raster_burn_line() {
+	rt_raster rast;
+	rt_band band;
+	LWGEOM *geom;
+	uint32_t burned = 0;
+	double val;
+	int nodata;
+
+	rast = rt_raster_new(10, 10);
+	CU_ASSERT(rast != NULL);
+	rt_raster_set_offsets(rast, 0, 10);
+	rt_raster_set_scale(rast, 1, -1);
+
+	band = cu_add_band(rast, PT_8BUI, 1, 0);
+	CU_ASSERT(band != NULL);
+
+	/* diagonal */
+	geom = lwgeom_from_wkt("LINESTRING(0.5 9.5,9.5 0.5)", LW_PARSER_CHECK_NONE);
+	CU_ASSERT(geom != NULL);
+
+	CU_ASSERT_EQUAL(rt_raster_burn_line(rast, 0, geom, 3, &burned), ES_NONE);
+	CU_ASSERT_EQUAL(burned, 10);
+
+	rt_band_get_pixel(band, 0, 0, &val, &nodata);
+	CU_ASSERT_DOUBLE_EQUAL(val, 3, DBL_EPSILON);
+	rt_band_get_pixel(band, 9, 9, &val, &nodata);
+	CU_ASSERT_DOUBLE_EQUAL(val, 3, DBL_EPSILON);
+	rt_band_get_pixel(band, 1, 0, &val, &nodata);
+	CU_ASSERT_EQUAL(nodata, 1);
+	lwgeom_free(geom);
+
+	/* shallow, last pixel outside raster */
+	geom = lwgeom_from_wkt("LINESTRING(0.2 5.5,10.5 8.5)", LW_PARSER_CHECK_NONE);
+	CU_ASSERT(geom != NULL);
+
+	CU_ASSERT_EQUAL(rt_raster_burn_geometry(rast, 0, geom, 4, 0, &burned), ES_NONE);
+	CU_ASSERT_EQUAL(burned, 10);
+
+	rt_band_get_pixel(band, 0, 4, &val, &nodata);
+	CU_ASSERT_DOUBLE_EQUAL(val, 4, DBL_EPSILON);
+	rt_band_get_pixel(band, 2, 3, &val, &nodata);
+	CU_ASSERT_DOUBLE_EQUAL(val, 4, DBL_EPSILON);
+	rt_band_get_pixel(band, 9, 1, &val, &nodata);
+	CU_ASSERT_DOUBLE_EQUAL(val, 4, DBL_EPSILON);
+	rt_band_get_pixel(band, 2, 4, &val, &nodata);
+	CU_ASSERT_EQUAL(nodata, 1);
+	lwgeom_free(geom);
+
+	/* steep with shared vertex, second line outside raster */
+	geom = lwgeom_from_wkt(
+		"MULTILINESTRING((3.5 0.5,2.5 9.5,-3 9.5),(20 20,30 30))",
+		LW_PARSER_CHECK_NONE
+	);
+	CU_ASSERT(geom != NULL);
+
+	CU_ASSERT_EQUAL(rt_raster_burn_line(rast, 0, geom, 6, &burned), ES_NONE);
+	CU_ASSERT_EQUAL(burned, 13);
+
+	rt_band_get_pixel(band, 3, 9, &val, &nodata);
+	CU_ASSERT_DOUBLE_EQUAL(val, 6, DBL_EPSILON);
+	rt_band_get_pixel(band, 2, 4, &val, &nodata);
+	CU_ASSERT_DOUBLE_EQUAL(val, 6, DBL_EPSILON);
+	rt_band_get_pixel(band, 0, 0, &val, &nodata);
+	CU_ASSERT_DOUBLE_EQUAL(val, 6, DBL_EPSILON);
+	lwgeom_free(geom);
+
+	/* not linear */
+	geom = lwgeom_from_wkt("POLYGON((0 0,1 0,1 1,0 0))", LW_PARSER_CHECK_NONE);
+	CU_ASSERT_NOT_EQUAL(rt_raster_burn_line(rast, 0, geom, 1, NULL), ES_NONE);
+	lwgeom_free(geom);
+
+	cu_free_raster(rast);
+}
+
 /* register tests */
 void raster_misc_suite_setup(void);
 void raster_misc_suite_setup(void)
@@ -213,5 +353,7 @@ void raster_misc_suite_setup(void)
 	PG_ADD_TEST(suite, test_raster_geopoint_to_cell);
 	PG_ADD_TEST(suite, test_raster_from_two_rasters);
 	PG_ADD_TEST(suite, test_raster_compute_skewed_raster);
+	PG_ADD_TEST(suite, test_raster_burn_polygon);
+	PG_ADD_TEST(suite, test_raster_burn_line);
 }
 
@@ -808,11 +808,211 @@ static void test_raster_wkb() {
 */
 }
 
+extern char enable_raster_compression;
+
+static void test_raster_serialize_rle() {
+	rt_raster raster = NULL;
+	rt_raster rast2 = NULL;
+	rt_band band = NULL;
+	rt_band band2 = NULL;
+	void *serialized = NULL;
+	uint32_t plainsize = 0;
+	uint32_t rlesize = 0;
+	uint16_t width = 97;
+	uint16_t height = 61;
+	int x = 0;
+	int y = 0;
+	int i = 0;
+	double val = 0;
+	double val2 = 0;
+	int nodata = 0;
+	int nodata2 = 0;
+
+	raster = rt_raster_new(width, height);
+	CU_ASSERT(raster != NULL);
+
+	/* mostly NODATA with a few scattered values */
+	band = cu_add_band(raster, PT_8BUI, 1, 0);
+	CU_ASSERT(band != NULL);
+	for (x = 10; x < 40; x++)
+		rt_band_set_pixel(band, x, 20, x % 3 + 1, NULL);
+
+	/* distinct values only, stays plain */
+	band = cu_add_band(raster, PT_16BSI, 0, 0);
+	CU_ASSERT(band != NULL);
+	for (y = 0; y < height; y++) {
+		for (x = 0; x < width; x++)
+			rt_band_set_pixel(band, x, y, y * width + x - 3000, NULL);
+	}
+
+	/* runs of various lengths */
+	band = cu_add_band(raster, PT_64BF, 1, -1);
+	CU_ASSERT(band != NULL);
+	for (y = 0; y < height; y++) {
+		for (x = 0; x < width; x++)
+			rt_band_set_pixel(band, x, y, (x / (y % 7 + 1)) * 0.5, NULL);
+	}
+
+	enable_raster_compression = 0;
+	serialized = rt_raster_serialize(raster);
+	CU_ASSERT(serialized != NULL);
+	plainsize = ((struct rt_raster_serialized_t *) serialized)->size;
+	CU_ASSERT_EQUAL(((struct rt_raster_serialized_t *) serialized)->version, 0);
+	free(serialized);
+
+	enable_raster_compression = 1;
+	serialized = rt_raster_serialize(raster);
+	CU_ASSERT(serialized != NULL);
+	rlesize = ((struct rt_raster_serialized_t *) serialized)->size;
+	CU_ASSERT(rlesize < plainsize);
+	CU_ASSERT_EQUAL(((struct rt_raster_serialized_t *) serialized)->version, 1);
+
+	rast2 = rt_raster_deserialize(serialized, FALSE);
+	CU_ASSERT(rast2 != NULL);
+	CU_ASSERT_EQUAL(rt_raster_get_num_bands(rast2), 3);
+
+	for (i = 0; i < 3; i++) {
+		band = rt_raster_get_band(raster, i);
+		band2 = rt_raster_get_band(rast2, i);
+		CU_ASSERT(band2 != NULL);
+		CU_ASSERT_EQUAL(rt_band_get_pixtype(band2), rt_band_get_pixtype(band));
+		CU_ASSERT_EQUAL(rt_band_get_hasnodata_flag(band2), rt_band_get_hasnodata_flag(band));
+
+		for (y = 0; y < height; y++) {
+			for (x = 0; x < width; x++) {
+				CU_ASSERT_EQUAL(rt_band_get_pixel(band, x, y, &val, &nodata), ES_NONE);
+				CU_ASSERT_EQUAL(rt_band_get_pixel(band2, x, y, &val2, &nodata2), ES_NONE);
+				CU_ASSERT_DOUBLE_EQUAL(val2, val, DBL_EPSILON);
+				CU_ASSERT_EQUAL(nodata2, nodata);
+			}
+		}
+	}
+	cu_free_raster(rast2);
+
+	/* encoded bands are rejected in version 0, unknown versions too */
+	((struct rt_raster_serialized_t *) serialized)->version = 0;
+	cu_error_msg_reset();
+	rast2 = rt_raster_deserialize(serialized, FALSE);
+	CU_ASSERT(rast2 == NULL);
+	CU_ASSERT(strlen(cu_error_msg) > 0);
+
+	((struct rt_raster_serialized_t *) serialized)->version = 2;
+	cu_error_msg_reset();
+	rast2 = rt_raster_deserialize(serialized, TRUE);
+	CU_ASSERT(rast2 == NULL);
+	CU_ASSERT(strlen(cu_error_msg) > 0);
+
+	free(serialized);
+	cu_free_raster(raster);
+
+	/* too small to be worth encoding */
+	raster = rt_raster_new(1, 1);
+	CU_ASSERT(raster != NULL);
+	band = cu_add_band(raster, PT_8BUI, 0, 0);
+	CU_ASSERT(band != NULL);
+	rt_band_set_pixel(band, 0, 0, 7, NULL);
+
+	serialized = rt_raster_serialize(raster);
+	CU_ASSERT(serialized != NULL);
+	CU_ASSERT_EQUAL(((struct rt_raster_serialized_t *) serialized)->version, 0);
+	rast2 = rt_raster_deserialize(serialized, FALSE);
+	CU_ASSERT(rast2 != NULL);
+	CU_ASSERT_EQUAL(rt_band_get_pixel(rt_raster_get_band(rast2, 0), 0, 0, &val, NULL), ES_NONE);
+	CU_ASSERT_DOUBLE_EQUAL(val, 7, DBL_EPSILON);
+
+	cu_free_raster(rast2);
+	free(serialized);
+	cu_free_raster(raster);
+
+	enable_raster_compression = 0;
+}
+
+static void test_raster_deserialize_free() {
+	rt_raster raster = NULL;
+	rt_raster rast2 = NULL;
+	rt_band band = NULL;
+	void *serialized = NULL;
+	uint32_t size = 0;
+	uint8_t bandnum = 0;
+	double val = 0;
+	int x = 0;
+
+	raster = rt_raster_new(20, 5);
+	CU_ASSERT(raster != NULL);
+
+	/* long runs, stored run-length encoded */
+	band = cu_add_band(raster, PT_16BSI, 1, -1);
+	CU_ASSERT(band != NULL);
+	for (x = 0; x < 20; x++)
+		rt_band_set_pixel(band, x, 2, 7, NULL);
+
+	band = rt_band_new_offline(20, 5, PT_16BUI, 1, 3, 2, "/tmp/free.tif");
+	CU_ASSERT(band != NULL);
+	CU_ASSERT_EQUAL(rt_raster_add_band(raster, band, 1), 1);
+
+	band = cu_add_band(raster, PT_32BF, 1, 1.5);
+	CU_ASSERT(band != NULL);
+
+	enable_raster_compression = 1;
+	serialized = rt_raster_serialize(raster);
+	enable_raster_compression = 0;
+	CU_ASSERT(serialized != NULL);
+	size = ((struct rt_raster_serialized_t *) serialized)->size;
+
+	rast2 = rt_raster_deserialize(serialized, FALSE);
+	CU_ASSERT(rast2 != NULL);
+	CU_ASSERT_EQUAL(rt_raster_get_num_bands(rast2), 3);
+
+	/* encoded data is only decoded on first access */
+	band = rt_raster_get_band(rast2, 0);
+	CU_ASSERT(band != NULL);
+	CU_ASSERT(band->rle != NULL);
+	CU_ASSERT(band->data.mem == NULL);
+	CU_ASSERT_EQUAL(rt_band_get_pixel(band, 4, 2, &val, NULL), ES_NONE);
+	CU_ASSERT_DOUBLE_EQUAL(val, 7, DBL_EPSILON);
+	CU_ASSERT(band->rle == NULL);
+
+	/* as PG_FREE_IF_COPY of the serialized raster would */
+	memset(serialized, 0xFF, size);
+	free(serialized);
+
+	/* band headers and decoded data do not point into the serialized form */
+	band = rt_raster_get_band(rast2, 0);
+	CU_ASSERT_EQUAL(rt_band_get_pixtype(band), PT_16BSI);
+	CU_ASSERT(rt_band_get_hasnodata_flag(band));
+	CU_ASSERT_EQUAL(rt_band_get_nodata(band, &val), ES_NONE);
+	CU_ASSERT_DOUBLE_EQUAL(val, -1, DBL_EPSILON);
+	CU_ASSERT_EQUAL(rt_band_get_pixel(band, 19, 2, &val, NULL), ES_NONE);
+	CU_ASSERT_DOUBLE_EQUAL(val, 7, DBL_EPSILON);
+	CU_ASSERT_EQUAL(rt_band_get_pixel(band, 19, 3, &val, NULL), ES_NONE);
+	CU_ASSERT_DOUBLE_EQUAL(val, -1, DBL_EPSILON);
+
+	band = rt_raster_get_band(rast2, 1);
+	CU_ASSERT(band != NULL);
+	CU_ASSERT(rt_band_is_offline(band));
+	CU_ASSERT_STRING_EQUAL(rt_band_get_ext_path(band), "/tmp/free.tif");
+	CU_ASSERT_EQUAL(rt_band_get_ext_band_num(band, &bandnum), ES_NONE);
+	CU_ASSERT_EQUAL(bandnum, 2);
+	CU_ASSERT_EQUAL(rt_band_get_nodata(band, &val), ES_NONE);
+	CU_ASSERT_DOUBLE_EQUAL(val, 3, DBL_EPSILON);
+
+	band = rt_raster_get_band(rast2, 2);
+	CU_ASSERT(band != NULL);
+	CU_ASSERT_EQUAL(rt_band_get_pixtype(band), PT_32BF);
+	CU_ASSERT_EQUAL(rt_band_get_nodata(band, &val), ES_NONE);
+	CU_ASSERT_DOUBLE_EQUAL(val, 1.5, DBL_EPSILON);
+
+	cu_free_raster(rast2);
+	cu_free_raster(raster);
+}
+
 /* register tests */
 void raster_wkb_suite_setup(void);
 void raster_wkb_suite_setup(void)
 {
 	CU_pSuite suite = CU_add_suite("raster_wkb", NULL, NULL);
 	PG_ADD_TEST(suite, test_raster_wkb);
+	PG_ADD_TEST(suite, test_raster_serialize_rle);
+	PG_ADD_TEST(suite, test_raster_deserialize_free);
 }
 
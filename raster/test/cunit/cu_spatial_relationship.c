@@ -4723,6 +4723,45 @@ static void test_raster_intersects() {
 
 	cu_free_raster(rast2);
 	cu_free_raster(rast1);
+
+	/* sparse rasters, one pixel with value each */
+	rast1 = rt_raster_new(100, 100);
+	CU_ASSERT(rast1 != NULL);
+	rt_raster_set_scale(rast1, 1, -1);
+
+	band1 = cu_add_band(rast1, PT_8BUI, 1, 0);
+	CU_ASSERT(band1 != NULL);
+	rtn = rt_band_set_pixel(band1, 10, 10, 1, NULL);
+
+	rast2 = rt_raster_new(100, 100);
+	CU_ASSERT(rast2 != NULL);
+	rt_raster_set_scale(rast2, 1, -1);
+	rt_raster_set_offsets(rast2, 50.5, -50.5);
+
+	band2 = cu_add_band(rast2, PT_8BUI, 1, 0);
+	CU_ASSERT(band2 != NULL);
+	rtn = rt_band_set_pixel(band2, 40, 40, 1, NULL);
+
+	rtn = rt_raster_intersects(
+		rast1, 0,
+		rast2, 0,
+		&result
+	);
+	CU_ASSERT_EQUAL(rtn, ES_NONE);
+	CU_ASSERT_EQUAL(result, 0);
+
+	/* pixel of rast2 overlaps pixel of rast1 */
+	rt_raster_set_offsets(rast2, -29.5, 29.5);
+
+	rtn = rt_raster_intersects(
+		rast1, 0,
+		rast2, 0,
+		&result
+	);
+	CU_ASSERT_EQUAL(rtn, ES_NONE);
+	CU_ASSERT_EQUAL(result, 1);
+	cu_free_raster(rast2);
+	cu_free_raster(rast1);
 }
 
 static void test_raster_same_alignment() {
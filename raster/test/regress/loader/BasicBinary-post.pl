@@ -0,0 +1,2 @@
+unlink "loader/BasicBinary.tif";
+unlink "loader/BasicBinary.bin";
@@ -0,0 +1 @@
+unlink "loader/Overview.tif";
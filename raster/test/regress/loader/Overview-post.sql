@@ -0,0 +1,2 @@
+DROP TABLE o_2_loadedrast;
+DROP TABLE o_4_loadedrast;
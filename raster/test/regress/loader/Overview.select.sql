@@ -0,0 +1,2 @@
+SELECT ST_Width(rast), ST_Height(rast), ST_ScaleX(rast), ST_ScaleY(rast), ST_Value(rast, 1, 1, 21) FROM o_2_loadedrast;
+SELECT ST_Width(rast), ST_Height(rast), ST_ScaleX(rast), ST_ScaleY(rast), ST_Value(rast, 1, 8, 3), ST_Value(rast, 2, 22, 1) FROM o_4_loadedrast;
@@ -0,0 +1 @@
+unlink "loader/OverviewAverage.tif";
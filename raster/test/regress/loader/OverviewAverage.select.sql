@@ -0,0 +1,27 @@
+-- each overview pixel is the average of the raster pixels it covers
+WITH base AS (
+	SELECT band, round(ST_UpperLeftX(rast))::int + (p).x - 1 AS c, round(-ST_UpperLeftY(rast))::int + (p).y - 1 AS r, (p).val
+	FROM (SELECT rast, band, ST_PixelAsPoints(rast, band, FALSE) AS p FROM loadedrast, generate_series(1, 3) band) foo
+), overview AS (
+	SELECT factor, band, round(ST_UpperLeftX(rast) / ST_ScaleX(rast))::int + (p).x - 1 AS c, round(ST_UpperLeftY(rast) / ST_ScaleY(rast))::int + (p).y - 1 AS r, (p).val
+	FROM (
+		SELECT factor, rast, band, ST_PixelAsPoints(rast, band, FALSE) AS p
+		FROM (
+			SELECT 2 AS factor, rast FROM o_2_loadedrast UNION ALL
+			SELECT 3, rast FROM o_3_loadedrast UNION ALL
+			SELECT 6, rast FROM o_6_loadedrast
+		) o, generate_series(1, 3) band
+	) foo
+), averaged AS (
+	SELECT o.factor, o.val, avg(b.val) AS avg
+	FROM overview o
+	LEFT JOIN base b
+		ON b.band = o.band
+		AND b.c / o.factor = o.c
+		AND b.r / o.factor = o.r
+	GROUP BY o.factor, o.band, o.c, o.r, o.val
+)
+SELECT factor, count(*), sum((avg IS NULL OR abs(val - avg) >= 1)::int)
+FROM averaged
+GROUP BY factor
+ORDER BY factor;
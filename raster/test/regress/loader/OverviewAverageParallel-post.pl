@@ -0,0 +1 @@
+unlink "loader/OverviewAverageParallel.tif";
@@ -0,0 +1,3 @@
+DROP TABLE o_2_loadedrast;
+DROP TABLE o_3_loadedrast;
+DROP TABLE o_6_loadedrast;
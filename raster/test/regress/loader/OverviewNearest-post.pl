@@ -0,0 +1 @@
+unlink "loader/OverviewNearest.tif";
@@ -0,0 +1,4 @@
+DROP TABLE o_2_loadedrast;
+DROP TABLE o_3_loadedrast;
+DROP TABLE o_4_loadedrast;
+DROP TABLE o_6_loadedrast;
@@ -0,0 +1 @@
+link "loader/testraster.tif", "loader/OverviewNearest.tif";
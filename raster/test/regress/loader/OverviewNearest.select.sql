@@ -0,0 +1,24 @@
+-- each overview pixel is the raster pixel at the center of the pixels it covers
+WITH base AS (
+	SELECT band, round(ST_UpperLeftX(rast))::int + (p).x - 1 AS c, round(-ST_UpperLeftY(rast))::int + (p).y - 1 AS r, (p).val
+	FROM (SELECT rast, band, ST_PixelAsPoints(rast, band, FALSE) AS p FROM loadedrast, generate_series(1, 3) band) foo
+), overview AS (
+	SELECT factor, band, round(ST_UpperLeftX(rast) / ST_ScaleX(rast))::int + (p).x - 1 AS c, round(ST_UpperLeftY(rast) / ST_ScaleY(rast))::int + (p).y - 1 AS r, (p).val
+	FROM (
+		SELECT factor, rast, band, ST_PixelAsPoints(rast, band, FALSE) AS p
+		FROM (
+			SELECT 2 AS factor, rast FROM o_2_loadedrast UNION ALL
+			SELECT 3, rast FROM o_3_loadedrast UNION ALL
+			SELECT 4, rast FROM o_4_loadedrast UNION ALL
+			SELECT 6, rast FROM o_6_loadedrast
+		) o, generate_series(1, 3) band
+	) foo
+)
+SELECT o.factor, count(*), sum((o.val IS DISTINCT FROM b.val)::int)
+FROM overview o
+LEFT JOIN base b
+	ON b.band = o.band
+	AND b.c = least(o.c * o.factor + o.factor / 2, 89)
+	AND b.r = least(o.r * o.factor + o.factor / 2, 49)
+GROUP BY o.factor
+ORDER BY o.factor;
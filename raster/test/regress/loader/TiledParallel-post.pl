@@ -0,0 +1,3 @@
+unlink "loader/TiledParallel-1.tif";
+unlink "loader/TiledParallel-2.tif";
+unlink "loader/TiledParallel.tif";
@@ -0,0 +1,3 @@
+link "loader/testraster.tif", "loader/TiledParallel-1.tif";
+link "loader/testraster.tif", "loader/TiledParallel-2.tif";
+link "loader/testraster.tif", "loader/TiledParallel.tif";
@@ -0,0 +1,4 @@
+unlink "loader/TiledParallelBinary-1.tif";
+unlink "loader/TiledParallelBinary-2.tif";
+unlink "loader/TiledParallelBinary.tif";
+unlink "loader/TiledParallelBinary.bin";
@@ -0,0 +1,3 @@
+link "loader/testraster.tif", "loader/TiledParallelBinary-1.tif";
+link "loader/testraster.tif", "loader/TiledParallelBinary-2.tif";
+link "loader/testraster.tif", "loader/TiledParallelBinary.tif";
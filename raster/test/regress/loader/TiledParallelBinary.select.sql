@@ -0,0 +1,10 @@
+SELECT srid, scale_x::numeric(16, 10), scale_y::numeric(16, 10), blocksize_x, blocksize_y, same_alignment, regular_blocking, num_bands, pixel_types, nodata_values::numeric(16,10)[], out_db, ST_AsEWKT(extent) FROM raster_columns WHERE r_table_name = 'loadedrast' AND r_raster_column = 'rast';
+-- rows of each file are in the order of the files
+SELECT filename, count(*), min(rid), max(rid) FROM loadedrast GROUP BY filename ORDER BY min(rid);
+-- tiles of each file are in row-major order
+SELECT count(*) FROM loadedrast WHERE ST_UpperLeftX(rast) <> (rid - 1) % 45 % 9 * 10 OR ST_UpperLeftY(rast) <> -((rid - 1) % 45 / 9 * 10);
+-- tiles of the files converted by workers match those of the first file, converted serially
+SELECT count(*) FROM loadedrast a JOIN loadedrast b ON a.rid = (b.rid - 1) % 45 + 1 WHERE a.rid <= 45 AND b.rid > 45 AND a.rast::bytea = b.rast::bytea;
+SELECT ST_AsEWKT(geom), val FROM (SELECT (ST_PixelAsPolygons(rast, 1)).* FROM loadedrast WHERE rid = 91) foo WHERE x = 1 AND y = 1;
+SELECT ST_AsEWKT(geom), val FROM (SELECT (ST_PixelAsPolygons(rast, 2)).* FROM loadedrast WHERE rid = 68) foo WHERE x = 1 AND y = 1;
+SELECT ST_AsEWKT(geom), val FROM (SELECT (ST_PixelAsPolygons(rast, 3)).* FROM loadedrast WHERE rid = 135) foo WHERE x = 1 AND y = 1;
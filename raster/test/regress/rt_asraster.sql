@@ -40,6 +40,36 @@ CREATE OR REPLACE FUNCTION make_test_raster()
 SELECT make_test_raster();
 DROP FUNCTION make_test_raster();
 
+-- geometries burned into one raster, later geometries over earlier ones
+WITH geoms(id, geom, val) AS (VALUES
+	(1, ST_GeomFromText('POLYGON((1 1,9 1,9 9,1 9,1 1),(4 4,4 6,6 6,6 4,4 4))'), 5),
+	(2, ST_GeomFromText('LINESTRING(0.5 9.5,9.5 0.5)'), 3),
+	(3, ST_GeomFromText('POINT(0.5 0.5)'), 7),
+	(4, NULL::geometry, 9)
+), agg AS (
+	SELECT ST_AsRasterAgg(geom, val, ST_MakeEmptyRaster(10, 10, 0, 10, 1, -1, 0, 0, 0) ORDER BY id) AS rast
+	FROM geoms
+)
+SELECT
+	ST_Width(rast), ST_Height(rast), ST_BandPixelType(rast), ST_BandNoDataValue(rast),
+	(SELECT array_agg(value || ':' || count ORDER BY value) FROM ST_ValueCount(rast)),
+	ST_Value(rast, 1, 10), ST_Value(rast, 5, 5), ST_Value(rast, 3, 4)
+FROM agg;
+
+-- touched pixels of a line are those of ST_AsRaster
+WITH geoms(geom) AS (VALUES
+	(ST_GeomFromText('LINESTRING(1.2 8.7,8.1 2.6,3.3 1.4)'))
+)
+SELECT count > 0, count = (SELECT ST_Count(ST_AsRaster(geom, ST_MakeEmptyRaster(10, 10, 0, 10, 1, -1, 0, 0, 0), '8BUI', 1, 0, TRUE)) FROM geoms)
+FROM (
+	SELECT ST_Count(ST_AsRasterAgg(geom, 1, ST_MakeEmptyRaster(10, 10, 0, 10, 1, -1, 0, 0, 0), '8BUI', 0, TRUE)) AS count
+	FROM geoms
+) foo;
+
+-- no reference raster, different SRIDs
+SELECT ST_AsRasterAgg(geom, 1, NULL::raster) IS NULL FROM (SELECT ST_GeomFromText('POINT(1 1)') AS geom) foo;
+SELECT ST_AsRasterAgg(ST_GeomFromText('POINT(1 1)', 4326), 1, ST_MakeEmptyRaster(10, 10, 0, 10, 1, -1, 0, 0, 0));
+
 DELETE FROM "spatial_ref_sys" WHERE srid = 992163;
 DELETE FROM "spatial_ref_sys" WHERE srid = 993309;
 DELETE FROM "spatial_ref_sys" WHERE srid = 993310;
@@ -496,6 +526,50 @@ FROM (
 	ORDER BY d.rid
 ) foo;
 
+-- polygons are burned without GDAL unless touched, band flags are the same
+SELECT
+	ST_BandIsNoData(ST_AsRaster(
+		geom, 100., -100., NULL::double precision, NULL::double precision,
+		ARRAY['8BUI'], ARRAY[1]::double precision[], ARRAY[0]::double precision[],
+		0, 0, FALSE
+	)),
+	ST_BandIsNoData(ST_AsRaster(
+		geom, 100., -100., NULL::double precision, NULL::double precision,
+		ARRAY['8BUI'], ARRAY[1]::double precision[], ARRAY[0]::double precision[],
+		0, 0, TRUE
+	))
+FROM (SELECT ST_GeomFromText('POLYGON((0 0,10 0,0 10,0 0))') AS geom) foo;
+
+-- geometries burned into one raster, later geometries over earlier ones
+WITH geoms(id, geom, val) AS (VALUES
+	(1, ST_GeomFromText('POLYGON((1 1,9 1,9 9,1 9,1 1),(4 4,4 6,6 6,6 4,4 4))'), 5),
+	(2, ST_GeomFromText('LINESTRING(0.5 9.5,9.5 0.5)'), 3),
+	(3, ST_GeomFromText('POINT(0.5 0.5)'), 7),
+	(4, NULL::geometry, 9)
+), agg AS (
+	SELECT ST_AsRasterAgg(geom, val, ST_MakeEmptyRaster(10, 10, 0, 10, 1, -1, 0, 0, 0) ORDER BY id) AS rast
+	FROM geoms
+)
+SELECT
+	ST_Width(rast), ST_Height(rast), ST_BandPixelType(rast), ST_BandNoDataValue(rast),
+	(SELECT array_agg(value || ':' || count ORDER BY value) FROM ST_ValueCount(rast)),
+	ST_Value(rast, 1, 10), ST_Value(rast, 5, 5), ST_Value(rast, 3, 4)
+FROM agg;
+
+-- touched pixels of a line are those of ST_AsRaster
+WITH geoms(geom) AS (VALUES
+	(ST_GeomFromText('LINESTRING(1.2 8.7,8.1 2.6,3.3 1.4)'))
+)
+SELECT count > 0, count = (SELECT ST_Count(ST_AsRaster(geom, ST_MakeEmptyRaster(10, 10, 0, 10, 1, -1, 0, 0, 0), '8BUI', 1, 0, TRUE)) FROM geoms)
+FROM (
+	SELECT ST_Count(ST_AsRasterAgg(geom, 1, ST_MakeEmptyRaster(10, 10, 0, 10, 1, -1, 0, 0, 0), '8BUI', 0, TRUE)) AS count
+	FROM geoms
+) foo;
+
+-- no reference raster, different SRIDs
+SELECT ST_AsRasterAgg(geom, 1, NULL::raster) IS NULL FROM (SELECT ST_GeomFromText('POINT(1 1)') AS geom) foo;
+SELECT ST_AsRasterAgg(ST_GeomFromText('POINT(1 1)', 4326), 1, ST_MakeEmptyRaster(10, 10, 0, 10, 1, -1, 0, 0, 0));
+
 DELETE FROM "spatial_ref_sys" WHERE srid = 992163;
 DELETE FROM "spatial_ref_sys" WHERE srid = 993309;
 DELETE FROM "spatial_ref_sys" WHERE srid = 993310;
@@ -175,6 +175,35 @@ WHERE
     encode(st_asbinary(rast), 'base64') != encode(rast::bytea, 'base64')
     ;
 
+-----------------------------------------------------------------------
+--- Test binary send and receive
+-----------------------------------------------------------------------
+
+SELECT
+	id,
+    name
+FROM rt_bytea_test
+WHERE
+    encode(raster_send(rast), 'base64') != encode(rast::bytea, 'base64')
+    ;
+
+CREATE TABLE rt_bytea_binary AS
+SELECT id, rast FROM rt_bytea_test
+UNION ALL
+SELECT 4, ST_AddBand(ST_SetValue(ST_AddBand(ST_MakeEmptyRaster(3, 2, 0, 0, 1, -1, 0, 0, 4326), 1, '16BSI', -7, -9999), 1, 2, 1, 42), '32BF', 1.5);
+
+COPY rt_bytea_binary TO :tmpfile WITH BINARY;
+CREATE TABLE rt_bytea_binary_in AS SELECT * FROM rt_bytea_binary LIMIT 0;
+COPY rt_bytea_binary_in FROM :tmpfile WITH BINARY;
+SELECT
+	count(*)
+FROM rt_bytea_binary_in i, rt_bytea_binary o
+WHERE i.id = o.id
+	AND encode(i.rast::bytea, 'base64') = encode(o.rast::bytea, 'base64');
+
+DROP TABLE rt_bytea_binary_in;
+DROP TABLE rt_bytea_binary;
+
 -- Cleanup
 DROP TABLE rt_bytea_test;
 
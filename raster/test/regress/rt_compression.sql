@@ -0,0 +1,58 @@
+SET postgis.enable_raster_compression TO on;
+
+CREATE TEMP TABLE raster_compression AS
+	SELECT
+		1 AS rid,
+		ST_SetValues(
+			ST_AddBand(
+				ST_AddBand(ST_MakeEmptyRaster(100, 100, 0, 0, 1, -1, 0, 0, 0), 1, '16BSI', -1, -1),
+				2, '32BF', 0.5, NULL
+			),
+			1, 10, 10, 20, 5, 7
+		) AS rast;
+
+-- bands are stored run-length encoded
+SELECT rid, pg_column_size(rast) < 1000 FROM raster_compression;
+
+SET postgis.enable_raster_compression TO off;
+
+-- encoded bands are read with compression off, written plain
+SELECT rid, pg_column_size(ST_SetSRID(rast, 0)) > 60000 FROM raster_compression;
+INSERT INTO raster_compression
+	SELECT 2, ST_SetSRID(rast, 0) FROM raster_compression WHERE rid = 1;
+
+SELECT
+	rid,
+	ST_Value(rast, 1, 15, 12),
+	ST_Value(rast, 1, 1, 1),
+	ST_Value(rast, 2, 50, 50)
+FROM raster_compression
+ORDER BY rid;
+
+SELECT
+	rid,
+	(ST_SummaryStats(rast, 1)).count,
+	(ST_SummaryStats(rast, 1)).sum
+FROM raster_compression
+ORDER BY rid;
+
+SELECT
+	ST_DumpValues(a.rast, 1) = ST_DumpValues(b.rast, 1),
+	ST_DumpValues(a.rast, 2) = ST_DumpValues(b.rast, 2),
+	ST_AsBinary(a.rast) = ST_AsBinary(b.rast)
+FROM raster_compression a, raster_compression b
+WHERE a.rid = 1 AND b.rid = 2;
+
+SELECT
+	ST_Value(ST_SetValue(rast, 1, 1, 1, 3), 1, 1, 1),
+	ST_Value(ST_SetValue(rast, 1, 1, 1, 3), 1, 15, 12)
+FROM raster_compression
+WHERE rid = 1;
+
+SET postgis.enable_raster_compression TO on;
+
+-- plain bands are encoded again
+SELECT rid, pg_column_size(ST_SetSRID(rast, 0)) < 1000 FROM raster_compression ORDER BY rid;
+
+DROP TABLE raster_compression;
+RESET postgis.enable_raster_compression;
@@ -0,0 +1,78 @@
+SET client_min_messages TO warning;
+
+DROP TABLE IF EXISTS raster_dumpaspolygons;
+CREATE TABLE raster_dumpaspolygons (
+	rid integer,
+	rast raster
+);
+
+-- NODATA pixel making a hole
+INSERT INTO raster_dumpaspolygons VALUES (1, ST_SetValues(
+	ST_AddBand(ST_MakeEmptyRaster(5, 5, 0, 0, 1, -1, 0, 0, 0), 1, '8BUI', 1, 0),
+	1, 1, 1, ARRAY[
+		[1, 1, 1, 1, 1],
+		[1, 1, 1, 1, 1],
+		[1, 1, 0, 1, 1],
+		[1, 1, 1, 1, 1],
+		[1, 1, 1, 1, 2]
+	]::double precision[][]
+));
+
+-- pixels of same value touching at a corner only
+INSERT INTO raster_dumpaspolygons VALUES (2, ST_SetValues(
+	ST_AddBand(ST_MakeEmptyRaster(3, 3, 0, 0, 1, -1, 0, 0, 0), 1, '8BUI', 1, 0),
+	1, 1, 1, ARRAY[
+		[1, 2, 2],
+		[2, 1, 2],
+		[2, 2, 1]
+	]::double precision[][]
+));
+
+-- 64BF values, 0 and -0 are the same value
+INSERT INTO raster_dumpaspolygons VALUES (3, ST_SetValues(
+	ST_AddBand(ST_MakeEmptyRaster(4, 3, 0, 0, 1, -1, 0, 0, 0), 1, '64BF', 0, NULL),
+	1, 1, 1, ARRAY[
+		[0, '-0'::double precision, 1.5, 1.5],
+		[2.25, 0, 1.5, -0.5],
+		[2.25, 2.25, -0.5, -0.5]
+	]::double precision[][]
+));
+
+SELECT rid, (gv).val, ST_AsText((gv).geom)
+FROM (
+	SELECT rid, ST_DumpAsPolygons(rast) AS gv
+	FROM raster_dumpaspolygons
+	WHERE rid = 1
+) foo;
+
+SELECT rid, (gv).val, ST_AsText((gv).geom)
+FROM (
+	SELECT rid, ST_DumpAsPolygons(rast, 1, FALSE) AS gv
+	FROM raster_dumpaspolygons
+	WHERE rid = 1
+) foo;
+
+SELECT rid, (gv).val, ST_AsText((gv).geom)
+FROM (
+	SELECT rid, ST_DumpAsPolygons(rast) AS gv
+	FROM raster_dumpaspolygons
+	WHERE rid = 2
+) foo;
+
+SELECT rid, (gv).val, ST_AsText((gv).geom)
+FROM (
+	SELECT rid, ST_DumpAsPolygons(rast) AS gv
+	FROM raster_dumpaspolygons
+	WHERE rid = 3
+) foo;
+
+-- the polygons of a band cover it
+SELECT rid, sum(ST_Area((gv).geom)), count(*)
+FROM (
+	SELECT rid, ST_DumpAsPolygons(rast, 1, FALSE) AS gv
+	FROM raster_dumpaspolygons
+) foo
+GROUP BY rid
+ORDER BY rid;
+
+DROP TABLE IF EXISTS raster_dumpaspolygons;
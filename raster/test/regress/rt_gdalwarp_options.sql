@@ -0,0 +1,163 @@
+DELETE FROM "spatial_ref_sys" WHERE srid = 992163;
+DELETE FROM "spatial_ref_sys" WHERE srid = 993309;
+DELETE FROM "spatial_ref_sys" WHERE srid = 993310;
+DELETE FROM "spatial_ref_sys" WHERE srid = 994269;
+DELETE FROM "spatial_ref_sys" WHERE srid = 974269;
+
+INSERT INTO "spatial_ref_sys" ("srid","auth_name","auth_srid","srtext","proj4text") VALUES (992163,'EPSG',2163,'PROJCS["unnamed",GEOGCS["unnamed ellipse",DATUM["unknown",SPHEROID["unnamed",6370997,0]],PRIMEM["Greenwich",0],UNIT["degree",0.0174532925199433]],PROJECTION["Lambert_Azimuthal_Equal_Area"],PARAMETER["latitude_of_center",45],PARAMETER["longitude_of_center",-100],PARAMETER["false_easting",0],PARAMETER["false_northing",0],UNIT["Meter",1],AUTHORITY["EPSG","2163"]]','+proj=laea +lat_0=45 +lon_0=-100 +x_0=0 +y_0=0 +a=6370997 +b=6370997 +units=m +no_defs ');
+INSERT INTO "spatial_ref_sys" ("srid","auth_name","auth_srid","srtext","proj4text") VALUES (993309,'EPSG',3309,'PROJCS["NAD27 / California Albers",GEOGCS["NAD27",DATUM["North_American_Datum_1927",SPHEROID["Clarke 1866",6378206.4,294.9786982139006,AUTHORITY["EPSG","7008"]],AUTHORITY["EPSG","6267"]],PRIMEM["Greenwich",0,AUTHORITY["EPSG","8901"]],UNIT["degree",0.01745329251994328,AUTHORITY["EPSG","9122"]],AUTHORITY["EPSG","4267"]],UNIT["metre",1,AUTHORITY["EPSG","9001"]],PROJECTION["Albers_Conic_Equal_Area"],PARAMETER["standard_parallel_1",34],PARAMETER["standard_parallel_2",40.5],PARAMETER["latitude_of_center",0],PARAMETER["longitude_of_center",-120],PARAMETER["false_easting",0],PARAMETER["false_northing",-4000000],AUTHORITY["EPSG","3309"],AXIS["X",EAST],AXIS["Y",NORTH]]','+proj=aea +lat_1=34 +lat_2=40.5 +lat_0=0 +lon_0=-120 +x_0=0 +y_0=-4000000 +ellps=clrk66 +datum=NAD27 +units=m +no_defs ');
+INSERT INTO "spatial_ref_sys" ("srid","auth_name","auth_srid","srtext","proj4text") VALUES (993310,'EPSG',3310,'PROJCS["NAD83 / California Albers",GEOGCS["NAD83",DATUM["North_American_Datum_1983",SPHEROID["GRS 1980",6378137,298.257222101,AUTHORITY["EPSG","7019"]],AUTHORITY["EPSG","6269"]],PRIMEM["Greenwich",0,AUTHORITY["EPSG","8901"]],UNIT["degree",0.01745329251994328,AUTHORITY["EPSG","9122"]],AUTHORITY["EPSG","4269"]],UNIT["metre",1,AUTHORITY["EPSG","9001"]],PROJECTION["Albers_Conic_Equal_Area"],PARAMETER["standard_parallel_1",34],PARAMETER["standard_parallel_2",40.5],PARAMETER["latitude_of_center",0],PARAMETER["longitude_of_center",-120],PARAMETER["false_easting",0],PARAMETER["false_northing",-4000000],AUTHORITY["EPSG","3310"],AXIS["X",EAST],AXIS["Y",NORTH]]','+proj=aea +lat_1=34 +lat_2=40.5 +lat_0=0 +lon_0=-120 +x_0=0 +y_0=-4000000 +ellps=GRS80 +datum=NAD83 +units=m +no_defs ');
+INSERT INTO "spatial_ref_sys" ("srid","auth_name","auth_srid","srtext","proj4text") VALUES (994269,'EPSG',4269,'GEOGCS["NAD83",DATUM["North_American_Datum_1983",SPHEROID["GRS 1980",6378137,298.257222101,AUTHORITY["EPSG","7019"]],AUTHORITY["EPSG","6269"]],PRIMEM["Greenwich",0,AUTHORITY["EPSG","8901"]],UNIT["degree",0.01745329251994328,AUTHORITY["EPSG","9122"]],AUTHORITY["EPSG","4269"]]','+proj=longlat +ellps=GRS80 +datum=NAD83 +no_defs ');
+INSERT INTO "spatial_ref_sys" ("srid","srtext") VALUES (974269,'GEOGCS["NAD83",DATUM["North_American_Datum_1983",SPHEROID["GRS 1980",6378137,298.257222101,AUTHORITY["EPSG","7019"]],AUTHORITY["EPSG","6269"]],PRIMEM["Greenwich",0,AUTHORITY["EPSG","8901"]],UNIT["degree",0.01745329251994328,AUTHORITY["EPSG","9122"]],AUTHORITY["EPSG","4269"]]');
+
+CREATE TABLE raster_gdalwarp_opt_src (
+	rid integer,
+	rast raster
+);
+CREATE TABLE raster_gdalwarp_opt_dst (
+	tag text,
+	seq integer,
+	rast raster
+);
+-- warp operations, run in seq order so that consecutive calls share
+-- or change the source and destination spatial references
+CREATE TABLE raster_gdalwarp_opt_seq (
+	seq integer,
+	rid integer,
+	op text,
+	srid integer
+);
+
+CREATE OR REPLACE FUNCTION make_test_raster()
+	RETURNS void
+	AS $$
+	DECLARE
+		width int := 10;
+		height int := 10;
+		x int;
+		y int;
+		rast raster;
+	BEGIN
+		rast := ST_MakeEmptyRaster(width, height, -500000, 600000, 1000, -1000, 0, 0, 992163);
+		rast := ST_AddBand(rast, 1, '64BF', 0, 0);
+
+		FOR x IN 1..width LOOP
+			FOR y IN 1..height LOOP
+				rast := ST_SetValue(rast, 1, x, y, ((x::double precision * y) + (x + y) + (x + y * x)) / (x + y + 1));
+			END LOOP;
+		END LOOP;
+
+		INSERT INTO raster_gdalwarp_opt_src VALUES (1, rast);
+		-- same values in two other spatial references
+		INSERT INTO raster_gdalwarp_opt_src VALUES (2, ST_Transform(rast, 993310));
+		-- only used to clear the cached spatial references
+		INSERT INTO raster_gdalwarp_opt_src VALUES (0, ST_Transform(rast, 993309));
+
+		RETURN;
+	END;
+	$$ LANGUAGE 'plpgsql';
+SELECT make_test_raster();
+DROP FUNCTION make_test_raster();
+
+INSERT INTO raster_gdalwarp_opt_seq VALUES
+	(1, 1, 'transform', 993310),
+	(2, 1, 'transform', 993310),
+	(3, 1, 'transform', 993309),
+	(4, 2, 'transform', 993309),
+	(5, 1, 'resample', NULL),
+	(6, 1, 'transform', 993309),
+	(7, 2, 'transform', 994269),
+	(8, 2, 'alignto', 994269),
+	(9, 1, 'alignto', 993310),
+	(10, 2, 'transform', 992163);
+
+CREATE OR REPLACE FUNCTION run_warp_sequence(tag text, uncached boolean)
+	RETURNS void
+	AS $$
+	DECLARE
+		r record;
+		rast raster;
+	BEGIN
+		FOR r IN SELECT * FROM raster_gdalwarp_opt_seq ORDER BY seq LOOP
+			-- warp between two spatial references not used by the sequence
+			IF uncached THEN
+				PERFORM ST_Transform(s.rast, 974269) FROM raster_gdalwarp_opt_src s WHERE s.rid = 0;
+			END IF;
+
+			SELECT s.rast INTO rast FROM raster_gdalwarp_opt_src s WHERE s.rid = r.rid;
+
+			IF r.op = 'transform' THEN
+				rast := ST_Transform(rast, r.srid);
+			ELSEIF r.op = 'alignto' THEN
+				rast := ST_Transform(rast, ST_MakeEmptyRaster(1, 1, 0, 0, CASE WHEN r.srid = 994269 THEN 0.01 ELSE 500 END, CASE WHEN r.srid = 994269 THEN -0.01 ELSE -500 END, 0, 0, r.srid));
+			ELSE
+				rast := ST_Resample(rast, 500., 500.);
+			END IF;
+
+			INSERT INTO raster_gdalwarp_opt_dst VALUES ($1, r.seq, rast);
+		END LOOP;
+
+		RETURN;
+	END;
+	$$ LANGUAGE 'plpgsql';
+
+-- postgis.gdal_warp_num_threads
+SET postgis.gdal_warp_num_threads = 0;
+SHOW postgis.gdal_warp_num_threads;
+SET postgis.gdal_warp_num_threads = 4;
+SHOW postgis.gdal_warp_num_threads;
+SET postgis.gdal_warp_num_threads = -1;
+SET postgis.gdal_warp_num_threads = 1025;
+SET postgis.gdal_warp_num_threads = 'abc';
+SHOW postgis.gdal_warp_num_threads;
+RESET postgis.gdal_warp_num_threads;
+SHOW postgis.gdal_warp_num_threads;
+
+-- postgis.gdal_warp_memory_limit
+SET postgis.gdal_warp_memory_limit = '64MB';
+SHOW postgis.gdal_warp_memory_limit;
+SET postgis.gdal_warp_memory_limit = 'lots';
+SHOW postgis.gdal_warp_memory_limit;
+SET postgis.gdal_warp_memory_limit = 0;
+SHOW postgis.gdal_warp_memory_limit;
+RESET postgis.gdal_warp_memory_limit;
+
+-- reference: every warp starts from an empty spatial reference cache
+SELECT run_warp_sequence('uncached', TRUE);
+
+-- consecutive warps reuse the cached spatial references
+SELECT run_warp_sequence('cached', FALSE);
+
+-- all available CPUs, small warp memory
+SET postgis.gdal_warp_num_threads = 0;
+SET postgis.gdal_warp_memory_limit = '1MB';
+SELECT run_warp_sequence('all_cpus', FALSE);
+
+SET postgis.gdal_warp_num_threads = 2;
+SET postgis.gdal_warp_memory_limit = '64MB';
+SELECT run_warp_sequence('threads_2', FALSE);
+
+RESET postgis.gdal_warp_num_threads;
+RESET postgis.gdal_warp_memory_limit;
+
+SELECT
+	d.tag,
+	d.seq,
+	ST_SRID(d.rast),
+	md5(ST_AsBinary(d.rast)) = md5(ST_AsBinary(u.rast))
+FROM raster_gdalwarp_opt_dst d
+JOIN raster_gdalwarp_opt_dst u
+	ON u.seq = d.seq AND u.tag = 'uncached'
+WHERE d.tag <> 'uncached'
+ORDER BY d.tag, d.seq;
+
+DROP FUNCTION run_warp_sequence(text, boolean);
+DROP TABLE raster_gdalwarp_opt_seq;
+DROP TABLE raster_gdalwarp_opt_src;
+DROP TABLE raster_gdalwarp_opt_dst;
+
+DELETE FROM "spatial_ref_sys" WHERE srid = 992163;
+DELETE FROM "spatial_ref_sys" WHERE srid = 993309;
+DELETE FROM "spatial_ref_sys" WHERE srid = 993310;
+DELETE FROM "spatial_ref_sys" WHERE srid = 994269;
+DELETE FROM "spatial_ref_sys" WHERE srid = 974269;
@@ -272,6 +272,19 @@ SELECT round(ST_Quantile('test_quantile', 'rast', 1, FALSE, 0.95)::numeric, 3);
 SELECT round(ST_Quantile('test_quantile', 'rast', 1, 0.95)::numeric, 3);
 SELECT round(ST_Quantile('test_quantile', 'rast', TRUE, 0.95)::numeric, 3);
 SELECT round(ST_Quantile('test_quantile', 'rast', 0.5)::numeric, 3);
+SELECT round(value::numeric, 3) FROM unnest((
+	SELECT ST_QuantileAgg(rast, 1, TRUE, NULL::double precision[]) FROM test_quantile
+)) AS value;
+SELECT round(value::numeric, 3) FROM unnest((
+	SELECT ST_QuantileAgg(rast, 1, FALSE, ARRAY[0, 0.006, 0.5, 0.994, 1]::double precision[]) FROM test_quantile
+)) AS value;
+SELECT round(value::numeric, 3) FROM unnest((
+	SELECT ST_QuantileAgg(rast, 1, ARRAY[0.05, 0.95]::double precision[]) FROM test_quantile
+)) AS value;
+SELECT round(value::numeric, 3) FROM unnest((
+	SELECT ST_QuantileAgg(rast, ARRAY[0.5]::double precision[]) FROM test_quantile
+)) AS value;
+SELECT ST_QuantileAgg(rast, 2, ARRAY[0.5]::double precision[]) IS NULL FROM test_quantile;
 SAVEPOINT test;
 SELECT round(ST_Quantile('test_quantile', 'rast', 2, 0.5)::numeric, 3);
 ROLLBACK TO SAVEPOINT test;
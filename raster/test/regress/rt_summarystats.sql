@@ -366,3 +366,41 @@ FROM (
 ROLLBACK TO SAVEPOINT test;
 RELEASE SAVEPOINT test;
 ROLLBACK;
+
+-- pixels in geometry
+SELECT
+	(stats).count,
+	round((stats).sum::numeric, 3),
+	round((stats).mean::numeric, 3),
+	round((stats).stddev::numeric, 3),
+	round((stats).min::numeric, 3),
+	round((stats).max::numeric, 3)
+FROM (
+	SELECT
+		ST_SummaryStats(
+			ST_SetValue(ST_AddBand(ST_MakeEmptyRaster(10, 10, 0, 10, 1, -1, 0, 0, 0), '8BUI', 1, 0), 1, 2, 2, 5),
+			ST_GeomFromText('POLYGON((0 10,3 10,3 7,0 7,0 10))', 0)
+		) AS stats
+) foo;
+
+SELECT
+	(stats).count,
+	round((stats).sum::numeric, 3),
+	round((stats).mean::numeric, 3),
+	round((stats).stddev::numeric, 3),
+	round((stats).min::numeric, 3),
+	round((stats).max::numeric, 3)
+FROM (
+	SELECT
+		ST_SummaryStatsAgg(rast, ST_GeomFromText('POLYGON((0 10,3 10,3 7,0 7,0 10))', 0), 1, TRUE) AS stats
+	FROM (
+		SELECT ST_SetValue(ST_AddBand(ST_MakeEmptyRaster(10, 10, 0, 10, 1, -1, 0, 0, 0), '8BUI', 1, 0), 1, 2, 2, 5) AS rast
+		UNION ALL
+		SELECT ST_SetValue(ST_AddBand(ST_MakeEmptyRaster(10, 10, 0, 10, 1, -1, 0, 0, 0), '8BUI', 1, 0), 1, 2, 2, 5) AS rast
+	) bar
+) foo;
+
+SELECT ST_SummaryStats(
+	ST_AddBand(ST_MakeEmptyRaster(10, 10, 0, 10, 1, -1, 0, 0, 0), '8BUI', 1, 0),
+	ST_GeomFromText('POLYGON((0 10,3 10,3 7,0 7,0 10))', 4326)
+);
@@ -451,6 +451,81 @@ FROM (
 ) foo
 ORDER BY uniontype, y, x;
 
+TRUNCATE raster_union_out;
+TRUNCATE raster_union_in;
+
+-- tiles with differing origins, gaps and an overlap: the working raster
+-- grows left, up, right and down, uncovered pixels stay NODATA and the
+-- padding is cropped off
+INSERT INTO raster_union_in
+	SELECT 71, ST_AddBand(ST_MakeEmptyRaster(2, 2, 0, 0, 1, -1, 0, 0, 0), 1, '8BUI', 2, 0) AS rast UNION ALL
+	SELECT 72, ST_AddBand(ST_MakeEmptyRaster(2, 2, 3, -1, 1, -1, 0, 0, 0), 1, '8BUI', 5, 0) AS rast UNION ALL
+	SELECT 73, ST_AddBand(ST_MakeEmptyRaster(2, 2, -2, 2, 1, -1, 0, 0, 0), 1, '8BUI', 3, 0) AS rast UNION ALL
+	SELECT 74, ST_AddBand(ST_MakeEmptyRaster(2, 2, 1, -1, 1, -1, 0, 0, 0), 1, '8BUI', 4, 0) AS rast
+;
+
+INSERT INTO raster_union_out
+	SELECT
+		'LAST',
+		ST_Union(rast ORDER BY rid) AS rast
+	FROM raster_union_in;
+
+INSERT INTO raster_union_out
+	SELECT
+		'COUNT',
+		ST_Union(rast, 1, 'COUNT' ORDER BY rid) AS rast
+	FROM raster_union_in;
+
+INSERT INTO raster_union_out
+	SELECT
+		'MEAN',
+		ST_Union(rast, 'mean' ORDER BY rid) AS rast
+	FROM raster_union_in;
+
+SELECT
+	uniontype,
+	(ST_Metadata(rast)).*,
+	ST_DumpValues(rast, 1)
+FROM raster_union_out
+ORDER BY uniontype;
+
+TRUNCATE raster_union_out;
+TRUNCATE raster_union_in;
+
+-- the last tile lands in the padding of the working raster, past the
+-- extent of the tiles before it
+INSERT INTO raster_union_in
+	SELECT 81, ST_AddBand(ST_MakeEmptyRaster(2, 2, 0, 0, 1, -1, 0, 0, 0), 1, '8BUI', 1, 0) AS rast UNION ALL
+	SELECT 82, ST_AddBand(ST_MakeEmptyRaster(2, 2, 2, 0, 1, -1, 0, 0, 0), 1, '8BUI', 2, 0) AS rast UNION ALL
+	SELECT 83, ST_AddBand(ST_MakeEmptyRaster(1, 2, 4, 0, 1, -1, 0, 0, 0), 1, '8BUI', 3, 0) AS rast
+;
+
+INSERT INTO raster_union_out
+	SELECT
+		'LAST',
+		ST_Union(rast ORDER BY rid) AS rast
+	FROM raster_union_in;
+
+SELECT
+	uniontype,
+	(ST_Metadata(rast)).*,
+	ST_DumpValues(rast, 1)
+FROM raster_union_out
+ORDER BY uniontype;
+
+TRUNCATE raster_union_out;
+TRUNCATE raster_union_in;
+
+-- tiles off the grid of the first tile cannot be pasted
+INSERT INTO raster_union_in
+	SELECT 91, ST_AddBand(ST_MakeEmptyRaster(2, 2, 0, 0, 1, -1, 0, 0, 0), 1, '8BUI', 1, 0) AS rast UNION ALL
+	SELECT 92, ST_AddBand(ST_MakeEmptyRaster(2, 2, 0.5, 0, 1, -1, 0, 0, 0), 1, '8BUI', 2, 0) AS rast
+;
+
+SELECT
+	ST_Union(rast ORDER BY rid)
+FROM raster_union_in;
+
 DROP TABLE IF EXISTS raster_union_in;
 DROP TABLE IF EXISTS raster_union_out;
 
@@ -0,0 +1 @@
+select gid, i2, i4, f8, num, d, b, s from loadedshp order by 1;
@@ -0,0 +1,10 @@
+-- GeoJSON FeatureCollection aggregate
+WITH f(id, name, geom) AS ( VALUES
+  (1, 'a', 'POINT(1.126 2)'::geometry),
+  (2, 'b', NULL),
+  (3, NULL, 'LINESTRING(0 0,1 1)') )
+SELECT 'geojson_fc_01', ST_AsGeoJSONFeatureCollection(geom,
+  (SELECT p FROM (SELECT id, name) p), 2 ORDER BY id) FROM f;
+-- Properties must be a record
+SELECT 'geojson_fc_02', ST_AsGeoJSONFeatureCollection(geom, id)
+FROM (VALUES ('POINT(1 2)'::geometry, 42)) f(geom, id);
@@ -159,6 +159,14 @@ SELECT 'geojson_options_14', ST_AsGeoJson(GeomFromEWKT('SRID=4326;LINESTRING(1 1
 SELECT 'geojson_options_15', ST_AsGeoJson(GeomFromEWKT('SRID=0;LINESTRING(1 1, 2 2, 3 3, 4 4)'), 0, 7);
 SELECT 'geojson_options_16', ST_AsGeoJson(GeomFromEWKT('SRID=4326;LINESTRING(1 1, 2 2, 3 3, 4 4)'), 0, 7);
 
+-- Mapbox Vector Tile aggregate
+WITH f(id, name, geom) AS ( VALUES
+  (1, 'a', 'POINT(50 50)'::geometry),
+  (2, 'a', 'LINESTRING(0 0,100 100)'),
+  (3, 'b', NULL) )
+SELECT 'mvt_01', encode(ST_AsMVT(geom, (SELECT p FROM (SELECT id, name) p),
+  'test', ST_MakeBox2D(ST_Point(0, 0), ST_Point(100, 100)) ORDER BY id), 'hex') FROM f;
+
 -- Out and in to PostgreSQL native geometric types
 WITH p AS ( SELECT '((0,0),(0,1),(1,1),(1,0),(0,0))'::text AS p )
   SELECT 'pgcast_01', p = p::polygon::geometry::polygon::text FROM p;
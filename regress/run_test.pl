@@ -277,6 +277,16 @@ sub create_upgrade_test_objects
       print "\nSomething went wrong adding raster constraints to upgrade_test: " . $ret . "\n";
       exit(1);
     }
+
+    # The raster type got binary send and receive in 2.3.0, the upgrade
+    # has to set them on a raster type created before
+    $query = "update pg_type set typreceive = 0, typsend = 0 where oid = 'raster'::regtype";
+    $ret = sql($query);
+    unless ( $ret =~ /^UPDATE 1$/ ) {
+      `dropdb $DB`;
+      print "\nSomething went wrong removing raster send and receive: " . $ret . "\n";
+      exit(1);
+    }
   }
 
   if ( $OPT_WITH_TOPO )
@@ -302,6 +312,17 @@ sub drop_upgrade_test_objects
     exit(1);
   }
 
+  if ( $OPT_WITH_RASTER )
+  {
+    my $query = "select typreceive = 'raster_recv'::regproc and typsend = 'raster_send'::regproc from pg_type where oid = 'raster'::regtype";
+    $ret = sql($query);
+    unless ( $ret =~ /^t$/ ) {
+      `dropdb $DB`;
+      print "\nUpgrade did not set raster send and receive: " . $ret . "\n";
+      exit(1);
+    }
+  }
+
   if ( $OPT_WITH_TOPO )
   {
     my $query = "SELECT topology.DropTopology('upgrade_test');";
@@ -1029,6 +1050,13 @@ sub run_loader_test
 	}
 	drop_table($tblname);
 
+	# If we have some expected files to compare with, run in binary COPY mode.
+	if ( ! run_loader_and_check_output("binary test", $tblname, "${TEST}-B.sql.expected", "${TEST}-B.select.expected", "-B ${TMPDIR}/loader.bin $custom_opts") )
+	{
+		return 0;
+	}
+	drop_table($tblname);
+
 	# Some custom parameters can be incompatible with -D.
 	if ( $custom_opts )
 	{
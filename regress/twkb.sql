@@ -64,3 +64,29 @@ select 'POLYGON((1 1, 1 2, 2 2, 2 1, 1 1))'::text g
 --GEOMETRYCOLLECTION with bounding box ref #3187
 select encode(st_astwkb(st_collect('point(4 1)'::geometry,'linestring(1 1, 0 3)'::geometry),0,0,0,false,true),'hex');
 
+
+--ST_AsTWKBAgg skips rows with a NULL geometry or id
+select 'twkbagg_01', encode(ST_AsTWKBAgg(g::geometry, id, 0 order by n),'hex') from
+(values (1, 'POINT(1 1)', 1::int8),(2, NULL, 2),(3, 'POINT(2 2)', NULL),(4, 'POINT(3 3)', 4)) foo(n, g, id);
+select 'twkbagg_02', ST_AsTWKBAgg(g::geometry, id) is null from
+(values (NULL, 1::int8),('POINT(1 1)', NULL)) foo(g, id);
+
+--ST_AsTWKBAgg takes its options from the first row
+select 'twkbagg_03', encode(ST_AsTWKBAgg(g::geometry, id, p order by id),'hex') from
+(values ('POINT(1.26 1.34)', 1::int8, 1),('POINT(2.555 2.111)', 2, 3)) foo(g, id, p);
+
+--ST_AsTWKBAgg refuses mixed dimensions
+select 'twkbagg_04', ST_AsTWKBAgg(g::geometry, id order by id) from
+(values ('POINT(1 1)', 1::int8),('POINT(1 1 1)', 2)) foo(g, id);
+
+--ST_AsTWKBAgg matches ST_AsTWKB on arrays
+select 'twkbagg_05', encode(a,'hex'), a = b from (
+select ST_AsTWKBAgg(g, id, 1, 0, 0, true, true order by id) a,
+       ST_AsTWKB(array_agg(g order by id), array_agg(id order by id), 1, 0, 0, true, true) b from
+(values ('POINT(1 2)'::geometry, 10::int8),('LINESTRING(0 0,10.5 3,4 4)', 20),
+        ('POLYGON((0 0,0 5,5 5,5 0,0 0),(1 1,2 1,2 2,1 1))', 30),('POINT(7 8)', 40)) foo(g, id)) bar;
+select 'twkbagg_06', encode(a,'hex'), a = b from (
+select ST_AsTWKBAgg(g, id order by id) a,
+       ST_AsTWKB(array_agg(g order by id), array_agg(id order by id)) b from
+(values ('LINESTRING(0 0 1,1 1 2)'::geometry, 1::int8),('LINESTRING(5 5 5,6 7 8)', 2),
+        ('LINESTRING(-1 -1 0,2 2 2)', 3)) foo(g, id)) bar;
@@ -107,6 +107,15 @@ sub parse_last_updated
   return 0;
 }
 
+sub parse_availability
+{
+  my $comment = shift;
+  if ( $comment =~ m/Availability:\s([^\.])\.([^.]*)/s ) {
+    return $1*100 + $2;
+  }
+  return 0;
+}
+
 sub parse_missing
 {
   my $comment = shift;
@@ -249,18 +258,59 @@ while(<INPUT>)
       $last_updated = find_last_updated("types", $newtype);
     }
     my $missing = parse_missing($comment);
+    # A type changed after it became available cannot be created
+    # again, its changed properties are set with ALTER TYPE instead
+    my $available = parse_availability($comment) || $last_updated;
+    my %columns = (
+      'receive' => 'typreceive',
+      'send' => 'typsend',
+      'typmod_in' => 'typmodin',
+      'typmod_out' => 'typmodout',
+      'analyze' => 'typanalyze'
+    );
+    my @props = ();
+    my @sets = ();
+    my @unset = ();
+    if ( $available < $last_updated ) {
+      for my $prop ( 'receive', 'send', 'typmod_in', 'typmod_out', 'analyze' ) {
+        next unless ( $def =~ m/\b$prop\s*=\s*(\w+)/i );
+        push(@props, "$prop = $1");
+        push(@sets, "$columns{$prop} = '$1'::regproc");
+        push(@unset, "$columns{$prop} = 0");
+      }
+    }
     print "-- Type ${newtype} -- LastUpdated: ${last_updated}\n";
       print <<"EOF";
 DO LANGUAGE 'plpgsql'
 \$postgis_proc_upgrade\$
 BEGIN
-  IF $last_updated > version_from_num
+  IF $available > version_from_num
 EOF
       print "OR version_from_num IN ( ${missing} )" if ( $missing );
       print <<"EOF";
      FROM _postgis_upgrade_info
   THEN
       EXECUTE \$postgis_proc_upgrade_parsed_def\$ $def \$postgis_proc_upgrade_parsed_def\$;
+EOF
+      if ( @props ) {
+        # ALTER TYPE ... SET only exists from PostgreSQL 13, older
+        # servers get the functions set in the catalog. The functions
+        # are created before the type, so they exist by now. Both are
+        # run on every upgrade of an existing type so that a type
+        # installed by a development version gets them too
+        my $alter = "ALTER TYPE ${newtype} SET (" . join(', ', @props) . ")";
+        my $update = "UPDATE pg_type SET " . join(', ', @sets) .
+          " WHERE oid = '${newtype}'::regtype AND (" . join(' OR ', @unset) . ")";
+        print <<"EOF";
+  ELSE
+    IF current_setting('server_version_num')::integer >= 130000 THEN
+      EXECUTE \$postgis_proc_upgrade_parsed_def\$ $alter \$postgis_proc_upgrade_parsed_def\$;
+    ELSE
+      EXECUTE \$postgis_proc_upgrade_parsed_def\$ $update \$postgis_proc_upgrade_parsed_def\$;
+    END IF;
+EOF
+      }
+      print <<"EOF";
   END IF;
 END
 \$postgis_proc_upgrade\$;